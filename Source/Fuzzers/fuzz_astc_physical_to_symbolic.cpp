@@ -69,6 +69,7 @@ bool bsd_initializer()
 		    testSz[i].z,
 		    false,
 		    1.0f,
+		    false,
 		    &(testBSD[i]));
 	}
 
@@ -0,0 +1,671 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Microbenchmarks for the hot kernels of the codec.
+ *
+ * Each kernel is timed in isolation over a corpus of real blocks, captured
+ * from an input image for each block size. The intermediate data that each
+ * kernel consumes, such as error weights, ideal weights, and symbolic blocks,
+ * is computed before timing starts so only the kernel itself is measured.
+ *
+ * The benchmark is built for each SIMD ISA, so the cost of each kernel can be
+ * compared across ISA backends.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "../astcenc_internal.h"
+#include "../astcenccli_internal.h"
+
+/**
+ * @brief Sink for kernel results, so that the compiler cannot remove them.
+ */
+static volatile float kernel_sink;
+
+/**
+ * @brief The ISE encoded weights of a single block.
+ */
+struct ise_sequence
+{
+	/** The weight quantization level. */
+	int quant_level;
+	/** The number of weights. */
+	int count;
+	/** The unpacked weights. */
+	uint8_t values[MAX_WEIGHTS_PER_BLOCK];
+	/** The packed weights. */
+	uint8_t encoded[16];
+};
+
+/**
+ * @brief The corpus of captured blocks for a single block size.
+ */
+struct kernel_corpus
+{
+	/** The codec context, which owns the block size descriptor. */
+	astcenc_context* context;
+	/** The block size descriptor. */
+	const block_size_descriptor* bsd;
+	/** The number of blocks in the corpus. */
+	unsigned int block_count;
+	/** The texel position of each block. */
+	std::vector<unsigned int> xpos;
+	/** The texel position of each block. */
+	std::vector<unsigned int> ypos;
+	/** The image data of each block. */
+	imageblock* blocks;
+	/** The error weights of each block. */
+	error_weight_block* ewbs;
+	/** The ideal single partition endpoints and weights of each block. */
+	endpoints_and_weights* eis;
+	/** The ideal decimated weights for each decimation mode of each block. */
+	float* decimated_quantized_weights;
+	/** The decimated weights for each decimation mode of each block. */
+	float* decimated_weights;
+	/** The final symbolic encoding of each block. */
+	std::vector<symbolic_compressed_block> scbs;
+	/** The ISE encoded weights of each non-constant block. */
+	std::vector<ise_sequence> ise;
+};
+
+/**
+ * @brief The size of the per-block decimated weight arrays.
+ */
+static const size_t DECIMATED_WEIGHTS_SIZE = MAX_DECIMATION_MODES * MAX_WEIGHTS_PER_BLOCK;
+
+/**
+ * @brief Test if a decimation mode is searched for single plane encodings.
+ *
+ * @param dm   The decimation mode.
+ *
+ * @return True if the mode is searched.
+ */
+static bool is_searched_1plane(
+	const decimation_mode& dm
+) {
+	return (dm.maxprec_1plane >= 0) && dm.percentile_hit;
+}
+
+/**
+ * @brief Populate the error weights for a block using the default weighting.
+ *
+ * This matches the compressor error weighting when all channel weights are
+ * one and no averages, variances, or alpha weighting are used.
+ *
+ * @param      bsd   The block size descriptor.
+ * @param      blk   The image block.
+ * @param[out] ewb   The error weights to populate.
+ */
+static void init_error_weight_block(
+	const block_size_descriptor* bsd,
+	const imageblock* blk,
+	error_weight_block* ewb
+) {
+	vfloat4 derv[MAX_TEXELS_PER_BLOCK];
+	imageblock_initialize_deriv(blk, bsd->texel_count, derv);
+
+	*ewb = error_weight_block {};
+	for (int i = 0; i < bsd->texel_count; i++)
+	{
+		vfloat4 error_weight = vfloat4(1.0f) / (derv[i] * derv[i] * 1e-10f);
+		ewb->error_weights[i] = error_weight;
+
+		float wr = error_weight.lane<0>();
+		float wg = error_weight.lane<1>();
+		float wb = error_weight.lane<2>();
+		float wa = error_weight.lane<3>();
+
+		ewb->texel_weight_r[i] = wr;
+		ewb->texel_weight_g[i] = wg;
+		ewb->texel_weight_b[i] = wb;
+		ewb->texel_weight_a[i] = wa;
+
+		ewb->texel_weight_rg[i] = (wr + wg) * 0.5f;
+		ewb->texel_weight_rb[i] = (wr + wb) * 0.5f;
+		ewb->texel_weight_gb[i] = (wg + wb) * 0.5f;
+		ewb->texel_weight_ra[i] = (wr + wa) * 0.5f;
+
+		ewb->texel_weight_gba[i] = (wg + wb + wa) * 0.333333f;
+		ewb->texel_weight_rba[i] = (wr + wb + wa) * 0.333333f;
+		ewb->texel_weight_rga[i] = (wr + wg + wa) * 0.333333f;
+		ewb->texel_weight_rgb[i] = (wr + wg + wb) * 0.333333f;
+
+		ewb->texel_weight[i] = (wr + wg + wb + wa) * 0.25f;
+	}
+}
+
+/**
+ * @brief Get the ISE encoded weights of a symbolic block.
+ *
+ * @param      bsd   The block size descriptor.
+ * @param      scb   The symbolic block; must not be a constant color block.
+ * @param[out] seq   The weight sequence to populate.
+ */
+static void init_ise_sequence(
+	const block_size_descriptor* bsd,
+	const symbolic_compressed_block& scb,
+	ise_sequence& seq
+) {
+	const block_mode& bm = bsd->block_modes[bsd->block_mode_packed_index[scb.block_mode]];
+	int weight_count = bsd->decimation_tables[bm.decimation_mode]->weight_count;
+
+	seq.quant_level = bm.quant_mode;
+	seq.count = bm.is_dual_plane ? 2 * weight_count : weight_count;
+	for (int i = 0; i < weight_count; i++)
+	{
+		if (bm.is_dual_plane)
+		{
+			seq.values[2 * i] = scb.weights[i];
+			seq.values[2 * i + 1] = scb.weights[i + PLANE2_WEIGHTS_OFFSET];
+		}
+		else
+		{
+			seq.values[i] = scb.weights[i];
+		}
+	}
+
+	memset(seq.encoded, 0, sizeof(seq.encoded));
+	encode_ise(seq.quant_level, seq.count, seq.values, seq.encoded, 0);
+}
+
+/**
+ * @brief Capture a corpus of blocks from an image.
+ *
+ * The image is compressed with the medium preset, and blocks are sampled at
+ * evenly spaced positions across the image.
+ *
+ * @param      image         The input image.
+ * @param      profile       The color profile.
+ * @param      block_x       The block X dimension.
+ * @param      block_y       The block Y dimension.
+ * @param      max_blocks    The maximum number of blocks in the corpus.
+ * @param[out] corpus        The corpus to populate.
+ *
+ * @return True on success, false on error.
+ */
+static bool init_corpus(
+	astcenc_image& image,
+	astcenc_profile profile,
+	unsigned int block_x,
+	unsigned int block_y,
+	unsigned int max_blocks,
+	kernel_corpus& corpus
+) {
+	astcenc_config config;
+	astcenc_error status = astcenc_config_init(profile, block_x, block_y, 1,
+	                                           ASTCENC_PRE_MEDIUM, 0, config);
+	if (status == ASTCENC_SUCCESS)
+	{
+		status = astcenc_context_alloc(config, 1, &corpus.context);
+	}
+
+	if (status != ASTCENC_SUCCESS)
+	{
+		printf("ERROR: Codec context alloc failed: %s\n", astcenc_get_error_string(status));
+		return false;
+	}
+
+	corpus.bsd = corpus.context->bsd;
+
+	unsigned int blocks_x = (image.dim_x + block_x - 1) / block_x;
+	unsigned int blocks_y = (image.dim_y + block_y - 1) / block_y;
+	unsigned int total_blocks = blocks_x * blocks_y;
+
+	std::vector<uint8_t> data(total_blocks * 16);
+	astcenc_swizzle swizzle { ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A };
+	status = astcenc_compress_image(corpus.context, image, swizzle, data.data(), data.size(), 0);
+	if (status != ASTCENC_SUCCESS)
+	{
+		printf("ERROR: Codec compress failed: %s\n", astcenc_get_error_string(status));
+		return false;
+	}
+
+	unsigned int count = astc::min(max_blocks, total_blocks);
+	corpus.block_count = count;
+	corpus.blocks = aligned_malloc<imageblock>(sizeof(imageblock) * count, ASTCENC_VECALIGN);
+	corpus.ewbs = aligned_malloc<error_weight_block>(sizeof(error_weight_block) * count, ASTCENC_VECALIGN);
+	corpus.eis = aligned_malloc<endpoints_and_weights>(sizeof(endpoints_and_weights) * count, ASTCENC_VECALIGN);
+	corpus.decimated_quantized_weights = aligned_malloc<float>(sizeof(float) * DECIMATED_WEIGHTS_SIZE * count, ASTCENC_VECALIGN);
+	corpus.decimated_weights = aligned_malloc<float>(sizeof(float) * DECIMATED_WEIGHTS_SIZE * count, ASTCENC_VECALIGN);
+	corpus.scbs.resize(count);
+
+	if (!corpus.blocks || !corpus.ewbs || !corpus.eis ||
+	    !corpus.decimated_quantized_weights || !corpus.decimated_weights)
+	{
+		printf("ERROR: Failed to allocate corpus\n");
+		return false;
+	}
+
+	const block_size_descriptor* bsd = corpus.bsd;
+	const partition_info* pi = get_partition_info(bsd, 1, 0);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		size_t index = static_cast<size_t>(i) * total_blocks / count;
+		unsigned int x = static_cast<unsigned int>(index % blocks_x) * block_x;
+		unsigned int y = static_cast<unsigned int>(index / blocks_x) * block_y;
+		corpus.xpos.push_back(x);
+		corpus.ypos.push_back(y);
+
+		imageblock* blk = corpus.blocks + i;
+		fetch_imageblock(profile, image, blk, bsd, x, y, 0, swizzle);
+
+		error_weight_block* ewb = corpus.ewbs + i;
+		init_error_weight_block(bsd, blk, ewb);
+
+		endpoints_and_weights* ei = corpus.eis + i;
+		compute_endpoints_and_ideal_weights_1_plane(bsd, pi, blk, ewb, ei);
+
+		float* dqw = corpus.decimated_quantized_weights + i * DECIMATED_WEIGHTS_SIZE;
+		float* dw = corpus.decimated_weights + i * DECIMATED_WEIGHTS_SIZE;
+		for (int j = 0; j < bsd->decimation_mode_count; j++)
+		{
+			if (is_searched_1plane(bsd->decimation_modes[j]))
+			{
+				compute_ideal_weights_for_decimation_table(
+				    *ei, *bsd->decimation_tables[j],
+				    dqw + j * MAX_WEIGHTS_PER_BLOCK, dw + j * MAX_WEIGHTS_PER_BLOCK);
+			}
+		}
+
+		physical_compressed_block pcb;
+		memcpy(pcb.data, data.data() + index * 16, 16);
+		physical_to_symbolic(*bsd, pcb, corpus.scbs[i]);
+
+		const symbolic_compressed_block& scb = corpus.scbs[i];
+		if (!scb.error_block && (scb.block_mode >= 0))
+		{
+			ise_sequence seq;
+			init_ise_sequence(bsd, scb, seq);
+			corpus.ise.push_back(seq);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Free a corpus created by init_corpus().
+ *
+ * @param corpus   The corpus to free.
+ */
+static void free_corpus(
+	kernel_corpus& corpus
+) {
+	aligned_free(corpus.blocks);
+	aligned_free(corpus.ewbs);
+	aligned_free(corpus.eis);
+	aligned_free(corpus.decimated_quantized_weights);
+	aligned_free(corpus.decimated_weights);
+	astcenc_context_free(corpus.context);
+}
+
+/**
+ * @brief The shared state passed to each kernel runner.
+ */
+struct kernel_args
+{
+	/** The corpus. */
+	const kernel_corpus* corpus;
+	/** The input image. */
+	const astcenc_image* image;
+	/** The color profile. */
+	astcenc_profile profile;
+};
+
+static float run_fetch_imageblock(const kernel_args& args)
+{
+	const kernel_corpus& corpus = *args.corpus;
+	astcenc_swizzle swizzle { ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A };
+	imageblock blk;
+
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < corpus.block_count; i++)
+	{
+		fetch_imageblock(args.profile, *args.image, &blk, corpus.bsd,
+		                 corpus.xpos[i], corpus.ypos[i], 0, swizzle);
+		sum += blk.data_r[0];
+	}
+
+	return sum;
+}
+
+static float run_find_best_partitionings(const kernel_args& args)
+{
+	const kernel_corpus& corpus = *args.corpus;
+	unsigned int limit = corpus.context->config.tune_partition_limit;
+
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < corpus.block_count; i++)
+	{
+		for (int partition_count = 2; partition_count <= 4; partition_count++)
+		{
+			int best_uncorrelated;
+			int best_samechroma;
+			int best_dualplane;
+			find_best_partitionings(corpus.bsd, corpus.blocks + i, corpus.ewbs + i,
+			                        partition_count, limit, &best_uncorrelated,
+			                        &best_samechroma, &best_dualplane);
+			sum += static_cast<float>(best_uncorrelated + best_samechroma + best_dualplane);
+		}
+	}
+
+	return sum;
+}
+
+static float run_kmeans_compute_partition_ordering(const kernel_args& args)
+{
+	const kernel_corpus& corpus = *args.corpus;
+
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < corpus.block_count; i++)
+	{
+		for (int partition_count = 2; partition_count <= 4; partition_count++)
+		{
+			int ordering[PARTITION_COUNT];
+			kmeans_compute_partition_ordering(corpus.bsd, partition_count,
+			                                  corpus.blocks + i, ordering);
+			sum += static_cast<float>(ordering[0]);
+		}
+	}
+
+	return sum;
+}
+
+static float run_compute_ideal_weights_for_decimation_table(const kernel_args& args)
+{
+	const kernel_corpus& corpus = *args.corpus;
+	const block_size_descriptor* bsd = corpus.bsd;
+	alignas(ASTCENC_VECALIGN) float weight_set[MAX_WEIGHTS_PER_BLOCK];
+	alignas(ASTCENC_VECALIGN) float weights[MAX_WEIGHTS_PER_BLOCK];
+
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < corpus.block_count; i++)
+	{
+		for (int j = 0; j < bsd->decimation_mode_count; j++)
+		{
+			if (is_searched_1plane(bsd->decimation_modes[j]))
+			{
+				compute_ideal_weights_for_decimation_table(
+				    corpus.eis[i], *bsd->decimation_tables[j], weight_set, weights);
+				sum += weight_set[0];
+			}
+		}
+	}
+
+	return sum;
+}
+
+static float run_compute_angular_endpoints_1plane(const kernel_args& args)
+{
+	const kernel_corpus& corpus = *args.corpus;
+	float low_value[MAX_WEIGHT_MODES];
+	float high_value[MAX_WEIGHT_MODES];
+
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < corpus.block_count; i++)
+	{
+		compute_angular_endpoints_1plane(
+		    false, -1, corpus.bsd,
+		    corpus.decimated_quantized_weights + i * DECIMATED_WEIGHTS_SIZE,
+		    corpus.decimated_weights + i * DECIMATED_WEIGHTS_SIZE,
+		    low_value, high_value);
+		sum += low_value[0] + high_value[0];
+	}
+
+	return sum;
+}
+
+static float run_encode_ise(const kernel_args& args)
+{
+	const kernel_corpus& corpus = *args.corpus;
+	uint8_t encoded[16] {};
+
+	float sum = 0.0f;
+	for (const ise_sequence& seq : corpus.ise)
+	{
+		encode_ise(seq.quant_level, seq.count, seq.values, encoded, 0);
+		sum += encoded[0];
+	}
+
+	return sum;
+}
+
+static float run_decode_ise(const kernel_args& args)
+{
+	const kernel_corpus& corpus = *args.corpus;
+	uint8_t values[MAX_WEIGHTS_PER_BLOCK];
+
+	float sum = 0.0f;
+	for (const ise_sequence& seq : corpus.ise)
+	{
+		decode_ise(seq.quant_level, seq.count, seq.encoded, values, 0);
+		sum += values[0];
+	}
+
+	return sum;
+}
+
+static float run_decompress_symbolic_block(const kernel_args& args)
+{
+	const kernel_corpus& corpus = *args.corpus;
+	imageblock blk;
+
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < corpus.block_count; i++)
+	{
+		decompress_symbolic_block(args.profile, corpus.bsd, corpus.xpos[i], corpus.ypos[i], 0,
+		                          &corpus.scbs[i], &blk);
+		sum += blk.data_r[0];
+	}
+
+	return sum;
+}
+
+/**
+ * @brief A kernel to benchmark.
+ */
+struct kernel_desc
+{
+	/** The kernel name. */
+	const char* name;
+	/** The function which runs the kernel once over the whole corpus. */
+	float (*run)(const kernel_args& args);
+	/** True if the kernel is only run for non-constant blocks. */
+	bool ise_corpus;
+};
+
+static const kernel_desc kernels[] {
+	{ "fetch_imageblock", run_fetch_imageblock, false },
+	{ "find_best_partitionings", run_find_best_partitionings, false },
+	{ "kmeans_compute_partition_ordering", run_kmeans_compute_partition_ordering, false },
+	{ "compute_ideal_weights_for_decimation_table", run_compute_ideal_weights_for_decimation_table, false },
+	{ "compute_angular_endpoints_1plane", run_compute_angular_endpoints_1plane, false },
+	{ "encode_ise", run_encode_ise, true },
+	{ "decode_ise", run_decode_ise, true },
+	{ "decompress_symbolic_block", run_decompress_symbolic_block, false }
+};
+
+/**
+ * @brief The minimum duration of each timed run of a kernel, in seconds.
+ *
+ * The system timer may only have microsecond resolution, so small corpora are
+ * processed multiple times per run to keep timing noise low.
+ */
+static const double MIN_RUN_TIME = 0.01;
+
+/**
+ * @brief Time a kernel over a corpus.
+ *
+ * @param kernel    The kernel to run.
+ * @param args      The kernel arguments.
+ * @param repeats   The number of timed runs.
+ *
+ * @return The fastest time to process the corpus once, in seconds.
+ */
+static double time_kernel(
+	const kernel_desc& kernel,
+	const kernel_args& args,
+	unsigned int repeats
+) {
+	// Warm up caches and branch predictors, and find how many passes over the
+	// corpus are needed for each run to exceed the minimum run time
+	unsigned int passes = 1;
+	while (true)
+	{
+		double start = get_time();
+		for (unsigned int j = 0; j < passes; j++)
+		{
+			kernel_sink = kernel.run(args);
+		}
+
+		if ((get_time() - start) >= MIN_RUN_TIME)
+		{
+			break;
+		}
+
+		passes *= 2;
+	}
+
+	double best = 0.0;
+	for (unsigned int i = 0; i < repeats; i++)
+	{
+		double start = get_time();
+		for (unsigned int j = 0; j < passes; j++)
+		{
+			kernel_sink = kernel.run(args);
+		}
+
+		double time = (get_time() - start) / static_cast<double>(passes);
+		best = (i == 0) ? time : astc::min(best, time);
+	}
+
+	return best;
+}
+
+/**
+ * @brief Print the command line usage.
+ */
+static void print_usage()
+{
+	printf("Usage: bench-kernels <image> [-block <WxH>]... [-blocks <count>] [-repeats <count>]\n\n"
+	       "    -block <WxH>       Benchmark a 2D block size; may be repeated.\n"
+	       "                       Defaults to 4x4, 5x5, 6x6, 8x8, 10x10, and 12x12.\n"
+	       "    -blocks <count>    The maximum number of blocks in each corpus (default 256).\n"
+	       "    -repeats <count>   The number of timed runs of each kernel (default 10).\n");
+}
+
+int main(
+	int argc,
+	char** argv
+) {
+	if (argc < 2)
+	{
+		print_usage();
+		return 1;
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>> block_sizes;
+	unsigned int max_blocks = 256;
+	unsigned int repeats = 10;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-block") && (i + 1 < argc))
+		{
+			unsigned int x = 0;
+			unsigned int y = 0;
+			if (sscanf(argv[++i], "%ux%u", &x, &y) != 2)
+			{
+				printf("ERROR: Invalid block size '%s'\n", argv[i]);
+				return 1;
+			}
+
+			block_sizes.emplace_back(x, y);
+		}
+		else if (!strcmp(argv[i], "-blocks") && (i + 1 < argc))
+		{
+			max_blocks = astc::max(atoi(argv[++i]), 1);
+		}
+		else if (!strcmp(argv[i], "-repeats") && (i + 1 < argc))
+		{
+			repeats = astc::max(atoi(argv[++i]), 1);
+		}
+		else
+		{
+			print_usage();
+			return 1;
+		}
+	}
+
+	if (block_sizes.empty())
+	{
+		block_sizes = { { 4, 4 }, { 5, 5 }, { 6, 6 }, { 8, 8 }, { 10, 10 }, { 12, 12 } };
+	}
+
+	bool is_hdr;
+	unsigned int component_count;
+	astcenc_image* image = load_ncimage(argv[1], false, is_hdr, component_count);
+	if (!image)
+	{
+		return 1;
+	}
+
+	astcenc_profile profile = is_hdr ? ASTCENC_PRF_HDR : ASTCENC_PRF_LDR;
+
+	printf("Kernel microbenchmarks\n");
+	printf("======================\n\n");
+	printf("    Image:                      %s\n", argv[1]);
+	printf("    Repeats:                    %u\n", repeats);
+
+	for (const auto& block_size : block_sizes)
+	{
+		kernel_corpus corpus {};
+		if (!init_corpus(*image, profile, block_size.first, block_size.second, max_blocks, corpus))
+		{
+			free_corpus(corpus);
+			free_image(image);
+			return 1;
+		}
+
+		printf("\n    Block size %ux%u, %u blocks (%zu non-constant)\n",
+		       block_size.first, block_size.second, corpus.block_count, corpus.ise.size());
+
+		kernel_args args { &corpus, image, profile };
+		for (const kernel_desc& kernel : kernels)
+		{
+			size_t count = kernel.ise_corpus ? corpus.ise.size() : corpus.block_count;
+			if (!count)
+			{
+				continue;
+			}
+
+			double best = time_kernel(kernel, args, repeats);
+			double ns_per_block = best * 1e9 / static_cast<double>(count);
+			printf("        %-44s %10.1f ns/block\n", kernel.name, ns_per_block);
+		}
+
+		free_corpus(corpus);
+	}
+
+	printf("\n");
+	free_image(image);
+	return 0;
+}
@@ -19,7 +19,8 @@ add_executable(test-simd-${ISA_SIMD})
 
 target_sources(test-simd-${ISA_SIMD}
     PRIVATE
-        test_simd.cpp)
+        test_simd.cpp
+        ../astcenc_mathlib_softfloat.cpp)
 
 target_include_directories(test-simd-${ISA_SIMD}
     PRIVATE
@@ -48,7 +49,8 @@ if(${ISA_SIMD} MATCHES "none")
             ASTCENC_NEON=0
             ASTCENC_SSE=0
             ASTCENC_AVX=0
-            ASTCENC_POPCNT=0)
+            ASTCENC_POPCNT=0
+            ASTCENC_F16C=0)
 
     if (${ARCH} MATCHES x64)
         target_compile_options(test-simd-${ISA_SIMD}
@@ -62,7 +64,8 @@ elseif(${ISA_SIMD} MATCHES "neon")
             ASTCENC_NEON=1
             ASTCENC_SSE=0
             ASTCENC_AVX=0
-            ASTCENC_POPCNT=0)
+            ASTCENC_POPCNT=0
+            ASTCENC_F16C=0)
 
 elseif(${ISA_SIMD} MATCHES "sse2")
     target_compile_definitions(test-simd-${ISA_SIMD}
@@ -70,7 +73,8 @@ elseif(${ISA_SIMD} MATCHES "sse2")
             ASTCENC_NEON=0
             ASTCENC_SSE=20
             ASTCENC_AVX=0
-            ASTCENC_POPCNT=0)
+            ASTCENC_POPCNT=0
+            ASTCENC_F16C=0)
 
     target_compile_options(test-simd-${ISA_SIMD}
         PRIVATE
@@ -82,7 +86,8 @@ elseif(${ISA_SIMD} MATCHES "sse4.1")
             ASTCENC_NEON=0
             ASTCENC_SSE=41
             ASTCENC_AVX=0
-            ASTCENC_POPCNT=1)
+            ASTCENC_POPCNT=1
+            ASTCENC_F16C=0)
 
     target_compile_options(test-simd-${ISA_SIMD}
         PRIVATE
@@ -94,12 +99,27 @@ elseif(${ISA_SIMD} MATCHES "avx2")
             ASTCENC_NEON=0
             ASTCENC_SSE=41
             ASTCENC_AVX=2
-            ASTCENC_POPCNT=1)
+            ASTCENC_POPCNT=1
+            ASTCENC_F16C=1)
 
     target_compile_options(test-simd-${ISA_SIMD}
         PRIVATE
-            $<$<NOT:$<CXX_COMPILER_ID:MSVC>>:-mfpmath=sse -mavx2 -mpopcnt>
+            $<$<NOT:$<CXX_COMPILER_ID:MSVC>>:-mfpmath=sse -mavx2 -mpopcnt -mf16c>
             $<$<CXX_COMPILER_ID:MSVC>:/arch:AVX2>)
+
+elseif(${ISA_SIMD} MATCHES "avx512")
+    target_compile_definitions(test-simd-${ISA_SIMD}
+        PRIVATE
+            ASTCENC_NEON=0
+            ASTCENC_SSE=41
+            ASTCENC_AVX=512
+            ASTCENC_POPCNT=1
+            ASTCENC_F16C=1)
+
+    target_compile_options(test-simd-${ISA_SIMD}
+        PRIVATE
+            $<$<NOT:$<CXX_COMPILER_ID:MSVC>>:-mfpmath=sse -mavx512f -mavx512bw -mavx512dq -mavx512vl -mpopcnt -mf16c>
+            $<$<CXX_COMPILER_ID:MSVC>:/arch:AVX512>)
 endif()
 
 target_link_libraries(test-simd-${ISA_SIMD}
@@ -110,3 +130,55 @@ add_test(NAME test-simd-${ISA_SIMD}
          COMMAND test-simd-${ISA_SIMD})
 
 install(TARGETS test-simd-${ISA_SIMD} DESTINATION ${PACKAGE_ROOT})
+
+# Public API tests, which link the codec library
+if(NOT ${DECOMPRESSOR})
+    add_executable(test-api-${ISA_SIMD})
+
+    target_sources(test-api-${ISA_SIMD}
+        PRIVATE
+            test_api.cpp)
+
+    target_include_directories(test-api-${ISA_SIMD}
+        PRIVATE
+            ${gtest_SOURCE_DIR}/include)
+
+    astc_set_properties(test-api-${ISA_SIMD})
+
+    target_link_libraries(test-api-${ISA_SIMD}
+        PRIVATE
+            astc${CODEC}-${ISA_SIMD}-static
+            gtest_main)
+
+    add_test(NAME test-api-${ISA_SIMD}
+             COMMAND test-api-${ISA_SIMD})
+
+    install(TARGETS test-api-${ISA_SIMD} DESTINATION ${PACKAGE_ROOT})
+endif()
+
+# Kernel microbenchmarks, which use the CLI image loaders to capture a corpus
+# of real blocks; these are run manually and are not registered as tests
+if(NOT ${DECOMPRESSOR})
+    add_executable(bench-kernels-${ISA_SIMD})
+
+    target_sources(bench-kernels-${ISA_SIMD}
+        PRIVATE
+            bench_kernels.cpp
+            ../astcenccli_image.cpp
+            ../astcenccli_image_external.cpp
+            ../astcenccli_image_load_store.cpp
+            ../astcenccli_platform_dependents.cpp)
+
+    if(CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+        set_source_files_properties(../astcenccli_image_external.cpp
+                PROPERTIES COMPILE_FLAGS ${EXTERNAL_CXX_FLAGS})
+    endif()
+
+    astc_set_properties(bench-kernels-${ISA_SIMD})
+
+    target_link_libraries(bench-kernels-${ISA_SIMD}
+        PRIVATE
+            astc${CODEC}-${ISA_SIMD}-static)
+
+    install(TARGETS bench-kernels-${ISA_SIMD} DESTINATION ${PACKAGE_ROOT})
+endif()
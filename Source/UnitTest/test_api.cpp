@@ -0,0 +1,492 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Unit tests for the public codec API.
+ *
+ * These tests use small synthetic images, and drive multi-threaded contexts
+ * from a single test thread so that the order in which the compressing
+ * threads arrive is deterministic.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../astcenc.h"
+
+namespace astcenc
+{
+
+static const astcenc_swizzle swz_rgba {
+	ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A
+};
+
+/**
+ * @brief A synthetic RGBA8 test image, and its storage.
+ */
+struct test_image
+{
+	std::vector<uint8_t> texels;
+	void* slice;
+	astcenc_image image {};
+
+	test_image(unsigned int dim_x, unsigned int dim_y, unsigned int seed = 0)
+		: texels(dim_x * dim_y * 4)
+	{
+		// Gradients with some high frequency detail, so that blocks need a
+		// mix of encodings and the averages are not uniform
+		for (unsigned int y = 0; y < dim_y; y++)
+		{
+			for (unsigned int x = 0; x < dim_x; x++)
+			{
+				uint8_t* texel = texels.data() + (y * dim_x + x) * 4;
+				texel[0] = static_cast<uint8_t>(x * 4 + seed);
+				texel[1] = static_cast<uint8_t>(y * 4 + seed * 3);
+				texel[2] = static_cast<uint8_t>(((x ^ y) & 8) ? 220 : 30);
+				texel[3] = static_cast<uint8_t>(255 - ((x * y + seed) & 63));
+			}
+		}
+
+		slice = texels.data();
+		image.dim_x = dim_x;
+		image.dim_y = dim_y;
+		image.dim_z = 1;
+		image.data_type = ASTCENC_TYPE_U8;
+		image.data = &slice;
+	}
+};
+
+/**
+ * @brief Get the compressed data size of an image, in bytes.
+ */
+static size_t compressed_size(
+	const astcenc_config& config,
+	const astcenc_image& image
+) {
+	size_t blocks_x = (image.dim_x + config.block_x - 1) / config.block_x;
+	size_t blocks_y = (image.dim_y + config.block_y - 1) / config.block_y;
+	size_t blocks_z = (image.dim_z + config.block_z - 1) / config.block_z;
+	return blocks_x * blocks_y * blocks_z * 16;
+}
+
+/**
+ * @brief Create a 6x6 LDR config, with averages enabled if requested.
+ */
+static astcenc_config make_config(
+	bool use_averages,
+	float quality = ASTCENC_PRE_MEDIUM
+) {
+	astcenc_config config;
+	astcenc_error status = astcenc_config_init(
+	    ASTCENC_PRF_LDR, 6, 6, 1, quality, 0, config);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+
+	if (use_averages)
+	{
+		config.a_scale_radius = 2;
+	}
+
+	return config;
+}
+
+/**
+ * @brief Compress an image with a single threaded context.
+ */
+static std::vector<uint8_t> compress_reference(
+	const astcenc_config& config,
+	astcenc_image& image
+) {
+	std::vector<uint8_t> data(compressed_size(config, image));
+
+	astcenc_context* context;
+	EXPECT_EQ(astcenc_context_alloc(config, 1, &context), ASTCENC_SUCCESS);
+	EXPECT_EQ(astcenc_compress_image(context, image, swz_rgba,
+	                                 data.data(), data.size(), 0),
+	          ASTCENC_SUCCESS);
+	astcenc_context_free(context);
+
+	return data;
+}
+
+/**
+ * @brief The payload for the cancelling progress callback.
+ */
+struct cancel_payload
+{
+	astcenc_context* context;
+	bool armed;
+	unsigned int calls;
+};
+
+/**
+ * @brief Progress callback which cancels the compression at 10 percent, if armed.
+ */
+static void cancel_callback(float progress, void* payload)
+{
+	cancel_payload* cancel = static_cast<cancel_payload*>(payload);
+	cancel->calls++;
+	if (cancel->armed && progress >= 10.0f)
+	{
+		EXPECT_EQ(astcenc_compress_cancel(cancel->context), ASTCENC_SUCCESS);
+	}
+}
+
+/**
+ * @brief Test cancelling from the progress callback, and then reusing the context.
+ */
+static void test_cancel_and_reset(bool use_averages)
+{
+	test_image src(96, 96);
+	astcenc_config config = make_config(use_averages);
+	std::vector<uint8_t> ref = compress_reference(config, src.image);
+
+	cancel_payload cancel { nullptr, true, 0 };
+	config.progress_callback = cancel_callback;
+	config.progress_payload = &cancel;
+	ASSERT_EQ(astcenc_context_alloc(config, 2, &cancel.context), ASTCENC_SUCCESS);
+	astcenc_context* context = cancel.context;
+
+	// Every thread returns the cancellation, including one arriving late
+	std::vector<uint8_t> data(ref.size());
+	EXPECT_EQ(astcenc_compress_image(context, src.image, swz_rgba,
+	                                 data.data(), data.size(), 0),
+	          ASTCENC_ERR_CANCELLED);
+	EXPECT_EQ(astcenc_compress_image(context, src.image, swz_rgba,
+	                                 data.data(), data.size(), 1),
+	          ASTCENC_ERR_CANCELLED);
+	EXPECT_GT(cancel.calls, 0u);
+
+	// After a reset the context must produce the same output as a fresh one
+	cancel.armed = false;
+	EXPECT_EQ(astcenc_compress_reset(context), ASTCENC_SUCCESS);
+	EXPECT_EQ(astcenc_compress_image(context, src.image, swz_rgba,
+	                                 data.data(), data.size(), 0),
+	          ASTCENC_SUCCESS);
+	EXPECT_EQ(astcenc_compress_image(context, src.image, swz_rgba,
+	                                 data.data(), data.size(), 1),
+	          ASTCENC_SUCCESS);
+	EXPECT_EQ(data, ref);
+
+	astcenc_context_free(context);
+}
+
+// Compression tests - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+/** @brief Test a thread which arrives after all the work has completed. */
+TEST(compress, LateJoiningThread)
+{
+	test_image src(64, 64);
+	astcenc_config config = make_config(true);
+	std::vector<uint8_t> ref = compress_reference(config, src.image);
+
+	astcenc_context* context;
+	ASSERT_EQ(astcenc_context_alloc(config, 2, &context), ASTCENC_SUCCESS);
+
+	// Thread 0 does all of the work and releases the jobs before thread 1
+	// arrives, so thread 1 must not touch the released compression state
+	std::vector<uint8_t> data(ref.size());
+	EXPECT_EQ(astcenc_compress_image(context, src.image, swz_rgba,
+	                                 data.data(), data.size(), 0),
+	          ASTCENC_SUCCESS);
+	EXPECT_EQ(astcenc_compress_image(context, src.image, swz_rgba,
+	                                 data.data(), data.size(), 1),
+	          ASTCENC_SUCCESS);
+	EXPECT_EQ(data, ref);
+
+	// The context must be reusable for the next image
+	std::vector<uint8_t> data2(ref.size());
+	EXPECT_EQ(astcenc_compress_reset(context), ASTCENC_SUCCESS);
+	EXPECT_EQ(astcenc_compress_image(context, src.image, swz_rgba,
+	                                 data2.data(), data2.size(), 1),
+	          ASTCENC_SUCCESS);
+	EXPECT_EQ(astcenc_compress_image(context, src.image, swz_rgba,
+	                                 data2.data(), data2.size(), 0),
+	          ASTCENC_SUCCESS);
+	EXPECT_EQ(data2, ref);
+
+	astcenc_context_free(context);
+}
+
+/** @brief Test cancelling from the progress callback, then resetting. */
+TEST(compress, CancelAndReset)
+{
+	test_cancel_and_reset(false);
+}
+
+/** @brief Test cancelling from the progress callback, then resetting, with averages. */
+TEST(compress, CancelAndResetAverages)
+{
+	test_cancel_and_reset(true);
+}
+
+/** @brief Test that zero components and pitches give the packed RGBA layout. */
+TEST(compress, ZeroLayoutIsPackedRGBA)
+{
+	test_image src(37, 13);
+	astcenc_config config = make_config(false);
+	std::vector<uint8_t> ref = compress_reference(config, src.image);
+
+	// The same layout, given explicitly
+	astcenc_image image = src.image;
+	image.components = 4;
+	image.row_pitch = 37 * 4;
+	image.slice_pitch = 37 * 13 * 4;
+	EXPECT_EQ(compress_reference(config, image), ref);
+}
+
+/** @brief Test that batch compression matches compressing each image separately. */
+TEST(compress_batch, MatchesSeparateImages)
+{
+	for (bool use_averages : { false, true })
+	{
+		astcenc_config config = make_config(use_averages);
+
+		// Include images which are not a whole number of blocks
+		test_image src[3] {
+			test_image(64, 64, 0),
+			test_image(37, 13, 1),
+			test_image(6, 90, 2)
+		};
+
+		std::vector<uint8_t> ref[3];
+		std::vector<uint8_t> data[3];
+		astcenc_batch_image batch[3];
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			ref[i] = compress_reference(config, src[i].image);
+			data[i].resize(ref[i].size());
+			batch[i] = { &src[i].image, data[i].data(), data[i].size() };
+		}
+
+		astcenc_context* context;
+		ASSERT_EQ(astcenc_context_alloc(config, 2, &context), ASTCENC_SUCCESS);
+
+		for (unsigned int thread = 0; thread < 2; thread++)
+		{
+			EXPECT_EQ(astcenc_compress_image_batch(context, batch, 3, swz_rgba, thread),
+			          ASTCENC_SUCCESS);
+		}
+
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			EXPECT_EQ(data[i], ref[i]) << "image " << i << ", averages " << use_averages;
+		}
+
+		astcenc_context_free(context);
+	}
+}
+
+/** @brief Test the batch compression argument checks. */
+TEST(compress_batch, BadArguments)
+{
+	astcenc_config config = make_config(false);
+	test_image src[2] {
+		test_image(64, 64, 0),
+		test_image(37, 13, 1)
+	};
+
+	std::vector<uint8_t> data[2];
+	astcenc_batch_image batch[2];
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		data[i].resize(compressed_size(config, src[i].image));
+		batch[i] = { &src[i].image, data[i].data(), data[i].size() };
+	}
+
+	astcenc_context* context;
+	ASSERT_EQ(astcenc_context_alloc(config, 1, &context), ASTCENC_SUCCESS);
+
+	// An output buffer which is too small for one of the images
+	batch[1].data_len -= 16;
+	EXPECT_EQ(astcenc_compress_image_batch(context, batch, 2, swz_rgba, 0),
+	          ASTCENC_ERR_OUT_OF_MEM);
+	batch[1].data_len += 16;
+
+	// An empty batch, or a thread index outside of the context
+	EXPECT_EQ(astcenc_compress_image_batch(context, batch, 0, swz_rgba, 0),
+	          ASTCENC_ERR_BAD_PARAM);
+	EXPECT_EQ(astcenc_compress_image_batch(context, batch, 2, swz_rgba, 1),
+	          ASTCENC_ERR_BAD_PARAM);
+
+	// An image with no texels
+	src[1].image.dim_y = 0;
+	EXPECT_EQ(astcenc_compress_image_batch(context, batch, 2, swz_rgba, 0),
+	          ASTCENC_ERR_BAD_PARAM);
+	src[1].image.dim_y = 13;
+
+	// A swizzle which is not valid for compression
+	astcenc_swizzle swz_bad { ASTCENC_SWZ_Z, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A };
+	EXPECT_EQ(astcenc_compress_image_batch(context, batch, 2, swz_bad, 0),
+	          ASTCENC_ERR_BAD_SWIZZLE);
+
+	// The failed calls must not have started a compression
+	EXPECT_EQ(astcenc_compress_image_batch(context, batch, 2, swz_rgba, 0),
+	          ASTCENC_SUCCESS);
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		EXPECT_EQ(data[i], compress_reference(config, src[i].image));
+	}
+
+	astcenc_context_free(context);
+}
+
+// Decompression tests - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+/**
+ * @brief Test decompressing regions of an image against a full decompression.
+ *
+ * @param data_type   The output data type.
+ * @param swizzle     The decompression swizzle.
+ */
+static void test_decompress_region(
+	astcenc_type data_type,
+	const astcenc_swizzle& swizzle
+) {
+	test_image src(64, 50);
+	astcenc_config config = make_config(false, ASTCENC_PRE_FAST);
+	std::vector<uint8_t> comp = compress_reference(config, src.image);
+
+	size_t texel_size = 4 * (data_type == ASTCENC_TYPE_U8 ? 1 : (data_type == ASTCENC_TYPE_F16 ? 2 : 4));
+	size_t row_pitch = (src.image.dim_x + config.block_x - 1) / config.block_x;
+	size_t slice_pitch = row_pitch * ((src.image.dim_y + config.block_y - 1) / config.block_y);
+
+	astcenc_context* context;
+	ASSERT_EQ(astcenc_context_alloc(config, 1, &context), ASTCENC_SUCCESS);
+
+	std::vector<uint8_t> full(src.image.dim_x * src.image.dim_y * texel_size);
+	void* full_slice = full.data();
+	astcenc_image full_image {};
+	full_image.dim_x = src.image.dim_x;
+	full_image.dim_y = src.image.dim_y;
+	full_image.dim_z = 1;
+	full_image.data_type = data_type;
+	full_image.data = &full_slice;
+	EXPECT_EQ(astcenc_decompress_image(context, comp.data(), comp.size(), full_image, swizzle, 0),
+	          ASTCENC_SUCCESS);
+
+	// Windows with unaligned edges, including ones which end at the image edge
+	// and ones which are entirely inside a single block
+	const unsigned int windows[][4] {
+		{ 7, 5, 29, 23 },
+		{ 0, 0, 13, 1 },
+		{ 41, 31, 23, 19 },
+		{ 62, 49, 2, 1 },
+		{ 13, 14, 3, 3 }
+	};
+
+	for (const auto& window : windows)
+	{
+		unsigned int origin_x = window[0];
+		unsigned int origin_y = window[1];
+		unsigned int dim_x = window[2];
+		unsigned int dim_y = window[3];
+
+		std::vector<uint8_t> region(dim_x * dim_y * texel_size);
+		void* region_slice = region.data();
+		astcenc_image region_image {};
+		region_image.dim_x = dim_x;
+		region_image.dim_y = dim_y;
+		region_image.dim_z = 1;
+		region_image.data_type = data_type;
+		region_image.data = &region_slice;
+
+		EXPECT_EQ(astcenc_decompress_reset(context), ASTCENC_SUCCESS);
+		EXPECT_EQ(astcenc_decompress_image_region(context, comp.data(), comp.size(),
+		                                          row_pitch, slice_pitch,
+		                                          origin_x, origin_y, 0,
+		                                          region_image, swizzle, 0),
+		          ASTCENC_SUCCESS);
+
+		for (unsigned int y = 0; y < dim_y; y++)
+		{
+			const uint8_t* expect = full.data() + ((origin_y + y) * src.image.dim_x + origin_x) * texel_size;
+			const uint8_t* actual = region.data() + y * dim_x * texel_size;
+			EXPECT_EQ(memcmp(expect, actual, dim_x * texel_size), 0)
+			    << "window " << origin_x << "," << origin_y << " "
+			    << dim_x << "x" << dim_y << ", row " << y;
+		}
+	}
+
+	astcenc_context_free(context);
+}
+
+/** @brief Test decompressing unaligned regions to U8, which uses the LDR fast path. */
+TEST(decompress_region, UnalignedU8)
+{
+	test_decompress_region(ASTCENC_TYPE_U8, swz_rgba);
+}
+
+/** @brief Test decompressing unaligned regions to U8 with a swizzle. */
+TEST(decompress_region, UnalignedU8Swizzle)
+{
+	astcenc_swizzle swizzle { ASTCENC_SWZ_B, ASTCENC_SWZ_G, ASTCENC_SWZ_R, ASTCENC_SWZ_1 };
+	test_decompress_region(ASTCENC_TYPE_U8, swizzle);
+}
+
+/** @brief Test decompressing unaligned regions to F16. */
+TEST(decompress_region, UnalignedF16)
+{
+	test_decompress_region(ASTCENC_TYPE_F16, swz_rgba);
+}
+
+/** @brief Test decompressing unaligned regions to F32. */
+TEST(decompress_region, UnalignedF32)
+{
+	test_decompress_region(ASTCENC_TYPE_F32, swz_rgba);
+}
+
+/** @brief Test the region decompression argument checks. */
+TEST(decompress_region, BadArguments)
+{
+	test_image src(64, 50);
+	astcenc_config config = make_config(false, ASTCENC_PRE_FAST);
+	std::vector<uint8_t> comp = compress_reference(config, src.image);
+
+	astcenc_context* context;
+	ASSERT_EQ(astcenc_context_alloc(config, 1, &context), ASTCENC_SUCCESS);
+
+	std::vector<uint8_t> region(16 * 16 * 4);
+	void* region_slice = region.data();
+	astcenc_image region_image {};
+	region_image.dim_x = 16;
+	region_image.dim_y = 16;
+	region_image.dim_z = 1;
+	region_image.data_type = ASTCENC_TYPE_U8;
+	region_image.data = &region_slice;
+
+	// A region which ends beyond the compressed row pitch
+	EXPECT_EQ(astcenc_decompress_image_region(context, comp.data(), comp.size(), 11, 99,
+	                                          60, 0, 0, region_image, swz_rgba, 0),
+	          ASTCENC_ERR_BAD_PARAM);
+
+	// A region which ends beyond the compressed data
+	EXPECT_EQ(astcenc_decompress_image_region(context, comp.data(), comp.size() - 16, 11, 99,
+	                                          48, 34, 0, region_image, swz_rgba, 0),
+	          ASTCENC_ERR_OUT_OF_MEM);
+
+	// A thread index outside of the context
+	EXPECT_EQ(astcenc_decompress_image_region(context, comp.data(), comp.size(), 11, 99,
+	                                          0, 0, 0, region_image, swz_rgba, 1),
+	          ASTCENC_ERR_BAD_PARAM);
+
+	astcenc_context_free(context);
+}
+
+}
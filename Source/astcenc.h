@@ -43,9 +43,9 @@
  *       allocate multiple contexts and assign each context to a thread.
  *     * An application wishing to process a single image in using multiple
  *       threads can configure the context for multi-threaded use, and invoke
- *       astcenc_compress() once per thread for faster compression. The caller
- *       is responsible for creating the worker threads. Note that
- *       decompression is always single-threaded.
+ *       astcenc_compress_image() or astcenc_decompress_image() once per
+ *       thread for faster processing. The caller is responsible for creating
+ *       the worker threads.
  *
  * Threading
  * =========
@@ -70,6 +70,14 @@
  *
  *         astcenc_compress_reset(my_context);
  *
+ *     // Decompress each image using these config settings
+ *     foreach image:
+ *         // For each thread in the thread pool
+ *         for i in range(0, thread_count):
+ *             astcenc_decompress_image(my_context, my_input, &my_output, i);
+ *
+ *         astcenc_decompress_reset(my_context);
+ *
  *     // Clean up
  *     astcenc_context_free(my_context);
  *
@@ -83,15 +91,28 @@
  * Images can be any dimension; there is no requirement for them to be a
  * multiple of the ASTC block size.
  *
- * Data is always passed in as 4 color channels, and accessed as an array of
- * 2D image slices. Data within an image slice is always tightly packed without
- * padding. Addresing looks like this:
+ * Data is passed in with 1 to 4 color channels, and accessed as an array of
+ * 2D image slices. By default data uses 4 channels and is tightly packed
+ * without padding. Addressing looks like this:
  *
  *     data[z_coord][y_coord * x_dim * 4 + x_coord * 4    ]   // Red
  *     data[z_coord][y_coord * x_dim * 4 + x_coord * 4 + 1]   // Green
  *     data[z_coord][y_coord * x_dim * 4 + x_coord * 4 + 2]   // Blue
  *     data[z_coord][y_coord * x_dim * 4 + x_coord * 4 + 3]   // Alpha
  *
+ * Images with fewer channels, padded rows, or slices in a single allocation
+ * can be used directly by setting the components, row_pitch, and slice_pitch
+ * fields. Pitches are in bytes, and must be a multiple of the channel data type
+ * size. Addressing then looks like this:
+ *
+ *     uint8_t* slice = slice_pitch ? data[0] + z_coord * slice_pitch
+ *                                  : data[z_coord];
+ *     uint8_t* row = slice + y_coord * row_pitch;
+ *     T* texel = (T*)row + x_coord * components;
+ *
+ * Missing channels are read as zero for red, green, and blue, and one for
+ * alpha, and are discarded when writing a decompressed image.
+ *
  * Common compressor usage
  * =======================
  *
@@ -181,6 +202,8 @@ enum astcenc_error {
 	ASTCENC_ERR_BAD_CONTEXT,
 	/** @brief The call failed due to unimplemented functionality. */
 	ASTCENC_ERR_NOT_IMPLEMENTED,
+	/** @brief The call was cancelled by astcenc_compress_cancel(). */
+	ASTCENC_ERR_CANCELLED,
 #if defined(ASTCENC_DIAGNOSTICS)
 	/** @brief The call failed due to an issue with diagnostic tracing. */
 	ASTCENC_ERR_DTRACE_FAILURE,
@@ -319,6 +342,57 @@ static const unsigned int ASTCENC_FLG_DECOMPRESS_ONLY      = 1 << 4;
  */
 static const unsigned int ASTCENC_FLG_SELF_DECOMPRESS_ONLY = 1 << 5;
 
+/**
+ * @brief Retain compression scratch memory between images.
+ *
+ * By default the transient memory needed to compress an image is allocated
+ * at the start of each compression, and freed at the end of it. Setting this
+ * flag retains this memory in the context, growing it only if a later image
+ * needs more, so steady-state compression of many similarly sized images does
+ * not allocate memory. The memory is freed when the context is freed.
+ */
+static const unsigned int ASTCENC_FLG_PERSISTENT_SCRATCH   = 1 << 6;
+
+/**
+ * @brief Enable the duplicate block cache.
+ *
+ * Blocks with bit-identical input data reuse the encoding of the first such
+ * block compressed, rather than repeating the full compressor search. This
+ * speeds up images with many repeated blocks, such as texture atlases, but has
+ * a small overhead for images without them. The cache is not used if error
+ * weighting uses regional averages or variances, or if the image is compressed
+ * with a hint, as these make the encoding dependent on block position.
+ */
+static const unsigned int ASTCENC_FLG_USE_BLOCK_CACHE      = 1 << 7;
+
+/**
+ * @brief Enable adaptive effort compression.
+ *
+ * This flag is experimental, and its behavior may change in later releases.
+ *
+ * Each block is first compressed using the search limits and block modes of
+ * the fastest preset, but with the configured dB limit as its quality target.
+ * Only blocks which miss the target are compressed again using the configured
+ * search limits, keeping the encoding with the lower error.
+ *
+ * This is only faster if most blocks can meet the dB limit with the fastest
+ * search, so is intended for use with an explicitly lowered dB limit. The
+ * dB limits of the built-in presets are rarely met by most blocks, and so
+ * are slower with this flag set. Blocks which are accepted by the first pass
+ * only just meet the target, so image quality is lower than using the
+ * configured search limits for every block.
+ */
+static const unsigned int ASTCENC_FLG_ADAPTIVE_EFFORT      = 1 << 8;
+
+/**
+ * @brief Collect per-block timing statistics.
+ *
+ * By default the @c fetch_time_ns and @c compress_time_ns statistics are not
+ * collected, as reading the clock twice per block has a measurable cost for
+ * the fast search presets. Setting this flag enables their collection.
+ */
+static const unsigned int ASTCENC_FLG_COLLECT_TIMINGS      = 1 << 9;
+
 /**
  * @brief The bit mask of all valid flags.
  */
@@ -328,7 +402,19 @@ static const unsigned int ASTCENC_ALL_FLAGS =
                               ASTCENC_FLG_USE_ALPHA_WEIGHT |
                               ASTCENC_FLG_USE_PERCEPTUAL |
                               ASTCENC_FLG_DECOMPRESS_ONLY |
-                              ASTCENC_FLG_SELF_DECOMPRESS_ONLY;
+                              ASTCENC_FLG_SELF_DECOMPRESS_ONLY |
+                              ASTCENC_FLG_PERSISTENT_SCRATCH |
+                              ASTCENC_FLG_USE_BLOCK_CACHE |
+                              ASTCENC_FLG_ADAPTIVE_EFFORT |
+                              ASTCENC_FLG_COLLECT_TIMINGS;
+
+/**
+ * @brief A compression progress callback.
+ *
+ * @param progress   The percentage of the compression which has completed.
+ * @param payload    The payload from the config.
+ */
+typedef void (*astcenc_progress_callback)(float progress, void* payload);
 
 /**
  * @brief The config structure.
@@ -449,7 +535,8 @@ struct astcenc_config {
 	/**
 	 * @brief The dB threshold for stopping block search (-dblimit).
 	 *
-	 * This option is ineffective for HDR textures.
+	 * For HDR textures the limit is converted to an equivalent error in LNS
+	 * space, where 0 dB corresponds to an error of four stops.
 	 */
 	float tune_db_limit;
 
@@ -491,6 +578,59 @@ struct astcenc_config {
 	 */
 	float tune_two_plane_early_out_limit;
 
+	/**
+	 * @brief The threshold for skipping more precise weight encodings.
+	 *
+	 * Block modes are searched in increasing weight precision for each weight
+	 * grid. Once a more precise weight encoding reduces the weight error by
+	 * less than this fraction of the block error target, the more precise
+	 * encodings of that grid are skipped. Zero disables the early out. It is
+	 * always disabled for 3D blocks, where it costs significant image quality.
+	 */
+	float tune_weight_converged_fraction;
+
+	/**
+	 * @brief The target time for each compression, in milliseconds (-budget).
+	 *
+	 * If non-zero the compressor adapts the partition, candidate, and
+	 * refinement limits while compressing, based on its measured progress, to
+	 * give the best quality which fits in the time budget. The limits set in
+	 * this structure give the highest effort used. The block mode limit is
+	 * fixed when the context is created, so is not adapted. Compression using
+	 * a time budget is not deterministic.
+	 */
+	float tune_time_budget;
+
+	/**
+	 * @brief The rate-distortion trade-off for entropy coded output (-rdo).
+	 *
+	 * If non-zero each block may reuse the encoding, or the endpoints or
+	 * weights, of the previous blocks in its row, so the output compresses
+	 * better with an LZ-based entropy coder such as deflate or zstd. Each
+	 * encoding is scored by its error plus a rate cost for the bytes which
+	 * do not repeat a neighbor, where reusing a neighbor in full is accepted
+	 * if its error is at most (1 + lambda) times the lowest error. Higher
+	 * values give smaller coded output and lower image quality. Blocks in
+	 * each row are compressed in order by one thread, and the duplicate
+	 * block cache is not used.
+	 */
+	float tune_rdo_lambda;
+
+	/**
+	 * @brief The optional compression progress callback.
+	 *
+	 * If not @c nullptr this is called with the percentage of each compression
+	 * which has completed. It is called by the compressing threads, but only
+	 * by one thread at a time, at most once per percent of progress, and with
+	 * increasing values. A final call is made at 100 percent unless the
+	 * compression is cancelled. The calling thread does no compression work
+	 * until the callback returns, so it should return quickly.
+	 */
+	astcenc_progress_callback progress_callback;
+
+	/** @brief The payload passed to the progress callback. */
+	void* progress_payload;
+
 #if defined(ASTCENC_DIAGNOSTICS)
 	/**
 	 * @brief The path to save the diagnostic trace data to.
@@ -507,6 +647,12 @@ struct astcenc_config {
  *
  * 3D image are passed in as an array of 2D slices. Each slice has identical
  * size and color format.
+ *
+ * The @c components, @c row_pitch, and @c slice_pitch fields were added in
+ * the 2.5 release. Setting them to zero gives the tightly packed RGBA layout
+ * used by earlier releases. Callers must initialize them; code written for
+ * earlier releases which sets each field of an uninitialized structure must
+ * be updated to value-initialize it, for example as @c astcenc_image @c img{}.
  */
 struct astcenc_image {
 	/** @brief The X dimension of the image, in texels. */
@@ -517,10 +663,112 @@ struct astcenc_image {
 	unsigned int dim_z;
 	/** @brief The data type per channel. */
 	astcenc_type data_type;
-	/** @brief The array of 2D slices, of length dim_z. */
+	/**
+	 * @brief The array of 2D slices, of length dim_z.
+	 *
+	 * If @c slice_pitch is non-zero only the first entry is used.
+	 */
 	void** data;
+	/** @brief The number of channels per texel, 1-4, or 0 for 4 (RGBA). */
+	unsigned int components;
+	/** @brief The row pitch in bytes, or 0 for tightly packed rows. */
+	size_t row_pitch;
+	/** @brief The slice pitch in bytes, or 0 to use a @c data entry per slice. */
+	size_t slice_pitch;
 };
 
+/**
+ * @brief An image and output buffer pair for batch compression.
+ */
+struct astcenc_batch_image {
+	/** @brief The input image. */
+	astcenc_image* image;
+	/** @brief The output data array for this image. */
+	uint8_t* data_out;
+	/** @brief The length of the output data array. */
+	size_t data_len;
+};
+
+/**
+ * @brief A block-aligned region of an image.
+ *
+ * All coordinates and dimensions are specified in units of whole blocks.
+ */
+struct astcenc_block_region {
+	/** @brief The X origin of the region, in blocks. */
+	unsigned int origin_x;
+	/** @brief The Y origin of the region, in blocks. */
+	unsigned int origin_y;
+	/** @brief The Z origin of the region, in blocks. */
+	unsigned int origin_z;
+	/** @brief The X dimension of the region, in blocks. */
+	unsigned int dim_x;
+	/** @brief The Y dimension of the region, in blocks. */
+	unsigned int dim_y;
+	/** @brief The Z dimension of the region, in blocks. */
+	unsigned int dim_z;
+};
+
+/**
+ * @brief Compression statistics, accumulated over the lifetime of a context.
+ *
+ * Each block is counted under exactly one exit point, which records the
+ * search pass that terminated the compressor search for that block. Blocks
+ * compressed again by adaptive effort compression are counted for each search. Times
+ * are the sum over all compression threads, in nanoseconds.
+ */
+struct astcenc_stats {
+	/** @brief The number of blocks compressed, including cached blocks. */
+	uint64_t block_count;
+	/** @brief The number of blocks reused from the duplicate block cache. */
+	uint64_t cache_hit_count;
+	/** @brief The number of blocks reusing part of a neighbor encoding. */
+	uint64_t rdo_reuse_count;
+	/** @brief The number of blocks reused from a previous incremental compression. */
+	uint64_t unchanged_block_count;
+	/** @brief The number of blocks compressed again by adaptive effort compression. */
+	uint64_t adaptive_retry_count;
+	/** @brief The number of blocks encoded as a constant color. */
+	uint64_t exit_constant_count;
+	/** @brief The number of blocks meeting the target with the configuration of the hint block. */
+	uint64_t exit_hint_count;
+	/** @brief The number of blocks meeting the target with 1 partition and 1 plane. */
+	uint64_t exit_1_plane_count;
+	/** @brief The number of blocks meeting the target with 1 partition and 2 planes. */
+	uint64_t exit_2_plane_count;
+	/** @brief The number of blocks meeting the target with 2, 3, or 4 partitions. */
+	uint64_t exit_partition_count[3];
+	/** @brief The number of blocks stopped by the 3+ partition early out. */
+	uint64_t exit_partition_early_out_count;
+	/** @brief The number of blocks which never met the target. */
+	uint64_t exit_full_search_count;
+	/** @brief The number of block modes evaluated for candidate encodings. */
+	uint64_t block_modes_evaluated;
+	/** @brief The number of endpoint and weight refinement iterations. */
+	uint64_t refinement_iterations;
+	/** @brief The time spent computing averages and variances. */
+	uint64_t avg_var_time_ns;
+	/** @brief The time spent fetching image blocks, if ASTCENC_FLG_COLLECT_TIMINGS is set. */
+	uint64_t fetch_time_ns;
+	/** @brief The time spent compressing image blocks, if ASTCENC_FLG_COLLECT_TIMINGS is set. */
+	uint64_t compress_time_ns;
+};
+
+/* ============================================================================
+    Functional interface
+============================================================================ */
+
+/*
+ * Builds which link several ISA variants of the codec into one library compile
+ * each variant in its own namespace, with a dispatch layer providing these
+ * functions in the global namespace.
+ */
+#if defined(ASTCENC_DISPATCH_NAMESPACE)
+namespace ASTCENC_DISPATCH_NAMESPACE {
+
+struct astcenc_context;
+#endif
+
 /**
  * Populate a codec config based on default settings.
  *
@@ -558,15 +806,17 @@ astcenc_error astcenc_config_init(
  * to serially compress or decompress multiple images to amortize setup cost.
  *
  * Contexts can be allocated to support only decompression by setting the
- * ASTCENC_FLG_DECOMPRESS_ONLY flag when creating the configuration. These
- * contexts must be allocated with a thread count of 1 (decompression is always
- * single threaded), and the compression functions will fail if invoked. For
+ * ASTCENC_FLG_DECOMPRESS_ONLY flag when creating the configuration. The
+ * compression functions will fail if invoked on these contexts. For
  * a decompress-only library build the ASTCENC_FLG_DECOMPRESS_ONLY flag must
  * be set when creating ay context.
  *
+ * The per-thread compression working memory is not allocated here; each
+ * thread allocates its own the first time it compresses an image, so that on
+ * NUMA systems the memory is local to the thread which uses it.
+ *
  * @param[in]  config         Codec config.
- * @param      thread_count   Thread count to configure for. Decompress-only
- *                            contexts must have a thread_count of 1.
+ * @param      thread_count   Thread count to configure for.
  * @param[out] context        Location to store an opaque context pointer.
  *
  * @return ASTCENC_SUCCESS on success, or an error if context creation failed.
@@ -602,6 +852,168 @@ astcenc_error astcenc_compress_image(
 	size_t data_len,
 	unsigned int thread_index);
 
+/**
+ * @brief Compress a block-aligned region of an image.
+ *
+ * This behaves like astcenc_compress_image(), but only compresses the blocks
+ * inside @c region, writing them to a caller-provided buffer. Blocks are
+ * stored in row-major order, with @c row_pitch blocks between the start of
+ * each row of the region and @c row_pitch * region.dim_y blocks between the
+ * start of each Z slice.
+ *
+ * Only the input texels covered by the region, plus the texels inside the
+ * radius of any configured averaging kernels, are read from the input image.
+ * Other texels in the image do not need to be populated.
+ *
+ * This allows 3D images to be compressed as a stream of slabs, one block
+ * deep, without the whole volume being resident. For a slab at block Z
+ * coordinate @c k, only the slices from <tt>k * block_z - R</tt> up to
+ * <tt>(k + 1) * block_z + R</tt>, clamped to the image, are read, where @c R
+ * is the larger of @c v_rgba_radius and @c a_scale_radius in the config. The
+ * @c image must still have the full volume dimensions, but the pointers for
+ * all other slices may be @c nullptr. Working memory is sized by the region,
+ * so peak memory use does not depend on the depth of the volume.
+ *
+ * All threads compressing a region must pass the same region arguments. The
+ * compressor must be reset using astcenc_compress_reset() before compressing
+ * the next region.
+ *
+ * @param         context        Codec context.
+ * @param[in,out] image          An input image, in 2D slices.
+ * @param         swizzle        Compression data swizzle.
+ * @param         region         The block region to compress.
+ * @param[out]    data_out       Pointer to output data array.
+ * @param         data_len       Length of the output data array.
+ * @param         row_pitch      Output row pitch, in blocks.
+ * @param         thread_index   Thread index [0..N-1] of calling thread.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+astcenc_error astcenc_compress_image_region(
+	astcenc_context* context,
+	astcenc_image& image,
+	astcenc_swizzle swizzle,
+	const astcenc_block_region& region,
+	uint8_t* data_out,
+	size_t data_len,
+	size_t row_pitch,
+	unsigned int thread_index);
+
+/**
+ * @brief Compress a batch of images.
+ *
+ * This behaves like calling astcenc_compress_image() for each image in the
+ * batch, but the blocks of all images are processed as a single pool of work.
+ * Threads therefore do not need to synchronize between images, which is
+ * important for effective multi-threading of small images. All images must
+ * use the same swizzle.
+ *
+ * All threads compressing a batch must pass the same batch arguments, and the
+ * batch array must remain valid until all threads have returned. The
+ * compressor must be reset using astcenc_compress_reset() before compressing
+ * the next image or batch.
+ *
+ * @param     context        Codec context.
+ * @param[in] batch          The array of images and output buffers.
+ * @param     batch_size     The number of entries in the batch array.
+ * @param     swizzle        Compression data swizzle.
+ * @param     thread_index   Thread index [0..N-1] of calling thread.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+astcenc_error astcenc_compress_image_batch(
+	astcenc_context* context,
+	const astcenc_batch_image* batch,
+	unsigned int batch_size,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index);
+
+/**
+ * @brief Compress an image, reusing the unchanged blocks of a previous compression.
+ *
+ * This behaves like astcenc_compress_image(), but each block whose input
+ * texels are identical in @c image and @c prev_image copies its encoding from
+ * @c prev_data rather than being compressed again. This makes recompressing an
+ * image after a small edit much faster. Texels inside the radius of any
+ * configured averaging kernels are included in the comparison, as they also
+ * affect the encoding of the block.
+ *
+ * The previous data must have been compressed from @c prev_image by a context
+ * using the same config, otherwise the reused blocks will not match a full
+ * compression. With rate-distortion optimization, or with a time budget, the
+ * encoding of a block also depends on other blocks, so a full compression of
+ * the new image may differ from the result for unchanged blocks. Averages and
+ * variances are computed using summed-area tables, so changed texels can also
+ * perturb the rounding of the error weights of blocks outside the kernel
+ * radius; in this case the reused encodings are equivalent, but not always
+ * bit-identical, to those of a full compression.
+ *
+ * The images must have the same dimensions, data type, and component count,
+ * but may use different pitches. The previous data may alias the output data
+ * to update an image in place.
+ *
+ * @param         context         Codec context.
+ * @param[in,out] image           The new input image, in 2D slices.
+ * @param         prev_image      The previous input image, in 2D slices.
+ * @param[in]     prev_data       The previous compressed data.
+ * @param         prev_data_len   Length of the previous compressed data.
+ * @param         swizzle         Compression data swizzle.
+ * @param[out]    data_out        Pointer to output data array.
+ * @param         data_len        Length of the output data array.
+ * @param         thread_index    Thread index [0..N-1] of calling thread.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+astcenc_error astcenc_compress_image_incremental(
+	astcenc_context* context,
+	astcenc_image& image,
+	const astcenc_image& prev_image,
+	const uint8_t* prev_data,
+	size_t prev_data_len,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index);
+
+/**
+ * @brief Compress an image, starting the search of each block from a hint encoding.
+ *
+ * This behaves like astcenc_compress_image(), but the search for each block
+ * first tests the block mode and partitioning of the block at the same
+ * position in @c hint_data, with new endpoints and weights. If this meets the
+ * quality target the rest of the search is skipped. This is intended for
+ * sequences of similar images, such as video frames, animation flipbooks, or
+ * the slices of a texture array, where the hint is the compressed data of the
+ * previous image. A poor hint costs only a small amount of extra search time,
+ * and constant color or invalid hint blocks are ignored.
+ *
+ * The result depends on the hint, so it is not identical to the result of
+ * astcenc_compress_image(), but it meets the same quality target for each
+ * block that reaches the target using the hint configuration. The hint data
+ * may alias the output data to update an image in place. The duplicate block
+ * cache is not used, as each block is compressed using its own hint.
+ *
+ * @param         context         Codec context.
+ * @param[in,out] image           The input image, in 2D slices.
+ * @param[in]     hint_data       The hint compressed data, for the same image size.
+ * @param         hint_data_len   Length of the hint compressed data.
+ * @param         swizzle         Compression data swizzle.
+ * @param[out]    data_out        Pointer to output data array.
+ * @param         data_len        Length of the output data array.
+ * @param         thread_index    Thread index [0..N-1] of calling thread.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+astcenc_error astcenc_compress_image_hinted(
+	astcenc_context* context,
+	astcenc_image& image,
+	const uint8_t* hint_data,
+	size_t hint_data_len,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index);
+
 /**
  * @brief Reset the compressor state for a new compression.
  *
@@ -617,14 +1029,61 @@ astcenc_error astcenc_compress_image(
 astcenc_error astcenc_compress_reset(
 	astcenc_context* context);
 
+/**
+ * @brief Cancel the current compression.
+ *
+ * This can be called from any thread, including from the progress callback,
+ * while other threads are compressing an image. The compressing threads stop
+ * doing new work when they next request tasks, and every thread returns
+ * ASTCENC_ERR_CANCELLED once the compression has been wound down. The
+ * contents of the output data are undefined.
+ *
+ * The request remains set until astcenc_compress_reset() is called, after
+ * which the context can be used to compress another image.
+ *
+ * @param context   Codec context.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if the context is not a
+ * compression context.
+ */
+astcenc_error astcenc_compress_cancel(
+	astcenc_context* context);
+
+/**
+ * @brief Get the compression statistics for a context.
+ *
+ * Statistics are accumulated per thread, and merged into the context totals
+ * at the end of each compression. The returned values are totals for all
+ * compressions since the context was allocated.
+ *
+ * This function must only be called when no thread is compressing an image.
+ *
+ * @param      context   Codec context.
+ * @param[out] stats     The statistics to populate.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if the context is not a
+ * compression context.
+ */
+astcenc_error astcenc_get_stats(
+	astcenc_context* context,
+	astcenc_stats& stats);
+
 /**
  * @brief Decompress an image.
  *
- * @param         context      Codec context.
- * @param[in]     data         Pointer to compressed data.
- * @param         data_len     Length of the compressed data, in bytes.
- * @param[in,out] image_out    Output image.
- * @param         swizzle      Decompression data swizzle.
+ * A single context can only compress or decompress a single image at a time.
+ *
+ * For a context configured for multi-threading, any set of the N threads can
+ * call this function. Work will be dynamically scheduled across the threads
+ * available. Each thread must have a unique thread_index. The output image is
+ * only complete once all calling threads have returned.
+ *
+ * @param         context        Codec context.
+ * @param[in]     data           Pointer to compressed data.
+ * @param         data_len       Length of the compressed data, in bytes.
+ * @param[in,out] image_out      Output image.
+ * @param         swizzle        Decompression data swizzle.
+ * @param         thread_index   Thread index [0..N-1] of calling thread.
  *
  * @return ASTCENC_SUCCESS on success, or an error if decompression failed.
  */
@@ -633,7 +1092,69 @@ astcenc_error astcenc_decompress_image(
 	const uint8_t* data,
 	size_t data_len,
 	astcenc_image& image_out,
-	astcenc_swizzle swizzle);
+	astcenc_swizzle swizzle,
+	unsigned int thread_index);
+
+/**
+ * @brief Decompress a region of an image.
+ *
+ * This behaves like astcenc_decompress_image(), but only decompresses the
+ * blocks which cover a texel region of the encoded image. The region starts
+ * at texel @c origin_x, @c origin_y, @c origin_z of the encoded image, and
+ * has the same dimensions as @c image_out. The origin does not need to be
+ * block-aligned; texels of partially covered blocks which are outside of the
+ * region are discarded.
+ *
+ * The compressed data must contain the encoded image starting from its first
+ * block, stored with @c row_pitch blocks between the start of each row and
+ * @c slice_pitch blocks between the start of each Z slice. Only the blocks
+ * covering the region are read.
+ *
+ * All threads decompressing a region must pass the same region arguments.
+ * The decompressor must be reset using astcenc_decompress_reset() before
+ * decompressing the next image or region.
+ *
+ * @param         context        Codec context.
+ * @param[in]     data           Pointer to compressed data.
+ * @param         data_len       Length of the compressed data, in bytes.
+ * @param         row_pitch      Compressed data row pitch, in blocks.
+ * @param         slice_pitch    Compressed data slice pitch, in blocks.
+ * @param         origin_x       The X origin of the region, in texels.
+ * @param         origin_y       The Y origin of the region, in texels.
+ * @param         origin_z       The Z origin of the region, in texels.
+ * @param[in,out] image_out      Output image, sized to the region.
+ * @param         swizzle        Decompression data swizzle.
+ * @param         thread_index   Thread index [0..N-1] of calling thread.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if decompression failed.
+ */
+astcenc_error astcenc_decompress_image_region(
+	astcenc_context* context,
+	const uint8_t* data,
+	size_t data_len,
+	size_t row_pitch,
+	size_t slice_pitch,
+	unsigned int origin_x,
+	unsigned int origin_y,
+	unsigned int origin_z,
+	astcenc_image& image_out,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index);
+
+/**
+ * @brief Reset the decompressor state for a new decompression.
+ *
+ * The caller is responsible for synchronizing threads in the worker thread
+ * pool. This function must only be called when all threads have exited the
+ * astcenc_decompress_image() function for image N, but before any thread
+ * enters it for image N + 1.
+ *
+ * @param context   Codec context.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if reset failed.
+ */
+astcenc_error astcenc_decompress_reset(
+	astcenc_context* context);
 
 /**
  * Free the compressor context.
@@ -653,4 +1174,8 @@ void astcenc_context_free(
 const char* astcenc_get_error_string(
 	astcenc_error status);
 
+#if defined(ASTCENC_DISPATCH_NAMESPACE)
+}
+#endif
+
 #endif
@@ -32,6 +32,8 @@
 	#include <fenv.h>
 #endif
 
+ASTCENC_NAMESPACE_BEGIN
+
 // For a full block, functions to compute averages and dominant directions. The
 // averages and directions are computed separately for each partition.
 // We have separate versions for blocks with and without alpha, since the
@@ -827,4 +829,6 @@ void compute_error_squared_rgb(
 	*samec_errors = samec_errorsum;
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
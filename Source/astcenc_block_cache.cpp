@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+#if !defined(ASTCENC_DECOMPRESS_ONLY)
+
+/**
+ * @brief Functions for the duplicate block cache.
+ *
+ * Images such as texture atlases often contain many bit-identical blocks. The
+ * cache stores the encoding of each unique block input, keyed by a pair of
+ * independent 64-bit hashes of the block data, so later duplicates can reuse
+ * the encoding rather than repeating the full compressor search.
+ */
+
+#include "astcenc_internal.h"
+
+#include <cstring>
+#include <new>
+
+ASTCENC_NAMESPACE_BEGIN
+
+/**
+ * @brief The maximum number of block cache entries.
+ */
+static const unsigned int MAX_BLOCK_CACHE_ENTRIES = 1 << 20;
+
+/**
+ * @brief The maximum number of entries probed by a lookup or insert.
+ */
+static const unsigned int MAX_BLOCK_CACHE_PROBES = 16;
+
+/**
+ * @brief Accumulate a 32-bit value into a running 64-bit hash.
+ *
+ * @param hash   The current hash value.
+ * @param value  The value to add.
+ * @param mul    The hash multiplier, which must be odd.
+ *
+ * @return The updated hash value.
+ */
+static inline uint64_t hash_add(
+	uint64_t hash,
+	uint32_t value,
+	uint64_t mul
+) {
+	hash = (hash ^ value) * mul;
+	return hash ^ (hash >> 29);
+}
+
+/**
+ * @brief Get the raw bit pattern of a float.
+ */
+static inline uint32_t float_bits(
+	float value
+) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+/* Public function, see header file for detailed documentation */
+unsigned int get_block_cache_entry_count(
+	unsigned int block_count
+) {
+	// Size for a load factor of at most one half
+	unsigned int entry_count = 64;
+	while ((entry_count < 2 * block_count) && (entry_count < MAX_BLOCK_CACHE_ENTRIES))
+	{
+		entry_count <<= 1;
+	}
+
+	return entry_count;
+}
+
+/* Public function, see header file for detailed documentation */
+void init_block_cache(
+	block_cache& cache,
+	block_cache_entry* entries,
+	unsigned int entry_count
+) {
+	for (unsigned int i = 0; i < entry_count; i++)
+	{
+		block_cache_entry* entry = new (entries + i) block_cache_entry;
+		entry->hash0.store(0, std::memory_order_relaxed);
+		entry->ready.store(0, std::memory_order_relaxed);
+	}
+
+	cache.entries = entries;
+	cache.entry_mask = entry_count - 1;
+}
+
+/* Public function, see header file for detailed documentation */
+block_cache_key compute_block_cache_key(
+	const block_size_descriptor& bsd,
+	const imageblock& blk,
+	int valid_x,
+	int valid_y,
+	int valid_z
+) {
+	uint64_t hash0 = 0xcbf29ce484222325ULL;
+	uint64_t hash1 = 0x84222325cbf29ce4ULL;
+
+	const uint64_t mul0 = 0x100000001b3ULL;
+	const uint64_t mul1 = 0x9e3779b97f4a7c15ULL;
+
+	uint32_t extent = (valid_z << 16) | (valid_y << 8) | valid_x;
+	hash0 = hash_add(hash0, extent, mul0);
+	hash1 = hash_add(hash1, extent, mul1);
+
+	for (int i = 0; i < bsd.texel_count; i++)
+	{
+		uint32_t flags = (blk.rgb_lns[i] << 16) | (blk.alpha_lns[i] << 8) | blk.nan_texel[i];
+		uint32_t texel[5] {
+			float_bits(blk.data_r[i]),
+			float_bits(blk.data_g[i]),
+			float_bits(blk.data_b[i]),
+			float_bits(blk.data_a[i]),
+			flags
+		};
+
+		for (int j = 0; j < 5; j++)
+		{
+			hash0 = hash_add(hash0, texel[j], mul0);
+			hash1 = hash_add(hash1, texel[j], mul1);
+		}
+	}
+
+	// Zero marks an unused entry, so is never a valid hash
+	block_cache_key key;
+	key.hash0 = hash0 | 1;
+	key.hash1 = hash1;
+	return key;
+}
+
+/* Public function, see header file for detailed documentation */
+bool block_cache_lookup(
+	const block_cache& cache,
+	const block_cache_key& key,
+	physical_compressed_block& pcb
+) {
+	unsigned int index = (unsigned int)(key.hash0 >> 32);
+	for (unsigned int i = 0; i < MAX_BLOCK_CACHE_PROBES; i++)
+	{
+		const block_cache_entry& entry = cache.entries[(index + i) & cache.entry_mask];
+		uint64_t hash0 = entry.hash0.load(std::memory_order_relaxed);
+		if (hash0 == 0)
+		{
+			return false;
+		}
+
+		if (hash0 == key.hash0)
+		{
+			// An entry still being written is treated as a miss
+			if (!entry.ready.load(std::memory_order_acquire) || (entry.hash1 != key.hash1))
+			{
+				return false;
+			}
+
+			pcb = entry.pcb;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Public function, see header file for detailed documentation */
+void block_cache_insert(
+	block_cache& cache,
+	const block_cache_key& key,
+	const physical_compressed_block& pcb
+) {
+	unsigned int index = (unsigned int)(key.hash0 >> 32);
+	for (unsigned int i = 0; i < MAX_BLOCK_CACHE_PROBES; i++)
+	{
+		block_cache_entry& entry = cache.entries[(index + i) & cache.entry_mask];
+
+		// Claim the entry; only the thread which claims it writes the payload
+		uint64_t hash0 = 0;
+		if (entry.hash0.compare_exchange_strong(hash0, key.hash0, std::memory_order_relaxed))
+		{
+			entry.hash1 = key.hash1;
+			entry.pcb = pcb;
+			entry.ready.store(1, std::memory_order_release);
+			return;
+		}
+
+		// Another thread has already added this key
+		if (hash0 == key.hash0)
+		{
+			return;
+		}
+	}
+}
+
+ASTCENC_NAMESPACE_END
+
+#endif
@@ -21,6 +21,11 @@
 
 #include "astcenc_internal.h"
 
+#include <mutex>
+#include <new>
+
+ASTCENC_NAMESPACE_BEGIN
+
 // return 0 on invalid mode, 1 on valid mode.
 static int decode_block_mode_2d(
 	int blockmode,
@@ -229,12 +234,131 @@ static int decode_block_mode_3d(
 	return 1;
 }
 
-static void initialize_decimation_table_2d(
+/**
+ * @brief Allocate and populate a decimation table from its texel-weight mapping.
+ *
+ * The per-weight arrays are packed into the same allocation as the table, and
+ * are sized to the actual number of texel contributions for this weight grid.
+ *
+ * @param texel_count             The number of texels in the block.
+ * @param weight_count            The number of weights in the weight grid.
+ * @param weightcount_of_texel    The number of weights that contribute to each texel.
+ * @param grid_weights_of_texel   The weight indices that contribute to each texel.
+ * @param weights_of_texel        The contribution of each weight to each texel.
+ * @param texelcount_of_weight    The number of texels that each weight contributes to.
+ * @param texels_of_weight        The texel indices that each weight contributes to.
+ * @param texelweights_of_weight  The contribution of each weight to each of its texels.
+ *
+ * @return The new decimation table; the weight grid dimensions are not set.
+ */
+static decimation_table* construct_decimation_table(
+	int texel_count,
+	int weight_count,
+	const uint8_t weightcount_of_texel[MAX_TEXELS_PER_BLOCK],
+	const uint8_t grid_weights_of_texel[MAX_TEXELS_PER_BLOCK][4],
+	const uint8_t weights_of_texel[MAX_TEXELS_PER_BLOCK][4],
+	const uint8_t texelcount_of_weight[MAX_WEIGHTS_PER_BLOCK],
+	const uint8_t texels_of_weight[MAX_WEIGHTS_PER_BLOCK][MAX_TEXELS_PER_BLOCK],
+	const int texelweights_of_weight[MAX_WEIGHTS_PER_BLOCK][MAX_TEXELS_PER_BLOCK]
+) {
+	int entry_count = 0;
+	for (int i = 0; i < weight_count; i++)
+	{
+		entry_count += texelcount_of_weight[i];
+	}
+
+	// Widest elements first so every packed array is naturally aligned
+	size_t table_size = (sizeof(decimation_table) + ASTCENC_VECALIGN - 1) & ~(size_t)(ASTCENC_VECALIGN - 1);
+	size_t alloc_size = table_size + entry_count * (sizeof(float) * 5 + sizeof(uint8_t) * 5);
+
+	uint8_t* mem = aligned_malloc<uint8_t>(alloc_size, ASTCENC_VECALIGN);
+	decimation_table* dt = new (mem) decimation_table;
+
+	uint8_t* packed = mem + table_size;
+	dt->texel_weights_float_texel = reinterpret_cast<float(*)[4]>(packed);
+	packed += entry_count * sizeof(float) * 4;
+	dt->weights_flt = reinterpret_cast<float*>(packed);
+	packed += entry_count * sizeof(float);
+	dt->texel_weights_texel = reinterpret_cast<uint8_t(*)[4]>(packed);
+	packed += entry_count * sizeof(uint8_t) * 4;
+	dt->weight_texel = packed;
+
+	for (int i = 0; i < texel_count; i++)
+	{
+		dt->texel_weight_count[i] = weightcount_of_texel[i];
+
+		// Init all 4 entries so we can rely on zeros for vectorization
+		for (int j = 0; j < 4; j++)
+		{
+			dt->texel_weights_int_t4[i][j] = 0;
+			dt->texel_weights_float_t4[i][j] = 0.0f;
+			dt->texel_weights_t4[i][j] = 0;
+
+			dt->texel_weights_float_4t[j][i] = 0.0f;
+			dt->texel_weights_4t[j][i] = 0;
+		}
+
+		for (int j = 0; j < weightcount_of_texel[i]; j++)
+		{
+			dt->texel_weights_int_t4[i][j] = weights_of_texel[i][j];
+			dt->texel_weights_float_t4[i][j] = ((float)weights_of_texel[i][j]) * (1.0f / TEXEL_WEIGHT_SUM);
+			dt->texel_weights_t4[i][j] = grid_weights_of_texel[i][j];
+
+			dt->texel_weights_float_4t[j][i] = ((float)weights_of_texel[i][j]) * (1.0f / TEXEL_WEIGHT_SUM);
+			dt->texel_weights_4t[j][i] = grid_weights_of_texel[i][j];
+		}
+	}
+
+	int offset = 0;
+	for (int i = 0; i < weight_count; i++)
+	{
+		dt->weight_texel_count[i] = texelcount_of_weight[i];
+		dt->weight_texel_offset[i] = (uint16_t)offset;
+
+		for (int j = 0; j < texelcount_of_weight[i]; j++, offset++)
+		{
+			uint8_t texel = texels_of_weight[i][j];
+			dt->weight_texel[offset] = texel;
+			dt->weights_flt[offset] = (float)texelweights_of_weight[i][j];
+
+			// perform a layer of array unrolling. An aspect of this unrolling is that
+			// one of the texel-weight indexes is an identity-mapped index; we will use this
+			// fact to reorder the indexes so that the first one is the identity index.
+			int swap_idx = -1;
+			for (int k = 0; k < 4; k++)
+			{
+				uint8_t dttw = dt->texel_weights_t4[texel][k];
+				float dttwf = dt->texel_weights_float_t4[texel][k];
+				if (dttw == i && dttwf != 0.0f)
+				{
+					swap_idx = k;
+				}
+				dt->texel_weights_texel[offset][k] = dttw;
+				dt->texel_weights_float_texel[offset][k] = dttwf;
+			}
+
+			if (swap_idx != 0)
+			{
+				uint8_t vi = dt->texel_weights_texel[offset][0];
+				float vf = dt->texel_weights_float_texel[offset][0];
+				dt->texel_weights_texel[offset][0] = dt->texel_weights_texel[offset][swap_idx];
+				dt->texel_weights_float_texel[offset][0] = dt->texel_weights_float_texel[offset][swap_idx];
+				dt->texel_weights_texel[offset][swap_idx] = vi;
+				dt->texel_weights_float_texel[offset][swap_idx] = vf;
+			}
+		}
+	}
+
+	dt->texel_count = texel_count;
+	dt->weight_count = weight_count;
+	return dt;
+}
+
+static decimation_table* initialize_decimation_table_2d(
 	int xdim,
 	int ydim,
 	int x_weights,
-	int y_weights,
-	decimation_table* dt
+	int y_weights
 ) {
 	int texels_per_block = xdim * ydim;
 	int weights_per_block = x_weights * y_weights;
@@ -300,87 +424,24 @@ static void initialize_decimation_table_2d(
 		}
 	}
 
-	for (int i = 0; i < texels_per_block; i++)
-	{
-		dt->texel_weight_count[i] = weightcount_of_texel[i];
-
-		// Init all 4 entries so we can rely on zeros for vectorization
-		for (int j = 0; j < 4; j++)
-		{
-			dt->texel_weights_int_t4[i][j] = 0;
-			dt->texel_weights_float_t4[i][j] = 0.0f;
-			dt->texel_weights_t4[i][j] = 0;
-
-			dt->texel_weights_float_4t[j][i] = 0.0f;
-			dt->texel_weights_4t[j][i] = 0;
-
-		}
-
-		for (int j = 0; j < weightcount_of_texel[i]; j++)
-		{
-			dt->texel_weights_int_t4[i][j] = weights_of_texel[i][j];
-			dt->texel_weights_float_t4[i][j] = ((float)weights_of_texel[i][j]) * (1.0f / TEXEL_WEIGHT_SUM);
-			dt->texel_weights_t4[i][j] = grid_weights_of_texel[i][j];
-
-			dt->texel_weights_float_4t[j][i] = ((float)weights_of_texel[i][j]) * (1.0f / TEXEL_WEIGHT_SUM);
-			dt->texel_weights_4t[j][i] = grid_weights_of_texel[i][j];
-		}
-	}
-
-	for (int i = 0; i < weights_per_block; i++)
-	{
-		dt->weight_texel_count[i] = texelcount_of_weight[i];
-
-		for (int j = 0; j < texelcount_of_weight[i]; j++)
-		{
-			uint8_t texel = texels_of_weight[i][j];
-			dt->weight_texel[i][j] = texel;
-			dt->weights_int[i][j] = texelweights_of_weight[i][j];
-			dt->weights_flt[i][j] = (float)texelweights_of_weight[i][j];
-
-			// perform a layer of array unrolling. An aspect of this unrolling is that
-			// one of the texel-weight indexes is an identity-mapped index; we will use this
-			// fact to reorder the indexes so that the first one is the identity index.
-			int swap_idx = -1;
-			for (int k = 0; k < 4; k++)
-			{
-				uint8_t dttw = dt->texel_weights_t4[texel][k];
-				float dttwf = dt->texel_weights_float_t4[texel][k];
-				if (dttw == i && dttwf != 0.0f)
-				{
-					swap_idx = k;
-				}
-				dt->texel_weights_texel[i][j][k] = dttw;
-				dt->texel_weights_float_texel[i][j][k] = dttwf;
-			}
+	decimation_table* dt = construct_decimation_table(
+	    texels_per_block, weights_per_block,
+	    weightcount_of_texel, grid_weights_of_texel, weights_of_texel,
+	    texelcount_of_weight, texels_of_weight, texelweights_of_weight);
 
-			if (swap_idx != 0)
-			{
-				uint8_t vi = dt->texel_weights_texel[i][j][0];
-				float vf = dt->texel_weights_float_texel[i][j][0];
-				dt->texel_weights_texel[i][j][0] = dt->texel_weights_texel[i][j][swap_idx];
-				dt->texel_weights_float_texel[i][j][0] = dt->texel_weights_float_texel[i][j][swap_idx];
-				dt->texel_weights_texel[i][j][swap_idx] = vi;
-				dt->texel_weights_float_texel[i][j][swap_idx] = vf;
-			}
-		}
-	}
-
-	dt->texel_count = texels_per_block;
-	dt->weight_count = weights_per_block;
 	dt->weight_x = x_weights;
 	dt->weight_y = y_weights;
 	dt->weight_z = 1;
+	return dt;
 }
 
-static void initialize_decimation_table_3d(
+static decimation_table* initialize_decimation_table_3d(
 	int xdim,
 	int ydim,
 	int zdim,
 	int x_weights,
 	int y_weights,
-	int z_weights,
-	decimation_table* dt
+	int z_weights
 ) {
 	int texels_per_block = xdim * ydim * zdim;
 	int weights_per_block = x_weights * y_weights * z_weights;
@@ -519,75 +580,48 @@ static void initialize_decimation_table_3d(
 		}
 	}
 
-	for (int i = 0; i < texels_per_block; i++)
-	{
-		dt->texel_weight_count[i] = weightcount_of_texel[i];
-
-		// Init all 4 entries so we can rely on zeros for vectorization
-		for (int j = 0; j < 4; j++)
-		{
-			dt->texel_weights_int_t4[i][j] = 0;
-			dt->texel_weights_float_t4[i][j] = 0.0f;
-			dt->texel_weights_t4[i][j] = 0;
+	decimation_table* dt = construct_decimation_table(
+	    texels_per_block, weights_per_block,
+	    weightcount_of_texel, grid_weights_of_texel, weights_of_texel,
+	    texelcount_of_weight, texels_of_weight, texelweights_of_weight);
 
-			dt->texel_weights_float_4t[j][i] = 0.0f;
-			dt->texel_weights_4t[j][i] = 0;
-		}
-
-		for (int j = 0; j < weightcount_of_texel[i]; j++)
-		{
-			dt->texel_weights_int_t4[i][j] = weights_of_texel[i][j];
-			dt->texel_weights_float_t4[i][j] = ((float)weights_of_texel[i][j]) * (1.0f / TEXEL_WEIGHT_SUM);
-			dt->texel_weights_t4[i][j] = grid_weights_of_texel[i][j];
-
-			dt->texel_weights_float_4t[j][i] = ((float)weights_of_texel[i][j]) * (1.0f / TEXEL_WEIGHT_SUM);
-			dt->texel_weights_4t[j][i] = grid_weights_of_texel[i][j];
-		}
-	}
-
-	for (int i = 0; i < weights_per_block; i++)
-	{
-		dt->weight_texel_count[i] = texelcount_of_weight[i];
-		for (int j = 0; j < texelcount_of_weight[i]; j++)
-		{
-			int texel = texels_of_weight[i][j];
-			dt->weight_texel[i][j] = texel;
-			dt->weights_int[i][j] = texelweights_of_weight[i][j];
-			dt->weights_flt[i][j] = (float)texelweights_of_weight[i][j];
+	dt->weight_x = x_weights;
+	dt->weight_y = y_weights;
+	dt->weight_z = z_weights;
+	return dt;
+}
 
-			// perform a layer of array unrolling. An aspect of this unrolling is that
-			// one of the texel-weight indexes is an identity-mapped index; we will use this
-			// fact to reorder the indexes so that the first one is the identity index.
-			int swap_idx = -1;
-			for (int k = 0; k < 4; k++)
+/**
+ * @brief Sort the active block modes by decimation mode and weight precision.
+ *
+ * Modes are grouped by decimation mode and plane count, in increasing weight
+ * quantization level within each group. The packed index lookup table is
+ * updated to match the new order.
+ *
+ * @param bsd   The block size descriptor to update.
+ */
+static void sort_block_modes(
+	block_size_descriptor& bsd
+) {
+	std::stable_sort(bsd.block_modes, bsd.block_modes + bsd.block_mode_count,
+		[](const block_mode& a, const block_mode& b) {
+			if (a.decimation_mode != b.decimation_mode)
 			{
-				uint8_t dttw = dt->texel_weights_t4[texel][k];
-				float dttwf = dt->texel_weights_float_t4[texel][k];
-				if (dttw == i && dttwf != 0.0f)
-				{
-					swap_idx = k;
-				}
-				dt->texel_weights_texel[i][j][k] = dttw;
-				dt->texel_weights_float_texel[i][j][k] = dttwf;
+				return a.decimation_mode < b.decimation_mode;
 			}
 
-			if (swap_idx != 0)
+			if (a.is_dual_plane != b.is_dual_plane)
 			{
-				uint8_t vi = dt->texel_weights_texel[i][j][0];
-				float vf = dt->texel_weights_float_texel[i][j][0];
-				dt->texel_weights_texel[i][j][0] = dt->texel_weights_texel[i][j][swap_idx];
-				dt->texel_weights_float_texel[i][j][0] = dt->texel_weights_float_texel[i][j][swap_idx];
-				dt->texel_weights_texel[i][j][swap_idx] = vi;
-				dt->texel_weights_float_texel[i][j][swap_idx] = vf;
+				return a.is_dual_plane < b.is_dual_plane;
 			}
-		}
-	}
 
-	dt->texel_count = texels_per_block;
-	dt->weight_count = weights_per_block;
-	dt->weight_x = x_weights;
-	dt->weight_y = y_weights;
-	dt->weight_z = z_weights;
+			return a.quant_mode < b.quant_mode;
+		});
+
+	for (int i = 0; i < bsd.block_mode_count; i++)
+	{
+		bsd.block_mode_packed_index[bsd.block_modes[i].mode_index] = (int16_t)i;
+	}
 }
 
 /**
@@ -663,8 +697,11 @@ static int construct_dt_entry_2d(
 
 	bool try_2planes = (2 * weight_count) <= MAX_WEIGHTS_PER_BLOCK;
 
-	decimation_table *dt = aligned_malloc<decimation_table>(sizeof(decimation_table), ASTCENC_VECALIGN);
-	initialize_decimation_table_2d(x_dim, y_dim, x_weights, y_weights, dt);
+	decimation_table *dt = nullptr;
+	if (!bsd.lazy_tables)
+	{
+		dt = initialize_decimation_table_2d(x_dim, y_dim, x_weights, y_weights);
+	}
 
 	int maxprec_1plane = -1;
 	int maxprec_2planes = -1;
@@ -693,6 +730,9 @@ static int construct_dt_entry_2d(
 	bsd.decimation_modes[dm_index].percentile_hit = false;
 	bsd.decimation_modes[dm_index].percentile_always = false;
 	bsd.decimation_tables[dm_index] = dt;
+	bsd.decimation_grid_dims[dm_index][0] = (uint8_t)x_weights;
+	bsd.decimation_grid_dims[dm_index][1] = (uint8_t)y_weights;
+	bsd.decimation_grid_dims[dm_index][2] = 1;
 
 	bsd.decimation_mode_count++;
 	return dm_index;
@@ -796,6 +836,12 @@ static void construct_block_size_descriptor_2d(
 			bsd.block_modes[packed_idx].percentile_hit = true;
 			bsd.decimation_modes[decimation_mode].percentile_hit = true;
 		}
+		// Modes kept only for decompression are never used for compression
+		else
+		{
+			bsd.block_modes[packed_idx].percentile_always = false;
+			bsd.block_modes[packed_idx].percentile_hit = false;
+		}
 #endif
 
 		bsd.block_modes[packed_idx].decimation_mode = decimation_mode;
@@ -821,6 +867,8 @@ static void construct_block_size_descriptor_2d(
 		bsd.decimation_tables[i] = nullptr;
 	}
 
+	sort_block_modes(bsd);
+
 	// Determine the texels to use for kmeans clustering.
 	assign_kmeans_texels(bsd);
 }
@@ -857,9 +905,13 @@ static void construct_block_size_descriptor_3d(
 					continue;
 				}
 
-				decimation_table *dt = aligned_malloc<decimation_table>(sizeof(decimation_table), ASTCENC_VECALIGN);
+				decimation_table *dt = nullptr;
+				if (!bsd->lazy_tables)
+				{
+					dt = initialize_decimation_table_3d(xdim, ydim, zdim, x_weights, y_weights, z_weights);
+				}
+
 				decimation_mode_index[z_weights * 64 + y_weights * 8 + x_weights] = decimation_mode_count;
-				initialize_decimation_table_3d(xdim, ydim, zdim, x_weights, y_weights, z_weights, dt);
 
 				int maxprec_1plane = -1;
 				int maxprec_2planes = -1;
@@ -889,6 +941,9 @@ static void construct_block_size_descriptor_3d(
 				bsd->decimation_modes[decimation_mode_count].percentile_hit = false;
 				bsd->decimation_modes[decimation_mode_count].percentile_always = false;
 				bsd->decimation_tables[decimation_mode_count] = dt;
+				bsd->decimation_grid_dims[decimation_mode_count][0] = (uint8_t)x_weights;
+				bsd->decimation_grid_dims[decimation_mode_count][1] = (uint8_t)y_weights;
+				bsd->decimation_grid_dims[decimation_mode_count][2] = (uint8_t)z_weights;
 				decimation_mode_count++;
 			}
 		}
@@ -945,6 +1000,7 @@ static void construct_block_size_descriptor_3d(
 		++packed_idx;
 	}
 	bsd->block_mode_count = packed_idx;
+	sort_block_modes(*bsd);
 
 	// Determine the texels to use for kmeans clustering.
 	assign_kmeans_texels(*bsd);
@@ -957,8 +1013,23 @@ void init_block_size_descriptor(
 	int zdim,
 	bool can_omit_modes,
 	float mode_cutoff,
+	bool lazy_tables,
 	block_size_descriptor* bsd
 ) {
+	bsd->lazy_tables = lazy_tables;
+	for (int i = 0; i < MAX_DECIMATION_MODES; i++)
+	{
+		bsd->lazy_decimation_tables[i].store(nullptr, std::memory_order_relaxed);
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < PARTITION_COUNT; j++)
+		{
+			bsd->lazy_partitions[i][j].store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
 	if (zdim > 1)
 	{
 		construct_block_size_descriptor_3d(xdim, ydim, zdim, bsd);
@@ -971,11 +1042,169 @@ void init_block_size_descriptor(
 	init_partition_tables(bsd);
 }
 
+/* Public function, see header file for detailed documentation */
+const decimation_table* init_lazy_decimation_table(
+	const block_size_descriptor& bsd,
+	int decimation_mode
+) {
+	assert(bsd.lazy_tables);
+	assert(decimation_mode >= 0 && decimation_mode < bsd.decimation_mode_count);
+
+	const uint8_t* dims = bsd.decimation_grid_dims[decimation_mode];
+
+	decimation_table* dt;
+	if (bsd.zdim > 1)
+	{
+		dt = initialize_decimation_table_3d(bsd.xdim, bsd.ydim, bsd.zdim, dims[0], dims[1], dims[2]);
+	}
+	else
+	{
+		dt = initialize_decimation_table_2d(bsd.xdim, bsd.ydim, dims[0], dims[1]);
+	}
+
+	// If another thread published a table first then use theirs and drop ours
+	const decimation_table* expected = nullptr;
+	if (!bsd.lazy_decimation_tables[decimation_mode].compare_exchange_strong(
+	        expected, dt, std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		aligned_free<decimation_table>(dt);
+		return expected;
+	}
+
+	return dt;
+}
+
 void term_block_size_descriptor(
 	block_size_descriptor* bsd)
 {
 	for (int i = 0; i < bsd->decimation_mode_count; i++)
 	{
 		aligned_free<const decimation_table>(bsd->decimation_tables[i]);
+		aligned_free<const decimation_table>(bsd->lazy_decimation_tables[i].load(std::memory_order_relaxed));
+	}
+
+	delete[] bsd->partitions;
+
+	for (int i = 0; i < 3; i++)
+	{
+		aligned_free<int>(bsd->partitioning_coverage[i]);
+
+		for (int j = 0; j < PARTITION_COUNT; j++)
+		{
+			delete bsd->lazy_partitions[i][j].load(std::memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * @brief An entry in the shared block size descriptor cache.
+ */
+struct bsd_cache_entry
+{
+	/**< The next entry in the cache list. */
+	bsd_cache_entry* next;
+
+	/**< The number of contexts currently using this entry. */
+	unsigned int ref_count;
+
+	/**< The block X dimension. */
+	int xdim;
+
+	/**< The block Y dimension. */
+	int ydim;
+
+	/**< The block Z dimension. */
+	int zdim;
+
+	/**< The can_omit_modes setting used to build the descriptor. */
+	bool can_omit_modes;
+
+	/**< The mode_cutoff setting used to build the descriptor. */
+	float mode_cutoff;
+
+	/**< The lazy_tables setting used to build the descriptor. */
+	bool lazy_tables;
+
+	/**< The cached descriptor. */
+	block_size_descriptor* bsd;
+};
+
+/** @brief The lock protecting the shared block size descriptor cache. */
+static std::mutex g_bsd_cache_lock;
+
+/** @brief The head of the shared block size descriptor cache list. */
+static bsd_cache_entry* g_bsd_cache = nullptr;
+
+/* Public function, see header file for detailed documentation */
+const block_size_descriptor* acquire_block_size_descriptor(
+	int xdim,
+	int ydim,
+	int zdim,
+	bool can_omit_modes,
+	float mode_cutoff,
+	bool lazy_tables
+) {
+	std::lock_guard<std::mutex> lock(g_bsd_cache_lock);
+
+	// The cutoff is unused for 3D blocks, and only affects the compressor
+	// heuristic flags for decompression if no modes are omitted
+	if ((zdim > 1) || (lazy_tables && !can_omit_modes))
+	{
+		mode_cutoff = 1.0f;
 	}
+
+	for (bsd_cache_entry* entry = g_bsd_cache; entry; entry = entry->next)
+	{
+		if (entry->xdim == xdim && entry->ydim == ydim && entry->zdim == zdim &&
+		    entry->can_omit_modes == can_omit_modes && entry->mode_cutoff == mode_cutoff &&
+		    entry->lazy_tables == lazy_tables)
+		{
+			entry->ref_count++;
+			return entry->bsd;
+		}
+	}
+
+	block_size_descriptor* bsd = new block_size_descriptor;
+	init_block_size_descriptor(xdim, ydim, zdim, can_omit_modes, mode_cutoff, lazy_tables, bsd);
+
+	bsd_cache_entry* entry = new bsd_cache_entry;
+	entry->next = g_bsd_cache;
+	entry->ref_count = 1;
+	entry->xdim = xdim;
+	entry->ydim = ydim;
+	entry->zdim = zdim;
+	entry->can_omit_modes = can_omit_modes;
+	entry->mode_cutoff = mode_cutoff;
+	entry->lazy_tables = lazy_tables;
+	entry->bsd = bsd;
+	g_bsd_cache = entry;
+
+	return bsd;
+}
+
+/* Public function, see header file for detailed documentation */
+void release_block_size_descriptor(
+	const block_size_descriptor* bsd
+) {
+	std::lock_guard<std::mutex> lock(g_bsd_cache_lock);
+
+	bsd_cache_entry** link = &g_bsd_cache;
+	while (*link && (*link)->bsd != bsd)
+	{
+		link = &((*link)->next);
+	}
+
+	bsd_cache_entry* entry = *link;
+	assert(entry);
+	if (--entry->ref_count)
+	{
+		return;
+	}
+
+	*link = entry->next;
+	term_block_size_descriptor(entry->bsd);
+	delete entry->bsd;
+	delete entry;
 }
+
+ASTCENC_NAMESPACE_END
@@ -26,6 +26,8 @@
 
 #include "astcenc_internal.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 /*
 	quantize an LDR RGB color. Since this is a fall-back encoding, we cannot actually
 	fail but must just go on until we can produce a sensible result.
@@ -1412,7 +1414,7 @@ static void quantize_hdr_rgb3(
 		int d0_intval = astc::flt2int_rtn(d0_fval * mode_scale);
 		int d1_intval = astc::flt2int_rtn(d1_fval * mode_scale);
 
-		if (abs(d0_intval) >= d_intcutoff || abs(d1_intval) >= d_intcutoff)
+		if (std::abs(d0_intval) >= d_intcutoff || std::abs(d1_intval) >= d_intcutoff)
 		{
 			continue;
 		}
@@ -1930,4 +1932,6 @@ int pack_color_endpoints(
 	return retval;
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
@@ -21,6 +21,8 @@
 
 #include "astcenc_internal.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 static int rgb_delta_unpack(
 	const int input[6],
 	int quant_level,
@@ -900,3 +902,5 @@ void unpack_color_endpoints(
 		break;
 	}
 }
+
+ASTCENC_NAMESPACE_END
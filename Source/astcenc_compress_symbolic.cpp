@@ -36,6 +36,8 @@
 	#include <fenv.h>
 #endif
 
+ASTCENC_NAMESPACE_BEGIN
+
 /**
  * @brief Attempt to improve weights given a chosen configuration.
  *
@@ -54,8 +56,7 @@ static int realign_weights(
 ) {
 	// Get the partition descriptor
 	int partition_count = scb->partition_count;
-	const partition_info *pt = get_partition_table(bsd, partition_count);
-	pt += scb->partition_index;
+	const partition_info *pt = get_partition_info(bsd, partition_count, scb->partition_index);
 
 	// Get the quantization table
 	const int packed_index = bsd->block_mode_packed_index[scb->block_mode];
@@ -139,12 +140,13 @@ static int realign_weights(
 
 			// Interpolate the colors to create the diffs
 			int texels_to_evaluate = it->weight_texel_count[we_idx];
+			int texel_offset = it->weight_texel_offset[we_idx];
 			promise(texels_to_evaluate > 0);
-			for (int te_idx = 0; te_idx < texels_to_evaluate; te_idx++)
+			for (int te_idx = texel_offset; te_idx < texel_offset + texels_to_evaluate; te_idx++)
 			{
-				int texel = it->weight_texel[we_idx][te_idx];
-				const uint8_t *texel_weights = it->texel_weights_texel[we_idx][te_idx];
-				const float *texel_weights_float = it->texel_weights_float_texel[we_idx][te_idx];
+				int texel = it->weight_texel[te_idx];
+				const uint8_t *texel_weights = it->texel_weights_texel[te_idx];
+				const float *texel_weights_float = it->texel_weights_float_texel[te_idx];
 				float twf0 = texel_weights_float[0];
 				float weight_base =
 				    ((static_cast<float>(uqw) * twf0
@@ -200,33 +202,35 @@ static int realign_weights(
 }
 
 /*
-	function for compressing a block symbolically, given that we have already decided on a partition
+	function for compressing a block symbolically, given that we have already decided on a partition;
+	if only_block_mode is not -1 then only that block mode is tested
 */
 static float compress_symbolic_block_fixed_partition_1_plane(
 	astcenc_profile decode_mode,
 	bool only_always,
+	int only_block_mode,
 	int tune_candidate_limit,
 	float tune_errorval_threshold,
 	int max_refinement_iters,
+	float tune_converged_fraction,
 	const block_size_descriptor* bsd,
 	int partition_count,
 	int partition_index,
 	const imageblock* blk,
 	const error_weight_block* ewb,
 	symbolic_compressed_block& scb,
-	compress_fixed_partition_buffers* tmpbuf
+	compress_fixed_partition_buffers* tmpbuf,
+	astcenc_stats& stats
 ) {
 	static const int free_bits_for_partition_count[5] = {
 		0, 115 - 4, 111 - 4 - PARTITION_BITS, 108 - 4 - PARTITION_BITS, 105 - 4 - PARTITION_BITS
 	};
 
-	const partition_info *pi = get_partition_table(bsd, partition_count);
-	pi += partition_index;
+	const partition_info *pi = get_partition_info(bsd, partition_count, partition_index);
 
 	// first, compute ideal weights and endpoint colors, under the assumption that
 	// there is no quantization or decimation going on.
 	endpoints_and_weights *ei = &tmpbuf->ei1;
-	endpoints_and_weights *eix = tmpbuf->eix1;
 	compute_endpoints_and_ideal_weights_1_plane(bsd, pi, blk, ewb, ei);
 
 	// next, compute ideal weights and endpoint colors for every decimation.
@@ -234,23 +238,26 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 
 	float *decimated_quantized_weights = tmpbuf->decimated_quantized_weights;
 	float *decimated_weights = tmpbuf->decimated_weights;
-	float *flt_quantized_decimated_quantized_weights = tmpbuf->flt_quantized_decimated_quantized_weights;
-	uint8_t *u8_quantized_decimated_quantized_weights = tmpbuf->u8_quantized_decimated_quantized_weights;
+
+	int only_decimation_mode = -1;
+	if (only_block_mode >= 0)
+	{
+		only_decimation_mode = bsd->block_modes[only_block_mode].decimation_mode;
+	}
 
 	// for each decimation mode, compute an ideal set of weights
 	// (that is, weights computed with the assumption that they are not quantized)
 	for (int i = 0; i < bsd->decimation_mode_count; i++)
 	{
 		const decimation_mode& dm = bsd->decimation_modes[i];
-		if (dm.maxprec_1plane < 0 || (only_always && !dm.percentile_always) || !dm.percentile_hit)
+		if (dm.maxprec_1plane < 0 || (only_always && !dm.percentile_always) || !dm.percentile_hit
+		    || ((only_decimation_mode >= 0) && (i != only_decimation_mode)))
 		{
 			continue;
 		}
 
-		eix[i] = *ei;
-
 		compute_ideal_weights_for_decimation_table(
-		    eix[i],
+		    *ei,
 		    *(ixtab2[i]),
 		    decimated_quantized_weights + i * MAX_WEIGHTS_PER_BLOCK,
 		    decimated_weights + i * MAX_WEIGHTS_PER_BLOCK);
@@ -283,7 +290,7 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 	float weight_high_value[MAX_WEIGHT_MODES];
 
 	compute_angular_endpoints_1plane(
-	    only_always, bsd,
+	    only_always, only_block_mode, bsd,
 	    decimated_quantized_weights, decimated_weights,
 	    weight_low_value, weight_high_value);
 
@@ -294,10 +301,19 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 	int qwt_bitcounts[MAX_WEIGHT_MODES];
 	float qwt_errors[MAX_WEIGHT_MODES];
 
+	// Block modes are sorted by increasing weight precision for each decimation
+	// mode, so stop each decimation mode once its weight error has converged
+	float converged_error = tune_errorval_threshold * tune_converged_fraction;
+	int converged_decimation_mode = -1;
+	int last_decimation_mode = -1;
+	float last_error = 1e38f;
+
 	for (int i = 0; i < bsd->block_mode_count; ++i)
 	{
 		const block_mode& bm = bsd->block_modes[i];
-		if (bm.is_dual_plane || (only_always && !bm.percentile_always) || !bm.percentile_hit)
+		if (bm.is_dual_plane || (only_always && !bm.percentile_always) || !bm.percentile_hit
+		    || ((only_block_mode >= 0) && (i != only_block_mode))
+		    || (bm.decimation_mode == converged_decimation_mode))
 		{
 			qwt_errors[i] = 1e38f;
 			continue;
@@ -321,21 +337,40 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 			continue;
 		}
 		qwt_bitcounts[i] = bitcount;
+		stats.block_modes_evaluated++;
 
 		// then, generate the optimized set of weights for the weight mode.
+		// These are only needed to compute the error, so are not retained.
+		alignas(ASTCENC_VECALIGN) float flt_quantized_weights[MAX_WEIGHTS_PER_BLOCK];
+		uint8_t u8_quantized_weights[MAX_WEIGHTS_PER_BLOCK];
+
 		compute_quantized_weights_for_decimation_table(
 		    ixtab2[decimation_mode],
 		    weight_low_value[i], weight_high_value[i],
 		    decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * decimation_mode,
-		    flt_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * i,
-		    u8_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * i,
+		    flt_quantized_weights,
+		    u8_quantized_weights,
 		    bm.quant_mode);
 
 		// then, compute weight-errors for the weight mode.
 		qwt_errors[i] = compute_error_of_weight_set(
-		                    &(eix[decimation_mode]),
+		                    ei,
 		                    ixtab2[decimation_mode],
-		                    flt_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * i);
+		                    flt_quantized_weights);
+
+		// Stop once a more precise encoding no longer gives a useful gain
+		if (decimation_mode != last_decimation_mode)
+		{
+			last_decimation_mode = decimation_mode;
+			last_error = 1e38f;
+		}
+
+		if ((qwt_errors[i] <= last_error) && ((last_error - qwt_errors[i]) < converged_error))
+		{
+			converged_decimation_mode = decimation_mode;
+		}
+
+		last_error = qwt_errors[i];
 	}
 
 	// for each weighting mode, determine the optimal combination of color endpoint encodings
@@ -356,13 +391,14 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 	float best_errorval_in_mode = 1e30f;
 	float best_errorval_in_scb = scb.errorval;
 
+	// The endpoints of each candidate; candidates which share a decimation
+	// mode start from the endpoints refined by the previous such candidate
+	endpoints candidate_ep[TUNE_MAX_TRIAL_CANDIDATES];
+
 	for (int i = 0; i < tune_candidate_limit; i++)
 	{
 		TRACE_NODE(node0, "candidate");
 
-		uint8_t *u8_weight_src;
-		int weights_to_copy;
-
 		const int qw_packed_index = quantized_weight[i];
 		if (qw_packed_index < 0)
 		{
@@ -376,8 +412,31 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 		int decimation_mode = qw_bm.decimation_mode;
 		int weight_quant_mode = qw_bm.quant_mode;
 		const decimation_table *it = ixtab2[decimation_mode];
-		u8_weight_src = u8_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * qw_packed_index;
-		weights_to_copy = it->weight_count;
+		int weights_to_copy = it->weight_count;
+
+		endpoints* ep = &(candidate_ep[i]);
+		*ep = ei->ep;
+		for (int j = i - 1; j >= 0; j--)
+		{
+			if ((quantized_weight[j] >= 0) &&
+			    (bsd->block_modes[quantized_weight[j]].decimation_mode == decimation_mode))
+			{
+				*ep = candidate_ep[j];
+				break;
+			}
+		}
+
+		// Candidates use distinct block modes, so quantize the weights again
+		alignas(ASTCENC_VECALIGN) float flt_weight_src[MAX_WEIGHTS_PER_BLOCK];
+		uint8_t u8_weight_src[MAX_WEIGHTS_PER_BLOCK];
+
+		compute_quantized_weights_for_decimation_table(
+		    it,
+		    weight_low_value[qw_packed_index], weight_high_value[qw_packed_index],
+		    decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * decimation_mode,
+		    flt_weight_src,
+		    u8_weight_src,
+		    weight_quant_mode);
 
 		trace_add_data("weight_x", it->weight_x);
 		trace_add_data("weight_y", it->weight_y);
@@ -392,8 +451,10 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 		symbolic_compressed_block workscb;
 		for (int l = 0; l < max_refinement_iters; l++)
 		{
+			stats.refinement_iterations++;
+
 			recompute_ideal_colors_1plane(
-			    weight_quant_mode, &(eix[decimation_mode].ep),
+			    weight_quant_mode, ep,
 			    rgbs_colors, rgbo_colors, u8_weight_src, pi, it, blk, ewb);
 
 			// quantize the chosen color
@@ -402,8 +463,8 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 			for (int j = 0; j < partition_count; j++)
 			{
 				workscb.color_formats[j] = pack_color_endpoints(
-				    eix[decimation_mode].ep.endpt0[j],
-				    eix[decimation_mode].ep.endpt1[j],
+				    ep->endpt0[j],
+				    ep->endpt1[j],
 				    rgbs_colors[j],
 				    rgbo_colors[j],
 				    partition_format_specifiers[i][j],
@@ -427,8 +488,8 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 				for (int j = 0; j < partition_count; j++)
 				{
 					color_formats_mod[j] = pack_color_endpoints(
-					    eix[decimation_mode].ep.endpt0[j],
-					    eix[decimation_mode].ep.endpt1[j],
+					    ep->endpt0[j],
+					    ep->endpt1[j],
 					    rgbs_colors[j],
 					    rgbo_colors[j],
 					    partition_format_specifiers[i][j],
@@ -555,9 +616,11 @@ static float compress_symbolic_block_fixed_partition_1_plane(
 static float compress_symbolic_block_fixed_partition_2_planes(
 	astcenc_profile decode_mode,
 	bool only_always,
+	int only_block_mode,
 	int tune_candidate_limit,
 	float tune_errorval_threshold,
 	int max_refinement_iters,
+	float tune_converged_fraction,
 	const block_size_descriptor* bsd,
 	int partition_count,
 	int partition_index,
@@ -565,20 +628,18 @@ static float compress_symbolic_block_fixed_partition_2_planes(
 	const imageblock* blk,
 	const error_weight_block* ewb,
 	symbolic_compressed_block& scb,
-	compress_fixed_partition_buffers* tmpbuf
+	compress_fixed_partition_buffers* tmpbuf,
+	astcenc_stats& stats
 ) {
 	static const int free_bits_for_partition_count[5] = {
 		0, 113 - 4, 109 - 4 - PARTITION_BITS, 106 - 4 - PARTITION_BITS, 103 - 4 - PARTITION_BITS
 	};
 
-	const partition_info *pi = get_partition_table(bsd, partition_count);
-	pi += partition_index;
+	const partition_info *pi = get_partition_info(bsd, partition_count, partition_index);
 
 	// first, compute ideal weights and endpoint colors
 	endpoints_and_weights *ei1 = &tmpbuf->ei1;
 	endpoints_and_weights *ei2 = &tmpbuf->ei2;
-	endpoints_and_weights *eix1 = tmpbuf->eix1;
-	endpoints_and_weights *eix2 = tmpbuf->eix2;
 	compute_endpoints_and_ideal_weights_2_planes(bsd, pi, blk, ewb, separate_component, ei1, ei2);
 
 	// next, compute ideal weights and endpoint colors for every decimation.
@@ -586,29 +647,31 @@ static float compress_symbolic_block_fixed_partition_2_planes(
 
 	float *decimated_quantized_weights = tmpbuf->decimated_quantized_weights;
 	float *decimated_weights = tmpbuf->decimated_weights;
-	float *flt_quantized_decimated_quantized_weights = tmpbuf->flt_quantized_decimated_quantized_weights;
-	uint8_t *u8_quantized_decimated_quantized_weights = tmpbuf->u8_quantized_decimated_quantized_weights;
+
+	int only_decimation_mode = -1;
+	if (only_block_mode >= 0)
+	{
+		only_decimation_mode = bsd->block_modes[only_block_mode].decimation_mode;
+	}
 
 	// for each decimation mode, compute an ideal set of weights
 	for (int i = 0; i < bsd->decimation_mode_count; i++)
 	{
 		const decimation_mode& dm = bsd->decimation_modes[i];
-		if (dm.maxprec_2planes < 0 || (only_always && !dm.percentile_always) || !dm.percentile_hit)
+		if (dm.maxprec_2planes < 0 || (only_always && !dm.percentile_always) || !dm.percentile_hit
+		    || ((only_decimation_mode >= 0) && (i != only_decimation_mode)))
 		{
 			continue;
 		}
 
-		eix1[i] = *ei1;
-		eix2[i] = *ei2;
-
 		compute_ideal_weights_for_decimation_table(
-		    eix1[i],
+		    *ei1,
 		    *(ixtab2[i]),
 		    decimated_quantized_weights + (2 * i) * MAX_WEIGHTS_PER_BLOCK,
 		    decimated_weights + (2 * i) * MAX_WEIGHTS_PER_BLOCK);
 
 		compute_ideal_weights_for_decimation_table(
-		    eix2[i],
+		    *ei2,
 		    *(ixtab2[i]),
 		    decimated_quantized_weights + (2 * i + 1) * MAX_WEIGHTS_PER_BLOCK,
 		    decimated_weights + (2 * i + 1) * MAX_WEIGHTS_PER_BLOCK);
@@ -656,7 +719,7 @@ static float compress_symbolic_block_fixed_partition_2_planes(
 	float weight_high_value2[MAX_WEIGHT_MODES];
 
 	compute_angular_endpoints_2planes(
-	    only_always, bsd,
+	    only_always, only_block_mode, bsd,
 	    decimated_quantized_weights, decimated_weights,
 	    weight_low_value1, weight_high_value1,
 	    weight_low_value2, weight_high_value2);
@@ -668,10 +731,20 @@ static float compress_symbolic_block_fixed_partition_2_planes(
 
 	int qwt_bitcounts[MAX_WEIGHT_MODES];
 	float qwt_errors[MAX_WEIGHT_MODES];
+
+	// Block modes are sorted by increasing weight precision for each decimation
+	// mode, so stop each decimation mode once its weight error has converged
+	float converged_error = tune_errorval_threshold * tune_converged_fraction;
+	int converged_decimation_mode = -1;
+	int last_decimation_mode = -1;
+	float last_error = 1e38f;
+
 	for (int i = 0; i < bsd->block_mode_count; ++i)
 	{
 		const block_mode& bm = bsd->block_modes[i];
-		if ((!bm.is_dual_plane) || (only_always && !bm.percentile_always) || !bm.percentile_hit)
+		if ((!bm.is_dual_plane) || (only_always && !bm.percentile_always) || !bm.percentile_hit
+		    || ((only_block_mode >= 0) && (i != only_block_mode))
+		    || (bm.decimation_mode == converged_decimation_mode))
 		{
 			qwt_errors[i] = 1e38f;
 			continue;
@@ -700,35 +773,54 @@ static float compress_symbolic_block_fixed_partition_2_planes(
 			continue;
 		}
 		qwt_bitcounts[i] = bitcount;
+		stats.block_modes_evaluated++;
 
 		// then, generate the optimized set of weights for the mode.
+		// These are only needed to compute the error, so are not retained.
+		alignas(ASTCENC_VECALIGN) float flt_quantized_weights1[MAX_WEIGHTS_PER_BLOCK];
+		alignas(ASTCENC_VECALIGN) float flt_quantized_weights2[MAX_WEIGHTS_PER_BLOCK];
+		uint8_t u8_quantized_weights[MAX_WEIGHTS_PER_BLOCK];
+
 		compute_quantized_weights_for_decimation_table(
 		    ixtab2[decimation_mode],
 		    weight_low_value1[i],
 		    weight_high_value1[i],
 		    decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * decimation_mode),
-		    flt_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * i),
-		    u8_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * i), bm.quant_mode);
+		    flt_quantized_weights1,
+		    u8_quantized_weights, bm.quant_mode);
 
 		compute_quantized_weights_for_decimation_table(
 		    ixtab2[decimation_mode],
 		    weight_low_value2[i],
 		    weight_high_value2[i],
 		    decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * decimation_mode + 1),
-		    flt_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * i + 1),
-		    u8_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * i + 1), bm.quant_mode);
-
+		    flt_quantized_weights2,
+		    u8_quantized_weights, bm.quant_mode);
 
 		// then, compute quantization errors for the block mode.
 		qwt_errors[i] =	compute_error_of_weight_set(
-		                    &(eix1[decimation_mode]),
+		                    ei1,
 		                    ixtab2[decimation_mode],
-		                    flt_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * i))
+		                    flt_quantized_weights1)
 
 		              + compute_error_of_weight_set(
-		                    &(eix2[decimation_mode]),
+		                    ei2,
 		                    ixtab2[decimation_mode],
-		                    flt_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * i + 1));
+		                    flt_quantized_weights2);
+
+		// Stop once a more precise encoding no longer gives a useful gain
+		if (decimation_mode != last_decimation_mode)
+		{
+			last_decimation_mode = decimation_mode;
+			last_error = 1e38f;
+		}
+
+		if ((qwt_errors[i] <= last_error) && ((last_error - qwt_errors[i]) < converged_error))
+		{
+			converged_decimation_mode = decimation_mode;
+		}
+
+		last_error = qwt_errors[i];
 	}
 
 	// decide the optimal combination of color endpoint encodings and weight encodings.
@@ -761,20 +853,34 @@ static float compress_symbolic_block_fixed_partition_2_planes(
 			continue;
 		}
 
-		uint8_t *u8_weight1_src;
-		uint8_t *u8_weight2_src;
-		int weights_to_copy;
-
 		assert(qw_packed_index >= 0 && qw_packed_index < bsd->block_mode_count);
 		const block_mode& qw_bm = bsd->block_modes[qw_packed_index];
 
 		int decimation_mode = qw_bm.decimation_mode;
 		int weight_quant_mode = qw_bm.quant_mode;
 		const decimation_table *it = ixtab2[decimation_mode];
+		int weights_to_copy = it->weight_count;
+
+		// Candidates use distinct block modes, so quantize the weights again
+		alignas(ASTCENC_VECALIGN) float flt_weight_src[MAX_WEIGHTS_PER_BLOCK];
+		uint8_t u8_weight1_src[MAX_WEIGHTS_PER_BLOCK];
+		uint8_t u8_weight2_src[MAX_WEIGHTS_PER_BLOCK];
 
-		u8_weight1_src = u8_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * qw_packed_index);
-		u8_weight2_src = u8_quantized_decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * qw_packed_index + 1);
-		weights_to_copy = it->weight_count;
+		compute_quantized_weights_for_decimation_table(
+		    it,
+		    weight_low_value1[qw_packed_index],
+		    weight_high_value1[qw_packed_index],
+		    decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * decimation_mode),
+		    flt_weight_src,
+		    u8_weight1_src, weight_quant_mode);
+
+		compute_quantized_weights_for_decimation_table(
+		    it,
+		    weight_low_value2[qw_packed_index],
+		    weight_high_value2[qw_packed_index],
+		    decimated_quantized_weights + MAX_WEIGHTS_PER_BLOCK * (2 * decimation_mode + 1),
+		    flt_weight_src,
+		    u8_weight2_src, weight_quant_mode);
 
 		trace_add_data("weight_x", it->weight_x);
 		trace_add_data("weight_y", it->weight_y);
@@ -782,7 +888,7 @@ static float compress_symbolic_block_fixed_partition_2_planes(
 		trace_add_data("weight_quant", weight_quant_mode);
 
 		// recompute the ideal color endpoints before storing them.
-		merge_endpoints(&(eix1[decimation_mode].ep), &(eix2[decimation_mode].ep), separate_component, &epm);
+		merge_endpoints(&(ei1->ep), &(ei2->ep), separate_component, &epm);
 
 		vfloat4 rgbs_colors[4];
 		vfloat4 rgbo_colors[4];
@@ -791,6 +897,8 @@ static float compress_symbolic_block_fixed_partition_2_planes(
 		symbolic_compressed_block workscb;
 		for (int l = 0; l < max_refinement_iters; l++)
 		{
+			stats.refinement_iterations++;
+
 			recompute_ideal_colors_2planes(
 			    weight_quant_mode, &epm, rgbs_colors, rgbo_colors,
 			    u8_weight1_src, u8_weight2_src, separate_component, pi, it, blk, ewb);
@@ -979,10 +1087,13 @@ void expand_deblock_weights(
 }
 
 // Function to set error weights for each color component for each texel in a block.
-// Returns the sum of all the error values set.
+// Returns the sum of all the error values set, used to scale the error threshold.
+// For normal maps the angular error scaling is removed from the returned sum, so
+// the threshold bounds the angular error of the unit normal.
 static float prepare_error_weight_block(
 	const astcenc_context& ctx,
 	const astcenc_image& input_image,
+	const avg_var_buffers& avg_var,
 	const block_size_descriptor* bsd,
 	const imageblock* blk,
 	error_weight_block* ewb
@@ -999,6 +1110,8 @@ static float prepare_error_weight_block(
 	                      ctx.config.cw_b_weight,
 	                      ctx.config.cw_a_weight);
 
+	vfloat4 threshold_weight_sum = vfloat4::zero();
+
 	for (int z = 0; z < bsd->zdim; z++)
 	{
 		for (int y = 0; y < bsd->ydim; y++)
@@ -1012,6 +1125,7 @@ static float prepare_error_weight_block(
 				if (xpos >= input_image.dim_x || ypos >= input_image.dim_y || zpos >= input_image.dim_z)
 				{
 					ewb->error_weights[idx] = vfloat4(1e-11f);
+					threshold_weight_sum = threshold_weight_sum + vfloat4(1e-11f);
 				}
 				else
 				{
@@ -1020,16 +1134,17 @@ static float prepare_error_weight_block(
 					                     ctx.config.v_rgb_base,
 					                     ctx.config.v_a_base);
 
-					int ydt = input_image.dim_x;
-					int zdt = input_image.dim_x * input_image.dim_y;
+					vfloat4 angular_scale(1.0f);
+
+					int avg_var_index = get_avg_var_index(avg_var, xpos, ypos, zpos);
 
 					if (any_mean_stdev_weight)
 					{
-						vfloat4 avg = ctx.input_averages[zpos * zdt + ypos * ydt + xpos];
+						vfloat4 avg = avg_var.input_averages[avg_var_index];
 						avg = max(avg, 6e-5f);
 						avg = avg * avg;
 
-						vfloat4 variance = ctx.input_variances[zpos * zdt + ypos * ydt + xpos];
+						vfloat4 variance = avg_var.input_variances[avg_var_index];
 						variance = variance * variance;
 
 						float favg = hadd_rgb_s(avg) * (1.0f / 3.0f);
@@ -1069,8 +1184,9 @@ static float prepare_error_weight_block(
 						float denom = 1.0f - xN * xN - yN * yN;
 						denom = astc::max(denom, 0.1f);
 						denom = 1.0f / denom;
-						error_weight.set_lane<0>(error_weight.lane<0>() * (1.0f + xN * xN * denom));
-						error_weight.set_lane<3>(error_weight.lane<3>() * (1.0f + yN * yN * denom));
+						angular_scale.set_lane<0>(1.0f + xN * xN * denom);
+						angular_scale.set_lane<3>(1.0f + yN * yN * denom);
+						error_weight = error_weight * angular_scale;
 					}
 
 					if (ctx.config.flags & ASTCENC_FLG_USE_ALPHA_WEIGHT)
@@ -1078,7 +1194,7 @@ static float prepare_error_weight_block(
 						float alpha_scale;
 						if (ctx.config.a_scale_radius != 0)
 						{
-							alpha_scale = ctx.input_alpha_averages[zpos * zdt + ypos * ydt + xpos];
+							alpha_scale = avg_var.input_alpha_averages[avg_var_index];
 						}
 						else
 						{
@@ -1106,18 +1222,16 @@ static float prepare_error_weight_block(
 
 					error_weight = error_weight / (derv[idx] * derv[idx] * 1e-10f);
 					ewb->error_weights[idx] = error_weight;
+					threshold_weight_sum = threshold_weight_sum + error_weight / angular_scale;
 				}
 				idx++;
 			}
 		}
 	}
 
-	vfloat4 error_weight_sum = vfloat4::zero();
 	int texels_per_block = bsd->texel_count;
 	for (int i = 0; i < texels_per_block; i++)
 	{
-		error_weight_sum = error_weight_sum + ewb->error_weights[i];
-
 		float wr = ewb->error_weights[i].lane<0>();
 		float wg = ewb->error_weights[i].lane<1>();
 		float wb = ewb->error_weights[i].lane<2>();
@@ -1141,7 +1255,7 @@ static float prepare_error_weight_block(
 		ewb->texel_weight[i] = (wr + wg + wb + wa) * 0.25f;
 	}
 
-	return hadd_s(error_weight_sum);
+	return hadd_s(threshold_weight_sum);
 }
 
 static float prepare_block_statistics(
@@ -1258,17 +1372,21 @@ static float prepare_block_statistics(
 	return lowest_correlation;
 }
 
-void compress_block(
+bool compress_block(
 	const astcenc_context& ctx,
 	const astcenc_image& input_image,
+	const avg_var_buffers& avg_var,
+	const block_search_limits& limits,
 	const imageblock* blk,
+	const physical_compressed_block* hint,
 	symbolic_compressed_block& scb,
 	physical_compressed_block& pcb,
 	compress_symbolic_block_buffers* tmpbuf)
 {
 	astcenc_profile decode_mode = ctx.config.profile;
 	error_weight_block *ewb = &tmpbuf->ewb;
-	const block_size_descriptor* bsd = ctx.bsd;
+	const block_size_descriptor* bsd = limits.bsd;
+	astcenc_stats& stats = tmpbuf->stats;
 	float lowest_correl;
 
 	TRACE_NODE(node0, "block");
@@ -1289,8 +1407,8 @@ void compress_block(
 #if defined(ASTCENC_DIAGNOSTICS)
 	// Do this early in diagnostic builds so we can dump uniform metrics
 	// for every block. Do it later in release builds to avoid redundant work!
-	float error_weight_sum = prepare_error_weight_block(ctx, input_image, bsd, blk, ewb);
-	float error_threshold = ctx.config.tune_db_limit
+	float error_weight_sum = prepare_error_weight_block(ctx, input_image, avg_var, bsd, blk, ewb);
+	float error_threshold = limits.db_limit
 	                      * error_weight_sum
 	                      * block_is_l_scale
 	                      * block_is_la_scale;
@@ -1314,11 +1432,11 @@ void compress_block(
 		{
 			scb.block_mode = -1;
 			scb.partition_count = 0;
-			vfloat4 orig_color = blk->origin_texel;
-			scb.constant_color[0] = float_to_sf16(orig_color.lane<0>(), SF_NEARESTEVEN);
-			scb.constant_color[1] = float_to_sf16(orig_color.lane<1>(), SF_NEARESTEVEN);
-			scb.constant_color[2] = float_to_sf16(orig_color.lane<2>(), SF_NEARESTEVEN);
-			scb.constant_color[3] = float_to_sf16(orig_color.lane<3>(), SF_NEARESTEVEN);
+			vint4 color_f16 = float_to_float16(blk->origin_texel);
+			scb.constant_color[0] = color_f16.lane<0>();
+			scb.constant_color[1] = color_f16.lane<1>();
+			scb.constant_color[2] = color_f16.lane<2>();
+			scb.constant_color[3] = color_f16.lane<3>();
 		}
 		else
 		{
@@ -1332,14 +1450,15 @@ void compress_block(
 		}
 
 		trace_add_data("exit", "quality hit");
+		stats.exit_constant_count++;
 
 		symbolic_to_physical(*bsd, scb, pcb);
-		return;
+		return true;
 	}
 
 #if !defined(ASTCENC_DIAGNOSTICS)
-	float error_weight_sum = prepare_error_weight_block(ctx, input_image, bsd, blk, ewb);
-	float error_threshold = ctx.config.tune_db_limit
+	float error_weight_sum = prepare_error_weight_block(ctx, input_image, avg_var, bsd, blk, ewb);
+	float error_threshold = limits.db_limit
 	                      * error_weight_sum
 	                      * block_is_l_scale
 	                      * block_is_la_scale;
@@ -1366,13 +1485,74 @@ void compress_block(
 	// compression and slightly reduces image quality.
 
 	float errorval_mult[2] = {
-		1.0f / ctx.config.tune_mode0_mse_overshoot,
+		1.0f / limits.mode0_mse_overshoot,
 		1.0f
 	};
 
 	static const float errorval_overshoot = 1.0f / ctx.config.tune_refinement_mse_overshoot;
 
 	int start_trial = bsd->texel_count < (int)TUNE_MAX_TEXELS_MODE0_FASTPATH ? 1 : 0;
+
+	// Trial the block mode and partitioning of the hint encoding first, as
+	// similar blocks often meet the target using the same configuration
+	if (hint)
+	{
+		symbolic_compressed_block hint_scb;
+		physical_to_symbolic(*bsd, *hint, hint_scb);
+
+		int packed_index = -1;
+		if (!hint_scb.error_block && (hint_scb.block_mode >= 0))
+		{
+			packed_index = bsd->block_mode_packed_index[hint_scb.block_mode];
+		}
+
+		// The hint block mode may not be enabled for the current search limits
+		if ((packed_index >= 0) && bsd->block_modes[packed_index].percentile_hit)
+		{
+			TRACE_NODE(node1, "pass");
+			trace_add_data("partition_count", hint_scb.partition_count);
+			trace_add_data("partition_index", hint_scb.partition_index);
+			trace_add_data("hint_block_mode", hint_scb.block_mode);
+
+			float errorval;
+			if (bsd->block_modes[packed_index].is_dual_plane)
+			{
+				trace_add_data("plane_count", 2);
+				trace_add_data("plane_channel", hint_scb.plane2_color_component);
+
+				errorval = compress_symbolic_block_fixed_partition_2_planes(
+				    decode_mode, false, packed_index,
+				    limits.candidate_limit,
+				    error_threshold * errorval_overshoot,
+				    limits.refinement_limit,
+				    limits.weight_converged_fraction,
+				    bsd, hint_scb.partition_count, hint_scb.partition_index,
+				    hint_scb.plane2_color_component,
+				    blk, ewb, scb, &tmpbuf->planes, stats);
+			}
+			else
+			{
+				trace_add_data("plane_count", 1);
+
+				errorval = compress_symbolic_block_fixed_partition_1_plane(
+				    decode_mode, false, packed_index,
+				    limits.candidate_limit,
+				    error_threshold * errorval_overshoot,
+				    limits.refinement_limit,
+				    limits.weight_converged_fraction,
+				    bsd, hint_scb.partition_count, hint_scb.partition_index,
+				    blk, ewb, scb, &tmpbuf->planes, stats);
+			}
+
+			if (errorval < error_threshold)
+			{
+				trace_add_data("exit", "quality hit");
+				stats.exit_hint_count++;
+				goto END_OF_TESTS;
+			}
+		}
+	}
+
 	for (int i = start_trial; i < 2; i++)
 	{
 		TRACE_NODE(node1, "pass");
@@ -1381,17 +1561,19 @@ void compress_block(
 		trace_add_data("search_mode", i);
 
 		float errorval = compress_symbolic_block_fixed_partition_1_plane(
-		    decode_mode, i == 0,
-		    ctx.config.tune_candidate_limit,
+		    decode_mode, i == 0, -1,
+		    limits.candidate_limit,
 		    error_threshold * errorval_mult[i] * errorval_overshoot,
-		    ctx.config.tune_refinement_limit,
-		    bsd, 1, 0, blk, ewb, scb, &tmpbuf->planes);
+		    limits.refinement_limit,
+		    limits.weight_converged_fraction,
+		    bsd, 1, 0, blk, ewb, scb, &tmpbuf->planes, stats);
 
 		// Mode 0
 		best_errorvals_in_modes[0] = errorval;
 		if (errorval < (error_threshold * errorval_mult[i]))
 		{
 			trace_add_data("exit", "quality hit");
+			stats.exit_1_plane_count++;
 			goto END_OF_TESTS;
 		}
 	}
@@ -1408,7 +1590,7 @@ void compress_block(
 		trace_add_data("plane_count", 2);
 		trace_add_data("plane_channel", i);
 
-		if (lowest_correl > ctx.config.tune_two_plane_early_out_limit)
+		if (lowest_correl > limits.two_plane_early_out_limit)
 		{
 			trace_add_data("skip", "tune_two_plane_early_out_limit");
 			continue;
@@ -1427,19 +1609,21 @@ void compress_block(
 		}
 
 		float errorval = compress_symbolic_block_fixed_partition_2_planes(
-		    decode_mode, false,
-		    ctx.config.tune_candidate_limit,
+		    decode_mode, false, -1,
+		    limits.candidate_limit,
 		    error_threshold * errorval_overshoot,
-		    ctx.config.tune_refinement_limit,
+		    limits.refinement_limit,
+		    limits.weight_converged_fraction,
 		    bsd, 1,	// partition count
 		    0,	// partition index
 		    i,	// the color component to test a separate plane of weights for.
-		    blk, ewb, scb, &tmpbuf->planes);
+		    blk, ewb, scb, &tmpbuf->planes, stats);
 
 		// Modes 7, 10 (13 is unreachable)
 		if (errorval < error_threshold)
 		{
 			trace_add_data("exit", "quality hit");
+			stats.exit_2_plane_count++;
 			goto END_OF_TESTS;
 		}
 	}
@@ -1451,7 +1635,7 @@ void compress_block(
 		int partition_index_2planes;
 
 		find_best_partitionings(bsd, blk, ewb, partition_count,
-		                        ctx.config.tune_partition_limit,
+		                        limits.partition_limit,
 		                        &(partition_indices_1plane[0]),
 		                        &(partition_indices_1plane[1]),
 		                        &partition_index_2planes);
@@ -1465,25 +1649,28 @@ void compress_block(
 			trace_add_data("search_mode", i);
 
 			float errorval = compress_symbolic_block_fixed_partition_1_plane(
-			    decode_mode, false,
-			    ctx.config.tune_candidate_limit,
+			    decode_mode, false, -1,
+			    limits.candidate_limit,
 			    error_threshold * errorval_overshoot,
-			    ctx.config.tune_refinement_limit,
+			    limits.refinement_limit,
+			    limits.weight_converged_fraction,
 			    bsd, partition_count, partition_indices_1plane[i],
-			    blk, ewb, scb, &tmpbuf->planes);
+			    blk, ewb, scb, &tmpbuf->planes, stats);
 
 			// Modes 5, 6, 8, 9, 11, 12
 			best_errorvals_in_modes[3 * (partition_count - 2) + 5 + i] = errorval;
 			if (errorval < error_threshold)
 			{
 				trace_add_data("exit", "quality hit");
+				stats.exit_partition_count[partition_count - 2]++;
 				goto END_OF_TESTS;
 			}
 		}
 
-		if (partition_count == 2 && astc::min(best_errorvals_in_modes[5], best_errorvals_in_modes[6]) > (best_errorvals_in_modes[0] * ctx.config.tune_partition_early_out_limit))
+		if (partition_count == 2 && astc::min(best_errorvals_in_modes[5], best_errorvals_in_modes[6]) > (best_errorvals_in_modes[0] * limits.partition_early_out_limit))
 		{
 			trace_add_data("skip", "tune_partition_early_out_limit 1");
+			stats.exit_partition_early_out_count++;
 			goto END_OF_TESTS;
 		}
 
@@ -1502,7 +1689,7 @@ void compress_block(
 		}
 
 		// * Blocks with higher component correlation than the tuning cutoff
-		if (lowest_correl > ctx.config.tune_two_plane_early_out_limit)
+		if (lowest_correl > limits.two_plane_early_out_limit)
 		{
 			trace_add_data("skip", "tune_two_plane_early_out_limit");
 			continue;
@@ -1518,28 +1705,258 @@ void compress_block(
 		float errorval = compress_symbolic_block_fixed_partition_2_planes(
 			decode_mode,
 			false,
-			ctx.config.tune_candidate_limit,
+			-1,
+			limits.candidate_limit,
 			error_threshold * errorval_overshoot,
-			ctx.config.tune_refinement_limit,
+			limits.refinement_limit,
+			limits.weight_converged_fraction,
 			bsd,
 			partition_count,
 			partition_index_2planes & (PARTITION_COUNT - 1),
 			partition_index_2planes >> PARTITION_BITS,
-			blk, ewb, scb, &tmpbuf->planes);
+			blk, ewb, scb, &tmpbuf->planes, stats);
 
 		// Modes 7, 10 (13 is unreachable)
 		if (errorval < error_threshold)
 		{
 			trace_add_data("exit", "quality hit");
+			stats.exit_partition_count[partition_count - 2]++;
 			goto END_OF_TESTS;
 		}
 	}
 
 	trace_add_data("exit", "quality not hit");
+	stats.exit_full_search_count++;
 
 END_OF_TESTS:
 	// Compress to a physical block
 	symbolic_to_physical(*bsd, scb, pcb);
+	return scb.errorval < error_threshold;
 }
 
+/**
+ * @brief Count the bytes of an encoding which are not repeated by a neighbor.
+ *
+ * Entropy coders can code a run of bytes which repeats a recent run for much
+ * less than literal bytes, so this is used as the rate estimate. Each byte is
+ * compared with the byte at the same position in a single neighbor block.
+ *
+ * @param pcb              The candidate encoding.
+ * @param neighbors        The neighboring block encodings.
+ * @param neighbor_count   The number of neighboring blocks.
+ *
+ * @return The lowest number of differing bytes for any neighbor.
+ */
+static unsigned int count_literal_bytes(
+	const physical_compressed_block& pcb,
+	const physical_compressed_block* neighbors,
+	unsigned int neighbor_count
+) {
+	unsigned int best_literals = 16;
+	for (unsigned int i = 0; i < neighbor_count; i++)
+	{
+		unsigned int literals = 0;
+		for (int j = 0; j < 16; j++)
+		{
+			literals += pcb.data[j] != neighbors[i].data[j];
+		}
+
+		best_literals = astc::min(best_literals, literals);
+	}
+
+	return best_literals;
+}
+
+/**
+ * @brief Adjust the weights of an encoding to suit its endpoints.
+ *
+ * @param         decode_mode     The compressor color profile.
+ * @param         bsd             The block size information.
+ * @param         blk             The image block being compressed.
+ * @param         ewb             The error weights of the block.
+ * @param         is_dual_plane   Does the encoding use two planes of weights?
+ * @param[in,out] scb             The encoding to adjust.
+ */
+static void realign_rdo_weights(
+	astcenc_profile decode_mode,
+	const block_size_descriptor* bsd,
+	const imageblock* blk,
+	const error_weight_block* ewb,
+	bool is_dual_plane,
+	symbolic_compressed_block& scb
+) {
+	uint8_t plane1_weights[PLANE2_WEIGHTS_OFFSET];
+	uint8_t plane2_weights[PLANE2_WEIGHTS_OFFSET];
+	memcpy(plane1_weights, scb.weights, sizeof(plane1_weights));
+	memcpy(plane2_weights, scb.weights + PLANE2_WEIGHTS_OFFSET, sizeof(plane2_weights));
+
+	for (int i = 0; i < TUNE_RDO_REALIGN_LIMIT; i++)
+	{
+		int adjustments = realign_weights(decode_mode, bsd, blk, ewb, &scb,
+		                                  plane1_weights, is_dual_plane ? plane2_weights : nullptr);
+		if (!adjustments)
+		{
+			break;
+		}
+	}
+
+	memcpy(scb.weights, plane1_weights, sizeof(plane1_weights));
+	memcpy(scb.weights + PLANE2_WEIGHTS_OFFSET, plane2_weights, sizeof(plane2_weights));
+}
+
+/**
+ * @brief The current best encoding during rate-distortion optimization.
+ */
+struct rdo_choice
+{
+	/** The rate-distortion cost. */
+	float cost;
+	/** The number of literal bytes. */
+	unsigned int literals;
+	/** The symbolic encoding. */
+	symbolic_compressed_block scb;
+	/** The physical encoding. */
+	physical_compressed_block pcb;
+};
+
+/**
+ * @brief Test a candidate encoding, keeping it if it has a lower cost.
+ *
+ * @param decode_mode      The compressor color profile.
+ * @param bsd              The block size information.
+ * @param blk              The image block being compressed.
+ * @param ewb              The error weights of the block.
+ * @param neighbors        The neighboring block encodings.
+ * @param neighbor_count   The number of neighboring blocks.
+ * @param rate_scale       The cost of each literal byte.
+ * @param scb              The candidate encoding.
+ * @param[in,out] best     The current best encoding.
+ *
+ * @return @c true if the candidate was kept.
+ */
+static bool test_rdo_candidate(
+	astcenc_profile decode_mode,
+	const block_size_descriptor* bsd,
+	const imageblock* blk,
+	const error_weight_block* ewb,
+	const physical_compressed_block* neighbors,
+	unsigned int neighbor_count,
+	float rate_scale,
+	symbolic_compressed_block& scb,
+	rdo_choice& best
+) {
+	physical_compressed_block pcb;
+	symbolic_to_physical(*bsd, scb, pcb);
+
+	unsigned int literals = count_literal_bytes(pcb, neighbors, neighbor_count);
+	float rate_cost = rate_scale * static_cast<float>(literals);
+	// The error is never negative, so skip the decode if the rate alone is
+	// already more expensive than the current best
+	if (rate_cost > best.cost)
+	{
+		return false;
+	}
+
+	float errorval = compute_symbolic_block_difference(decode_mode, bsd, &scb, blk, ewb);
+	float cost = errorval + rate_cost;
+	if ((cost < best.cost) || ((cost == best.cost) && (literals < best.literals)))
+	{
+		scb.errorval = errorval;
+		best.cost = cost;
+		best.literals = literals;
+		best.scb = scb;
+		best.pcb = pcb;
+		return true;
+	}
+
+	return false;
+}
+
+/* See header for documentation. */
+void apply_block_rdo(
+	const astcenc_context& ctx,
+	const imageblock* blk,
+	const physical_compressed_block* neighbors,
+	unsigned int neighbor_count,
+	symbolic_compressed_block& scb,
+	physical_compressed_block& pcb,
+	compress_symbolic_block_buffers* tmpbuf
+) {
+	// Constant color blocks are already cheap to code, and have no error weights
+	if (scb.error_block || (scb.block_mode < 0) || (neighbor_count == 0))
+	{
+		return;
+	}
+
+	astcenc_profile decode_mode = ctx.config.profile;
+	const block_size_descriptor* bsd = ctx.bsd;
+	const error_weight_block* ewb = &tmpbuf->ewb;
+
+	// Each literal byte costs lambda times 1/16th of the lowest error, so a
+	// neighbor encoding reused in full is accepted if its error is no more
+	// than (1 + lambda) times the lowest error
+	float rate_scale = ctx.config.tune_rdo_lambda * scb.errorval * (1.0f / 16.0f);
+
+	int packed_index = bsd->block_mode_packed_index[scb.block_mode];
+	bool is_dual_plane = bsd->block_modes[packed_index].is_dual_plane;
+
+	rdo_choice best;
+	best.literals = count_literal_bytes(pcb, neighbors, neighbor_count);
+	best.cost = scb.errorval + rate_scale * static_cast<float>(best.literals);
+	best.scb = scb;
+	best.pcb = pcb;
+
+	bool changed = false;
+	for (unsigned int i = 0; i < neighbor_count; i++)
+	{
+		symbolic_compressed_block neighbor;
+		physical_to_symbolic(*bsd, neighbors[i], neighbor);
+		if (neighbor.error_block || (neighbor.block_mode < 0))
+		{
+			continue;
+		}
+
+		// Reuse the whole neighbor encoding
+		symbolic_compressed_block candidate = neighbor;
+		changed |= test_rdo_candidate(decode_mode, bsd, blk, ewb, neighbors, neighbor_count,
+		                              rate_scale, candidate, best);
+
+		// Reuse only the neighbor endpoints, or only the neighbor weights, which
+		// needs the same weight grid, partitioning, and plane assignment
+		if ((neighbor.block_mode != scb.block_mode) ||
+		    (neighbor.partition_count != scb.partition_count) ||
+		    (neighbor.partition_index != scb.partition_index))
+		{
+			continue;
+		}
+
+		// The plane assignment is only set for dual plane encodings
+		if (is_dual_plane && (neighbor.plane2_color_component != scb.plane2_color_component))
+		{
+			continue;
+		}
+
+		// Adjust the weights to suit the reused endpoints
+		candidate = neighbor;
+		memcpy(candidate.weights, scb.weights, sizeof(candidate.weights));
+		realign_rdo_weights(decode_mode, bsd, blk, ewb, is_dual_plane, candidate);
+		changed |= test_rdo_candidate(decode_mode, bsd, blk, ewb, neighbors, neighbor_count,
+		                              rate_scale, candidate, best);
+
+		candidate = scb;
+		memcpy(candidate.weights, neighbor.weights, sizeof(candidate.weights));
+		changed |= test_rdo_candidate(decode_mode, bsd, blk, ewb, neighbors, neighbor_count,
+		                              rate_scale, candidate, best);
+	}
+
+	if (changed)
+	{
+		scb = best.scb;
+		pcb = best.pcb;
+		tmpbuf->stats.rdo_reuse_count++;
+	}
+}
+
+ASTCENC_NAMESPACE_END
+
 #endif
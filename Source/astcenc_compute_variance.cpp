@@ -23,81 +23,382 @@
  * We need N to be parametric, so the routine below uses summed area tables in
  * order to execute in O(1) time independent of how big N is.
  *
- * The addition uses a Brent-Kung-based parallel prefix adder. This uses the
- * prefix tree to first perform a binary reduction, and then distributes the
- * results. This method means that there is no serial dependency between a
- * given element and the next one, and also significantly improves numerical
- * stability allowing us to use floats rather than doubles.
+ * The tables are only built for small tiles, so the sums stay short, and the
+ * values are offset by the first texel of the tile before they are summed.
+ * This keeps the table entries small enough that floats give good numerical
+ * stability, without needing doubles.
  */
 
 #include "astcenc_internal.h"
 
 #include <cassert>
 
+ASTCENC_NAMESPACE_BEGIN
+
+/**
+ * @brief The number of working blocks processed along a band by each task.
+ */
+static const int AVG_VAR_BLOCKS_PER_TASK = 4;
+
+/**
+ * @brief Convert an 8-bit UNORM image component to float.
+ *
+ * @param v   The component value.
+ *
+ * @return The value in the range 0-1.
+ */
+static ASTCENC_SIMD_INLINE float component_to_float(
+	uint8_t v
+) {
+	return v * (1.0f / 255.0f);
+}
+
+/**
+ * @brief Convert an FP16 image component to float.
+ *
+ * @param v   The component value.
+ *
+ * @return The value as a float.
+ */
+static ASTCENC_SIMD_INLINE float component_to_float(
+	uint16_t v
+) {
+	return sf16_to_float(v);
+}
+
+/**
+ * @brief Convert an FP32 image component to float.
+ *
+ * @param v   The component value.
+ *
+ * @return The value as a float.
+ */
+static ASTCENC_SIMD_INLINE float component_to_float(
+	float v
+) {
+	return v;
+}
+
+/**
+ * @brief Load an unswizzled 8-bit UNORM texel.
+ *
+ * @param texel   The texel data in the image.
+ *
+ * @return The texel in the range 0-1.
+ */
+static ASTCENC_SIMD_INLINE vfloat4 load_unswizzled_texel(
+	const uint8_t* texel
+) {
+	return int_to_float(vint4(texel)) * (1.0f / 255.0f);
+}
+
+/**
+ * @brief Load an unswizzled FP16 texel.
+ *
+ * @param texel   The texel data in the image.
+ *
+ * @return The texel as floats.
+ */
+static ASTCENC_SIMD_INLINE vfloat4 load_unswizzled_texel(
+	const uint16_t* texel
+) {
+	return float16_to_float(vint4(texel[0], texel[1], texel[2], texel[3]));
+}
+
+/**
+ * @brief Load an unswizzled FP32 texel.
+ *
+ * @param texel   The texel data in the image.
+ *
+ * @return The texel as floats.
+ */
+static ASTCENC_SIMD_INLINE vfloat4 load_unswizzled_texel(
+	const float* texel
+) {
+	return vfloat4(texel);
+}
+
+/**
+ * @brief Load a texel from an image, applying swizzle and power adjustments.
+ *
+ * @param texel          The texel data in the image.
+ * @param components     The number of channels in the image.
+ * @param needs_swz      Is the swizzle anything other than the identity?
+ * @param swz            The channel swizzle pattern.
+ * @param one            The value of the ONE swizzle for the image data type.
+ * @param are_powers_1   Are the power adjustments all 1?
+ * @param rgb_power      The RGB channel power adjustment.
+ * @param alpha_power    The alpha channel power adjustment.
+ *
+ * @return The adjusted texel value.
+ */
+template<typename T>
+static ASTCENC_SIMD_INLINE vfloat4 load_texel(
+	const T* texel,
+	int components,
+	bool needs_swz,
+	const astcenc_swizzle& swz,
+	T one,
+	bool are_powers_1,
+	float rgb_power,
+	float alpha_power
+) {
+	vfloat4 d;
+	if (!needs_swz && components == 4)
+	{
+		d = load_unswizzled_texel(texel);
+	}
+	else
+	{
+		// Swizzle data structure 4 = ZERO, 5 = ONE; missing channels use these
+		T data[6] { texel[0],
+		            components > 1 ? texel[1] : static_cast<T>(0),
+		            components > 2 ? texel[2] : static_cast<T>(0),
+		            components > 3 ? texel[3] : one,
+		            0, one };
+
+		d = vfloat4(component_to_float(data[swz.r]),
+		            component_to_float(data[swz.g]),
+		            component_to_float(data[swz.b]),
+		            component_to_float(data[swz.a]));
+	}
+
+	if (!are_powers_1)
+	{
+		d.set_lane<0>(powf(astc::max(d.lane<0>(), 1e-6f), rgb_power));
+		d.set_lane<1>(powf(astc::max(d.lane<1>(), 1e-6f), rgb_power));
+		d.set_lane<2>(powf(astc::max(d.lane<2>(), 1e-6f), rgb_power));
+		d.set_lane<3>(powf(astc::max(d.lane<3>(), 1e-6f), alpha_power));
+	}
+
+	return d;
+}
+
 /**
- * @brief Generate a prefix-sum array using Brent-Kung algorithm.
+ * @brief Load a padded texel region into the working buffers as row prefix sums.
+ *
+ * The region is padded by the kernel radius, with texels outside of the image
+ * clamped to the image edge. The first row and column of each slice, and the
+ * first slice of a 3D region, are zero as they form the edge of the tables.
  *
- * This will take an input array of the form:
- *     v0, v1, v2, ...
- * ... and modify in-place to turn it into a prefix-sum array of the form:
- *     v0, v0+v1, v0+v1+v2, ...
+ * All values are offset by @c shift, the first texel of the region, before
+ * they are accumulated. Variance is invariant under this offset, and it keeps
+ * the table entries small, preserving precision when they are differenced.
  *
- * @param d      The array to prefix-sum.
- * @param items  The number of items in the array.
- * @param stride The item spacing in the array; i.e. dense arrays should use 1.
+ * @param      arg         The input parameter structure.
+ * @param      one         The value of the ONE swizzle for the image data type.
+ * @param      padsize_x   The padded region size in X, including the zero column.
+ * @param      padsize_y   The padded region size in Y, including the zero row.
+ * @param      padsize_z   The padded region size in Z, including any zero slice.
+ * @param[out] varbuf1     The buffer for the row prefix sums of N.
+ * @param[out] varbuf2     The buffer for the row prefix sums of N^2.
+ * @param[out] shift       The offset subtracted from all values.
  */
-static void brent_kung_prefix_sum(
-	vfloat4* d,
-	size_t items,
-	int stride
+template<typename T>
+static void load_pixel_region(
+	const pixel_region_variance_args& arg,
+	T one,
+	int padsize_x,
+	int padsize_y,
+	int padsize_z,
+	vfloat4* varbuf1,
+	vfloat4* varbuf2,
+	vfloat4& shift
 ) {
-	if (items < 2)
-		return;
+	const astcenc_image& img = *arg.img;
+	int dim_x = img.dim_x;
+	int dim_y = img.dim_y;
+	int dim_z = img.dim_z;
+	int components = get_image_components(img);
+
+	float rgb_power = arg.rgb_power;
+	float alpha_power = arg.alpha_power;
+	bool are_powers_1 = (rgb_power == 1.0f) && (alpha_power == 1.0f);
+
+	const astcenc_swizzle& swz = arg.swz;
+	bool needs_swz = (swz.r != ASTCENC_SWZ_R) || (swz.g != ASTCENC_SWZ_G) ||
+	                 (swz.b != ASTCENC_SWZ_B) || (swz.a != ASTCENC_SWZ_A);
 
-	size_t lc_stride = 2;
-	size_t log2_stride = 1;
+	int kernel_radius = astc::max(arg.avg_var_kernel_radius, arg.alpha_kernel_radius);
+	int kernel_radius_z = arg.have_z ? kernel_radius : 0;
+	int zd_start = arg.have_z ? 1 : 0;
 
-	// The reduction-tree loop
-	do {
-		size_t step = lc_stride >> 1;
-		size_t start = lc_stride - 1;
-		size_t iters = items >> log2_stride;
+	int src_x = arg.offset_x - kernel_radius;
+	int src_y = arg.offset_y - kernel_radius;
+	int src_z = arg.offset_z - kernel_radius_z;
+
+	int zst = padsize_x * padsize_y;
+	vfloat4 vbz = vfloat4::zero();
 
-		vfloat4 *da = d + (start * stride);
-		ptrdiff_t ofs = -(ptrdiff_t)(step * stride);
-		size_t ofs_stride = stride << log2_stride;
+	// Use the first texel of the region as the offset
+	{
+		const T* data = get_image_row<const T>(img, astc::clamp(src_y, 0, dim_y - 1),
+		                                       astc::clamp(src_z, 0, dim_z - 1));
+		size_t index = components * astc::clamp(src_x, 0, dim_x - 1);
+		shift = load_texel(data + index, components, needs_swz, swz, one,
+		                   are_powers_1, rgb_power, alpha_power);
+	}
 
-		while (iters)
+	if (zd_start)
+	{
+		for (int i = 0; i < zst; i++)
 		{
-			*da = *da + da[ofs];
-			da += ofs_stride;
-			iters--;
+			varbuf1[i] = vbz;
+			varbuf2[i] = vbz;
 		}
+	}
+
+	for (int z = zd_start; z < padsize_z; z++)
+	{
+		int z_src = astc::clamp(src_z + z - zd_start, 0, dim_z - 1);
 
-		log2_stride += 1;
-		lc_stride <<= 1;
-	} while (lc_stride <= items);
+		vfloat4* row1 = varbuf1 + z * zst;
+		vfloat4* row2 = varbuf2 + z * zst;
+		for (int x = 0; x < padsize_x; x++)
+		{
+			row1[x] = vbz;
+			row2[x] = vbz;
+		}
 
-	// The expansion-tree loop
-	do {
-		log2_stride -= 1;
-		lc_stride >>= 1;
+		for (int y = 1; y < padsize_y; y++)
+		{
+			row1 += padsize_x;
+			row2 += padsize_x;
 
-		size_t step = lc_stride >> 1;
-		size_t start = step + lc_stride - 1;
-		size_t iters = (items - step) >> log2_stride;
+			int y_src = astc::clamp(src_y + y - 1, 0, dim_y - 1);
+			const T* data_row = get_image_row<const T>(img, y_src, z_src);
 
-		vfloat4 *da = d + (start * stride);
-		ptrdiff_t ofs = -(ptrdiff_t)(step * stride);
-		size_t ofs_stride = stride << log2_stride;
+			vfloat4 sum1 = vbz;
+			vfloat4 sum2 = vbz;
+			row1[0] = vbz;
+			row2[0] = vbz;
 
-		while (iters)
-		{
-			*da = *da + da[ofs];
-			da += ofs_stride;
-			iters--;
+			for (int x = 1; x < padsize_x; x++)
+			{
+				int x_src = astc::clamp(src_x + x - 1, 0, dim_x - 1);
+				vfloat4 d = load_texel(data_row + components * x_src, components, needs_swz,
+				                       swz, one, are_powers_1, rgb_power, alpha_power) - shift;
+
+				sum1 = sum1 + d;
+				sum2 = sum2 + d * d;
+				row1[x] = sum1;
+				row2[x] = sum2;
+			}
 		}
-	} while (lc_stride > 2);
+	}
+}
+
+/**
+ * @brief Accumulate one float array into another.
+ *
+ * @param[in,out] dst     The array to accumulate into.
+ * @param         src     The array to add.
+ * @param         count   The number of floats; must be a multiple of 4.
+ */
+static void accumulate(
+	float* dst,
+	const float* src,
+	int count
+) {
+	int i = 0;
+
+#if ASTCENC_SIMD_WIDTH > 4
+	for (/* */; i + ASTCENC_SIMD_WIDTH <= count; i += ASTCENC_SIMD_WIDTH)
+	{
+		store(vfloat(dst + i) + vfloat(src + i), dst + i);
+	}
+#endif
+
+	for (/* */; i < count; i += 4)
+	{
+		store(vfloat4(dst + i) + vfloat4(src + i), dst + i);
+	}
+}
+
+/**
+ * @brief The summed-area table rows and output rows for one row of texels.
+ */
+struct sat_row_span
+{
+	/** @brief Do the tables have a Z axis? */
+	bool have_z;
+	/** @brief The N table rows at (z_high, y_low), (z_high, y_high), (z_low, y_low), and (z_low, y_high). */
+	const float* n_rows[4];
+	/** @brief The N^2 table rows, in the same order as @c n_rows. */
+	const float* n2_rows[4];
+	/** @brief The float offsets of the low and high X bounds of the first texel in the table rows. */
+	int offset_low;
+	int offset_high;
+	/** @brief The output average row. */
+	float* averages;
+	/** @brief The output variance row. */
+	float* variances;
+	/** @brief The output alpha average row. */
+	float* alpha_averages;
+	/** @brief The offset to add back to averages, repeated for every lane. */
+	float shift[16];
+	/** @brief The variance computation constants. */
+	float avg_var_rsamples;
+	float alpha_rsamples;
+	float mul1;
+	float mul2;
+};
+
+/**
+ * @brief Compute the sum of a box of table entries for a vector of values.
+ *
+ * @param rows          The table rows at the low and high Y bounds.
+ * @param i             The float index of the first value.
+ * @param offset_low    The float offset of the low X bound.
+ * @param offset_high   The float offset of the high X bound.
+ *
+ * @return The box sums.
+ */
+template<typename vtype>
+static ASTCENC_SIMD_INLINE vtype box_sum(
+	const float* const* rows,
+	int i,
+	int offset_low,
+	int offset_high
+) {
+	return ((vtype(rows[0] + i + offset_low) - vtype(rows[0] + i + offset_high))
+	       - vtype(rows[1] + i + offset_low)) + vtype(rows[1] + i + offset_high);
+}
+
+/**
+ * @brief Compute averages and variances for a vector of values in a texel row.
+ *
+ * @param span   The table and output rows.
+ * @param i      The float index of the first value.
+ */
+template<typename vtype, int lanes>
+static ASTCENC_SIMD_INLINE void compute_span_variance(
+	const sat_row_span& span,
+	int i
+) {
+	vtype v1sum = box_sum<vtype>(span.n_rows, i, span.offset_low, span.offset_high);
+	vtype v2sum = box_sum<vtype>(span.n2_rows, i, span.offset_low, span.offset_high);
+
+	if (span.have_z)
+	{
+		v1sum = v1sum - box_sum<vtype>(span.n_rows + 2, i, span.offset_low, span.offset_high);
+		v2sum = v2sum - box_sum<vtype>(span.n2_rows + 2, i, span.offset_low, span.offset_high);
+	}
+
+	// Compute and emit the average
+	vtype shift(span.shift);
+	store(v1sum * span.avg_var_rsamples + shift, span.averages + i);
+
+	// Compute and emit the actual variance
+	store(span.mul2 * v2sum - span.mul1 * (v1sum * v1sum), span.variances + i);
+
+	// Emit the alpha average
+	alignas(ASTCENC_VECALIGN) float v1sum_lanes[lanes];
+	store(v1sum, v1sum_lanes);
+	for (int j = 0; j < lanes / 4; j++)
+	{
+		span.alpha_averages[i / 4 + j] = v1sum_lanes[4 * j + 3] * span.alpha_rsamples + span.shift[3];
+	}
 }
 
 /**
@@ -106,17 +407,18 @@ static void brent_kung_prefix_sum(
  * The routine computes both in a single pass, using a summed-area table to
  * decouple the running time from the averaging/variance kernel size.
  *
+ * The tables are built in three separable passes. The X pass is fused with
+ * loading the image, and the Y and Z passes accumulate whole rows and slices
+ * at a time, so they vectorize across texels and channels. The tables only
+ * cover the working block and its kernel halo, so they stay in cache.
+ *
  * @param arg The input parameter structure.
  */
 static void compute_pixel_region_variance(
-	astcenc_context& ctx,
 	const pixel_region_variance_args* arg
 ) {
 	// Unpack the memory structure into local variables
 	const astcenc_image* img = arg->img;
-	float rgb_power = arg->rgb_power;
-	float alpha_power = arg->alpha_power;
-	astcenc_swizzle swz = arg->swz;
 	int have_z = arg->have_z;
 
 	int size_x = arg->size_x;
@@ -130,9 +432,7 @@ static void compute_pixel_region_variance(
 	int avg_var_kernel_radius = arg->avg_var_kernel_radius;
 	int alpha_kernel_radius = arg->alpha_kernel_radius;
 
-	float  *input_alpha_averages = ctx.input_alpha_averages;
-	vfloat4 *input_averages = ctx.input_averages;
-	vfloat4 *input_variances = ctx.input_variances;
+	const avg_var_buffers& dst = arg->dst;
 	vfloat4 *work_memory = arg->work_memory;
 
 	// Compute memory sizes and dimensions that we need
@@ -147,7 +447,6 @@ static void compute_pixel_region_variance(
 	int sizeprod = padsize_x * padsize_y * padsize_z;
 
 	int zd_start = have_z ? 1 : 0;
-	int are_powers_1 = (rgb_power == 1.0f) && (alpha_power == 1.0f);
 
 	vfloat4 *varbuf1 = work_memory;
 	vfloat4 *varbuf2 = work_memory + sizeprod;
@@ -156,231 +455,45 @@ static void compute_pixel_region_variance(
 	int yst = padsize_x;
 	int zst = padsize_x * padsize_y;
 
-	// Scaling factors to apply to Y and Z for accesses into result buffers
-	int ydt = img->dim_x;
-	int zdt = img->dim_x * img->dim_y;
-
-	// Macros to act as accessor functions for the work-memory
-	#define VARBUF1(z, y, x) varbuf1[z * zst + y * yst + x]
-	#define VARBUF2(z, y, x) varbuf2[z * zst + y * yst + x]
-
-	// Load N and N^2 values into the work buffers
+	// Load N and N^2 values into the work buffers as row prefix sums
+	vfloat4 shift;
 	if (img->data_type == ASTCENC_TYPE_U8)
 	{
-		// Swizzle data structure 4 = ZERO, 5 = ONE
-		uint8_t data[6];
-		data[ASTCENC_SWZ_0] = 0;
-		data[ASTCENC_SWZ_1] = 255;
-
-		for (int z = zd_start; z < padsize_z; z++)
-		{
-			int z_src = (z - zd_start) + offset_z - kernel_radius_z;
-			z_src = astc::clamp(z_src, 0, (int)(img->dim_z - 1));
-			uint8_t* data8 = static_cast<uint8_t*>(img->data[z_src]);
-
-			for (int y = 1; y < padsize_y; y++)
-			{
-				int y_src = (y - 1) + offset_y - kernel_radius_xy;
-				y_src = astc::clamp(y_src, 0, (int)(img->dim_y - 1));
-
-				for (int x = 1; x < padsize_x; x++)
-				{
-					int x_src = (x - 1) + offset_x - kernel_radius_xy;
-					x_src = astc::clamp(x_src, 0, (int)(img->dim_x - 1));
-
-					data[0] = data8[(4 * img->dim_x * y_src) + (4 * x_src    )];
-					data[1] = data8[(4 * img->dim_x * y_src) + (4 * x_src + 1)];
-					data[2] = data8[(4 * img->dim_x * y_src) + (4 * x_src + 2)];
-					data[3] = data8[(4 * img->dim_x * y_src) + (4 * x_src + 3)];
-
-					uint8_t r = data[swz.r];
-					uint8_t g = data[swz.g];
-					uint8_t b = data[swz.b];
-					uint8_t a = data[swz.a];
-
-					vfloat4 d = vfloat4 (r * (1.0f / 255.0f),
-					                     g * (1.0f / 255.0f),
-					                     b * (1.0f / 255.0f),
-					                     a * (1.0f / 255.0f));
-
-					if (!are_powers_1)
-					{
-						d.set_lane<0>(powf(astc::max(d.lane<0>(), 1e-6f), rgb_power));
-						d.set_lane<1>(powf(astc::max(d.lane<1>(), 1e-6f), rgb_power));
-						d.set_lane<2>(powf(astc::max(d.lane<2>(), 1e-6f), rgb_power));
-						d.set_lane<3>(powf(astc::max(d.lane<3>(), 1e-6f), alpha_power));
-					}
-
-					VARBUF1(z, y, x) = d;
-					VARBUF2(z, y, x) = d * d;
-				}
-			}
-		}
+		load_pixel_region<uint8_t>(*arg, 255, padsize_x, padsize_y, padsize_z,
+		                           varbuf1, varbuf2, shift);
 	}
 	else if (img->data_type == ASTCENC_TYPE_F16)
 	{
-		// Swizzle data structure 4 = ZERO, 5 = ONE (in FP16)
-		uint16_t data[6];
-		data[ASTCENC_SWZ_0] = 0;
-		data[ASTCENC_SWZ_1] = 0x3C00;
-
-		for (int z = zd_start; z < padsize_z; z++)
-		{
-			int z_src = (z - zd_start) + offset_z - kernel_radius_z;
-			z_src = astc::clamp(z_src, 0, (int)(img->dim_z - 1));
-			uint16_t* data16 = static_cast<uint16_t*>(img->data[z_src]);
-
-			for (int y = 1; y < padsize_y; y++)
-			{
-				int y_src = (y - 1) + offset_y - kernel_radius_xy;
-				y_src = astc::clamp(y_src, 0, (int)(img->dim_y - 1));
-
-				for (int x = 1; x < padsize_x; x++)
-				{
-					int x_src = (x - 1) + offset_x - kernel_radius_xy;
-					x_src = astc::clamp(x_src, 0, (int)(img->dim_x - 1));
-
-					data[0] = data16[(4 * img->dim_x * y_src) + (4 * x_src    )];
-					data[1] = data16[(4 * img->dim_x * y_src) + (4 * x_src + 1)];
-					data[2] = data16[(4 * img->dim_x * y_src) + (4 * x_src + 2)];
-					data[3] = data16[(4 * img->dim_x * y_src) + (4 * x_src + 3)];
-
-					uint16_t r = data[swz.r];
-					uint16_t g = data[swz.g];
-					uint16_t b = data[swz.b];
-					uint16_t a = data[swz.a];
-
-					vfloat4 d = vfloat4(sf16_to_float(r),
-					                    sf16_to_float(g),
-					                    sf16_to_float(b),
-					                    sf16_to_float(a));
-
-					if (!are_powers_1)
-					{
-						// TODO: Vectorize this ...
-						d.set_lane<0>(powf(astc::max(d.lane<0>(), 1e-6f), rgb_power));
-						d.set_lane<1>(powf(astc::max(d.lane<1>(), 1e-6f), rgb_power));
-						d.set_lane<2>(powf(astc::max(d.lane<2>(), 1e-6f), rgb_power));
-						d.set_lane<3>(powf(astc::max(d.lane<3>(), 1e-6f), alpha_power));
-					}
-
-					VARBUF1(z, y, x) = d;
-					VARBUF2(z, y, x) = d * d;
-				}
-			}
-		}
+		load_pixel_region<uint16_t>(*arg, 0x3C00, padsize_x, padsize_y, padsize_z,
+		                            varbuf1, varbuf2, shift);
 	}
 	else // if (img->data_type == ASTCENC_TYPE_F32)
 	{
 		assert(img->data_type == ASTCENC_TYPE_F32);
-
-		// Swizzle data structure 4 = ZERO, 5 = ONE (in FP16)
-		float data[6];
-		data[ASTCENC_SWZ_0] = 0.0f;
-		data[ASTCENC_SWZ_1] = 1.0f;
-
-		for (int z = zd_start; z < padsize_z; z++)
-		{
-			int z_src = (z - zd_start) + offset_z - kernel_radius_z;
-			z_src = astc::clamp(z_src, 0, (int)(img->dim_z - 1));
-			float* data32 = static_cast<float*>(img->data[z_src]);
-
-			for (int y = 1; y < padsize_y; y++)
-			{
-				int y_src = (y - 1) + offset_y - kernel_radius_xy;
-				y_src = astc::clamp(y_src, 0, (int)(img->dim_y - 1));
-
-				for (int x = 1; x < padsize_x; x++)
-				{
-					int x_src = (x - 1) + offset_x - kernel_radius_xy;
-					x_src = astc::clamp(x_src, 0, (int)(img->dim_x - 1));
-
-					data[0] = data32[(4 * img->dim_x * y_src) + (4 * x_src    )];
-					data[1] = data32[(4 * img->dim_x * y_src) + (4 * x_src + 1)];
-					data[2] = data32[(4 * img->dim_x * y_src) + (4 * x_src + 2)];
-					data[3] = data32[(4 * img->dim_x * y_src) + (4 * x_src + 3)];
-
-					float r = data[swz.r];
-					float g = data[swz.g];
-					float b = data[swz.b];
-					float a = data[swz.a];
-
-					vfloat4 d(r, g, b, a);
-
-					if (!are_powers_1)
-					{
-						d.set_lane<0>(powf(astc::max(d.lane<0>(), 1e-6f), rgb_power));
-						d.set_lane<1>(powf(astc::max(d.lane<1>(), 1e-6f), rgb_power));
-						d.set_lane<2>(powf(astc::max(d.lane<2>(), 1e-6f), rgb_power));
-						d.set_lane<3>(powf(astc::max(d.lane<3>(), 1e-6f), alpha_power));
-					}
-
-					VARBUF1(z, y, x) = d;
-					VARBUF2(z, y, x) = d * d;
-				}
-			}
-		}
+		load_pixel_region<float>(*arg, 1.0f, padsize_x, padsize_y, padsize_z,
+		                         varbuf1, varbuf2, shift);
 	}
 
-	// Pad with an extra layer of 0s; this forms the edge of the SAT tables
-	vfloat4 vbz = vfloat4::zero();
-	for (int z = 0; z < padsize_z; z++)
-	{
-		for (int y = 0; y < padsize_y; y++)
-		{
-			VARBUF1(z, y, 0) = vbz;
-			VARBUF2(z, y, 0) = vbz;
-		}
+	float* sat1 = reinterpret_cast<float*>(varbuf1);
+	float* sat2 = reinterpret_cast<float*>(varbuf2);
 
-		for (int x = 0; x < padsize_x; x++)
-		{
-			VARBUF1(z, 0, x) = vbz;
-			VARBUF2(z, 0, x) = vbz;
-		}
-	}
-
-	if (have_z)
-	{
-		for (int y = 0; y < padsize_y; y++)
-		{
-			for (int x = 0; x < padsize_x; x++)
-			{
-				VARBUF1(0, y, x) = vbz;
-				VARBUF2(0, y, x) = vbz;
-			}
-		}
-	}
-
-	// Generate summed-area tables for N and N^2; this is done in-place, using
-	// a Brent-Kung parallel-prefix based algorithm to minimize precision loss
+	// Complete the summed-area tables for N and N^2 by accumulating the rows
+	// of each slice, and then the slices
 	for (int z = zd_start; z < padsize_z; z++)
 	{
-		for (int y = 1; y < padsize_y; y++)
+		for (int y = 2; y < padsize_y; y++)
 		{
-			brent_kung_prefix_sum(&(VARBUF1(z, y, 1)), padsize_x - 1, 1);
-			brent_kung_prefix_sum(&(VARBUF2(z, y, 1)), padsize_x - 1, 1);
+			int row = 4 * (z * zst + y * yst);
+			accumulate(sat1 + row, sat1 + row - 4 * yst, 4 * padsize_x);
+			accumulate(sat2 + row, sat2 + row - 4 * yst, 4 * padsize_x);
 		}
 	}
 
-	for (int z = zd_start; z < padsize_z; z++)
-	{
-		for (int x = 1; x < padsize_x; x++)
-		{
-			brent_kung_prefix_sum(&(VARBUF1(z, 1, x)), padsize_y - 1, yst);
-			brent_kung_prefix_sum(&(VARBUF2(z, 1, x)), padsize_y - 1, yst);
-		}
-	}
-
-	if (have_z)
+	for (int z = 2; z < padsize_z; z++)
 	{
-		for (int y = 1; y < padsize_y; y++)
-		{
-			for (int x = 1; x < padsize_x; x++)
-			{
-				brent_kung_prefix_sum(&(VARBUF1(1, y, x)), padsize_z - 1, zst);
-				brent_kung_prefix_sum(&(VARBUF2(1, y, x)), padsize_z - 1, zst);
-			}
-		}
+		int slice = 4 * z * zst;
+		accumulate(sat1 + slice, sat1 + slice - 4 * zst, 4 * zst);
+		accumulate(sat2 + slice, sat2 + slice - 4 * zst, 4 * zst);
 	}
 
 	int avg_var_kdim = 2 * avg_var_kernel_radius + 1;
@@ -414,75 +527,30 @@ static void compute_pixel_region_variance(
 
 	float mul2 = avg_var_samples * mul1;
 
-	// Use the summed-area tables to compute variance for each neighborhood
-	if (have_z)
+	sat_row_span span;
+	span.have_z = have_z != 0;
+	span.offset_low = 4 * (kernel_radius_xy - alpha_kernel_radius);
+	span.offset_high = 4 * (kernel_radius_xy + alpha_kernel_radius + 1);
+	for (int i = 0; i < 16; i += 4)
 	{
-		for (int z = 0; z < size_z; z++)
-		{
-			int z_src = z + kernel_radius_z;
-			int z_dst = z + offset_z;
-			int z_low  = z_src - alpha_kernel_radius;
-			int z_high = z_src + alpha_kernel_radius + 1;
-
-			for (int y = 0; y < size_y; y++)
-			{
-				int y_src = y + kernel_radius_xy;
-				int y_dst = y + offset_y;
-				int y_low  = y_src - alpha_kernel_radius;
-				int y_high = y_src + alpha_kernel_radius + 1;
-
-				for (int x = 0; x < size_x; x++)
-				{
-					int x_src = x + kernel_radius_xy;
-					int x_dst = x + offset_x;
-					int x_low  = x_src - alpha_kernel_radius;
-					int x_high = x_src + alpha_kernel_radius + 1;
-
-					// Summed-area table lookups for alpha average
-					float vasum = (  VARBUF1(z_high, y_low,  x_low).lane<3>()
-					               - VARBUF1(z_high, y_low,  x_high).lane<3>()
-					               - VARBUF1(z_high, y_high, x_low).lane<3>()
-					               + VARBUF1(z_high, y_high, x_high).lane<3>()) -
-					              (  VARBUF1(z_low,  y_low,  x_low).lane<3>()
-					               - VARBUF1(z_low,  y_low,  x_high).lane<3>()
-					               - VARBUF1(z_low,  y_high, x_low).lane<3>()
-					               + VARBUF1(z_low,  y_high, x_high).lane<3>());
-
-					int out_index = z_dst * zdt + y_dst * ydt + x_dst;
-					input_alpha_averages[out_index] = (vasum * alpha_rsamples);
-
-					// Summed-area table lookups for RGBA average and variance
-					vfloat4 v1sum = ( VARBUF1(z_high, y_low,  x_low)
-					                - VARBUF1(z_high, y_low,  x_high)
-					                - VARBUF1(z_high, y_high, x_low)
-					                + VARBUF1(z_high, y_high, x_high)) -
-					               (  VARBUF1(z_low,  y_low,  x_low)
-					                - VARBUF1(z_low,  y_low,  x_high)
-					                - VARBUF1(z_low,  y_high, x_low)
-					                + VARBUF1(z_low,  y_high, x_high));
-
-					vfloat4 v2sum = ( VARBUF2(z_high, y_low,  x_low)
-					                - VARBUF2(z_high, y_low,  x_high)
-					                - VARBUF2(z_high, y_high, x_low)
-					                + VARBUF2(z_high, y_high, x_high)) -
-					               (  VARBUF2(z_low,  y_low,  x_low)
-					                - VARBUF2(z_low,  y_low,  x_high)
-					                - VARBUF2(z_low,  y_high, x_low)
-					                + VARBUF2(z_low,  y_high, x_high));
-
-					// Compute and emit the average
-					vfloat4 avg = v1sum * avg_var_rsamples;
-					input_averages[out_index] = avg;
-
-					// Compute and emit the actual variance
-					vfloat4 variance = mul2 * v2sum - mul1 * (v1sum * v1sum);
-					input_variances[out_index] = variance;
-				}
-			}
-		}
+		store(shift, span.shift + i);
 	}
-	else
+
+	span.avg_var_rsamples = avg_var_rsamples;
+	span.alpha_rsamples = alpha_rsamples;
+	span.mul1 = mul1;
+	span.mul2 = mul2;
+
+	// Use the summed-area tables to compute variance for each neighborhood,
+	// a row of texels at a time
+	int row_floats = 4 * size_x;
+	for (int z = 0; z < size_z; z++)
 	{
+		int z_src = z + kernel_radius_z;
+		int z_dst = z + offset_z;
+		int z_low  = have_z ? z_src - alpha_kernel_radius : 0;
+		int z_high = have_z ? z_src + alpha_kernel_radius + 1 : 0;
+
 		for (int y = 0; y < size_y; y++)
 		{
 			int y_src = y + kernel_radius_xy;
@@ -490,121 +558,132 @@ static void compute_pixel_region_variance(
 			int y_low  = y_src - alpha_kernel_radius;
 			int y_high = y_src + alpha_kernel_radius + 1;
 
-			for (int x = 0; x < size_x; x++)
+			span.n_rows[0] = sat1 + 4 * (z_high * zst + y_low * yst);
+			span.n_rows[1] = sat1 + 4 * (z_high * zst + y_high * yst);
+			span.n_rows[2] = sat1 + 4 * (z_low * zst + y_low * yst);
+			span.n_rows[3] = sat1 + 4 * (z_low * zst + y_high * yst);
+			span.n2_rows[0] = sat2 + 4 * (z_high * zst + y_low * yst);
+			span.n2_rows[1] = sat2 + 4 * (z_high * zst + y_high * yst);
+			span.n2_rows[2] = sat2 + 4 * (z_low * zst + y_low * yst);
+			span.n2_rows[3] = sat2 + 4 * (z_low * zst + y_high * yst);
+
+			int out_index = get_avg_var_index(dst, offset_x, y_dst, z_dst);
+			span.averages = reinterpret_cast<float*>(dst.input_averages + out_index);
+			span.variances = reinterpret_cast<float*>(dst.input_variances + out_index);
+			span.alpha_averages = dst.input_alpha_averages + out_index;
+
+			int i = 0;
+
+#if ASTCENC_SIMD_WIDTH > 4
+			for (/* */; i + ASTCENC_SIMD_WIDTH <= row_floats; i += ASTCENC_SIMD_WIDTH)
+			{
+				compute_span_variance<vfloat, ASTCENC_SIMD_WIDTH>(span, i);
+			}
+#endif
+
+			for (/* */; i < row_floats; i += 4)
 			{
-				int x_src = x + kernel_radius_xy;
-				int x_dst = x + offset_x;
-				int x_low  = x_src - alpha_kernel_radius;
-				int x_high = x_src + alpha_kernel_radius + 1;
-
-				// Summed-area table lookups for alpha average
-				float vasum = VARBUF1(0, y_low,  x_low).lane<3>()
-				            - VARBUF1(0, y_low,  x_high).lane<3>()
-				            - VARBUF1(0, y_high, x_low).lane<3>()
-				            + VARBUF1(0, y_high, x_high).lane<3>();
-
-				int out_index = y_dst * ydt + x_dst;
-				input_alpha_averages[out_index] = (vasum * alpha_rsamples);
-
-				// summed-area table lookups for RGBA average and variance
-				vfloat4 v1sum = VARBUF1(0, y_low,  x_low)
-				              - VARBUF1(0, y_low,  x_high)
-				              - VARBUF1(0, y_high, x_low)
-				              + VARBUF1(0, y_high, x_high);
-
-				vfloat4 v2sum = VARBUF2(0, y_low,  x_low)
-				              - VARBUF2(0, y_low,  x_high)
-				              - VARBUF2(0, y_high, x_low)
-				              + VARBUF2(0, y_high, x_high);
-
-				// Compute and emit the average
-				vfloat4 avg = v1sum * avg_var_rsamples;
-				input_averages[out_index] = avg;
-
-				// Compute and emit the actual variance
-				vfloat4 variance = mul2 * v2sum - mul1 * (v1sum * v1sum);
-				input_variances[out_index] = variance;
+				compute_span_variance<vfloat4, 4>(span, i);
 			}
 		}
 	}
 }
 
+
+/* Public function, see header file for detailed documentation */
+avg_var_buffers get_band_avg_var_buffers(
+	const avg_var_args& ag,
+	const avg_var_buffers& storage,
+	unsigned int band
+) {
+	unsigned int band_z = band / ag.bands_y;
+	unsigned int band_y = band - (band_z * ag.bands_y);
+
+	avg_var_buffers dst = storage;
+	dst.offset_x = ag.img_offset_x;
+	dst.offset_y = ag.img_offset_y + band_y * ag.band_size_y;
+	dst.offset_z = ag.img_offset_z + band_z * ag.band_size_z;
+	dst.stride_y = ag.img_size_x;
+	dst.stride_z = ag.img_size_x * ag.band_size_y;
+	return dst;
+}
+
+/* Public function, see header file for detailed documentation */
 void compute_averages_and_variances(
-	astcenc_context& ctx,
-	const avg_var_args &ag
+	const avg_var_args& ag,
+	const avg_var_buffers& dst,
+	unsigned int task,
+	vfloat4* work_memory
 ) {
 	pixel_region_variance_args arg = ag.arg;
-	arg.work_memory = new vfloat4[ag.work_memory_size];
+	arg.work_memory = work_memory;
+	arg.dst = dst;
 
-	int size_x = ag.img_size_x;
-	int size_y = ag.img_size_y;
-	int size_z = ag.img_size_z;
-
-	int step_xy = ag.blk_size_xy;
-	int step_z = ag.blk_size_z;
+	// Clamp the band to the texel region
+	int y = dst.offset_y - ag.img_offset_y;
+	int z = dst.offset_z - ag.img_offset_z;
 
-	int y_tasks = (size_y + step_xy - 1) / step_xy;
+	arg.offset_y = dst.offset_y;
+	arg.size_y = astc::min(ag.band_size_y, ag.img_size_y - y);
 
-	// All threads run this processing loop until there is no work remaining
-	while (true)
-	{
-		unsigned int count;
-		unsigned int base = ctx.manage_avg_var.get_task_assignment(1, count);
-		if (!count)
-		{
-			break;
-		}
+	arg.offset_z = dst.offset_z;
+	arg.size_z = astc::min(ag.band_size_z, ag.img_size_z - z);
 
-		assert(count == 1);
-		int z = (base / (y_tasks)) * step_z;
-		int y = (base - (z * y_tasks)) * step_xy;
-
-		arg.size_z = astc::min(step_z, size_z - z);
-		arg.offset_z = z;
-
-		arg.size_y = astc::min(step_xy, size_y - y);
-		arg.offset_y = y;
-
-		for (int x = 0; x < size_x; x += step_xy)
-		{
-			arg.size_x = astc::min(step_xy, size_x - x);
-			arg.offset_x = x;
-			compute_pixel_region_variance(ctx, &arg);
-		}
+	// Each task processes a contiguous span of working blocks along the band
+	int step_xy = ag.blk_size_xy;
+	int task_size_x = step_xy * AVG_VAR_BLOCKS_PER_TASK;
+	int start_x = task * task_size_x;
+	int end_x = astc::min(start_x + task_size_x, ag.img_size_x);
 
-		ctx.manage_avg_var.complete_task_assignment(count);
+	for (int x = start_x; x < end_x; x += step_xy)
+	{
+		arg.size_x = astc::min(step_xy, ag.img_size_x - x);
+		arg.offset_x = x + ag.img_offset_x;
+		compute_pixel_region_variance(&arg);
 	}
-
-	delete[] arg.work_memory;
 }
 
 /* Public function, see header file for detailed documentation */
-unsigned int init_compute_averages_and_variances(
-	astcenc_image& img,
+void init_compute_averages_and_variances(
+	const astcenc_image& img,
+	const block_size_descriptor& bsd,
+	const astcenc_block_region& region,
 	float rgb_power,
 	float alpha_power,
 	int avg_var_kernel_radius,
 	int alpha_kernel_radius,
 	astcenc_swizzle swz,
-	pixel_region_variance_args& arg,
 	avg_var_args& ag
 ) {
-	int size_x = img.dim_x;
-	int size_y = img.dim_y;
-	int size_z = img.dim_z;
+	pixel_region_variance_args& arg = ag.arg;
+
+	// Convert the block region into a texel region clamped to the image
+	int offset_x = region.origin_x * bsd.xdim;
+	int offset_y = region.origin_y * bsd.ydim;
+	int offset_z = region.origin_z * bsd.zdim;
+
+	int size_x = astc::min((int)(region.dim_x * bsd.xdim), (int)img.dim_x - offset_x);
+	int size_y = astc::min((int)(region.dim_y * bsd.ydim), (int)img.dim_y - offset_y);
+	int size_z = astc::min((int)(region.dim_z * bsd.zdim), (int)img.dim_z - offset_z);
 
 	// Compute maximum block size and from that the working memory buffer size
 	int kernel_radius = astc::max(avg_var_kernel_radius, alpha_kernel_radius);
 	int kerneldim = 2 * kernel_radius + 1;
 
-	int have_z = (size_z > 1);
+	int have_z = (img.dim_z > 1);
 	int max_blk_size_xy = have_z ? 16 : 32;
-	int max_blk_size_z = astc::min(size_z, have_z ? 16 : 1);
 
-	int max_padsize_xy = max_blk_size_xy + kerneldim;
-	int max_padsize_z = max_blk_size_z + (have_z ? kerneldim : 0);
+	// Each band is a whole number of block rows, at least one working block
+	// high, and one block slice deep
+	unsigned int band_block_rows = (max_blk_size_xy + bsd.ydim - 1) / bsd.ydim;
+	band_block_rows = astc::min(band_block_rows, region.dim_y);
+	int band_size_y = band_block_rows * bsd.ydim;
+	int band_size_z = bsd.zdim;
+
+	int max_padsize_x = max_blk_size_xy + kerneldim;
+	int max_padsize_y = band_size_y + kerneldim;
+	int max_padsize_z = band_size_z + (have_z ? kerneldim : 0);
 
-	// Perform block-wise averages-and-variances calculations across the image
 	// Initialize fields which are not populated until later
 	arg.size_x = 0;
 	arg.size_y = 0;
@@ -613,6 +692,7 @@ unsigned int init_compute_averages_and_variances(
 	arg.offset_y = 0;
 	arg.offset_z = 0;
 	arg.work_memory = nullptr;
+	arg.dst = avg_var_buffers {};
 
 	arg.img = &img;
 	arg.rgb_power = rgb_power;
@@ -622,18 +702,26 @@ unsigned int init_compute_averages_and_variances(
 	arg.avg_var_kernel_radius = avg_var_kernel_radius;
 	arg.alpha_kernel_radius = alpha_kernel_radius;
 
-	ag.arg = arg;
+	ag.img_offset_x = offset_x;
+	ag.img_offset_y = offset_y;
+	ag.img_offset_z = offset_z;
 	ag.img_size_x = size_x;
 	ag.img_size_y = size_y;
 	ag.img_size_z = size_z;
 	ag.blk_size_xy = max_blk_size_xy;
-	ag.blk_size_z = max_blk_size_z;
-	ag.work_memory_size = 2 * max_padsize_xy * max_padsize_xy * max_padsize_z;
+	ag.work_memory_size = 2 * max_padsize_x * max_padsize_y * max_padsize_z;
+
+	ag.band_size_y = band_size_y;
+	ag.band_size_z = band_size_z;
+	ag.band_texel_count = size_x * band_size_y * band_size_z;
+	ag.band_block_rows = band_block_rows;
+	ag.bands_y = (region.dim_y + band_block_rows - 1) / band_block_rows;
+	ag.band_count = ag.bands_y * region.dim_z;
 
-	// The parallel task count
-	int z_tasks = (size_z + max_blk_size_z - 1) / max_blk_size_z;
-	int y_tasks = (size_y + max_blk_size_xy - 1) / max_blk_size_xy;
-	return z_tasks * y_tasks;
+	int task_size_x = max_blk_size_xy * AVG_VAR_BLOCKS_PER_TASK;
+	ag.band_tasks = (size_x + task_size_x - 1) / task_size_x;
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
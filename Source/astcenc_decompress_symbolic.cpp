@@ -23,6 +23,9 @@
 
 #include <stdio.h>
 #include <assert.h>
+#include <cstring>
+
+ASTCENC_NAMESPACE_BEGIN
 
 static int compute_value_of_texel_int(
 	int texel_to_get,
@@ -39,6 +42,36 @@ static int compute_value_of_texel_int(
 	return summed_value >> 4;
 }
 
+/**
+ * @brief Compute the weight for every texel from a decimated weight grid.
+ *
+ * @param      it            The decimation table.
+ * @param      texel_count   The number of texels in the block.
+ * @param      uq_weights    The unquantized decimated weights.
+ * @param[out] weights       The per-texel weights.
+ */
+static void undecimate_weights(
+	const decimation_table* it,
+	int texel_count,
+	const int* uq_weights,
+	int* weights
+) {
+	// Weight grids the same size as the block need no infill
+	if (it->weight_count == texel_count)
+	{
+		for (int i = 0; i < texel_count; i++)
+		{
+			weights[i] = uq_weights[i];
+		}
+		return;
+	}
+
+	for (int i = 0; i < texel_count; i++)
+	{
+		weights[i] = compute_value_of_texel_int(i, it, uq_weights);
+	}
+}
+
 static vfloat4 lerp_color_int(
 	astcenc_profile decode_mode,
 	vint4 color0,
@@ -193,16 +226,13 @@ void decompress_symbolic_block(
 
 	// get the appropriate partition-table entry
 	int partition_count = scb->partition_count;
-	const partition_info *pt = get_partition_table(bsd, partition_count);
-	pt += scb->partition_index;
+	const partition_info *pt = get_partition_info(bsd, partition_count, scb->partition_index);
 
 	// get the appropriate block descriptor
-	const decimation_table *const *ixtab2 = bsd->decimation_tables;
-
 	const int packed_index = bsd->block_mode_packed_index[scb->block_mode];
 	assert(packed_index >= 0 && packed_index < bsd->block_mode_count);
 	const block_mode& bm = bsd->block_modes[packed_index];
-	const decimation_table *it = ixtab2[bm.decimation_mode];
+	const decimation_table *it = get_decimation_table(*bsd, bm.decimation_mode);
 
 	int is_dual_plane = bm.is_dual_plane;
 
@@ -252,17 +282,11 @@ void decompress_symbolic_block(
 	int weights[MAX_TEXELS_PER_BLOCK];
 	int plane2_weights[MAX_TEXELS_PER_BLOCK];
 
-	for (int i = 0; i < bsd->texel_count; i++)
-	{
-		weights[i] = compute_value_of_texel_int(i, it, uq_plane1_weights);
-	}
+	undecimate_weights(it, bsd->texel_count, uq_plane1_weights, weights);
 
 	if (is_dual_plane)
 	{
-		for (int i = 0; i < bsd->texel_count; i++)
-		{
-			plane2_weights[i] = compute_value_of_texel_int(i, it, uq_plane2_weights);
-		}
+		undecimate_weights(it, bsd->texel_count, uq_plane2_weights, plane2_weights);
 	}
 
 	// Now that we have endpoint colors and weights, we can unpack texel colors
@@ -296,6 +320,239 @@ void decompress_symbolic_block(
 	imageblock_initialize_orig_from_work(blk, bsd->texel_count);
 }
 
+/**
+ * @brief Convert UNORM16 values to UNORM8, matching the float decode path.
+ *
+ * The float decode path converts to UNORM8 via an FP16 intermediate, which
+ * truncates to 11 significant bits. Clearing the low 13 mantissa bits of the
+ * FP32 value reproduces that truncation exactly, so the result is bit-exact.
+ *
+ * @param v   The UNORM16 values.
+ *
+ * @return The UNORM8 values.
+ */
+static ASTCENC_SIMD_INLINE vint unorm16_to_unorm8(vint v)
+{
+	vint t = float_as_int(int_to_float(v)) & vint(static_cast<int>(0xFFFFE000));
+	vfloat f = int_as_float(t) * vfloat(255.0f) + vfloat(32768.0f);
+	return lsr<16>(float_to_int(f));
+}
+
+/**
+ * @brief Fill the in-bounds texels of a block with a single RGBA8 value.
+ */
+static void fill_block_u8(
+	const block_size_descriptor* bsd,
+	int xpos,
+	int ypos,
+	int zpos,
+	int color,
+	astcenc_image& img
+) {
+	int x_start = astc::max(0, -xpos);
+	int y_start = astc::max(0, -ypos);
+	int z_start = astc::max(0, -zpos);
+
+	int x_count = astc::min(bsd->xdim, static_cast<int>(img.dim_x) - xpos);
+	int y_count = astc::min(bsd->ydim, static_cast<int>(img.dim_y) - ypos);
+	int z_count = astc::min(bsd->zdim, static_cast<int>(img.dim_z) - zpos);
+
+	for (int z = z_start; z < z_count; z++)
+	{
+		for (int y = y_start; y < y_count; y++)
+		{
+			uint8_t* row = get_image_row<uint8_t>(img, ypos + y, zpos + z) + 4 * (xpos + x_start);
+			for (int x = x_start; x < x_count; x++)
+			{
+				memcpy(row + 4 * (x - x_start), &color, 4);
+			}
+		}
+	}
+}
+
+/* See header for documentation. */
+void decompress_symbolic_block_u8(
+	astcenc_profile decode_mode,
+	const block_size_descriptor* bsd,
+	int xpos,
+	int ypos,
+	int zpos,
+	const symbolic_compressed_block* scb,
+	astcenc_image& img
+) {
+	assert(decode_mode == ASTCENC_PRF_LDR || decode_mode == ASTCENC_PRF_LDR_SRGB);
+	assert(img.data_type == ASTCENC_TYPE_U8);
+	assert(get_image_components(img) == 4);
+
+	// Error blocks, and FP16 constant blocks in an LDR profile, are magenta
+	const int magenta = 0xFF | (0xFF << 16) | (0xFF << 24);
+	if (scb->error_block || scb->block_mode == -1)
+	{
+		fill_block_u8(bsd, xpos, ypos, zpos, magenta, img);
+		return;
+	}
+
+	if (scb->block_mode == -2)
+	{
+		int color = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			int c = scb->constant_color[i];
+			if (decode_mode == ASTCENC_PRF_LDR_SRGB)
+			{
+				c = (c >> 8) * 257;
+			}
+
+			int c8 = astc::flt2int_rtn(sf16_to_float(unorm16_to_sf16(c)) * 255.0f);
+			color |= c8 << (8 * i);
+		}
+
+		fill_block_u8(bsd, xpos, ypos, zpos, color, img);
+		return;
+	}
+
+	int partition_count = scb->partition_count;
+	const partition_info *pt = get_partition_info(bsd, partition_count, scb->partition_index);
+
+	const int packed_index = bsd->block_mode_packed_index[scb->block_mode];
+	assert(packed_index >= 0 && packed_index < bsd->block_mode_count);
+	const block_mode& bm = bsd->block_modes[packed_index];
+	const decimation_table *it = get_decimation_table(*bsd, bm.decimation_mode);
+
+	int is_dual_plane = bm.is_dual_plane;
+	int texel_count = bsd->texel_count;
+	int weight_count = it->weight_count;
+
+	// Decode the color endpoints; LDR profiles never return HDR endpoints
+	alignas(16) int endpoint0[4][4];
+	alignas(16) int endpoint1[4][4];
+	int nan_endpoint[4];
+
+	for (int i = 0; i < partition_count; i++)
+	{
+		int rgb_hdr;
+		int alpha_hdr;
+		vint4 ep0;
+		vint4 ep1;
+
+		unpack_color_endpoints(decode_mode,
+		                       scb->color_formats[i],
+		                       scb->color_quant_level,
+		                       scb->color_values[i],
+		                       &rgb_hdr, &alpha_hdr,
+		                       &(nan_endpoint[i]),
+		                       &ep0, &ep1);
+
+		if (decode_mode == ASTCENC_PRF_LDR_SRGB)
+		{
+			ep0 = lsr<8>(ep0);
+			ep1 = lsr<8>(ep1);
+		}
+
+		store(ep0, endpoint0[i]);
+		store(ep1, endpoint1[i]);
+	}
+
+	// Unquantize and undecimate the weights
+	int uq_weights[MAX_WEIGHTS_PER_BLOCK];
+	alignas(ASTCENC_VECALIGN) int weights[MAX_TEXELS_PER_BLOCK_PADDED];
+	alignas(ASTCENC_VECALIGN) int plane2_weights[MAX_TEXELS_PER_BLOCK_PADDED];
+
+	const quantization_and_transfer_table *qat = &(quant_and_xfer_tables[bm.quant_mode]);
+
+	for (int i = 0; i < weight_count; i++)
+	{
+		uq_weights[i] = qat->unquantized_value[scb->weights[i]];
+	}
+
+	undecimate_weights(it, texel_count, uq_weights, weights);
+
+	if (is_dual_plane)
+	{
+		for (int i = 0; i < weight_count; i++)
+		{
+			uq_weights[i] = qat->unquantized_value[scb->weights[i + PLANE2_WEIGHTS_OFFSET]];
+		}
+
+		undecimate_weights(it, texel_count, uq_weights, plane2_weights);
+	}
+
+	// Zero the padding so the vector loop never reads uninitialized values
+	int texel_count_simd = round_up_to_simd_multiple_vla(texel_count);
+	for (int i = texel_count; i < texel_count_simd; i++)
+	{
+		weights[i] = 0;
+		plane2_weights[i] = 0;
+	}
+
+	int plane2_color_component = is_dual_plane ? scb->plane2_color_component : -1;
+
+	// Interpolate and pack the texels; all values are below 2^24 so the float
+	// arithmetic is exact and matches the integer reference interpolation
+	alignas(ASTCENC_VECALIGN) int texels[MAX_TEXELS_PER_BLOCK_PADDED];
+
+	for (int i = 0; i < texel_count; i += ASTCENC_SIMD_WIDTH)
+	{
+		vint partition(pt->partition_of_texel + i);
+		vint weight1 = vint::loada(weights + i);
+		vint weight2 = vint::loada(plane2_weights + i);
+
+		vint nan = vint(nan_endpoint[0]);
+		for (int j = 1; j < partition_count; j++)
+		{
+			nan = select(nan, vint(nan_endpoint[j]), partition == vint(j));
+		}
+
+		vint color[4];
+		for (int c = 0; c < 4; c++)
+		{
+			vint ep0(endpoint0[0][c]);
+			vint ep1(endpoint1[0][c]);
+			for (int j = 1; j < partition_count; j++)
+			{
+				vmask is_partition = partition == vint(j);
+				ep0 = select(ep0, vint(endpoint0[j][c]), is_partition);
+				ep1 = select(ep1, vint(endpoint1[j][c]), is_partition);
+			}
+
+			vfloat w1 = int_to_float(c == plane2_color_component ? weight2 : weight1);
+			vfloat w0 = vfloat(64.0f) - w1;
+
+			vfloat value = int_to_float(ep0) * w0 + int_to_float(ep1) * w1 + vfloat(32.0f);
+			color[c] = lsr<6>(float_to_int(value));
+
+			if (decode_mode == ASTCENC_PRF_LDR)
+			{
+				color[c] = unorm16_to_unorm8(color[c]);
+			}
+		}
+
+		vint packed = color[0] | lsl<8>(color[1]) | lsl<16>(color[2]) | lsl<24>(color[3]);
+		packed = select(packed, vint(magenta), nan != vint::zero());
+		storea(packed, texels + i);
+	}
+
+	// Write the in-bounds rows of the block to the output image; when decoding
+	// a region the block may overlap any edge of the image
+	int x_start = astc::max(0, -xpos);
+	int y_start = astc::max(0, -ypos);
+	int z_start = astc::max(0, -zpos);
+
+	int x_count = astc::min(bsd->xdim, static_cast<int>(img.dim_x) - xpos);
+	int y_count = astc::min(bsd->ydim, static_cast<int>(img.dim_y) - ypos);
+	int z_count = astc::min(bsd->zdim, static_cast<int>(img.dim_z) - zpos);
+
+	for (int z = z_start; z < z_count; z++)
+	{
+		for (int y = y_start; y < y_count; y++)
+		{
+			uint8_t* row = get_image_row<uint8_t>(img, ypos + y, zpos + z) + 4 * (xpos + x_start);
+			int idx = (z * bsd->ydim + y) * bsd->xdim + x_start;
+			memcpy(row, texels + idx, 4 * (x_count - x_start));
+		}
+	}
+}
+
 float compute_symbolic_block_difference(
 	astcenc_profile decode_mode,
 	const block_size_descriptor* bsd,
@@ -313,8 +570,7 @@ float compute_symbolic_block_difference(
 
 	// get the appropriate partition-table entry
 	int partition_count = scb->partition_count;
-	const partition_info *pt = get_partition_table(bsd, partition_count);
-	pt += scb->partition_index;
+	const partition_info *pt = get_partition_info(bsd, partition_count, scb->partition_index);
 
 	// get the appropriate block descriptor
 	const decimation_table *const *ixtab2 = bsd->decimation_tables;
@@ -377,17 +633,11 @@ float compute_symbolic_block_difference(
 	int weights[MAX_TEXELS_PER_BLOCK];
 	int plane2_weights[MAX_TEXELS_PER_BLOCK];
 
-	for (int i = 0; i < texel_count; i++)
-	{
-		weights[i] = compute_value_of_texel_int(i, it, uq_plane1_weights);
-	}
+	undecimate_weights(it, texel_count, uq_plane1_weights, weights);
 
 	if (is_dual_plane)
 	{
-		for (int i = 0; i < texel_count; i++)
-		{
-			plane2_weights[i] = compute_value_of_texel_int(i, it, uq_plane2_weights);
-		}
+		undecimate_weights(it, texel_count, uq_plane2_weights, plane2_weights);
 	}
 
 	// Now that we have endpoint colors and weights, we can unpack texel colors
@@ -424,3 +674,5 @@ float compute_symbolic_block_difference(
 
 	return summa;
 }
+
+ASTCENC_NAMESPACE_END
@@ -16,156 +16,235 @@
 // ----------------------------------------------------------------------------
 
 /**
- * @brief Functions for the library entrypoint.
+ * @brief Functions for the diagnostic trace.
  */
 
 #if defined(ASTCENC_DIAGNOSTICS)
 
+#include <atomic>
 #include <cassert>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
+#include <unordered_map>
 
 #include "astcenc_diagnostic_trace.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
+/** @brief The size of each per-thread trace buffer, in bytes. */
+static const size_t TRACE_BUFFER_SIZE = 1024 * 1024;
+
+/** @brief The largest event record, in bytes. */
+static const size_t TRACE_MAX_EVENT_SIZE = 1 + 2 + 1 + 255;
+
+/** @brief The trace file magic identifier. */
+static const char TRACE_MAGIC[8] = { 'A', 'S', 'T', 'C', 'T', 'R', 'C', 0 };
+
+/** @brief The trace file format version. */
+static const uint32_t TRACE_VERSION = 1;
+
+struct TraceBuffer
+{
+	/** @brief The thread identifier stored in each chunk. */
+	uint32_t thread_id;
+
+	/** @brief The number of bytes of event data in the buffer. */
+	size_t used;
+
+	/** @brief The identifiers of the attribute keys this thread has used. */
+	std::unordered_map<const char*, uint16_t> keys;
+
+	/** @brief The event data. */
+	uint8_t data[TRACE_BUFFER_SIZE];
+};
+
 /** @brief The global trace logger. */
 static TraceLog* g_TraceLog = nullptr;
 
-/** @brief The JSON indentation level. */
-static const int g_trace_indent = 2;
+/** @brief The source of unique trace log identifiers. */
+static std::atomic<unsigned int> g_trace_generation { 0 };
+
+/** @brief The trace buffer of this thread. */
+static thread_local TraceBuffer* t_trace_buffer = nullptr;
+
+/** @brief The identifier of the trace log which owns this thread's buffer. */
+static thread_local unsigned int t_trace_generation = 0;
 
 TraceLog::TraceLog(
 	const char* file_name):
-	m_file(file_name, std::ofstream::out | std::ofstream::binary)
+	m_file(file_name, std::ofstream::out | std::ofstream::binary),
+	m_generation(++g_trace_generation)
 {
 	assert(!g_TraceLog);
 	g_TraceLog = this;
-	m_root = new TraceNode("root");
+
+	m_file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+	m_file.write(reinterpret_cast<const char*>(&TRACE_VERSION), sizeof(TRACE_VERSION));
 }
 
-TraceNode* TraceLog::get_current_leaf()
+TraceLog::~TraceLog()
 {
-	if (m_stack.size())
+	assert(g_TraceLog == this);
+	for (auto& buffer : m_buffers)
 	{
-		return m_stack.back();
+		flush(*buffer);
 	}
 
-	return nullptr;
+	g_TraceLog = nullptr;
 }
 
-int TraceLog::get_depth()
+TraceBuffer* TraceLog::get_thread_buffer()
 {
-	return m_stack.size();
-}
+	if (t_trace_generation != m_generation)
+	{
+		std::lock_guard<std::mutex> lck(m_lock);
+		TraceBuffer* buffer = new TraceBuffer;
+		buffer->thread_id = static_cast<uint32_t>(m_buffers.size());
+		buffer->used = 0;
+		m_buffers.emplace_back(buffer);
+
+		t_trace_buffer = buffer;
+		t_trace_generation = m_generation;
+	}
 
-TraceLog::~TraceLog()
-{
-	assert(g_TraceLog == this);
-	delete m_root;
-	g_TraceLog = nullptr;
+	return t_trace_buffer;
 }
 
-TraceNode::TraceNode(
-	const char* format,
-	...
+void TraceLog::flush(
+	TraceBuffer& buffer
 ) {
-	// Format the name string
-	constexpr size_t bufsz = 256;
-	char buffer[bufsz];
-
-	va_list args;
-	va_start (args, format);
-	vsnprintf (buffer, bufsz, format, args);
-	va_end (args);
-
-	// Guarantee there is a nul termintor
-	buffer[bufsz - 1] = 0;
-
-	// Generate the node
-	TraceNode* parent = g_TraceLog->get_current_leaf();
-	int depth = g_TraceLog->get_depth();
-	g_TraceLog->m_stack.push_back(this);
-
-	bool comma = parent && parent->m_attrib_count;
-	auto& out = g_TraceLog->m_file;
-
-	if (parent)
-	{
-		parent->m_attrib_count++;
-	}
-
-	if (comma)
+	if (!buffer.used)
 	{
-		out << ',';
+		return;
 	}
 
-	if (depth)
-	{
-		out << '\n';
-	}
+	uint32_t header[2] {
+		buffer.thread_id,
+		static_cast<uint32_t>(buffer.used)
+	};
 
-	int out_indent = (depth * 2) * g_trace_indent;
-	int in_indent = (depth * 2 + 1) * g_trace_indent;
+	std::lock_guard<std::mutex> lck(m_lock);
+	m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	m_file.write(reinterpret_cast<const char*>(buffer.data), buffer.used);
+	buffer.used = 0;
+}
 
-	std::string out_indents("");
-	if (out_indent)
+/**
+ * @brief Get the calling thread's buffer, with space for one more event.
+ *
+ * @return The trace buffer.
+ */
+static TraceBuffer& get_event_buffer()
+{
+	TraceBuffer& buffer = *g_TraceLog->get_thread_buffer();
+	if (buffer.used + TRACE_MAX_EVENT_SIZE > TRACE_BUFFER_SIZE)
 	{
-		out_indents = std::string(out_indent, ' ');
+		g_TraceLog->flush(buffer);
 	}
 
-	std::string in_indents(in_indent, ' ');
+	return buffer;
+}
 
-	out << out_indents << "[ \"node\", \"" << buffer << "\",\n";
-	out << in_indents << "[";
+/**
+ * @brief Append a value to a trace buffer.
+ *
+ * @param buffer   The trace buffer.
+ * @param value    The value to append.
+ */
+template<typename T>
+static void put(
+	TraceBuffer& buffer,
+	T value
+) {
+	std::memcpy(buffer.data + buffer.used, &value, sizeof(T));
+	buffer.used += sizeof(T);
 }
 
-void TraceNode::add_attrib(
-	std::string type,
-	std::string key,
-	std::string value
+/**
+ * @brief Append a length-prefixed string to a trace buffer.
+ *
+ * Strings longer than 255 characters are truncated.
+ *
+ * @param buffer   The trace buffer.
+ * @param str      The string to append.
+ */
+static void put_string(
+	TraceBuffer& buffer,
+	const char* str
 ) {
-	(void)type;
+	size_t len = astc::min(std::strlen(str), static_cast<size_t>(255));
+	put<uint8_t>(buffer, static_cast<uint8_t>(len));
+	std::memcpy(buffer.data + buffer.used, str, len);
+	buffer.used += len;
+}
 
-	int depth = g_TraceLog->get_depth();
-	int indent = (depth * 2) * g_trace_indent;
-	auto& out = g_TraceLog->m_file;
-	bool comma = m_attrib_count;
-	m_attrib_count++;
+/**
+ * @brief Start an attribute event, defining its key if needed.
+ *
+ * @param type   The event type.
+ * @param key    The attribute key.
+ *
+ * @return The trace buffer to append the value to.
+ */
+static TraceBuffer& begin_attrib(
+	trace_event type,
+	const char* key
+) {
+	TraceBuffer& buffer = get_event_buffer();
 
-	if (comma)
+	uint16_t key_id;
+	auto it = buffer.keys.find(key);
+	if (it == buffer.keys.end())
 	{
-		out << ',';
+		key_id = static_cast<uint16_t>(buffer.keys.size());
+		buffer.keys[key] = key_id;
+
+		put<uint8_t>(buffer, TRACE_EVENT_KEY);
+		put<uint16_t>(buffer, key_id);
+		put_string(buffer, key);
+
+		// Defining a key may have used the space reserved for the attribute
+		if (buffer.used + TRACE_MAX_EVENT_SIZE > TRACE_BUFFER_SIZE)
+		{
+			g_TraceLog->flush(buffer);
+		}
+	}
+	else
+	{
+		key_id = it->second;
 	}
 
-	out << '\n';
-	out << std::string(indent, ' ') << "[ "
-	                                << "\"" << key << "\", "
-	                                << value << " ]";
+	put<uint8_t>(buffer, type);
+	put<uint16_t>(buffer, key_id);
+	return buffer;
 }
 
-TraceNode::~TraceNode()
-{
-	g_TraceLog->m_stack.pop_back();
-
-	auto& out = g_TraceLog->m_file;
-	int depth = g_TraceLog->get_depth();
-	int out_indent = (depth * 2) * g_trace_indent;
-	int in_indent = (depth * 2 + 1) * g_trace_indent;
+TraceNode::TraceNode(
+	const char* format,
+	...
+) {
+	// Format the name string
+	constexpr size_t bufsz = 256;
+	char buffer[bufsz];
 
-	std::string out_indents("");
-	if (out_indent)
-	{
-		out_indents = std::string(out_indent, ' ');
-	}
+	va_list args;
+	va_start (args, format);
+	vsnprintf (buffer, bufsz, format, args);
+	va_end (args);
 
-	std::string in_indents(in_indent, ' ');
+	// Guarantee there is a nul termintor
+	buffer[bufsz - 1] = 0;
 
-	if (m_attrib_count)
-	{
-		out << "\n" << in_indents;
-	}
-	out << "]\n";
+	TraceBuffer& out = get_event_buffer();
+	put<uint8_t>(out, TRACE_EVENT_NODE_BEGIN);
+	put_string(out, buffer);
+}
 
-	out << out_indents << "]";
+TraceNode::~TraceNode()
+{
+	TraceBuffer& out = get_event_buffer();
+	put<uint8_t>(out, TRACE_EVENT_NODE_END);
 }
 
 void trace_add_data(
@@ -184,34 +263,34 @@ void trace_add_data(
 	// Guarantee there is a nul termintor
 	buffer[bufsz - 1] = 0;
 
-	std::string value = "\"" + std::string(buffer) + "\"";
-
-	TraceNode* node = g_TraceLog->get_current_leaf();
-	node->add_attrib("str", key, value);
+	TraceBuffer& out = begin_attrib(TRACE_EVENT_STR, key);
+	put_string(out, buffer);
 }
 
 void trace_add_data(
 	const char* key,
 	float value
 ) {
-	TraceNode* node = g_TraceLog->get_current_leaf();
-	node->add_attrib("float", key, std::to_string(value));
+	TraceBuffer& out = begin_attrib(TRACE_EVENT_FLOAT, key);
+	put<float>(out, value);
 }
 
 void trace_add_data(
 	const char* key,
 	int value
 ) {
-	TraceNode* node = g_TraceLog->get_current_leaf();
-	node->add_attrib("int", key, std::to_string(value));
+	TraceBuffer& out = begin_attrib(TRACE_EVENT_INT, key);
+	put<int32_t>(out, static_cast<int32_t>(value));
 }
 
 void trace_add_data(
 	const char* key,
 	unsigned int value
 ) {
-	TraceNode* node = g_TraceLog->get_current_leaf();
-	node->add_attrib("int", key, std::to_string(value));
+	TraceBuffer& out = begin_attrib(TRACE_EVENT_UINT, key);
+	put<uint32_t>(out, static_cast<uint32_t>(value));
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
@@ -21,8 +21,8 @@
  * Overview
  * ========
  *
- * The built-in diagnostic trace tool generates a hierarchical JSON tree
- * structure. The tree hierarchy contains three levels:
+ * The built-in diagnostic trace tool generates a hierarchical tree structure.
+ * The tree hierarchy contains three levels:
  *
  *    - block
  *        - pass
@@ -49,6 +49,35 @@
  * A set of utility macros are provided to add attribute annotations to the
  * current trace node.
  *
+ * Trace format
+ * ============
+ *
+ * Each thread appends compact binary event records to its own buffer, so
+ * tracing needs no synchronization between threads other than when a full
+ * buffer is written to the file. The file contains a header followed by a
+ * sequence of chunks, each of which contains events from a single thread.
+ * Nodes and attributes outside of any node belong to the root node. All
+ * values are stored in native byte order; the conversion script only supports
+ * traces from little-endian hosts.
+ *
+ *     header:  char magic[8] "ASTCTRC\0", u32 version
+ *     chunk:   u32 thread_id, u32 payload_size, u8 payload[payload_size]
+ *
+ * The payloads of a thread's chunks form a single stream of events, each of
+ * which starts with a u8 event type:
+ *
+ *     TRACE_EVENT_NODE_BEGIN   u8 name_len, char name[name_len]
+ *     TRACE_EVENT_NODE_END
+ *     TRACE_EVENT_KEY          u16 key_id, u8 key_len, char key[key_len]
+ *     TRACE_EVENT_INT          u16 key_id, i32 value
+ *     TRACE_EVENT_UINT         u16 key_id, u32 value
+ *     TRACE_EVENT_FLOAT        u16 key_id, f32 value
+ *     TRACE_EVENT_STR          u16 key_id, u8 value_len, char value[value_len]
+ *
+ * Attribute keys are defined by a key event the first time each thread uses
+ * them. The @c Test/astc_trace_convert.py script converts a trace into the
+ * JSON tree used by @c Test/astc_trace_analysis.py.
+ *
  * Usage
  * =====
  *
@@ -71,10 +100,35 @@
 
 #if defined(ASTCENC_DIAGNOSTICS)
 
-#include <iostream>
+#include <cstdint>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+#include "astcenc_mathlib.h"
+
+ASTCENC_NAMESPACE_BEGIN
+
+/**
+ * @brief The trace event types.
+ */
+enum trace_event : uint8_t
+{
+	TRACE_EVENT_NODE_BEGIN = 1,
+	TRACE_EVENT_NODE_END = 2,
+	TRACE_EVENT_KEY = 3,
+	TRACE_EVENT_INT = 4,
+	TRACE_EVENT_UINT = 5,
+	TRACE_EVENT_FLOAT = 6,
+	TRACE_EVENT_STR = 7
+};
+
+/**
+ * @brief The per-thread trace event buffer.
+ */
+struct TraceBuffer;
+
 /**
  * @brief Class representing a single node in the trace hierarchy.
  */
@@ -93,18 +147,6 @@ public:
 	 */
 	TraceNode(const char* format, ...);
 
-	/**
-	 * @brief Add an attribute to this node.
-	 *
-	 * Note that no quoting is applied to the @c value, so if quoting is
-	 * needed it must be done by the caller.
-	 *
-	 * @param type    The type of the attribute.
-	 * @param key     The key of the attribute.
-	 * @param value   The value of the attribute.
-	 */
-	void add_attrib(std::string type, std::string key, std::string value);
-
 	/**
 	 * @brief Destroy this node.
 	 *
@@ -113,11 +155,6 @@ public:
 	 * is not the current node; usage must conform to stack push-pop semantics.
 	 */
 	~TraceNode();
-
-	/**
-	 * @brief The number of attributes and child nodes in this node.
-	 */
-	unsigned int m_attrib_count { 0 };
 };
 
 /**
@@ -139,38 +176,44 @@ public:
 	 * @brief Detroy the trace log.
 	 *
 	 * Trace logs MUST be cleanly destroyed to ensure the file gets written.
+	 * No thread may be adding to the trace while it is destroyed.
 	 */
 	~TraceLog();
 
 	/**
-	 * @brief Get the current child node.
+	 * @brief Get the trace buffer of the calling thread, creating it if needed.
 	 *
-	 * @return The current leaf node.
+	 * @return The trace buffer.
 	 */
-	TraceNode* get_current_leaf();
+	TraceBuffer* get_thread_buffer();
 
 	/**
-	 * @brief Get the stack depth of the current child node.
+	 * @brief Write the contents of a trace buffer to the file as a chunk.
 	 *
-	 * @return The current leaf node stack depth.
+	 * @param buffer   The buffer, which is emptied.
 	 */
-	int get_depth();
+	void flush(TraceBuffer& buffer);
 
 	/**
 	 * @brief The file stream to write to.
 	 */
 	std::ofstream m_file;
 
+private:
 	/**
-	 * @brief The stack of nodes (newest at the back).
+	 * @brief The unique identifier of this trace log.
 	 */
-	std::vector<TraceNode*> m_stack;
+	unsigned int m_generation;
 
-private:
 	/**
-	 * @brief The root node in the JSON file.
+	 * @brief The lock for buffer creation and file writes.
 	 */
-	TraceNode* m_root;
+	std::mutex m_lock;
+
+	/**
+	 * @brief The trace buffers of all threads which have used this log.
+	 */
+	std::vector<std::unique_ptr<TraceBuffer>> m_buffers;
 };
 
 /**
@@ -184,7 +227,7 @@ private:
 /**
  * @brief Add a string annotation to the current node.
  *
- * @param key      The name of the attribute.
+ * @param key      The name of the attribute; must be a string literal.
  * @param format   The format template for the attribute value.
  * @param ...      The format parameters.
  */
@@ -193,7 +236,7 @@ void trace_add_data(const char* key, const char* format, ...);
 /**
  * @brief Add a float annotation to the current node.
  *
- * @param key     The name of the attribute.
+ * @param key     The name of the attribute; must be a string literal.
  * @param value   The value of the attribute.
  */
 void trace_add_data(const char* key, float value);
@@ -201,7 +244,7 @@ void trace_add_data(const char* key, float value);
 /**
  * @brief Add an integer annotation to the current node.
  *
- * @param key     The name of the attribute.
+ * @param key     The name of the attribute; must be a string literal.
  * @param value   The value of the attribute.
  */
 void trace_add_data(const char* key, int value);
@@ -209,11 +252,13 @@ void trace_add_data(const char* key, int value);
 /**
  * @brief Add an unsigned integer annotation to the current node.
  *
- * @param key     The name of the attribute.
+ * @param key     The name of the attribute; must be a string literal.
  * @param value   The value of the attribute.
  */
 void trace_add_data(const char* key, unsigned int value);
 
+ASTCENC_NAMESPACE_END
+
 #else
 
 #define TRACE_NODE(name, ...)
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Functions for the runtime ISA dispatch layer.
+ *
+ * Dispatch builds compile the whole codec once per ISA, each variant in its
+ * own namespace, and link all of the variants into a single library. This
+ * module implements the public API for those builds, selecting the best
+ * variant supported by the host CPU and forwarding each call to it. Dispatch
+ * happens once per API call, so the cost is amortized over whole images.
+ */
+
+#include <new>
+
+#include "astcenc.h"
+#include "astcenc_dispatch.h"
+
+namespace astcenc_avx512 { const astcenc_isa_variant& get_isa_variant(); }
+namespace astcenc_avx2 { const astcenc_isa_variant& get_isa_variant(); }
+namespace astcenc_sse41 { const astcenc_isa_variant& get_isa_variant(); }
+namespace astcenc_sse2 { const astcenc_isa_variant& get_isa_variant(); }
+
+/**
+ * @brief The dispatch layer context, wrapping a context of the chosen variant.
+ */
+struct astcenc_context
+{
+	/** @brief The variant which owns the wrapped context. */
+	const astcenc_isa_variant* variant;
+
+	/** @brief The wrapped variant context. */
+	void* impl;
+};
+
+/**
+ * @brief Get the best codec variant supported by the host CPU.
+ *
+ * The SSE2 variant is the x86-64 baseline, so is always supported.
+ *
+ * @return The selected variant.
+ */
+static const astcenc_isa_variant& get_host_variant()
+{
+	static const astcenc_isa_variant& host_variant = []() -> const astcenc_isa_variant& {
+		const astcenc_isa_variant* variants[] {
+			&astcenc_avx512::get_isa_variant(),
+			&astcenc_avx2::get_isa_variant(),
+			&astcenc_sse41::get_isa_variant()
+		};
+
+		for (const astcenc_isa_variant* variant : variants)
+		{
+			if (variant->validate_cpu_isa() == ASTCENC_SUCCESS)
+			{
+				return *variant;
+			}
+		}
+
+		return astcenc_sse2::get_isa_variant();
+	}();
+
+	return host_variant;
+}
+
+astcenc_error astcenc_config_init(
+	astcenc_profile profile,
+	unsigned int block_x,
+	unsigned int block_y,
+	unsigned int block_z,
+	float quality,
+	unsigned int flags,
+	astcenc_config& config
+) {
+	return get_host_variant().config_init(profile, block_x, block_y, block_z,
+	                                      quality, flags, config);
+}
+
+astcenc_error astcenc_context_alloc(
+	const astcenc_config& config,
+	unsigned int thread_count,
+	astcenc_context** context
+) {
+	astcenc_context* ctx = new (std::nothrow) astcenc_context;
+	if (!ctx)
+	{
+		*context = nullptr;
+		return ASTCENC_ERR_OUT_OF_MEM;
+	}
+
+	ctx->variant = &get_host_variant();
+	astcenc_error status = ctx->variant->context_alloc(config, thread_count, &ctx->impl);
+	if (status != ASTCENC_SUCCESS)
+	{
+		delete ctx;
+		ctx = nullptr;
+	}
+
+	*context = ctx;
+	return status;
+}
+
+astcenc_error astcenc_compress_image(
+	astcenc_context* ctx,
+	astcenc_image& image,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+	return ctx->variant->compress_image(ctx->impl, image, swizzle,
+	                                    data_out, data_len, thread_index);
+}
+
+astcenc_error astcenc_compress_image_region(
+	astcenc_context* ctx,
+	astcenc_image& image,
+	astcenc_swizzle swizzle,
+	const astcenc_block_region& region,
+	uint8_t* data_out,
+	size_t data_len,
+	size_t row_pitch,
+	unsigned int thread_index
+) {
+	return ctx->variant->compress_image_region(ctx->impl, image, swizzle, region,
+	                                           data_out, data_len, row_pitch,
+	                                           thread_index);
+}
+
+astcenc_error astcenc_compress_image_batch(
+	astcenc_context* ctx,
+	const astcenc_batch_image* batch,
+	unsigned int batch_size,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index
+) {
+	return ctx->variant->compress_image_batch(ctx->impl, batch, batch_size,
+	                                          swizzle, thread_index);
+}
+
+astcenc_error astcenc_compress_image_incremental(
+	astcenc_context* ctx,
+	astcenc_image& image,
+	const astcenc_image& prev_image,
+	const uint8_t* prev_data,
+	size_t prev_data_len,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+	return ctx->variant->compress_image_incremental(ctx->impl, image, prev_image,
+	                                                prev_data, prev_data_len, swizzle,
+	                                                data_out, data_len, thread_index);
+}
+
+astcenc_error astcenc_compress_image_hinted(
+	astcenc_context* ctx,
+	astcenc_image& image,
+	const uint8_t* hint_data,
+	size_t hint_data_len,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+	return ctx->variant->compress_image_hinted(ctx->impl, image, hint_data, hint_data_len,
+	                                           swizzle, data_out, data_len, thread_index);
+}
+
+astcenc_error astcenc_compress_reset(
+	astcenc_context* ctx
+) {
+	return ctx->variant->compress_reset(ctx->impl);
+}
+
+astcenc_error astcenc_compress_cancel(
+	astcenc_context* ctx
+) {
+	return ctx->variant->compress_cancel(ctx->impl);
+}
+
+astcenc_error astcenc_get_stats(
+	astcenc_context* ctx,
+	astcenc_stats& stats
+) {
+	return ctx->variant->get_stats(ctx->impl, stats);
+}
+
+astcenc_error astcenc_decompress_image(
+	astcenc_context* ctx,
+	const uint8_t* data,
+	size_t data_len,
+	astcenc_image& image_out,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index
+) {
+	return ctx->variant->decompress_image(ctx->impl, data, data_len,
+	                                      image_out, swizzle, thread_index);
+}
+
+astcenc_error astcenc_decompress_image_region(
+	astcenc_context* ctx,
+	const uint8_t* data,
+	size_t data_len,
+	size_t row_pitch,
+	size_t slice_pitch,
+	unsigned int origin_x,
+	unsigned int origin_y,
+	unsigned int origin_z,
+	astcenc_image& image_out,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index
+) {
+	return ctx->variant->decompress_image_region(ctx->impl, data, data_len,
+	                                             row_pitch, slice_pitch,
+	                                             origin_x, origin_y, origin_z,
+	                                             image_out, swizzle, thread_index);
+}
+
+astcenc_error astcenc_decompress_reset(
+	astcenc_context* ctx
+) {
+	return ctx->variant->decompress_reset(ctx->impl);
+}
+
+void astcenc_context_free(
+	astcenc_context* ctx
+) {
+	if (ctx)
+	{
+		ctx->variant->context_free(ctx->impl);
+		delete ctx;
+	}
+}
+
+const char* astcenc_get_error_string(
+	astcenc_error status
+) {
+	return get_host_variant().get_error_string(status);
+}
+
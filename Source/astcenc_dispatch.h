@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Declarations for the runtime ISA dispatch layer.
+ *
+ * Builds with runtime ISA dispatch compile the codec once per ISA, each in its
+ * own namespace, and select the best variant supported by the host when a
+ * context is allocated. Each variant exports a table of its public entry
+ * points, with variant contexts passed as opaque pointers.
+ */
+
+#ifndef ASTCENC_DISPATCH_INCLUDED
+#define ASTCENC_DISPATCH_INCLUDED
+
+#include "astcenc.h"
+
+/**
+ * @brief The public entry points of one ISA variant of the codec.
+ */
+struct astcenc_isa_variant
+{
+	/** @brief The printable name of the ISA. */
+	const char* name;
+
+	/** @brief Test if the host CPU supports this variant. */
+	astcenc_error (*validate_cpu_isa)();
+
+	/** @brief Variant implementation of astcenc_config_init(). */
+	astcenc_error (*config_init)(
+		astcenc_profile profile,
+		unsigned int block_x,
+		unsigned int block_y,
+		unsigned int block_z,
+		float quality,
+		unsigned int flags,
+		astcenc_config& config);
+
+	/** @brief Variant implementation of astcenc_context_alloc(). */
+	astcenc_error (*context_alloc)(
+		const astcenc_config& config,
+		unsigned int thread_count,
+		void** context);
+
+	/** @brief Variant implementation of astcenc_compress_image(). */
+	astcenc_error (*compress_image)(
+		void* context,
+		astcenc_image& image,
+		astcenc_swizzle swizzle,
+		uint8_t* data_out,
+		size_t data_len,
+		unsigned int thread_index);
+
+	/** @brief Variant implementation of astcenc_compress_image_region(). */
+	astcenc_error (*compress_image_region)(
+		void* context,
+		astcenc_image& image,
+		astcenc_swizzle swizzle,
+		const astcenc_block_region& region,
+		uint8_t* data_out,
+		size_t data_len,
+		size_t row_pitch,
+		unsigned int thread_index);
+
+	/** @brief Variant implementation of astcenc_compress_image_batch(). */
+	astcenc_error (*compress_image_batch)(
+		void* context,
+		const astcenc_batch_image* batch,
+		unsigned int batch_size,
+		astcenc_swizzle swizzle,
+		unsigned int thread_index);
+
+	/** @brief Variant implementation of astcenc_compress_image_incremental(). */
+	astcenc_error (*compress_image_incremental)(
+		void* context,
+		astcenc_image& image,
+		const astcenc_image& prev_image,
+		const uint8_t* prev_data,
+		size_t prev_data_len,
+		astcenc_swizzle swizzle,
+		uint8_t* data_out,
+		size_t data_len,
+		unsigned int thread_index);
+
+	/** @brief Variant implementation of astcenc_compress_image_hinted(). */
+	astcenc_error (*compress_image_hinted)(
+		void* context,
+		astcenc_image& image,
+		const uint8_t* hint_data,
+		size_t hint_data_len,
+		astcenc_swizzle swizzle,
+		uint8_t* data_out,
+		size_t data_len,
+		unsigned int thread_index);
+
+	/** @brief Variant implementation of astcenc_compress_reset(). */
+	astcenc_error (*compress_reset)(
+		void* context);
+
+	/** @brief Variant implementation of astcenc_compress_cancel(). */
+	astcenc_error (*compress_cancel)(
+		void* context);
+
+	/** @brief Variant implementation of astcenc_get_stats(). */
+	astcenc_error (*get_stats)(
+		void* context,
+		astcenc_stats& stats);
+
+	/** @brief Variant implementation of astcenc_decompress_image(). */
+	astcenc_error (*decompress_image)(
+		void* context,
+		const uint8_t* data,
+		size_t data_len,
+		astcenc_image& image_out,
+		astcenc_swizzle swizzle,
+		unsigned int thread_index);
+
+	/** @brief Variant implementation of astcenc_decompress_image_region(). */
+	astcenc_error (*decompress_image_region)(
+		void* context,
+		const uint8_t* data,
+		size_t data_len,
+		size_t row_pitch,
+		size_t slice_pitch,
+		unsigned int origin_x,
+		unsigned int origin_y,
+		unsigned int origin_z,
+		astcenc_image& image_out,
+		astcenc_swizzle swizzle,
+		unsigned int thread_index);
+
+	/** @brief Variant implementation of astcenc_decompress_reset(). */
+	astcenc_error (*decompress_reset)(
+		void* context);
+
+	/** @brief Variant implementation of astcenc_context_free(). */
+	void (*context_free)(
+		void* context);
+
+	/** @brief Variant implementation of astcenc_get_error_string(). */
+	const char* (*get_error_string)(
+		astcenc_error status);
+};
+
+#if defined(ASTCENC_DISPATCH_NAMESPACE)
+namespace ASTCENC_DISPATCH_NAMESPACE {
+
+/**
+ * @brief Get the entry points of the ISA variant in this namespace.
+ *
+ * @return The variant entry point table.
+ */
+const astcenc_isa_variant& get_isa_variant();
+
+}
+#endif
+
+#endif
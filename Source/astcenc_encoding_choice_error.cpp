@@ -41,6 +41,8 @@
 
 #include "astcenc_internal.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 // helper function to merge two endpoint-colors
 void merge_endpoints(
 	const endpoints * ep1,	// contains three of the color components
@@ -285,4 +287,6 @@ void compute_encoding_choice_errors(
 	}
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
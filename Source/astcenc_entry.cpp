@@ -20,12 +20,18 @@
  */
 
 #include <array>
+#include <cassert>
+#include <chrono>
 #include <cstring>
 #include <new>
+#include <thread>
 
 #include "astcenc.h"
 #include "astcenc_internal.h"
 #include "astcenc_diagnostic_trace.h"
+#include "astcenc_dispatch.h"
+
+ASTCENC_NAMESPACE_BEGIN
 
 // The ASTC codec is written with the assumption that a float threaded through
 // the "if32" union will in fact be stored and reloaded as a 32-bit IEEE-754 single-precision
@@ -64,6 +70,13 @@ static astcenc_error validate_cpu_isa()
 		}
 	#endif
 
+	#if ASTCENC_F16C >= 1
+		if (!cpu_supports_f16c())
+		{
+			return ASTCENC_ERR_BAD_CPU_ISA;
+		}
+	#endif
+
 	#if ASTCENC_AVX >= 2
 		if (!cpu_supports_avx2())
 		{
@@ -71,6 +84,13 @@ static astcenc_error validate_cpu_isa()
 		}
 	#endif
 
+	#if ASTCENC_AVX >= 512
+		if (!cpu_supports_avx512())
+		{
+			return ASTCENC_ERR_BAD_CPU_ISA;
+		}
+	#endif
+
 	return ASTCENC_SUCCESS;
 }
 
@@ -96,6 +116,7 @@ struct astcenc_preset_config {
 	float tune_refinement_mse_overshoot;
 	float tune_partition_early_out_limit;
 	float tune_two_plane_early_out_limit;
+	float tune_weight_converged_fraction;
 };
 
 /**
@@ -104,19 +125,19 @@ struct astcenc_preset_config {
 static const std::array<astcenc_preset_config, 5> preset_configs {{
 	{
 		ASTCENC_PRE_FASTEST,
-		2, 25, 1, 1, 75, 53, 1.0f, 1.0f, 1.0f, 0.5f
+		2, 25, 1, 1, 75, 53, 1.0f, 1.0f, 1.0f, 0.5f, 0.0f
 	}, {
 		ASTCENC_PRE_FAST,
-		4, 50, 1, 2, 85, 63, 2.5f, 2.5f, 1.0f, 0.5f
+		4, 50, 1, 2, 85, 63, 2.5f, 2.5f, 1.0f, 0.5f, 0.0f
 	}, {
 		ASTCENC_PRE_MEDIUM,
-		25, 75, 2, 2,  95, 70, 1.75f, 1.75f, 1.2f, 0.75f
+		25, 75, 2, 2,  95, 70, 1.75f, 1.75f, 1.2f, 0.75f, 0.1f
 	}, {
 		ASTCENC_PRE_THOROUGH,
-		100, 95, 4, 3, 105, 77, 10.0f, 10.0f, 2.5f, 0.95f
+		100, 95, 4, 3, 105, 77, 10.0f, 10.0f, 2.5f, 0.95f, 0.1f
 	}, {
 		ASTCENC_PRE_EXHAUSTIVE,
-		1024, 100, 4, 4, 200, 200, 10.0f, 10.0f, 10.0f, 0.99f
+		1024, 100, 4, 4, 200, 200, 10.0f, 10.0f, 10.0f, 0.99f, 0.0f
 	}
 }};
 
@@ -239,6 +260,38 @@ static astcenc_error validate_decompression_swizzle(
 	return ASTCENC_SUCCESS;
 }
 
+/**
+ * Validate that the memory layout of an image is in-spec.
+ *
+ * Pitches must hold a complete row or slice, and must keep every row aligned
+ * to the channel data type.
+ */
+static astcenc_error validate_image_layout(
+	const astcenc_image& image
+) {
+	if (image.components > 4)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	size_t component_size = get_image_component_size(image);
+	size_t row_bytes = image.dim_x * get_image_components(image) * component_size;
+	if ((image.row_pitch != 0) &&
+	    ((image.row_pitch < row_bytes) || (image.row_pitch % component_size)))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	size_t slice_bytes = get_image_row_pitch(image) * image.dim_y;
+	if ((image.slice_pitch != 0) &&
+	    ((image.slice_pitch < slice_bytes) || (image.slice_pitch % component_size)))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	return ASTCENC_SUCCESS;
+}
+
 /**
  * Validate that an incoming configuration is in-spec.
  *
@@ -250,8 +303,7 @@ static astcenc_error validate_decompression_swizzle(
  *     make no sense algorithmically will return an error.
  */
 static astcenc_error validate_config(
-	astcenc_config &config,
-	unsigned int thread_count
+	astcenc_config &config
 ) {
 	astcenc_error status;
 
@@ -273,12 +325,6 @@ static astcenc_error validate_config(
 		return status;
 	}
 
-	// Decompress-only contexts must be single threaded
-	if ((config.flags & ASTCENC_FLG_DECOMPRESS_ONLY) && (thread_count > 1))
-	{
-		return ASTCENC_ERR_BAD_PARAM;
-	}
-
 #if defined(ASTCENC_DECOMPRESS_ONLY)
 	// Decompress-only builds only support decompress-only contexts
 	if (!(config.flags & ASTCENC_FLG_DECOMPRESS_ONLY))
@@ -308,6 +354,9 @@ static astcenc_error validate_config(
 	config.tune_refinement_mse_overshoot = astc::max(config.tune_refinement_mse_overshoot, 1.0f);
 	config.tune_partition_early_out_limit = astc::max(config.tune_partition_early_out_limit, 0.0f);
 	config.tune_two_plane_early_out_limit = astc::max(config.tune_two_plane_early_out_limit, 0.0f);
+	config.tune_weight_converged_fraction = astc::max(config.tune_weight_converged_fraction, 0.0f);
+	config.tune_time_budget = astc::max(config.tune_time_budget, 0.0f);
+	config.tune_rdo_lambda = astc::max(config.tune_rdo_lambda, 0.0f);
 
 	// Specifying a zero weight color component is not allowed; force to small value
 	float max_weight = astc::max(astc::max(config.cw_r_weight, config.cw_g_weight),
@@ -399,6 +448,7 @@ astcenc_error astcenc_config_init(
 
 		config.tune_partition_early_out_limit = preset_configs[start].tune_partition_early_out_limit;
 		config.tune_two_plane_early_out_limit = preset_configs[start].tune_two_plane_early_out_limit;
+		config.tune_weight_converged_fraction = preset_configs[start].tune_weight_converged_fraction;
 	}
 	// Start and end node are not the same - so interpolate between them
 	else
@@ -432,6 +482,7 @@ astcenc_error astcenc_config_init(
 
 		config.tune_partition_early_out_limit = LERP(tune_partition_early_out_limit);
 		config.tune_two_plane_early_out_limit = LERP(tune_two_plane_early_out_limit);
+		config.tune_weight_converged_fraction = LERP(tune_weight_converged_fraction);
 
 		#undef LERP
 		#undef LERPI
@@ -479,8 +530,6 @@ astcenc_error astcenc_config_init(
 		config.v_a_base = 0.05f;
 		config.v_a_mean = 0.0f;
 		config.v_a_stdev = 0.0f;
-
-		config.tune_db_limit = 999.0f;
 		break;
 	case ASTCENC_PRF_HDR:
 		config.v_rgb_power = 0.75f;
@@ -492,8 +541,6 @@ astcenc_error astcenc_config_init(
 		config.v_a_base = 0.0f;
 		config.v_a_mean = 1.0f;
 		config.v_a_stdev = 0.0f;
-
-		config.tune_db_limit = 999.0f;
 		break;
 	default:
 		return ASTCENC_ERR_BAD_PROFILE;
@@ -512,7 +559,6 @@ astcenc_error astcenc_config_init(
 		config.cw_g_weight = 0.0f;
 		config.cw_b_weight = 0.0f;
 		config.cw_a_weight = 1.0f;
-		config.tune_partition_early_out_limit = 1000.0f;
 		config.tune_two_plane_early_out_limit = 0.99f;
 
 		if (flags & ASTCENC_FLG_USE_PERCEPTUAL)
@@ -542,6 +588,117 @@ astcenc_error astcenc_config_init(
 	return ASTCENC_SUCCESS;
 }
 
+#if !defined(ASTCENC_DECOMPRESS_ONLY)
+/**
+ * @brief Convert a dB limit into a per-texel error threshold.
+ *
+ * For LDR profiles this is the squared error of a UNORM16 texel at the given
+ * PSNR. Normal maps use the same threshold, but the compressor normalizes it
+ * by the angular error weights, so it acts as a bound on the mean squared
+ * angular error of the unit normal.
+ *
+ * For HDR profiles the texel data is stored as LNS, where 2048 units is one
+ * stop, so the threshold is a bound on the log2 error of each texel. The dB
+ * limit is mapped to a relative error of @c HDR_STOPS_AT_0DB * 10^(-dB/20)
+ * stops, which gives a similar quality trade-off to the LDR presets.
+ *
+ * @param profile    The color profile.
+ * @param db_limit   The limit in dB.
+ *
+ * @return The per-texel error threshold.
+ */
+static float get_texel_error_limit(
+	astcenc_profile profile,
+	float db_limit
+) {
+	if ((profile == ASTCENC_PRF_LDR) || (profile == ASTCENC_PRF_LDR_SRGB))
+	{
+		return powf(0.1f, db_limit * 0.1f) * 65535.0f * 65535.0f;
+	}
+
+	static const float HDR_STOPS_AT_0DB = 4.0f;
+	float lns_error = HDR_STOPS_AT_0DB * powf(0.1f, db_limit * 0.05f) * 2048.0f;
+	return lns_error * lns_error;
+}
+
+/**
+ * @brief Initialize the search limits for each time budget effort level.
+ *
+ * The highest level uses the configured limits, and the lowest level uses
+ * the limits of the fastest preset, or the configured limits if lower. The
+ * intermediate levels are interpolated between the two. All levels test the
+ * configured block modes. This must be called before the configured dB limit
+ * is converted to a per-texel error.
+ *
+ * If adaptive effort is enabled its first pass uses the lowest level limits,
+ * but only tests the block modes of the fastest preset.
+ *
+ * @param[in,out] ctx   The context to initialize.
+ */
+static void init_search_limits(
+	astcenc_context& ctx
+) {
+	const astcenc_config& config = ctx.config;
+	const astcenc_preset_config& floor = preset_configs[0];
+
+	float texels = static_cast<float>(config.block_x * config.block_y * config.block_z);
+	float ltexels = logf(texels) / logf(10.0f);
+	float floor_db_limit = astc::max(floor.tune_db_limit_a_base - 35 * ltexels,
+	                                 floor.tune_db_limit_b_base - 19 * ltexels);
+
+	block_search_limits lo;
+	lo.partition_limit = astc::min(floor.tune_partition_limit, config.tune_partition_limit);
+	lo.candidate_limit = astc::min(floor.tune_candidate_limit, config.tune_candidate_limit);
+	lo.refinement_limit = astc::min(floor.tune_refinement_limit, config.tune_refinement_limit);
+	lo.db_limit = astc::min(floor_db_limit, config.tune_db_limit);
+	lo.mode0_mse_overshoot = astc::min(floor.tune_mode0_mse_overshoot, config.tune_mode0_mse_overshoot);
+	lo.partition_early_out_limit = astc::min(floor.tune_partition_early_out_limit, config.tune_partition_early_out_limit);
+	lo.two_plane_early_out_limit = astc::min(floor.tune_two_plane_early_out_limit, config.tune_two_plane_early_out_limit);
+
+	for (unsigned int i = 0; i < BUDGET_EFFORT_LEVELS; i++)
+	{
+		float w = static_cast<float>(i) / static_cast<float>(BUDGET_EFFORT_LEVELS - 1);
+
+		auto lerpui = [w](unsigned int a, unsigned int b) {
+			return a + static_cast<unsigned int>(astc::flt2int_rtn(w * static_cast<float>(b - a)));
+		};
+
+		// The top level must exactly match the configuration
+		auto lerpf = [w](float a, float b) {
+			return w == 1.0f ? b : a + w * (b - a);
+		};
+
+		block_search_limits& limits = ctx.search_limits[i];
+		limits.bsd = ctx.bsd;
+		limits.partition_limit = lerpui(lo.partition_limit, config.tune_partition_limit);
+		limits.candidate_limit = lerpui(lo.candidate_limit, config.tune_candidate_limit);
+		limits.refinement_limit = lerpui(lo.refinement_limit, config.tune_refinement_limit);
+		limits.mode0_mse_overshoot = lerpf(lo.mode0_mse_overshoot, config.tune_mode0_mse_overshoot);
+		limits.partition_early_out_limit = lerpf(lo.partition_early_out_limit, config.tune_partition_early_out_limit);
+		limits.two_plane_early_out_limit = lerpf(lo.two_plane_early_out_limit, config.tune_two_plane_early_out_limit);
+
+		// Skipping more precise weight encodings costs too much quality for 3D blocks
+		limits.weight_converged_fraction = config.block_z > 1 ? 0.0f : config.tune_weight_converged_fraction;
+
+		float db_limit = lerpf(lo.db_limit, config.tune_db_limit);
+		limits.db_limit = get_texel_error_limit(config.profile, db_limit);
+	}
+
+	ctx.effort_level.store(BUDGET_EFFORT_LEVELS - 1, std::memory_order_relaxed);
+
+	ctx.adaptive_limits = ctx.search_limits[0];
+	ctx.adaptive_limits.bsd = nullptr;
+	if (config.flags & ASTCENC_FLG_ADAPTIVE_EFFORT)
+	{
+		bool can_omit_modes = config.flags & ASTCENC_FLG_SELF_DECOMPRESS_ONLY;
+		unsigned int mode_limit = astc::min(floor.tune_block_mode_limit, config.tune_block_mode_limit);
+		ctx.adaptive_limits.bsd = acquire_block_size_descriptor(
+		    config.block_x, config.block_y, config.block_z, can_omit_modes,
+		    static_cast<float>(mode_limit) / 100.0f, false);
+	}
+}
+#endif
+
 astcenc_error astcenc_context_alloc(
 	astcenc_config const& config,
 	unsigned int thread_count,
@@ -549,7 +706,7 @@ astcenc_error astcenc_context_alloc(
 ) {
 	astcenc_error status;
 	astcenc_context* ctx = nullptr;
-	block_size_descriptor* bsd = nullptr;
+	const block_size_descriptor* bsd = nullptr;
 
 	status = validate_cpu_float();
 	if (status != ASTCENC_SUCCESS)
@@ -568,14 +725,6 @@ astcenc_error astcenc_context_alloc(
 		return ASTCENC_ERR_BAD_PARAM;
 	}
 
-#if defined(ASTCENC_DIAGNOSTICS)
-	// Force single threaded compressor use in diagnostic mode.
-	if (thread_count != 1)
-	{
-		return ASTCENC_ERR_BAD_PARAM;
-	}
-#endif
-
 	ctx = new astcenc_context;
 	ctx->thread_count = thread_count;
 	ctx->config = config;
@@ -586,47 +735,71 @@ astcenc_error astcenc_context_alloc(
 	ctx->input_variances = nullptr;
 	ctx->input_alpha_averages = nullptr;
 
+#if !defined(ASTCENC_DECOMPRESS_ONLY)
+	ctx->jobs = nullptr;
+	ctx->job_count = 0;
+	ctx->bands = nullptr;
+	ctx->avg_var_work_memory = nullptr;
+	ctx->avg_var_work_memory_size = 0;
+	ctx->cache = block_cache {};
+	ctx->job_scratch = scratch_arena {};
+	ctx->band_scratch = scratch_arena {};
+	ctx->cache_scratch = scratch_arena {};
+	ctx->schedule_scratch = scratch_arena {};
+	ctx->stats = astcenc_stats {};
+	ctx->adaptive_limits.bsd = nullptr;
+	ctx->cancel_requested.store(false, std::memory_order_relaxed);
+	ctx->compress_cancelled = false;
+	ctx->progress_reported = 0;
+#endif
+
 	// Copy the config first and validate the copy (we may modify it)
-	status = validate_config(ctx->config, thread_count);
+	status = validate_config(ctx->config);
 	if (status != ASTCENC_SUCCESS)
 	{
 		delete ctx;
 		return status;
 	}
 
-	bsd = new block_size_descriptor;
+	// Contexts with the same block size and mode settings share a descriptor
 	bool can_omit_modes = config.flags & ASTCENC_FLG_SELF_DECOMPRESS_ONLY;
-	init_block_size_descriptor(config.block_x, config.block_y, config.block_z,
-	                           can_omit_modes, static_cast<float>(config.tune_block_mode_limit) / 100.0f, bsd);
+	bool lazy_tables = config.flags & ASTCENC_FLG_DECOMPRESS_ONLY;
+	bsd = acquire_block_size_descriptor(config.block_x, config.block_y, config.block_z,
+	                                    can_omit_modes, static_cast<float>(config.tune_block_mode_limit) / 100.0f,
+	                                    lazy_tables);
 	ctx->bsd = bsd;
 
 #if !defined(ASTCENC_DECOMPRESS_ONLY)
 	// Do setup only needed by compression
-	if (!(status & ASTCENC_FLG_DECOMPRESS_ONLY))
+	if (!(ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY))
 	{
 		// Expand deblock supression into a weight scale per texel in the block
 		expand_deblock_weights(*ctx);
 
+		// Precompute the search limits used for time budgeted compression
+		init_search_limits(*ctx);
+
 		// Turn a dB limit into a per-texel error for faster use later
-		if ((ctx->config.profile == ASTCENC_PRF_LDR) || (ctx->config.profile == ASTCENC_PRF_LDR_SRGB))
-		{
-			ctx->config.tune_db_limit = powf(0.1f, ctx->config.tune_db_limit * 0.1f) * 65535.0f * 65535.0f;
-		}
-		else
-		{
-			ctx->config.tune_db_limit = 0.0f;
-		}
+		ctx->config.tune_db_limit = get_texel_error_limit(ctx->config.profile, ctx->config.tune_db_limit);
 
-		size_t worksize = sizeof(compress_symbolic_block_buffers) * thread_count;
-		ctx->working_buffers = aligned_malloc<compress_symbolic_block_buffers>(worksize , 32);
+		ctx->working_buffers = new (std::nothrow) compress_symbolic_block_buffers*[thread_count];
 		if (!ctx->working_buffers)
 		{
-			term_block_size_descriptor(bsd);
-			delete bsd;
+			if (ctx->adaptive_limits.bsd)
+			{
+				release_block_size_descriptor(ctx->adaptive_limits.bsd);
+			}
+
+			release_block_size_descriptor(bsd);
 			delete ctx;
 			*context = nullptr;
 			return ASTCENC_ERR_OUT_OF_MEM;
 		}
+
+		for (unsigned int i = 0; i < thread_count; i++)
+		{
+			ctx->working_buffers[i] = nullptr;
+		}
 	}
 #endif
 
@@ -658,229 +831,1679 @@ void astcenc_context_free(
 ) {
 	if (ctx)
 	{
-		aligned_free<compress_symbolic_block_buffers>(ctx->working_buffers);
-		term_block_size_descriptor(ctx->bsd);
+#if !defined(ASTCENC_DECOMPRESS_ONLY)
+		if (ctx->working_buffers)
+		{
+			for (unsigned int i = 0; i < ctx->thread_count; i++)
+			{
+				aligned_free<compress_symbolic_block_buffers>(ctx->working_buffers[i]);
+			}
+
+			delete[] ctx->working_buffers;
+		}
+
+		aligned_free<uint8_t>(ctx->job_scratch.data);
+		aligned_free<uint8_t>(ctx->band_scratch.data);
+		aligned_free<uint8_t>(ctx->cache_scratch.data);
+		aligned_free<uint8_t>(ctx->schedule_scratch.data);
+
+		if (ctx->adaptive_limits.bsd)
+		{
+			release_block_size_descriptor(ctx->adaptive_limits.bsd);
+		}
+#endif
+		release_block_size_descriptor(ctx->bsd);
 #if defined(ASTCENC_DIAGNOSTICS)
 		delete ctx->trace_log;
 #endif
-		delete ctx->bsd;
 		delete ctx;
 	}
 }
 
 #if !defined(ASTCENC_DECOMPRESS_ONLY)
-static void compress_image(
-	astcenc_context& ctx,
-	unsigned int thread_index,
-	const astcenc_image& image,
-	astcenc_swizzle swizzle,
-	uint8_t* buffer
-) {
-	const block_size_descriptor *bsd = ctx.bsd;
-	int block_x = bsd->xdim;
-	int block_y = bsd->ydim;
-	int block_z = bsd->zdim;
-	astcenc_profile decode_mode = ctx.config.profile;
-
-	imageblock pb;
-	int dim_x = image.dim_x;
-	int dim_y = image.dim_y;
-	int dim_z = image.dim_z;
-	int xblocks = (dim_x + block_x - 1) / block_x;
-	int yblocks = (dim_y + block_y - 1) / block_y;
-	int zblocks = (dim_z + block_z - 1) / block_z;
-
-	int row_blocks = xblocks;
-	int plane_blocks = xblocks * yblocks;
-
-	// Use preallocated scratch buffer
-	auto temp_buffers = &(ctx.working_buffers[thread_index]);
+/**
+ * @brief The alignment of scratch arena allocations, in bytes.
+ */
+static const size_t SCRATCH_ALIGNMENT = 64;
 
-	// Only the first thread actually runs the initializer
-	ctx.manage_compress.init(zblocks * yblocks * xblocks);
+/**
+ * @brief Get the arena space needed for an array allocation.
+ *
+ * @param count   The number of array elements.
+ *
+ * @return The allocation size in bytes, including alignment padding.
+ */
+template<typename T>
+static size_t get_scratch_size(
+	size_t count
+) {
+	size_t size = count * sizeof(T);
+	return (size + SCRATCH_ALIGNMENT - 1) & ~(SCRATCH_ALIGNMENT - 1);
+}
 
-	// All threads run this processing loop until there is no work remaining
-	while (true)
+/**
+ * @brief Reserve space in a scratch arena, freeing all existing allocations.
+ *
+ * The arena memory is only reallocated if it is smaller than @c size.
+ *
+ * @param arena   The arena to reserve.
+ * @param size    The arena size needed, in bytes.
+ */
+static void scratch_reserve(
+	scratch_arena& arena,
+	size_t size
+) {
+	if (size > arena.capacity)
 	{
-		unsigned int count;
-		unsigned int base = ctx.manage_compress.get_task_assignment(4, count);
-		if (!count)
-		{
-			break;
-		}
-
-		for (unsigned int i = base; i < base + count; i++)
-		{
-			// Decode i into x, y, z block indices
-			int z = i / plane_blocks;
-			unsigned int rem = i - (z * plane_blocks);
-			int y = rem / row_blocks;
-			int x = rem - (y * row_blocks);
+		aligned_free<uint8_t>(arena.data);
+		arena.data = aligned_malloc<uint8_t>(size, SCRATCH_ALIGNMENT);
+		arena.capacity = arena.data ? size : 0;
+	}
 
-			// Test if we can apply some basic alpha-scale RDO
-			bool use_full_block = true;
-			if (ctx.config.a_scale_radius != 0 && block_z == 1)
-			{
-				int start_x = x * block_x;
-				int end_x = astc::min(dim_x, start_x + block_x);
+	arena.used = 0;
+}
 
-				int start_y = y * block_y;
-				int end_y = astc::min(dim_y, start_y + block_y);
+/**
+ * @brief Allocate an array from a scratch arena.
+ *
+ * The arena must have been reserved with enough space for all allocations,
+ * and the allocated memory is not initialized.
+ *
+ * @param arena   The arena to allocate from.
+ * @param count   The number of array elements.
+ *
+ * @return The allocated array.
+ */
+template<typename T>
+static T* scratch_alloc(
+	scratch_arena& arena,
+	size_t count
+) {
+	size_t size = get_scratch_size<T>(count);
+	assert(arena.used + size <= arena.capacity);
 
-				// SATs accumulate error, so don't test exactly zero. Test for
-				// less than 1 alpha in the expanded block footprint that
-				// includes the alpha radius.
-				int x_footprint = block_x +
-				                  2 * (ctx.config.a_scale_radius - 1);
+	T* ptr = reinterpret_cast<T*>(arena.data + arena.used);
+	arena.used += size;
+	return ptr;
+}
 
-				int y_footprint = block_y +
-				                  2 * (ctx.config.a_scale_radius - 1);
+/**
+ * @brief Free the memory of a scratch arena.
+ *
+ * @param arena   The arena to release.
+ */
+static void scratch_release(
+	scratch_arena& arena
+) {
+	aligned_free<uint8_t>(arena.data);
+	arena = scratch_arena {};
+}
 
-				float footprint = (float)(x_footprint * y_footprint);
-				float threshold = 0.9f / (255.0f * footprint);
+/**
+ * @brief Get the number of blocks in a block region.
+ */
+static unsigned int get_region_block_count(
+	const astcenc_block_region& region
+) {
+	return region.dim_x * region.dim_y * region.dim_z;
+}
 
-				// Do we have any alpha values?
-				use_full_block = false;
-				for (int ay = start_y; ay < end_y; ay++)
-				{
-					for (int ax = start_x; ax < end_x; ax++)
-					{
-						float a_avg = ctx.input_alpha_averages[ay * dim_x + ax];
-						if (a_avg > threshold)
-						{
-							use_full_block = true;
-							ax = end_x;
-							ay = end_y;
-						}
-					}
-				}
-			}
+/**
+ * @brief Get the full block region for an image.
+ */
+static astcenc_block_region get_image_block_region(
+	const astcenc_context& ctx,
+	const astcenc_image& image
+) {
+	unsigned int block_x = ctx.config.block_x;
+	unsigned int block_y = ctx.config.block_y;
+	unsigned int block_z = ctx.config.block_z;
+
+	astcenc_block_region region;
+	region.origin_x = 0;
+	region.origin_y = 0;
+	region.origin_z = 0;
+	region.dim_x = (image.dim_x + block_x - 1) / block_x;
+	region.dim_y = (image.dim_y + block_y - 1) / block_y;
+	region.dim_z = (image.dim_z + block_z - 1) / block_z;
+	return region;
+}
 
-			// Fetch the full block for compression
-			if (use_full_block)
-			{
-				fetch_imageblock(decode_mode, image, &pb, bsd, x * block_x, y * block_y, z * block_z, swizzle);
-			}
-			// Apply alpha scale RDO - substitute constant color block
-			else
-			{
-				pb.origin_texel = vfloat4::zero();
-				pb.data_min = vfloat4::zero();
-				pb.data_max = pb.data_min;
-				pb.grayscale = false;
-			}
+/**
+ * @brief The number of bands of averages and variances computed ahead of the
+ * band being compressed.
+ */
+static const unsigned int BAND_LOOKAHEAD = 2;
 
-			int offset = ((z * yblocks + y) * xblocks + x) * 16;
-			uint8_t *bp = buffer + offset;
-			physical_compressed_block* pcb = reinterpret_cast<physical_compressed_block*>(bp);
-			symbolic_compressed_block scb;
-			compress_block(ctx, image, &pb, scb, *pcb, temp_buffers);
-		}
+/**
+ * @brief The maximum number of band buffers stored for each compression job.
+ *
+ * This must be larger than the lookahead, so that computing a band does not
+ * need to wait for the compression of the immediately preceding band.
+ */
+static const unsigned int BAND_SLOTS = BAND_LOOKAHEAD + 2;
 
-		ctx.manage_compress.complete_task_assignment(count);
-	}
+/**
+ * @brief Test if the compressor configuration needs averages and variances.
+ */
+static bool needs_avg_var(
+	const astcenc_config& config
+) {
+	return config.v_rgb_mean != 0.0f || config.v_rgb_stdev != 0.0f ||
+	       config.v_a_mean != 0.0f || config.v_a_stdev != 0.0f ||
+	       config.a_scale_radius != 0;
 }
-#endif
 
-astcenc_error astcenc_compress_image(
-	astcenc_context* ctx,
-	astcenc_image& image,
-	astcenc_swizzle swizzle,
-	uint8_t* data_out,
-	size_t data_len,
-	unsigned int thread_index
+/**
+ * @brief Get the number of blocks in a band of a compression job.
+ */
+static unsigned int get_band_block_count(
+	const compress_job& job,
+	unsigned int band
 ) {
-#if defined(ASTCENC_DECOMPRESS_ONLY)
-	(void)ctx;
-	(void)image;
-	(void)swizzle;
-	(void)data_out;
-	(void)data_len;
-	(void)thread_index;
-	return ASTCENC_ERR_BAD_CONTEXT;
-#else
-	astcenc_error status;
+	const avg_var_args& ag = job.ag;
+	unsigned int band_y = band % ag.bands_y;
+	unsigned int row = band_y * ag.band_block_rows;
+	unsigned int rows = astc::min(ag.band_block_rows, job.region.dim_y - row);
+	return rows * job.region.dim_x;
+}
 
-	if (ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+/**
+ * @brief Get the number of tasks in a pipeline step of a compression job.
+ *
+ * Step @c N computes the averages and variances for band @c N, and then
+ * compresses the blocks of band @c N - @c BAND_LOOKAHEAD.
+ */
+static unsigned int get_band_step_task_count(
+	const compress_job& job,
+	unsigned int step
+) {
+	unsigned int count = 0;
+	if (step < job.ag.band_count)
 	{
-		return ASTCENC_ERR_BAD_CONTEXT;
+		count += job.ag.band_tasks;
 	}
 
-	status = validate_compression_swizzle(swizzle);
-	if (status != ASTCENC_SUCCESS)
+	if (step >= BAND_LOOKAHEAD)
 	{
-		return status;
+		count += get_band_block_count(job, step - BAND_LOOKAHEAD) / job.task_blocks;
 	}
 
-	if (thread_index >= ctx->thread_count)
-	{
-		return ASTCENC_ERR_BAD_PARAM;
-	}
+	return count;
+}
 
-	unsigned int block_x = ctx->config.block_x;
-	unsigned int block_y = ctx->config.block_y;
-	unsigned int block_z = ctx->config.block_z;
+/**
+ * @brief Get the averages and variances buffers for a band of a compression job.
+ */
+static avg_var_buffers get_band_buffers(
+	const compress_job& job,
+	unsigned int band
+) {
+	size_t offset = (band % job.band_slots) * (size_t)job.ag.band_texel_count;
 
-	unsigned int xblocks = (image.dim_x + block_x - 1) / block_x;
-	unsigned int yblocks = (image.dim_y + block_y - 1) / block_y;
-	unsigned int zblocks = (image.dim_z + block_z - 1) / block_z;
+	avg_var_buffers storage = job.band_storage;
+	storage.input_averages += offset;
+	storage.input_variances += offset;
+	storage.input_alpha_averages += offset;
+	return get_band_avg_var_buffers(job.ag, storage, band);
+}
 
-	// Check we have enough output space (16 bytes per block)
-	size_t size_needed = xblocks * yblocks * zblocks * 16;
-	if (data_len < size_needed)
+/**
+ * @brief Wait for a progress counter to reach a target value.
+ */
+static void wait_for_progress(
+	const std::atomic<unsigned int>& counter,
+	unsigned int target
+) {
+	while (counter.load(std::memory_order_acquire) < target)
 	{
-		return ASTCENC_ERR_OUT_OF_MEM;
+		std::this_thread::yield();
 	}
+}
 
-	if (ctx->config.v_rgb_mean != 0.0f || ctx->config.v_rgb_stdev != 0.0f ||
-	    ctx->config.v_a_mean != 0.0f || ctx->config.v_a_stdev != 0.0f ||
-	    ctx->config.a_scale_radius != 0)
+/**
+ * @brief Test if the input texels for a block match the previous image.
+ *
+ * The block footprint is expanded by the radius of any averaging kernels, as
+ * texels inside the radius contribute to the error weights of the block.
+ *
+ * @param job      The compression job, which must have a previous image.
+ * @param bsd      The block size descriptor.
+ * @param radius   The averaging kernel radius, or 0 if not used.
+ * @param x        The block X coordinate in the image, in blocks.
+ * @param y        The block Y coordinate in the image, in blocks.
+ * @param z        The block Z coordinate in the image, in blocks.
+ *
+ * @return @c true if all input texels for the block are unchanged.
+ */
+static bool is_block_unchanged(
+	const compress_job& job,
+	const block_size_descriptor& bsd,
+	int radius,
+	int x,
+	int y,
+	int z
+) {
+	const astcenc_image& image = *job.image;
+	const astcenc_image& prev = *job.prev_image;
+
+	int radius_z = image.dim_z > 1 ? radius : 0;
+	int start_x = astc::max(x * bsd.xdim - radius, 0);
+	int start_y = astc::max(y * bsd.ydim - radius, 0);
+	int start_z = astc::max(z * bsd.zdim - radius_z, 0);
+	int end_x = astc::min((x + 1) * bsd.xdim + radius, static_cast<int>(image.dim_x));
+	int end_y = astc::min((y + 1) * bsd.ydim + radius, static_cast<int>(image.dim_y));
+	int end_z = astc::min((z + 1) * bsd.zdim + radius_z, static_cast<int>(image.dim_z));
+
+	size_t texel_size = get_image_components(image) * get_image_component_size(image);
+	size_t offset = start_x * texel_size;
+	size_t size = (end_x - start_x) * texel_size;
+
+	for (int tz = start_z; tz < end_z; tz++)
 	{
-		// First thread to enter will do setup, other threads will subsequently
-		// enter the critical section but simply skip over the initialization
-		auto init_avg_var = [ctx, &image, swizzle]() {
-			// Perform memory allocations for the destination buffers
-			size_t texel_count = image.dim_x * image.dim_y * image.dim_z;
-			ctx->input_averages = new vfloat4[texel_count];
-			ctx->input_variances = new vfloat4[texel_count];
-			ctx->input_alpha_averages = new float[texel_count];
-
-			return init_compute_averages_and_variances(
-				image, ctx->config.v_rgb_power, ctx->config.v_a_power,
-				ctx->config.v_rgba_radius, ctx->config.a_scale_radius, swizzle,
-				ctx->arg, ctx->ag);
-		};
-
-		// Only the first thread actually runs the initializer
-		ctx->manage_avg_var.init(init_avg_var);
-
-		// All threads will enter this function and dynamically grab work
-		compute_averages_and_variances(*ctx, ctx->ag);
+		for (int ty = start_y; ty < end_y; ty++)
+		{
+			const uint8_t* row = get_image_row<const uint8_t>(image, ty, tz);
+			const uint8_t* prev_row = get_image_row<const uint8_t>(prev, ty, tz);
+			if (memcmp(row + offset, prev_row + offset, size))
+			{
+				return false;
+			}
+		}
 	}
 
-	// Wait for compute_averages_and_variances to complete before compressing
-	ctx->manage_avg_var.wait();
+	return true;
+}
 
-	compress_image(*ctx, thread_index, image, swizzle, data_out);
+/**
+ * @brief Get the time elapsed between two time points, in nanoseconds.
+ *
+ * @param start   The start time.
+ * @param end     The end time; defaults to the current time.
+ *
+ * @return The elapsed time.
+ */
+static uint64_t get_elapsed_ns(
+	std::chrono::steady_clock::time_point start,
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now()
+) {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+/**
+ * @brief Add the statistics from one thread into the context totals.
+ *
+ * @param[in,out] dst   The totals to add to.
+ * @param[in,out] src   The thread statistics, which are reset to zero.
+ */
+static void merge_stats(
+	astcenc_stats& dst,
+	astcenc_stats& src
+) {
+	dst.block_count += src.block_count;
+	dst.cache_hit_count += src.cache_hit_count;
+	dst.rdo_reuse_count += src.rdo_reuse_count;
+	dst.unchanged_block_count += src.unchanged_block_count;
+	dst.adaptive_retry_count += src.adaptive_retry_count;
+	dst.exit_constant_count += src.exit_constant_count;
+	dst.exit_hint_count += src.exit_hint_count;
+	dst.exit_1_plane_count += src.exit_1_plane_count;
+	dst.exit_2_plane_count += src.exit_2_plane_count;
+	for (int i = 0; i < 3; i++)
+	{
+		dst.exit_partition_count[i] += src.exit_partition_count[i];
+	}
+	dst.exit_partition_early_out_count += src.exit_partition_early_out_count;
+	dst.exit_full_search_count += src.exit_full_search_count;
+	dst.block_modes_evaluated += src.block_modes_evaluated;
+	dst.refinement_iterations += src.refinement_iterations;
+	dst.avg_var_time_ns += src.avg_var_time_ns;
+	dst.fetch_time_ns += src.fetch_time_ns;
+	dst.compress_time_ns += src.compress_time_ns;
+
+	src = astcenc_stats {};
+}
+
+/**
+ * @brief Report compression progress to the progress callback.
+ *
+ * Only one thread calls the callback at a time; other threads skip their
+ * report rather than waiting, except for the thread completing the final task
+ * which must report 100 percent. Completions may be reported out of order, so
+ * only reports which increase the percentage are passed on.
+ *
+ * @param ctx    The codec context.
+ * @param done   The number of tasks completed, from complete_task_assignment().
+ */
+static void report_progress(
+	astcenc_context& ctx,
+	unsigned int done
+) {
+	unsigned int task_count = ctx.manage_compress.get_task_count();
+	std::unique_lock<std::mutex> lck(ctx.progress_lock, std::defer_lock);
+	if (done == task_count)
+	{
+		lck.lock();
+	}
+	else if (!lck.try_lock())
+	{
+		return;
+	}
+
+	if (ctx.cancel_requested.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	unsigned int percent = static_cast<unsigned int>((done * 100ull) / task_count);
+	if (percent > ctx.progress_reported)
+	{
+		ctx.progress_reported = percent;
+		ctx.config.progress_callback(static_cast<float>(percent), ctx.config.progress_payload);
+	}
+}
+
+/**
+ * @brief Adapt the effort level to fit the remaining time budget.
+ *
+ * The time taken by the calling thread for its last task assignment is used
+ * to project the time needed for the remaining tasks at the current level.
+ * The level is lowered if this would exceed the remaining budget, and raised
+ * if it would use less than half of it, as each level up may cost up to
+ * twice as much time.
+ *
+ * @param ctx            The codec context.
+ * @param effort_level   The effort level used for the last assignment.
+ * @param start          The start time of the last assignment.
+ * @param count          The number of tasks in the last assignment.
+ */
+static void update_effort_level(
+	astcenc_context& ctx,
+	unsigned int effort_level,
+	std::chrono::steady_clock::time_point start,
+	unsigned int count
+) {
+	using ms = std::chrono::duration<float, std::milli>;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	float remaining_budget = ctx.config.tune_time_budget - ms(now - ctx.budget_start).count();
+	float task_time = ms(now - start).count() / static_cast<float>(count);
+	float remaining_tasks = static_cast<float>(ctx.manage_compress.get_remaining_count());
+	float projected = task_time * remaining_tasks / static_cast<float>(ctx.thread_count);
+
+	unsigned int new_level = effort_level;
+	if (remaining_budget <= 0.0f)
+	{
+		new_level = 0;
+	}
+	else if (projected > remaining_budget && effort_level > 0)
+	{
+		new_level = effort_level - 1;
+	}
+	else if (projected < 0.5f * remaining_budget && effort_level < BUDGET_EFFORT_LEVELS - 1)
+	{
+		new_level = effort_level + 1;
+	}
+
+	// Only apply the change if no other thread has changed level meanwhile
+	if (new_level != effort_level)
+	{
+		ctx.effort_level.compare_exchange_strong(effort_level, new_level, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * @brief Compress a block, using adaptive effort if enabled.
+ *
+ * With adaptive effort the block is first compressed using the search limits
+ * of the lowest effort level, but with the error target of @c limits. Only if
+ * this misses the target is the block compressed again using @c limits, and
+ * the encoding with the lower error is kept.
+ *
+ * @param      ctx       The codec context.
+ * @param      image     The input image.
+ * @param      avg_var   The averages and variances for the block, if used.
+ * @param      limits    The search limits for the current effort level.
+ * @param      blk       The image block.
+ * @param      hint      The hint encoding, or @c nullptr if not used.
+ * @param[out] scb       The symbolic encoding.
+ * @param[out] pcb       The physical encoding.
+ * @param      tmpbuf    The per-thread working buffers.
+ */
+static void compress_block_adaptive(
+	const astcenc_context& ctx,
+	const astcenc_image& image,
+	const avg_var_buffers& avg_var,
+	const block_search_limits& limits,
+	const imageblock* blk,
+	const physical_compressed_block* hint,
+	symbolic_compressed_block& scb,
+	physical_compressed_block& pcb,
+	compress_symbolic_block_buffers* tmpbuf
+) {
+	if (!ctx.adaptive_limits.bsd)
+	{
+		compress_block(ctx, image, avg_var, limits, blk, hint, scb, pcb, tmpbuf);
+		return;
+	}
+
+	block_search_limits first_limits = ctx.adaptive_limits;
+	first_limits.db_limit = limits.db_limit;
+	if (compress_block(ctx, image, avg_var, first_limits, blk, hint, scb, pcb, tmpbuf))
+	{
+		return;
+	}
+
+	tmpbuf->stats.adaptive_retry_count++;
+
+	symbolic_compressed_block first_scb = scb;
+	physical_compressed_block first_pcb = pcb;
+	compress_block(ctx, image, avg_var, limits, blk, hint, scb, pcb, tmpbuf);
+
+	if (first_scb.errorval < scb.errorval)
+	{
+		scb = first_scb;
+		pcb = first_pcb;
+	}
+}
+
+/**
+ * @brief The minimum number of blocks classified by each classification task.
+ */
+static const unsigned int CLASSIFY_MIN_BLOCKS_PER_TASK = 256;
+
+/**
+ * @brief The maximum number of classification tasks.
+ *
+ * Each scatter task reads the class counts of all classification tasks, so
+ * this bounds the cost of the scatter.
+ */
+static const unsigned int CLASSIFY_MAX_TASKS = 256;
+
+/**
+ * @brief The task assignment granule for each block range class.
+ *
+ * Blocks with a larger range take longer to compress, so are assigned in
+ * smaller granules to balance the work between threads. Constant color
+ * blocks are the cheapest, and are assigned in bulk.
+ */
+static const unsigned int range_class_granules[BLOCK_RANGE_CLASSES] {
+	32, 8, 8, 8, 8, 4, 2, 1, 1
+};
+
+/**
+ * @brief Test if the compressor should use the block classification prepass.
+ *
+ * The compression order only affects the balance of work between threads. It
+ * is not used with averages and variances, as the bands are computed just in
+ * time for the blocks in raster order, with a time budget, as the budget
+ * projections assume the blocks are evenly mixed, or with rate-distortion
+ * optimization, as each task is then a whole block row.
+ */
+static bool needs_schedule(
+	const astcenc_context& ctx,
+	bool use_avg_var,
+	bool use_rdo
+) {
+	return (ctx.thread_count > 1) && !use_avg_var && !use_rdo &&
+	       (ctx.config.tune_time_budget == 0.0f);
+}
+
+/**
+ * @brief Get the job which contains a block.
+ *
+ * @param ctx     The codec context.
+ * @param block   The block index in the task space of the jobs.
+ *
+ * @return The job index.
+ */
+static unsigned int get_block_job(
+	const astcenc_context& ctx,
+	unsigned int block
+) {
+	unsigned int low = 0;
+	unsigned int high = ctx.job_count;
+	while (high - low > 1)
+	{
+		unsigned int mid = (low + high) / 2;
+		if (ctx.jobs[mid].task_base <= block)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/**
+ * @brief Get the coordinates of a block, relative to the region of its job.
+ *
+ * @param      job        The compression job.
+ * @param      job_task   The block index within the job region.
+ * @param[out] rx         The x coordinate, in blocks.
+ * @param[out] ry         The y coordinate, in blocks.
+ * @param[out] rz         The z coordinate, in blocks.
+ */
+static void get_job_block_coords(
+	const compress_job& job,
+	unsigned int job_task,
+	int& rx,
+	int& ry,
+	int& rz
+) {
+	unsigned int row_blocks = job.region.dim_x;
+	unsigned int plane_blocks = job.region.dim_x * job.region.dim_y;
+
+	rz = job_task / plane_blocks;
+	unsigned int rem = job_task - (rz * plane_blocks);
+	ry = rem / row_blocks;
+	rx = rem - (ry * row_blocks);
+}
+
+/**
+ * @brief Classify the blocks of one classification task.
+ *
+ * @param ctx    The codec context.
+ * @param task   The classification task index.
+ */
+static void classify_blocks(
+	astcenc_context& ctx,
+	unsigned int task
+) {
+	block_schedule& sched = ctx.schedule;
+	const block_size_descriptor& bsd = *ctx.bsd;
+
+	unsigned int* counts = sched.class_counts + task * BLOCK_RANGE_CLASSES;
+	for (unsigned int i = 0; i < BLOCK_RANGE_CLASSES; i++)
+	{
+		counts[i] = 0;
+	}
+
+	unsigned int start = task * sched.blocks_per_task;
+	unsigned int end = astc::min(start + sched.blocks_per_task, sched.block_count);
+	unsigned int job_index = get_block_job(ctx, start);
+
+	for (unsigned int block = start; block < end; block++)
+	{
+		while ((job_index + 1 < ctx.job_count) && (block >= ctx.jobs[job_index + 1].task_base))
+		{
+			job_index++;
+		}
+
+		const compress_job& job = ctx.jobs[job_index];
+
+		int rx, ry, rz;
+		get_job_block_coords(job, block - job.task_base, rx, ry, rz);
+
+		int x = (rx + job.region.origin_x) * bsd.xdim;
+		int y = (ry + job.region.origin_y) * bsd.ydim;
+		int z = (rz + job.region.origin_z) * bsd.zdim;
+
+		unsigned int range_class = get_block_range_class(*job.image, bsd, x, y, z);
+		sched.block_classes[block] = static_cast<uint8_t>(range_class);
+		counts[range_class]++;
+	}
+}
+
+/**
+ * @brief Store the blocks of one classification task in compression order.
+ *
+ * Blocks are ordered by decreasing range class, and then by block index.
+ *
+ * @param ctx    The codec context.
+ * @param task   The classification task index.
+ */
+static void scatter_blocks(
+	astcenc_context& ctx,
+	unsigned int task
+) {
+	block_schedule& sched = ctx.schedule;
+
+	// Find the position of the first block of this task in each class
+	unsigned int offsets[BLOCK_RANGE_CLASSES] {};
+	unsigned int totals[BLOCK_RANGE_CLASSES] {};
+	for (unsigned int i = 0; i < sched.task_count; i++)
+	{
+		const unsigned int* counts = sched.class_counts + i * BLOCK_RANGE_CLASSES;
+		for (unsigned int j = 0; j < BLOCK_RANGE_CLASSES; j++)
+		{
+			offsets[j] += (i < task) ? counts[j] : 0;
+			totals[j] += counts[j];
+		}
+	}
+
+	unsigned int class_base = 0;
+	for (unsigned int j = BLOCK_RANGE_CLASSES; j-- > 0; )
+	{
+		offsets[j] += class_base;
+		class_base += totals[j];
+	}
+
+	unsigned int start = task * sched.blocks_per_task;
+	unsigned int end = astc::min(start + sched.blocks_per_task, sched.block_count);
+	for (unsigned int block = start; block < end; block++)
+	{
+		sched.block_order[offsets[sched.block_classes[block]]++] = block;
+	}
+}
+
+/**
+ * @brief Get the task assignment granule for the next compression task.
+ *
+ * @param ctx            The codec context.
+ * @param use_schedule   Is the block classification prepass used?
+ *
+ * @return The granule size.
+ */
+static unsigned int get_compress_granule(
+	const astcenc_context& ctx,
+	bool use_schedule
+) {
+	if (!use_schedule)
+	{
+		return 32;
+	}
+
+	// Classification tasks are large, so are assigned individually
+	const block_schedule& sched = ctx.schedule;
+	unsigned int prepass_tasks = 2 * sched.task_count;
+	unsigned int next = ctx.manage_compress.get_next_task_index();
+	if (next < prepass_tasks)
+	{
+		return 1;
+	}
+
+	// The compression order is only known once the scatter has completed
+	next -= prepass_tasks;
+	if ((next >= sched.block_count) ||
+	    (sched.scatter_done.load(std::memory_order_acquire) < sched.task_count))
+	{
+		return 32;
+	}
+
+	return range_class_granules[sched.block_classes[sched.block_order[next]]];
+}
+
+/**
+ * @brief Compress the blocks of all of the jobs in the context.
+ *
+ * Blocks from all jobs are flattened into a single task space, so threads can
+ * move on to the next job without waiting for all threads to finish the
+ * current one.
+ *
+ * If averages and variances are needed they are computed in bands, with the
+ * tasks for each band placed in the task space @c BAND_LOOKAHEAD bands ahead
+ * of the blocks which use them. Tasks are assigned in increasing order, and
+ * only ever wait for tasks earlier in the task space, so the pipeline cannot
+ * deadlock. Only @c BAND_SLOTS bands per job are stored at any one time.
+ *
+ * Otherwise, if the context has more than one thread, blocks are first
+ * classified by their range and compressed in decreasing order of range, so
+ * that the most expensive blocks are compressed first. Tasks are assigned in
+ * granules sized by block range class, so expensive blocks are spread across
+ * threads and trivial blocks are assigned in bulk.
+ *
+ * If using rate-distortion optimization each task is a whole row of a job
+ * region, compressed in order, so each block can reuse the final encodings of
+ * the previous blocks in its row regardless of the thread count.
+ *
+ * @param ctx            The codec context, with populated jobs.
+ * @param thread_index   The index of the calling thread.
+ * @param swizzle        The input data swizzle.
+ * @param use_avg_var    Are averages and variances needed?
+ * @param use_cache      Is the duplicate block cache enabled?
+ * @param use_schedule   Is the block classification prepass used?
+ * @param use_rdo        Is rate-distortion optimization used?
+ */
+static void compress_image(
+	astcenc_context& ctx,
+	unsigned int thread_index,
+	astcenc_swizzle swizzle,
+	bool use_avg_var,
+	bool use_cache,
+	bool use_schedule,
+	bool use_rdo
+) {
+	const block_size_descriptor *bsd = ctx.bsd;
+	int block_x = bsd->xdim;
+	int block_y = bsd->ydim;
+	int block_z = bsd->zdim;
+	astcenc_profile decode_mode = ctx.config.profile;
+
+	imageblock pb;
+
+	// Use preallocated scratch buffer
+	auto temp_buffers = ctx.working_buffers[thread_index];
+	astcenc_stats& stats = temp_buffers->stats;
+
+	// Average and variance working memory, and the pipeline state of the first
+	// job, are set up once this thread has been assigned a task; a thread which
+	// arrives after all tasks have completed may find the jobs already released
+	vfloat4* work_memory = nullptr;
+	bool is_setup = false;
+
+	// Tasks are assigned in increasing order, so jobs and pipeline steps are
+	// only ever visited in increasing order by each thread
+	unsigned int job_index = 0;
+	unsigned int step = 0;
+	unsigned int step_base = 0;
+	unsigned int step_count = 0;
+
+	bool use_budget = ctx.config.tune_time_budget > 0.0f;
+	bool use_timings = (ctx.config.flags & ASTCENC_FLG_COLLECT_TIMINGS) != 0;
+
+	// Texels inside the averaging kernel radius affect the encoding of a block
+	int kernel_radius = 0;
+	if (use_avg_var)
+	{
+		kernel_radius = static_cast<int>(astc::max(ctx.config.v_rgba_radius, ctx.config.a_scale_radius));
+	}
+
+	// All threads run this processing loop until there is no work remaining
+	while (true)
+	{
+		unsigned int count;
+		unsigned int granule = use_rdo ? 1 : get_compress_granule(ctx, use_schedule);
+		unsigned int base = ctx.manage_compress.get_task_assignment(granule, count);
+		if (!count)
+		{
+			break;
+		}
+
+		if (!is_setup)
+		{
+			// Use preallocated average and variance working memory
+			work_memory = ctx.avg_var_work_memory + thread_index * ctx.avg_var_work_memory_size;
+			step_count = use_avg_var ? get_band_step_task_count(ctx.jobs[0], 0) : 0;
+			is_setup = true;
+		}
+
+		// Cancelled tasks skip their work, but still update the progress
+		// counters that other tasks wait on so that no thread stalls
+		bool cancelled = ctx.cancel_requested.load(std::memory_order_relaxed);
+
+		// The effort level only changes between task assignments
+		unsigned int effort_level = ctx.effort_level.load(std::memory_order_relaxed);
+		const block_search_limits& limits = ctx.search_limits[effort_level];
+
+		std::chrono::steady_clock::time_point granule_start;
+		if (use_budget)
+		{
+			granule_start = std::chrono::steady_clock::now();
+		}
+
+		for (unsigned int i = base; i < base + count; i++)
+		{
+			unsigned int block = i;
+			if (use_schedule)
+			{
+				block_schedule& sched = ctx.schedule;
+
+				// Classify the blocks of one classification task
+				if (i < sched.task_count)
+				{
+					classify_blocks(ctx, i);
+					sched.classify_done.fetch_add(1, std::memory_order_release);
+					continue;
+				}
+
+				// Store the blocks of one classification task in compression order
+				if (i < 2 * sched.task_count)
+				{
+					wait_for_progress(sched.classify_done, sched.task_count);
+					scatter_blocks(ctx, i - sched.task_count);
+					sched.scatter_done.fetch_add(1, std::memory_order_release);
+					continue;
+				}
+
+				// Compress blocks in compression order, which may visit jobs in any order
+				wait_for_progress(sched.scatter_done, sched.task_count);
+				block = sched.block_order[i - 2 * sched.task_count];
+				job_index = get_block_job(ctx, block);
+			}
+
+			while ((job_index + 1 < ctx.job_count) && (block >= ctx.jobs[job_index + 1].task_base))
+			{
+				job_index++;
+				step = 0;
+				step_base = ctx.jobs[job_index].task_base;
+				step_count = use_avg_var ? get_band_step_task_count(ctx.jobs[job_index], 0) : 0;
+			}
+
+			const compress_job& job = ctx.jobs[job_index];
+			const astcenc_image& image = *job.image;
+			avg_var_buffers avg_var {};
+			band_progress* progress = nullptr;
+
+			unsigned int job_task = (block - job.task_base) * job.task_blocks;
+
+			if (use_avg_var)
+			{
+				const avg_var_args& ag = job.ag;
+				while (i >= step_base + step_count)
+				{
+					step_base += step_count;
+					step++;
+					step_count = get_band_step_task_count(job, step);
+				}
+
+				unsigned int step_task = i - step_base;
+
+				// Compute averages and variances for band N
+				if (step < ag.band_count)
+				{
+					if (step_task < ag.band_tasks)
+					{
+						// Wait for the band previously stored in this slot to be used
+						if (step >= job.band_slots)
+						{
+							unsigned int old_band = step - job.band_slots;
+							wait_for_progress(job.bands[old_band].blocks_done,
+							                  get_band_block_count(job, old_band));
+						}
+
+						if (!cancelled)
+						{
+							avg_var_buffers dst = get_band_buffers(job, step);
+							std::chrono::steady_clock::time_point avg_var_start = std::chrono::steady_clock::now();
+							compute_averages_and_variances(ag, dst, step_task, work_memory);
+							stats.avg_var_time_ns += get_elapsed_ns(avg_var_start);
+						}
+
+						job.bands[step].tasks_done.fetch_add(1, std::memory_order_release);
+						continue;
+					}
+
+					step_task -= ag.band_tasks;
+				}
+
+				// Compress blocks for band N - BAND_LOOKAHEAD
+				unsigned int band = step - BAND_LOOKAHEAD;
+				progress = &job.bands[band];
+				wait_for_progress(progress->tasks_done, ag.band_tasks);
+				avg_var = get_band_buffers(job, band);
+
+				unsigned int band_z = band / ag.bands_y;
+				unsigned int band_y = band - (band_z * ag.bands_y);
+				unsigned int band_row = band_z * job.region.dim_y + band_y * ag.band_block_rows;
+				job_task = band_row * job.region.dim_x + step_task * job.task_blocks;
+			}
+
+			int dim_x = image.dim_x;
+			int dim_y = image.dim_y;
+
+			// A task with more than one block is a region row, compressed in order
+			for (unsigned int task_block = 0; task_block < job.task_blocks; task_block++)
+			{
+				if (cancelled)
+				{
+					if (progress)
+					{
+						progress->blocks_done.fetch_add(1, std::memory_order_release);
+					}
+
+					continue;
+				}
+
+				// Decode the task into x, y, z block indices within the region
+				int rx, ry, rz;
+				get_job_block_coords(job, job_task + task_block, rx, ry, rz);
+
+				// Convert to x, y, z block indices within the image
+				int x = rx + job.region.origin_x;
+				int y = ry + job.region.origin_y;
+				int z = rz + job.region.origin_z;
+
+				size_t offset = ((rz * job.region.dim_y + ry) * job.row_pitch + rx) * 16;
+				uint8_t *bp = job.data_out + offset;
+
+				// Reuse the previous encoding if none of the input texels changed
+				if (job.prev_image && is_block_unchanged(job, *bsd, kernel_radius, x, y, z))
+				{
+					if (bp != job.prev_data + offset)
+					{
+						memcpy(bp, job.prev_data + offset, 16);
+					}
+
+					stats.unchanged_block_count++;
+					stats.block_count++;
+
+					if (progress)
+					{
+						progress->blocks_done.fetch_add(1, std::memory_order_release);
+					}
+
+					continue;
+				}
+
+				// Test if we can apply some basic alpha-scale RDO
+				bool use_full_block = true;
+				if (ctx.config.a_scale_radius != 0 && block_z == 1)
+				{
+					int start_x = x * block_x;
+					int end_x = astc::min(dim_x, start_x + block_x);
+
+					int start_y = y * block_y;
+					int end_y = astc::min(dim_y, start_y + block_y);
+
+					// SATs accumulate error, so don't test exactly zero. Test for
+					// less than 1 alpha in the expanded block footprint that
+					// includes the alpha radius.
+					int x_footprint = block_x +
+					                  2 * (ctx.config.a_scale_radius - 1);
+
+					int y_footprint = block_y +
+					                  2 * (ctx.config.a_scale_radius - 1);
+
+					float footprint = (float)(x_footprint * y_footprint);
+					float threshold = 0.9f / (255.0f * footprint);
+
+					// Do we have any alpha values?
+					use_full_block = false;
+					for (int ay = start_y; ay < end_y; ay++)
+					{
+						for (int ax = start_x; ax < end_x; ax++)
+						{
+							float a_avg = avg_var.input_alpha_averages[get_avg_var_index(avg_var, ax, ay, z)];
+							if (a_avg > threshold)
+							{
+								use_full_block = true;
+								ax = end_x;
+								ay = end_y;
+							}
+						}
+					}
+				}
+
+				std::chrono::steady_clock::time_point fetch_start;
+				if (use_timings)
+				{
+					fetch_start = std::chrono::steady_clock::now();
+				}
+
+				// Fetch the full block for compression
+				if (use_full_block)
+				{
+					fetch_imageblock(decode_mode, image, &pb, bsd, x * block_x, y * block_y, z * block_z, swizzle);
+				}
+				// Apply alpha scale RDO - substitute constant color block
+				else
+				{
+					pb.origin_texel = vfloat4::zero();
+					pb.data_min = vfloat4::zero();
+					pb.data_max = pb.data_min;
+					pb.grayscale = false;
+				}
+
+				physical_compressed_block* pcb = reinterpret_cast<physical_compressed_block*>(bp);
+				symbolic_compressed_block scb;
+
+				// Copy the hint, as the hint data may alias the output
+				physical_compressed_block hint_pcb;
+				const physical_compressed_block* hint = nullptr;
+				if (job.hint_data)
+				{
+					memcpy(hint_pcb.data, job.hint_data + offset, 16);
+					hint = &hint_pcb;
+				}
+
+				std::chrono::steady_clock::time_point compress_start;
+				if (use_timings)
+				{
+					compress_start = std::chrono::steady_clock::now();
+					stats.fetch_time_ns += get_elapsed_ns(fetch_start, compress_start);
+				}
+
+				// Reuse the encoding of an identical block if we have one
+				if (use_cache)
+				{
+					int valid_x = astc::min(block_x, dim_x - x * block_x);
+					int valid_y = astc::min(block_y, dim_y - y * block_y);
+					int valid_z = astc::min(block_z, (int)image.dim_z - z * block_z);
+					block_cache_key key = compute_block_cache_key(*bsd, pb, valid_x, valid_y, valid_z);
+					if (block_cache_lookup(ctx.cache, key, *pcb))
+					{
+						stats.cache_hit_count++;
+					}
+					else
+					{
+						compress_block_adaptive(ctx, image, avg_var, limits, &pb, hint, scb, *pcb, temp_buffers);
+						block_cache_insert(ctx.cache, key, *pcb);
+					}
+				}
+				else
+				{
+					compress_block_adaptive(ctx, image, avg_var, limits, &pb, hint, scb, *pcb, temp_buffers);
+
+					// The previous blocks in the row are contiguous in the output
+					if (use_rdo)
+					{
+						unsigned int neighbor_count = astc::min(static_cast<unsigned int>(rx), TUNE_RDO_WINDOW);
+						apply_block_rdo(ctx, &pb, pcb - neighbor_count, neighbor_count, scb, *pcb, temp_buffers);
+					}
+				}
+
+				if (use_timings)
+				{
+					stats.compress_time_ns += get_elapsed_ns(compress_start);
+				}
+
+				stats.block_count++;
+
+				if (progress)
+				{
+					progress->blocks_done.fetch_add(1, std::memory_order_release);
+				}
+			}
+		}
+
+		unsigned int done = ctx.manage_compress.complete_task_assignment(count);
+
+		if (ctx.config.progress_callback)
+		{
+			report_progress(ctx, done);
+		}
+
+		// Cancelled tasks are not representative of the time per task
+		if (use_budget && !cancelled)
+		{
+			update_effort_level(ctx, effort_level, granule_start, count);
+		}
+	}
+}
+
+/**
+ * @brief Get the working buffers for a thread, allocating them on first use.
+ *
+ * The buffers are allocated and cleared by the thread which uses them, so on
+ * NUMA systems with a first-touch page placement policy they are placed in
+ * memory local to that thread.
+ *
+ * @param ctx            The codec context.
+ * @param thread_index   The index of the calling thread.
+ *
+ * @return The working buffers, or @c nullptr if allocation failed.
+ */
+static compress_symbolic_block_buffers* acquire_working_buffers(
+	astcenc_context& ctx,
+	unsigned int thread_index
+) {
+	compress_symbolic_block_buffers*& buffers = ctx.working_buffers[thread_index];
+	if (!buffers)
+	{
+		buffers = aligned_malloc<compress_symbolic_block_buffers>(
+		    sizeof(compress_symbolic_block_buffers), ASTCENC_VECALIGN);
+		if (buffers)
+		{
+			std::memset(static_cast<void*>(buffers), 0, sizeof(compress_symbolic_block_buffers));
+			buffers->stats = astcenc_stats {};
+		}
+	}
+
+	return buffers;
+}
+
+/**
+ * @brief Run the compression pipeline for a set of compression jobs.
+ *
+ * A thread which cannot allocate its working buffers does not take part, and
+ * its tasks are completed by the other threads.
+ *
+ * @param ctx            The codec context.
+ * @param thread_index   The index of the calling thread.
+ * @param swizzle        The input data swizzle.
+ * @param job_count      The number of compression jobs.
+ * @param use_hint       Do the jobs compress using a warm-start hint?
+ * @param init_jobs      Callable which populates the context jobs; only the
+ *                       first thread actually runs it.
+ *
+ * @return @c ASTCENC_SUCCESS on success, @c ASTCENC_ERR_CANCELLED if the
+ *         compression was cancelled, or an error if the calling thread could
+ *         not allocate its working buffers.
+ */
+static astcenc_error compress_jobs(
+	astcenc_context& ctx,
+	unsigned int thread_index,
+	astcenc_swizzle swizzle,
+	unsigned int job_count,
+	bool use_hint,
+	std::function<void(compress_job*)> init_jobs
+) {
+	if (!acquire_working_buffers(ctx, thread_index))
+	{
+		return ASTCENC_ERR_OUT_OF_MEM;
+	}
+
+	bool use_avg_var = needs_avg_var(ctx.config);
+
+	bool use_rdo = ctx.config.tune_rdo_lambda > 0.0f;
+
+	// Error weights from averages and variances vary with block position,
+	// rate-distortion optimized encodings depend on the neighboring blocks, and
+	// hinted encodings depend on the hint block, so identical block data is not
+	// guaranteed to give an identical encoding
+	bool use_cache = (ctx.config.flags & ASTCENC_FLG_USE_BLOCK_CACHE) && !use_avg_var && !use_rdo && !use_hint;
+
+	bool use_schedule = needs_schedule(ctx, use_avg_var, use_rdo);
+
+	// First thread to enter will do setup, other threads will subsequently
+	// enter the critical section but simply skip over the initialization
+	auto init_compress = [&ctx, &init_jobs, swizzle, job_count, use_avg_var, use_cache, use_schedule, use_rdo]() {
+		// The time budget includes the setup time
+		ctx.budget_start = std::chrono::steady_clock::now();
+		ctx.progress_reported = 0;
+
+		scratch_reserve(ctx.job_scratch, get_scratch_size<compress_job>(job_count));
+		ctx.jobs = scratch_alloc<compress_job>(ctx.job_scratch, job_count);
+		ctx.job_count = job_count;
+		init_jobs(ctx.jobs);
+
+		// Assign each job its range in the compression task space
+		unsigned int task_base = 0;
+		size_t texel_count = 0;
+		unsigned int band_count = 0;
+		int work_memory_size = 0;
+		for (unsigned int i = 0; i < ctx.job_count; i++)
+		{
+			compress_job& job = ctx.jobs[i];
+			job.task_base = task_base;
+			job.task_blocks = use_rdo ? job.region.dim_x : 1;
+			job.band_storage = avg_var_buffers {};
+			job.band_slots = 0;
+			job.bands = nullptr;
+			task_base += get_region_block_count(job.region) / job.task_blocks;
+
+			if (use_avg_var)
+			{
+				init_compute_averages_and_variances(
+					*job.image, *ctx.bsd, job.region, ctx.config.v_rgb_power, ctx.config.v_a_power,
+					ctx.config.v_rgba_radius, ctx.config.a_scale_radius, swizzle, job.ag);
+
+				job.band_slots = astc::min(BAND_SLOTS, job.ag.band_count);
+				texel_count += job.band_slots * (size_t)job.ag.band_texel_count;
+				band_count += job.ag.band_count;
+				task_base += job.ag.band_count * job.ag.band_tasks;
+				work_memory_size = astc::max(work_memory_size, job.ag.work_memory_size);
+			}
+		}
+
+		// Without averages and variances the task space only contains blocks
+		if (use_schedule)
+		{
+			block_schedule& sched = ctx.schedule;
+			unsigned int block_count = task_base;
+			unsigned int blocks_per_task = astc::max(CLASSIFY_MIN_BLOCKS_PER_TASK,
+			                                         (block_count + CLASSIFY_MAX_TASKS - 1) / CLASSIFY_MAX_TASKS);
+
+			sched.block_count = block_count;
+			sched.blocks_per_task = blocks_per_task;
+			sched.task_count = (block_count + blocks_per_task - 1) / blocks_per_task;
+
+			size_t count_count = sched.task_count * (size_t)BLOCK_RANGE_CLASSES;
+			size_t scratch_size = get_scratch_size<uint8_t>(block_count) +
+			                      get_scratch_size<unsigned int>(count_count) +
+			                      get_scratch_size<unsigned int>(block_count);
+
+			scratch_reserve(ctx.schedule_scratch, scratch_size);
+			sched.block_classes = scratch_alloc<uint8_t>(ctx.schedule_scratch, block_count);
+			sched.class_counts = scratch_alloc<unsigned int>(ctx.schedule_scratch, count_count);
+			sched.block_order = scratch_alloc<unsigned int>(ctx.schedule_scratch, block_count);
+			sched.classify_done.store(0, std::memory_order_relaxed);
+			sched.scatter_done.store(0, std::memory_order_relaxed);
+
+			task_base += 2 * sched.task_count;
+		}
+
+		if (use_cache)
+		{
+			unsigned int block_count = 0;
+			for (unsigned int i = 0; i < ctx.job_count; i++)
+			{
+				block_count += get_region_block_count(ctx.jobs[i].region);
+			}
+
+			unsigned int entry_count = get_block_cache_entry_count(block_count);
+			scratch_reserve(ctx.cache_scratch, get_scratch_size<block_cache_entry>(entry_count));
+			block_cache_entry* entries = scratch_alloc<block_cache_entry>(ctx.cache_scratch, entry_count);
+			init_block_cache(ctx.cache, entries, entry_count);
+		}
+
+		if (!use_avg_var)
+		{
+			return task_base;
+		}
+
+		// Allocate the band buffers, band progress, and working memory
+		size_t work_memory_count = work_memory_size * (size_t)ctx.thread_count;
+		size_t scratch_size = 2 * get_scratch_size<vfloat4>(texel_count) +
+		                      get_scratch_size<float>(texel_count) +
+		                      get_scratch_size<band_progress>(band_count) +
+		                      get_scratch_size<vfloat4>(work_memory_count);
+
+		scratch_reserve(ctx.band_scratch, scratch_size);
+		ctx.input_averages = scratch_alloc<vfloat4>(ctx.band_scratch, texel_count);
+		ctx.input_variances = scratch_alloc<vfloat4>(ctx.band_scratch, texel_count);
+		ctx.input_alpha_averages = scratch_alloc<float>(ctx.band_scratch, texel_count);
+		ctx.bands = scratch_alloc<band_progress>(ctx.band_scratch, band_count);
+		ctx.avg_var_work_memory = scratch_alloc<vfloat4>(ctx.band_scratch, work_memory_count);
+		ctx.avg_var_work_memory_size = work_memory_size;
+
+		// Assign each job its range in the band buffers and band progress
+		size_t texel_base = 0;
+		unsigned int band_base = 0;
+		for (unsigned int i = 0; i < ctx.job_count; i++)
+		{
+			compress_job& job = ctx.jobs[i];
+			job.band_storage.input_averages = ctx.input_averages + texel_base;
+			job.band_storage.input_variances = ctx.input_variances + texel_base;
+			job.band_storage.input_alpha_averages = ctx.input_alpha_averages + texel_base;
+			job.bands = ctx.bands + band_base;
+
+			texel_base += job.band_slots * (size_t)job.ag.band_texel_count;
+			band_base += job.ag.band_count;
+		}
+
+		for (unsigned int i = 0; i < band_count; i++)
+		{
+			band_progress* progress = new (ctx.bands + i) band_progress;
+			progress->tasks_done.store(0, std::memory_order_relaxed);
+			progress->blocks_done.store(0, std::memory_order_relaxed);
+		}
+
+		return task_base;
+	};
+
+	// Only the first thread actually runs the initializer
+	ctx.manage_compress.init(init_compress);
+
+	compress_image(ctx, thread_index, swizzle, use_avg_var, use_cache, use_schedule, use_rdo);
+
+	// Wait for compress to complete before freeing memory
+	ctx.manage_compress.wait();
+
+	auto term_compress = [&ctx]() {
+		ctx.input_averages = nullptr;
+		ctx.input_variances = nullptr;
+		ctx.input_alpha_averages = nullptr;
+		ctx.bands = nullptr;
+		ctx.avg_var_work_memory = nullptr;
+		ctx.avg_var_work_memory_size = 0;
+		ctx.jobs = nullptr;
+		ctx.job_count = 0;
+		ctx.cache = block_cache {};
+
+		// Record the outcome once, so every thread returns the same result
+		// even if cancellation is requested while the threads are exiting
+		ctx.compress_cancelled = ctx.cancel_requested.load(std::memory_order_relaxed);
+
+		// All threads have finished their tasks, so can merge their stats
+		for (unsigned int i = 0; i < ctx.thread_count; i++)
+		{
+			if (ctx.working_buffers[i])
+			{
+				merge_stats(ctx.stats, ctx.working_buffers[i]->stats);
+			}
+		}
+
+		// Scratch memory is retained for reuse by later images if requested
+		if (!(ctx.config.flags & ASTCENC_FLG_PERSISTENT_SCRATCH))
+		{
+			scratch_release(ctx.job_scratch);
+			scratch_release(ctx.band_scratch);
+			scratch_release(ctx.cache_scratch);
+			scratch_release(ctx.schedule_scratch);
+		}
+	};
+
+	// Only the first thread to arrive actually runs the term
+	ctx.manage_compress.term(term_compress);
+
+	return ctx.compress_cancelled ? ASTCENC_ERR_CANCELLED : ASTCENC_SUCCESS;
+}
+#endif
+
+astcenc_error astcenc_compress_image(
+	astcenc_context* ctx,
+	astcenc_image& image,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)image;
+	(void)swizzle;
+	(void)data_out;
+	(void)data_len;
+	(void)thread_index;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	astcenc_block_region region = get_image_block_region(*ctx, image);
+	return astcenc_compress_image_region(ctx, image, swizzle, region,
+	                                     data_out, data_len, region.dim_x,
+	                                     thread_index);
+#endif
+}
+
+astcenc_error astcenc_compress_image_region(
+	astcenc_context* ctx,
+	astcenc_image& image,
+	astcenc_swizzle swizzle,
+	const astcenc_block_region& region,
+	uint8_t* data_out,
+	size_t data_len,
+	size_t row_pitch,
+	unsigned int thread_index
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)image;
+	(void)swizzle;
+	(void)region;
+	(void)data_out;
+	(void)data_len;
+	(void)row_pitch;
+	(void)thread_index;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	astcenc_error status;
+
+	if (ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	status = validate_compression_swizzle(swizzle);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	status = validate_image_layout(image);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	if (thread_index >= ctx->thread_count)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	astcenc_block_region image_region = get_image_block_region(*ctx, image);
+	unsigned int xblocks = image_region.dim_x;
+	unsigned int yblocks = image_region.dim_y;
+	unsigned int zblocks = image_region.dim_z;
+
+	// Check the region is non-empty and inside the image
+	if ((region.dim_x == 0) || (region.dim_y == 0) || (region.dim_z == 0) ||
+	    (region.origin_x >= xblocks) || (region.dim_x > xblocks - region.origin_x) ||
+	    (region.origin_y >= yblocks) || (region.dim_y > yblocks - region.origin_y) ||
+	    (region.origin_z >= zblocks) || (region.dim_z > zblocks - region.origin_z) ||
+	    (row_pitch < region.dim_x))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// Check we have enough output space (16 bytes per block)
+	size_t rows_needed = region.dim_y * region.dim_z;
+	size_t size_needed = ((rows_needed - 1) * row_pitch + region.dim_x) * 16;
+	if (data_len < size_needed)
+	{
+		return ASTCENC_ERR_OUT_OF_MEM;
+	}
+
+	auto init_jobs = [&image, &region, data_out, row_pitch](compress_job* jobs) {
+		compress_job& job = jobs[0];
+		job.image = &image;
+		job.region = region;
+		job.data_out = data_out;
+		job.row_pitch = row_pitch;
+		job.prev_image = nullptr;
+		job.prev_data = nullptr;
+		job.hint_data = nullptr;
+	};
+
+	return compress_jobs(*ctx, thread_index, swizzle, 1, false, init_jobs);
+#endif
+}
+
+astcenc_error astcenc_compress_image_batch(
+	astcenc_context* ctx,
+	const astcenc_batch_image* batch,
+	unsigned int batch_size,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)batch;
+	(void)batch_size;
+	(void)swizzle;
+	(void)thread_index;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	astcenc_error status;
+
+	if (ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	status = validate_compression_swizzle(swizzle);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	if ((thread_index >= ctx->thread_count) || (batch_size == 0))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	for (unsigned int i = 0; i < batch_size; i++)
+	{
+		const astcenc_image& image = *batch[i].image;
+		if ((image.dim_x == 0) || (image.dim_y == 0) || (image.dim_z == 0))
+		{
+			return ASTCENC_ERR_BAD_PARAM;
+		}
+
+		status = validate_image_layout(image);
+		if (status != ASTCENC_SUCCESS)
+		{
+			return status;
+		}
+
+		// Check we have enough output space (16 bytes per block)
+		astcenc_block_region region = get_image_block_region(*ctx, image);
+		size_t size_needed = get_region_block_count(region) * 16;
+		if (batch[i].data_len < size_needed)
+		{
+			return ASTCENC_ERR_OUT_OF_MEM;
+		}
+	}
+
+	auto init_jobs = [ctx, batch, batch_size](compress_job* jobs) {
+		for (unsigned int i = 0; i < batch_size; i++)
+		{
+			compress_job& job = jobs[i];
+			job.image = batch[i].image;
+			job.region = get_image_block_region(*ctx, *batch[i].image);
+			job.data_out = batch[i].data_out;
+			job.row_pitch = job.region.dim_x;
+			job.prev_image = nullptr;
+			job.prev_data = nullptr;
+			job.hint_data = nullptr;
+		}
+	};
+
+	return compress_jobs(*ctx, thread_index, swizzle, batch_size, false, init_jobs);
+#endif
+}
+
+astcenc_error astcenc_compress_image_incremental(
+	astcenc_context* ctx,
+	astcenc_image& image,
+	const astcenc_image& prev_image,
+	const uint8_t* prev_data,
+	size_t prev_data_len,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)image;
+	(void)prev_image;
+	(void)prev_data;
+	(void)prev_data_len;
+	(void)swizzle;
+	(void)data_out;
+	(void)data_len;
+	(void)thread_index;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	astcenc_error status;
+
+	if (ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	status = validate_compression_swizzle(swizzle);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
 
-	// Wait for compress to complete before freeing memory
-	ctx->manage_compress.wait();
+	status = validate_image_layout(image);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	status = validate_image_layout(prev_image);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	if (thread_index >= ctx->thread_count)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
 
-	auto term_compress = [ctx]() {
-		delete[] ctx->input_averages;
-		ctx->input_averages = nullptr;
+	// The previous image must have the same texel layout as the new image
+	if ((image.dim_x == 0) || (image.dim_y == 0) || (image.dim_z == 0) ||
+	    (prev_image.dim_x != image.dim_x) ||
+	    (prev_image.dim_y != image.dim_y) ||
+	    (prev_image.dim_z != image.dim_z) ||
+	    (prev_image.data_type != image.data_type) ||
+	    (get_image_components(prev_image) != get_image_components(image)))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
 
-		delete[] ctx->input_variances;
-		ctx->input_variances = nullptr;
+	// Check we have enough input and output space (16 bytes per block)
+	astcenc_block_region region = get_image_block_region(*ctx, image);
+	size_t size_needed = get_region_block_count(region) * 16;
+	if ((data_len < size_needed) || (prev_data_len < size_needed))
+	{
+		return ASTCENC_ERR_OUT_OF_MEM;
+	}
 
-		delete[] ctx->input_alpha_averages;
-		ctx->input_alpha_averages = nullptr;
+	auto init_jobs = [&image, &prev_image, &region, prev_data, data_out](compress_job* jobs) {
+		compress_job& job = jobs[0];
+		job.image = &image;
+		job.region = region;
+		job.data_out = data_out;
+		job.row_pitch = region.dim_x;
+		job.prev_image = &prev_image;
+		job.prev_data = prev_data;
+		job.hint_data = nullptr;
 	};
 
-	// Only the first thread to arrive actually runs the term
-	ctx->manage_compress.term(term_compress);
+	return compress_jobs(*ctx, thread_index, swizzle, 1, false, init_jobs);
+#endif
+}
 
-	return ASTCENC_SUCCESS;
+astcenc_error astcenc_compress_image_hinted(
+	astcenc_context* ctx,
+	astcenc_image& image,
+	const uint8_t* hint_data,
+	size_t hint_data_len,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)image;
+	(void)hint_data;
+	(void)hint_data_len;
+	(void)swizzle;
+	(void)data_out;
+	(void)data_len;
+	(void)thread_index;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	astcenc_error status;
+
+	if (ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	status = validate_compression_swizzle(swizzle);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	status = validate_image_layout(image);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	if (thread_index >= ctx->thread_count)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	if ((image.dim_x == 0) || (image.dim_y == 0) || (image.dim_z == 0))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// Check we have enough input and output space (16 bytes per block)
+	astcenc_block_region region = get_image_block_region(*ctx, image);
+	size_t size_needed = get_region_block_count(region) * 16;
+	if ((data_len < size_needed) || (hint_data_len < size_needed))
+	{
+		return ASTCENC_ERR_OUT_OF_MEM;
+	}
+
+	auto init_jobs = [&image, &region, hint_data, data_out](compress_job* jobs) {
+		compress_job& job = jobs[0];
+		job.image = &image;
+		job.region = region;
+		job.data_out = data_out;
+		job.row_pitch = region.dim_x;
+		job.prev_image = nullptr;
+		job.prev_data = nullptr;
+		job.hint_data = hint_data;
+	};
+
+	return compress_jobs(*ctx, thread_index, swizzle, 1, hint_data != nullptr, init_jobs);
 #endif
 }
 
@@ -896,18 +2519,80 @@ astcenc_error astcenc_compress_reset(
 		return ASTCENC_ERR_BAD_CONTEXT;
 	}
 
-	ctx->manage_avg_var.reset();
 	ctx->manage_compress.reset();
+	ctx->cancel_requested.store(false, std::memory_order_relaxed);
+	return ASTCENC_SUCCESS;
+#endif
+}
+
+astcenc_error astcenc_compress_cancel(
+	astcenc_context* ctx
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	if (ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	ctx->cancel_requested.store(true, std::memory_order_relaxed);
+	return ASTCENC_SUCCESS;
+#endif
+}
+
+astcenc_error astcenc_get_stats(
+	astcenc_context* ctx,
+	astcenc_stats& stats
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)stats;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	if (ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	stats = ctx->stats;
 	return ASTCENC_SUCCESS;
 #endif
 }
 
 astcenc_error astcenc_decompress_image(
-	astcenc_context* context,
+	astcenc_context* ctx,
 	const uint8_t* data,
 	size_t data_len,
 	astcenc_image& image_out,
-	astcenc_swizzle swizzle
+	astcenc_swizzle swizzle,
+	unsigned int thread_index
+) {
+	unsigned int block_x = ctx->config.block_x;
+	unsigned int block_y = ctx->config.block_y;
+
+	size_t xblocks = (image_out.dim_x + block_x - 1) / block_x;
+	size_t yblocks = (image_out.dim_y + block_y - 1) / block_y;
+
+	return astcenc_decompress_image_region(ctx, data, data_len,
+	                                       xblocks, xblocks * yblocks,
+	                                       0, 0, 0, image_out, swizzle,
+	                                       thread_index);
+}
+
+astcenc_error astcenc_decompress_image_region(
+	astcenc_context* ctx,
+	const uint8_t* data,
+	size_t data_len,
+	size_t row_pitch,
+	size_t slice_pitch,
+	unsigned int origin_x,
+	unsigned int origin_y,
+	unsigned int origin_z,
+	astcenc_image& image_out,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index
 ) {
 	astcenc_error status;
 
@@ -917,49 +2602,120 @@ astcenc_error astcenc_decompress_image(
 		return status;
 	}
 
-	unsigned int block_x = context->config.block_x;
-	unsigned int block_y = context->config.block_y;
-	unsigned int block_z = context->config.block_z;
+	status = validate_image_layout(image_out);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	if (thread_index >= ctx->thread_count)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	unsigned int block_x = ctx->config.block_x;
+	unsigned int block_y = ctx->config.block_y;
+	unsigned int block_z = ctx->config.block_z;
 
-	unsigned int xblocks = (image_out.dim_x + block_x - 1) / block_x;
-	unsigned int yblocks = (image_out.dim_y + block_y - 1) / block_y;
-	unsigned int zblocks = (image_out.dim_z + block_z - 1) / block_z;
+	// The blocks covering the region, as a half-open range of block indices
+	unsigned int x_start = origin_x / block_x;
+	unsigned int y_start = origin_y / block_y;
+	unsigned int z_start = origin_z / block_z;
+	unsigned int x_end = (origin_x + image_out.dim_x + block_x - 1) / block_x;
+	unsigned int y_end = (origin_y + image_out.dim_y + block_y - 1) / block_y;
+	unsigned int z_end = (origin_z + image_out.dim_z + block_z - 1) / block_z;
+
+	// Check the region is non-empty and fits in the compressed data layout
+	if ((image_out.dim_x == 0) || (image_out.dim_y == 0) || (image_out.dim_z == 0) ||
+	    (row_pitch < x_end) || (slice_pitch < row_pitch * y_end))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
 
-	// Check we have enough output space (16 bytes per block)
-	size_t size_needed = xblocks * yblocks * zblocks * 16;
+	// Check we have enough input data (16 bytes per block)
+	size_t size_needed = ((z_end - 1) * slice_pitch + (y_end - 1) * row_pitch + x_end) * 16;
 	if (data_len < size_needed)
 	{
 		return ASTCENC_ERR_OUT_OF_MEM;
 	}
 
+	unsigned int row_blocks = x_end - x_start;
+	unsigned int plane_blocks = row_blocks * (y_end - y_start);
+	unsigned int total_blocks = plane_blocks * (z_end - z_start);
+
 	imageblock pb;
 
-	for (unsigned int z = 0; z < zblocks; z++)
+	// LDR decodes to unswizzled U8 can skip the float imageblock entirely
+	bool is_ldr = (ctx->config.profile == ASTCENC_PRF_LDR) ||
+	              (ctx->config.profile == ASTCENC_PRF_LDR_SRGB);
+	bool is_identity = (swizzle.r == ASTCENC_SWZ_R) && (swizzle.g == ASTCENC_SWZ_G) &&
+	                   (swizzle.b == ASTCENC_SWZ_B) && (swizzle.a == ASTCENC_SWZ_A);
+	bool use_u8_path = is_ldr && is_identity && (image_out.data_type == ASTCENC_TYPE_U8) &&
+	                   (get_image_components(image_out) == 4);
+
+	// Only the first thread actually runs the initializer
+	ctx->manage_decompress.init(total_blocks);
+
+	// All threads run this processing loop until there is no work remaining
+	while (true)
 	{
-		for (unsigned int y = 0; y < yblocks; y++)
+		unsigned int count;
+		unsigned int base = ctx->manage_decompress.get_task_assignment(128, count);
+		if (!count)
 		{
-			for (unsigned int x = 0; x < xblocks; x++)
-			{
-				unsigned int offset = (((z * yblocks + y) * xblocks) + x) * 16;
-				const uint8_t* bp = data + offset;
-				physical_compressed_block pcb = *(const physical_compressed_block*)bp;
-				symbolic_compressed_block scb;
+			break;
+		}
+
+		for (unsigned int i = base; i < base + count; i++)
+		{
+			// Decode i into x, y, z block indices in the encoded image
+			unsigned int z = i / plane_blocks;
+			unsigned int rem = i - (z * plane_blocks);
+			unsigned int y = rem / row_blocks;
+			unsigned int x = rem - (y * row_blocks);
+
+			x += x_start;
+			y += y_start;
+			z += z_start;
 
-				physical_to_symbolic(*context->bsd, pcb, scb);
+			size_t offset = (z * slice_pitch + y * row_pitch + x) * 16;
+			const uint8_t* bp = data + offset;
+			physical_compressed_block pcb = *(const physical_compressed_block*)bp;
+			symbolic_compressed_block scb;
+
+			physical_to_symbolic(*ctx->bsd, pcb, scb);
 
-				decompress_symbolic_block(context->config.profile, context->bsd,
-				                          x * block_x, y * block_y, z * block_z,
-				                          &scb, &pb);
+			// Texel position of the block relative to the region origin
+			int xpos = static_cast<int>(x * block_x) - static_cast<int>(origin_x);
+			int ypos = static_cast<int>(y * block_y) - static_cast<int>(origin_y);
+			int zpos = static_cast<int>(z * block_z) - static_cast<int>(origin_z);
 
-				write_imageblock(image_out, &pb, context->bsd,
-				                 x * block_x, y * block_y, z * block_z, swizzle);
+			if (use_u8_path)
+			{
+				decompress_symbolic_block_u8(ctx->config.profile, ctx->bsd,
+				                             xpos, ypos, zpos, &scb, image_out);
+				continue;
 			}
+
+			decompress_symbolic_block(ctx->config.profile, ctx->bsd,
+			                          xpos, ypos, zpos, &scb, &pb);
+
+			write_imageblock(image_out, &pb, ctx->bsd, xpos, ypos, zpos, swizzle);
 		}
+
+		ctx->manage_decompress.complete_task_assignment(count);
 	}
 
 	return ASTCENC_SUCCESS;
 }
 
+astcenc_error astcenc_decompress_reset(
+	astcenc_context* ctx
+) {
+	ctx->manage_decompress.reset();
+	return ASTCENC_SUCCESS;
+}
+
 const char* astcenc_get_error_string(
 	astcenc_error status
 ) {
@@ -991,6 +2747,8 @@ const char* astcenc_get_error_string(
 		return "ASTCENC_ERR_BAD_CONTEXT";
 	case ASTCENC_ERR_NOT_IMPLEMENTED:
 		return "ASTCENC_ERR_NOT_IMPLEMENTED";
+	case ASTCENC_ERR_CANCELLED:
+		return "ASTCENC_ERR_CANCELLED";
 #if defined(ASTCENC_DIAGNOSTICS)
 	case ASTCENC_ERR_DTRACE_FAILURE:
 		return "ASTCENC_ERR_DTRACE_FAILURE";
@@ -999,3 +2757,195 @@ const char* astcenc_get_error_string(
 		return nullptr;
 	}
 }
+
+
+#if defined(ASTCENC_DISPATCH_NAMESPACE)
+
+/**
+ * @brief The printable name of the ISA of this variant.
+ */
+#if (ASTCENC_AVX == 512)
+	static const char* const ISA_VARIANT_NAME = "avx512";
+#elif (ASTCENC_AVX == 2)
+	static const char* const ISA_VARIANT_NAME = "avx2";
+#elif (ASTCENC_SSE == 41)
+	static const char* const ISA_VARIANT_NAME = "sse4.1";
+#elif (ASTCENC_SSE == 20)
+	static const char* const ISA_VARIANT_NAME = "sse2";
+#elif (ASTCENC_NEON == 1)
+	static const char* const ISA_VARIANT_NAME = "neon";
+#else
+	static const char* const ISA_VARIANT_NAME = "none";
+#endif
+
+static astcenc_error variant_context_alloc(
+	const astcenc_config& config,
+	unsigned int thread_count,
+	void** context
+) {
+	astcenc_context* ctx = nullptr;
+	astcenc_error status = astcenc_context_alloc(config, thread_count, &ctx);
+	*context = ctx;
+	return status;
+}
+
+static astcenc_error variant_compress_image(
+	void* context,
+	astcenc_image& image,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+	return astcenc_compress_image(static_cast<astcenc_context*>(context),
+	                              image, swizzle, data_out, data_len, thread_index);
+}
+
+static astcenc_error variant_compress_image_region(
+	void* context,
+	astcenc_image& image,
+	astcenc_swizzle swizzle,
+	const astcenc_block_region& region,
+	uint8_t* data_out,
+	size_t data_len,
+	size_t row_pitch,
+	unsigned int thread_index
+) {
+	return astcenc_compress_image_region(static_cast<astcenc_context*>(context),
+	                                     image, swizzle, region, data_out, data_len,
+	                                     row_pitch, thread_index);
+}
+
+static astcenc_error variant_compress_image_batch(
+	void* context,
+	const astcenc_batch_image* batch,
+	unsigned int batch_size,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index
+) {
+	return astcenc_compress_image_batch(static_cast<astcenc_context*>(context),
+	                                    batch, batch_size, swizzle, thread_index);
+}
+
+static astcenc_error variant_compress_image_incremental(
+	void* context,
+	astcenc_image& image,
+	const astcenc_image& prev_image,
+	const uint8_t* prev_data,
+	size_t prev_data_len,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+	return astcenc_compress_image_incremental(static_cast<astcenc_context*>(context),
+	                                          image, prev_image, prev_data, prev_data_len,
+	                                          swizzle, data_out, data_len, thread_index);
+}
+
+static astcenc_error variant_compress_image_hinted(
+	void* context,
+	astcenc_image& image,
+	const uint8_t* hint_data,
+	size_t hint_data_len,
+	astcenc_swizzle swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+	return astcenc_compress_image_hinted(static_cast<astcenc_context*>(context),
+	                                     image, hint_data, hint_data_len,
+	                                     swizzle, data_out, data_len, thread_index);
+}
+
+static astcenc_error variant_compress_reset(
+	void* context
+) {
+	return astcenc_compress_reset(static_cast<astcenc_context*>(context));
+}
+
+static astcenc_error variant_compress_cancel(
+	void* context
+) {
+	return astcenc_compress_cancel(static_cast<astcenc_context*>(context));
+}
+
+static astcenc_error variant_get_stats(
+	void* context,
+	astcenc_stats& stats
+) {
+	return astcenc_get_stats(static_cast<astcenc_context*>(context), stats);
+}
+
+static astcenc_error variant_decompress_image(
+	void* context,
+	const uint8_t* data,
+	size_t data_len,
+	astcenc_image& image_out,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index
+) {
+	return astcenc_decompress_image(static_cast<astcenc_context*>(context),
+	                                data, data_len, image_out, swizzle, thread_index);
+}
+
+static astcenc_error variant_decompress_image_region(
+	void* context,
+	const uint8_t* data,
+	size_t data_len,
+	size_t row_pitch,
+	size_t slice_pitch,
+	unsigned int origin_x,
+	unsigned int origin_y,
+	unsigned int origin_z,
+	astcenc_image& image_out,
+	astcenc_swizzle swizzle,
+	unsigned int thread_index
+) {
+	return astcenc_decompress_image_region(static_cast<astcenc_context*>(context),
+	                                       data, data_len, row_pitch, slice_pitch,
+	                                       origin_x, origin_y, origin_z,
+	                                       image_out, swizzle, thread_index);
+}
+
+static astcenc_error variant_decompress_reset(
+	void* context
+) {
+	return astcenc_decompress_reset(static_cast<astcenc_context*>(context));
+}
+
+static void variant_context_free(
+	void* context
+) {
+	astcenc_context_free(static_cast<astcenc_context*>(context));
+}
+
+/* See header for documentation. */
+const astcenc_isa_variant& get_isa_variant()
+{
+	static const astcenc_isa_variant variant {
+		ISA_VARIANT_NAME,
+		validate_cpu_isa,
+		astcenc_config_init,
+		variant_context_alloc,
+		variant_compress_image,
+		variant_compress_image_region,
+		variant_compress_image_batch,
+		variant_compress_image_incremental,
+		variant_compress_image_hinted,
+		variant_compress_reset,
+		variant_compress_cancel,
+		variant_get_stats,
+		variant_decompress_image,
+		variant_decompress_image_region,
+		variant_decompress_reset,
+		variant_context_free,
+		astcenc_get_error_string
+	};
+
+	return variant;
+}
+
+#endif
+
+ASTCENC_NAMESPACE_END
@@ -53,44 +53,218 @@
 
 #include "astcenc_internal.h"
 
-// TODO: This slows down when inlining, but might change if we shrink caller
-static void compute_rgba_range(
-	int texels_per_block,
-	const partition_info* pt,
+ASTCENC_NAMESPACE_BEGIN
+
+/**
+ * @brief Compute the per-partition statistics used to score a partitioning.
+ *
+ * This fuses the error weighting, average, dominant direction, and range
+ * computations for a candidate partitioning into two passes over the block,
+ * processing a SIMD vector of texels at a time. The partition assignment of
+ * each texel masks the accumulation into each partition, so there are no
+ * gathers through the texels_of_partition lists.
+ *
+ * For blocks without alpha the averages and directions are computed using the
+ * RGB texel weights, and have a zero alpha component.
+ *
+ * @param      bsd                 The block size descriptor.
+ * @param      blk                 The image block.
+ * @param      ewb                 The error weight block.
+ * @param      pt                  The partitioning to score.
+ * @param      use_alpha           Should alpha be included in the statistics?
+ * @param[out] error_weightings    The average error weight of each partition.
+ * @param[out] color_scalefactors  The color scale factor of each partition.
+ * @param[out] averages            The scaled average color of each partition.
+ * @param[out] directions          The unnormalized dominant direction of each partition.
+ * @param[out] rgba_range          The color range of each partition.
+ */
+static void compute_partition_statistics(
+	const block_size_descriptor* bsd,
 	const imageblock* blk,
 	const error_weight_block* ewb,
+	const partition_info* pt,
+	bool use_alpha,
+	vfloat4 error_weightings[4],
+	vfloat4 color_scalefactors[4],
+	vfloat4 averages[4],
+	vfloat4 directions[4],
 	vfloat4 rgba_range[4]
 ) {
-	vfloat4 rgba_min[4];
-	vfloat4 rgba_max[4];
-
+	int texel_count = bsd->texel_count;
 	int partition_count = pt->partition_count;
+	const float* texel_weights = use_alpha ? ewb->texel_weight : ewb->texel_weight_rgb;
+
+	// Texel arrays are padded to a multiple of the SIMD width, so the loops can
+	// safely overshoot the texel count; lanes past the end are masked off
+	int padded_texel_count = round_up_to_simd_multiple_vla(texel_count);
+	vint texel_limit(texel_count);
+	vfloat zero = vfloat::zero();
 
 	promise(partition_count > 0);
-	for (int i = 0; i < partition_count; i++)
+	for (int partition = 0; partition < partition_count; partition++)
 	{
-		rgba_min[i] = vfloat4(1e38f);
-		rgba_max[i] = vfloat4(-1e38f);
-	}
+		vint partition_id(partition);
+
+		vfloat error_weight_r = zero;
+		vfloat error_weight_g = zero;
+		vfloat error_weight_b = zero;
+		vfloat error_weight_a = zero;
+
+		vfloat weight_sum = zero;
+		vfloat base_sum_r = zero;
+		vfloat base_sum_g = zero;
+		vfloat base_sum_b = zero;
+		vfloat base_sum_a = zero;
+
+		vfloat min_r(1e38f);
+		vfloat min_g(1e38f);
+		vfloat min_b(1e38f);
+		vfloat min_a(1e38f);
+
+		vfloat max_r(-1e38f);
+		vfloat max_g(-1e38f);
+		vfloat max_b(-1e38f);
+		vfloat max_a(-1e38f);
+
+		// First pass computes the error weights, weighted color sums, and ranges
+		vint texel_ids = vint::lane_id();
+		for (int i = 0; i < padded_texel_count; i += ASTCENC_SIMD_WIDTH)
+		{
+			vmask in_partition = (texel_ids < texel_limit) &
+			                     (vint(pt->partition_of_texel + i) == partition_id);
+			texel_ids = texel_ids + vint(ASTCENC_SIMD_WIDTH);
+
+			vfloat data_r = select(zero, vfloat(blk->data_r + i), in_partition);
+			vfloat data_g = select(zero, vfloat(blk->data_g + i), in_partition);
+			vfloat data_b = select(zero, vfloat(blk->data_b + i), in_partition);
+			vfloat data_a = select(zero, vfloat(blk->data_a + i), in_partition);
+
+			error_weight_r = error_weight_r + select(zero, vfloat(ewb->texel_weight_r + i), in_partition);
+			error_weight_g = error_weight_g + select(zero, vfloat(ewb->texel_weight_g + i), in_partition);
+			error_weight_b = error_weight_b + select(zero, vfloat(ewb->texel_weight_b + i), in_partition);
+			error_weight_a = error_weight_a + select(zero, vfloat(ewb->texel_weight_a + i), in_partition);
+
+			vfloat weight = select(zero, vfloat(texel_weights + i), in_partition);
+			weight_sum = weight_sum + weight;
+			base_sum_r = base_sum_r + data_r * weight;
+			base_sum_g = base_sum_g + data_g * weight;
+			base_sum_b = base_sum_b + data_b * weight;
+			base_sum_a = base_sum_a + data_a * weight;
+
+			vmask in_range = in_partition & (vfloat(ewb->texel_weight + i) > vfloat(1e-10f));
+			min_r = min(min_r, select(vfloat(1e38f), data_r, in_range));
+			min_g = min(min_g, select(vfloat(1e38f), data_g, in_range));
+			min_b = min(min_b, select(vfloat(1e38f), data_b, in_range));
+			min_a = min(min_a, select(vfloat(1e38f), data_a, in_range));
+
+			max_r = max(max_r, select(vfloat(-1e38f), data_r, in_range));
+			max_g = max(max_g, select(vfloat(-1e38f), data_g, in_range));
+			max_b = max(max_b, select(vfloat(-1e38f), data_b, in_range));
+			max_a = max(max_a, select(vfloat(-1e38f), data_a, in_range));
+		}
 
-	promise(texels_per_block > 0);
-	for (int i = 0; i < texels_per_block; i++)
-	{
-		if (ewb->texel_weight[i] > 1e-10f)
+		vfloat4 error_weight(hadd_s(error_weight_r), hadd_s(error_weight_g),
+		                     hadd_s(error_weight_b), hadd_s(error_weight_a));
+		error_weight = (error_weight + vfloat4(1e-12f)) * (1.0f / pt->texels_per_partition[partition]);
+		error_weightings[partition] = error_weight;
+		color_scalefactors[partition] = sqrt(error_weight);
+
+		vfloat4 base_sum(hadd_s(base_sum_r), hadd_s(base_sum_g),
+		                 hadd_s(base_sum_b), use_alpha ? hadd_s(base_sum_a) : 0.0f);
+		vfloat4 average = base_sum * (1.0f / astc::max(hadd_s(weight_sum), 1e-7f));
+		averages[partition] = average * color_scalefactors[partition];
+
+		// Covert min/max into ranges forcing a min range of 1e-10
+		// to avoid divide by zeros later ...
+		vfloat4 rgba_min(hmin_s(min_r), hmin_s(min_g), hmin_s(min_b), hmin_s(min_a));
+		vfloat4 rgba_max(hmax_s(max_r), hmax_s(max_g), hmax_s(max_b), hmax_s(max_a));
+		rgba_range[partition] = max(rgba_max - rgba_min, 1e-10f);
+
+		// Second pass sums the weighted offsets from the average, split by the
+		// sign of each component, to find the dominant direction
+		vfloat average_r(average.lane<0>());
+		vfloat average_g(average.lane<1>());
+		vfloat average_b(average.lane<2>());
+		vfloat average_a(average.lane<3>());
+
+		vfloat sum_xp_r = zero, sum_xp_g = zero, sum_xp_b = zero, sum_xp_a = zero;
+		vfloat sum_yp_r = zero, sum_yp_g = zero, sum_yp_b = zero, sum_yp_a = zero;
+		vfloat sum_zp_r = zero, sum_zp_g = zero, sum_zp_b = zero, sum_zp_a = zero;
+		vfloat sum_wp_r = zero, sum_wp_g = zero, sum_wp_b = zero, sum_wp_a = zero;
+
+		texel_ids = vint::lane_id();
+		for (int i = 0; i < padded_texel_count; i += ASTCENC_SIMD_WIDTH)
 		{
-			int partition = pt->partition_of_texel[i];
-			vfloat4 data = blk->texel(i);
+			vmask in_partition = (texel_ids < texel_limit) &
+			                     (vint(pt->partition_of_texel + i) == partition_id);
+			texel_ids = texel_ids + vint(ASTCENC_SIMD_WIDTH);
+
+			vfloat weight(texel_weights + i);
+			vfloat diff_r = select(zero, (vfloat(blk->data_r + i) - average_r) * weight, in_partition);
+			vfloat diff_g = select(zero, (vfloat(blk->data_g + i) - average_g) * weight, in_partition);
+			vfloat diff_b = select(zero, (vfloat(blk->data_b + i) - average_b) * weight, in_partition);
+			vfloat diff_a = zero;
+			if (use_alpha)
+			{
+				diff_a = select(zero, (vfloat(blk->data_a + i) - average_a) * weight, in_partition);
+			}
 
-			rgba_min[partition] = min(data, rgba_min[partition]);
-			rgba_max[partition] = max(data, rgba_max[partition]);
+			vmask xp = diff_r > zero;
+			sum_xp_r = sum_xp_r + select(zero, diff_r, xp);
+			sum_xp_g = sum_xp_g + select(zero, diff_g, xp);
+			sum_xp_b = sum_xp_b + select(zero, diff_b, xp);
+			sum_xp_a = sum_xp_a + select(zero, diff_a, xp);
+
+			vmask yp = diff_g > zero;
+			sum_yp_r = sum_yp_r + select(zero, diff_r, yp);
+			sum_yp_g = sum_yp_g + select(zero, diff_g, yp);
+			sum_yp_b = sum_yp_b + select(zero, diff_b, yp);
+			sum_yp_a = sum_yp_a + select(zero, diff_a, yp);
+
+			vmask zp = diff_b > zero;
+			sum_zp_r = sum_zp_r + select(zero, diff_r, zp);
+			sum_zp_g = sum_zp_g + select(zero, diff_g, zp);
+			sum_zp_b = sum_zp_b + select(zero, diff_b, zp);
+			sum_zp_a = sum_zp_a + select(zero, diff_a, zp);
+
+			vmask wp = diff_a > zero;
+			sum_wp_r = sum_wp_r + select(zero, diff_r, wp);
+			sum_wp_g = sum_wp_g + select(zero, diff_g, wp);
+			sum_wp_b = sum_wp_b + select(zero, diff_b, wp);
+			sum_wp_a = sum_wp_a + select(zero, diff_a, wp);
 		}
-	}
 
-	// Covert min/max into ranges forcing a min range of 1e-10
-	// to avoid divide by zeros later ...
-	for (int i = 0; i < partition_count; i++)
-	{
-		rgba_range[i] = max(rgba_max[i] - rgba_min[i], 1e-10f);
+		vfloat4 sum_xp(hadd_s(sum_xp_r), hadd_s(sum_xp_g), hadd_s(sum_xp_b), hadd_s(sum_xp_a));
+		vfloat4 sum_yp(hadd_s(sum_yp_r), hadd_s(sum_yp_g), hadd_s(sum_yp_b), hadd_s(sum_yp_a));
+		vfloat4 sum_zp(hadd_s(sum_zp_r), hadd_s(sum_zp_g), hadd_s(sum_zp_b), hadd_s(sum_zp_a));
+		vfloat4 sum_wp(hadd_s(sum_wp_r), hadd_s(sum_wp_g), hadd_s(sum_wp_b), hadd_s(sum_wp_a));
+
+		float prod_xp = dot_s(sum_xp, sum_xp);
+		float prod_yp = dot_s(sum_yp, sum_yp);
+		float prod_zp = dot_s(sum_zp, sum_zp);
+		float prod_wp = dot_s(sum_wp, sum_wp);
+
+		vfloat4 best_vector = sum_xp;
+		float best_sum = prod_xp;
+
+		if (prod_yp > best_sum)
+		{
+			best_vector = sum_yp;
+			best_sum = prod_yp;
+		}
+
+		if (prod_zp > best_sum)
+		{
+			best_vector = sum_zp;
+			best_sum = prod_zp;
+		}
+
+		if (prod_wp > best_sum)
+		{
+			best_vector = sum_wp;
+		}
+
+		directions[partition] = best_vector;
 	}
 }
 
@@ -165,6 +339,9 @@ void find_best_partitionings(
 
 	const partition_info* ptab = get_partition_table(bsd, partition_count);
 
+	// Only the unique, non-degenerate partitionings are searched
+	partition_search_limit = astc::min(partition_search_limit, bsd->partitioning_count[partition_count - 1]);
+
 	// Partitioning errors assuming uncorrelated-chrominance endpoints
 	float uncorr_best_error { ERROR_CALC_DEFAULT };
 	int uncorr_best_partition { 0 };
@@ -186,31 +363,24 @@ void find_best_partitionings(
 		{
 			int partition = partition_sequence[i];
 
-			int bk_partition_count = ptab[partition].partition_count;
-			if (bk_partition_count < partition_count)
-			{
-				continue;
-			}
-
 			// compute the weighting to give to each color channel
 			// in each partition.
 			vfloat4 error_weightings[4];
 			vfloat4 color_scalefactors[4];
 			vfloat4 inverse_color_scalefactors[4];
-			compute_partition_error_color_weightings(bsd, ewb, ptab + partition, error_weightings, color_scalefactors);
+			vfloat4 averages[4];
+			vfloat4 directions_rgba[4];
+			vfloat4 rgba_range[4];
+
+			compute_partition_statistics(bsd, blk, ewb, ptab + partition, true,
+			                             error_weightings, color_scalefactors,
+			                             averages, directions_rgba, rgba_range);
 
 			for (int j = 0; j < partition_count; j++)
 			{
 				inverse_color_scalefactors[j] = 1.0f / max(color_scalefactors[j], 1e-7f);
 			}
 
-			vfloat4 averages[4];
-			vfloat4 directions_rgba[4];
-
-			compute_averages_and_directions_rgba(ptab + partition, blk, ewb,
-			                                     color_scalefactors, averages,
-			                                     directions_rgba);
-
 			line4 uncorr_lines[4];
 			line4 samechroma_lines[4];
 			line3 separate_red_lines[4];
@@ -340,10 +510,6 @@ void find_best_partitionings(
 			                           &uncorr_error,
 			                           &samechroma_error);
 
-			// compute minimum & maximum alpha values in each partition
-			vfloat4 rgba_range[4];
-			compute_rgba_range(bsd->texel_count, ptab + partition, blk, ewb, rgba_range);
-
 			/*
 			   Compute an estimate of error introduced by weight quantization imprecision.
 			   This error is computed as follows, for each partition
@@ -443,30 +609,24 @@ void find_best_partitionings(
 		{
 			int partition = partition_sequence[i];
 
-			int bk_partition_count = ptab[partition].partition_count;
-			if (bk_partition_count < partition_count)
-			{
-				continue;
-			}
-
 			// compute the weighting to give to each color channel
 			// in each partition.
 			vfloat4 error_weightings[4];
 			vfloat4 color_scalefactors[4];
 			vfloat4 inverse_color_scalefactors[4];
+			vfloat4 averages[4];
+			vfloat4 directions_rgb[4];
+			vfloat4 rgba_range[4];
 
-			compute_partition_error_color_weightings(bsd, ewb, ptab + partition, error_weightings, color_scalefactors);
+			compute_partition_statistics(bsd, blk, ewb, ptab + partition, false,
+			                             error_weightings, color_scalefactors,
+			                             averages, directions_rgb, rgba_range);
 
 			for (int j = 0; j < partition_count; j++)
 			{
 				inverse_color_scalefactors[j] = 1.0f / max(color_scalefactors[j], 1e-7f);
 			}
 
-			vfloat4 averages[4];
-			vfloat4 directions_rgb[4];
-
-			compute_averages_and_directions_rgb(ptab + partition, blk, ewb, color_scalefactors, averages, directions_rgb);
-
 			line3 uncorr_lines[4];
 			line3 samechroma_lines[4];
 			line2 separate_red_lines[4];
@@ -574,9 +734,6 @@ void find_best_partitionings(
 			                          &uncorr_error,
 			                          &samechroma_error);
 
-			vfloat4 rgba_range[4];
-			compute_rgba_range(bsd->texel_count, ptab + partition, blk, ewb, rgba_range);
-
 			/*
 			   compute an estimate of error introduced by weight imprecision.
 			   This error is computed as follows, for each partition
@@ -665,13 +822,16 @@ void find_best_partitionings(
 		}
 	}
 
-	*best_partition_uncorrelated = uncorr_best_partition;
+	// Convert the table array indices into physical partition indices
+	*best_partition_uncorrelated = ptab[uncorr_best_partition].partition_index;
 
 	int index { samechroma_best_partitions[0] != uncorr_best_partition ? 0 : 1 };
-	*best_partition_samechroma = samechroma_best_partitions[index];
+	*best_partition_samechroma = ptab[samechroma_best_partitions[index]].partition_index;
 
 	*best_partition_dualplane = (separate_best_component << PARTITION_BITS) |
-	                            (separate_best_partition);
+	                            (ptab[separate_best_partition].partition_index);
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
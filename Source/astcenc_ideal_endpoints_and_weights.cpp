@@ -34,6 +34,8 @@
 	#include <fenv.h>
 #endif
 
+ASTCENC_NAMESPACE_BEGIN
+
 static void compute_endpoints_and_ideal_weights_1_component(
 	const block_size_descriptor* bsd,
 	const partition_info* pt,
@@ -756,6 +758,57 @@ void compute_endpoints_and_ideal_weights_2_planes(
      go into a given texel.
 */
 
+/**
+ * @brief Compute the error of a weight set for a weight grid with one weight per texel.
+ *
+ * @param eai           The ideal weights and their error significance.
+ * @param texel_count   The number of texels in the block.
+ * @param weights       The weight values, one per texel.
+ *
+ * @return The summed error of the weight set.
+ */
+static float compute_error_of_undecimated_weight_set(
+	const endpoints_and_weights* eai,
+	int texel_count,
+	const float* weights
+) {
+	vfloat verror_summa(0.0f);
+	float error_summa = 0.0f;
+
+	int i = 0;
+
+#if ASTCENC_SIMD_WIDTH > 1
+
+	// Process SIMD-width texel coordinates at at time while we can
+	int clipped_texel_count = round_down_to_simd_multiple_vla(texel_count);
+	for (/* */; i < clipped_texel_count; i += ASTCENC_SIMD_WIDTH)
+	{
+		vfloat current_values = loada(weights + i);
+		vfloat actual_values = loada(&(eai->weights[i]));
+		vfloat diff = current_values - actual_values;
+		vfloat significance = loada(&(eai->weight_error_scale[i]));
+		vfloat error = diff * diff * significance;
+
+		verror_summa = verror_summa + error;
+	}
+
+	// Accumulate the error vectors into a single error sum
+	error_summa += hadd_s(verror_summa);
+
+#endif
+
+	// Loop tail
+	for (/* */; i < texel_count; i++)
+	{
+		float valuedif = weights[i] - eai->weights[i];
+		float error = valuedif * valuedif * eai->weight_error_scale[i];
+
+		error_summa += error;
+	}
+
+	return error_summa;
+}
+
 float compute_error_of_weight_set(
 	const endpoints_and_weights* eai,
 	const decimation_table* it,
@@ -765,6 +818,12 @@ float compute_error_of_weight_set(
 	float error_summa = 0.0f;
 	int texel_count = it->texel_count;
 
+	// Weight grids the same size as the block need no infill
+	if (it->weight_count == texel_count)
+	{
+		return compute_error_of_undecimated_weight_set(eai, texel_count, weights);
+	}
+
 	int i = 0;
 
 #if ASTCENC_SIMD_WIDTH > 1
@@ -849,7 +908,7 @@ void compute_ideal_weights_for_decimation_table(
 	{
 		for (int i = 0; i < texel_count; i++)
 		{
-			assert(i == dt.weight_texel[i][0]);
+			assert(i == dt.weight_texel[dt.weight_texel_offset[i]]);
 			weight_set[i] = eai.weights[i];
 			weights[i] = eai.weight_error_scale[i];
 		}
@@ -868,12 +927,14 @@ void compute_ideal_weights_for_decimation_table(
 
 		// Accumulate error weighting of all the texels using this weight
 		int weight_texel_count = dt.weight_texel_count[i];
+		const uint8_t *weight_texel_ptr = dt.weight_texel + dt.weight_texel_offset[i];
+		const float *weights_ptr = dt.weights_flt + dt.weight_texel_offset[i];
 		promise(weight_texel_count > 0);
 
 		for (int j = 0; j < weight_texel_count; j++)
 		{
-			int texel = dt.weight_texel[i][j];
-			float weight = dt.weights_flt[i][j];
+			int texel = weight_texel_ptr[j];
+			float weight = weights_ptr[j];
 			float contrib_weight = weight * eai.weight_error_scale[texel];
 			weight_weight += contrib_weight;
 			initial_weight += eai.weights[texel] * contrib_weight;
@@ -902,8 +963,8 @@ void compute_ideal_weights_for_decimation_table(
 	{
 		float weight_val = weight_set[i];
 
-		const uint8_t *weight_texel_ptr = dt.weight_texel[i];
-		const float *weights_ptr = dt.weights_flt[i];
+		const uint8_t *weight_texel_ptr = dt.weight_texel + dt.weight_texel_offset[i];
+		const float *weights_ptr = dt.weights_flt + dt.weight_texel_offset[i];
 
 		// Start with a small value to avoid div-by-zero later
 		float error_change0 = 1e-10f;
@@ -1036,6 +1097,26 @@ void compute_quantized_weights_for_decimation_table(
 	}
 }
 
+/**
+ * @brief Compute the bilinear infill of a decimated weight grid for a texel.
+ *
+ * @param dt        The decimation table.
+ * @param weights   The decimated weight values.
+ * @param index     The texel index.
+ *
+ * @return The interpolated weight for the texel.
+ */
+static inline float bilinear_infill(
+	const decimation_table& dt,
+	const float* weights,
+	int index
+) {
+	return (weights[dt.texel_weights_t4[index][0]] * dt.texel_weights_float_t4[index][0]
+	      + weights[dt.texel_weights_t4[index][1]] * dt.texel_weights_float_t4[index][1])
+	     + (weights[dt.texel_weights_t4[index][2]] * dt.texel_weights_float_t4[index][2]
+	      + weights[dt.texel_weights_t4[index][3]] * dt.texel_weights_float_t4[index][3]);
+}
+
 static inline vfloat4 compute_rgbovec(
 	vfloat4 rgba_weight_sum,
 	vfloat4 weight_weight_sum,
@@ -1116,6 +1197,9 @@ void recompute_ideal_colors_2planes(
 ) {
 	const quantization_and_transfer_table *qat = &(quant_and_xfer_tables[weight_quant_mode]);
 
+	// Weight grids the same size as the block need no infill
+	bool is_undecimated = it->weight_count == it->texel_count;
+
 	float weight_set[MAX_WEIGHTS_PER_BLOCK];
 	float plane2_weight_set[MAX_WEIGHTS_PER_BLOCK];
 
@@ -1194,12 +1278,7 @@ void recompute_ideal_colors_2planes(
 			// FIXME: move this calculation out to the color block.
 			float ls_weight = hadd_rgb_s(color_weight);
 
-			const uint8_t *texel_weights = it->texel_weights_t4[tix];
-			const float *texel_weights_float = it->texel_weights_float_t4[tix];
-			float idx0 = (weight_set[texel_weights[0]] * texel_weights_float[0]
-			            + weight_set[texel_weights[1]] * texel_weights_float[1])
-			           + (weight_set[texel_weights[2]] * texel_weights_float[2]
-			            + weight_set[texel_weights[3]] * texel_weights_float[3]);
+			float idx0 = is_undecimated ? weight_set[tix] : bilinear_infill(*it, weight_set, tix);
 
 			float om_idx0 = 1.0f - idx0;
 			wmin1 = astc::min(idx0, wmin1);
@@ -1229,10 +1308,7 @@ void recompute_ideal_colors_2planes(
 
 			if (plane2_weight_set8)
 			{
-				idx1 = (plane2_weight_set[texel_weights[0]] * texel_weights_float[0]
-				      + plane2_weight_set[texel_weights[1]] * texel_weights_float[1])
-				     + (plane2_weight_set[texel_weights[2]] * texel_weights_float[2]
-				      + plane2_weight_set[texel_weights[3]] * texel_weights_float[3]);
+				idx1 = is_undecimated ? plane2_weight_set[tix] : bilinear_infill(*it, plane2_weight_set, tix);
 
 				om_idx1 = 1.0f - idx1;
 				wmin2 = astc::min(idx1, wmin2);
@@ -1454,6 +1530,9 @@ void recompute_ideal_colors_1plane(
 
 	const quantization_and_transfer_table *qat = &(quant_and_xfer_tables[weight_quant_mode]);
 
+	// Weight grids the same size as the block need no infill
+	bool is_undecimated = weight_count == it->texel_count;
+
 	float weight_set[MAX_WEIGHTS_PER_BLOCK];
 	for (int i = 0; i < weight_count; i++)
 	{
@@ -1516,12 +1595,7 @@ void recompute_ideal_colors_1plane(
 			// FIXME: move this calculation out to the color block.
 			float ls_weight = hadd_rgb_s(color_weight);
 
-			const uint8_t *texel_weights = it->texel_weights_t4[tix];
-			const float *texel_weights_float = it->texel_weights_float_t4[tix];
-			float idx0 = (weight_set[texel_weights[0]] * texel_weights_float[0]
-			            + weight_set[texel_weights[1]] * texel_weights_float[1])
-			           + (weight_set[texel_weights[2]] * texel_weights_float[2]
-			            + weight_set[texel_weights[3]] * texel_weights_float[3]);
+			float idx0 = is_undecimated ? weight_set[tix] : bilinear_infill(*it, weight_set, tix);
 
 			float om_idx0 = 1.0f - idx0;
 			wmin1 = astc::min(idx0, wmin1);
@@ -1678,4 +1752,6 @@ void recompute_ideal_colors_1plane(
 	}
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
@@ -24,78 +24,68 @@
 
 #include "astcenc_internal.h"
 
-// conversion functions between the LNS representation and the FP16 representation.
-static float float_to_lns(float p)
-{
-	if (!(p > (1.0f / 67108864.0f)))
-	{
-		// underflow or NaN value, return 0.
-		// We count underflow if the input value is smaller than 2^-26.
-		return 0.0f;
-	}
-
-	if (p >= 65536.0f)
-	{
-		// overflow, return a +INF value
-		return 65535.0f;
-	}
-
-	int expo;
-	float normfrac = astc::frexp(p, &expo);
-	float p1;
-	if (expo < -13)
-	{
-		// input number is smaller than 2^-14. In this case, multiply by 2^25.
-		p1 = p * 33554432.0f;
-		expo = 0;
-	}
-	else
-	{
-		expo += 14;
-		p1 = (normfrac - 0.5f) * 4096.0f;
-	}
-
-	if (p1 < 384.0f)
-	{
-		p1 *= 4.0f / 3.0f;
-	}
-	else if (p1 <= 1408.0f)
-	{
-		p1 += 128.0f;
-	}
-	else
-	{
-		p1 = (p1 + 512.0f) * (4.0f / 5.0f);
-	}
+ASTCENC_NAMESPACE_BEGIN
 
-	p1 += ((float)expo) * 2048.0f;
-	return p1 + 1.0f;
+/**
+ * @brief Convert float values to the LNS representation.
+ *
+ * Values smaller than 2^-26, and NaN, are returned as zero; values larger
+ * than 65535 are returned as 65535.
+ *
+ * @param a   The input values.
+ *
+ * @return The LNS values.
+ */
+static vfloat4 float_to_lns(vfloat4 a)
+{
+	vmask4 underflow = ~(a > vfloat4(1.0f / 67108864.0f));
+	vmask4 overflow = a >= vfloat4(65536.0f);
+
+	// Split into a normalized fraction in the range [0.5, 1) and an exponent
+	vint4 bits = float_as_int(a);
+	vint4 expo = (lsr<23>(bits) & vint4(0xFF)) - vint4(126);
+	vfloat4 normfrac = int_as_float((bits & vint4(0x807FFFFF)) | vint4(0x3F000000));
+
+	// Inputs smaller than 2^-14 are multiplied by 2^25
+	vmask4 denormal = expo < vint4(-13);
+	vfloat4 p1 = select((normfrac - vfloat4(0.5f)) * 4096.0f, a * 33554432.0f, denormal);
+	expo = select(expo + vint4(14), vint4::zero(), denormal);
+
+	vmask4 mant_lo = p1 < vfloat4(384.0f);
+	vmask4 mant_hi = p1 > vfloat4(1408.0f);
+	vfloat4 p1_lo = p1 * (4.0f / 3.0f);
+	vfloat4 p1_mid = p1 + vfloat4(128.0f);
+	vfloat4 p1_hi = (p1 + vfloat4(512.0f)) * (4.0f / 5.0f);
+	p1 = select(select(p1_mid, p1_lo, mant_lo), p1_hi, mant_hi);
+
+	p1 = p1 + int_to_float(expo) * 2048.0f;
+	p1 = p1 + vfloat4(1.0f);
+
+	p1 = select(p1, vfloat4(65535.0f), overflow);
+	return select(p1, vfloat4::zero(), underflow);
 }
 
-static uint16_t lns_to_sf16(uint16_t p)
+/**
+ * @brief Convert LNS values to FP16 bit patterns.
+ *
+ * @param p   The input values, in the low 16 bits of each lane.
+ *
+ * @return The FP16 bit patterns, in the low 16 bits of each lane.
+ */
+static vint4 lns_to_sf16(vint4 p)
 {
-	uint16_t mc = p & 0x7FF;
-	uint16_t ec = p >> 11;
-	uint16_t mt;
-	if (mc < 512)
-	{
-		mt = 3 * mc;
-	}
-	else if (mc < 1536)
-	{
-		mt = 4 * mc - 512;
-	}
-	else
-	{
-		mt = 5 * mc - 2048;
-	}
+	vint4 mc = p & vint4(0x7FF);
+	vint4 ec = lsr<11>(p);
 
-	uint16_t res = (ec << 10) | (mt >> 3);
-	if (res > 0x7BFF)
-	{
-		res = 0x7BFF;
-	}
-	return res;
+	vint4 mc_lo = mc * 3;
+	vint4 mc_mid = mc * 4 - vint4(512);
+	vint4 mc_hi = mc * 5 - vint4(2048);
+
+	vint4 mt = select(mc_hi, mc_mid, mc < vint4(1536));
+	mt = select(mt, mc_lo, mc < vint4(512));
+
+	vint4 res = lsl<10>(ec) | lsr<3>(mt);
+	return min(res, vint4(0x7BFF));
 }
 
 // conversion function from 16-bit LDR value to FP16.
@@ -121,6 +111,45 @@ uint16_t unorm16_to_sf16(uint16_t p)
 	return p;
 }
 
+/**
+ * @brief Convert UNORM16 values to FP16 bit patterns.
+ *
+ * This is a vectorized equivalent of the scalar unorm16_to_sf16().
+ *
+ * @param p   The input values, in the low 16 bits of each lane.
+ *
+ * @return The FP16 bit patterns, in the low 16 bits of each lane.
+ */
+static vint4 unorm16_to_sf16(vint4 p)
+{
+	// Inputs are exact in FP32, so the FP16 exponent and the truncated FP16
+	// mantissa of p * 2^-16 can be taken directly from the FP32 bit pattern
+	vint4 fp32 = float_as_int(int_to_float(p));
+	vint4 expo = (lsr<23>(fp32) & vint4(0xFF)) - vint4(128);
+	vint4 mant = lsr<13>(fp32) & vint4(0x3FF);
+	vint4 res = lsl<10>(expo) | mant;
+
+	// Small inputs are FP16 denormals
+	res = select(res, lsl<8>(p), p < vint4(4));
+	return select(res, vint4(0x3C00), p == vint4(0xFFFF));
+}
+
+/**
+ * @brief Get the LNS lane mask for a texel.
+ *
+ * @param pb      The image block.
+ * @param index   The texel index.
+ *
+ * @return The mask, with lanes set for components stored as LNS.
+ */
+static inline vmask4 get_lns_mask(
+	const imageblock* pb,
+	int index
+) {
+	int rgb_lns = pb->rgb_lns[index];
+	return vint4(rgb_lns, rgb_lns, rgb_lns, pb->alpha_lns[index]) != vint4::zero();
+}
+
 void imageblock_initialize_deriv(
 	const imageblock* pb,
 	int pixelcount,
@@ -128,52 +157,62 @@ void imageblock_initialize_deriv(
 ) {
 	for (int i = 0; i < pixelcount; i++)
 	{
-		float dr = 65535.0f;
-		float dg = 65535.0f;
-		float db = 65535.0f;
-		float da = 65535.0f;
+		vfloat4 derv(65535.0f);
 
-		// compute derivatives for RGB first
-		if (pb->rgb_lns[i])
+		// Compute derivatives for the components stored as LNS
+		vmask4 lns_mask = get_lns_mask(pb, i);
+		if (any(lns_mask))
 		{
-			vfloat4 fdata = pb->texel3(i);
-			fdata.set_lane<0>(sf16_to_float(lns_to_sf16((uint16_t)fdata.lane<0>())));
-			fdata.set_lane<1>(sf16_to_float(lns_to_sf16((uint16_t)fdata.lane<1>())));
-			fdata.set_lane<2>(sf16_to_float(lns_to_sf16((uint16_t)fdata.lane<2>())));
-
-			float r = astc::max(fdata.lane<0>(), 6e-5f);
-			float g = astc::max(fdata.lane<1>(), 6e-5f);
-			float b = astc::max(fdata.lane<2>(), 6e-5f);
-
-			float rderiv = (float_to_lns(r * 1.05f) - float_to_lns(r)) / (r * 0.05f);
-			float gderiv = (float_to_lns(g * 1.05f) - float_to_lns(g)) / (g * 0.05f);
-			float bderiv = (float_to_lns(b * 1.05f) - float_to_lns(b)) / (b * 0.05f);
-
-			// the derivative may not actually take values smaller than 1/32 or larger than 2^25;
-			// if it does, we clamp it.
-			dr = astc::clamp(rderiv, 1.0f / 32.0f, 33554432.0f);
-			dg = astc::clamp(gderiv, 1.0f / 32.0f, 33554432.0f);
-			db = astc::clamp(bderiv, 1.0f / 32.0f, 33554432.0f);
-		}
+			vint4 datai = lns_to_sf16(float_to_int(pb->texel(i)));
+			vfloat4 data = max(float16_to_float(datai), 6e-5f);
 
-		// then compute derivatives for Alpha
-		if (pb->alpha_lns[i])
-		{
-			float fdata = pb->data_a[i];
-			fdata = sf16_to_float(lns_to_sf16((uint16_t)fdata));
-
-			float a = astc::max(fdata, 6e-5f);
-			float aderiv = (float_to_lns(a * 1.05f) - float_to_lns(a)) / (a * 0.05f);
-			// the derivative may not actually take values smaller than 1/32 or larger than 2^25;
-			// if it does, we clamp it.
-			da = astc::clamp(aderiv, 1.0f / 32.0f, 33554432.0f);
+			vfloat4 data_lns_hi = float_to_lns(data * 1.05f);
+			vfloat4 data_lns = float_to_lns(data);
+			vfloat4 deriv = (data_lns_hi - data_lns) / (data * 0.05f);
+
+			// The derivative may not actually take values smaller than 1/32 or
+			// larger than 2^25; if it does, we clamp it.
+			deriv = clamp(1.0f / 32.0f, 33554432.0f, deriv);
+			derv = select(derv, deriv, lns_mask);
 		}
 
-		*dptr = vfloat4(dr, dg, db, da);
+		*dptr = derv;
 		dptr++;
 	}
 }
 
+/**
+ * @brief Store a texel in the block, and update the block metadata.
+ *
+ * @param         pb          The image block.
+ * @param         index       The texel index.
+ * @param         data        The texel data.
+ * @param[in,out] data_min    The running minimum of the block data.
+ * @param[in,out] data_max    The running maximum of the block data.
+ * @param[in,out] grayscale   The running grayscale status of the block.
+ */
+static inline void store_block_texel(
+	imageblock* pb,
+	int index,
+	vfloat4 data,
+	vfloat4& data_min,
+	vfloat4& data_max,
+	bool& grayscale
+) {
+	data_min = min(data_min, data);
+	data_max = max(data_max, data);
+
+	if (grayscale && (data.lane<0>() != data.lane<1>() || data.lane<0>() != data.lane<2>()))
+	{
+		grayscale = false;
+	}
+
+	pb->data_r[index] = data.lane<0>();
+	pb->data_g[index] = data.lane<1>();
+	pb->data_b[index] = data.lane<2>();
+	pb->data_a[index] = data.lane<3>();
+}
+
 // helper function to initialize the work-data from the orig-data
 static void imageblock_initialize_work_from_orig(
 	imageblock* pb,
@@ -188,43 +227,19 @@ static void imageblock_initialize_work_from_orig(
 	for (int i = 0; i < pixelcount; i++)
 	{
 		vfloat4 data = pb->texel(i);
+		vfloat4 data_unorm = data * 65535.0f;
 
-		if (pb->rgb_lns[i])
+		vmask4 lns_mask = get_lns_mask(pb, i);
+		if (any(lns_mask))
 		{
-			data.set_lane<0>(float_to_lns(data.lane<0>()));
-			data.set_lane<1>(float_to_lns(data.lane<1>()));
-			data.set_lane<2>(float_to_lns(data.lane<2>()));
+			data = select(data_unorm, float_to_lns(data), lns_mask);
 		}
 		else
 		{
-			data.set_lane<0>(data.lane<0>() * 65535.0f);
-			data.set_lane<1>(data.lane<1>() * 65535.0f);
-			data.set_lane<2>(data.lane<2>() * 65535.0f);
+			data = data_unorm;
 		}
 
-		if (pb->alpha_lns[i])
-		{
-			data.set_lane<3>(float_to_lns(data.lane<3>()));
-		}
-		else
-		{
-			data.set_lane<3>(data.lane<3>() * 65535.0f);
-		}
-
-		// Compute block metadata
-		data_min = min(data_min, data);
-		data_max = max(data_max, data);
-
-		if (grayscale && (data.lane<0>() != data.lane<1>() || data.lane<0>() != data.lane<2>()))
-		{
-			grayscale = false;
-		}
-
-		// Store block data
-		pb->data_r[i] = data.lane<0>();
-		pb->data_g[i] = data.lane<1>();
-		pb->data_b[i] = data.lane<2>();
-		pb->data_a[i] = data.lane<3>();
+		store_block_texel(pb, i, data, data_min, data_max, grayscale);
 	}
 
 	// Store block metadata
@@ -244,50 +259,192 @@ void imageblock_initialize_orig_from_work(
 
 	for (int i = 0; i < pixelcount; i++)
 	{
-		vfloat4 data = pb->texel(i);
+		vint4 datai = float_to_int(pb->texel(i));
+		vint4 data_f16 = unorm16_to_sf16(datai);
 
-		if (pb->rgb_lns[i])
-		{
-			data.set_lane<0>(sf16_to_float(lns_to_sf16((uint16_t)data.lane<0>())));
-			data.set_lane<1>(sf16_to_float(lns_to_sf16((uint16_t)data.lane<1>())));
-			data.set_lane<2>(sf16_to_float(lns_to_sf16((uint16_t)data.lane<2>())));
-		}
-		else
+		vmask4 lns_mask = get_lns_mask(pb, i);
+		if (any(lns_mask))
 		{
-			data.set_lane<0>(sf16_to_float(unorm16_to_sf16((uint16_t)data.lane<0>())));
-			data.set_lane<1>(sf16_to_float(unorm16_to_sf16((uint16_t)data.lane<1>())));
-			data.set_lane<2>(sf16_to_float(unorm16_to_sf16((uint16_t)data.lane<2>())));
+			data_f16 = select(data_f16, lns_to_sf16(datai), lns_mask);
 		}
 
-		if (pb->alpha_lns[i])
-		{
-			data.set_lane<3>(sf16_to_float(lns_to_sf16((uint16_t)data.lane<3>())));
-		}
-		else
+		vfloat4 data = float16_to_float(data_f16);
+		store_block_texel(pb, i, data, data_min, data_max, grayscale);
+	}
+
+	// Store block metadata
+	pb->data_min = data_min;
+	pb->data_max = data_max;
+	pb->grayscale = grayscale;
+}
+
+/**
+ * @brief Load a single unswizzled U8 texel, normalized to the 0-1 range.
+ */
+static inline vfloat4 load_texel(
+	const uint8_t* data
+) {
+	return int_to_float(vint4(data)) / 255.0f;
+}
+
+/**
+ * @brief Load a single unswizzled F16 texel, clamped to be positive.
+ */
+static inline vfloat4 load_texel(
+	const uint16_t* data
+) {
+	vint4 texel(data[0], data[1], data[2], data[3]);
+	return max(float16_to_float(texel), 1e-8f);
+}
+
+/**
+ * @brief Load a single unswizzled F32 texel, clamped to be positive.
+ */
+static inline vfloat4 load_texel(
+	const float* data
+) {
+	return max(vfloat4(data), 1e-8f);
+}
+
+/**
+ * @brief Load the channels of a texel, synthesizing any missing channels.
+ *
+ * Missing color channels are loaded as the ZERO swizzle, and missing alpha as
+ * the ONE swizzle.
+ *
+ * @param      src          The texel data in the image.
+ * @param      components   The number of channels in the image.
+ * @param[out] dst          The swizzle source array; entries for the ZERO and
+ *                          ONE swizzles must already be populated.
+ */
+template <typename T>
+static inline void load_components(
+	const T* src,
+	int components,
+	T* dst
+) {
+	dst[ASTCENC_SWZ_R] = src[0];
+	dst[ASTCENC_SWZ_G] = components > 1 ? src[1] : dst[ASTCENC_SWZ_0];
+	dst[ASTCENC_SWZ_B] = components > 2 ? src[2] : dst[ASTCENC_SWZ_0];
+	dst[ASTCENC_SWZ_A] = components > 3 ? src[3] : dst[ASTCENC_SWZ_1];
+}
+
+/**
+ * @brief Load a single unswizzled texel from an image with any channel count.
+ *
+ * @param data         The texel data in the image.
+ * @param components   The number of channels in the image.
+ * @param one          The value of the ONE swizzle for the image data type.
+ */
+template <typename T>
+static inline vfloat4 load_texel(
+	const T* data,
+	int components,
+	T one
+) {
+	if (components == 4)
+	{
+		return load_texel(data);
+	}
+
+	T texel[6] { 0, 0, 0, 0, 0, one };
+	load_components(data, components, texel);
+	return load_texel(texel);
+}
+
+/**
+ * @brief Fetch an imageblock from an image which needs no swizzle.
+ *
+ * This path avoids all per-texel swizzle handling, and for LDR profiles also
+ * fuses the conversion to the working 0-65535 range with the computation of
+ * the block metadata, so the texels are only traversed once.
+ *
+ * @param decode_mode   The compression color profile.
+ * @param img           The input image.
+ * @param[out] pb       The imageblock to populate.
+ * @param bsd           The block size descriptor.
+ * @param xpos          The block x coordinate in the image.
+ * @param ypos          The block y coordinate in the image.
+ * @param zpos          The block z coordinate in the image.
+ * @param one           The value of the ONE swizzle for the image data type.
+ */
+template <typename T>
+static void fetch_imageblock_unswizzled(
+	astcenc_profile decode_mode,
+	const astcenc_image& img,
+	imageblock* pb,
+	const block_size_descriptor* bsd,
+	int xpos,
+	int ypos,
+	int zpos,
+	T one
+) {
+	int xsize = img.dim_x;
+	int ysize = img.dim_y;
+	int zsize = img.dim_z;
+	int components = get_image_components(img);
+
+	int idx = 0;
+	for (int z = 0; z < bsd->zdim; z++)
+	{
+		int zi = astc::min(zpos + z, zsize - 1);
+
+		for (int y = 0; y < bsd->ydim; y++)
 		{
-			data.set_lane<3>(sf16_to_float(unorm16_to_sf16((uint16_t)data.lane<3>())));
+			int yi = astc::min(ypos + y, ysize - 1);
+			const T* row = get_image_row<const T>(img, yi, zi);
+
+			for (int x = 0; x < bsd->xdim; x++)
+			{
+				int xi = astc::min(xpos + x, xsize - 1);
+				vfloat4 texel = load_texel(row + components * xi, components, one);
+
+				pb->data_r[idx] = texel.lane<0>();
+				pb->data_g[idx] = texel.lane<1>();
+				pb->data_b[idx] = texel.lane<2>();
+				pb->data_a[idx] = texel.lane<3>();
+				idx++;
+			}
 		}
+	}
+
+	int texel_count = bsd->texel_count;
+	int rgb_lns = (decode_mode == ASTCENC_PRF_HDR) || (decode_mode == ASTCENC_PRF_HDR_RGB_LDR_A);
+	int alpha_lns = decode_mode == ASTCENC_PRF_HDR;
+
+	std::memset(pb->rgb_lns, rgb_lns, texel_count);
+	std::memset(pb->alpha_lns, alpha_lns, texel_count);
+	std::memset(pb->nan_texel, 0, texel_count);
+
+	if (rgb_lns || alpha_lns)
+	{
+		imageblock_initialize_work_from_orig(pb, texel_count);
+		return;
+	}
+
+	pb->origin_texel = pb->texel(0);
+
+	vfloat4 data_min(1e38f);
+	vfloat4 data_max(-1e38f);
+	unsigned int grayscale = 0xF;
+
+	for (int i = 0; i < texel_count; i++)
+	{
+		vfloat4 data = pb->texel(i) * 65535.0f;
 
-		// Compute block metadata
 		data_min = min(data_min, data);
 		data_max = max(data_max, data);
+		grayscale &= mask(data.swz<0, 0, 0, 0>() == data.swz<1, 2, 0, 0>());
 
-		if (grayscale && (data.lane<0>() != data.lane<1>() || data.lane<0>() != data.lane<2>()))
-		{
-			grayscale = false;
-		}
-
-		// Store block data
 		pb->data_r[i] = data.lane<0>();
 		pb->data_g[i] = data.lane<1>();
 		pb->data_b[i] = data.lane<2>();
 		pb->data_a[i] = data.lane<3>();
 	}
 
-	// Store block metadata
 	pb->data_min = data_min;
 	pb->data_max = data_max;
-	pb->grayscale = grayscale;
+	pb->grayscale = grayscale == 0xF;
 }
 
 // fetch an imageblock from the input file.
@@ -305,6 +462,7 @@ void fetch_imageblock(
 	int xsize = img.dim_x;
 	int ysize = img.dim_y;
 	int zsize = img.dim_z;
+	int components = get_image_components(img);
 
 	pb->xpos = xpos;
 	pb->ypos = ypos;
@@ -314,6 +472,24 @@ void fetch_imageblock(
 	bool needs_swz = (swz.r != ASTCENC_SWZ_R) || (swz.g != ASTCENC_SWZ_G) ||
 	                 (swz.b != ASTCENC_SWZ_B) || (swz.a != ASTCENC_SWZ_A);
 
+	if (!needs_swz)
+	{
+		if (img.data_type == ASTCENC_TYPE_U8)
+		{
+			fetch_imageblock_unswizzled<uint8_t>(decode_mode, img, pb, bsd, xpos, ypos, zpos, 0xFF);
+		}
+		else if (img.data_type == ASTCENC_TYPE_F16)
+		{
+			fetch_imageblock_unswizzled<uint16_t>(decode_mode, img, pb, bsd, xpos, ypos, zpos, 0x3C00);
+		}
+		else
+		{
+			assert(img.data_type == ASTCENC_TYPE_F32);
+			fetch_imageblock_unswizzled<float>(decode_mode, img, pb, bsd, xpos, ypos, zpos, 1.0f);
+		}
+		return;
+	}
+
 	int idx = 0;
 	if (img.data_type == ASTCENC_TYPE_U8)
 	{
@@ -324,33 +500,21 @@ void fetch_imageblock(
 		for (int z = 0; z < bsd->zdim; z++)
 		{
 			int zi = astc::min(zpos + z, zsize - 1);
-			uint8_t* data8 = static_cast<uint8_t*>(img.data[zi]);
 
 			for (int y = 0; y < bsd->ydim; y++)
 			{
 				int yi = astc::min(ypos + y, ysize - 1);
+				const uint8_t* data8 = get_image_row<const uint8_t>(img, yi, zi);
 
 				for (int x = 0; x < bsd->xdim; x++)
 				{
 					int xi = astc::min(xpos + x, xsize - 1);
+					load_components(data8 + components * xi, components, data);
 
-					int r = data8[(4 * xsize * yi) + (4 * xi    )];
-					int g = data8[(4 * xsize * yi) + (4 * xi + 1)];
-					int b = data8[(4 * xsize * yi) + (4 * xi + 2)];
-					int a = data8[(4 * xsize * yi) + (4 * xi + 3)];
-
-					if (needs_swz)
-					{
-						data[ASTCENC_SWZ_R] = r;
-						data[ASTCENC_SWZ_G] = g;
-						data[ASTCENC_SWZ_B] = b;
-						data[ASTCENC_SWZ_A] = a;
-
-						r = data[swz.r];
-						g = data[swz.g];
-						b = data[swz.b];
-						a = data[swz.a];
-					}
+					int r = data[swz.r];
+					int g = data[swz.g];
+					int b = data[swz.b];
+					int a = data[swz.a];
 
 					pb->data_r[idx] = static_cast<float>(r) / 255.0f;
 					pb->data_g[idx] = static_cast<float>(g) / 255.0f;
@@ -370,38 +534,24 @@ void fetch_imageblock(
 		for (int z = 0; z < bsd->zdim; z++)
 		{
 			int zi = astc::min(zpos + z, zsize - 1);
-			uint16_t* data16 = static_cast<uint16_t*>(img.data[zi]);
 
 			for (int y = 0; y < bsd->ydim; y++)
 			{
 				int yi = astc::min(ypos + y, ysize - 1);
+				const uint16_t* data16 = get_image_row<const uint16_t>(img, yi, zi);
 
 				for (int x = 0; x < bsd->xdim; x++)
 				{
 					int xi = astc::min(xpos + x, xsize - 1);
+					load_components(data16 + components * xi, components, data);
 
-					int r = data16[(4 * xsize * yi) + (4 * xi    )];
-					int g = data16[(4 * xsize * yi) + (4 * xi + 1)];
-					int b = data16[(4 * xsize * yi) + (4 * xi + 2)];
-					int a = data16[(4 * xsize * yi) + (4 * xi + 3)];
-
-					if (needs_swz)
-					{
-						data[ASTCENC_SWZ_R] = r;
-						data[ASTCENC_SWZ_G] = g;
-						data[ASTCENC_SWZ_B] = b;
-						data[ASTCENC_SWZ_A] = a;
-
-						r = data[swz.r];
-						g = data[swz.g];
-						b = data[swz.b];
-						a = data[swz.a];
-					}
+					vint4 texel(data[swz.r], data[swz.g], data[swz.b], data[swz.a]);
+					vfloat4 datav = max(float16_to_float(texel), 1e-8f);
 
-					pb->data_r[idx] = astc::max(sf16_to_float(r), 1e-8f);
-					pb->data_g[idx] = astc::max(sf16_to_float(g), 1e-8f);
-					pb->data_b[idx] = astc::max(sf16_to_float(b), 1e-8f);
-					pb->data_a[idx] = astc::max(sf16_to_float(a), 1e-8f);
+					pb->data_r[idx] = datav.lane<0>();
+					pb->data_g[idx] = datav.lane<1>();
+					pb->data_b[idx] = datav.lane<2>();
+					pb->data_a[idx] = datav.lane<3>();
 					idx++;
 				}
 			}
@@ -418,33 +568,21 @@ void fetch_imageblock(
 		for (int z = 0; z < bsd->zdim; z++)
 		{
 			int zi = astc::min(zpos + z, zsize - 1);
-			float* data32 = static_cast<float*>(img.data[zi]);
 
 			for (int y = 0; y < bsd->ydim; y++)
 			{
 				int yi = astc::min(ypos + y, ysize - 1);
+				const float* data32 = get_image_row<const float>(img, yi, zi);
 
 				for (int x = 0; x < bsd->xdim; x++)
 				{
 					int xi = astc::min(xpos + x, xsize - 1);
+					load_components(data32 + components * xi, components, data);
 
-					float r = data32[(4 * xsize * yi) + (4 * xi    )];
-					float g = data32[(4 * xsize * yi) + (4 * xi + 1)];
-					float b = data32[(4 * xsize * yi) + (4 * xi + 2)];
-					float a = data32[(4 * xsize * yi) + (4 * xi + 3)];
-
-					if (needs_swz)
-					{
-						data[ASTCENC_SWZ_R] = r;
-						data[ASTCENC_SWZ_G] = g;
-						data[ASTCENC_SWZ_B] = b;
-						data[ASTCENC_SWZ_A] = a;
-
-						r = data[swz.r];
-						g = data[swz.g];
-						b = data[swz.b];
-						a = data[swz.a];
-					}
+					float r = data[swz.r];
+					float g = data[swz.g];
+					float b = data[swz.b];
+					float a = data[swz.a];
 
 					pb->data_r[idx] = astc::max(r, 1e-8f);
 					pb->data_g[idx] = astc::max(g, 1e-8f);
@@ -470,6 +608,257 @@ void fetch_imageblock(
 	imageblock_initialize_work_from_orig(pb, bsd->texel_count);
 }
 
+/**
+ * @brief Get the range class of a block from an image of type @c T.
+ *
+ * @param img    The input image.
+ * @param bsd    The block size descriptor.
+ * @param xpos   The block x coordinate in the image.
+ * @param ypos   The block y coordinate in the image.
+ * @param zpos   The block z coordinate in the image.
+ * @param one    The value of the ONE swizzle for the image data type.
+ *
+ * @return The block range class.
+ */
+template <typename T>
+static unsigned int get_block_range_class(
+	const astcenc_image& img,
+	const block_size_descriptor& bsd,
+	int xpos,
+	int ypos,
+	int zpos,
+	T one
+) {
+	int xsize = img.dim_x;
+	int ysize = img.dim_y;
+	int zsize = img.dim_z;
+	int components = get_image_components(img);
+
+	vfloat4 data_min(1e38f);
+	vfloat4 data_max(-1e38f);
+
+	for (int z = 0; z < bsd.zdim; z++)
+	{
+		int zi = astc::min(zpos + z, zsize - 1);
+
+		for (int y = 0; y < bsd.ydim; y++)
+		{
+			int yi = astc::min(ypos + y, ysize - 1);
+			const T* row = get_image_row<const T>(img, yi, zi);
+
+			for (int x = 0; x < bsd.xdim; x++)
+			{
+				int xi = astc::min(xpos + x, xsize - 1);
+				vfloat4 texel = load_texel(row + components * xi, components, one);
+				data_min = min(data_min, texel);
+				data_max = max(data_max, texel);
+			}
+		}
+	}
+
+	float range = hmax_s(data_max - data_min);
+	if (range == 0.0f)
+	{
+		return 0;
+	}
+
+	// Count the significant bits of the range as an 8-bit UNORM value
+	int range8 = static_cast<int>(astc::min(range * 255.0f + 0.5f, 255.0f));
+	unsigned int range_class = 1;
+	while (range8 > 1)
+	{
+		range8 >>= 1;
+		range_class++;
+	}
+
+	return range_class;
+}
+
+/* See header for documentation. */
+unsigned int get_block_range_class(
+	const astcenc_image& img,
+	const block_size_descriptor& bsd,
+	int xpos,
+	int ypos,
+	int zpos
+) {
+	if (img.data_type == ASTCENC_TYPE_U8)
+	{
+		return get_block_range_class<uint8_t>(img, bsd, xpos, ypos, zpos, 0xFF);
+	}
+	else if (img.data_type == ASTCENC_TYPE_F16)
+	{
+		return get_block_range_class<uint16_t>(img, bsd, xpos, ypos, zpos, 0x3C00);
+	}
+	else
+	{
+		return get_block_range_class<float>(img, bsd, xpos, ypos, zpos, 1.0f);
+	}
+}
+
+/**
+ * @brief Store a single unswizzled texel as U8 data.
+ */
+static inline void store_texel(
+	vfloat4 texel,
+	bool is_nan,
+	uint8_t* data
+) {
+	// Matches astc::flt2int_rtn(), which does not round ties to even
+	vint4 color = float_to_int((min(texel, 1.0f) * 255.0f) + vfloat4(0.5f));
+
+	// NaN-pixel, but we can't display it. Display purple instead.
+	vint4 purple(0xFF, 0x00, 0xFF, 0xFF);
+	vmask4 nan_mask = vint4(is_nan) != vint4::zero();
+	color = select(color, purple, nan_mask);
+
+	store_nbytes(pack_low_bytes(color), data);
+}
+
+/**
+ * @brief Store a single unswizzled texel as F16 data.
+ */
+static inline void store_texel(
+	vfloat4 texel,
+	bool is_nan,
+	uint16_t* data
+) {
+	if (is_nan)
+	{
+		data[0] = 0xFFFF;
+		data[1] = 0xFFFF;
+		data[2] = 0xFFFF;
+		data[3] = 0xFFFF;
+		return;
+	}
+
+	vint4 texel_f16 = float_to_float16(texel);
+	data[0] = static_cast<uint16_t>(texel_f16.lane<0>());
+	data[1] = static_cast<uint16_t>(texel_f16.lane<1>());
+	data[2] = static_cast<uint16_t>(texel_f16.lane<2>());
+	data[3] = static_cast<uint16_t>(texel_f16.lane<3>());
+}
+
+/**
+ * @brief Store a single unswizzled texel as F32 data.
+ */
+static inline void store_texel(
+	vfloat4 texel,
+	bool is_nan,
+	float* data
+) {
+	vmask4 nan_mask = vint4(is_nan) != vint4::zero();
+	texel = select(texel, vfloat4(std::numeric_limits<float>::quiet_NaN()), nan_mask);
+	store(texel, data);
+}
+
+/**
+ * @brief Store a single unswizzled texel to an image with any channel count.
+ *
+ * Channels which the image does not store are discarded.
+ */
+template <typename T>
+static inline void store_texel(
+	vfloat4 texel,
+	bool is_nan,
+	int components,
+	T* data
+) {
+	if (components == 4)
+	{
+		store_texel(texel, is_nan, data);
+		return;
+	}
+
+	T channels[4];
+	store_texel(texel, is_nan, channels);
+	for (int i = 0; i < components; i++)
+	{
+		data[i] = channels[i];
+	}
+}
+
+/**
+ * @brief Store the channels of a texel, discarding channels the image does not store.
+ */
+template <typename T>
+static inline void store_components(
+	T* dst,
+	int components,
+	T r,
+	T g,
+	T b,
+	T a
+) {
+	dst[0] = r;
+	if (components > 1)
+	{
+		dst[1] = g;
+	}
+
+	if (components > 2)
+	{
+		dst[2] = b;
+	}
+
+	if (components > 3)
+	{
+		dst[3] = a;
+	}
+}
+
+/**
+ * @brief Write an imageblock to an image which needs no swizzle.
+ *
+ * The image bounds are resolved once per row, so the inner loop has no
+ * per-texel bounds or swizzle tests.
+ *
+ * @param[out] img   The output image.
+ * @param pb         The imageblock to write.
+ * @param bsd        The block size descriptor.
+ * @param xpos       The block x coordinate in the image.
+ * @param ypos       The block y coordinate in the image.
+ * @param zpos       The block z coordinate in the image.
+ */
+template <typename T>
+static void write_imageblock_unswizzled(
+	astcenc_image& img,
+	const imageblock* pb,
+	const block_size_descriptor* bsd,
+	int xpos,
+	int ypos,
+	int zpos
+) {
+	int xsize = img.dim_x;
+	int ysize = img.dim_y;
+	int zsize = img.dim_z;
+	int components = get_image_components(img);
+
+	// Blocks may overlap any image edge when decoding a region
+	int x_start = astc::max(0, -xpos);
+	int y_start = astc::max(0, -ypos);
+	int z_start = astc::max(0, -zpos);
+
+	int x_count = astc::min(bsd->xdim, xsize - xpos);
+	int y_count = astc::min(bsd->ydim, ysize - ypos);
+	int z_count = astc::min(bsd->zdim, zsize - zpos);
+
+	for (int z = z_start; z < z_count; z++)
+	{
+		for (int y = y_start; y < y_count; y++)
+		{
+			T* row = get_image_row<T>(img, ypos + y, zpos + z) + components * (xpos + x_start);
+			int idx = (z * bsd->ydim + y) * bsd->xdim;
+
+			for (int x = x_start; x < x_count; x++)
+			{
+				store_texel(pb->texel(idx + x), pb->nan_texel[idx + x] != 0, components,
+				            row + components * (x - x_start));
+			}
+		}
+	}
+}
+
 void write_imageblock(
 	astcenc_image& img,
 	const imageblock* pb,	// picture-block to initialize with image data. We assume that orig_data is valid.
@@ -484,6 +873,7 @@ void write_imageblock(
 	int xsize = img.dim_x;
 	int ysize = img.dim_y;
 	int zsize = img.dim_z;
+	int components = get_image_components(img);
 
 	float data[7];
 	data[ASTCENC_SWZ_0] = 0.0f;
@@ -497,16 +887,36 @@ void write_imageblock(
 	bool needs_z = (swz.r == ASTCENC_SWZ_Z) || (swz.g == ASTCENC_SWZ_Z) ||
 	               (swz.b == ASTCENC_SWZ_Z) || (swz.a == ASTCENC_SWZ_Z);
 
+	if (!needs_swz)
+	{
+		if (img.data_type == ASTCENC_TYPE_U8)
+		{
+			write_imageblock_unswizzled<uint8_t>(img, pb, bsd, xpos, ypos, zpos);
+		}
+		else if (img.data_type == ASTCENC_TYPE_F16)
+		{
+			write_imageblock_unswizzled<uint16_t>(img, pb, bsd, xpos, ypos, zpos);
+		}
+		else
+		{
+			assert(img.data_type == ASTCENC_TYPE_F32);
+			write_imageblock_unswizzled<float>(img, pb, bsd, xpos, ypos, zpos);
+		}
+		return;
+	}
+
 	int idx = 0;
 	if (img.data_type == ASTCENC_TYPE_U8)
 	{
 		for (int z = 0; z < bsd->zdim; z++)
 		{
-			int zc = astc::min(zpos + z, zsize - 1);
-			uint8_t* data8 = static_cast<uint8_t*>(img.data[zc]);
+			int zc = astc::clamp(zpos + z, 0, zsize - 1);
 
 			for (int y = 0; y < bsd->ydim; y++)
 			{
+				int yc = astc::clamp(ypos + y, 0, ysize - 1);
+				uint8_t* data8 = get_image_row<uint8_t>(img, yc, zc);
+
 				for (int x = 0; x < bsd->xdim; x++)
 				{
 					int xi = xpos + x;
@@ -525,7 +935,7 @@ void write_imageblock(
 							bi = 0xFF;
 							ai = 0xFF;
 						}
-						else if (needs_swz)
+						else
 						{
 							data[ASTCENC_SWZ_R] = pb->data_r[idx];
 							data[ASTCENC_SWZ_G] = pb->data_g[idx];
@@ -549,18 +959,8 @@ void write_imageblock(
 							bi = astc::flt2int_rtn(astc::min(data[swz.b], 1.0f) * 255.0f);
 							ai = astc::flt2int_rtn(astc::min(data[swz.a], 1.0f) * 255.0f);
 						}
-						else
-						{
-							ri = astc::flt2int_rtn(astc::min(pb->data_r[idx], 1.0f) * 255.0f);
-							gi = astc::flt2int_rtn(astc::min(pb->data_g[idx], 1.0f) * 255.0f);
-							bi = astc::flt2int_rtn(astc::min(pb->data_b[idx], 1.0f) * 255.0f);
-							ai = astc::flt2int_rtn(astc::min(pb->data_a[idx], 1.0f) * 255.0f);
-						}
 
-						data8[(4 * xsize * yi) + (4 * xi    )] = ri;
-						data8[(4 * xsize * yi) + (4 * xi + 1)] = gi;
-						data8[(4 * xsize * yi) + (4 * xi + 2)] = bi;
-						data8[(4 * xsize * yi) + (4 * xi + 3)] = ai;
+						store_components<uint8_t>(data8 + components * xi, components, ri, gi, bi, ai);
 					}
 					idx++;
 					nptr++;
@@ -572,11 +972,13 @@ void write_imageblock(
 	{
 		for (int z = 0; z < bsd->zdim; z++)
 		{
-			int zc = astc::min(zpos + z, zsize - 1);
-			uint16_t* data16 = static_cast<uint16_t*>(img.data[zc]);
+			int zc = astc::clamp(zpos + z, 0, zsize - 1);
 
 			for (int y = 0; y < bsd->ydim; y++)
 			{
+				int yc = astc::clamp(ypos + y, 0, ysize - 1);
+				uint16_t* data16 = get_image_row<uint16_t>(img, yc, zc);
+
 				for (int x = 0; x < bsd->xdim; x++)
 				{
 					int xi = xpos + x;
@@ -594,7 +996,7 @@ void write_imageblock(
 							bi = 0xFFFF;
 							ai = 0xFFFF;
 						}
-						else if (needs_swz)
+						else
 						{
 							data[ASTCENC_SWZ_R] = pb->data_r[idx];
 							data[ASTCENC_SWZ_G] = pb->data_g[idx];
@@ -613,23 +1015,15 @@ void write_imageblock(
 								data[ASTCENC_SWZ_Z] = (astc::sqrt(zN) * 0.5f) + 0.5f;
 							}
 
-							ri = float_to_sf16(data[swz.r], SF_NEARESTEVEN);
-							gi = float_to_sf16(data[swz.g], SF_NEARESTEVEN);
-							bi = float_to_sf16(data[swz.b], SF_NEARESTEVEN);
-							ai = float_to_sf16(data[swz.a], SF_NEARESTEVEN);
-						}
-						else
-						{
-							ri = float_to_sf16(pb->data_r[idx], SF_NEARESTEVEN);
-							gi = float_to_sf16(pb->data_g[idx], SF_NEARESTEVEN);
-							bi = float_to_sf16(pb->data_b[idx], SF_NEARESTEVEN);
-							ai = float_to_sf16(pb->data_a[idx], SF_NEARESTEVEN);
+							vfloat4 texel(data[swz.r], data[swz.g], data[swz.b], data[swz.a]);
+							vint4 texel_f16 = float_to_float16(texel);
+							ri = texel_f16.lane<0>();
+							gi = texel_f16.lane<1>();
+							bi = texel_f16.lane<2>();
+							ai = texel_f16.lane<3>();
 						}
 
-						data16[(4 * xsize * yi) + (4 * xi    )] = ri;
-						data16[(4 * xsize * yi) + (4 * xi + 1)] = gi;
-						data16[(4 * xsize * yi) + (4 * xi + 2)] = bi;
-						data16[(4 * xsize * yi) + (4 * xi + 3)] = ai;
+						store_components<uint16_t>(data16 + components * xi, components, ri, gi, bi, ai);
 					}
 					idx++;
 					nptr++;
@@ -643,11 +1037,13 @@ void write_imageblock(
 
 		for (int z = 0; z < bsd->zdim; z++)
 		{
-			int zc = astc::min(zpos + z, zsize - 1);
-			float* data32 = static_cast<float*>(img.data[zc]);
+			int zc = astc::clamp(zpos + z, 0, zsize - 1);
 
 			for (int y = 0; y < bsd->ydim; y++)
 			{
+				int yc = astc::clamp(ypos + y, 0, ysize - 1);
+				float* data32 = get_image_row<float>(img, yc, zc);
+
 				for (int x = 0; x < bsd->xdim; x++)
 				{
 					int xi = xpos + x;
@@ -665,7 +1061,7 @@ void write_imageblock(
 							bf = std::numeric_limits<float>::quiet_NaN();
 							af = std::numeric_limits<float>::quiet_NaN();
 						}
-						else if (needs_swz)
+						else
 						{
 							data[ASTCENC_SWZ_R] = pb->data_r[idx];
 							data[ASTCENC_SWZ_G] = pb->data_g[idx];
@@ -689,18 +1085,8 @@ void write_imageblock(
 							bf = data[swz.b];
 							af = data[swz.a];
 						}
-						else
-						{
-							rf = pb->data_r[idx];
-							gf = pb->data_g[idx];
-							bf = pb->data_b[idx];
-							af = pb->data_a[idx];
-						}
 
-						data32[(4 * xsize * yi) + (4 * xi    )] = rf;
-						data32[(4 * xsize * yi) + (4 * xi + 1)] = gf;
-						data32[(4 * xsize * yi) + (4 * xi + 2)] = bf;
-						data32[(4 * xsize * yi) + (4 * xi + 3)] = af;
+						store_components<float>(data32 + components * xi, components, rf, gf, bf, af);
 					}
 					idx++;
 					nptr++;
@@ -709,3 +1095,5 @@ void write_imageblock(
 		}
 	}
 }
+
+ASTCENC_NAMESPACE_END
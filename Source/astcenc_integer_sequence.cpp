@@ -23,6 +23,8 @@
 
 #include <array>
 
+ASTCENC_NAMESPACE_BEGIN
+
 // unpacked quint triplets <low,middle,high> for each packed-quint value
 static const uint8_t quints_of_integer[128][3] = {
 	{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {3, 0, 0},
@@ -438,42 +440,133 @@ int get_ise_sequence_bitcount(
 	return (entry.scale * items + entry.round) / entry.divisor;
 }
 
-// routine to write up to 8 bits
-static inline void write_bits(
-	int value,
+/**
+ * @brief The cumulative trit-block bit count stored before each trit group element.
+ *
+ * A trit group stores five elements, each followed by a chunk of the packed
+ * 8-bit trit-block value. Element @c i of the group stores trit-block bits
+ * <tt>[trit_bits_before[i], trit_bits_before[i + 1])</tt> after its plain bits.
+ */
+static const uint8_t trit_bits_before[6] { 0, 2, 4, 5, 7, 8 };
+
+/**
+ * @brief The cumulative quint-block bit count stored before each quint group element.
+ *
+ * A quint group stores three elements, each followed by a chunk of the packed
+ * 7-bit quint-block value. Element @c i of the group stores quint-block bits
+ * <tt>[quint_bits_before[i], quint_bits_before[i + 1])</tt> after its plain bits.
+ */
+static const uint8_t quint_bits_before[4] { 0, 3, 5, 7 };
+
+/**
+ * @brief Load a 128-bit physical block as two little-endian 64-bit words.
+ *
+ * @param      data    The 16 byte block.
+ * @param[out] words   The loaded words.
+ */
+static inline void load_block_words(
+	const uint8_t* data,
+	uint64_t words[2]
+) {
+	words[0] = 0;
+	words[1] = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		words[0] |= static_cast<uint64_t>(data[i]) << (8 * i);
+		words[1] |= static_cast<uint64_t>(data[i + 8]) << (8 * i);
+	}
+}
+
+/**
+ * @brief Store two little-endian 64-bit words as a 128-bit physical block.
+ *
+ * @param      words   The words to store.
+ * @param[out] data    The 16 byte block.
+ */
+static inline void store_block_words(
+	const uint64_t words[2],
+	uint8_t* data
+) {
+	for (int i = 0; i < 8; i++)
+	{
+		data[i] = static_cast<uint8_t>(words[0] >> (8 * i));
+		data[i + 8] = static_cast<uint8_t>(words[1] >> (8 * i));
+	}
+}
+
+/**
+ * @brief Read a bit field of up to 63 bits from a 128-bit block.
+ *
+ * Bits past the end of the block read as zero.
+ *
+ * @param bitcount    The number of bits to read.
+ * @param bitoffset   The offset of the first bit to read.
+ * @param words       The block to read from.
+ *
+ * @return The bit field value.
+ */
+static inline uint64_t read_bits(
 	int bitcount,
 	int bitoffset,
-	uint8_t* ptr
+	const uint64_t words[2]
 ) {
-	int mask = (1 << bitcount) - 1;
-	value &= mask;
-	ptr += bitoffset >> 3;
-	bitoffset &= 7;
-	value <<= bitoffset;
-	mask <<= bitoffset;
-	mask = ~mask;
-
-	ptr[0] &= mask;
-	ptr[0] |= value;
-	ptr[1] &= mask >> 8;
-	ptr[1] |= value >> 8;
+	assert(bitcount < 64 && bitoffset < 128);
+
+	uint64_t mask = (static_cast<uint64_t>(1) << bitcount) - 1;
+	int shift = bitoffset & 63;
+
+	uint64_t value;
+	if (bitoffset < 64)
+	{
+		// Double shift of the high word avoids an undefined shift by 64 bits
+		value = (words[0] >> shift) | ((words[1] << 1) << (63 - shift));
+	}
+	else
+	{
+		value = words[1] >> shift;
+	}
+
+	return value & mask;
 }
 
-// routine to read up to 8 bits
-static inline int read_bits(
+/**
+ * @brief Write a bit field of up to 63 bits into a 128-bit block.
+ *
+ * Bits of the field that fall past the end of the block are discarded.
+ *
+ * @param value       The value to write; bits above @c bitcount are ignored.
+ * @param bitcount    The number of bits to write.
+ * @param bitoffset   The offset of the first bit to write.
+ * @param words       The block to write to.
+ */
+static inline void write_bits(
+	uint64_t value,
 	int bitcount,
 	int bitoffset,
-	const uint8_t* ptr
+	uint64_t words[2]
 ) {
-	int mask = (1 << bitcount) - 1;
-	ptr += bitoffset >> 3;
-	bitoffset &= 7;
-	int value = ptr[0] | (ptr[1] << 8);
-	value >>= bitoffset;
+	assert(bitcount < 64 && bitoffset < 128);
+
+	uint64_t mask = (static_cast<uint64_t>(1) << bitcount) - 1;
 	value &= mask;
-	return value;
+	int shift = bitoffset & 63;
+
+	if (bitoffset < 64)
+	{
+		words[0] = (words[0] & ~(mask << shift)) | (value << shift);
+
+		// Double shift avoids an undefined shift by 64 bits
+		uint64_t high_mask = (mask >> 1) >> (63 - shift);
+		uint64_t high_value = (value >> 1) >> (63 - shift);
+		words[1] = (words[1] & ~high_mask) | high_value;
+	}
+	else
+	{
+		words[1] = (words[1] & ~(mask << shift)) | (value << shift);
+	}
 }
 
+/* See header for documentation. */
 void encode_ise(
 	int quant_level,
 	int elements,
@@ -486,150 +579,95 @@ void encode_ise(
 	int quints = btq_counts[quant_level].quints;
 	int mask = (1 << bits) - 1;
 
-	// Write out trits and bits
+	uint64_t words[2];
+	load_block_words(output_data, words);
+
+	// Write out trits and bits, one group of up to five elements at a time
 	if (trits)
 	{
-		int i = 0;
-		int full_trit_blocks = elements / 5;
-
-		for (int j = 0; j < full_trit_blocks; j++)
+		for (int i = 0; i < elements; i += 5)
 		{
-			int i4 = input_data[i + 4] >> bits;
-			int i3 = input_data[i + 3] >> bits;
-			int i2 = input_data[i + 2] >> bits;
-			int i1 = input_data[i + 1] >> bits;
-			int i0 = input_data[i + 0] >> bits;
-
-			uint8_t T = integer_of_trits[i4][i3][i2][i1][i0];
-
-			// The max size of a trit bit count is 6, so we can always safely
-			// pack a single MX value with the following 1 or 2 T bits.
-			uint8_t pack;
-
-			// Element 0 + T0 + T1
-			pack = (input_data[i++] & mask) | (((T >> 0) & 0x3) << bits);
-			write_bits(pack, bits + 2, bit_offset, output_data);
-			bit_offset += bits + 2;
-
-			// Element 1 + T2 + T3
-			pack = (input_data[i++] & mask) | (((T >> 2) & 0x3) << bits);
-			write_bits(pack, bits + 2, bit_offset, output_data);
-			bit_offset += bits + 2;
-
-			// Element 2 + T4
-			pack = (input_data[i++] & mask) | (((T >> 4) & 0x1) << bits);
-			write_bits(pack, bits + 1, bit_offset, output_data);
-			bit_offset += bits + 1;
-
-			// Element 3 + T5 + T6
-			pack = (input_data[i++] & mask) | (((T >> 5) & 0x3) << bits);
-			write_bits(pack, bits + 2, bit_offset, output_data);
-			bit_offset += bits + 2;
-
-			// Element 4 + T7
-			pack = (input_data[i++] & mask) | (((T >> 7) & 0x1) << bits);
-			write_bits(pack, bits + 1, bit_offset, output_data);
-			bit_offset += bits + 1;
-		}
-
-		// Loop tail for a partial block
-		if (i != elements)
-		{
-			// i4 cannot be present - we know the block is partial
-			// i0 must be present - we know the block isn't empty
-			int i4 =                         0;
-			int i3 = i + 3 >= elements ? 0 : input_data[i + 3] >> bits;
-			int i2 = i + 2 >= elements ? 0 : input_data[i + 2] >> bits;
-			int i1 = i + 1 >= elements ? 0 : input_data[i + 1] >> bits;
-			int i0 =                         input_data[i + 0] >> bits;
-
-			uint8_t T = integer_of_trits[i4][i3][i2][i1][i0];
-
-			for (int j = 0; i < elements; i++, j++)
+			// Missing elements of a partial group encode as zero
+			int group_elements = astc::min(elements - i, 5);
+			int t[5] { 0, 0, 0, 0, 0 };
+			for (int j = 0; j < group_elements; j++)
 			{
-				// Truncated table as this iteration is always partital
-				static const uint8_t tbits[4]  { 2, 2, 1, 2 };
-				static const uint8_t tshift[4] { 0, 2, 4, 5 };
+				t[j] = input_data[i + j] >> bits;
+			}
 
-				uint8_t pack = (input_data[i] & mask) |
-				               (((T >> tshift[j]) & ((1 << tbits[j]) - 1)) << bits);
+			int T = integer_of_trits[t[4]][t[3]][t[2]][t[1]][t[0]];
 
-				write_bits(pack, bits + tbits[j], bit_offset, output_data);
-				bit_offset += bits + tbits[j];
+			// Interleave the plain bits of each element with its chunk of T
+			uint64_t group = 0;
+			for (int j = 0; j < group_elements; j++)
+			{
+				int pos = j * bits + trit_bits_before[j];
+				int tbits = trit_bits_before[j + 1] - trit_bits_before[j];
+				int tchunk = (T >> trit_bits_before[j]) & ((1 << tbits) - 1);
+				group |= static_cast<uint64_t>(input_data[i + j] & mask) << pos;
+				group |= static_cast<uint64_t>(tchunk) << (pos + bits);
 			}
+
+			int group_bits = group_elements * bits + trit_bits_before[group_elements];
+			write_bits(group, group_bits, bit_offset, words);
+			bit_offset += group_bits;
 		}
 	}
-	// Write out quints and bits
+	// Write out quints and bits, one group of up to three elements at a time
 	else if (quints)
 	{
-		int i = 0;
-		int full_quint_blocks = elements / 3;
-
-		for (int j = 0; j < full_quint_blocks; j++)
-		{
-			int i2 = input_data[i + 2] >> bits;
-			int i1 = input_data[i + 1] >> bits;
-			int i0 = input_data[i + 0] >> bits;
-
-			uint8_t T = integer_of_quints[i2][i1][i0];
-
-			// The max size of a quint bit count is 5, so we can always safely
-			// pack a single M value with the following 2 or 3 T bits.
-			uint8_t pack;
-
-			// Element 0
-			pack = (input_data[i++] & mask) | (((T >> 0) & 0x7) << bits);
-			write_bits(pack, bits + 3, bit_offset, output_data);
-			bit_offset += bits + 3;
-
-			// Element 1
-			pack = (input_data[i++] & mask) | (((T >> 3) & 0x3) << bits);
-			write_bits(pack, bits + 2, bit_offset, output_data);
-			bit_offset += bits + 2;
-
-			// Element 2
-			pack = (input_data[i++] & mask) | (((T >> 5) & 0x3) << bits);
-			write_bits(pack, bits + 2, bit_offset, output_data);
-			bit_offset += bits + 2;
-		}
-
-		// Loop tail for a partial block
-		if (i != elements)
+		for (int i = 0; i < elements; i += 3)
 		{
-			// i2 cannot be present - we know the block is partial
-			// i0 must be present - we know the block isn't empty
-			int i2 =                         0;
-			int i1 = i + 1 >= elements ? 0 : input_data[i + 1] >> bits;
-			int i0 =                         input_data[i + 0] >> bits;
-
-			uint8_t T = integer_of_quints[i2][i1][i0];
-
-			for (int j = 0; i < elements; i++, j++)
+			// Missing elements of a partial group encode as zero
+			int group_elements = astc::min(elements - i, 3);
+			int q[3] { 0, 0, 0 };
+			for (int j = 0; j < group_elements; j++)
 			{
-				// Truncated table as this iteration is always partital
-				static const uint8_t tbits[2]  { 3, 2 };
-				static const uint8_t tshift[2] { 0, 3 };
+				q[j] = input_data[i + j] >> bits;
+			}
 
-				uint8_t pack = (input_data[i] & mask) |
-				               (((T >> tshift[j]) & ((1 << tbits[j]) - 1)) << bits);
+			int Q = integer_of_quints[q[2]][q[1]][q[0]];
 
-				write_bits(pack, bits + tbits[j], bit_offset, output_data);
-				bit_offset += bits + tbits[j];
+			// Interleave the plain bits of each element with its chunk of Q
+			uint64_t group = 0;
+			for (int j = 0; j < group_elements; j++)
+			{
+				int pos = j * bits + quint_bits_before[j];
+				int qbits = quint_bits_before[j + 1] - quint_bits_before[j];
+				int qchunk = (Q >> quint_bits_before[j]) & ((1 << qbits) - 1);
+				group |= static_cast<uint64_t>(input_data[i + j] & mask) << pos;
+				group |= static_cast<uint64_t>(qchunk) << (pos + bits);
 			}
+
+			int group_bits = group_elements * bits + quint_bits_before[group_elements];
+			write_bits(group, group_bits, bit_offset, words);
+			bit_offset += group_bits;
 		}
 	}
-	// Write out just bits
+	// Write out just bits, packing as many elements as fit into each write
 	else
 	{
 		promise(elements > 0);
-		for (int i = 0; i < elements; i++)
+		int group_size = 56 / bits;
+		for (int i = 0; i < elements; i += group_size)
 		{
-			write_bits(input_data[i], bits, bit_offset, output_data);
-			bit_offset += bits;
+			int group_elements = astc::min(elements - i, group_size);
+			uint64_t group = 0;
+			for (int j = 0; j < group_elements; j++)
+			{
+				group |= static_cast<uint64_t>(input_data[i + j] & mask) << (j * bits);
+			}
+
+			int group_bits = group_elements * bits;
+			write_bits(group, group_bits, bit_offset, words);
+			bit_offset += group_bits;
 		}
 	}
+
+	store_block_words(words, output_data);
 }
 
+/* See header for documentation. */
 void decode_ise(
 	int quant_level,
 	int elements,
@@ -637,88 +675,95 @@ void decode_ise(
 	uint8_t* output_data,
 	int bit_offset
 ) {
-	// note: due to how the trit/quint-block unpacking is done in this function,
-	// we may write more temporary results than the number of outputs
-	// The maximum actual number of results is 64 bit, but we keep 4 additional elements
-	// of padding.
-	uint8_t results[68];
-	uint8_t tq_blocks[22];		// trit-blocks or quint-blocks
-
 	int bits = btq_counts[quant_level].bits;
 	int trits = btq_counts[quant_level].trits;
 	int quints = btq_counts[quant_level].quints;
+	uint64_t mask = (1 << bits) - 1;
 
-	int lcounter = 0;
-	int hcounter = 0;
+	uint64_t words[2];
+	load_block_words(input_data, words);
 
-	// trit-blocks or quint-blocks must be zeroed out before we collect them in the loop below.
-	for (int i = 0; i < 22; i++)
-	{
-		tq_blocks[i] = 0;
-	}
-
-	// collect bits for each element, as well as bits for any trit-blocks and quint-blocks.
-	for (int i = 0; i < elements; i++)
+	// Read trits and bits, one group of up to five elements at a time
+	if (trits)
 	{
-		results[i] = read_bits(bits, bit_offset, input_data);
-		bit_offset += bits;
-
-		if (trits)
+		for (int i = 0; i < elements; i += 5)
 		{
-			static const int bits_to_read[5]  { 2, 2, 1, 2, 1 };
-			static const int block_shift[5]   { 0, 2, 4, 5, 7 };
-			static const int next_lcounter[5] { 1, 2, 3, 4, 0 };
-			static const int hcounter_incr[5] { 0, 0, 0, 0, 1 };
-			int tdata = read_bits(bits_to_read[lcounter], bit_offset, input_data);
-			bit_offset += bits_to_read[lcounter];
-			tq_blocks[hcounter] |= tdata << block_shift[lcounter];
-			hcounter += hcounter_incr[lcounter];
-			lcounter = next_lcounter[lcounter];
-		}
+			// Trit-block bits of missing elements of a partial group are zero,
+			// which the read provides as it only returns the group's own bits
+			int group_elements = astc::min(elements - i, 5);
+			int group_bits = group_elements * bits + trit_bits_before[group_elements];
+			uint64_t group = read_bits(group_bits, bit_offset, words);
+			bit_offset += group_bits;
+
+			// Gather the chunks of T that follow the plain bits of each element
+			int T = 0;
+			for (int j = 0; j < 5; j++)
+			{
+				int pos = j * bits + trit_bits_before[j];
+				int tbits = trit_bits_before[j + 1] - trit_bits_before[j];
+				int tchunk = static_cast<int>(group >> (pos + bits)) & ((1 << tbits) - 1);
+				T |= tchunk << trit_bits_before[j];
+			}
 
-		if (quints)
-		{
-			static const int bits_to_read[3]  { 3, 2, 2 };
-			static const int block_shift[3]   { 0, 3, 5 };
-			static const int next_lcounter[3] { 1, 2, 0 };
-			static const int hcounter_incr[3] { 0, 0, 1 };
-			int tdata = read_bits(bits_to_read[lcounter], bit_offset, input_data);
-			bit_offset += bits_to_read[lcounter];
-			tq_blocks[hcounter] |= tdata << block_shift[lcounter];
-			hcounter += hcounter_incr[lcounter];
-			lcounter = next_lcounter[lcounter];
+			// Unpack all five trits with a single lookup
+			const uint8_t* tritptr = trits_of_integer[T];
+			for (int j = 0; j < group_elements; j++)
+			{
+				int pos = j * bits + trit_bits_before[j];
+				int value = static_cast<int>((group >> pos) & mask);
+				output_data[i + j] = static_cast<uint8_t>(value | (tritptr[j] << bits));
+			}
 		}
 	}
-
-	// unpack trit-blocks or quint-blocks as needed
-	if (trits)
+	// Read quints and bits, one group of up to three elements at a time
+	else if (quints)
 	{
-		int trit_blocks = (elements + 4) / 5;
-		for (int i = 0; i < trit_blocks; i++)
+		for (int i = 0; i < elements; i += 3)
 		{
-			const uint8_t *tritptr = trits_of_integer[tq_blocks[i]];
-			results[5 * i    ] |= tritptr[0] << bits;
-			results[5 * i + 1] |= tritptr[1] << bits;
-			results[5 * i + 2] |= tritptr[2] << bits;
-			results[5 * i + 3] |= tritptr[3] << bits;
-			results[5 * i + 4] |= tritptr[4] << bits;
+			// Quint-block bits of missing elements of a partial group are zero,
+			// which the read provides as it only returns the group's own bits
+			int group_elements = astc::min(elements - i, 3);
+			int group_bits = group_elements * bits + quint_bits_before[group_elements];
+			uint64_t group = read_bits(group_bits, bit_offset, words);
+			bit_offset += group_bits;
+
+			// Gather the chunks of Q that follow the plain bits of each element
+			int Q = 0;
+			for (int j = 0; j < 3; j++)
+			{
+				int pos = j * bits + quint_bits_before[j];
+				int qbits = quint_bits_before[j + 1] - quint_bits_before[j];
+				int qchunk = static_cast<int>(group >> (pos + bits)) & ((1 << qbits) - 1);
+				Q |= qchunk << quint_bits_before[j];
+			}
+
+			// Unpack all three quints with a single lookup
+			const uint8_t* quintptr = quints_of_integer[Q];
+			for (int j = 0; j < group_elements; j++)
+			{
+				int pos = j * bits + quint_bits_before[j];
+				int value = static_cast<int>((group >> pos) & mask);
+				output_data[i + j] = static_cast<uint8_t>(value | (quintptr[j] << bits));
+			}
 		}
 	}
-
-	if (quints)
+	// Read just bits, unpacking as many elements as fit into each read
+	else
 	{
-		int quint_blocks = (elements + 2) / 3;
-		for (int i = 0; i < quint_blocks; i++)
+		int group_size = 56 / bits;
+		for (int i = 0; i < elements; i += group_size)
 		{
-			const uint8_t *quintptr = quints_of_integer[tq_blocks[i]];
-			results[3 * i    ] |= quintptr[0] << bits;
-			results[3 * i + 1] |= quintptr[1] << bits;
-			results[3 * i + 2] |= quintptr[2] << bits;
-		}
-	}
+			int group_elements = astc::min(elements - i, group_size);
+			int group_bits = group_elements * bits;
+			uint64_t group = read_bits(group_bits, bit_offset, words);
+			bit_offset += group_bits;
 
-	for (int i = 0; i < elements; i++)
-	{
-		output_data[i] = results[i];
+			for (int j = 0; j < group_elements; j++)
+			{
+				output_data[i + j] = static_cast<uint8_t>((group >> (j * bits)) & mask);
+			}
+		}
 	}
 }
+
+ASTCENC_NAMESPACE_END
@@ -23,6 +23,8 @@
 #define ASTCENC_INTERNAL_INCLUDED
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
@@ -36,6 +38,8 @@
 #include "astcenc_mathlib.h"
 #include "astcenc_vecmathlib.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 /**
  * @brief Make a promise to the compiler's optimizer.
  *
@@ -80,6 +84,9 @@
   Constants
 ============================================================================ */
 #define MAX_TEXELS_PER_BLOCK 216
+// Texel count rounded up so that each row of a 2D per-texel array stays aligned
+// for the widest (16 lane) SIMD vector
+#define MAX_TEXELS_PER_BLOCK_PADDED 224
 #define MAX_KMEANS_TEXELS 64
 #define MAX_WEIGHTS_PER_BLOCK 64
 #define PLANE2_WEIGHTS_OFFSET (MAX_WEIGHTS_PER_BLOCK/2)
@@ -107,6 +114,14 @@ static const unsigned int TUNE_MAX_TEXELS_MODE0_FASTPATH { 24 };
 // Default: depends on quality preset
 static const unsigned int TUNE_MAX_TRIAL_CANDIDATES { 4 };
 
+// The number of previous blocks in the same row which are tested as sources
+// of reusable encodings when using rate-distortion optimization.
+static const unsigned int TUNE_RDO_WINDOW { 8 };
+
+// The maximum number of weight realignment passes used to fit the weights of
+// a block to endpoints reused from a neighbor.
+static const int TUNE_RDO_REALIGN_LIMIT { 4 };
+
 /* ============================================================================
   Other configuration parameters
 ============================================================================ */
@@ -136,6 +151,13 @@ static const unsigned int TUNE_MAX_TRIAL_CANDIDATES { 4 };
  * task tickets are just counters; the caller must map these integers to an
  * actual processing partition in a specific problem domain.
  *
+ * Task assignment and completion are lock-free atomic counter updates, so the
+ * processing stage never takes the lock. The assigned granule is adaptive;
+ * threads are given up to the requested granule while plenty of work remains,
+ * shrinking down to single tasks toward the tail of the stage to keep threads
+ * load balanced as the stage drains. Only the thread completing the final task
+ * of the stage touches the lock and condition variable to wake any waiters.
+ *
  * The exit wait condition is needed to ensure processing has finished before
  * a worker thread can progress to the next stage of the pipeline. Specifically
  * a worker may exit the processing stage because there are no new tasks to
@@ -181,6 +203,14 @@ static const unsigned int TUNE_MAX_TRIAL_CANDIDATES { 4 };
 class ParallelManager
 {
 private:
+	/**
+	 * @brief The tail divisor for adaptive granule sizing.
+	 *
+	 * Assignments are limited to 1/Nth of the remaining tasks, so assignment
+	 * sizes shrink toward a single task as the stage nears completion.
+	 */
+	static const unsigned int TAIL_DIVISOR = 64;
+
 	/** @brief Lock used for critical section and condition synchronization. */
 	std::mutex m_lock;
 
@@ -194,10 +224,10 @@ private:
 	std::condition_variable m_complete;
 
 	/** @brief Number of tasks started, but not necessarily finished. */
-	unsigned int m_start_count;
+	std::atomic<unsigned int> m_start_count;
 
 	/** @brief Number of tasks finished. */
-	unsigned int m_done_count;
+	std::atomic<unsigned int> m_done_count;
 
 	/** @brief Number of tasks that need to be processed. */
 	unsigned int m_task_count;
@@ -219,8 +249,8 @@ public:
 	{
 		m_init_done = false;
 		m_term_done = false;
-		m_start_count = 0;
-		m_done_count = 0;
+		m_start_count.store(0, std::memory_order_relaxed);
+		m_done_count.store(0, std::memory_order_relaxed);
 		m_task_count = 0;
 	}
 
@@ -266,7 +296,9 @@ public:
 	/**
 	 * @brief Request a task assignment.
 	 *
-	 * Assign up to @c granule tasks to the caller for processing.
+	 * Assign up to @c granule tasks to the caller for processing. Fewer tasks
+	 * will be assigned toward the tail of the stage to improve load balancing.
+	 * The caller must have called init() before calling this function.
 	 *
 	 * @param      granule   Maximum number of tasks that can be assigned.
 	 * @param[out] count     Actual number of tasks assigned, or zero if
@@ -277,10 +309,21 @@ public:
 	 */
 	unsigned int get_task_assignment(unsigned int granule, unsigned int& count)
 	{
-		std::lock_guard<std::mutex> lck(m_lock);
-		unsigned int base = m_start_count;
-		count = std::min(granule, m_task_count - m_start_count);
-		m_start_count += count;
+		// Size the request using a snapshot of the remaining work; this may
+		// be stale by the time we claim tasks, but only granule size depends
+		// on it so this is benign
+		unsigned int start = m_start_count.load(std::memory_order_relaxed);
+		unsigned int remaining = (start < m_task_count) ? m_task_count - start : 0;
+		unsigned int request = astc::max(1u, astc::min(granule, remaining / TAIL_DIVISOR));
+
+		unsigned int base = m_start_count.fetch_add(request, std::memory_order_relaxed);
+		if (base >= m_task_count)
+		{
+			count = 0;
+			return 0;
+		}
+
+		count = astc::min(request, m_task_count - base);
 		return base;
 	}
 
@@ -291,16 +334,35 @@ public:
 	 * on @c wait() if this completes the processing of the stage.
 	 *
 	 * @param count   The number of completed tasks.
+	 *
+	 * @return The number of tasks completed by all threads, including these.
 	 */
-	void complete_task_assignment(unsigned int count)
+	unsigned int complete_task_assignment(unsigned int count)
 	{
-		std::unique_lock<std::mutex> lck(m_lock);
-		this->m_done_count += count;
-		if (m_done_count == m_task_count)
+		unsigned int done = m_done_count.fetch_add(count, std::memory_order_acq_rel) + count;
+		if (done == m_task_count)
 		{
-			lck.unlock();
+			// Take the lock to avoid racing a waiter between it testing the
+			// predicate and it blocking on the condition variable
+			{
+				std::lock_guard<std::mutex> lck(m_lock);
+			}
 			m_complete.notify_all();
 		}
+
+		return done;
+	}
+
+	/**
+	 * @brief Get the number of tasks in the stage.
+	 *
+	 * The caller must have called init() before calling this function.
+	 *
+	 * @return The number of tasks.
+	 */
+	unsigned int get_task_count() const
+	{
+		return m_task_count;
 	}
 
 	/**
@@ -308,8 +370,41 @@ public:
 	 */
 	void wait()
 	{
+		if (m_done_count.load(std::memory_order_acquire) == m_task_count)
+		{
+			return;
+		}
+
 		std::unique_lock<std::mutex> lck(m_lock);
-		m_complete.wait(lck, [this]{ return m_done_count == m_task_count; });
+		m_complete.wait(lck, [this]{
+			return m_done_count.load(std::memory_order_acquire) == m_task_count;
+		});
+	}
+
+	/**
+	 * @brief Get the number of tasks which have not yet been completed.
+	 *
+	 * This is a snapshot which may be stale as soon as it is returned, so it
+	 * is only suitable for use by heuristics such as progress estimation.
+	 *
+	 * @return The number of tasks remaining.
+	 */
+	unsigned int get_remaining_count() const
+	{
+		return m_task_count - m_done_count.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Get the index of the next task which will be assigned.
+	 *
+	 * This is a snapshot which may be stale as soon as it is returned, so it
+	 * is only suitable for use by heuristics such as granule sizing.
+	 *
+	 * @return The next task index, which may be beyond the last task.
+	 */
+	unsigned int get_next_task_index() const
+	{
+		return m_start_count.load(std::memory_order_relaxed);
 	}
 
 	/**
@@ -335,8 +430,9 @@ public:
 
 /*
 	Partition table representation:
-	For each block size, we have 3 tables, each with 1024 partitionings;
-	these three tables correspond to 2, 3 and 4 partitions respectively.
+	For each block size, we have 3 sets of up to 1024 partitionings;
+	these three sets correspond to 2, 3 and 4 partitions respectively.
+	Only unique partitionings are stored, see block_size_descriptor.
 	For each partitioning, we have:
 	* a 4-entry table indicating how many texels there are in each of the 4 partitions.
 	  This may be from 0 to a very large value.
@@ -348,8 +444,9 @@ public:
 struct partition_info
 {
 	int partition_count;
+	uint16_t partition_index;	// the partition index (seed) that generated this partitioning
 	uint8_t texels_per_partition[4];
-	uint8_t partition_of_texel[MAX_TEXELS_PER_BLOCK];
+	uint8_t partition_of_texel[MAX_TEXELS_PER_BLOCK_PADDED];	// padded so vector loops can safely overshoot the texel count
 	uint8_t texels_of_partition[4][MAX_TEXELS_PER_BLOCK];
 	uint64_t coverage_bitmaps[4];
 };
@@ -375,8 +472,8 @@ struct decimation_table
 
 	// The 4t and t4 tables are the same data, but transposed to allow optimal
 	// data access patterns depending on how we can unroll loops
-	alignas(ASTCENC_VECALIGN) float texel_weights_float_4t[4][MAX_TEXELS_PER_BLOCK];	// the weight to assign to each weight
-	alignas(ASTCENC_VECALIGN) uint8_t texel_weights_4t[4][MAX_TEXELS_PER_BLOCK];	// the weights that go into a texel calculation
+	alignas(ASTCENC_VECALIGN) float texel_weights_float_4t[4][MAX_TEXELS_PER_BLOCK_PADDED];	// the weight to assign to each weight
+	alignas(ASTCENC_VECALIGN) uint8_t texel_weights_4t[4][MAX_TEXELS_PER_BLOCK_PADDED];	// the weights that go into a texel calculation
 
 	float texel_weights_float_t4[MAX_TEXELS_PER_BLOCK][4];	// the weight to assign to each weight
 	uint8_t texel_weights_t4[MAX_TEXELS_PER_BLOCK][4];	// the weights that go into a texel calculation
@@ -384,15 +481,20 @@ struct decimation_table
 	uint8_t texel_weights_int_t4[MAX_TEXELS_PER_BLOCK][4];	// the weight to assign to each weight
 
 	uint8_t weight_texel_count[MAX_WEIGHTS_PER_BLOCK];	// the number of texels that a given weight contributes to
-	uint8_t weight_texel[MAX_WEIGHTS_PER_BLOCK][MAX_TEXELS_PER_BLOCK];	// the texels that the weight contributes to
-	uint8_t weights_int[MAX_WEIGHTS_PER_BLOCK][MAX_TEXELS_PER_BLOCK];	// the weights that the weight contributes to a texel.
-	float weights_flt[MAX_WEIGHTS_PER_BLOCK][MAX_TEXELS_PER_BLOCK];	// the weights that the weight contributes to a texel.
+	uint16_t weight_texel_offset[MAX_WEIGHTS_PER_BLOCK];	// the index of the first entry of a given weight in the packed arrays
+
+	// The packed per-weight arrays hold the texel contributions of each weight
+	// in turn, starting at weight_texel_offset[i] for weight_texel_count[i]
+	// entries. They are sized to the actual contribution count, and are stored
+	// in the same allocation directly after the table.
+	uint8_t* weight_texel;	// the texels that the weight contributes to
+	float* weights_flt;	// the weights that the weight contributes to a texel.
 
 	// folded data structures:
-	//  * texel_weights_texel[i][j] = texel_weights[weight_texel[i][j]];
-	//  * texel_weights_float_texel[i][j] = texel_weights_float[weight_texel[i][j]]
-	uint8_t texel_weights_texel[MAX_WEIGHTS_PER_BLOCK][MAX_TEXELS_PER_BLOCK][4];
-	float texel_weights_float_texel[MAX_WEIGHTS_PER_BLOCK][MAX_TEXELS_PER_BLOCK][4];
+	//  * texel_weights_texel[i] = texel_weights_t4[weight_texel[i]];
+	//  * texel_weights_float_texel[i] = texel_weights_float_t4[weight_texel[i]]
+	uint8_t (*texel_weights_texel)[4];
+	float (*texel_weights_float_texel)[4];
 };
 
 /**
@@ -436,11 +538,22 @@ struct decimation_mode
  * block size and set of compressor heuristics, only a subset of the block
  * modes will be used. The actual number of block modes stored is indicated in
  * @c block_mode_count, and the @c block_modes array store the active modes
- * contiguously at the start of the array. These entries are stored in
- * incrementing "packed" value order, which doesn't mean much once unpacked.
- * To allow decompressors to reference the packed data efficiently the
+ * contiguously at the start of the array. These entries are grouped by
+ * decimation mode, then by plane count, and then stored in increasing weight
+ * quantization level order, allowing the compressor to walk each decimation
+ * grid from its cheapest to most precise weight encoding. To allow
+ * decompressors to reference the packed data efficiently the
  * @c block_mode_packed_index array stores the mapping between physical ID and
  * the actual remapped array index.
+ *
+ * The partition tables only store unique partitionings. For each partition
+ * count the partitionings that are worth searching, i.e. that use every
+ * partition and are not a relabeling of an earlier partitioning, are stored
+ * first in increasing partition index order; the number of these is given by
+ * @c partitioning_count. These are followed by the remaining unique
+ * partitionings, which are only used when decompressing. The
+ * @c partitioning_packed_index array stores the mapping between the physical
+ * partition index and the actual remapped array index.
  */
 struct block_size_descriptor
 {
@@ -483,8 +596,48 @@ struct block_size_descriptor
 	/**< The active texels for k-means partition selection. */
 	int kmeans_texels[MAX_KMEANS_TEXELS];
 
-	/**< The partion tables for all of the possible partitions. */
-	partition_info partitions[(3 * PARTITION_COUNT) + 1];
+	/**< The number of searchable partitionings for 1 to 4 partitions. */
+	int partitioning_count[4];
+
+	/**< The first partition table for 1 to 4 partitions. */
+	const partition_info *partitioning_tables[4];
+
+	/**< The partition table array index for 2 to 4 partitions. */
+	uint16_t partitioning_packed_index[3][PARTITION_COUNT];
+
+	/**< The partition tables for all of the unique partitionings. */
+	partition_info *partitions;
+
+	/**
+	 * @brief The k-means coverage bitmaps of the searchable partitionings for
+	 * 2 to 4 partitions, stored in planar form for vectorized scoring.
+	 *
+	 * Each 64-bit bitmap is split into low and high 32-bit words. The plane
+	 * for word @c w of partition @c p starts at index <tt>(2 * p + w) * N</tt>,
+	 * where @c N is the searchable partitioning count rounded up to a multiple
+	 * of the SIMD width. Padding lanes are zero.
+	 */
+	int *partitioning_coverage[3];
+
+	/**
+	 * @brief True if the decimation and partition tables are built on first use.
+	 *
+	 * This is used for decompress-only contexts, which only need the tables
+	 * for the block modes and partition indices that appear in the data. When
+	 * set, @c decimation_tables and all partition tables other than the single
+	 * partition table are not populated, and must be accessed using
+	 * get_decimation_table() and get_partition_info().
+	 */
+	bool lazy_tables;
+
+	/**< The weight grid X, Y, and Z dimensions of each decimation mode. */
+	uint8_t decimation_grid_dims[MAX_DECIMATION_MODES][3];
+
+	/**< The decimation tables built on first use, if @c lazy_tables is set. */
+	mutable std::atomic<const decimation_table*> lazy_decimation_tables[MAX_DECIMATION_MODES];
+
+	/**< The partition tables for 2 to 4 partitions built on first use, if @c lazy_tables is set. */
+	mutable std::atomic<const partition_info*> lazy_partitions[3][PARTITION_COUNT];
 };
 
 // data structure representing one block of an image.
@@ -492,10 +645,11 @@ struct block_size_descriptor
 // on conversions to/from uint8_t (this also allows us to handle HDR textures easily)
 struct imageblock
 {
-	float data_r[MAX_TEXELS_PER_BLOCK];  // the data that we will compress, either linear or LNS (0..65535 in both cases)
-	float data_g[MAX_TEXELS_PER_BLOCK];
-	float data_b[MAX_TEXELS_PER_BLOCK];
-	float data_a[MAX_TEXELS_PER_BLOCK];
+	// The channel arrays are padded so vector loops can safely overshoot the texel count
+	float data_r[MAX_TEXELS_PER_BLOCK_PADDED];  // the data that we will compress, either linear or LNS (0..65535 in both cases)
+	float data_g[MAX_TEXELS_PER_BLOCK_PADDED];
+	float data_b[MAX_TEXELS_PER_BLOCK_PADDED];
+	float data_a[MAX_TEXELS_PER_BLOCK_PADDED];
 
 	vfloat4 origin_texel;
 	vfloat4 data_min;
@@ -572,21 +726,24 @@ void imageblock_initialize_orig_from_work(
 struct error_weight_block
 {
 	vfloat4 error_weights[MAX_TEXELS_PER_BLOCK];
-	float texel_weight[MAX_TEXELS_PER_BLOCK];
+
+	// The texel_weight, texel_weight_rgb, and per-channel arrays are padded so
+	// vector loops can safely overshoot the texel count
+	float texel_weight[MAX_TEXELS_PER_BLOCK_PADDED];
 	float texel_weight_gba[MAX_TEXELS_PER_BLOCK];
 	float texel_weight_rba[MAX_TEXELS_PER_BLOCK];
 	float texel_weight_rga[MAX_TEXELS_PER_BLOCK];
-	float texel_weight_rgb[MAX_TEXELS_PER_BLOCK];
+	float texel_weight_rgb[MAX_TEXELS_PER_BLOCK_PADDED];
 
 	float texel_weight_rg[MAX_TEXELS_PER_BLOCK];
 	float texel_weight_rb[MAX_TEXELS_PER_BLOCK];
 	float texel_weight_gb[MAX_TEXELS_PER_BLOCK];
 	float texel_weight_ra[MAX_TEXELS_PER_BLOCK];
 
-	float texel_weight_r[MAX_TEXELS_PER_BLOCK];
-	float texel_weight_g[MAX_TEXELS_PER_BLOCK];
-	float texel_weight_b[MAX_TEXELS_PER_BLOCK];
-	float texel_weight_a[MAX_TEXELS_PER_BLOCK];
+	float texel_weight_r[MAX_TEXELS_PER_BLOCK_PADDED];
+	float texel_weight_g[MAX_TEXELS_PER_BLOCK_PADDED];
+	float texel_weight_b[MAX_TEXELS_PER_BLOCK_PADDED];
+	float texel_weight_a[MAX_TEXELS_PER_BLOCK_PADDED];
 };
 
 // enumeration of all the quantization methods we support under this format.
@@ -709,6 +866,8 @@ struct physical_compressed_block
  * @param ydim        The y axis size of the block.
  * @param zdim        The z axis size of the block.
  * @param mode_cutoff The block mode percentil cutoff [0-1].
+ * @param lazy_tables True if the decimation and partition tables should be
+ *                    built on first use; only valid for decompression.
  * @param bsd         The structure to populate.
  */
 void init_block_size_descriptor(
@@ -717,11 +876,48 @@ void init_block_size_descriptor(
 	int zdim,
 	bool can_omit_modes,
 	float mode_cutoff,
+	bool lazy_tables,
 	block_size_descriptor* bsd);
 
 void term_block_size_descriptor(
 	block_size_descriptor* bsd);
 
+/**
+ * @brief Get a shared block size descriptor for the target block size.
+ *
+ * Descriptors are immutable once built, so contexts with the same block size
+ * and construction settings share a single reference counted instance from a
+ * process-wide cache. Each call must be paired with a call to
+ * release_block_size_descriptor(). This function is thread-safe.
+ *
+ * @param xdim             The x axis size of the block.
+ * @param ydim             The y axis size of the block.
+ * @param zdim             The z axis size of the block.
+ * @param can_omit_modes   True if modes that compression won't use can be omitted.
+ * @param mode_cutoff      The block mode percentile cutoff [0-1].
+ * @param lazy_tables      True if the tables should be built on first use.
+ *
+ * @return The shared descriptor.
+ */
+const block_size_descriptor* acquire_block_size_descriptor(
+	int xdim,
+	int ydim,
+	int zdim,
+	bool can_omit_modes,
+	float mode_cutoff,
+	bool lazy_tables);
+
+/**
+ * @brief Release a shared block size descriptor.
+ *
+ * The descriptor is freed when the last context using it releases it. This
+ * function is thread-safe.
+ *
+ * @param bsd   The descriptor returned by acquire_block_size_descriptor().
+ */
+void release_block_size_descriptor(
+	const block_size_descriptor* bsd);
+
 /**
  * @brief Populate the partition tables for the target block size.
  *
@@ -733,15 +929,104 @@ void term_block_size_descriptor(
 void init_partition_tables(
 	block_size_descriptor* bsd);
 
+/**
+ * @brief Build a partition table for a BSD using lazy table construction.
+ *
+ * This is thread-safe; if multiple threads race to build the same table only
+ * one result is kept, and all callers receive that one.
+ *
+ * @param bsd              The block size descriptor.
+ * @param partition_count  The partition count; must be 2 or more.
+ * @param index            The partition index (seed).
+ *
+ * @return The partition table.
+ */
+const partition_info* init_lazy_partition_info(
+	const block_size_descriptor& bsd,
+	int partition_count,
+	int index);
+
+/**
+ * @brief Build a decimation table for a BSD using lazy table construction.
+ *
+ * This is thread-safe; if multiple threads race to build the same table only
+ * one result is kept, and all callers receive that one.
+ *
+ * @param bsd              The block size descriptor.
+ * @param decimation_mode  The decimation mode index.
+ *
+ * @return The decimation table.
+ */
+const decimation_table* init_lazy_decimation_table(
+	const block_size_descriptor& bsd,
+	int decimation_mode);
+
+/**
+ * @brief Get the decimation table for a decimation mode.
+ *
+ * @param bsd              The block size descriptor.
+ * @param decimation_mode  The decimation mode index.
+ *
+ * @return The decimation table.
+ */
+static inline const decimation_table* get_decimation_table(
+	const block_size_descriptor& bsd,
+	int decimation_mode
+) {
+	if (!bsd.lazy_tables)
+	{
+		return bsd.decimation_tables[decimation_mode];
+	}
+
+	const decimation_table* dt = bsd.lazy_decimation_tables[decimation_mode].load(std::memory_order_acquire);
+	return dt ? dt : init_lazy_decimation_table(bsd, decimation_mode);
+}
+
+/**
+ * @brief Get the searchable partition tables for a partition count.
+ *
+ * The returned array contains @c bsd->partitioning_count[partition_count - 1]
+ * entries, stored in increasing partition index order.
+ *
+ * @param bsd              The block size descriptor.
+ * @param partition_count  The partition count.
+ *
+ * @return The first partition table.
+ */
 static inline const partition_info *get_partition_table(
 	const block_size_descriptor* bsd,
 	int partition_count
 ) {
-	if (partition_count == 1) {
-		partition_count = 5;
+	return bsd->partitioning_tables[partition_count - 1];
+}
+
+/**
+ * @brief Get the partition table for a physical partition index.
+ *
+ * @param bsd              The block size descriptor.
+ * @param partition_count  The partition count.
+ * @param index            The partition index (seed).
+ *
+ * @return The partition table.
+ */
+static inline const partition_info *get_partition_info(
+	const block_size_descriptor* bsd,
+	int partition_count,
+	int index
+) {
+	if (partition_count == 1)
+	{
+		return bsd->partitioning_tables[0];
+	}
+
+	if (bsd->lazy_tables)
+	{
+		const partition_info* pt = bsd->lazy_partitions[partition_count - 2][index].load(std::memory_order_acquire);
+		return pt ? pt : init_lazy_partition_info(*bsd, partition_count, index);
 	}
-	int index = (partition_count - 2) * PARTITION_COUNT;
-	return bsd->partitions + index;
+
+	int packed_index = bsd->partitioning_packed_index[partition_count - 2][index];
+	return bsd->partitioning_tables[partition_count - 1] + packed_index;
 }
 
 /**
@@ -788,6 +1073,19 @@ extern const uint8_t color_quant_tables[21][256];
 extern const uint8_t color_unquant_tables[21][256];
 extern int8_t quant_mode_table[17][128];
 
+/**
+ * @brief Encode a packed string using BISE.
+ *
+ * The sequence is packed a trit or quint group at a time, with each group
+ * written into the block using a single 64-bit word operation. Bits in the
+ * output block that are outside of the encoded sequence are preserved.
+ *
+ * @param      quant_level   The quantization level to use.
+ * @param      elements      The number of elements to encode.
+ * @param      input_data    The unpacked elements to encode.
+ * @param[out] output_data   The 16 byte physical block to write to.
+ * @param      bit_offset    The bit offset of the sequence in the block.
+ */
 void encode_ise(
 	int quant_level,
 	int elements,
@@ -795,6 +1093,19 @@ void encode_ise(
 	uint8_t* output_data,
 	int bit_offset);
 
+/**
+ * @brief Decode a packed string using BISE.
+ *
+ * The sequence is unpacked a trit or quint group at a time, with each group
+ * read from the block using a single 64-bit word operation and all of its
+ * trits or quints unpacked with a single table lookup.
+ *
+ * @param      quant_level   The quantization level to use.
+ * @param      elements      The number of elements to decode.
+ * @param      input_data    The 16 byte physical block to read from.
+ * @param[out] output_data   The unpacked decoded elements.
+ * @param      bit_offset    The bit offset of the sequence in the block.
+ */
 void decode_ise(
 	int quant_level,
 	int elements,
@@ -912,7 +1223,8 @@ void find_best_partitionings(
 	int* best_partition_samechroma,
 	int* best_partition_dualplane);
 
-// use k-means clustering to compute a partition ordering for a block.
+// use k-means clustering to compute a partition ordering for a block. The
+// ordering stores array indices into the searchable partition tables.
 void kmeans_compute_partition_ordering(
 	const block_size_descriptor* bsd,
 	int partition_count,
@@ -923,6 +1235,50 @@ void kmeans_compute_partition_ordering(
 // functions and data pertaining to images and imageblocks
 // *********************************************************
 
+/**
+ * @brief The per-texel average and variance data for a region of an image.
+ *
+ * Buffers are indexed by texel coordinate relative to the buffer origin, and
+ * are only populated if the compressor configuration requires them.
+ */
+struct avg_var_buffers
+{
+	/** The regional RGBA averages. */
+	vfloat4* input_averages;
+	/** The regional RGBA variances. */
+	vfloat4* input_variances;
+	/** The regional alpha averages. */
+	float* input_alpha_averages;
+	/** The image texel coordinate of the first texel in the buffers. */
+	int offset_x;
+	int offset_y;
+	int offset_z;
+	/** The texel index stride between rows and slices in the buffers. */
+	int stride_y;
+	int stride_z;
+};
+
+/**
+ * @brief Get the buffer index of an image texel in an average and variance buffer.
+ *
+ * @param buffers   The buffers to index.
+ * @param x         The image texel x coordinate.
+ * @param y         The image texel y coordinate.
+ * @param z         The image texel z coordinate.
+ *
+ * @return The buffer index.
+ */
+static inline int get_avg_var_index(
+	const avg_var_buffers& buffers,
+	int x,
+	int y,
+	int z
+) {
+	return (z - buffers.offset_z) * buffers.stride_z +
+	       (y - buffers.offset_y) * buffers.stride_y +
+	       (x - buffers.offset_x);
+}
+
 /**
  * @brief Parameter structure for compute_pixel_region_variance().
  *
@@ -955,56 +1311,251 @@ struct pixel_region_variance_args
 	int offset_z;
 	/** The working memory buffer. */
 	vfloat4 *work_memory;
+	/** The output buffers. */
+	avg_var_buffers dst;
 };
 
 /**
- * @brief Parameter structure for compute_averages_and_variances_proc().
+ * @brief Parameter structure for compute_averages_and_variances().
+ *
+ * Averages and variances are computed in bands, each covering one or more
+ * rows of blocks in a single slice of blocks, so that only the bands which
+ * are needed by the blocks currently being compressed need to be stored.
  */
 struct avg_var_args
 {
 	/** The arguments for the nested variance computation. */
 	pixel_region_variance_args arg;
-	/** The image dimensions. */
+	/** The origin of the texel region to process. */
+	int img_offset_x;
+	int img_offset_y;
+	int img_offset_z;
+	/** The dimensions of the texel region to process. */
 	int img_size_x;
 	int img_size_y;
 	int img_size_z;
-	/** The maximum working block dimensions. */
+	/** The maximum working block width. */
 	int blk_size_xy;
-	int blk_size_z;
 	/** The working block memory size. */
 	int work_memory_size;
+	/** The maximum texel dimensions of a band. */
+	int band_size_y;
+	int band_size_z;
+	/** The number of texels in a band buffer. */
+	int band_texel_count;
+	/** The number of block rows in a band. */
+	unsigned int band_block_rows;
+	/** The number of bands in each slice of blocks. */
+	unsigned int bands_y;
+	/** The total number of bands. */
+	unsigned int band_count;
+	/** The number of processing tasks in each band. */
+	unsigned int band_tasks;
+};
+
+/**
+ * @brief The processing progress for a single band of a compression job.
+ */
+struct band_progress
+{
+	/** The number of completed average and variance tasks. */
+	std::atomic<unsigned int> tasks_done;
+	/** The number of completed block compressions. */
+	std::atomic<unsigned int> blocks_done;
+};
+
+/**
+ * @brief A compression job, covering a block region of a single image.
+ */
+struct compress_job
+{
+	/** The input image. */
+	const astcenc_image* image;
+	/** The block region of the image to compress. */
+	astcenc_block_region region;
+	/** The output data buffer. */
+	uint8_t* data_out;
+	/** The output data row pitch, in blocks. */
+	size_t row_pitch;
+	/** The previous input image, or @c nullptr if not incremental. */
+	const astcenc_image* prev_image;
+	/** The previous output data, with the same layout as the output data. */
+	const uint8_t* prev_data;
+	/** The hint encodings, with the same layout as the output data, or @c nullptr if not used. */
+	const uint8_t* hint_data;
+	/** The index of the first task for this job in the compression stage. */
+	unsigned int task_base;
+	/** The number of blocks in each compression task; a region row with RDO. */
+	unsigned int task_blocks;
+	/** The average and variance arguments for this job. */
+	avg_var_args ag;
+	/** The storage for the first band buffer; others follow contiguously. */
+	avg_var_buffers band_storage;
+	/** The number of band buffers, used as a ring. */
+	unsigned int band_slots;
+	/** The progress of each band. */
+	band_progress* bands;
+};
+
+/**
+ * @brief The state of the block classification prepass.
+ *
+ * Blocks are identified by their index in the task space of the jobs, which
+ * is the same as their index in the concatenated block regions of all jobs.
+ */
+struct block_schedule
+{
+	/** The number of blocks in all jobs. */
+	unsigned int block_count;
+	/** The number of blocks classified by each classification task. */
+	unsigned int blocks_per_task;
+	/** The number of classification tasks, and of scatter tasks. */
+	unsigned int task_count;
+	/** The range class of each block. */
+	uint8_t* block_classes;
+	/** The number of blocks in each range class, for each classification task. */
+	unsigned int* class_counts;
+	/** The blocks in compression order. */
+	unsigned int* block_order;
+	/** The number of completed classification tasks. */
+	std::atomic<unsigned int> classify_done;
+	/** The number of completed scatter tasks. */
+	std::atomic<unsigned int> scatter_done;
 };
 
 /**
- * @brief Compute regional averages and variances in an image.
+ * @brief Setup computation of regional averages and variances in an image.
  *
- * Results are written back into img->input_averages, img->input_variances,
- * and img->input_alpha_averages.
+ * Only texels covered by the block region are computed, although texels
+ * within the kernel radius of the region are read from the input image.
+ * Results are computed one band at a time by compute_averages_and_variances().
  *
- * @param img                   The input image data, also holds output data.
+ * @param img                   The input image data.
+ * @param bsd                   The block size information.
+ * @param region                The block region to process.
  * @param rgb_power             The RGB channel power.
  * @param alpha_power           The A channel power.
  * @param avg_var_kernel_radius The kernel radius (in pixels) for avg and var.
  * @param alpha_kernel_radius   The kernel radius (in pixels) for alpha mods.
  * @param swz                   Input data channel swizzle.
- * @param arg                   The pixel region arguments for this thread.
- * @param ag                    The average variance arguments for this thread.
- *
- * @return The number of tasks in the processing stage.
+ * @param ag                    The average variance arguments to init.
  */
-unsigned int init_compute_averages_and_variances(
-	astcenc_image& img,
+void init_compute_averages_and_variances(
+	const astcenc_image& img,
+	const block_size_descriptor& bsd,
+	const astcenc_block_region& region,
 	float rgb_power,
 	float alpha_power,
 	int avg_var_kernel_radius,
 	int alpha_kernel_radius,
 	astcenc_swizzle swz,
-	pixel_region_variance_args& arg,
 	avg_var_args& ag);
 
+/**
+ * @brief Get the buffers for a band of regional averages and variances.
+ *
+ * @param ag        The average variance arguments for the image.
+ * @param storage   The buffer storage, with space for a single band.
+ * @param band      The band index.
+ *
+ * @return The buffers, with offsets and strides for the band.
+ */
+avg_var_buffers get_band_avg_var_buffers(
+	const avg_var_args& ag,
+	const avg_var_buffers& storage,
+	unsigned int band);
+
+/**
+ * @brief Compute regional averages and variances for one task of a band.
+ *
+ * @param ag            The average variance arguments for the image.
+ * @param dst           The output buffers for the band.
+ * @param task          The task index within the band.
+ * @param work_memory   The working memory, of at least @c ag.work_memory_size.
+ */
 void compute_averages_and_variances(
-	astcenc_context& ctx,
-	const avg_var_args& ag);
+	const avg_var_args& ag,
+	const avg_var_buffers& dst,
+	unsigned int task,
+	vfloat4* work_memory);
+
+/**
+ * @brief Get the number of channels per texel in an image.
+ *
+ * @param img   The image.
+ *
+ * @return The channel count, in the range [1, 4].
+ */
+static inline int get_image_components(
+	const astcenc_image& img
+) {
+	return img.components == 0 ? 4 : static_cast<int>(img.components);
+}
+
+/**
+ * @brief Get the size of a single channel in an image, in bytes.
+ *
+ * @param img   The image.
+ *
+ * @return The channel size.
+ */
+static inline size_t get_image_component_size(
+	const astcenc_image& img
+) {
+	if (img.data_type == ASTCENC_TYPE_U8)
+	{
+		return 1;
+	}
+
+	return img.data_type == ASTCENC_TYPE_F16 ? 2 : 4;
+}
+
+/**
+ * @brief Get the row pitch of an image, in bytes.
+ *
+ * @param img   The image.
+ *
+ * @return The row pitch, resolving a zero pitch to the packed row size.
+ */
+static inline size_t get_image_row_pitch(
+	const astcenc_image& img
+) {
+	if (img.row_pitch != 0)
+	{
+		return img.row_pitch;
+	}
+
+	return img.dim_x * get_image_components(img) * get_image_component_size(img);
+}
+
+/**
+ * @brief Get a pointer to the first texel of an image row.
+ *
+ * @tparam T    The channel data type of the image, which may be const.
+ * @param img   The image.
+ * @param y     The row index in the slice.
+ * @param z     The slice index.
+ *
+ * @return The row pointer; texel @c x is at offset @c x*get_image_components().
+ */
+template <typename T>
+static inline T* get_image_row(
+	const astcenc_image& img,
+	int y,
+	int z
+) {
+	uint8_t* slice;
+	if (img.slice_pitch != 0)
+	{
+		slice = static_cast<uint8_t*>(img.data[0]) + img.slice_pitch * z;
+	}
+	else
+	{
+		slice = static_cast<uint8_t*>(img.data[z]);
+	}
+
+	return reinterpret_cast<T*>(slice + get_image_row_pitch(img) * y);
+}
 
 // fetch an image-block from the input file
 void fetch_imageblock(
@@ -1018,6 +1569,34 @@ void fetch_imageblock(
 	int zpos,
 	astcenc_swizzle swz);
 
+/**
+ * @brief The number of block range classes.
+ */
+static const unsigned int BLOCK_RANGE_CLASSES = 9;
+
+/**
+ * @brief Get the range class of a block, used to estimate its compression cost.
+ *
+ * Class zero is a constant color block. Other classes are the number of
+ * significant bits in the largest channel range of the block, measured as an
+ * 8-bit UNORM value and counting any non-zero range as at least one bit. The
+ * input data swizzle is not applied.
+ *
+ * @param img    The input image.
+ * @param bsd    The block size descriptor.
+ * @param xpos   The block x coordinate in the image, in texels.
+ * @param ypos   The block y coordinate in the image, in texels.
+ * @param zpos   The block z coordinate in the image, in texels.
+ *
+ * @return The block range class, in the range [0, BLOCK_RANGE_CLASSES).
+ */
+unsigned int get_block_range_class(
+	const astcenc_image& img,
+	const block_size_descriptor& bsd,
+	int xpos,
+	int ypos,
+	int zpos);
+
 // write an image block to the output file buffer.
 // the data written are taken from orig_data.
 void write_imageblock(
@@ -1154,22 +1733,36 @@ struct encoding_choice_errors
 };
 
 // buffers used to store intermediate data in compress_symbolic_block_fixed_partition_*()
+/**
+ * @brief The per-thread working memory for compressing a fixed partitioning.
+ *
+ * Quantized weights are not stored for every block mode; they are computed
+ * into temporaries while estimating the weight error of each mode, and are
+ * computed again for the few candidate modes which are trialed. This keeps the
+ * working set small enough to stay resident in the core-private caches.
+ */
 struct alignas(ASTCENC_VECALIGN) compress_fixed_partition_buffers
 {
+	/** @brief The ideal endpoints and weights for plane 1. */
 	endpoints_and_weights ei1;
+
+	/** @brief The ideal endpoints and weights for plane 2. */
 	endpoints_and_weights ei2;
-	endpoints_and_weights eix1[MAX_DECIMATION_MODES];
-	endpoints_and_weights eix2[MAX_DECIMATION_MODES];
+
+	/** @brief The ideal decimated weights for each decimation mode and plane. */
 	alignas(ASTCENC_VECALIGN) float decimated_quantized_weights[2 * MAX_DECIMATION_MODES * MAX_WEIGHTS_PER_BLOCK];
+
+	/** @brief The error weight of each decimated weight, for each decimation mode and plane. */
 	alignas(ASTCENC_VECALIGN) float decimated_weights[2 * MAX_DECIMATION_MODES * MAX_WEIGHTS_PER_BLOCK];
-	alignas(ASTCENC_VECALIGN) float flt_quantized_decimated_quantized_weights[2 * MAX_WEIGHT_MODES * MAX_WEIGHTS_PER_BLOCK];
-	alignas(ASTCENC_VECALIGN) uint8_t u8_quantized_decimated_quantized_weights[2 * MAX_WEIGHT_MODES * MAX_WEIGHTS_PER_BLOCK];
 };
 
 struct compress_symbolic_block_buffers
 {
 	error_weight_block ewb;
 	compress_fixed_partition_buffers planes;
+
+	// The compression statistics for the thread using this buffer
+	astcenc_stats stats;
 };
 
 void compute_encoding_choice_errors(
@@ -1234,6 +1827,7 @@ void imageblock_initialize_deriv(
 
 void compute_angular_endpoints_1plane(
 	bool only_always,
+	int only_block_mode,
 	const block_size_descriptor* bsd,
 	const float* decimated_quantized_weights,
 	const float* decimated_weights,
@@ -1242,6 +1836,7 @@ void compute_angular_endpoints_1plane(
 
 void compute_angular_endpoints_2planes(
 	bool only_always,
+	int only_block_mode,
 	const block_size_descriptor * bsd,
 	const float* decimated_quantized_weights,
 	const float* decimated_weights,
@@ -1252,10 +1847,217 @@ void compute_angular_endpoints_2planes(
 
 /* *********************************** high-level encode and decode functions ************************************ */
 
-void compress_block(
+/**
+ * @brief The number of effort levels used by time budgeted compression.
+ */
+static const unsigned int BUDGET_EFFORT_LEVELS = 8;
+
+/**
+ * @brief The search limits used when compressing a block.
+ *
+ * These are normally the limits from the codec configuration, but may be
+ * reduced during time budgeted or adaptive effort compression. The dB limit is stored after
+ * conversion to a per-texel error.
+ */
+struct block_search_limits
+{
+	/** @brief The block size descriptor, which selects the block modes to test. */
+	const block_size_descriptor* bsd;
+
+	/** @brief The number of partitionings to test. */
+	unsigned int partition_limit;
+
+	/** @brief The number of candidate encodings to test per block mode. */
+	unsigned int candidate_limit;
+
+	/** @brief The number of refinement iterations per candidate. */
+	unsigned int refinement_limit;
+
+	/** @brief The per-texel error target for an early out. */
+	float db_limit;
+
+	/** @brief The error overshoot accepted for the first 1 plane trial. */
+	float mode0_mse_overshoot;
+
+	/** @brief The threshold for skipping 3+ partitions. */
+	float partition_early_out_limit;
+
+	/** @brief The threshold for skipping 2 weight planes. */
+	float two_plane_early_out_limit;
+
+	/** @brief The weight error gain, as a fraction of the error target, for skipping more precise weights. */
+	float weight_converged_fraction;
+};
+
+/**
+ * @brief The key identifying the compressor input for a block.
+ */
+struct block_cache_key
+{
+	/** The first hash of the block data; never zero. */
+	uint64_t hash0;
+	/** The second hash of the block data. */
+	uint64_t hash1;
+};
+
+/**
+ * @brief An entry in the duplicate block cache.
+ */
+struct block_cache_entry
+{
+	/** The first hash of the key, or zero if the entry is unused. */
+	std::atomic<uint64_t> hash0;
+	/** The second hash of the key, valid once @c ready is set. */
+	uint64_t hash1;
+	/** Is the entry fully written? */
+	std::atomic<uint32_t> ready;
+	/** The encoded block, valid once @c ready is set. */
+	physical_compressed_block pcb;
+};
+
+/**
+ * @brief A lock-free hash table of already encoded blocks.
+ *
+ * Entries are only ever added, never removed or replaced, for the duration of
+ * a single compression. Threads that fail to find or insert an entry simply
+ * compress the block themselves, so no thread ever waits on another.
+ */
+struct block_cache
+{
+	/** The hash table entries. */
+	block_cache_entry* entries;
+	/** The number of entries minus one; the entry count is a power of two. */
+	unsigned int entry_mask;
+};
+
+/**
+ * @brief Get the number of block cache entries to use for an image.
+ *
+ * @param block_count   The number of blocks to compress.
+ *
+ * @return The number of entries, which is a power of two.
+ */
+unsigned int get_block_cache_entry_count(
+	unsigned int block_count);
+
+/**
+ * @brief Initialize a block cache, marking all entries as unused.
+ *
+ * @param cache         The cache to initialize.
+ * @param entries       The entry storage, which may be uninitialized.
+ * @param entry_count   The number of entries; must be a power of two.
+ */
+void init_block_cache(
+	block_cache& cache,
+	block_cache_entry* entries,
+	unsigned int entry_count);
+
+/**
+ * @brief Compute the block cache key for a block.
+ *
+ * The key covers the texel data and the texel encoding flags. The compressor
+ * treats texels outside of the image differently, so the key also covers the
+ * number of texels in each dimension which are inside the image.
+ *
+ * @param bsd       The block size information.
+ * @param blk       The image block data.
+ * @param valid_x   The number of texels in X which are inside the image.
+ * @param valid_y   The number of texels in Y which are inside the image.
+ * @param valid_z   The number of texels in Z which are inside the image.
+ *
+ * @return The block key.
+ */
+block_cache_key compute_block_cache_key(
+	const block_size_descriptor& bsd,
+	const imageblock& blk,
+	int valid_x,
+	int valid_y,
+	int valid_z);
+
+/**
+ * @brief Find an encoded block in the block cache.
+ *
+ * @param      cache   The cache to search.
+ * @param      key     The block key.
+ * @param[out] pcb     The encoded block, if found.
+ *
+ * @return @c true if the block was found, @c false otherwise.
+ */
+bool block_cache_lookup(
+	const block_cache& cache,
+	const block_cache_key& key,
+	physical_compressed_block& pcb);
+
+/**
+ * @brief Add an encoded block to the block cache.
+ *
+ * The block is silently dropped if the key is already present, or if there
+ * is no free entry close to its hashed position.
+ *
+ * @param cache   The cache to add to.
+ * @param key     The block key.
+ * @param pcb     The encoded block.
+ */
+void block_cache_insert(
+	block_cache& cache,
+	const block_cache_key& key,
+	const physical_compressed_block& pcb);
+
+/**
+ * @brief Compress a block, searching for an encoding which meets the quality target.
+ *
+ * If a hint encoding is given, such as the encoding of the same block in the
+ * previous frame of a sequence, its block mode and partitioning are tested
+ * first, and the search stops early if they meet the target.
+ *
+ * @param      ctx       The codec context.
+ * @param      image     The input image.
+ * @param      avg_var   The averages and variances for the block, if used.
+ * @param      limits    The search limits.
+ * @param      blk       The image block.
+ * @param      hint      The hint encoding, or @c nullptr if not used.
+ * @param[out] scb       The symbolic encoding.
+ * @param[out] pcb       The physical encoding.
+ * @param      tmpbuf    The per-thread working buffers.
+ *
+ * @return @c true if the encoding error is below the block error target.
+ */
+bool compress_block(
 	const astcenc_context& ctx,
 	const astcenc_image& image,
+	const avg_var_buffers& avg_var,
+	const block_search_limits& limits,
+	const imageblock* blk,
+	const physical_compressed_block* hint,
+	symbolic_compressed_block& scb,
+	physical_compressed_block& pcb,
+	compress_symbolic_block_buffers* tmpbuf);
+
+/**
+ * @brief Reuse parts of neighboring block encodings to reduce the coded size.
+ *
+ * Candidate encodings reuse a whole neighbor encoding, or the endpoints or
+ * weights of a neighbor with the same block mode and partitioning. Each
+ * candidate is scored by its error plus a rate cost for each byte which is
+ * not repeated by a neighbor, scaled by @c tune_rdo_lambda, and the lowest
+ * cost encoding is kept. Constant color and error blocks are not changed.
+ *
+ * This must be called directly after @c compress_block() for the same block,
+ * as it uses the error weights stored in @c tmpbuf.
+ *
+ * @param         ctx              The codec context.
+ * @param         blk              The image block being compressed.
+ * @param         neighbors        The final encodings of neighboring blocks.
+ * @param         neighbor_count   The number of neighboring blocks.
+ * @param[in,out] scb              The symbolic encoding of the block.
+ * @param[in,out] pcb              The physical encoding of the block.
+ * @param         tmpbuf           The compressor working buffers.
+ */
+void apply_block_rdo(
+	const astcenc_context& ctx,
 	const imageblock* blk,
+	const physical_compressed_block* neighbors,
+	unsigned int neighbor_count,
 	symbolic_compressed_block& scb,
 	physical_compressed_block& pcb,
 	compress_symbolic_block_buffers* tmpbuf);
@@ -1269,6 +2071,30 @@ void decompress_symbolic_block(
 	const symbolic_compressed_block* scb,
 	imageblock* blk);
 
+/**
+ * @brief Decompress a symbolic block directly into an RGBA8 image.
+ *
+ * This is a fast path for the LDR profiles writing unswizzled U8 output. It
+ * bypasses the float imageblock, but is bit-exact with the result of using
+ * decompress_symbolic_block() followed by write_imageblock().
+ *
+ * @param      decode_mode   The decode mode; must be an LDR profile.
+ * @param      bsd           The block size information.
+ * @param      xpos          The X coordinate of the block in the image.
+ * @param      ypos          The Y coordinate of the block in the image.
+ * @param      zpos          The Z coordinate of the block in the image.
+ * @param      scb           The symbolic block to decompress.
+ * @param[out] img           The output image; must be @c ASTCENC_TYPE_U8 with four channels.
+ */
+void decompress_symbolic_block_u8(
+	astcenc_profile decode_mode,
+	const block_size_descriptor* bsd,
+	int xpos,
+	int ypos,
+	int zpos,
+	const symbolic_compressed_block* scb,
+	astcenc_image& img);
+
 void symbolic_to_physical(
 	const block_size_descriptor& bsd,
 	const symbolic_compressed_block& scb,
@@ -1286,11 +2112,28 @@ uint16_t unorm16_to_sf16(
 class TraceLog; // See astcenc_diagnostic_trace for details.
 #endif
 
+/**
+ * @brief A linear scratch memory arena.
+ *
+ * Allocations are bumped from a single block of memory, which is only ever
+ * grown, so an arena that is retained across compressions reaches a high-water
+ * mark after which no further heap allocation is needed.
+ */
+struct scratch_arena
+{
+	/** The arena memory. */
+	uint8_t* data;
+	/** The arena memory size, in bytes. */
+	size_t capacity;
+	/** The number of bytes allocated from the arena. */
+	size_t used;
+};
+
 struct astcenc_context
 {
 	astcenc_config config;
 	unsigned int thread_count;
-	block_size_descriptor* bsd;
+	const block_size_descriptor* bsd;
 
 	// Fields below here are not needed in a decompress-only build, but some
 	// remain as they are small and it avoids littering the code with #ifdefs.
@@ -1299,29 +2142,87 @@ struct astcenc_context
 	// Regional average-and-variance information, initialized by
 	// compute_averages_and_variances() only if the astc encoder
 	// is requested to do error weighting based on averages and variances.
+	// These store the band buffer rings for all jobs, in job order.
 	vfloat4 *input_averages;
 	vfloat4 *input_variances;
 	float *input_alpha_averages;
 
-	compress_symbolic_block_buffers* working_buffers;
+	// Per-thread working buffers, allocated by each thread on first use so
+	// that the memory is local to the thread on NUMA systems
+	compress_symbolic_block_buffers** working_buffers;
 
 #if !defined(ASTCENC_DECOMPRESS_ONLY)
-	pixel_region_variance_args arg;
-	avg_var_args ag;
+	// The compression jobs for the current image or batch
+	compress_job* jobs;
+	unsigned int job_count;
+
+	// The band progress for all jobs, in job order
+	band_progress* bands;
+
+	// The per-thread average and variance working memory
+	vfloat4* avg_var_work_memory;
+	int avg_var_work_memory_size;
+
+	// The duplicate block cache, if enabled
+	block_cache cache;
+
+	// The block classification prepass state, if used
+	block_schedule schedule;
+
+	// The search limits for each time budget effort level; the highest level
+	// uses the limits from the configuration
+	block_search_limits search_limits[BUDGET_EFFORT_LEVELS];
+
+	// The search limits for the first pass of adaptive effort compression,
+	// which has its own descriptor if enabled; the dB limit is not used
+	block_search_limits adaptive_limits;
+
+	// The current effort level, which persists between images so that a
+	// sequence of similar images starts from the level that last fitted
+	std::atomic<unsigned int> effort_level;
+
+	// The start time of the current compression, if using a time budget
+	std::chrono::steady_clock::time_point budget_start;
+
+	// The compression statistics merged from all threads
+	astcenc_stats stats;
+
+	// Set by astcenc_compress_cancel(), and cleared by astcenc_compress_reset()
+	std::atomic<bool> cancel_requested;
+
+	// Was the last compression cancelled? Set once all threads are finished
+	bool compress_cancelled;
+
+	// Serializes progress callbacks, and the last percentage reported
+	std::mutex progress_lock;
+	unsigned int progress_reported;
+
+	// The scratch memory for the jobs, their band data, the block cache, and
+	// the block schedule
+	scratch_arena job_scratch;
+	scratch_arena band_scratch;
+	scratch_arena cache_scratch;
+	scratch_arena schedule_scratch;
 
 	float deblock_weights[MAX_TEXELS_PER_BLOCK];
 
-	ParallelManager manage_avg_var;
 	ParallelManager manage_compress;
 #endif
 
+	ParallelManager manage_decompress;
+
 #if defined(ASTCENC_DIAGNOSTICS)
 	TraceLog* trace_log;
 #endif
 };
 
+ASTCENC_NAMESPACE_END
+
 /* ============================================================================
   Platform-specific functions
+
+  Host ISA detection is shared by all ISA variants of the codec, so these
+  functions are always declared in the global namespace.
 ============================================================================ */
 /**
  * @brief Run-time detection if the host CPU supports SSE 4.1.
@@ -1335,12 +2236,25 @@ int cpu_supports_sse41();
  */
 int cpu_supports_popcnt();
 
+/**
+ * @brief Run-time detection if the host CPU supports F16C.
+ * @return Zero if not supported, positive value if it is.
+ */
+int cpu_supports_f16c();
+
 /**
  * @brief Run-time detection if the host CPU supports avx2.
  * @return Zero if not supported, positive value if it is.
  */
 int cpu_supports_avx2();
 
+/**
+ * @brief Run-time detection if the host CPU supports avx512 (F, BW, DQ, and VL).
+ * @return Zero if not supported, positive value if it is.
+ */
+int cpu_supports_avx512();
+
+ASTCENC_NAMESPACE_BEGIN
 
 /**
  * @brief Allocate an aligned memory buffer.
@@ -1387,5 +2301,6 @@ void aligned_free(T* ptr)
 #endif
 }
 
-#endif
+ASTCENC_NAMESPACE_END
 
+#endif
@@ -31,11 +31,50 @@
 
 #include "astcenc_internal.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 // for k++ means, we need pseudo-random numbers, however using random numbers
 // directly results in unreproducible encoding results. As such, we will
 // instead just supply a handful of numbers from random.org, and apply an
 // algorithm similar to XKCD #221. (http://xkcd.com/221/)
 
+/**
+ * @brief Compute the squared distance of a vector of texels from a color.
+ *
+ * @param blk     The image block.
+ * @param base    The index of the first texel in the vector.
+ * @param center  The color to measure from, replicated across the lanes.
+ *
+ * @return The squared distance of each texel.
+ */
+static ASTCENC_SIMD_INLINE vfloat texel_distances(
+	const imageblock* blk,
+	int base,
+	const vfloat center[4]
+) {
+	vfloat diff_r = vfloat(blk->data_r + base) - center[0];
+	vfloat diff_g = vfloat(blk->data_g + base) - center[1];
+	vfloat diff_b = vfloat(blk->data_b + base) - center[2];
+	vfloat diff_a = vfloat(blk->data_a + base) - center[3];
+	return (diff_r * diff_r + diff_g * diff_g) + (diff_b * diff_b + diff_a * diff_a);
+}
+
+/**
+ * @brief Replicate a color across the lanes of four SIMD vectors.
+ *
+ * @param      color   The color to replicate.
+ * @param[out] center  The replicated color components.
+ */
+static ASTCENC_SIMD_INLINE void replicate_color(
+	vfloat4 color,
+	vfloat center[4]
+) {
+	center[0] = vfloat(color.lane<0>());
+	center[1] = vfloat(color.lane<1>());
+	center[2] = vfloat(color.lane<2>());
+	center[3] = vfloat(color.lane<3>());
+}
+
 // cluster the texels using the k++ means clustering initialization algorithm.
 static void kmeans_init(
 	int texels_per_block,
@@ -48,16 +87,28 @@ static void kmeans_init(
 	cluster_center_samples[0] = 145897 /* number from random.org */  % texels_per_block;
 	int samples_selected = 1;
 
-	float distances[MAX_TEXELS_PER_BLOCK];
+	alignas(ASTCENC_VECALIGN) float distances[MAX_TEXELS_PER_BLOCK];
+	int clipped_texel_count = round_down_to_simd_multiple_vla(texels_per_block);
 
 	// compute the distance to the first point.
 	int sample = cluster_center_samples[0];
 	vfloat4 center_color = blk->texel(sample);
+	vfloat center[4];
+	replicate_color(center_color, center);
+
+	vfloat vdistance_sum = vfloat::zero();
+	int i = 0;
+	for (/* */; i < clipped_texel_count; i += ASTCENC_SIMD_WIDTH)
+	{
+		vfloat distance = texel_distances(blk, i, center);
+		vdistance_sum = vdistance_sum + distance;
+		storea(distance, distances + i);
+	}
 
-	float distance_sum = 0.0f;
-	for (int i = 0; i < texels_per_block; i++)
+	float distance_sum = hadd_s(vdistance_sum);
+	for (/* */; i < texels_per_block; i++)
 	{
-		vfloat4 color =  blk->texel(i);
+		vfloat4 color = blk->texel(i);
 		vfloat4 diff = color - center_color;
 		float distance = dot_s(diff, diff);
 		distance_sum += distance;
@@ -100,10 +151,19 @@ static void kmeans_init(
 		}
 
 		// update the distances with the new point.
-		center_color = blk->texel(sample);;
+		center_color = blk->texel(sample);
+		replicate_color(center_color, center);
 
-		distance_sum = 0.0f;
-		for (int i = 0; i < texels_per_block; i++)
+		vdistance_sum = vfloat::zero();
+		for (i = 0; i < clipped_texel_count; i += ASTCENC_SIMD_WIDTH)
+		{
+			vfloat distance = min(texel_distances(blk, i, center), loada(distances + i));
+			vdistance_sum = vdistance_sum + distance;
+			storea(distance, distances + i);
+		}
+
+		distance_sum = hadd_s(vdistance_sum);
+		for (/* */; i < texels_per_block; i++)
 		{
 			vfloat4 color = blk->texel(i);
 			vfloat4 diff = color - center_color;
@@ -115,10 +175,10 @@ static void kmeans_init(
 	}
 
 	// finally, gather up the results.
-	for (int i = 0; i < partition_count; i++)
+	for (int j = 0; j < partition_count; j++)
 	{
-		int center_sample = cluster_center_samples[i];
-		cluster_centers[i] = blk->texel(center_sample);
+		int center_sample = cluster_center_samples[j];
+		cluster_centers[j] = blk->texel(center_sample);
 	}
 }
 
@@ -131,42 +191,57 @@ static void kmeans_assign(
 	const vfloat4* cluster_centers,
 	int* partition_of_texel
 ) {
-	float distances[MAX_TEXELS_PER_BLOCK];
-
-	int texels_per_partition[4];
-
-	texels_per_partition[0] = texels_per_block;
-	for (int i = 1; i < partition_count; i++)
+	vfloat centers[4][4];
+	for (int j = 0; j < partition_count; j++)
 	{
-		texels_per_partition[i] = 0;
+		replicate_color(cluster_centers[j], centers[j]);
 	}
 
-	for (int i = 0; i < texels_per_block; i++)
+	// Assign each texel to the nearest center, with ties resolved to the
+	// lowest partition index
+	int i = 0;
+	int clipped_texel_count = round_down_to_simd_multiple_vla(texels_per_block);
+	for (/* */; i < clipped_texel_count; i += ASTCENC_SIMD_WIDTH)
 	{
-		vfloat4 color = blk->texel(i);
-		vfloat4 diff = color - cluster_centers[0];
-		float distance = dot_s(diff, diff);
-		distances[i] = distance;
-		partition_of_texel[i] = 0;
+		vfloat best_distance = texel_distances(blk, i, centers[0]);
+		vint best_partition = vint::zero();
+
+		for (int j = 1; j < partition_count; j++)
+		{
+			vfloat distance = texel_distances(blk, i, centers[j]);
+			vmask closer = distance < best_distance;
+			best_distance = select(best_distance, distance, closer);
+			best_partition = select(best_partition, vint(j), closer);
+		}
+
+		storea(best_partition, partition_of_texel + i);
 	}
 
-	for (int j = 1; j < partition_count; j++)
+	for (/* */; i < texels_per_block; i++)
 	{
-		vfloat4 center_color = cluster_centers[j];
+		vfloat4 color = blk->texel(i);
+		vfloat4 diff = color - cluster_centers[0];
+		float best_distance = dot_s(diff, diff);
+		int best_partition = 0;
 
-		for (int i = 0; i < texels_per_block; i++)
+		for (int j = 1; j < partition_count; j++)
 		{
-			vfloat4 color = blk->texel(i);
-			vfloat4 diff = color - center_color;
+			diff = color - cluster_centers[j];
 			float distance = dot_s(diff, diff);
-			if (distance < distances[i])
+			if (distance < best_distance)
 			{
-				distances[i] = distance;
-				texels_per_partition[partition_of_texel[i]]--;
-				texels_per_partition[j]++;
-				partition_of_texel[i] = j;
+				best_distance = distance;
+				best_partition = j;
 			}
 		}
+
+		partition_of_texel[i] = best_partition;
+	}
+
+	int texels_per_partition[4] { 0 };
+	for (i = 0; i < texels_per_block; i++)
+	{
+		texels_per_partition[partition_of_texel[i]]++;
 	}
 
 	// it is possible to get a situation where one of the partitions ends up
@@ -178,13 +253,13 @@ static void kmeans_assign(
 	do
 	{
 		problem_case = 0;
-		for (int i = 0; i < partition_count; i++)
+		for (int j = 0; j < partition_count; j++)
 		{
-			if (texels_per_partition[i] == 0)
+			if (texels_per_partition[j] == 0)
 			{
-				texels_per_partition[partition_of_texel[i]]--;
-				texels_per_partition[i]++;
-				partition_of_texel[i] = i;
+				texels_per_partition[partition_of_texel[j]]--;
+				texels_per_partition[j]++;
+				partition_of_texel[j] = j;
 				problem_case = 1;
 			}
 		}
@@ -201,200 +276,182 @@ static void kmeans_update(
 	const int* partition_of_texel,
 	vfloat4* cluster_centers
 ) {
-	vfloat4 color_sum[4];
-	int weight_sum[4];
+	int clipped_texel_count = round_down_to_simd_multiple_vla(texels_per_block);
 
-	for (int i = 0; i < partition_count; i++)
+	// find the center-of-gravity in each cluster
+	for (int j = 0; j < partition_count; j++)
 	{
-		color_sum[i] = vfloat4::zero();
-		weight_sum[i] = 0;
-	}
+		vint partition(j);
+		vfloat sum_r = vfloat::zero();
+		vfloat sum_g = vfloat::zero();
+		vfloat sum_b = vfloat::zero();
+		vfloat sum_a = vfloat::zero();
+		int weight_sum = 0;
+
+		int i = 0;
+		for (/* */; i < clipped_texel_count; i += ASTCENC_SIMD_WIDTH)
+		{
+			vmask used = vint::loada(partition_of_texel + i) == partition;
+			sum_r = sum_r + select(vfloat::zero(), vfloat(blk->data_r + i), used);
+			sum_g = sum_g + select(vfloat::zero(), vfloat(blk->data_g + i), used);
+			sum_b = sum_b + select(vfloat::zero(), vfloat(blk->data_b + i), used);
+			sum_a = sum_a + select(vfloat::zero(), vfloat(blk->data_a + i), used);
+			weight_sum += astc::popcount(mask(used));
+		}
 
-	// first, find the center-of-gravity in each cluster
-	for (int i = 0; i < texels_per_block; i++)
-	{
-		vfloat4 color = blk->texel(i);
-		int part = partition_of_texel[i];
-		color_sum[part] = color_sum[part] + color;
-		weight_sum[part]++;
-	}
+		vfloat4 color_sum(hadd_s(sum_r), hadd_s(sum_g), hadd_s(sum_b), hadd_s(sum_a));
+		for (/* */; i < texels_per_block; i++)
+		{
+			if (partition_of_texel[i] == j)
+			{
+				color_sum = color_sum + blk->texel(i);
+				weight_sum++;
+			}
+		}
 
-	for (int i = 0; i < partition_count; i++)
-	{
-		cluster_centers[i] = color_sum[i] * (1.0f / static_cast<float>(weight_sum[i]));
+		cluster_centers[j] = color_sum * (1.0f / static_cast<float>(weight_sum));
 	}
 }
 
+/**
+ * @brief Compute the bit-mismatch between two vectors of 64-bit bitmaps.
+ *
+ * @param a_lo   The low 32 bits of the first bitmap.
+ * @param a_hi   The high 32 bits of the first bitmap.
+ * @param b_lo   The low 32 bits of the second bitmap.
+ * @param b_hi   The high 32 bits of the second bitmap.
+ *
+ * @return The number of mismatched bits in each lane.
+ */
+static ASTCENC_SIMD_INLINE vint bitmap_mismatch(
+	vint a_lo,
+	vint a_hi,
+	vint b_lo,
+	vint b_hi
+) {
+	return popcount(a_lo ^ b_lo) + popcount(a_hi ^ b_hi);
+}
+
 // compute the bit-mismatch for a partitioning in 2-partition mode
-static inline int partition_mismatch2(
-	uint64_t a0,
-	uint64_t a1,
-	uint64_t b0,
-	uint64_t b1
+static ASTCENC_SIMD_INLINE vint partition_mismatch2(
+	const vint p[4][4]
 ) {
-	int v1 = astc::popcount(a0 ^ b0) + astc::popcount(a1 ^ b1);
-	int v2 = astc::popcount(a0 ^ b1) + astc::popcount(a1 ^ b0);
-	return astc::min(v1, v2);
+	vint v1 = p[0][0] + p[1][1];
+	vint v2 = p[0][1] + p[1][0];
+	return min(v1, v2);
 }
 
 // compute the bit-mismatch for a partitioning in 3-partition mode
-static inline int partition_mismatch3(
-	uint64_t a0,
-	uint64_t a1,
-	uint64_t a2,
-	uint64_t b0,
-	uint64_t b1,
-	uint64_t b2
+static ASTCENC_SIMD_INLINE vint partition_mismatch3(
+	const vint p[4][4]
 ) {
-	int p00 = astc::popcount(a0 ^ b0);
-	int p01 = astc::popcount(a0 ^ b1);
-	int p02 = astc::popcount(a0 ^ b2);
-
-	int p10 = astc::popcount(a1 ^ b0);
-	int p11 = astc::popcount(a1 ^ b1);
-	int p12 = astc::popcount(a1 ^ b2);
+	vint s0 = p[1][1] + p[2][2];
+	vint s1 = p[1][2] + p[2][1];
+	vint v0 = min(s0, s1) + p[0][0];
 
-	int p20 = astc::popcount(a2 ^ b0);
-	int p21 = astc::popcount(a2 ^ b1);
-	int p22 = astc::popcount(a2 ^ b2);
+	vint s2 = p[1][0] + p[2][2];
+	vint s3 = p[1][2] + p[2][0];
+	vint v1 = min(s2, s3) + p[0][1];
 
-	int s0 = p11 + p22;
-	int s1 = p12 + p21;
-	int v0 = astc::min(s0, s1) + p00;
+	vint s4 = p[1][0] + p[2][1];
+	vint s5 = p[1][1] + p[2][0];
+	vint v2 = min(s4, s5) + p[0][2];
 
-	int s2 = p10 + p22;
-	int s3 = p12 + p20;
-	int v1 = astc::min(s2, s3) + p01;
-
-	int s4 = p10 + p21;
-	int s5 = p11 + p20;
-	int v2 = astc::min(s4, s5) + p02;
-
-	return astc::min(v0, v1, v2);
+	return min(min(v0, v1), v2);
 }
 
 // compute the bit-mismatch for a partitioning in 4-partition mode
-static inline int partition_mismatch4(
-	uint64_t a0,
-	uint64_t a1,
-	uint64_t a2,
-	uint64_t a3,
-	uint64_t b0,
-	uint64_t b1,
-	uint64_t b2,
-	uint64_t b3
+static ASTCENC_SIMD_INLINE vint partition_mismatch4(
+	const vint p[4][4]
 ) {
-	int p00 = astc::popcount(a0 ^ b0);
-	int p01 = astc::popcount(a0 ^ b1);
-	int p02 = astc::popcount(a0 ^ b2);
-	int p03 = astc::popcount(a0 ^ b3);
-
-	int p10 = astc::popcount(a1 ^ b0);
-	int p11 = astc::popcount(a1 ^ b1);
-	int p12 = astc::popcount(a1 ^ b2);
-	int p13 = astc::popcount(a1 ^ b3);
-
-	int p20 = astc::popcount(a2 ^ b0);
-	int p21 = astc::popcount(a2 ^ b1);
-	int p22 = astc::popcount(a2 ^ b2);
-	int p23 = astc::popcount(a2 ^ b3);
-
-	int p30 = astc::popcount(a3 ^ b0);
-	int p31 = astc::popcount(a3 ^ b1);
-	int p32 = astc::popcount(a3 ^ b2);
-	int p33 = astc::popcount(a3 ^ b3);
-
-	int mx23 = astc::min(p22 + p33, p23 + p32);
-	int mx13 = astc::min(p21 + p33, p23 + p31);
-	int mx12 = astc::min(p21 + p32, p22 + p31);
-	int mx03 = astc::min(p20 + p33, p23 + p30);
-	int mx02 = astc::min(p20 + p32, p22 + p30);
-	int mx01 = astc::min(p21 + p30, p20 + p31);
-
-	int v0 = p00 + astc::min(p11 + mx23, p12 + mx13, p13 + mx12);
-	int v1 = p01 + astc::min(p10 + mx23, p12 + mx03, p13 + mx02);
-	int v2 = p02 + astc::min(p11 + mx03, p10 + mx13, p13 + mx01);
-	int v3 = p03 + astc::min(p11 + mx02, p12 + mx01, p10 + mx12);
-
-	return astc::min(v0, v1, v2, v3);
+	vint mx23 = min(p[2][2] + p[3][3], p[2][3] + p[3][2]);
+	vint mx13 = min(p[2][1] + p[3][3], p[2][3] + p[3][1]);
+	vint mx12 = min(p[2][1] + p[3][2], p[2][2] + p[3][1]);
+	vint mx03 = min(p[2][0] + p[3][3], p[2][3] + p[3][0]);
+	vint mx02 = min(p[2][0] + p[3][2], p[2][2] + p[3][0]);
+	vint mx01 = min(p[2][1] + p[3][0], p[2][0] + p[3][1]);
+
+	vint v0 = p[0][0] + min(min(p[1][1] + mx23, p[1][2] + mx13), p[1][3] + mx12);
+	vint v1 = p[0][1] + min(min(p[1][0] + mx23, p[1][2] + mx03), p[1][3] + mx02);
+	vint v2 = p[0][2] + min(min(p[1][1] + mx03, p[1][0] + mx13), p[1][3] + mx01);
+	vint v3 = p[0][3] + min(min(p[1][1] + mx02, p[1][2] + mx01), p[1][0] + mx12);
+
+	return min(min(v0, v1), min(v2, v3));
 }
 
+/**
+ * @brief Count the bit-mismatch between the block and each searchable partitioning.
+ *
+ * Partitionings are scored a SIMD vector at a time, using the planar coverage
+ * bitmaps stored in the block size descriptor. The output array is written up
+ * to the search count rounded up to a multiple of the SIMD width.
+ *
+ * @param      bsd              The block size descriptor.
+ * @param      partition_count  The partition count.
+ * @param      bitmaps          The block texel partition assignment bitmaps.
+ * @param[out] bitcounts        The mismatch bit count of each partitioning.
+ */
 static void count_partition_mismatch_bits(
 	const block_size_descriptor* bsd,
 	int partition_count,
 	const uint64_t bitmaps[4],
 	int bitcounts[PARTITION_COUNT]
 ) {
-	const partition_info *pi = get_partition_table(bsd, partition_count);
+	int search_count = bsd->partitioning_count[partition_count - 1];
+	int stride = round_up_to_simd_multiple_vla(search_count);
+	const int* coverage = bsd->partitioning_coverage[partition_count - 2];
 
-	if (partition_count == 2)
+	vint a_lo[4];
+	vint a_hi[4];
+	for (int j = 0; j < partition_count; j++)
 	{
-		uint64_t bm0 = bitmaps[0];
-		uint64_t bm1 = bitmaps[1];
-		for (int i = 0; i < PARTITION_COUNT; i++)
-		{
-			if (pi->partition_count == 2)
-			{
-				bitcounts[i] = partition_mismatch2(bm0, bm1, pi->coverage_bitmaps[0], pi->coverage_bitmaps[1]);
-			}
-			else
-			{
-				bitcounts[i] = 255;
-			}
-			pi++;
-		}
+		a_lo[j] = vint(static_cast<int>(static_cast<uint32_t>(bitmaps[j])));
+		a_hi[j] = vint(static_cast<int>(static_cast<uint32_t>(bitmaps[j] >> 32)));
 	}
-	else if (partition_count == 3)
+
+	for (int i = 0; i < search_count; i += ASTCENC_SIMD_WIDTH)
 	{
-		uint64_t bm0 = bitmaps[0];
-		uint64_t bm1 = bitmaps[1];
-		uint64_t bm2 = bitmaps[2];
-		for (int i = 0; i < PARTITION_COUNT; i++)
+		vint p[4][4];
+		for (int k = 0; k < partition_count; k++)
 		{
-			if (pi->partition_count == 3)
+			vint b_lo = vint::loada(coverage + (2 * k) * stride + i);
+			vint b_hi = vint::loada(coverage + (2 * k + 1) * stride + i);
+			for (int j = 0; j < partition_count; j++)
 			{
-				bitcounts[i] = partition_mismatch3(bm0, bm1, bm2, pi->coverage_bitmaps[0], pi->coverage_bitmaps[1], pi->coverage_bitmaps[2]);
+				p[j][k] = bitmap_mismatch(a_lo[j], a_hi[j], b_lo, b_hi);
 			}
-			else
-			{
-				bitcounts[i] = 255;
-			}
-			pi++;
 		}
-	}
-	else if (partition_count == 4)
-	{
-		uint64_t bm0 = bitmaps[0];
-		uint64_t bm1 = bitmaps[1];
-		uint64_t bm2 = bitmaps[2];
-		uint64_t bm3 = bitmaps[3];
-		for (int i = 0; i < PARTITION_COUNT; i++)
+
+		vint mismatch;
+		if (partition_count == 2)
 		{
-			if (pi->partition_count == 4)
-			{
-				bitcounts[i] = partition_mismatch4(bm0, bm1, bm2, bm3, pi->coverage_bitmaps[0], pi->coverage_bitmaps[1], pi->coverage_bitmaps[2], pi->coverage_bitmaps[3]);
-			}
-			else
-			{
-				bitcounts[i] = 255;
-			}
-			pi++;
+			mismatch = partition_mismatch2(p);
+		}
+		else if (partition_count == 3)
+		{
+			mismatch = partition_mismatch3(p);
+		}
+		else
+		{
+			mismatch = partition_mismatch4(p);
 		}
-	}
 
+		storea(mismatch, bitcounts + i);
+	}
 }
 
 /**
  * @brief Use counting sort on the mismatch array to sort partition candidates.
  */
 static void get_partition_ordering_by_mismatch_bits(
+	int search_count,
 	const int mismatch_bits[PARTITION_COUNT],
 	int partition_ordering[PARTITION_COUNT]
 ) {
 	int mscount[256] { 0 };
 
 	// Create the histogram of mismatch counts
-	for (int i = 0; i < PARTITION_COUNT; i++)
+	for (int i = 0; i < search_count; i++)
 	{
 		mscount[mismatch_bits[i]]++;
 	}
@@ -411,7 +468,7 @@ static void get_partition_ordering_by_mismatch_bits(
 
 	// Use the running sum as the index, incrementing after read to allow
 	// sequential entries with the same count
-	for (int i = 0; i < PARTITION_COUNT; i++)
+	for (int i = 0; i < search_count; i++)
 	{
 		int idx = mscount[mismatch_bits[i]]++;
 		partition_ordering[idx] = i;
@@ -425,7 +482,7 @@ void kmeans_compute_partition_ordering(
 	int* ordering
 ) {
 	vfloat4 cluster_centers[4];
-	int partition_of_texel[MAX_TEXELS_PER_BLOCK];
+	alignas(ASTCENC_VECALIGN) int partition_of_texel[MAX_TEXELS_PER_BLOCK];
 
 	// Use three passes of k-means clustering to partition the block data
 	for (int i = 0; i < 3; i++)
@@ -452,11 +509,14 @@ void kmeans_compute_partition_ordering(
 	}
 
 	// Count the mismatch between the block and the format's partition tables
-	int mismatch_counts[PARTITION_COUNT];
+	alignas(ASTCENC_VECALIGN) int mismatch_counts[PARTITION_COUNT];
 	count_partition_mismatch_bits(bsd, partition_count, bitmaps, mismatch_counts);
 
 	// Sort the partitions based on the number of mismatched bits
-	get_partition_ordering_by_mismatch_bits(mismatch_counts, ordering);
+	int search_count = bsd->partitioning_count[partition_count - 1];
+	get_partition_ordering_by_mismatch_bits(search_count, mismatch_counts, ordering);
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
@@ -17,6 +17,8 @@
 
 #include "astcenc_mathlib.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 /* Public function, see header file for detailed documentation */
 float astc::log2(float val)
 {
@@ -81,3 +83,5 @@ uint64_t astc::rand(uint64_t state[2])
 	state[1] = rotl(s1, 37);
 	return res;
 }
+
+ASTCENC_NAMESPACE_END
@@ -49,6 +49,14 @@
   #endif
 #endif
 
+#ifndef ASTCENC_F16C
+  #if defined(__F16C__)
+    #define ASTCENC_F16C 1
+  #else
+    #define ASTCENC_F16C 0
+  #endif
+#endif
+
 #ifndef ASTCENC_AVX
   #if defined(__AVX2__)
     #define ASTCENC_AVX 2
@@ -67,16 +75,43 @@
   #endif
 #endif
 
-#if ASTCENC_AVX
+#if ASTCENC_AVX >= 512
+  #define ASTCENC_VECALIGN 64
+#elif ASTCENC_AVX
   #define ASTCENC_VECALIGN 32
 #else
   #define ASTCENC_VECALIGN 16
 #endif
 
 #if ASTCENC_SSE != 0 || ASTCENC_AVX != 0
-	#include <immintrin.h>
+	// GCC 12 reports false positive uninitialized warnings for the use of
+	// _mm512_undefined_*() inside the AVX-512 intrinsic header
+	#if ASTCENC_AVX >= 512 && defined(__GNUC__) && !defined(__clang__)
+		#pragma GCC diagnostic push
+		#pragma GCC diagnostic ignored "-Wuninitialized"
+		#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+		#include <immintrin.h>
+		#pragma GCC diagnostic pop
+	#else
+		#include <immintrin.h>
+	#endif
 #endif
 
+/*
+ * Builds which link several ISA variants of the codec into one library compile
+ * each variant with ASTCENC_DISPATCH_NAMESPACE set, placing all of its symbols
+ * in a namespace unique to that variant. Other builds use the global namespace.
+ */
+#if defined(ASTCENC_DISPATCH_NAMESPACE)
+	#define ASTCENC_NAMESPACE_BEGIN namespace ASTCENC_DISPATCH_NAMESPACE {
+	#define ASTCENC_NAMESPACE_END }
+#else
+	#define ASTCENC_NAMESPACE_BEGIN
+	#define ASTCENC_NAMESPACE_END
+#endif
+
+ASTCENC_NAMESPACE_BEGIN
+
 /* ============================================================================
   Fast math library; note that many of the higher-order functions in this set
   use approximations which are less accurate, but faster, than <cmath> standard
@@ -572,8 +607,12 @@ float sf16_to_float(sf16);
 /*********************************
   Vector library
 *********************************/
+ASTCENC_NAMESPACE_END
+
 #include "astcenc_vecmathlib.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 /*********************************
   Declaration of line types
 *********************************/
@@ -620,4 +659,6 @@ struct processed_line4
 	vfloat4 bis;
 };
 
+ASTCENC_NAMESPACE_END
+
 #endif
@@ -21,6 +21,8 @@
 
 #include "astcenc_mathlib.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 /******************************************
   helper functions and their lookup tables
  ******************************************/
@@ -383,3 +385,5 @@ sf16 float_to_sf16(float p, roundmode rm)
 	i.f = p;
 	return sf32_to_sf16(i.u, rm);
 }
+
+ASTCENC_NAMESPACE_END
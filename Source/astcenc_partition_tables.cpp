@@ -21,6 +21,10 @@
 
 #include "astcenc_internal.h"
 
+#include <cstring>
+
+ASTCENC_NAMESPACE_BEGIN
+
 /*
 	Produce a canonicalized representation of a partition pattern
 
@@ -69,38 +73,6 @@ static int compare_canonicalized_partition_tables(
 	return 1;
 }
 
-/*
-   For a partition table, detect partitions that are equivalent, then mark them
-   as invalid. This reduces the number of partitions that the codec has to
-   consider and thus improves encode performance. */
-static void partition_table_zap_equal_elements(
-	int texel_count,
-	partition_info* pi
-) {
-	int partition_tables_zapped = 0;
-	uint64_t *canonicalizeds = new uint64_t[PARTITION_COUNT * 7];
-
-	for (int i = 0; i < PARTITION_COUNT; i++)
-	{
-		gen_canonicalized_partition_table(texel_count, pi[i].partition_of_texel, canonicalizeds + i * 7);
-	}
-
-	for (int i = 0; i < PARTITION_COUNT; i++)
-	{
-		for (int j = 0; j < i; j++)
-		{
-			if (compare_canonicalized_partition_tables(canonicalizeds + 7 * i, canonicalizeds + 7 * j))
-			{
-				pi[i].partition_count = 0;
-				partition_tables_zapped++;
-				break;
-			}
-		}
-	}
-
-	delete[] canonicalizeds;
-}
-
 static uint32_t hash52(uint32_t inp)
 {
 	inp ^= inp >> 15;
@@ -247,6 +219,8 @@ static void generate_one_partition_table(
 	int texels_per_block = bsd->texel_count;
 	int small_block = texels_per_block < 32;
 
+	pt->partition_index = (uint16_t)partition_index;
+
 	uint8_t *partition_of_texel = pt->partition_of_texel;
 
 	for (int z = 0; z < bsd->zdim; z++)
@@ -312,24 +286,217 @@ static void generate_one_partition_table(
 	}
 }
 
+/**
+ * @brief Test if a partitioning is worth searching.
+ *
+ * A partitioning is not worth searching if it leaves a partition empty, or if
+ * it is a relabeling of a partitioning with a lower partition index.
+ *
+ * @param partition_count  The partition count.
+ * @param index            The partition index to test.
+ * @param canonicalizeds   The canonicalized tables for all partition indices.
+ * @param pi               The partition tables for all partition indices.
+ *
+ * @return @c true if the partitioning should be searched.
+ */
+static bool is_searchable_partitioning(
+	int partition_count,
+	int index,
+	const uint64_t* canonicalizeds,
+	const partition_info* pi
+) {
+	if (pi[index].partition_count < partition_count)
+	{
+		return false;
+	}
+
+	for (int j = 0; j < index; j++)
+	{
+		if (compare_canonicalized_partition_tables(canonicalizeds + 7 * index, canonicalizeds + 7 * j))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Build the packed partition tables for a single partition count.
+ *
+ * Searchable partitionings are stored first in partition index order, then
+ * any other partitioning that is not an exact duplicate of a stored one.
+ *
+ * @param bsd              The block size descriptor to populate.
+ * @param partition_count  The partition count.
+ * @param pi               The partition tables for all partition indices.
+ * @param packed           The output packed table array.
+ *
+ * @return The number of packed tables written.
+ */
+static int pack_partition_tables(
+	block_size_descriptor& bsd,
+	int partition_count,
+	const partition_info* pi,
+	partition_info* packed
+) {
+	int texel_count = bsd.texel_count;
+	uint16_t* packed_index = bsd.partitioning_packed_index[partition_count - 2];
+
+	uint64_t *canonicalizeds = new uint64_t[PARTITION_COUNT * 7];
+	bool* searchable = new bool[PARTITION_COUNT];
+
+	for (int i = 0; i < PARTITION_COUNT; i++)
+	{
+		gen_canonicalized_partition_table(texel_count, pi[i].partition_of_texel, canonicalizeds + i * 7);
+	}
+
+	int packed_count = 0;
+	for (int i = 0; i < PARTITION_COUNT; i++)
+	{
+		searchable[i] = is_searchable_partitioning(partition_count, i, canonicalizeds, pi);
+		if (searchable[i])
+		{
+			packed_index[i] = (uint16_t)packed_count;
+			packed[packed_count++] = pi[i];
+		}
+	}
+
+	bsd.partitioning_count[partition_count - 1] = packed_count;
+
+	// Other partitionings may still be used by blocks from other compressors
+	for (int i = 0; i < PARTITION_COUNT; i++)
+	{
+		if (searchable[i])
+		{
+			continue;
+		}
+
+		int j = 0;
+		for (; j < packed_count; j++)
+		{
+			if (!memcmp(packed[j].partition_of_texel, pi[i].partition_of_texel, texel_count))
+			{
+				break;
+			}
+		}
+
+		packed_index[i] = (uint16_t)j;
+		if (j == packed_count)
+		{
+			packed[packed_count++] = pi[i];
+		}
+	}
+
+	delete[] searchable;
+	delete[] canonicalizeds;
+	return packed_count;
+}
+
 /* Public function, see header file for detailed documentation */
 void init_partition_tables(
 	block_size_descriptor* bsd
 ) {
-	partition_info *par_tab2 = bsd->partitions;
-	partition_info *par_tab3 = par_tab2 + PARTITION_COUNT;
-	partition_info *par_tab4 = par_tab3 + PARTITION_COUNT;
-	partition_info *par_tab1 = par_tab4 + PARTITION_COUNT;
+	// Lazy BSDs only build the single partition table up front
+	if (bsd->lazy_tables)
+	{
+		bsd->partitions = new partition_info[1];
+		generate_one_partition_table(bsd, 1, 0, bsd->partitions);
+
+		bsd->partitioning_count[0] = 1;
+		bsd->partitioning_tables[0] = bsd->partitions;
+		for (int i = 1; i < 4; i++)
+		{
+			bsd->partitioning_count[i] = 0;
+			bsd->partitioning_tables[i] = nullptr;
+			bsd->partitioning_coverage[i - 1] = nullptr;
+		}
+
+		return;
+	}
+
+	partition_info *par_tab = new partition_info[PARTITION_COUNT];
+	partition_info *packed = new partition_info[(3 * PARTITION_COUNT) + 1];
 
-	generate_one_partition_table(bsd, 1, 0, par_tab1);
-	for (int i = 0; i < 1024; i++)
+	generate_one_partition_table(bsd, 1, 0, packed);
+	bsd->partitioning_count[0] = 1;
+
+	int offsets[4];
+	int packed_count = 1;
+	for (int partition_count = 2; partition_count <= 4; partition_count++)
 	{
-		generate_one_partition_table(bsd, 2, i, par_tab2 + i);
-		generate_one_partition_table(bsd, 3, i, par_tab3 + i);
-		generate_one_partition_table(bsd, 4, i, par_tab4 + i);
+		for (int i = 0; i < PARTITION_COUNT; i++)
+		{
+			generate_one_partition_table(bsd, partition_count, i, par_tab + i);
+		}
+
+		offsets[partition_count - 1] = packed_count;
+		packed_count += pack_partition_tables(*bsd, partition_count, par_tab, packed + packed_count);
+	}
+
+	// Copy into a compact array holding only the unique partitionings
+	bsd->partitions = new partition_info[packed_count];
+	for (int i = 0; i < packed_count; i++)
+	{
+		bsd->partitions[i] = packed[i];
+	}
+
+	bsd->partitioning_tables[0] = bsd->partitions;
+	for (int i = 1; i < 4; i++)
+	{
+		bsd->partitioning_tables[i] = bsd->partitions + offsets[i];
+	}
+
+	// Transpose the coverage bitmaps into planes for vectorized scoring
+	for (int partition_count = 2; partition_count <= 4; partition_count++)
+	{
+		const partition_info* pi = bsd->partitioning_tables[partition_count - 1];
+		int search_count = bsd->partitioning_count[partition_count - 1];
+		int stride = round_up_to_simd_multiple_vla(search_count);
+
+		size_t plane_count = 2 * partition_count;
+		int* coverage = aligned_malloc<int>(sizeof(int) * plane_count * stride, ASTCENC_VECALIGN);
+		memset(coverage, 0, sizeof(int) * plane_count * stride);
+
+		for (int i = 0; i < search_count; i++)
+		{
+			for (int j = 0; j < partition_count; j++)
+			{
+				uint64_t bitmap = pi[i].coverage_bitmaps[j];
+				coverage[(2 * j) * stride + i] = static_cast<int>(static_cast<uint32_t>(bitmap));
+				coverage[(2 * j + 1) * stride + i] = static_cast<int>(static_cast<uint32_t>(bitmap >> 32));
+			}
+		}
+
+		bsd->partitioning_coverage[partition_count - 2] = coverage;
+	}
+
+	delete[] packed;
+	delete[] par_tab;
+}
+
+/* Public function, see header file for detailed documentation */
+const partition_info* init_lazy_partition_info(
+	const block_size_descriptor& bsd,
+	int partition_count,
+	int index
+) {
+	assert(bsd.lazy_tables);
+	assert(partition_count >= 2 && partition_count <= 4);
+
+	partition_info* pt = new partition_info;
+	generate_one_partition_table(&bsd, partition_count, index, pt);
+
+	// If another thread published a table first then use theirs and drop ours
+	const partition_info* expected = nullptr;
+	if (!bsd.lazy_partitions[partition_count - 2][index].compare_exchange_strong(
+	        expected, pt, std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		delete pt;
+		return expected;
 	}
 
-	partition_table_zap_equal_elements(bsd->texel_count, par_tab2);
-	partition_table_zap_equal_elements(bsd->texel_count, par_tab3);
-	partition_table_zap_equal_elements(bsd->texel_count, par_tab4);
+	return pt;
 }
+
+ASTCENC_NAMESPACE_END
@@ -24,6 +24,8 @@
 
 #include "astcenc_internal.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 #if !defined(ASTCENC_DECOMPRESS_ONLY)
 /**
  * @brief Structure containing packed percentile metadata.
@@ -1202,3 +1204,5 @@ int is_legal_3d_block_size(
 			return 0;
 	}
 }
+
+ASTCENC_NAMESPACE_END
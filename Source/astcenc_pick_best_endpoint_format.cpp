@@ -26,12 +26,27 @@
 
 #include <assert.h>
 
+ASTCENC_NAMESPACE_BEGIN
+
 /*
    functions to determine, for a given partitioning, which color endpoint formats are the best to use.
  */
 
+// The endpoint format error tables store one row per integer count, with each
+// row holding all of the quantization levels. Rows are padded to a whole
+// number of SIMD vectors so that quantization levels can be processed a
+// vector at a time.
+#define QUANT_LEVELS_PADDED (((21 + ASTCENC_SIMD_WIDTH - 1) / ASTCENC_SIMD_WIDTH) * ASTCENC_SIMD_WIDTH)
+
+// The number of color bitcounts that a block mode can leave for the endpoints.
+#define COLOR_BITCOUNT_LIMIT 128
+
 // for a given partition, compute for every (integer-component-count, quantization-level)
 // the color error.
+//
+// Formats are returned shifted into the byte of the packed format word that
+// belongs to the partition, so that the formats of a multi-partition
+// combination can be packed using a bitwise OR.
 static void compute_color_error_for_every_integer_count_and_quant_level(
 	int encode_hdr_rgb,	// 1 = perform HDR encoding, 0 = perform LDR encoding.
 	int encode_hdr_alpha,
@@ -40,13 +55,14 @@ static void compute_color_error_for_every_integer_count_and_quant_level(
 	const encoding_choice_errors* eci,	// pointer to the structure for the CURRENT partition.
 	const endpoints* ep,
 	vfloat4 error_weightings[4],
-	// arrays to return results back through.
-	float best_error[21][4],
-	int format_of_choice[21][4]
+	// arrays to return results back through, indexed by (integer-pair-count-minus-1, quant-level)
+	float best_error[4][QUANT_LEVELS_PADDED],
+	int format_of_choice[4][QUANT_LEVELS_PADDED]
 ) {
 	int partition_size = pi->texels_per_partition[partition_index];
+	int format_shift = 8 * partition_index;
 
-	static const float baseline_quant_error[21] = {
+	alignas(ASTCENC_VECALIGN) static const float baseline_quant_error[QUANT_LEVELS_PADDED] = {
 		(65536.0f * 65536.0f / 18.0f),				// 2 values, 1 step
 		(65536.0f * 65536.0f / 18.0f) / (2 * 2),	// 3 values, 2 steps
 		(65536.0f * 65536.0f / 18.0f) / (3 * 3),	// 4 values, 3 steps
@@ -239,210 +255,163 @@ static void compute_color_error_for_every_integer_count_and_quant_level(
 
 		mode23mult *= 0.0005f;	// empirically determined ....
 
+		vfloat rgb_error_weight(error_weight_rgbsum);
+		vfloat alpha_error_weight(error_weight.lane<3>());
+		vfloat texel_count(static_cast<float>(partition_size));
+
+		vint hdr_rgba_format((encode_hdr_alpha ? FMT_HDR_RGBA : FMT_HDR_RGB_LDR_ALPHA) << format_shift);
+		vint hdr_rgb_format(FMT_HDR_RGB << format_shift);
+		vint hdr_rgb_scale_format(FMT_HDR_RGB_SCALE << format_shift);
+		vint hdr_luminance_format(FMT_HDR_LUMINANCE_LARGE_RANGE << format_shift);
+
 		// pick among the available HDR endpoint modes
-		for (int i = 0; i < 8; i++)
+		vint lane_ids = vint::lane_id();
+		for (int i = 0; i < QUANT_LEVELS_PADDED; i += ASTCENC_SIMD_WIDTH)
 		{
-			best_error[i][3] = 1e30f;
-			format_of_choice[i][3] = encode_hdr_alpha ? FMT_HDR_RGBA : FMT_HDR_RGB_LDR_ALPHA;
-			best_error[i][2] = 1e30f;
-			format_of_choice[i][2] = FMT_HDR_RGB;
-			best_error[i][1] = 1e30f;
-			format_of_choice[i][1] = FMT_HDR_RGB_SCALE;
-			best_error[i][0] = 1e30f;
-			format_of_choice[i][0] = FMT_HDR_LUMINANCE_LARGE_RANGE;
-		}
+			// HDR endpoints can only use quantization levels 8 and up
+			vmask usable = (lane_ids > vint(7)) & (lane_ids < vint(21));
 
-		for (int i = 8; i < 21; i++)
-		{
 			// base_quant_error should depend on the scale-factor that would be used
 			// during actual encode of the color value.
 
-			float base_quant_error = baseline_quant_error[i] * static_cast<float>(partition_size);
-			float rgb_quantization_error = error_weight_rgbsum * base_quant_error * 2.0f;
-			float alpha_quantization_error = error_weight.lane<3>() * base_quant_error * 2.0f;
-			float rgba_quantization_error = rgb_quantization_error + alpha_quantization_error;
+			vfloat base_quant_error = loada(baseline_quant_error + i) * texel_count;
+			vfloat rgb_quantization_error = rgb_error_weight * base_quant_error * vfloat(2.0f);
+			vfloat alpha_quantization_error = alpha_error_weight * base_quant_error * vfloat(2.0f);
+			vfloat rgba_quantization_error = rgb_quantization_error + alpha_quantization_error;
 
 			// for 8 integers, we have two encodings: one with HDR alpha and another one
 			// with LDR alpha.
 
-			float full_hdr_rgba_error = rgba_quantization_error + rgb_range_error + alpha_range_error;
-			best_error[i][3] = full_hdr_rgba_error;
-			format_of_choice[i][3] = encode_hdr_alpha ? FMT_HDR_RGBA : FMT_HDR_RGB_LDR_ALPHA;
+			vfloat full_hdr_rgba_error = rgba_quantization_error + vfloat(rgb_range_error) + vfloat(alpha_range_error);
+			storea(select(vfloat(1e30f), full_hdr_rgba_error, usable), best_error[3] + i);
+			storea(hdr_rgba_format, format_of_choice[3] + i);
 
 			// for 6 integers, we have one HDR-RGB encoding
-			float full_hdr_rgb_error = (rgb_quantization_error * mode11mult) + rgb_range_error + eci->alpha_drop_error;
-			best_error[i][2] = full_hdr_rgb_error;
-			format_of_choice[i][2] = FMT_HDR_RGB;
+			vfloat full_hdr_rgb_error = (rgb_quantization_error * vfloat(mode11mult)) + vfloat(rgb_range_error) + vfloat(eci->alpha_drop_error);
+			storea(select(vfloat(1e30f), full_hdr_rgb_error, usable), best_error[2] + i);
+			storea(hdr_rgb_format, format_of_choice[2] + i);
 
 			// for 4 integers, we have one HDR-RGB-Scale encoding
-			float hdr_rgb_scale_error = (rgb_quantization_error * mode7mult) + rgb_range_error + eci->alpha_drop_error + eci->rgb_luma_error;
-
-			best_error[i][1] = hdr_rgb_scale_error;
-			format_of_choice[i][1] = FMT_HDR_RGB_SCALE;
+			vfloat hdr_rgb_scale_error = (rgb_quantization_error * vfloat(mode7mult)) + vfloat(rgb_range_error) + vfloat(eci->alpha_drop_error) + vfloat(eci->rgb_luma_error);
+			storea(select(vfloat(1e30f), hdr_rgb_scale_error, usable), best_error[1] + i);
+			storea(hdr_rgb_scale_format, format_of_choice[1] + i);
 
 			// for 2 integers, we assume luminance-with-large-range
-			float hdr_luminance_error = (rgb_quantization_error * mode23mult) + rgb_range_error + eci->alpha_drop_error + eci->luminance_error;
-			best_error[i][0] = hdr_luminance_error;
-			format_of_choice[i][0] = FMT_HDR_LUMINANCE_LARGE_RANGE;
+			vfloat hdr_luminance_error = (rgb_quantization_error * vfloat(mode23mult)) + vfloat(rgb_range_error) + vfloat(eci->alpha_drop_error) + vfloat(eci->luminance_error);
+			storea(select(vfloat(1e30f), hdr_luminance_error, usable), best_error[0] + i);
+			storea(hdr_luminance_format, format_of_choice[0] + i);
+
+			lane_ids = lane_ids + vint(ASTCENC_SIMD_WIDTH);
 		}
 	}
 	else
 	{
-		for (int i = 0; i < 4; i++)
-		{
-			best_error[i][3] = 1e30f;
-			best_error[i][2] = 1e30f;
-			best_error[i][1] = 1e30f;
-			best_error[i][0] = 1e30f;
-
-			format_of_choice[i][3] = FMT_RGBA;
-			format_of_choice[i][2] = FMT_RGB;
-			format_of_choice[i][1] = FMT_RGB_SCALE;
-			format_of_choice[i][0] = FMT_LUMINANCE;
-		}
+		vfloat rgb_error_weight(error_weight_rgbsum);
+		vfloat alpha_error_weight(error_weight.lane<3>());
+		vfloat texel_count(static_cast<float>(partition_size));
 
 		// pick among the available LDR endpoint modes
-		for (int i = 4; i < 21; i++)
+		vint lane_ids = vint::lane_id();
+		for (int i = 0; i < QUANT_LEVELS_PADDED; i += ASTCENC_SIMD_WIDTH)
 		{
-			float base_quant_error = baseline_quant_error[i] * static_cast<float>(partition_size);
-			float rgb_quantization_error = error_weight_rgbsum * base_quant_error;
-			float alpha_quantization_error = error_weight.lane<3>() * base_quant_error;
-			float rgba_quantization_error = rgb_quantization_error + alpha_quantization_error;
+			// LDR endpoints can only use quantization levels 4 and up
+			vmask usable = (lane_ids > vint(3)) & (lane_ids < vint(21));
+
+			vfloat base_quant_error = loada(baseline_quant_error + i) * texel_count;
+			vfloat rgb_quantization_error = rgb_error_weight * base_quant_error;
+			vfloat alpha_quantization_error = alpha_error_weight * base_quant_error;
+			vfloat rgba_quantization_error = rgb_quantization_error + alpha_quantization_error;
 
 			// for 8 integers, the available encodings are:
 			// full LDR RGB-Alpha
-			float full_ldr_rgba_error = rgba_quantization_error;
+			vfloat full_ldr_rgba_error = rgba_quantization_error;
 
 			if (eci->can_blue_contract)
 			{
-				full_ldr_rgba_error *= 0.625f;
+				full_ldr_rgba_error = full_ldr_rgba_error * vfloat(0.625f);
 			}
 
-			if (eci->can_offset_encode && i <= 18)
+			if (eci->can_offset_encode)
 			{
-				full_ldr_rgba_error *= 0.5f;
+				vmask offset_encodable = lane_ids < vint(19);
+				full_ldr_rgba_error = select(full_ldr_rgba_error, full_ldr_rgba_error * vfloat(0.5f), offset_encodable);
 			}
 
-			full_ldr_rgba_error += rgb_range_error + alpha_range_error;
+			full_ldr_rgba_error = full_ldr_rgba_error + vfloat(rgb_range_error + alpha_range_error);
 
-			best_error[i][3] = full_ldr_rgba_error;
-			format_of_choice[i][3] = FMT_RGBA;
+			storea(select(vfloat(1e30f), full_ldr_rgba_error, usable), best_error[3] + i);
+			storea(vint(FMT_RGBA << format_shift), format_of_choice[3] + i);
 
 			// for 6 integers, we have:
 			// - an LDR-RGB encoding
 			// - an RGBS + Alpha encoding (LDR)
 
-			float full_ldr_rgb_error = rgb_quantization_error;
+			vfloat full_ldr_rgb_error = rgb_quantization_error;
 
 			if (eci->can_blue_contract)
 			{
-				full_ldr_rgb_error *= 0.5f;
+				full_ldr_rgb_error = full_ldr_rgb_error * vfloat(0.5f);
 			}
 
-			if (eci->can_offset_encode && i <= 18)
+			if (eci->can_offset_encode)
 			{
-				full_ldr_rgb_error *= 0.25f;
+				vmask offset_encodable = lane_ids < vint(19);
+				full_ldr_rgb_error = select(full_ldr_rgb_error, full_ldr_rgb_error * vfloat(0.25f), offset_encodable);
 			}
 
-			full_ldr_rgb_error += eci->alpha_drop_error + rgb_range_error;
+			full_ldr_rgb_error = full_ldr_rgb_error + vfloat(eci->alpha_drop_error + rgb_range_error);
 
-			float rgbs_alpha_error = rgba_quantization_error + eci->rgb_scale_error + rgb_range_error + alpha_range_error;
+			vfloat rgbs_alpha_error = rgba_quantization_error + vfloat(eci->rgb_scale_error) + vfloat(rgb_range_error) + vfloat(alpha_range_error);
 
-			if (rgbs_alpha_error < full_ldr_rgb_error)
-			{
-				best_error[i][2] = rgbs_alpha_error;
-				format_of_choice[i][2] = FMT_RGB_SCALE_ALPHA;
-			}
-			else
-			{
-				best_error[i][2] = full_ldr_rgb_error;
-				format_of_choice[i][2] = FMT_RGB;
-			}
+			vmask use_rgbs_alpha = rgbs_alpha_error < full_ldr_rgb_error;
+			vfloat error6 = select(full_ldr_rgb_error, rgbs_alpha_error, use_rgbs_alpha);
+			vint format6 = select(vint(FMT_RGB << format_shift), vint(FMT_RGB_SCALE_ALPHA << format_shift), use_rgbs_alpha);
+			storea(select(vfloat(1e30f), error6, usable), best_error[2] + i);
+			storea(format6, format_of_choice[2] + i);
 
 			// for 4 integers, we have a Luminance-Alpha encoding and the RGBS encoding
-			float ldr_rgbs_error = rgb_quantization_error + eci->alpha_drop_error + eci->rgb_scale_error + rgb_range_error;
+			vfloat ldr_rgbs_error = rgb_quantization_error + vfloat(eci->alpha_drop_error) + vfloat(eci->rgb_scale_error) + vfloat(rgb_range_error);
 
-			float lum_alpha_error = rgba_quantization_error + eci->luminance_error + rgb_range_error + alpha_range_error;
+			vfloat lum_alpha_error = rgba_quantization_error + vfloat(eci->luminance_error) + vfloat(rgb_range_error) + vfloat(alpha_range_error);
 
-			if (ldr_rgbs_error < lum_alpha_error)
-			{
-				best_error[i][1] = ldr_rgbs_error;
-				format_of_choice[i][1] = FMT_RGB_SCALE;
-			}
-			else
-			{
-				best_error[i][1] = lum_alpha_error;
-				format_of_choice[i][1] = FMT_LUMINANCE_ALPHA;
-			}
+			vmask use_rgbs = ldr_rgbs_error < lum_alpha_error;
+			vfloat error4 = select(lum_alpha_error, ldr_rgbs_error, use_rgbs);
+			vint format4 = select(vint(FMT_LUMINANCE_ALPHA << format_shift), vint(FMT_RGB_SCALE << format_shift), use_rgbs);
+			storea(select(vfloat(1e30f), error4, usable), best_error[1] + i);
+			storea(format4, format_of_choice[1] + i);
 
 			// for 2 integers, we have a Luminance-encoding and an Alpha-encoding.
-			float luminance_error = rgb_quantization_error + eci->alpha_drop_error + eci->luminance_error + rgb_range_error;
+			vfloat luminance_error = rgb_quantization_error + vfloat(eci->alpha_drop_error) + vfloat(eci->luminance_error) + vfloat(rgb_range_error);
 
-			best_error[i][0] = luminance_error;
-			format_of_choice[i][0] = FMT_LUMINANCE;
-		}
-	}
-}
+			storea(select(vfloat(1e30f), luminance_error, usable), best_error[0] + i);
+			storea(vint(FMT_LUMINANCE << format_shift), format_of_choice[0] + i);
 
-// for 1 partition, find the best combination (one format + a quantization level) for a given bitcount
-static void one_partition_find_best_combination_for_bitcount(
-	float combined_best_error[21][4],
-	int formats_of_choice[21][4],
-	int bits_available,
-	int* best_quant_level,
-	int* best_formats,
-	float* error_of_best_combination
-) {
-	int best_integer_count = -1;
-	float best_integer_count_error = 1e20f;
-	for (int i = 0; i < 4; i++)
-	{
-		// compute the quantization level for a given number of integers and a given number of bits.
-		int quant_level = quant_mode_table[i + 1][bits_available];
-
-		if (quant_level == -1)
-		{
-			continue;			// used to indicate the case where we don't have enough bits to represent a given endpoint format at all.
-		}
-
-		if (combined_best_error[quant_level][i] < best_integer_count_error)
-		{
-			best_integer_count_error = combined_best_error[quant_level][i];
-			best_integer_count = i;
+			lane_ids = lane_ids + vint(ASTCENC_SIMD_WIDTH);
 		}
 	}
-
-	int ql = quant_mode_table[best_integer_count + 1][bits_available];
-
-	*best_quant_level = ql;
-	*error_of_best_combination = best_integer_count_error;
-	if (ql >= 0)
-	{
-		*best_formats = formats_of_choice[ql][best_integer_count];
-	}
-	else
-	{
-		*best_formats = FMT_LUMINANCE;
-	}
 }
 
 // for 2 partitions, find the best format combinations for every (quantization-mode, integer-count) combination
 static void two_partitions_find_best_combination_for_every_quantization_and_integer_count(
-	float best_error[2][21][4],	// indexed by (partition, quant-level, integer-pair-count-minus-1)
-	int format_of_choice[2][21][4],
-	float combined_best_error[21][7],	// indexed by (quant-level, integer-pair-count-minus-2)
-	int formats_of_choice[21][7][2]
+	float best_error[2][4][QUANT_LEVELS_PADDED],	// indexed by (partition, integer-pair-count-minus-1, quant-level)
+	int format_of_choice[2][4][QUANT_LEVELS_PADDED],
+	float combined_best_error[7][QUANT_LEVELS_PADDED],	// indexed by (integer-pair-count-minus-2, quant-level)
+	int formats_of_choice[7][QUANT_LEVELS_PADDED]
 ) {
-	for (int i = 0; i < 21; i++)
+	vint lane_ids = vint::lane_id();
+	for (int quant = 0; quant < QUANT_LEVELS_PADDED; quant += ASTCENC_SIMD_WIDTH)
 	{
-		for (int j = 0; j < 7; j++)
+		// multi-partition encodings can only use quantization levels 5 and up
+		vmask usable = lane_ids > vint(4);
+
+		vfloat combined_error[7];
+		vint combined_formats[7];
+		for (int i = 0; i < 7; i++)
 		{
-			combined_best_error[i][j] = 1e30f;
+			combined_error[i] = vfloat(1e30f);
+			combined_formats[i] = vint(0);
 		}
-	}
 
-	for (int quant = 5; quant < 21; quant++)
-	{
 		for (int i = 0; i < 4; i++)	// integer-count for first endpoint-pair
 		{
 			for (int j = 0; j < 4; j++)	// integer-count for second endpoint-pair
@@ -455,89 +424,46 @@ static void two_partitions_find_best_combination_for_every_quantization_and_inte
 				}
 
 				int intcnt = i + j;
-				float errorterm = astc::min(best_error[0][quant][i] + best_error[1][quant][j], 1e10f);
-				if (errorterm <= combined_best_error[quant][intcnt])
-				{
-					combined_best_error[quant][intcnt] = errorterm;
-					formats_of_choice[quant][intcnt][0] = format_of_choice[0][quant][i];
-					formats_of_choice[quant][intcnt][1] = format_of_choice[1][quant][j];
-				}
+				vfloat errorterm = min(loada(best_error[0][i] + quant) + loada(best_error[1][j] + quant), vfloat(1e10f));
+				vmask better = (errorterm <= combined_error[intcnt]) & usable;
+				combined_error[intcnt] = select(combined_error[intcnt], errorterm, better);
+
+				vint formats = vint::loada(format_of_choice[0][i] + quant) | vint::loada(format_of_choice[1][j] + quant);
+				combined_formats[intcnt] = select(combined_formats[intcnt], formats, better);
 			}
 		}
-	}
-}
-
-// for 2 partitions, find the best combination (two formats + a quantization level) for a given bitcount
-static void two_partitions_find_best_combination_for_bitcount(
-	float combined_best_error[21][7],
-	int formats_of_choice[21][7][2],
-	int bits_available,
-	int* best_quant_level,
-	int* best_quant_level_mod,
-	int* best_formats,
-	float* error_of_best_combination
-) {
-	int best_integer_count = 0;
-	float best_integer_count_error = 1e20f;
 
-	for (int integer_count = 2; integer_count <= 8; integer_count++)
-	{
-		// compute the quantization level for a given number of integers and a given number of bits.
-		int quant_level = quant_mode_table[integer_count][bits_available];
-
-		if (quant_level == -1)
+		for (int i = 0; i < 7; i++)
 		{
-			break;				// used to indicate the case where we don't have enough bits to represent a given endpoint format at all.
+			storea(combined_error[i], combined_best_error[i] + quant);
+			storea(combined_formats[i], formats_of_choice[i] + quant);
 		}
 
-		float integer_count_error = combined_best_error[quant_level][integer_count - 2];
-
-		if (integer_count_error < best_integer_count_error)
-		{
-			best_integer_count_error = integer_count_error;
-			best_integer_count = integer_count;
-		}
-	}
-
-	int ql = quant_mode_table[best_integer_count][bits_available];
-	int ql_mod = quant_mode_table[best_integer_count][bits_available + 2];
-
-	*best_quant_level = ql;
-	*best_quant_level_mod = ql_mod;
-	*error_of_best_combination = best_integer_count_error;
-	if (ql >= 0)
-	{
-		for (int i = 0; i < 2; i++)
-		{
-			best_formats[i] = formats_of_choice[ql][best_integer_count - 2][i];
-		}
-	}
-	else
-	{
-		for (int i = 0; i < 2; i++)
-		{
-			best_formats[i] = FMT_LUMINANCE;
-		}
+		lane_ids = lane_ids + vint(ASTCENC_SIMD_WIDTH);
 	}
 }
 
 // for 3 partitions, find the best format combinations for every (quantization-mode, integer-count) combination
 static void three_partitions_find_best_combination_for_every_quantization_and_integer_count(
-	float best_error[3][21][4],	// indexed by (partition, quant-level, integer-count)
-	int format_of_choice[3][21][4],
-	float combined_best_error[21][10],
-	int formats_of_choice[21][10][3]
+	float best_error[3][4][QUANT_LEVELS_PADDED],	// indexed by (partition, integer-pair-count-minus-1, quant-level)
+	int format_of_choice[3][4][QUANT_LEVELS_PADDED],
+	float combined_best_error[10][QUANT_LEVELS_PADDED],	// indexed by (integer-pair-count-minus-3, quant-level)
+	int formats_of_choice[10][QUANT_LEVELS_PADDED]
 ) {
-	for (int i = 0; i < 21; i++)
+	vint lane_ids = vint::lane_id();
+	for (int quant = 0; quant < QUANT_LEVELS_PADDED; quant += ASTCENC_SIMD_WIDTH)
 	{
-		for (int j = 0; j < 10; j++)
+		// multi-partition encodings can only use quantization levels 5 and up
+		vmask usable = lane_ids > vint(4);
+
+		vfloat combined_error[10];
+		vint combined_formats[10];
+		for (int i = 0; i < 10; i++)
 		{
-			combined_best_error[i][j] = 1e30f;
+			combined_error[i] = vfloat(1e30f);
+			combined_formats[i] = vint(0);
 		}
-	}
 
-	for (int quant = 5; quant < 21; quant++)
-	{
 		for (int i = 0; i < 4; i++)	// integer-count for first endpoint-pair
 		{
 			for (int j = 0; j < 4; j++)	// integer-count for second endpoint-pair
@@ -549,6 +475,9 @@ static void three_partitions_find_best_combination_for_every_quantization_and_in
 					continue;
 				}
 
+				vfloat error2 = loada(best_error[0][i] + quant) + loada(best_error[1][j] + quant);
+				vint formats2 = vint::loada(format_of_choice[0][i] + quant) | vint::loada(format_of_choice[1][j] + quant);
+
 				for (int k = 0; k < 4; k++)	// integer-count for third endpoint-pair
 				{
 					int low3 = astc::min(k, low2);
@@ -559,91 +488,47 @@ static void three_partitions_find_best_combination_for_every_quantization_and_in
 					}
 
 					int intcnt = i + j + k;
-					float errorterm = astc::min(best_error[0][quant][i] + best_error[1][quant][j] + best_error[2][quant][k], 1e10f);
-					if (errorterm <= combined_best_error[quant][intcnt])
-					{
-						combined_best_error[quant][intcnt] = errorterm;
-						formats_of_choice[quant][intcnt][0] = format_of_choice[0][quant][i];
-						formats_of_choice[quant][intcnt][1] = format_of_choice[1][quant][j];
-						formats_of_choice[quant][intcnt][2] = format_of_choice[2][quant][k];
-					}
+					vfloat errorterm = min(error2 + loada(best_error[2][k] + quant), vfloat(1e10f));
+					vmask better = (errorterm <= combined_error[intcnt]) & usable;
+					combined_error[intcnt] = select(combined_error[intcnt], errorterm, better);
+
+					vint formats = formats2 | vint::loada(format_of_choice[2][k] + quant);
+					combined_formats[intcnt] = select(combined_formats[intcnt], formats, better);
 				}
 			}
 		}
-	}
-}
 
-// for 3 partitions, find the best combination (three formats + a quantization level) for a given bitcount
-static void three_partitions_find_best_combination_for_bitcount(
-	float combined_best_error[21][10],
-	int formats_of_choice[21][10][3],
-	int bits_available,
-	int* best_quant_level,
-	int* best_quant_level_mod,
-	int* best_formats,
-	float* error_of_best_combination
-) {
-	int best_integer_count = 0;
-	float best_integer_count_error = 1e20f;
-
-	for (int integer_count = 3; integer_count <= 9; integer_count++)
-	{
-		// compute the quantization level for a given number of integers and a given number of bits.
-		int quant_level = quant_mode_table[integer_count][bits_available];
-
-		if (quant_level == -1)
+		for (int i = 0; i < 10; i++)
 		{
-			break;				// used to indicate the case where we don't have enough bits to represent a given endpoint format at all.
+			storea(combined_error[i], combined_best_error[i] + quant);
+			storea(combined_formats[i], formats_of_choice[i] + quant);
 		}
 
-		float integer_count_error = combined_best_error[quant_level][integer_count - 3];
-
-		if (integer_count_error < best_integer_count_error)
-		{
-			best_integer_count_error = integer_count_error;
-			best_integer_count = integer_count;
-		}
-	}
-
-	int ql = quant_mode_table[best_integer_count][bits_available];
-	int ql_mod = quant_mode_table[best_integer_count][bits_available + 5];
-
-	*best_quant_level = ql;
-	*best_quant_level_mod = ql_mod;
-	*error_of_best_combination = best_integer_count_error;
-	if (ql >= 0)
-	{
-		for (int i = 0; i < 3; i++)
-		{
-			best_formats[i] = formats_of_choice[ql][best_integer_count - 3][i];
-		}
-	}
-	else
-	{
-		for (int i = 0; i < 3; i++)
-		{
-			best_formats[i] = FMT_LUMINANCE;
-		}
+		lane_ids = lane_ids + vint(ASTCENC_SIMD_WIDTH);
 	}
 }
 
 // for 4 partitions, find the best format combinations for every (quantization-mode, integer-count) combination
 static void four_partitions_find_best_combination_for_every_quantization_and_integer_count(
-	float best_error[4][21][4],	// indexed by (partition, quant-level, integer-count)
-	int format_of_choice[4][21][4],
-	float combined_best_error[21][13],
-	int formats_of_choice[21][13][4]
+	float best_error[4][4][QUANT_LEVELS_PADDED],	// indexed by (partition, integer-pair-count-minus-1, quant-level)
+	int format_of_choice[4][4][QUANT_LEVELS_PADDED],
+	float combined_best_error[13][QUANT_LEVELS_PADDED],	// indexed by (integer-pair-count-minus-4, quant-level)
+	int formats_of_choice[13][QUANT_LEVELS_PADDED]
 ) {
-	for (int i = 0; i < 21; i++)
+	vint lane_ids = vint::lane_id();
+	for (int quant = 0; quant < QUANT_LEVELS_PADDED; quant += ASTCENC_SIMD_WIDTH)
 	{
-		for (int j = 0; j < 13; j++)
+		// multi-partition encodings can only use quantization levels 5 and up
+		vmask usable = lane_ids > vint(4);
+
+		vfloat combined_error[13];
+		vint combined_formats[13];
+		for (int i = 0; i < 13; i++)
 		{
-			combined_best_error[i][j] = 1e30f;
+			combined_error[i] = vfloat(1e30f);
+			combined_formats[i] = vint(0);
 		}
-	}
 
-	for (int quant = 5; quant < 21; quant++)
-	{
 		for (int i = 0; i < 4; i++)	// integer-count for first endpoint-pair
 		{
 			for (int j = 0; j < 4; j++)	// integer-count for second endpoint-pair
@@ -655,6 +540,9 @@ static void four_partitions_find_best_combination_for_every_quantization_and_int
 					continue;
 				}
 
+				vfloat error2 = loada(best_error[0][i] + quant) + loada(best_error[1][j] + quant);
+				vint formats2 = vint::loada(format_of_choice[0][i] + quant) | vint::loada(format_of_choice[1][j] + quant);
+
 				for (int k = 0; k < 4; k++)	// integer-count for third endpoint-pair
 				{
 					int low3 = astc::min(k, low2);
@@ -664,6 +552,9 @@ static void four_partitions_find_best_combination_for_every_quantization_and_int
 						continue;
 					}
 
+					vfloat error3 = error2 + loada(best_error[2][k] + quant);
+					vint formats3 = formats2 | vint::loada(format_of_choice[2][k] + quant);
+
 					for (int l = 0; l < 4; l++)	// integer-count for fourth endpoint-pair
 					{
 						int low4 = astc::min(l, low3);
@@ -674,73 +565,88 @@ static void four_partitions_find_best_combination_for_every_quantization_and_int
 						}
 
 						int intcnt = i + j + k + l;
-						float errorterm = astc::min(best_error[0][quant][i] + best_error[1][quant][j] + best_error[2][quant][k] + best_error[3][quant][l], 1e10f);
-						if (errorterm <= combined_best_error[quant][intcnt])
-						{
-							combined_best_error[quant][intcnt] = errorterm;
-							formats_of_choice[quant][intcnt][0] = format_of_choice[0][quant][i];
-							formats_of_choice[quant][intcnt][1] = format_of_choice[1][quant][j];
-							formats_of_choice[quant][intcnt][2] = format_of_choice[2][quant][k];
-							formats_of_choice[quant][intcnt][3] = format_of_choice[3][quant][l];
-						}
+						vfloat errorterm = min(error3 + loada(best_error[3][l] + quant), vfloat(1e10f));
+						vmask better = (errorterm <= combined_error[intcnt]) & usable;
+						combined_error[intcnt] = select(combined_error[intcnt], errorterm, better);
+
+						vint formats = formats3 | vint::loada(format_of_choice[3][l] + quant);
+						combined_formats[intcnt] = select(combined_formats[intcnt], formats, better);
 					}
 				}
 			}
 		}
+
+		for (int i = 0; i < 13; i++)
+		{
+			storea(combined_error[i], combined_best_error[i] + quant);
+			storea(combined_formats[i], formats_of_choice[i] + quant);
+		}
+
+		lane_ids = lane_ids + vint(ASTCENC_SIMD_WIDTH);
 	}
 }
 
-// for 4 partitions, find the best combination (four formats + a quantization level) for a given bitcount
-static void four_partitions_find_best_combination_for_bitcount(
-	float combined_best_error[21][13],
-	int formats_of_choice[21][13][4],
-	int bits_available,
-	int* best_quant_level,
-	int* best_quant_level_mod,
-	int* best_formats,
-	float* error_of_best_combination
+// for a given partition count, find the best combination (formats + a quantization level)
+// for every color bitcount that a block mode can leave for the endpoints.
+//
+// The best combination only depends on the bitcount and not on the block mode itself,
+// so this replaces a search per block mode with a table lookup per block mode.
+static void find_best_combination_for_every_bitcount(
+	int partition_count,
+	float combined_best_error[][QUANT_LEVELS_PADDED],	// indexed by (integer-pair-count-minus-partition-count, quant-level)
+	int formats_of_choice[][QUANT_LEVELS_PADDED],
+	// arrays to return results back through, indexed by bitcount
+	float best_error[COLOR_BITCOUNT_LIMIT],
+	int best_quant_level[COLOR_BITCOUNT_LIMIT],
+	int best_quant_level_mod[COLOR_BITCOUNT_LIMIT],
+	int best_formats[COLOR_BITCOUNT_LIMIT]
 ) {
-	int best_integer_count = 0;
-	float best_integer_count_error = 1e20f;
+	// the largest integer-pair count, and the number of bits saved by
+	// using the same format for all partitions, indexed by partition count
+	static const int max_integer_count[4] { 4, 8, 9, 9 };
+	static const int mod_bits[4] { 0, 2, 5, 8 };
 
-	for (int integer_count = 4; integer_count <= 9; integer_count++)
+	int low_integer_count = partition_count;
+	int high_integer_count = max_integer_count[partition_count - 1];
+	int extra_bits = mod_bits[partition_count - 1];
+
+	for (int bits = 0; bits < COLOR_BITCOUNT_LIMIT; bits += ASTCENC_SIMD_WIDTH)
 	{
-		// compute the quantization level for a given number of integers and a given number of bits.
-		int quant_level = quant_mode_table[integer_count][bits_available];
+		// quant_mode_table uses -1 to indicate the case where we don't have enough bits to
+		// represent a given endpoint format at all; integer count 0 is always such a case
+		vint best_integer_count_ql(-1);
+		vint best_integer_count_ql_mod(-1);
+		vint best_integer_count_index(0);
+		vfloat best_integer_count_error(1e20f);
 
-		if (quant_level == -1)
+		for (int integer_count = low_integer_count; integer_count <= high_integer_count; integer_count++)
 		{
-			break;				// used to indicate the case where we don't have enough bits to represent a given endpoint format at all.
-		}
+			// compute the quantization level for a given number of integers and a given number of bits.
+			vint ql(reinterpret_cast<const uint8_t*>(&quant_mode_table[integer_count][bits]));
+			vint ql_mod(reinterpret_cast<const uint8_t*>(&quant_mode_table[integer_count][bits + extra_bits]));
+			ql = select(ql, vint(-1), ql == vint(255));
+			ql_mod = select(ql_mod, vint(-1), ql_mod == vint(255));
 
-		float integer_count_error = combined_best_error[quant_level][integer_count - 4];
+			vmask usable = ql > vint(-1);
+			vint index = vint((integer_count - partition_count) * QUANT_LEVELS_PADDED) + ql;
+			index = select(vint(0), index, usable);
 
-		if (integer_count_error < best_integer_count_error)
-		{
-			best_integer_count_error = integer_count_error;
-			best_integer_count = integer_count;
+			vfloat integer_count_error = gatherf(&combined_best_error[0][0], index);
+			vmask better = (integer_count_error < best_integer_count_error) & usable;
+
+			best_integer_count_error = select(best_integer_count_error, integer_count_error, better);
+			best_integer_count_ql = select(best_integer_count_ql, ql, better);
+			best_integer_count_ql_mod = select(best_integer_count_ql_mod, ql_mod, better);
+			best_integer_count_index = select(best_integer_count_index, index, better);
 		}
-	}
 
-	int ql = quant_mode_table[best_integer_count][bits_available];
-	int ql_mod = quant_mode_table[best_integer_count][bits_available + 8];
+		vint formats = gatheri(&formats_of_choice[0][0], best_integer_count_index);
+		formats = select(vint(FMT_LUMINANCE), formats, best_integer_count_ql > vint(-1));
 
-	*best_quant_level = ql;
-	*best_quant_level_mod = ql_mod;
-	*error_of_best_combination = best_integer_count_error;
-	if (ql >= 0)
-	{
-		for (int i = 0; i < 4; i++)
-		{
-			best_formats[i] = formats_of_choice[ql][best_integer_count - 4][i];
-		}
-	}
-	else
-	{
-		for (int i = 0; i < 4; i++)
-		{
-			best_formats[i] = FMT_LUMINANCE;
-		}
+		storea(best_integer_count_error, best_error + bits);
+		storea(best_integer_count_ql, best_quant_level + bits);
+		storea(partition_count == 1 ? best_integer_count_ql : best_integer_count_ql_mod, best_quant_level_mod + bits);
+		storea(formats, best_formats + bits);
 	}
 }
 
@@ -798,8 +704,8 @@ void determine_optimal_set_of_endpoint_formats_to_use(
 	vfloat4 dummied_color_scalefactors[4];	// only used to receive data
 	compute_partition_error_color_weightings(bsd, ewb, pt, error_weightings, dummied_color_scalefactors);
 
-	float best_error[4][21][4];
-	int format_of_choice[4][21][4];
+	alignas(ASTCENC_VECALIGN) float best_error[4][4][QUANT_LEVELS_PADDED];
+	alignas(ASTCENC_VECALIGN) int format_of_choice[4][4][QUANT_LEVELS_PADDED];
 	for (int i = 0; i < partition_count; i++)
 	{
 		compute_color_error_for_every_integer_count_and_quant_level(
@@ -808,160 +714,76 @@ void determine_optimal_set_of_endpoint_formats_to_use(
 		    format_of_choice[i]);
 	}
 
-	alignas(ASTCENC_VECALIGN) float errors_of_best_combination[MAX_WEIGHT_MODES];
-	alignas(ASTCENC_VECALIGN) int best_quant_levels[MAX_WEIGHT_MODES];
-	int best_quant_levels_mod[MAX_WEIGHT_MODES];
-	int best_ep_formats[MAX_WEIGHT_MODES][4];
-
-#if ASTCENC_SIMD_WIDTH > 1
-	// have to ensure that the "overstep" of the last iteration in the vectorized
-	// loop will contain data that will never be picked as best candidate
-	const int packed_mode_count = bsd->block_mode_count;
-	const int packed_mode_count_simd_up = round_up_to_simd_multiple_vla(packed_mode_count);
-	for (int i = packed_mode_count; i < packed_mode_count_simd_up; ++i)
-	{
-		errors_of_best_combination[i] = 1e30f;
-		best_quant_levels[i] = 0;
-		best_quant_levels_mod[i] = 0;
-	}
-#endif // #if ASTCENC_SIMD_WIDTH > 1
+	// combine the per-partition tables into tables indexed by the total integer count
+	alignas(ASTCENC_VECALIGN) float combined_best_error[13][QUANT_LEVELS_PADDED];
+	alignas(ASTCENC_VECALIGN) int formats_of_choice[13][QUANT_LEVELS_PADDED];
 
 	// code for the case where the block contains 1 partition
 	if (partition_count == 1)
 	{
-		int best_quant_level;
-		int best_format;
-		float error_of_best_combination;
-		for (int i = 0; i < bsd->block_mode_count; ++i)
+		for (int i = 0; i < 4; i++)
 		{
-			if (qwt_errors[i] >= 1e29f)
+			for (int j = 0; j < QUANT_LEVELS_PADDED; j += ASTCENC_SIMD_WIDTH)
 			{
-				errors_of_best_combination[i] = 1e30f;
-				continue;
+				storea(loada(best_error[0][i] + j), combined_best_error[i] + j);
+				storea(vint::loada(format_of_choice[0][i] + j), formats_of_choice[i] + j);
 			}
-
-			one_partition_find_best_combination_for_bitcount(
-			    best_error[0], format_of_choice[0], qwt_bitcounts[i],
-			    &best_quant_level, &best_format, &error_of_best_combination);
-			error_of_best_combination += qwt_errors[i];
-
-			errors_of_best_combination[i] = error_of_best_combination;
-			best_quant_levels[i] = best_quant_level;
-			best_quant_levels_mod[i] = best_quant_level;
-			best_ep_formats[i][0] = best_format;
 		}
 	}
 	// code for the case where the block contains 2 partitions
 	else if (partition_count == 2)
 	{
-		int best_quant_level;
-		int best_quant_level_mod;
-		int best_formats[2];
-		float error_of_best_combination;
-
-		float combined_best_error[21][7];
-		int formats_of_choice[21][7][2];
-
 		two_partitions_find_best_combination_for_every_quantization_and_integer_count(
 		    best_error, format_of_choice, combined_best_error, formats_of_choice);
-
-
-		for (int i = 0; i < bsd->block_mode_count; ++i)
-		{
-			if (qwt_errors[i] >= 1e29f)
-			{
-				errors_of_best_combination[i] = 1e30f;
-				continue;
-			}
-
-			two_partitions_find_best_combination_for_bitcount(
-			    combined_best_error, formats_of_choice, qwt_bitcounts[i],
-			    &best_quant_level, &best_quant_level_mod,
-			    best_formats, &error_of_best_combination);
-
-			error_of_best_combination += qwt_errors[i];
-
-			errors_of_best_combination[i] = error_of_best_combination;
-			best_quant_levels[i] = best_quant_level;
-			best_quant_levels_mod[i] = best_quant_level_mod;
-			best_ep_formats[i][0] = best_formats[0];
-			best_ep_formats[i][1] = best_formats[1];
-		}
 	}
 	// code for the case where the block contains 3 partitions
 	else if (partition_count == 3)
 	{
-		int best_quant_level;
-		int best_quant_level_mod;
-		int best_formats[3];
-		float error_of_best_combination;
-
-		float combined_best_error[21][10];
-		int formats_of_choice[21][10][3];
-
 		three_partitions_find_best_combination_for_every_quantization_and_integer_count(
 		    best_error, format_of_choice, combined_best_error, formats_of_choice);
-
-		for (int i = 0; i < bsd->block_mode_count; ++i)
-		{
-			if (qwt_errors[i] >= 1e29f)
-			{
-				errors_of_best_combination[i] = 1e30f;
-				continue;
-			}
-
-			three_partitions_find_best_combination_for_bitcount(
-			    combined_best_error, formats_of_choice, qwt_bitcounts[i],
-			    &best_quant_level, &best_quant_level_mod,
-			    best_formats, &error_of_best_combination);
-
-			error_of_best_combination += qwt_errors[i];
-
-			errors_of_best_combination[i] = error_of_best_combination;
-			best_quant_levels[i] = best_quant_level;
-			best_quant_levels_mod[i] = best_quant_level_mod;
-			best_ep_formats[i][0] = best_formats[0];
-			best_ep_formats[i][1] = best_formats[1];
-			best_ep_formats[i][2] = best_formats[2];
-		}
 	}
 	// code for the case where the block contains 4 partitions
 	else if (partition_count == 4)
 	{
-		int best_quant_level;
-		int best_quant_level_mod;
-		int best_formats[4];
-		float error_of_best_combination;
-
-		float combined_best_error[21][13];
-		int formats_of_choice[21][13][4];
-
 		four_partitions_find_best_combination_for_every_quantization_and_integer_count(
 		    best_error, format_of_choice, combined_best_error, formats_of_choice);
+	}
 
-		for (int i = 0; i < bsd->block_mode_count; ++i)
-		{
-			if (qwt_errors[i] >= 1e29f)
-			{
-				errors_of_best_combination[i] = 1e30f;
-				continue;
-			}
+	alignas(ASTCENC_VECALIGN) float bitcount_best_error[COLOR_BITCOUNT_LIMIT];
+	alignas(ASTCENC_VECALIGN) int bitcount_best_quant_levels[COLOR_BITCOUNT_LIMIT];
+	alignas(ASTCENC_VECALIGN) int bitcount_best_quant_levels_mod[COLOR_BITCOUNT_LIMIT];
+	alignas(ASTCENC_VECALIGN) int bitcount_best_ep_formats[COLOR_BITCOUNT_LIMIT];
+
+	find_best_combination_for_every_bitcount(
+	    partition_count, combined_best_error, formats_of_choice,
+	    bitcount_best_error, bitcount_best_quant_levels,
+	    bitcount_best_quant_levels_mod, bitcount_best_ep_formats);
+
+	// look up the best combination for every block mode; the formats of all
+	// partitions are packed into a single integer, 8 bits per partition
+	alignas(ASTCENC_VECALIGN) float errors_of_best_combination[MAX_WEIGHT_MODES];
+	alignas(ASTCENC_VECALIGN) int best_quant_levels[MAX_WEIGHT_MODES];
+	alignas(ASTCENC_VECALIGN) int best_quant_levels_mod[MAX_WEIGHT_MODES];
+	alignas(ASTCENC_VECALIGN) int best_ep_formats[MAX_WEIGHT_MODES];
+
+	// the "overstep" of the last iteration in the vectorized loop must contain
+	// data that will never be picked as best candidate
+	vint mode_ids = vint::lane_id();
+	vint packed_mode_count(bsd->block_mode_count);
+	for (int i = 0; i < bsd->block_mode_count; i += ASTCENC_SIMD_WIDTH)
+	{
+		vfloat weight_error(qwt_errors + i);
+		vmask usable = (mode_ids < packed_mode_count) & (weight_error < vfloat(1e29f));
 
-			four_partitions_find_best_combination_for_bitcount(
-			    combined_best_error, formats_of_choice, qwt_bitcounts[i],
-			    &best_quant_level, &best_quant_level_mod,
-			    best_formats, &error_of_best_combination);
+		vint bitcount = select(vint(0), vint(qwt_bitcounts + i), usable);
+		vfloat error = gatherf(bitcount_best_error, bitcount) + weight_error;
 
-			error_of_best_combination += qwt_errors[i];
+		storea(select(vfloat(1e30f), error, usable), errors_of_best_combination + i);
+		storea(select(vint(0), gatheri(bitcount_best_quant_levels, bitcount), usable), best_quant_levels + i);
+		storea(select(vint(0), gatheri(bitcount_best_quant_levels_mod, bitcount), usable), best_quant_levels_mod + i);
+		storea(gatheri(bitcount_best_ep_formats, bitcount), best_ep_formats + i);
 
-			errors_of_best_combination[i] = error_of_best_combination;
-			best_quant_levels[i] = best_quant_level;
-			best_quant_levels_mod[i] = best_quant_level_mod;
-			best_ep_formats[i][0] = best_formats[0];
-			best_ep_formats[i][1] = best_formats[1];
-			best_ep_formats[i][2] = best_formats[2];
-			best_ep_formats[i][3] = best_formats[3];
-		}
+		mode_ids = mode_ids + vint(ASTCENC_SIMD_WIDTH);
 	}
 
 	// finally, go through the results and pick the best-looking modes.
@@ -1026,10 +848,12 @@ void determine_optimal_set_of_endpoint_formats_to_use(
 			quant_level_mod[i] = best_quant_levels_mod[best_error_weights[i]];
 			for (int j = 0; j < partition_count; j++)
 			{
-				partition_format_specifiers[i][j] = best_ep_formats[best_error_weights[i]][j];
+				partition_format_specifiers[i][j] = (best_ep_formats[best_error_weights[i]] >> (8 * j)) & 0xFF;
 			}
 		}
 	}
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
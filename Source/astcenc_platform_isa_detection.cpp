@@ -15,7 +15,8 @@
 // under the License.
 // ----------------------------------------------------------------------------
 
-#if (ASTCENC_SSE > 0) || (ASTCENC_AVX > 0) || (ASTCENC_POPCNT > 0)
+#if (ASTCENC_SSE > 0) || (ASTCENC_AVX > 0) || \
+    (ASTCENC_POPCNT > 0) || (ASTCENC_F16C > 0)
 
 /**
  * @brief Platform-specific function implementations.
@@ -27,7 +28,9 @@
 
 static int g_cpu_has_sse41 = -1;
 static int g_cpu_has_avx2 = -1;
+static int g_cpu_has_avx512 = -1;
 static int g_cpu_has_popcnt = -1;
+static int g_cpu_has_f16c = -1;
 
 /* ============================================================================
    Platform code for Visual Studio
@@ -44,6 +47,7 @@ static void detect_cpu_isa()
 
 	g_cpu_has_sse41 = 0;
 	g_cpu_has_popcnt = 0;
+	g_cpu_has_f16c = 0;
 	if (num_id >= 1)
 	{
 		__cpuidex(data, 1, 0);
@@ -51,14 +55,19 @@ static void detect_cpu_isa()
 		g_cpu_has_sse41 = data[2] & (1 << 19) ? 1 : 0;
 		// POPCNT = Bank 1, ECX, bit 23
 		g_cpu_has_popcnt = data[2] & (1 << 23) ? 1 : 0;
+		// F16C = Bank 1, ECX, bit 29
+		g_cpu_has_f16c = data[2] & (1 << 29) ? 1 : 0;
 	}
 
 	g_cpu_has_avx2 = 0;
+	g_cpu_has_avx512 = 0;
 	if (num_id >= 7)
 	{
 		__cpuidex(data, 7, 0);
 		// AVX2 = Bank 7, EBX, bit 5
 		g_cpu_has_avx2 = data[1] & (1 << 5) ? 1 : 0;
+		// AVX512 F/DQ/BW/VL = Bank 7, EBX, bits 16/17/30/31
+		g_cpu_has_avx512 = (data[1] & 0xC0030000u) == 0xC0030000u ? 1 : 0;
 	}
 }
 
@@ -74,19 +83,25 @@ static void detect_cpu_isa()
 
 	g_cpu_has_sse41 = 0;
 	g_cpu_has_popcnt = 0;
+	g_cpu_has_f16c = 0;
 	if (__get_cpuid_count(1, 0, &data[0], &data[1], &data[2], &data[3]))
 	{
 		// SSE41 = Bank 1, ECX, bit 19
 		g_cpu_has_sse41 = data[2] & (1 << 19) ? 1 : 0;
 		// POPCNT = Bank 1, ECX, bit 23
 		g_cpu_has_popcnt = data[2] & (1 << 23) ? 1 : 0;
+		// F16C = Bank 1, ECX, bit 29
+		g_cpu_has_f16c = data[2] & (1 << 29) ? 1 : 0;
 	}
 
 	g_cpu_has_avx2 = 0;
+	g_cpu_has_avx512 = 0;
 	if (__get_cpuid_count(7, 0, &data[0], &data[1], &data[2], &data[3]))
 	{
 		// AVX2 = Bank 7, EBX, bit 5
 		g_cpu_has_avx2 = data[1] & (1 << 5) ? 1 : 0;
+		// AVX512 F/DQ/BW/VL = Bank 7, EBX, bits 16/17/30/31
+		g_cpu_has_avx512 = (data[1] & 0xC0030000u) == 0xC0030000u ? 1 : 0;
 	}
 }
 #endif
@@ -113,6 +128,17 @@ int cpu_supports_popcnt()
 	return g_cpu_has_popcnt;
 }
 
+/* Public function, see header file for detailed documentation */
+int cpu_supports_f16c()
+{
+	if (g_cpu_has_f16c == -1)
+	{
+		detect_cpu_isa();
+	}
+
+	return g_cpu_has_f16c;
+}
+
 /* Public function, see header file for detailed documentation */
 int cpu_supports_avx2()
 {
@@ -124,4 +150,15 @@ int cpu_supports_avx2()
 	return g_cpu_has_avx2;
 }
 
+/* Public function, see header file for detailed documentation */
+int cpu_supports_avx512()
+{
+	if (g_cpu_has_avx512 == -1)
+	{
+		detect_cpu_isa();
+	}
+
+	return g_cpu_has_avx512;
+}
+
 #endif
@@ -21,6 +21,8 @@
 
 #include "astcenc_internal.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 #if !defined(ASTCENC_DECOMPRESS_ONLY)
 
 const uint8_t color_quant_tables[21][256] = {
@@ -576,3 +578,5 @@ void build_quant_mode_table()
 		}
 	}
 }
+
+ASTCENC_NAMESPACE_END
@@ -23,6 +23,8 @@
 
 #include <assert.h>
 
+ASTCENC_NAMESPACE_BEGIN
+
 // routine to write up to 8 bits
 static inline void write_bits(
 	int value,
@@ -256,9 +258,6 @@ void physical_to_symbolic(
 
 	scb.error_block = 0;
 
-	// get hold of the decimation tables.
-	const decimation_table *const *ixtab2 = bsd.decimation_tables;
-
 	// extract header fields
 	int block_mode = read_bits(11, 0, pcb.data);
 	if ((block_mode & 0x1FF) == 0x1FC)
@@ -333,7 +332,7 @@ void physical_to_symbolic(
 	assert(packed_index >= 0 && packed_index < bsd.block_mode_count);
 	const struct block_mode& bm = bsd.block_modes[packed_index];
 
-	int weight_count = ixtab2[bm.decimation_mode]->weight_count;
+	int weight_count = get_decimation_table(bsd, bm.decimation_mode)->weight_count;
 	int weight_quant_method = bm.quant_mode;
 	int is_dual_plane = bm.is_dual_plane;
 
@@ -457,6 +456,7 @@ void physical_to_symbolic(
 	if (color_quant_level < 4)
 	{
 		scb.error_block = 1;
+		return;
 	}
 
 	// then unpack the integer-bits
@@ -482,3 +482,5 @@ void physical_to_symbolic(
 		scb.plane2_color_component = read_bits(2, below_weights_pos - 2, pcb.data);
 	}
 }
+
+ASTCENC_NAMESPACE_END
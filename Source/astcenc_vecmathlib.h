@@ -39,6 +39,11 @@
  * used as a fixed-width type in normal code. No reference C implementation is
  * provided on platforms without underlying SIMD intrinsics.
  *
+ * Explicit 16-wide types are accessible via the vint16, vfloat16, and vmask16
+ * types. These are provided for use by VLA code, and are not expected to be
+ * used as a fixed-width type in normal code. No reference C implementation is
+ * provided on platforms without underlying SIMD intrinsics.
+ *
  * With the current implementation ISA support is provided for:
  *
  *     * 1-wide for scalar reference.
@@ -46,12 +51,17 @@
  *     * 4-wide for x86-64 SSE2.
  *     * 4-wide for x86-64 SSE4.1.
  *     * 8-wide for x86-64 AVX2.
+ *     * 16-wide for x86-64 AVX-512.
  *
  */
 
 #ifndef ASTC_VECMATHLIB_H_INCLUDED
 #define ASTC_VECMATHLIB_H_INCLUDED
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
 #if ASTCENC_SSE != 0 || ASTCENC_AVX != 0
 	#include <immintrin.h>
 #elif ASTCENC_NEON != 0
@@ -66,7 +76,23 @@
 	#define ASTCENC_SIMD_INLINE __attribute__((always_inline, nodebug)) inline
 #endif
 
-#if ASTCENC_AVX >= 2
+ASTCENC_NAMESPACE_BEGIN
+
+#if ASTCENC_AVX >= 512
+	/* If we have AVX-512 expose 16-wide VLA. */
+	#include "astcenc_vecmathlib_avx512_16.h"
+	#include "astcenc_vecmathlib_sse_4.h"
+
+	#define ASTCENC_SIMD_WIDTH 16
+
+	using vfloat = vfloat16;
+	using vint = vint16;
+	using vmask = vmask16;
+
+	constexpr auto loada = vfloat16::loada;
+	constexpr auto load1 = vfloat16::load1;
+
+#elif ASTCENC_AVX >= 2
 	/* If we have AVX2 expose 8-wide VLA. */
 	#include "astcenc_vecmathlib_avx2_8.h"
 	#include "astcenc_vecmathlib_sse_4.h"
@@ -162,6 +188,19 @@ ASTCENC_SIMD_INLINE vfloat change_sign(vfloat a, vfloat b)
 	return int_as_float(r);
 }
 
+/**
+ * @brief Return the number of bits set in each lane of the vector.
+ */
+ASTCENC_SIMD_INLINE vint popcount(vint a)
+{
+	a = a - (lsr<1>(a) & vint(0x55555555));
+	a = (a & vint(0x33333333)) + (lsr<2>(a) & vint(0x33333333));
+	a = (a + lsr<4>(a)) & vint(0x0F0F0F0F);
+	a = a + lsr<8>(a);
+	a = a + lsr<16>(a);
+	return a & vint(0x3F);
+}
+
 /**
  * @brief Return fast, but approximate, vector atan(x).
  *
@@ -186,4 +225,6 @@ ASTCENC_SIMD_INLINE vfloat atan2(vfloat y, vfloat x)
 	return change_sign(select(z, vfloat(astc::PI) - z, xmask), y);
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif // #ifndef ASTC_VECMATHLIB_H_INCLUDED
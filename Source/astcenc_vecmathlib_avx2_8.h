@@ -439,6 +439,22 @@ ASTCENC_SIMD_INLINE vmask8 operator>(vint8 a, vint8 b)
 	return vmask8(_mm256_cmpgt_epi32(a.m, b.m));
 }
 
+/**
+ * @brief Logical shift left.
+ */
+template <int s> ASTCENC_SIMD_INLINE vint8 lsl(vint8 a)
+{
+	return vint8(_mm256_slli_epi32(a.m, s));
+}
+
+/**
+ * @brief Logical shift right.
+ */
+template <int s> ASTCENC_SIMD_INLINE vint8 lsr(vint8 a)
+{
+	return vint8(_mm256_srli_epi32(a.m, s));
+}
+
 /**
  * @brief Return the min vector of two vectors.
  */
@@ -866,6 +882,14 @@ ASTCENC_SIMD_INLINE vint8 float_to_int(vfloat8 a)
 	return vint8(_mm256_cvttps_epi32(a.m));
 }
 
+/**
+ * @brief Return a float value for an integer vector.
+ */
+ASTCENC_SIMD_INLINE vfloat8 int_to_float(vint8 a)
+{
+	return vfloat8(_mm256_cvtepi32_ps(a.m));
+}
+
 /**
  * @brief Return a float value as an integer bit pattern (i.e. no conversion).
  *
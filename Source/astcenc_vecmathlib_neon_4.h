@@ -494,12 +494,22 @@ ASTCENC_SIMD_INLINE vmask4 operator>(vint4 a, vint4 b)
 	return vmask4(vcgtq_s32(a.m, b.m));
 }
 
+/**
+ * @brief Logical shift left.
+ */
+template <int s> ASTCENC_SIMD_INLINE vint4 lsl(vint4 a)
+{
+	return vint4(vshlq_s32(a.m, vdupq_n_s32(s)));
+}
+
 /**
  * @brief Logical shift right.
  */
 template <int s> ASTCENC_SIMD_INLINE vint4 lsr(vint4 a)
 {
-	return vint4(vshlq_s32(a.m, vdupq_n_s32(-s)));
+	uint32x4_t ua = vreinterpretq_u32_s32(a.m);
+	ua = vshlq_u32(ua, vdupq_n_s32(-s));
+	return vint4(vreinterpretq_s32_u32(ua));
 }
 
 /**
@@ -1025,6 +1035,28 @@ ASTCENC_SIMD_INLINE vfloat4 int_as_float(vint4 v)
 	return vfloat4(vreinterpretq_f32_s32(v.m));
 }
 
+/**
+ * @brief Return a float16 value for a float vector, using round-to-nearest.
+ *
+ * The float16 bit pattern is returned in the low 16 bits of each lane.
+ */
+ASTCENC_SIMD_INLINE vint4 float_to_float16(vfloat4 a)
+{
+	uint16x4_t f16 = vreinterpret_u16_f16(vcvt_f16_f32(a.m));
+	return vint4(vreinterpretq_s32_u32(vmovl_u16(f16)));
+}
+
+/**
+ * @brief Return a float value for a float16 vector.
+ *
+ * The float16 bit pattern is read from the low 16 bits of each lane.
+ */
+ASTCENC_SIMD_INLINE vfloat4 float16_to_float(vint4 a)
+{
+	uint16x4_t f16 = vmovn_u32(vreinterpretq_u32_s32(a.m));
+	return vfloat4(vcvt_f32_f16(vreinterpret_f16_u16(f16)));
+}
+
 /**
  * @brief Debug function to print a vector of floats.
  */
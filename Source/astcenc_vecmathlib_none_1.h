@@ -381,6 +381,22 @@ ASTCENC_SIMD_INLINE vmask1 operator>(vint1 a, vint1 b)
 	return vmask1(a.m > b.m ? 0xFFFFFFFF : 0);
 }
 
+/**
+ * @brief Logical shift left.
+ */
+template <int s> ASTCENC_SIMD_INLINE vint1 lsl(vint1 a)
+{
+	return vint1(static_cast<int>(static_cast<unsigned int>(a.m) << s));
+}
+
+/**
+ * @brief Logical shift right.
+ */
+template <int s> ASTCENC_SIMD_INLINE vint1 lsr(vint1 a)
+{
+	return vint1(static_cast<int>(static_cast<unsigned int>(a.m) >> s));
+}
+
 /**
  * @brief Return the min vector of two vectors.
  */
@@ -701,6 +717,14 @@ ASTCENC_SIMD_INLINE vint1 float_to_int(vfloat1 a)
 	return vint1(a.m);
 }
 
+/**
+ * @brief Return a float value for an integer vector.
+ */
+ASTCENC_SIMD_INLINE vfloat1 int_to_float(vint1 a)
+{
+	return vfloat1(static_cast<float>(a.m));
+}
+
 /**
  * @brief Return a float value as an integer bit pattern (i.e. no conversion).
  *
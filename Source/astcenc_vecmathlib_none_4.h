@@ -547,15 +547,26 @@ ASTCENC_SIMD_INLINE vmask4 operator>(vint4 a, vint4 b)
 	              a.m[3] > b.m[3] ? 0xFFFFFFFF : 0);
 }
 
+/**
+ * @brief Logical shift left.
+ */
+template <int s> ASTCENC_SIMD_INLINE vint4 lsl(vint4 a)
+{
+	return vint4(static_cast<int>(static_cast<unsigned int>(a.m[0]) << s),
+	             static_cast<int>(static_cast<unsigned int>(a.m[1]) << s),
+	             static_cast<int>(static_cast<unsigned int>(a.m[2]) << s),
+	             static_cast<int>(static_cast<unsigned int>(a.m[3]) << s));
+}
+
 /**
  * @brief Logical shift right.
  */
 template <int s> ASTCENC_SIMD_INLINE vint4 lsr(vint4 a)
 {
-	return vint4(a.m[0] >> s,
-	             a.m[1] >> s,
-	             a.m[2] >> s,
-	             a.m[3] >> s);
+	return vint4(static_cast<int>(static_cast<unsigned int>(a.m[0]) >> s),
+	             static_cast<int>(static_cast<unsigned int>(a.m[1]) >> s),
+	             static_cast<int>(static_cast<unsigned int>(a.m[2]) >> s),
+	             static_cast<int>(static_cast<unsigned int>(a.m[3]) >> s));
 }
 
 /**
@@ -1147,4 +1158,32 @@ ASTCENC_SIMD_INLINE vfloat4 int_as_float(vint4 a)
 	return r;
 }
 
+/**
+ * @brief Return a float16 value for a float vector, using round-to-nearest.
+ *
+ * The float16 bit pattern is returned in the low 16 bits of each lane.
+ */
+ASTCENC_SIMD_INLINE vint4 float_to_float16(vfloat4 a)
+{
+	return vint4(
+		float_to_sf16(a.lane<0>(), SF_NEARESTEVEN),
+		float_to_sf16(a.lane<1>(), SF_NEARESTEVEN),
+		float_to_sf16(a.lane<2>(), SF_NEARESTEVEN),
+		float_to_sf16(a.lane<3>(), SF_NEARESTEVEN));
+}
+
+/**
+ * @brief Return a float value for a float16 vector.
+ *
+ * The float16 bit pattern is read from the low 16 bits of each lane.
+ */
+ASTCENC_SIMD_INLINE vfloat4 float16_to_float(vint4 a)
+{
+	return vfloat4(
+		sf16_to_float(static_cast<sf16>(a.lane<0>())),
+		sf16_to_float(static_cast<sf16>(a.lane<1>())),
+		sf16_to_float(static_cast<sf16>(a.lane<2>())),
+		sf16_to_float(static_cast<sf16>(a.lane<3>())));
+}
+
 #endif // #ifndef ASTC_VECMATHLIB_NONE_4_H_INCLUDED
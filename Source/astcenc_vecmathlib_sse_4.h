@@ -515,6 +515,14 @@ ASTCENC_SIMD_INLINE vmask4 operator>(vint4 a, vint4 b)
 	return vmask4(_mm_cmpgt_epi32(a.m, b.m));
 }
 
+/**
+ * @brief Logical shift left.
+ */
+template <int s> ASTCENC_SIMD_INLINE vint4 lsl(vint4 a)
+{
+	return vint4(_mm_slli_epi32(a.m, s));
+}
+
 /**
  * @brief Logical shift right.
  */
@@ -1094,6 +1102,46 @@ ASTCENC_SIMD_INLINE vfloat4 int_as_float(vint4 v)
 	return vfloat4(_mm_castsi128_ps(v.m));
 }
 
+/**
+ * @brief Return a float16 value for a float vector, using round-to-nearest.
+ *
+ * The float16 bit pattern is returned in the low 16 bits of each lane.
+ */
+ASTCENC_SIMD_INLINE vint4 float_to_float16(vfloat4 a)
+{
+#if ASTCENC_F16C >= 1
+	__m128i packedf16 = _mm_cvtps_ph(a.m, 0);
+	__m128i f16 = _mm_cvtepu16_epi32(packedf16);
+	return vint4(f16);
+#else
+	return vint4(
+		float_to_sf16(a.lane<0>(), SF_NEARESTEVEN),
+		float_to_sf16(a.lane<1>(), SF_NEARESTEVEN),
+		float_to_sf16(a.lane<2>(), SF_NEARESTEVEN),
+		float_to_sf16(a.lane<3>(), SF_NEARESTEVEN));
+#endif
+}
+
+/**
+ * @brief Return a float value for a float16 vector.
+ *
+ * The float16 bit pattern is read from the low 16 bits of each lane.
+ */
+ASTCENC_SIMD_INLINE vfloat4 float16_to_float(vint4 a)
+{
+#if ASTCENC_F16C >= 1
+	__m128i packed = _mm_packus_epi32(a.m, a.m);
+	__m128 f32 = _mm_cvtph_ps(packed);
+	return vfloat4(f32);
+#else
+	return vfloat4(
+		sf16_to_float(static_cast<sf16>(a.lane<0>())),
+		sf16_to_float(static_cast<sf16>(a.lane<1>())),
+		sf16_to_float(static_cast<sf16>(a.lane<2>())),
+		sf16_to_float(static_cast<sf16>(a.lane<3>())));
+#endif
+}
+
 /**
  * @brief Debug function to print a vector of floats.
  */
@@ -51,7 +51,12 @@
 #include <cassert>
 #include <cstring>
 
-#define ANGULAR_STEPS 40
+ASTCENC_NAMESPACE_BEGIN
+
+// Weights use at most QUANT_32, so the angular search needs at most 33 steps.
+// Vector loops round this up to a multiple of the SIMD width, so the arrays
+// are padded to 48 steps, the next multiple of the 16-wide AVX-512 width
+#define ANGULAR_STEPS 48
 static_assert((ANGULAR_STEPS % ASTCENC_SIMD_WIDTH) == 0,
               "ANGULAR_STEPS must be multiple of ASTCENC_SIMD_WIDTH");
 
@@ -341,9 +346,11 @@ static void compute_angular_endpoints_for_quant_levels(
 }
 
 // helper functions that will compute ideal angular-endpoints
-// for a given set of weights and a given block size descriptors
+// for a given set of weights and a given block size descriptors;
+// if only_block_mode is not -1 only that block mode is computed
 void compute_angular_endpoints_1plane(
 	bool only_always,
+	int only_block_mode,
 	const block_size_descriptor* bsd,
 	const float* decimated_quantized_weights,
 	const float* decimated_weights,
@@ -353,10 +360,17 @@ void compute_angular_endpoints_1plane(
 	float low_values[MAX_DECIMATION_MODES][12];
 	float high_values[MAX_DECIMATION_MODES][12];
 
+	int only_decimation_mode = -1;
+	if (only_block_mode >= 0)
+	{
+		only_decimation_mode = bsd->block_modes[only_block_mode].decimation_mode;
+	}
+
 	for (int i = 0; i < bsd->decimation_mode_count; i++)
 	{
 		const decimation_mode& dm = bsd->decimation_modes[i];
-		if (dm.maxprec_1plane < 0 || (only_always && !dm.percentile_always) || !dm.percentile_hit)
+		if (dm.maxprec_1plane < 0 || (only_always && !dm.percentile_always) || !dm.percentile_hit
+		    || ((only_decimation_mode >= 0) && (i != only_decimation_mode)))
 		{
 			continue;
 		}
@@ -370,7 +384,8 @@ void compute_angular_endpoints_1plane(
 	for (int i = 0; i < bsd->block_mode_count; ++i)
 	{
 		const block_mode& bm = bsd->block_modes[i];
-		if (bm.is_dual_plane || (only_always && !bm.percentile_always) || !bm.percentile_hit)
+		if (bm.is_dual_plane || (only_always && !bm.percentile_always) || !bm.percentile_hit
+		    || ((only_block_mode >= 0) && (i != only_block_mode)))
 		{
 			continue;
 		}
@@ -385,6 +400,7 @@ void compute_angular_endpoints_1plane(
 
 void compute_angular_endpoints_2planes(
 	bool only_always,
+	int only_block_mode,
 	const block_size_descriptor* bsd,
 	const float* decimated_quantized_weights,
 	const float* decimated_weights,
@@ -398,10 +414,17 @@ void compute_angular_endpoints_2planes(
 	float low_values2[MAX_DECIMATION_MODES][12];
 	float high_values2[MAX_DECIMATION_MODES][12];
 
+	int only_decimation_mode = -1;
+	if (only_block_mode >= 0)
+	{
+		only_decimation_mode = bsd->block_modes[only_block_mode].decimation_mode;
+	}
+
 	for (int i = 0; i < bsd->decimation_mode_count; i++)
 	{
 		const decimation_mode& dm = bsd->decimation_modes[i];
-		if (dm.maxprec_2planes < 0 || (only_always && !dm.percentile_always) || !dm.percentile_hit)
+		if (dm.maxprec_2planes < 0 || (only_always && !dm.percentile_always) || !dm.percentile_hit
+		    || ((only_decimation_mode >= 0) && (i != only_decimation_mode)))
 		{
 			continue;
 		}
@@ -420,7 +443,8 @@ void compute_angular_endpoints_2planes(
 	for (int i = 0; i < bsd->block_mode_count; ++i)
 	{
 		const block_mode& bm = bsd->block_modes[i];
-		if ((!bm.is_dual_plane) || (only_always && !bm.percentile_always) || !bm.percentile_hit)
+		if ((!bm.is_dual_plane) || (only_always && !bm.percentile_always) || !bm.percentile_hit
+		    || ((only_block_mode >= 0) && (i != only_block_mode)))
 		{
 			continue;
 		}
@@ -435,4 +459,6 @@ void compute_angular_endpoints_2planes(
 	}
 }
 
+ASTCENC_NAMESPACE_END
+
 #endif
@@ -21,6 +21,8 @@
 
 #include "astcenc_internal.h"
 
+ASTCENC_NAMESPACE_BEGIN
+
 #define _ 0 // using _ to indicate an entry that will not be used.
 
 const quantization_and_transfer_table quant_and_xfer_tables[12] = {
@@ -165,3 +167,5 @@ const quantization_and_transfer_table quant_and_xfer_tables[12] = {
 		 0x1f1d403c,_,0x1f1e403e}
 	}
 };
+
+ASTCENC_NAMESPACE_END
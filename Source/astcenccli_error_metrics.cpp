@@ -19,8 +19,10 @@
  * @brief Functions for computing image error metrics.
  */
 
+#include <atomic>
 #include <cassert>
 #include <cstdio>
+#include <vector>
 
 #include "astcenccli_internal.h"
 
@@ -71,55 +73,268 @@ static kahan_accum4 &operator+=(
 }
 
 /**
- * @brief mPSNR tonemapping operator for HDR images.
+ * @brief The incremental addition operator for merging Kahan accumulators.
+ *
+ * @param val The Kahan accumulator to increment
+ * @param inc The Kahan accumulator to add
+ *
+ * @return The updated accumulator
+ */
+static kahan_accum4 &operator+=(
+	kahan_accum4 &val,
+	const kahan_accum4 &inc
+) {
+	val += inc.sum;
+	val += vfloat4::zero() - inc.comp;
+	return val;
+}
+
+/**
+ * @brief mPSNR tonemapping scale factor for an exposure fstop.
+ *
+ * The mPSNR tonemapping operator for a value at an fstop is defined as:
+ *
+ *     clamp(255 * (val * 2^fstop)^(1 / 2.2), 0, 255)
+ *
+ * ... which can be factored into (val^(1 / 2.2)) * scale, where the scale is
+ * independent of the value. This allows the expensive power function to be
+ * computed once per texel rather than once per texel per fstop.
  *
- * @param val The color value to tone map
  * @param fstop The exposure fstop; should be in range [-125, 125]
  *
- * @return The mapped color value in [0.0f, 255.0f] range
+ * @return The scale factor to apply to val^(1 / 2.2)
  */
-static float mpsnr_operator(
-	float val,
+static float mpsnr_scale(
 	int fstop
 ) {
 	if32 p;
 	p.u = 0x3f800000 + (fstop << 23);  // 0x3f800000 is 1.0f
-	val *= p.f;
-	val = powf(val, (1.0f / 2.2f));
-	val *= 255.0f;
-
-	return astc::clamp(val, 0.0f, 255.0f);
+	return powf(p.f, (1.0f / 2.2f)) * 255.0f;
 }
 
 /**
- * @brief mPSNR difference between two values.
+ * @brief mPSNR difference between two colors.
  *
- * Differences are given as "val1 - val2".
+ * Differences are given as "color1 - color2".
  *
- * @param val1     The first color value
- * @param val2     The second color value
- * @param fstop_lo The low exposure fstop; should be in range [-125, 125]
- * @param fstop_hi The high exposure fstop; should be in range [-125, 125]
+ * @param color1      The first color value
+ * @param color2      The second color value
+ * @param scales      The tonemapping scale for each fstop
+ * @param scale_count The number of fstops
  *
  * @return The summed mPSNR difference across all active fstop levels
  */
-static float mpsnr_sumdiff(
-	float val1,
-	float val2,
-	int fstop_lo,
-	int fstop_hi
+static vfloat4 mpsnr_sumdiff(
+	vfloat4 color1,
+	vfloat4 color2,
+	const float* scales,
+	int scale_count
 ) {
-	float summa = 0.0f;
-	for (int i = fstop_lo; i <= fstop_hi; i++)
+	vfloat4 base1(powf(color1.lane<0>(), (1.0f / 2.2f)),
+	              powf(color1.lane<1>(), (1.0f / 2.2f)),
+	              powf(color1.lane<2>(), (1.0f / 2.2f)),
+	              powf(color1.lane<3>(), (1.0f / 2.2f)));
+
+	vfloat4 base2(powf(color2.lane<0>(), (1.0f / 2.2f)),
+	              powf(color2.lane<1>(), (1.0f / 2.2f)),
+	              powf(color2.lane<2>(), (1.0f / 2.2f)),
+	              powf(color2.lane<3>(), (1.0f / 2.2f)));
+
+	vfloat4 summa = vfloat4::zero();
+	for (int i = 0; i < scale_count; i++)
 	{
-		float mval1 = mpsnr_operator(val1, i);
-		float mval2 = mpsnr_operator(val2, i);
-		float mdiff = mval1 - mval2;
-		summa += mdiff * mdiff;
+		vfloat4 scale(scales[i]);
+		vfloat4 mval1 = clamp(0.0f, 255.0f, base1 * scale);
+		vfloat4 mval2 = clamp(0.0f, 255.0f, base2 * scale);
+		vfloat4 mdiff = mval1 - mval2;
+		summa = summa + mdiff * mdiff;
 	}
+
 	return summa;
 }
 
+/**
+ * @brief Load a single texel from an image as a float color.
+ *
+ * Float values are clamped to the [0, 65504] range.
+ *
+ * @param img The image to load from
+ * @param x   The texel X coordinate
+ * @param y   The texel Y coordinate
+ * @param z   The texel Z coordinate
+ *
+ * @return The texel color
+ */
+static vfloat4 load_texel(
+	const astcenc_image* img,
+	unsigned int x,
+	unsigned int y,
+	unsigned int z
+) {
+	size_t offset = 4 * (static_cast<size_t>(img->dim_x) * y + x);
+
+	if (img->data_type == ASTCENC_TYPE_U8)
+	{
+		const uint8_t* data8 = static_cast<const uint8_t*>(img->data[z]);
+		return int_to_float(vint4(data8 + offset)) * (1.0f / 255.0f);
+	}
+
+	if (img->data_type == ASTCENC_TYPE_F16)
+	{
+		const uint16_t* data16 = static_cast<const uint16_t*>(img->data[z]);
+		vint4 color(data16[offset], data16[offset + 1],
+		            data16[offset + 2], data16[offset + 3]);
+		return clamp(0.0f, 65504.0f, float16_to_float(color));
+	}
+
+	assert(img->data_type == ASTCENC_TYPE_F32);
+	const float* data32 = static_cast<const float*>(img->data[z]);
+	return clamp(0.0f, 65504.0f, vfloat4(data32 + offset));
+}
+
+/**
+ * @brief The error sums for a single image row.
+ */
+struct error_metrics_row
+{
+	/** The sum of squared errors. */
+	kahan_accum4 errorsum;
+
+	/** The sum of squared alpha-weighted errors. */
+	kahan_accum4 alpha_scaled_errorsum;
+
+	/** The sum of squared log errors. */
+	kahan_accum4 log_errorsum;
+
+	/** The sum of mPSNR errors. */
+	kahan_accum4 mpsnr_errorsum;
+
+	/** The per-channel peak value of the first image. */
+	vfloat4 peak;
+};
+
+/**
+ * @brief The error metrics workload shared by all threads.
+ */
+struct error_metrics_workload
+{
+	/** The first (original) image. */
+	const astcenc_image* img1;
+
+	/** The second (compressed) image. */
+	const astcenc_image* img2;
+
+	/** The X dimension of the compared region. */
+	unsigned int dim_x;
+
+	/** The Y dimension of the compared region. */
+	unsigned int dim_y;
+
+	/** Should HDR metrics be computed? */
+	bool compute_hdr_metrics;
+
+	/** The mPSNR tonemapping scale for each fstop. */
+	const float* mpsnr_scales;
+
+	/** The number of mPSNR fstops. */
+	int mpsnr_scale_count;
+
+	/** The index of the next row to process. */
+	std::atomic<unsigned int> next_row;
+
+	/** The number of rows to process. */
+	unsigned int row_count;
+
+	/** The error sums for each row. */
+	error_metrics_row* rows;
+};
+
+/**
+ * @brief Compute the error sums for a single image row.
+ *
+ * @param work The workload
+ * @param y    The row Y coordinate
+ * @param z    The row Z coordinate
+ * @param row  The row error sums to populate
+ */
+static void compute_row_error_metrics(
+	const error_metrics_workload& work,
+	unsigned int y,
+	unsigned int z,
+	error_metrics_row& row
+) {
+	row.peak = vfloat4::zero();
+
+	for (unsigned int x = 0; x < work.dim_x; x++)
+	{
+		vfloat4 color1 = load_texel(work.img1, x, y, z);
+		vfloat4 color2 = load_texel(work.img2, x, y, z);
+
+		row.peak = max(row.peak, color1);
+
+		vfloat4 diffcolor = color1 - color2;
+		row.errorsum += diffcolor * diffcolor;
+
+		vfloat4 alpha_scale(color1.lane<3>());
+		alpha_scale.set_lane<3>(1.0f);
+		vfloat4 alpha_scaled_diffcolor = diffcolor * alpha_scale;
+		row.alpha_scaled_errorsum += alpha_scaled_diffcolor * alpha_scaled_diffcolor;
+
+		if (work.compute_hdr_metrics)
+		{
+			vfloat4 log_input_color1 = vfloat4(
+			    astc::xlog2(color1.lane<0>()),
+			    astc::xlog2(color1.lane<1>()),
+			    astc::xlog2(color1.lane<2>()),
+			    astc::xlog2(color1.lane<3>()));
+
+			vfloat4 log_input_color2 = vfloat4(
+			    astc::xlog2(color2.lane<0>()),
+			    astc::xlog2(color2.lane<1>()),
+			    astc::xlog2(color2.lane<2>()),
+			    astc::xlog2(color2.lane<3>()));
+
+			vfloat4 log_diffcolor = log_input_color1 - log_input_color2;
+			row.log_errorsum += log_diffcolor * log_diffcolor;
+
+			row.mpsnr_errorsum += mpsnr_sumdiff(color1, color2, work.mpsnr_scales,
+			                                    work.mpsnr_scale_count);
+		}
+	}
+}
+
+/**
+ * @brief Thread entry point for the error metrics workload.
+ *
+ * Threads process rows in an arbitrary order, but each row is summed in to
+ * its own accumulator so the merged result is independent of thread count.
+ *
+ * @param thread_count The number of threads
+ * @param thread_id    The index of this thread
+ * @param payload      The error metrics workload
+ */
+static void error_metrics_workload_runner(
+	int thread_count,
+	int thread_id,
+	void* payload
+) {
+	(void)thread_count;
+	(void)thread_id;
+
+	error_metrics_workload& work = *static_cast<error_metrics_workload*>(payload);
+	while (true)
+	{
+		unsigned int index = work.next_row++;
+		if (index >= work.row_count)
+		{
+			break;
+		}
+
+		compute_row_error_metrics(work, index % work.dim_y, index / work.dim_y,
+		                          work.rows[index]);
+	}
+}
+
 /* Public function, see header file for detailed documentation */
 void compute_error_metrics(
 	int compute_hdr_metrics,
@@ -127,16 +342,12 @@ void compute_error_metrics(
 	const astcenc_image* img1,
 	const astcenc_image* img2,
 	int fstop_lo,
-	int fstop_hi
+	int fstop_hi,
+	unsigned int thread_count
 ) {
 	static const int channelmasks[5] { 0x00, 0x07, 0x0C, 0x07, 0x0F };
 	int channelmask = channelmasks[input_components];
 
-	kahan_accum4 errorsum;
-	kahan_accum4 alpha_scaled_errorsum;
-	kahan_accum4 log_errorsum;
-	kahan_accum4 mpsnr_errorsum;
-
 	unsigned int dim_x = astc::min(img1->dim_x, img2->dim_x);
 	unsigned int dim_y = astc::min(img1->dim_y, img2->dim_y);
 	unsigned int dim_z = astc::min(img1->dim_z, img2->dim_z);
@@ -152,121 +363,50 @@ void compute_error_metrics(
 		       img2->dim_x, img2->dim_y, img2->dim_z);
 	}
 
-	float rgb_peak = 0.0f;
-	unsigned int xsize1 = img1->dim_x;
-	unsigned int xsize2 = img2->dim_x;
+	std::vector<float> mpsnr_scales;
+	for (int i = fstop_lo; i <= fstop_hi; i++)
+	{
+		mpsnr_scales.push_back(mpsnr_scale(i));
+	}
 
-	for (unsigned int z = 0; z < dim_z; z++)
+	unsigned int row_count = dim_y * dim_z;
+	error_metrics_row* rows = new error_metrics_row[row_count];
+
+	error_metrics_workload work;
+	work.img1 = img1;
+	work.img2 = img2;
+	work.dim_x = dim_x;
+	work.dim_y = dim_y;
+	work.compute_hdr_metrics = compute_hdr_metrics != 0;
+	work.mpsnr_scales = mpsnr_scales.data();
+	work.mpsnr_scale_count = static_cast<int>(mpsnr_scales.size());
+	work.next_row = 0;
+	work.row_count = row_count;
+	work.rows = rows;
+
+	thread_count = astc::clamp(thread_count, 1u, astc::max(row_count, 1u));
+	launch_threads(static_cast<int>(thread_count), error_metrics_workload_runner, &work);
+
+	// Merge the row sums in row order, so the result is deterministic
+	kahan_accum4 errorsum;
+	kahan_accum4 alpha_scaled_errorsum;
+	kahan_accum4 log_errorsum;
+	kahan_accum4 mpsnr_errorsum;
+	vfloat4 peak = vfloat4::zero();
+
+	for (unsigned int i = 0; i < row_count; i++)
 	{
-		for (unsigned int y = 0; y < dim_y; y++)
-		{
-			for (unsigned int x = 0; x < dim_x; x++)
-			{
-				vfloat4 color1;
-				vfloat4 color2;
-
-				if (img1->data_type == ASTCENC_TYPE_U8)
-				{
-					uint8_t* data8 = static_cast<uint8_t*>(img1->data[z]);
-					color1 = vfloat4(
-					    data8[(4 * xsize1 * y) + (4 * x    )] * (1.0f / 255.0f),
-					    data8[(4 * xsize1 * y) + (4 * x + 1)] * (1.0f / 255.0f),
-					    data8[(4 * xsize1 * y) + (4 * x + 2)] * (1.0f / 255.0f),
-					    data8[(4 * xsize1 * y) + (4 * x + 3)] * (1.0f / 255.0f));
-				}
-				else if (img1->data_type == ASTCENC_TYPE_F16)
-				{
-					uint16_t* data16 = static_cast<uint16_t*>(img1->data[z]);
-					color1 = vfloat4(
-					    astc::clamp64Kf(sf16_to_float(data16[(4 * xsize1 * y) + (4 * x    )])),
-					    astc::clamp64Kf(sf16_to_float(data16[(4 * xsize1 * y) + (4 * x + 1)])),
-					    astc::clamp64Kf(sf16_to_float(data16[(4 * xsize1 * y) + (4 * x + 2)])),
-					    astc::clamp64Kf(sf16_to_float(data16[(4 * xsize1 * y) + (4 * x + 3)])));
-				}
-				else // if (img1->data_type == ASTCENC_TYPE_F32)
-				{
-					assert(img1->data_type == ASTCENC_TYPE_F32);
-					float* data32 = static_cast<float*>(img1->data[z]);
-					color1 = vfloat4(
-					    astc::clamp64Kf(data32[(4 * xsize1 * y) + (4 * x    )]),
-					    astc::clamp64Kf(data32[(4 * xsize1 * y) + (4 * x + 1)]),
-					    astc::clamp64Kf(data32[(4 * xsize1 * y) + (4 * x + 2)]),
-					    astc::clamp64Kf(data32[(4 * xsize1 * y) + (4 * x + 3)]));
-				}
-
-				if (img2->data_type == ASTCENC_TYPE_U8)
-				{
-					uint8_t* data8 = static_cast<uint8_t*>(img2->data[z]);
-					color2 = vfloat4(
-					    data8[(4 * xsize2 * y) + (4 * x    )] * (1.0f / 255.0f),
-					    data8[(4 * xsize2 * y) + (4 * x + 1)] * (1.0f / 255.0f),
-					    data8[(4 * xsize2 * y) + (4 * x + 2)] * (1.0f / 255.0f),
-					    data8[(4 * xsize2 * y) + (4 * x + 3)] * (1.0f / 255.0f));
-				}
-				else if (img2->data_type == ASTCENC_TYPE_F16)
-				{
-					uint16_t* data16 = static_cast<uint16_t*>(img2->data[z]);
-					color2 = vfloat4(
-					    astc::clamp64Kf(sf16_to_float(data16[(4 * xsize2 * y) + (4 * x    )])),
-					    astc::clamp64Kf(sf16_to_float(data16[(4 * xsize2 * y) + (4 * x + 1)])),
-					    astc::clamp64Kf(sf16_to_float(data16[(4 * xsize2 * y) + (4 * x + 2)])),
-					    astc::clamp64Kf(sf16_to_float(data16[(4 * xsize2 * y) + (4 * x + 3)])));
-				}
-				else // if (img2->data_type == ASTCENC_TYPE_F32)
-				{
-					assert(img2->data_type == ASTCENC_TYPE_F32);
-					float* data16 = static_cast<float*>(img2->data[z]);
-					color2 = vfloat4(
-					    astc::clamp64Kf(data16[(4 * xsize2 * y) + (4 * x    )]),
-					    astc::clamp64Kf(data16[(4 * xsize2 * y) + (4 * x + 1)]),
-					    astc::clamp64Kf(data16[(4 * xsize2 * y) + (4 * x + 2)]),
-					    astc::clamp64Kf(data16[(4 * xsize2 * y) + (4 * x + 3)]));
-				}
-
-				rgb_peak = astc::max(color1.lane<0>(), color1.lane<1>(), color1.lane<2>(), rgb_peak);
-
-				vfloat4 diffcolor = color1 - color2;
-				errorsum += diffcolor * diffcolor;
-
-				vfloat4 alpha_scaled_diffcolor = vfloat4(
-				    diffcolor.lane<0>() * color1.lane<3>(),
-				    diffcolor.lane<1>() * color1.lane<3>(),
-				    diffcolor.lane<2>() * color1.lane<3>(),
-				    diffcolor.lane<3>());
-
-				alpha_scaled_errorsum += alpha_scaled_diffcolor * \
-				                         alpha_scaled_diffcolor;
-
-				if (compute_hdr_metrics)
-				{
-					vfloat4 log_input_color1 = vfloat4(
-					    astc::xlog2(color1.lane<0>()),
-					    astc::xlog2(color1.lane<1>()),
-					    astc::xlog2(color1.lane<2>()),
-					    astc::xlog2(color1.lane<3>()));
-
-					vfloat4 log_input_color2 = vfloat4(
-					    astc::xlog2(color2.lane<0>()),
-					    astc::xlog2(color2.lane<1>()),
-					    astc::xlog2(color2.lane<2>()),
-					    astc::xlog2(color2.lane<3>()));
-
-					vfloat4 log_diffcolor = log_input_color1 - log_input_color2;
-
-					log_errorsum += log_diffcolor * log_diffcolor;
-
-					vfloat4 mpsnr_error = vfloat4(
-					    mpsnr_sumdiff(color1.lane<0>(), color2.lane<0>(), fstop_lo, fstop_hi),
-					    mpsnr_sumdiff(color1.lane<1>(), color2.lane<1>(), fstop_lo, fstop_hi),
-					    mpsnr_sumdiff(color1.lane<2>(), color2.lane<2>(), fstop_lo, fstop_hi),
-					    mpsnr_sumdiff(color1.lane<3>(), color2.lane<3>(), fstop_lo, fstop_hi));
-
-					mpsnr_errorsum += mpsnr_error;
-				}
-			}
-		}
+		errorsum += rows[i].errorsum;
+		alpha_scaled_errorsum += rows[i].alpha_scaled_errorsum;
+		log_errorsum += rows[i].log_errorsum;
+		mpsnr_errorsum += rows[i].mpsnr_errorsum;
+		peak = max(peak, rows[i].peak);
 	}
 
+	delete[] rows;
+
+	float rgb_peak = astc::max(peak.lane<0>(), peak.lane<1>(), peak.lane<2>());
+
 	float pixels = (float)(dim_x * dim_y * dim_z);
 	float num = 0.0f;
 	float alpha_num = 0.0f;
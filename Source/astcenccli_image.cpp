@@ -24,16 +24,60 @@
 
 #include "astcenccli_internal.h"
 
+/**
+ * @brief An image, and the owner of its data.
+ *
+ * All images created by the command line tool use this layout, so images
+ * which use data owned by a decoder or a file mapping can be freed in the same
+ * way as allocated images.
+ */
+struct owned_image
+{
+	/** The image; must be the first member. */
+	astcenc_image image;
+	/** The function to release the data, or @c nullptr for allocated data. */
+	void (*release)(void*);
+	/** The payload for the release function. */
+	void* owner;
+};
+
+/**
+ * @brief Get the image data type for a bitness.
+ */
+static astcenc_type get_bitness_type(
+	unsigned int bitness
+) {
+	if (bitness == 8)
+	{
+		return ASTCENC_TYPE_U8;
+	}
+
+	if (bitness == 16)
+	{
+		return ASTCENC_TYPE_F16;
+	}
+
+	assert(bitness == 32);
+	return ASTCENC_TYPE_F32;
+}
+
 astcenc_image *alloc_image(
 	unsigned int bitness,
 	unsigned int dim_x,
 	unsigned int dim_y,
 	unsigned int dim_z
 ) {
-	astcenc_image *img = new astcenc_image;
+	owned_image* owned = new owned_image;
+	owned->release = nullptr;
+	owned->owner = nullptr;
+
+	astcenc_image *img = &owned->image;
 	img->dim_x = dim_x;
 	img->dim_y = dim_y;
 	img->dim_z = dim_z;
+	img->components = 4;
+	img->row_pitch = 0;
+	img->slice_pitch = 0;
 
 	if (bitness == 8)
 	{
@@ -73,6 +117,37 @@ astcenc_image *alloc_image(
 	return img;
 }
 
+astcenc_image* wrap_image(
+	unsigned int bitness,
+	unsigned int dim_x,
+	unsigned int dim_y,
+	unsigned int dim_z,
+	void* const* slices,
+	void (*release)(void*),
+	void* owner
+) {
+	owned_image* owned = new owned_image;
+	owned->release = release;
+	owned->owner = owner;
+
+	astcenc_image *img = &owned->image;
+	img->dim_x = dim_x;
+	img->dim_y = dim_y;
+	img->dim_z = dim_z;
+	img->components = 4;
+	img->row_pitch = 0;
+	img->slice_pitch = 0;
+	img->data_type = get_bitness_type(bitness);
+	img->data = new void*[dim_z];
+
+	for (unsigned int z = 0; z < dim_z; z++)
+	{
+		img->data[z] = slices[z];
+	}
+
+	return img;
+}
+
 void free_image(astcenc_image * img)
 {
 	if (img == nullptr)
@@ -80,13 +155,45 @@ void free_image(astcenc_image * img)
 		return;
 	}
 
-	for (unsigned int z = 0; z < img->dim_z; z++)
+	owned_image* owned = reinterpret_cast<owned_image*>(img);
+	if (owned->release)
 	{
-		delete[] (char*)img->data[z];
+		owned->release(owned->owner);
+	}
+	else
+	{
+		for (unsigned int z = 0; z < img->dim_z; z++)
+		{
+			delete[] (char*)img->data[z];
+		}
 	}
 
 	delete[] img->data;
-	delete img;
+	delete owned;
+}
+
+void flip_image_rows(
+	void* data,
+	size_t row_bytes,
+	unsigned int row_count
+) {
+	uint8_t* rows = static_cast<uint8_t*>(data);
+	uint8_t tmp[256];
+
+	for (unsigned int y = 0; y < row_count / 2; y++)
+	{
+		uint8_t* top = rows + y * row_bytes;
+		uint8_t* bottom = rows + (row_count - y - 1) * row_bytes;
+
+		// Swap the rows in chunks, so no row sized temporary is needed
+		for (size_t i = 0; i < row_bytes; i += sizeof(tmp))
+		{
+			size_t chunk = astc::min(sizeof(tmp), row_bytes - i);
+			memcpy(tmp, top + i, chunk);
+			memcpy(top + i, bottom + i, chunk);
+			memcpy(bottom + i, tmp, chunk);
+		}
+	}
 }
 
 int determine_image_channels(const astcenc_image * img)
@@ -172,75 +279,6 @@ int determine_image_channels(const astcenc_image * img)
 	return image_channels;
 }
 
-// initialize an astcenc_image data structure from a 2D array of RGBA float*4
-astcenc_image* astc_img_from_floatx4_array(
-	const float* data,
-	unsigned int dim_x,
-	unsigned int dim_y,
-	bool y_flip
-) {
-	// TODO: Make this 32 to use direct passthough as float
-	astcenc_image* img = alloc_image(16, dim_x, dim_y, 1);
-
-	for (unsigned int y = 0; y < dim_y; y++)
-	{
-#if 0
-		float*** data32 = static_cast<float***>(img->data);
-		unsigned int y_src = y_flip ? (dim_y - y - 1) : y;
-		const float* src = data + 4 * dim_x * y_src;
-
-		for (unsigned int x = 0; x < dim_x; x++)
-		{
-			data32[0][y][4 * x    ] = src[4 * x    ];
-			data32[0][y][4 * x + 1] = src[4 * x + 1];
-			data32[0][y][4 * x + 2] = src[4 * x + 2];
-			data32[0][y][4 * x + 3] = src[4 * x + 3];
-		}
-#else
-		uint16_t* data16 = static_cast<uint16_t*>(img->data[0]);
-		unsigned int y_src = y_flip ? (dim_y - y - 1) : y;
-		const float* src = data + 4 * dim_x * y_src;
-
-		for (unsigned int x = 0; x < dim_x; x++)
-		{
-			data16[(4 * dim_x * y) + (4 * x    )] = float_to_sf16(src[4 * x    ], SF_NEARESTEVEN);
-			data16[(4 * dim_x * y) + (4 * x + 1)] = float_to_sf16(src[4 * x + 1], SF_NEARESTEVEN);
-			data16[(4 * dim_x * y) + (4 * x + 2)] = float_to_sf16(src[4 * x + 2], SF_NEARESTEVEN);
-			data16[(4 * dim_x * y) + (4 * x + 3)] = float_to_sf16(src[4 * x + 3], SF_NEARESTEVEN);
-		}
-#endif
-	}
-
-	return img;
-}
-
-// initialize an astcenc_image data structure from a 2D array of UNORM8
-astcenc_image* astc_img_from_unorm8x4_array(
-	const uint8_t* data,
-	unsigned int dim_x,
-	unsigned int dim_y,
-	bool y_flip
-) {
-	astcenc_image* img = alloc_image(8, dim_x, dim_y, 1);
-
-	for (unsigned int y = 0; y < dim_y; y++)
-	{
-		uint8_t* data8 = static_cast<uint8_t*>(img->data[0]);
-		unsigned int y_src = y_flip ? (dim_y - y - 1) : y;
-		const uint8_t* src = data + 4 * dim_x * y_src;
-
-		for (unsigned int x = 0; x < dim_x; x++)
-		{
-			data8[(4 * dim_x * y) + (4 * x    )] = src[4 * x    ];
-			data8[(4 * dim_x * y) + (4 * x + 1)] = src[4 * x + 1];
-			data8[(4 * dim_x * y) + (4 * x + 2)] = src[4 * x + 2];
-			data8[(4 * dim_x * y) + (4 * x + 3)] = src[4 * x + 3];
-		}
-	}
-
-	return img;
-}
-
 // initialize a flattened array of float values from an ASTC codec image
 // The returned array is allocated with new[] and must be deleted with delete[].
 float* floatx4_array_from_astc_img(
@@ -25,6 +25,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <vector>
 
 #include "astcenccli_internal.h"
 
@@ -32,10 +33,32 @@
 #include "stb_image_write.h"
 #include "tinyexr.h"
 
+#if defined(ASTCENC_ZSTD)
+	#include <zstd.h>
+#endif
+
 /*******************************************************************
 Image load and store through the stb_iamge and tinyexr libraries
 *******************************************************************/
 
+/**
+ * @brief Release image data decoded by tinyexr.
+ */
+static void release_tinyexr_data(
+	void* data
+) {
+	free(data);
+}
+
+/**
+ * @brief Release image data decoded by stb_image.
+ */
+static void release_stb_data(
+	void* data
+) {
+	stbi_image_free(data);
+}
+
 static astcenc_image* load_image_with_tinyexr(
 	const char* filename,
 	bool y_flip,
@@ -54,8 +77,14 @@ static astcenc_image* load_image_with_tinyexr(
 		return nullptr;
 	}
 
-	astcenc_image* res_img = astc_img_from_floatx4_array(image, dim_x, dim_y, y_flip);
-	free(image);
+	// Use the decoded RGBA float data directly, rather than a copy
+	if (y_flip)
+	{
+		flip_image_rows(image, 4 * sizeof(float) * dim_x, dim_y);
+	}
+
+	void* slices[1] { image };
+	astcenc_image* res_img = wrap_image(32, dim_x, dim_y, 1, slices, release_tinyexr_data, image);
 
 	is_hdr = true;
 	component_count = 4;
@@ -70,13 +99,19 @@ static astcenc_image* load_image_with_stb(
 ) {
 	int dim_x, dim_y;
 
+	// Use the decoded RGBA data directly, rather than a copy
 	if (stbi_is_hdr(filename))
 	{
 		float* data = stbi_loadf(filename, &dim_x, &dim_y, nullptr, STBI_rgb_alpha);
 		if (data)
 		{
-			astcenc_image* img = astc_img_from_floatx4_array(data, dim_x, dim_y, y_flip);
-			stbi_image_free(data);
+			if (y_flip)
+			{
+				flip_image_rows(data, 4 * sizeof(float) * dim_x, dim_y);
+			}
+
+			void* slices[1] { data };
+			astcenc_image* img = wrap_image(32, dim_x, dim_y, 1, slices, release_stb_data, data);
 			is_hdr = true;
 			component_count = 4;
 			return img;
@@ -87,8 +122,13 @@ static astcenc_image* load_image_with_stb(
 		uint8_t* data = stbi_load(filename, &dim_x, &dim_y, nullptr, STBI_rgb_alpha);
 		if (data)
 		{
-			astcenc_image* img = astc_img_from_unorm8x4_array(data, dim_x, dim_y, y_flip);
-			stbi_image_free(data);
+			if (y_flip)
+			{
+				flip_image_rows(data, 4 * dim_x, dim_y);
+			}
+
+			void* slices[1] { data };
+			astcenc_image* img = wrap_image(8, dim_x, dim_y, 1, slices, release_stb_data, data);
 			is_hdr = false;
 			component_count = 4;
 			return img;
@@ -718,6 +758,75 @@ static void ktx_header_switch_endianness(ktx_header * kt)
 	#undef REV
 }
 
+/**
+ * @brief Release the file mapping used by an image.
+ */
+static void release_mapped_file(
+	void* file
+) {
+	unmap_file(static_cast<mapped_file*>(file));
+}
+
+/**
+ * @brief Create an image which uses the surface data of a mapped file.
+ *
+ * The surface must already be tightly packed RGBA data in the codec layout.
+ * If Y flipping is requested the rows are flipped in the private mapping.
+ *
+ * @param filename   The file path on disk.
+ * @param offset     The offset of the surface data in the file, in bytes.
+ * @param bitness    The surface data bitness; 8 (U8), 16 (F16), or 32 (F32).
+ * @param dim_x      The image width.
+ * @param dim_y      The image height.
+ * @param dim_z      The image depth.
+ * @param y_flip     Should this image be Y flipped?
+ *
+ * @return The image, or @c nullptr if the file cannot be mapped.
+ */
+static astcenc_image* wrap_mapped_surface(
+	const char* filename,
+	long offset,
+	unsigned int bitness,
+	unsigned int dim_x,
+	unsigned int dim_y,
+	unsigned int dim_z,
+	bool y_flip
+) {
+	size_t component_bytes = bitness / 8;
+	size_t row_bytes = 4 * component_bytes * dim_x;
+	size_t slice_bytes = row_bytes * dim_y;
+
+	// Components must be naturally aligned to be used in place
+	if ((offset < 0) || (offset % component_bytes != 0))
+	{
+		return nullptr;
+	}
+
+	mapped_file* file = map_file(filename);
+	if (!file)
+	{
+		return nullptr;
+	}
+
+	if (file->size < static_cast<size_t>(offset) + slice_bytes * dim_z)
+	{
+		unmap_file(file);
+		return nullptr;
+	}
+
+	std::vector<void*> slices(dim_z);
+	for (unsigned int z = 0; z < dim_z; z++)
+	{
+		slices[z] = file->data + offset + z * slice_bytes;
+		if (y_flip)
+		{
+			flip_image_rows(slices[z], row_bytes, dim_y);
+		}
+	}
+
+	return wrap_image(bitness, dim_x, dim_y, dim_z, slices.data(), release_mapped_file, file);
+}
+
 static astcenc_image* load_ktx_uncompressed_image(
 	const char* filename,
 	bool y_flip,
@@ -986,6 +1095,19 @@ static astcenc_image* load_ktx_uncompressed_image(
 		return nullptr;
 	}
 
+	// Use the file data in place if it is already in the codec layout
+	if (!switch_endianness && (cm == RGBA8_TO_RGBA8 || cm == RGBA16F_TO_RGBA16F || cm == RGBA32F_TO_RGBA16F))
+	{
+		astcenc_image* astc_img = wrap_mapped_surface(filename, ftell(f), bitness, dim_x, dim_y, dim_z, y_flip);
+		if (astc_img)
+		{
+			fclose(f);
+			is_hdr = bitness == 32;
+			component_count = components;
+			return astc_img;
+		}
+	}
+
 	uint8_t *buf = new uint8_t[specified_bytes_of_surface];
 	size_t bytes_read = fread(buf, 1, specified_bytes_of_surface, f);
 	fclose(f);
@@ -1151,10 +1273,12 @@ bool load_ktx_compressed_image(
 
 
 bool store_ktx_compressed_image(
-	const astc_compressed_image& img,
+	const astc_compressed_image* levels,
+	unsigned int level_count,
 	const char* filename,
 	bool srgb
 ) {
+	const astc_compressed_image& img = levels[0];
 	unsigned int fmt = get_format(img.block_x, img.block_y, img.block_z, srgb);
 
 	ktx_header hdr;
@@ -1170,10 +1294,10 @@ bool store_ktx_compressed_image(
 	hdr.pixel_depth = (img.dim_z == 1) ? 0 : img.dim_z;
 	hdr.number_of_array_elements = 0;
 	hdr.number_of_faces = 1;
-	hdr.number_of_mipmap_levels = 1;
+	hdr.number_of_mipmap_levels = level_count;
 	hdr.bytes_of_key_value_data = 0;
 
-	size_t expected = sizeof(ktx_header) + 4 + img.data_len;
+	size_t expected = sizeof(ktx_header);
 	size_t actual = 0;
 
 	FILE *wf = fopen(filename, "wb");
@@ -1183,8 +1307,16 @@ bool store_ktx_compressed_image(
 	}
 
 	actual += fwrite(&hdr, 1, sizeof(ktx_header), wf);
-	actual += fwrite(&img.data_len, 1, 4, wf);
-	actual += fwrite(img.data, 1, img.data_len, wf);
+
+	// ASTC blocks are 16 bytes, so levels never need KTX mip padding
+	for (unsigned int i = 0; i < level_count; i++)
+	{
+		uint32_t data_len = static_cast<uint32_t>(levels[i].data_len);
+		expected += 4 + levels[i].data_len;
+		actual += fwrite(&data_len, 1, 4, wf);
+		actual += fwrite(levels[i].data, 1, levels[i].data_len, wf);
+	}
+
 	fclose(wf);
 
 	if (actual != expected)
@@ -1195,6 +1327,398 @@ bool store_ktx_compressed_image(
 	return false;
 }
 
+/*******************************************************************
+KTX2 compressed image load and store, with optional zstd supercompression
+*******************************************************************/
+
+#define VK_FORMAT_UNDEFINED                   0
+#define VK_FORMAT_ASTC_4x4_UNORM_BLOCK        157
+#define VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK_EXT   1000066000
+
+#define KHR_DF_MODEL_ASTC                     162
+#define KHR_DF_PRIMARIES_BT709                1
+#define KHR_DF_TRANSFER_LINEAR                1
+#define KHR_DF_TRANSFER_SRGB                  2
+#define KHR_DF_SAMPLE_DATATYPE_SIGNED         0x40
+#define KHR_DF_SAMPLE_DATATYPE_FLOAT          0x80
+
+#define KTX2_SS_NONE                          0
+#define KTX2_SS_ZSTD                          2
+
+struct ktx2_header
+{
+	uint8_t magic[12];
+	uint32_t vk_format;              // VK_FORMAT_UNDEFINED if no Vulkan format exists
+	uint32_t type_size;              // 1 for block compressed formats
+	uint32_t pixel_width;
+	uint32_t pixel_height;
+	uint32_t pixel_depth;            // 0 for 2D textures
+	uint32_t layer_count;            // 0 if not an array texture
+	uint32_t face_count;             // 6 for cubemaps, 1 for non-cubemaps
+	uint32_t level_count;
+	uint32_t supercompression_scheme;
+	uint32_t dfd_byte_offset;
+	uint32_t dfd_byte_length;
+	uint32_t kvd_byte_offset;
+	uint32_t kvd_byte_length;
+	uint64_t sgd_byte_offset;
+	uint64_t sgd_byte_length;
+};
+
+struct ktx2_level_index
+{
+	uint64_t byte_offset;
+	uint64_t byte_length;
+	uint64_t uncompressed_byte_length;
+};
+
+// magic 12-byte sequence that must appear at the beginning of every KTX2 file.
+static const uint8_t ktx2_magic[12] = {
+	0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+
+// The 2D block sizes, in Vulkan format enum order
+static const uint8_t ktx2_vk_block_sizes[14][2] = {
+	{ 4,  4}, { 5,  4}, { 5,  5}, { 6,  5}, { 6,  6}, { 8,  5}, { 8,  6},
+	{ 8,  8}, {10,  5}, {10,  6}, {10,  8}, {10, 10}, {12, 10}, {12, 12}
+};
+
+// The chunk size used for streaming supercompression, in bytes
+static const size_t KTX2_STREAM_CHUNK = 64 * 1024;
+
+/**
+ * @brief Get the Vulkan format for an ASTC block size and profile.
+ *
+ * @param img       The compressed image.
+ * @param profile   The color profile.
+ *
+ * @return The Vulkan format, or VK_FORMAT_UNDEFINED for 3D block sizes.
+ */
+static uint32_t get_ktx2_vk_format(
+	const astc_compressed_image& img,
+	astcenc_profile profile
+) {
+	if (img.block_z != 1)
+	{
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	for (uint32_t i = 0; i < 14; i++)
+	{
+		if ((ktx2_vk_block_sizes[i][0] == img.block_x) &&
+		    (ktx2_vk_block_sizes[i][1] == img.block_y))
+		{
+			if ((profile == ASTCENC_PRF_HDR) || (profile == ASTCENC_PRF_HDR_RGB_LDR_A))
+			{
+				return VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK_EXT + i;
+			}
+
+			uint32_t srgb = profile == ASTCENC_PRF_LDR_SRGB ? 1 : 0;
+			return VK_FORMAT_ASTC_4x4_UNORM_BLOCK + 2 * i + srgb;
+		}
+	}
+
+	return VK_FORMAT_UNDEFINED;
+}
+
+/**
+ * @brief Write a level to file, supercompressing it if requested.
+ *
+ * Supercompressed data is streamed out in chunks as it is produced, so the
+ * complete supercompressed level is never held in memory.
+ *
+ * @param      wf           The output file.
+ * @param      level        The compressed level.
+ * @param      zstd_level   The zstd compression level, or 0 to store.
+ * @param[out] byte_length  The number of bytes written.
+ *
+ * @return @c true on error, @c false on success.
+ */
+static bool store_ktx2_level(
+	FILE* wf,
+	const astc_compressed_image& level,
+	int zstd_level,
+	uint64_t& byte_length
+) {
+	if (zstd_level == 0)
+	{
+		byte_length = level.data_len;
+		return fwrite(level.data, 1, level.data_len, wf) != level.data_len;
+	}
+
+#if defined(ASTCENC_ZSTD)
+	ZSTD_CCtx* cctx = ZSTD_createCCtx();
+	if (!cctx)
+	{
+		return true;
+	}
+
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, zstd_level);
+	ZSTD_CCtx_setPledgedSrcSize(cctx, level.data_len);
+
+	std::vector<uint8_t> chunk(KTX2_STREAM_CHUNK);
+	byte_length = 0;
+	bool error = false;
+
+	// Feed the level in chunks, writing out each block of output as soon as
+	// it is produced by the compressor
+	size_t pos = 0;
+	size_t remaining;
+	do
+	{
+		size_t in_size = astc::min(level.data_len - pos, KTX2_STREAM_CHUNK);
+		bool last = pos + in_size == level.data_len;
+		ZSTD_inBuffer in { level.data + pos, in_size, 0 };
+		ZSTD_EndDirective mode = last ? ZSTD_e_end : ZSTD_e_continue;
+		do
+		{
+			ZSTD_outBuffer out { chunk.data(), chunk.size(), 0 };
+			remaining = ZSTD_compressStream2(cctx, &out, &in, mode);
+			if (ZSTD_isError(remaining) ||
+			    (fwrite(chunk.data(), 1, out.pos, wf) != out.pos))
+			{
+				error = true;
+				break;
+			}
+
+			byte_length += out.pos;
+		} while (last ? (remaining != 0) : (in.pos != in.size));
+
+		pos += in_size;
+	} while (!error && (pos != level.data_len));
+
+	ZSTD_freeCCtx(cctx);
+	return error;
+#else
+	(void)wf;
+	(void)byte_length;
+	return true;
+#endif
+}
+
+/* See header for documentation. */
+bool store_ktx2_compressed_image(
+	const astc_compressed_image* levels,
+	unsigned int level_count,
+	const char* filename,
+	astcenc_profile profile,
+	int zstd_level
+) {
+	const astc_compressed_image& img = levels[0];
+	bool is_hdr = (profile == ASTCENC_PRF_HDR) || (profile == ASTCENC_PRF_HDR_RGB_LDR_A);
+
+	static const char writer_key[] = "KTXwriter";
+	static const char writer_value[] = "astcenc";
+	uint32_t kvd_length = sizeof(writer_key) + sizeof(writer_value);
+	uint32_t kvd_padding = (4 - (kvd_length % 4)) % 4;
+
+	ktx2_header hdr;
+	memcpy(hdr.magic, ktx2_magic, 12);
+	hdr.vk_format = get_ktx2_vk_format(img, profile);
+	hdr.type_size = 1;
+	hdr.pixel_width = img.dim_x;
+	hdr.pixel_height = img.dim_y;
+	hdr.pixel_depth = (img.dim_z == 1) ? 0 : img.dim_z;
+	hdr.layer_count = 0;
+	hdr.face_count = 1;
+	hdr.level_count = level_count;
+	hdr.supercompression_scheme = zstd_level ? KTX2_SS_ZSTD : KTX2_SS_NONE;
+	hdr.dfd_byte_offset = static_cast<uint32_t>(sizeof(ktx2_header) + level_count * sizeof(ktx2_level_index));
+	hdr.dfd_byte_length = 44;
+	hdr.kvd_byte_offset = hdr.dfd_byte_offset + hdr.dfd_byte_length;
+	hdr.kvd_byte_length = 4 + kvd_length;
+	hdr.sgd_byte_offset = 0;
+	hdr.sgd_byte_length = 0;
+
+	// Basic data format descriptor with a single ASTC sample
+	uint32_t transfer = profile == ASTCENC_PRF_LDR_SRGB ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR;
+	uint32_t channel = is_hdr ? KHR_DF_SAMPLE_DATATYPE_SIGNED | KHR_DF_SAMPLE_DATATYPE_FLOAT : 0;
+	uint32_t dfd[11] {
+		hdr.dfd_byte_length,
+		0,
+		2 | (40 << 16),
+		KHR_DF_MODEL_ASTC | (KHR_DF_PRIMARIES_BT709 << 8) | (transfer << 16),
+		(img.block_x - 1) | ((img.block_y - 1) << 8) | ((img.block_z - 1) << 16),
+		16,
+		0,
+		(127 << 16) | (channel << 24),
+		0,
+		is_hdr ? 0xBF800000 : 0,
+		is_hdr ? 0x3F800000 : 0xFFFFFFFF
+	};
+
+	FILE *wf = fopen(filename, "wb");
+	if (!wf)
+	{
+		return true;
+	}
+
+	// The level index is written once the supercompressed sizes are known
+	std::vector<ktx2_level_index> index(level_count);
+	size_t expected = sizeof(ktx2_header) + index.size() * sizeof(ktx2_level_index) +
+	                  sizeof(dfd) + 4 + kvd_length + kvd_padding;
+	size_t actual = 0;
+
+	uint8_t padding[16] { 0 };
+	actual += fwrite(&hdr, 1, sizeof(hdr), wf);
+	actual += fwrite(index.data(), 1, index.size() * sizeof(ktx2_level_index), wf);
+	actual += fwrite(dfd, 1, sizeof(dfd), wf);
+	actual += fwrite(&kvd_length, 1, 4, wf);
+	actual += fwrite(writer_key, 1, sizeof(writer_key), wf);
+	actual += fwrite(writer_value, 1, sizeof(writer_value), wf);
+	actual += fwrite(padding, 1, kvd_padding, wf);
+
+	// Levels are stored smallest first; uncompressed levels are aligned to
+	// the 16 byte block size, supercompressed levels are not aligned
+	uint64_t offset = expected;
+	bool error = actual != expected;
+	for (unsigned int i = level_count; !error && (i > 0); i--)
+	{
+		const astc_compressed_image& level = levels[i - 1];
+		ktx2_level_index& entry = index[i - 1];
+
+		size_t align = zstd_level ? 0 : (16 - (offset % 16)) % 16;
+		error = fwrite(padding, 1, align, wf) != align;
+		offset += align;
+
+		entry.byte_offset = offset;
+		entry.uncompressed_byte_length = level.data_len;
+		error = error || store_ktx2_level(wf, level, zstd_level, entry.byte_length);
+		offset += entry.byte_length;
+	}
+
+	if (!error)
+	{
+		error = fseek(wf, sizeof(ktx2_header), SEEK_SET) ||
+		        (fwrite(index.data(), 1, index.size() * sizeof(ktx2_level_index), wf) !=
+		         index.size() * sizeof(ktx2_level_index));
+	}
+
+	error = fclose(wf) || error;
+	return error;
+}
+
+/* See header for documentation. */
+bool load_ktx2_compressed_image(
+	const char* filename,
+	bool& is_srgb,
+	astc_compressed_image& img
+) {
+	FILE *f = fopen(filename, "rb");
+	if (!f)
+	{
+		printf("Failed to open file %s\n", filename);
+		return true;
+	}
+
+	ktx2_header hdr;
+	ktx2_level_index level;
+	uint32_t dfd[11];
+	if ((fread(&hdr, 1, sizeof(hdr), f) != sizeof(hdr)) ||
+	    (fread(&level, 1, sizeof(level), f) != sizeof(level)))
+	{
+		printf("Failed to read header from %s\n", filename);
+		fclose(f);
+		return true;
+	}
+
+	if (memcmp(hdr.magic, ktx2_magic, 12) != 0)
+	{
+		printf("File %s does not have a valid KTX2 header\n", filename);
+		fclose(f);
+		return true;
+	}
+
+	// The block size is taken from the data format descriptor, which also
+	// describes the 3D block sizes that have no Vulkan format
+	if ((hdr.dfd_byte_length < sizeof(dfd)) ||
+	    fseek(f, hdr.dfd_byte_offset, SEEK_SET) ||
+	    (fread(dfd, 1, sizeof(dfd), f) != sizeof(dfd)) ||
+	    ((dfd[3] & 0xFF) != KHR_DF_MODEL_ASTC) ||
+	    (hdr.layer_count > 1) || (hdr.face_count != 1))
+	{
+		printf("File %s is not a compressed ASTC file\n", filename);
+		fclose(f);
+		return true;
+	}
+
+	img.block_x = (dfd[4] & 0xFF) + 1;
+	img.block_y = ((dfd[4] >> 8) & 0xFF) + 1;
+	img.block_z = ((dfd[4] >> 16) & 0xFF) + 1;
+
+	img.dim_x = hdr.pixel_width;
+	img.dim_y = hdr.pixel_height;
+	img.dim_z = hdr.pixel_depth == 0 ? 1 : hdr.pixel_depth;
+
+	size_t blocks_x = (img.dim_x + img.block_x - 1) / img.block_x;
+	size_t blocks_y = (img.dim_y + img.block_y - 1) / img.block_y;
+	size_t blocks_z = (img.dim_z + img.block_z - 1) / img.block_z;
+	size_t data_len = blocks_x * blocks_y * blocks_z * 16;
+
+	if ((level.uncompressed_byte_length != data_len) ||
+	    ((hdr.supercompression_scheme == KTX2_SS_NONE) && (level.byte_length != data_len)) ||
+	    fseek(f, static_cast<long>(level.byte_offset), SEEK_SET))
+	{
+		printf("Failed to read mip 0 data from %s\n", filename);
+		fclose(f);
+		return true;
+	}
+
+	uint8_t* data = new uint8_t[data_len];
+	bool error = false;
+	if (hdr.supercompression_scheme == KTX2_SS_NONE)
+	{
+		error = fread(data, 1, data_len, f) != data_len;
+	}
+#if defined(ASTCENC_ZSTD)
+	else if (hdr.supercompression_scheme == KTX2_SS_ZSTD)
+	{
+		// Stream the file through the decompressor in chunks, decompressing
+		// directly into the image data
+		ZSTD_DCtx* dctx = ZSTD_createDCtx();
+		std::vector<uint8_t> chunk(KTX2_STREAM_CHUNK);
+		ZSTD_outBuffer out { data, data_len, 0 };
+		uint64_t remaining = level.byte_length;
+		while (!error && (remaining != 0))
+		{
+			size_t in_size = static_cast<size_t>(astc::min<uint64_t>(remaining, chunk.size()));
+			error = fread(chunk.data(), 1, in_size, f) != in_size;
+			ZSTD_inBuffer in { chunk.data(), in_size, 0 };
+			while (!error && (in.pos != in.size))
+			{
+				error = ZSTD_isError(ZSTD_decompressStream(dctx, &out, &in)) ||
+				        ((in.pos != in.size) && (out.pos == out.size));
+			}
+
+			remaining -= in_size;
+		}
+
+		error = error || (out.pos != data_len);
+		ZSTD_freeDCtx(dctx);
+	}
+#endif
+	else
+	{
+		printf("File %s uses an unsupported supercompression scheme\n", filename);
+		fclose(f);
+		delete[] data;
+		return true;
+	}
+
+	fclose(f);
+	if (error)
+	{
+		printf("Failed to read mip 0 data from %s\n", filename);
+		delete[] data;
+		return true;
+	}
+
+	img.data = data;
+	img.data_len = data_len;
+	is_srgb = ((dfd[3] >> 16) & 0xFF) == KHR_DF_TRANSFER_SRGB;
+	return false;
+}
+
 static int store_ktx_uncompressed_image(
 	const astcenc_image* img,
 	const char* ktx_filename,
@@ -1720,6 +2244,20 @@ static astcenc_image* load_dds_uncompressed_image(
 	uint32_t ystride = xstride * dim_y;
 	uint32_t bytes_of_surface = ystride * dim_z;
 
+	// Use the file data in place if it is already in the codec layout
+	if (copy_method == RGBA8_TO_RGBA8 || copy_method == RGBA16F_TO_RGBA16F || copy_method == RGBA32F_TO_RGBA16F)
+	{
+		unsigned int surface_bitness = 8 * bytes_per_component;
+		astcenc_image* astc_img = wrap_mapped_surface(filename, ftell(f), surface_bitness, dim_x, dim_y, dim_z, y_flip);
+		if (astc_img)
+		{
+			fclose(f);
+			is_hdr = bitness == 16;
+			component_count = components;
+			return astc_img;
+		}
+	}
+
 	uint8_t *buf = new uint8_t[bytes_of_surface];
 	size_t bytes_read = fread(buf, 1, bytes_of_surface, f);
 	fclose(f);
@@ -2262,11 +2800,14 @@ int load_cimage(
 }
 
 
-int store_cimage(
+/* See header for documentation. */
+void get_cimage_header(
 	const astc_compressed_image& comp_img,
-	const char* filename
+	uint8_t* header
 ) {
 	astc_header hdr;
+	static_assert(sizeof(hdr) == ASTC_HEADER_SIZE, "Unexpected ASTC header size");
+
 	hdr.magic[0] =  ASTC_MAGIC_ID        & 0xFF;
 	hdr.magic[1] = (ASTC_MAGIC_ID >>  8) & 0xFF;
 	hdr.magic[2] = (ASTC_MAGIC_ID >> 16) & 0xFF;
@@ -2288,6 +2829,16 @@ int store_cimage(
 	hdr.dim_z[1] = (comp_img.dim_z >>  8) & 0xFF;
 	hdr.dim_z[2] = (comp_img.dim_z >> 16) & 0xFF;
 
+	memcpy(header, &hdr, sizeof(hdr));
+}
+
+int store_cimage(
+	const astc_compressed_image& comp_img,
+	const char* filename
+) {
+	uint8_t hdr[ASTC_HEADER_SIZE];
+	get_cimage_header(comp_img, hdr);
+
 	std::ofstream file(filename, std::ios::out | std::ios::binary);
 	if (!file)
 	{
@@ -2295,7 +2846,7 @@ int store_cimage(
 		return 1;
 	}
 
-	file.write((char*)&hdr, sizeof(astc_header));
+	file.write((char*)hdr, sizeof(hdr));
 	file.write((char*)comp_img.data, comp_img.data_len);
 	return 0;
 }
@@ -53,6 +53,17 @@ struct cli_config_options
 	int high_fstop;
 	astcenc_swizzle swz_encode;
 	astcenc_swizzle swz_decode;
+	bool print_stats;
+	bool mipmap;
+	float mipmap_alpha_cutoff;
+	int zstd_level;
+	bool direct_io;
+	unsigned int bench_iterations;
+	const char* bench_json;
+	const char* incremental_image;
+	const char* incremental_comp;
+	const char* warmstart_comp;
+	bool thread_affinity;
 };
 
 /**
@@ -86,9 +97,52 @@ astcenc_image* alloc_image(
 	unsigned int dim_y,
 	unsigned int dim_z);
 
+/**
+ * @brief Create an image which uses existing data, without a copy.
+ *
+ * The data must be tightly packed RGBA slices of the type given by the
+ * bitness. The image slice array is allocated, but the slices are not
+ * copied; @c release is called with @c owner when the image is freed.
+ *
+ * @param bitness   The data bitness; 8 (U8), 16 (F16), or 32 (F32).
+ * @param dim_x     The image width.
+ * @param dim_y     The image height.
+ * @param dim_z     The image depth.
+ * @param slices    The data for each slice.
+ * @param release   The function which releases the data.
+ * @param owner     The payload for the release function.
+ *
+ * @return The image.
+ */
+astcenc_image* wrap_image(
+	unsigned int bitness,
+	unsigned int dim_x,
+	unsigned int dim_y,
+	unsigned int dim_z,
+	void* const* slices,
+	void (*release)(void*),
+	void* owner);
+
+/**
+ * @brief Free an image created by alloc_image() or wrap_image().
+ *
+ * @param img   The image to free; may be @c nullptr.
+ */
 void free_image(
 	astcenc_image* img);
 
+/**
+ * @brief Flip the rows of an image in place.
+ *
+ * @param data        The image data.
+ * @param row_bytes   The size of each row, in bytes.
+ * @param row_count   The number of rows.
+ */
+void flip_image_rows(
+	void* data,
+	size_t row_bytes,
+	unsigned int row_count);
+
 int determine_image_channels(
 	const astcenc_image* img);
 
@@ -100,29 +154,79 @@ int store_cimage(
 	const astc_compressed_image& comp_img,
 	const char* filename);
 
+/**
+ * @brief The size of the ASTC compressed image file header.
+ */
+static const size_t ASTC_HEADER_SIZE = 16;
+
+/**
+ * @brief Get the file header of an ASTC compressed image.
+ *
+ * @param      comp_img   The compressed image.
+ * @param[out] header     The header, which is @c ASTC_HEADER_SIZE bytes.
+ */
+void get_cimage_header(
+	const astc_compressed_image& comp_img,
+	uint8_t* header);
+
 bool load_ktx_compressed_image(
 	const char* filename,
 	bool& is_srgb,
 	astc_compressed_image& img) ;
 
+/**
+ * @brief Store a compressed image, and optionally its mipmaps, in a KTX file.
+ *
+ * @param levels        The image levels, largest first.
+ * @param level_count   The number of levels; 1 stores no mipmaps.
+ * @param filename      The output file name.
+ * @param srgb          Store the image using an sRGB format.
+ *
+ * @return @c true on error, @c false on success.
+ */
 bool store_ktx_compressed_image(
-	const astc_compressed_image& img,
+	const astc_compressed_image* levels,
+	unsigned int level_count,
 	const char* filename,
 	bool srgb);
 
-// helper functions to prepare an ASTC image object from a flat array
-// Used by the image loaders in "astc_file_load_store.cpp"
-astcenc_image* astc_img_from_floatx4_array(
-	const float* data,
-	unsigned int dim_x,
-	unsigned int dim_y,
-	bool y_flip);
+/**
+ * @brief Load the first level of a compressed image from a KTX2 file.
+ *
+ * Supercompressed levels are decompressed directly into the image data,
+ * streaming the file through the decompressor in chunks.
+ *
+ * @param      filename   The input file name.
+ * @param[out] is_srgb    Is the image stored using an sRGB transfer function?
+ * @param[out] img        The compressed image.
+ *
+ * @return @c true on error, @c false on success.
+ */
+bool load_ktx2_compressed_image(
+	const char* filename,
+	bool& is_srgb,
+	astc_compressed_image& img);
 
-astcenc_image*astc_img_from_unorm8x4_array(
-	const uint8_t* data,
-	unsigned int dim_x,
-	unsigned int dim_y,
-	bool y_flip);
+/**
+ * @brief Store a compressed image, and optionally its mipmaps, in a KTX2 file.
+ *
+ * When supercompression is enabled each level is zstd compressed and written
+ * in chunks as the compressed stream is produced.
+ *
+ * @param levels        The image levels, largest first.
+ * @param level_count   The number of levels; 1 stores no mipmaps.
+ * @param filename      The output file name.
+ * @param profile       The color profile, which selects the format.
+ * @param zstd_level    The zstd supercompression level, or 0 for none.
+ *
+ * @return @c true on error, @c false on success.
+ */
+bool store_ktx2_compressed_image(
+	const astc_compressed_image* levels,
+	unsigned int level_count,
+	const char* filename,
+	astcenc_profile profile,
+	int zstd_level);
 
 // helper functions to prepare a flat array from an ASTC image object.
 // the array is allocated with new[], and must be freed with delete[].
@@ -152,6 +256,7 @@ void astcenc_print_longhelp();
  * @param img2                The compressed image.
  * @param fstop_lo            The low exposure fstop (HDR only).
  * @param fstop_hi            The high exposure fstop (HDR only).
+ * @param thread_count        The number of threads to use.
  */
 void compute_error_metrics(
 	int compute_hdr_metrics,
@@ -159,7 +264,8 @@ void compute_error_metrics(
 	const astcenc_image* img1,
 	const astcenc_image* img2,
 	int fstop_lo,
-	int fstop_hi);
+	int fstop_hi,
+	unsigned int thread_count);
 
 /**
  * @brief Get the current time.
@@ -175,6 +281,100 @@ double get_time();
  */
 int get_cpu_count();
 
+/**
+ * @brief A copy-on-write memory mapping of a file.
+ */
+struct mapped_file
+{
+	/** The mapped file data. */
+	uint8_t* data;
+	/** The size of the file, in bytes. */
+	size_t size;
+};
+
+/**
+ * @brief Map a file into memory.
+ *
+ * Writes to the mapped data are private to the process, and are not stored
+ * to the file.
+ *
+ * @param filename   The file path on disk.
+ *
+ * @return The file mapping, or @c nullptr on error.
+ */
+mapped_file* map_file(
+	const char* filename);
+
+/**
+ * @brief Unmap a file mapped by map_file().
+ *
+ * @param file   The file mapping to release.
+ */
+void unmap_file(
+	mapped_file* file);
+
+/**
+ * @brief An asynchronous file writer, created by async_writer_open().
+ */
+struct async_writer;
+
+/**
+ * @brief Open a file for asynchronous writing.
+ *
+ * Writes are performed in order by a background thread, so the caller can
+ * continue working while earlier data is written to the file. Data is written
+ * to a temporary file, which replaces the output file when the writer is
+ * closed, so a failed write never leaves a partial output file.
+ *
+ * @param filename    The file path on disk.
+ * @param direct_io   Use unbuffered direct I/O, if supported by the platform
+ *                    and file system; buffered I/O is used otherwise.
+ *
+ * @return The writer, or @c nullptr on error.
+ */
+async_writer* async_writer_open(
+	const char* filename,
+	bool direct_io);
+
+/**
+ * @brief Queue data to be written to the end of the file.
+ *
+ * The data is not copied, and must remain valid until the writer is closed.
+ *
+ * @param writer   The writer.
+ * @param data     The data to write.
+ * @param len      The length of the data.
+ */
+void async_writer_write(
+	async_writer* writer,
+	const uint8_t* data,
+	size_t len);
+
+/**
+ * @brief Wait for all queued writes to complete, and close the file.
+ *
+ * @param writer    The writer, which is freed.
+ * @param discard   Delete the file rather than storing it, e.g. on error.
+ *
+ * @return @c true on error, @c false on success.
+ */
+bool async_writer_close(
+	async_writer* writer,
+	bool discard);
+
+/**
+ * @brief Set whether launch_threads() binds each worker thread to a CPU.
+ *
+ * When enabled, worker thread N is bound to the Nth CPU the process may run
+ * on, so that it stays on one NUMA node and memory it first touches is local
+ * to it. This is only supported on Linux and Windows; on other platforms it
+ * does nothing. It is disabled by default.
+ *
+ * @param enable   Bind worker threads to CPUs?
+ */
+void set_thread_affinity(
+	bool enable);
+
 /**
  * @brief Launch N worker threads and wait for them to complete.
  *
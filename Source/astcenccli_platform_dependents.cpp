@@ -21,15 +21,26 @@
  * This module contains functions with strongly OS-dependent implementations:
  *
  *  * CPU count queries
+ *  * Thread affinity
+ *  * File mapping
+ *  * Unbuffered file output
  *  * Threading
  *  * Time
  *
  * In addition to the basic thread abstraction (which is native pthreads on
  * all platforms, except Windows where it is an emulation of pthreads), a
  * utility function to create N threads and wait for them to complete a batch
- * task has also been provided.
+ * task has also been provided, as has an asynchronous file writer.
  */
 
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "astcenccli_internal.h"
 
 /* ============================================================================
@@ -74,6 +85,38 @@ int get_cpu_count()
 	return sysinfo.dwNumberOfProcessors;
 }
 
+/**
+ * @brief Bind the calling thread to a single CPU.
+ *
+ * @param cpu_index   The index of the CPU in the set of CPUs the process may
+ *                    run on; wraps if larger than the set.
+ */
+static void bind_thread_to_cpu(
+	unsigned int cpu_index
+) {
+	DWORD_PTR process_mask;
+	DWORD_PTR system_mask;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) || !process_mask)
+	{
+		return;
+	}
+
+	unsigned int cpu_count = 0;
+	for (DWORD_PTR mask = process_mask; mask; mask &= mask - 1)
+	{
+		cpu_count++;
+	}
+
+	unsigned int skip = cpu_index % cpu_count;
+	DWORD_PTR mask = process_mask;
+	for (unsigned int i = 0; i < skip; i++)
+	{
+		mask &= mask - 1;
+	}
+
+	SetThreadAffinityMask(GetCurrentThread(), mask & (~mask + 1));
+}
+
 /* Public function, see header file for detailed documentation */
 double get_time()
 {
@@ -84,12 +127,164 @@ double get_time()
 	return ((double)ticks) / 1.0e7;
 }
 
+/* Public function, see header file for detailed documentation */
+mapped_file* map_file(
+	const char* filename
+) {
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+	                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return nullptr;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+	{
+		return nullptr;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data)
+	{
+		return nullptr;
+	}
+
+	mapped_file* mapped = new mapped_file;
+	mapped->data = static_cast<uint8_t*>(data);
+	mapped->size = static_cast<size_t>(size.QuadPart);
+	return mapped;
+}
+
+/* Public function, see header file for detailed documentation */
+void unmap_file(
+	mapped_file* file
+) {
+	UnmapViewOfFile(file->data);
+	delete file;
+}
+
+typedef HANDLE output_file;
+
+/**
+ * @brief Open a file for writing, truncating any existing file.
+ *
+ * @param      filename    The file path on disk.
+ * @param      direct      Request unbuffered direct I/O.
+ * @param[out] is_direct   Is the file using direct I/O?
+ * @param[out] file        The opened file.
+ *
+ * @return @c true on error, @c false on success.
+ */
+static bool open_output_file(
+	const char* filename,
+	bool direct,
+	bool& is_direct,
+	output_file& file
+) {
+	DWORD flags = FILE_ATTRIBUTE_NORMAL;
+	if (direct)
+	{
+		flags |= FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH;
+	}
+
+	file = CreateFileA(filename, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, flags, nullptr);
+	if ((file == INVALID_HANDLE_VALUE) && direct)
+	{
+		direct = false;
+		file = CreateFileA(filename, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+		                   FILE_ATTRIBUTE_NORMAL, nullptr);
+	}
+
+	is_direct = direct;
+	return file == INVALID_HANDLE_VALUE;
+}
+
+/**
+ * @brief Write data to a file.
+ *
+ * @param file   The file.
+ * @param data   The data to write.
+ * @param len    The length of the data; must be aligned for direct I/O.
+ *
+ * @return @c true on error, @c false on success.
+ */
+static bool write_output_file(
+	output_file file,
+	const uint8_t* data,
+	size_t len
+) {
+	while (len)
+	{
+		DWORD chunk = static_cast<DWORD>(astc::min<size_t>(len, 1u << 30));
+		DWORD written = 0;
+		if (!WriteFile(file, data, chunk, &written, nullptr) || (written == 0))
+		{
+			return true;
+		}
+
+		data += written;
+		len -= written;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Close a file, truncating it to its final size.
+ *
+ * @param file   The file.
+ * @param size   The final file size, which trims any direct I/O padding.
+ *
+ * @return @c true on error, @c false on success.
+ */
+static bool close_output_file(
+	output_file file,
+	uint64_t size
+) {
+	FILE_END_OF_FILE_INFO info;
+	info.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+	bool error = !SetFileInformationByHandle(file, FileEndOfFileInfo, &info, sizeof(info));
+	error = !CloseHandle(file) || error;
+	return error;
+}
+
+/**
+ * @brief Rename a file, replacing any existing file with the new name.
+ *
+ * @param from   The current file path on disk.
+ * @param to     The new file path on disk.
+ *
+ * @return @c true on error, @c false on success.
+ */
+static bool replace_file(
+	const char* from,
+	const char* to
+) {
+	return !MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING);
+}
+
 /* ============================================================================
    Platform code for an platform using POSIX APIs.
 ============================================================================ */
 #else
 
+#include <fcntl.h>
 #include <pthread.h>
+#if defined(__linux__)
+	#include <sched.h>
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <unistd.h>
 
@@ -99,6 +294,55 @@ int get_cpu_count()
 	return sysconf(_SC_NPROCESSORS_ONLN);
 }
 
+/**
+ * @brief Bind the calling thread to a single CPU.
+ *
+ * This is only supported on Linux; on other platforms it does nothing.
+ *
+ * @param cpu_index   The index of the CPU in the set of CPUs the process may
+ *                    run on; wraps if larger than the set.
+ */
+static void bind_thread_to_cpu(
+	unsigned int cpu_index
+) {
+#if defined(__linux__)
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+	{
+		return;
+	}
+
+	unsigned int cpu_count = CPU_COUNT(&allowed);
+	if (!cpu_count)
+	{
+		return;
+	}
+
+	unsigned int skip = cpu_index % cpu_count;
+	for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+	{
+		if (!CPU_ISSET(cpu, &allowed))
+		{
+			continue;
+		}
+
+		if (skip == 0)
+		{
+			cpu_set_t target;
+			CPU_ZERO(&target);
+			CPU_SET(cpu, &target);
+			pthread_setaffinity_np(pthread_self(), sizeof(target), &target);
+			return;
+		}
+
+		skip--;
+	}
+#else
+	(void)cpu_index;
+#endif
+}
+
 /* Public function, see header file for detailed documentation */
 double get_time()
 {
@@ -107,8 +351,160 @@ double get_time()
 	return (double)tv.tv_sec + (double)tv.tv_usec * 1.0e-6;
 }
 
+/* Public function, see header file for detailed documentation */
+mapped_file* map_file(
+	const char* filename
+) {
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+	{
+		return nullptr;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return nullptr;
+	}
+
+	size_t size = static_cast<size_t>(st.st_size);
+	void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	mapped_file* mapped = new mapped_file;
+	mapped->data = static_cast<uint8_t*>(data);
+	mapped->size = size;
+	return mapped;
+}
+
+/* Public function, see header file for detailed documentation */
+void unmap_file(
+	mapped_file* file
+) {
+	munmap(file->data, file->size);
+	delete file;
+}
+
+typedef int output_file;
+
+/**
+ * @brief Open a file for writing, truncating any existing file.
+ *
+ * @param      filename    The file path on disk.
+ * @param      direct      Request unbuffered direct I/O.
+ * @param[out] is_direct   Is the file using direct I/O?
+ * @param[out] file        The opened file.
+ *
+ * @return @c true on error, @c false on success.
+ */
+static bool open_output_file(
+	const char* filename,
+	bool direct,
+	bool& is_direct,
+	output_file& file
+) {
+	int flags = O_WRONLY | O_CREAT | O_TRUNC;
+	file = -1;
+
+#if defined(O_DIRECT)
+	// Not all file systems support direct I/O, so fall back to buffered I/O
+	if (direct)
+	{
+		file = open(filename, flags | O_DIRECT, 0644);
+	}
+#else
+	(void)direct;
+#endif
+
+	is_direct = file >= 0;
+	if (file < 0)
+	{
+		file = open(filename, flags, 0644);
+	}
+
+	return file < 0;
+}
+
+/**
+ * @brief Write data to a file.
+ *
+ * @param file   The file.
+ * @param data   The data to write.
+ * @param len    The length of the data; must be aligned for direct I/O.
+ *
+ * @return @c true on error, @c false on success.
+ */
+static bool write_output_file(
+	output_file file,
+	const uint8_t* data,
+	size_t len
+) {
+	while (len)
+	{
+		ssize_t written = write(file, data, len);
+		if (written <= 0)
+		{
+			return true;
+		}
+
+		data += written;
+		len -= static_cast<size_t>(written);
+	}
+
+	return false;
+}
+
+/**
+ * @brief Close a file, truncating it to its final size.
+ *
+ * @param file   The file.
+ * @param size   The final file size, which trims any direct I/O padding.
+ *
+ * @return @c true on error, @c false on success.
+ */
+static bool close_output_file(
+	output_file file,
+	uint64_t size
+) {
+	bool error = ftruncate(file, static_cast<off_t>(size)) != 0;
+	error = (close(file) != 0) || error;
+	return error;
+}
+
+/**
+ * @brief Rename a file, replacing any existing file with the new name.
+ *
+ * @param from   The current file path on disk.
+ * @param to     The new file path on disk.
+ *
+ * @return @c true on error, @c false on success.
+ */
+static bool replace_file(
+	const char* from,
+	const char* to
+) {
+	return rename(from, to) != 0;
+}
+
 #endif
 
+/**
+ * @brief Should launch_threads() bind each worker thread to a CPU?
+ */
+static bool bind_worker_threads = false;
+
+/* Public function, see header file for detailed documentation */
+void set_thread_affinity(
+	bool enable
+) {
+	bind_worker_threads = enable;
+}
+
 /**
  * @brief Worker thread helper payload for launch_threads.
  */
@@ -137,6 +533,11 @@ struct launch_desc
 static void* launch_threads_helper(void *p)
 {
 	launch_desc* ltd = (launch_desc*)p;
+	if (bind_worker_threads)
+	{
+		bind_thread_to_cpu(static_cast<unsigned int>(ltd->thread_id));
+	}
+
 	ltd->func(ltd->thread_count, ltd->thread_id, ltd->payload);
 	return nullptr;
 }
@@ -175,3 +576,213 @@ void launch_threads(
 
 	delete[] thread_descs;
 }
+
+/**
+ * @brief The alignment of direct I/O buffers, file offsets, and write sizes.
+ */
+static const size_t DIRECT_IO_ALIGNMENT = 4096;
+
+/**
+ * @brief The size of the direct I/O staging buffer.
+ */
+static const size_t DIRECT_IO_STAGING_SIZE = 1024 * 1024;
+
+/**
+ * @brief A single queued write.
+ */
+struct async_write
+{
+	/** The data to write. */
+	const uint8_t* data;
+	/** The length of the data. */
+	size_t len;
+};
+
+/**
+ * @brief The state of an asynchronous file writer.
+ */
+struct async_writer
+{
+	/** The native thread handle of the writer thread. */
+	pthread_t thread_handle;
+	/** The output file path, which is only created on success. */
+	std::string filename;
+	/** The temporary file path which is written. */
+	std::string temp_filename;
+	/** The output file. */
+	output_file file;
+	/** Is the file using direct I/O? */
+	bool is_direct;
+	/** Lock for the queue and the closing flag. */
+	std::mutex lock;
+	/** Condition variable signalled when a write is queued or on close. */
+	std::condition_variable queued;
+	/** The queued writes, in file order. */
+	std::deque<async_write> queue;
+	/** True once no further writes will be queued. */
+	bool closing;
+	/** True if any write failed; only accessed by the writer thread. */
+	bool error;
+	/** The number of bytes queued for the file, excluding padding. */
+	uint64_t size;
+	/** The direct I/O staging buffer allocation. */
+	std::vector<uint8_t> staging_alloc;
+	/** The aligned direct I/O staging buffer. */
+	uint8_t* staging;
+	/** The number of bytes in the staging buffer. */
+	size_t staged;
+};
+
+/**
+ * @brief Write queued data to file on the writer thread.
+ *
+ * Direct I/O requires aligned buffers and sizes, so data is copied in to an
+ * aligned staging buffer which is written once full.
+ *
+ * @param writer   The writer.
+ * @param write    The write to process.
+ */
+static void process_async_write(
+	async_writer& writer,
+	const async_write& write
+) {
+	if (writer.error)
+	{
+		return;
+	}
+
+	if (!writer.is_direct)
+	{
+		writer.error = write_output_file(writer.file, write.data, write.len);
+		return;
+	}
+
+	const uint8_t* data = write.data;
+	size_t len = write.len;
+	while (len && !writer.error)
+	{
+		size_t chunk = astc::min(len, DIRECT_IO_STAGING_SIZE - writer.staged);
+		memcpy(writer.staging + writer.staged, data, chunk);
+		writer.staged += chunk;
+		data += chunk;
+		len -= chunk;
+
+		if (writer.staged == DIRECT_IO_STAGING_SIZE)
+		{
+			writer.error = write_output_file(writer.file, writer.staging, writer.staged);
+			writer.staged = 0;
+		}
+	}
+}
+
+/**
+ * @brief Thread entry point for the writer thread.
+ *
+ * @param p   The writer.
+ */
+static void* async_writer_thread(void* p)
+{
+	async_writer& writer = *static_cast<async_writer*>(p);
+	while (true)
+	{
+		async_write write;
+		{
+			std::unique_lock<std::mutex> lck(writer.lock);
+			writer.queued.wait(lck, [&writer]{ return !writer.queue.empty() || writer.closing; });
+			if (writer.queue.empty())
+			{
+				break;
+			}
+
+			write = writer.queue.front();
+			writer.queue.pop_front();
+		}
+
+		process_async_write(writer, write);
+	}
+
+	// Flush the final partial staging buffer, padded to the alignment; the
+	// padding is trimmed when the file is closed
+	if (writer.is_direct && writer.staged && !writer.error)
+	{
+		size_t padded = (writer.staged + DIRECT_IO_ALIGNMENT - 1) & ~(DIRECT_IO_ALIGNMENT - 1);
+		memset(writer.staging + writer.staged, 0, padded - writer.staged);
+		writer.error = write_output_file(writer.file, writer.staging, padded);
+	}
+
+	return nullptr;
+}
+
+/* Public function, see header file for detailed documentation */
+async_writer* async_writer_open(
+	const char* filename,
+	bool direct_io
+) {
+	async_writer* writer = new async_writer;
+	writer->filename = filename;
+	writer->temp_filename = writer->filename + ".tmp";
+	if (open_output_file(writer->temp_filename.c_str(), direct_io, writer->is_direct, writer->file))
+	{
+		delete writer;
+		return nullptr;
+	}
+
+	writer->closing = false;
+	writer->error = false;
+	writer->size = 0;
+	writer->staging = nullptr;
+	writer->staged = 0;
+
+	if (writer->is_direct)
+	{
+		writer->staging_alloc.resize(DIRECT_IO_STAGING_SIZE + DIRECT_IO_ALIGNMENT);
+		uintptr_t base = reinterpret_cast<uintptr_t>(writer->staging_alloc.data());
+		base = (base + DIRECT_IO_ALIGNMENT - 1) & ~static_cast<uintptr_t>(DIRECT_IO_ALIGNMENT - 1);
+		writer->staging = reinterpret_cast<uint8_t*>(base);
+	}
+
+	pthread_create(&writer->thread_handle, nullptr, async_writer_thread, writer);
+	return writer;
+}
+
+/* Public function, see header file for detailed documentation */
+void async_writer_write(
+	async_writer* writer,
+	const uint8_t* data,
+	size_t len
+) {
+	std::lock_guard<std::mutex> lck(writer->lock);
+	writer->queue.push_back({ data, len });
+	writer->size += len;
+	writer->queued.notify_one();
+}
+
+/* Public function, see header file for detailed documentation */
+bool async_writer_close(
+	async_writer* writer,
+	bool discard
+) {
+	{
+		std::lock_guard<std::mutex> lck(writer->lock);
+		writer->closing = true;
+		writer->queued.notify_one();
+	}
+
+	pthread_join(writer->thread_handle, nullptr);
+
+	bool error = close_output_file(writer->file, writer->size) || writer->error;
+
+	// Only replace the output file with a complete image
+	if (!error && !discard)
+	{
+		error = replace_file(writer->temp_filename.c_str(), writer->filename.c_str());
+	}
+
+	if (error || discard)
+	{
+		remove(writer->temp_filename.c_str());
+	}
+
+	delete writer;
+	return error;
+}
@@ -22,8 +22,16 @@
 #include "astcenc.h"
 #include "astcenccli_internal.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -57,6 +65,7 @@ static const unsigned int ASTCENC_STAGE_COMPARE    = 1 << 6;
 static const astcenc_operation ASTCENC_OP_UNKNOWN  = 0;
 static const astcenc_operation ASTCENC_OP_HELP     = 1 << 7;
 static const astcenc_operation ASTCENC_OP_VERSION  = 1 << 8;
+static const astcenc_operation ASTCENC_OP_BATCH    = 1 << 9;
 
 static const astcenc_operation ASTCENC_OP_COMPRESS =
                                ASTCENC_STAGE_LD_NCOMP |
@@ -104,15 +113,55 @@ static const mode_entry modes[] = {
 	{"-h",       ASTCENC_OP_HELP,       ASTCENC_PRF_HDR},
 	{"-help",    ASTCENC_OP_HELP,       ASTCENC_PRF_HDR},
 	{"-v",       ASTCENC_OP_VERSION,    ASTCENC_PRF_HDR},
-	{"-version", ASTCENC_OP_VERSION,    ASTCENC_PRF_HDR}
+	{"-version", ASTCENC_OP_VERSION,    ASTCENC_PRF_HDR},
+	{"-batch",   ASTCENC_OP_BATCH,      ASTCENC_PRF_LDR}
 };
 
+static const cli_config_options cli_config_defaults {
+	0, 1, false, false, -10, 10,
+	{ ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A },
+	{ ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A },
+	false, false, 0.0f, 0, false, 0, nullptr, nullptr, nullptr, nullptr, false
+};
+
+/**
+ * @brief The target number of blocks in each strip of a streamed compression.
+ */
+static const unsigned int STREAM_STRIP_BLOCKS = 16384;
+
 struct compression_workload {
 	astcenc_context* context;
 	astcenc_image* image;
 	astcenc_swizzle swizzle;
+	astcenc_block_region region;
 	uint8_t* data_out;
 	size_t data_len;
+	const astcenc_image* prev_image;
+	const uint8_t* prev_data;
+	size_t prev_data_len;
+	astcenc_error error;
+};
+
+struct decompression_workload {
+	astcenc_context* context;
+	uint8_t* data;
+	size_t data_len;
+	astcenc_image* image_out;
+	astcenc_swizzle swizzle;
+	astcenc_error error;
+};
+
+struct mipmap_workload {
+	astcenc_context* context;
+	astcenc_swizzle swizzle;
+	astcenc_profile profile;
+	float alpha_cutoff;
+	// The image for each level; level 0 is the input image
+	std::vector<astcenc_image*> images;
+	// The compressed data for each level
+	std::vector<astc_compressed_image> levels;
+	// The levels after level 0, compressed as a single batch
+	std::vector<astcenc_batch_image> batch;
 	astcenc_error error;
 };
 
@@ -143,6 +192,19 @@ static bool ends_with(
 	       (0 == str.compare(str.size() - suffix.size(), suffix.size(), suffix));
 }
 
+/**
+ * @brief Test if a file name is a KTX or KTX2 file, which can store mipmaps.
+ *
+ * @param filename   The file name.
+ *
+ * @return @c true if the file is a KTX or KTX2 file.
+ */
+static bool is_ktx_filename(
+	const std::string& filename
+) {
+	return ends_with(filename, ".ktx") || ends_with(filename, ".ktx2");
+}
+
 static void compression_workload_runner(
 	int thread_count,
 	int thread_id,
@@ -151,9 +213,46 @@ static void compression_workload_runner(
 	(void)thread_count;
 
 	compression_workload* work = static_cast<compression_workload*>(payload);
-	astcenc_error error = astcenc_compress_image(
-	                       work->context, *work->image, work->swizzle,
-	                       work->data_out, work->data_len, thread_id);
+	astcenc_error error;
+	if (work->prev_image)
+	{
+		error = astcenc_compress_image_incremental(
+		            work->context, *work->image, *work->prev_image, work->prev_data,
+		            work->prev_data_len, work->swizzle, work->data_out, work->data_len,
+		            thread_id);
+	}
+	else if (work->prev_data)
+	{
+		error = astcenc_compress_image_hinted(
+		            work->context, *work->image, work->prev_data, work->prev_data_len,
+		            work->swizzle, work->data_out, work->data_len, thread_id);
+	}
+	else
+	{
+		error = astcenc_compress_image_region(
+		            work->context, *work->image, work->swizzle, work->region,
+		            work->data_out, work->data_len, work->region.dim_x, thread_id);
+	}
+
+	// This is a racy update, so which error gets returned is a random, but it
+	// will reliably report an error if an error occurs
+	if (error != ASTCENC_SUCCESS)
+	{
+		work->error = error;
+	}
+}
+
+static void decompression_workload_runner(
+	int thread_count,
+	int thread_id,
+	void* payload
+) {
+	(void)thread_count;
+
+	decompression_workload* work = static_cast<decompression_workload*>(payload);
+	astcenc_error error = astcenc_decompress_image(
+	                       work->context, work->data, work->data_len,
+	                       *work->image_out, work->swizzle, thread_id);
 
 	// This is a racy update, so which error gets returned is a random, but it
 	// will reliably report an error if an error occurs
@@ -193,6 +292,23 @@ static std::string get_slice_filename(
 	return name;
 }
 
+/**
+ * @brief Free the slice images used by an image array.
+ *
+ * @param slices   The slice images, as a @c std::vector<astcenc_image*>.
+ */
+static void release_slice_images(
+	void* slices
+) {
+	auto* images = static_cast<std::vector<astcenc_image*>*>(slices);
+	for (auto &i : *images)
+	{
+		free_image(i);
+	}
+
+	delete images;
+}
+
 /**
  * @brief Load a non-astc image file from memory.
  *
@@ -255,7 +371,8 @@ static astcenc_image* load_uncomp_file(
 			// Check slices are consistent with each other
 			if (image_index != 0)
 			{
-				if ((is_hdr != slice_is_hdr) || (component_count != slice_component_count))
+				if ((is_hdr != slice_is_hdr) || (component_count != slice_component_count) ||
+				    (slices[0]->data_type != slice->data_type))
 				{
 					printf("ERROR: Image array[0] and [%d] are different formats\n", image_index);
 					break;
@@ -276,49 +393,35 @@ static astcenc_image* load_uncomp_file(
 			}
 		}
 
-		// If all slices loaded correctly then repack them into a single image
+		// If all slices loaded correctly then use them, without a copy, as the
+		// slices of a single image which takes ownership of the slice images
 		if (slices.size() == dim_z)
 		{
-			unsigned int dim_x = slices[0]->dim_x;
-			unsigned int dim_y = slices[0]->dim_y;
-			// TODO: Make this 32 to use direct pass though as float
-			int bitness = is_hdr ? 16 : 8;
-			int slice_size = dim_x * dim_y;
-
-			image = alloc_image(bitness, dim_x, dim_y, dim_z);
+			unsigned int bitness = 32;
+			if (slices[0]->data_type == ASTCENC_TYPE_U8)
+			{
+				bitness = 8;
+			}
+			else if (slices[0]->data_type == ASTCENC_TYPE_F16)
+			{
+				bitness = 16;
+			}
 
-			// Combine 2D source images into one 3D image
+			std::vector<void*> slice_data(dim_z);
 			for (unsigned int z = 0; z < dim_z; z++)
 			{
-				// TODO: This is now a pointless copy, so don't do this ...
-				if (image->data_type == ASTCENC_TYPE_U8)
-				{
-					uint8_t* data8 = static_cast<uint8_t*>(image->data[z]);
-					uint8_t* data8src = static_cast<uint8_t*>(slices[z]->data[0]);
-					size_t copy_size = slice_size * 4 * sizeof(uint8_t);
-					memcpy(data8, data8src, copy_size);
-				}
-				else if (image->data_type == ASTCENC_TYPE_F16)
-				{
-					uint16_t* data16 = static_cast<uint16_t*>(image->data[z]);
-					uint16_t* data16src = static_cast<uint16_t*>(slices[z]->data[0]);
-					size_t copy_size = slice_size * 4 * sizeof(uint16_t);
-					memcpy(data16, data16src, copy_size);
-				}
-				else // if (image->data_type == ASTCENC_TYPE_F32)
-				{
-					assert(image->data_type == ASTCENC_TYPE_F32);
-					float* data32 = static_cast<float*>(image->data[z]);
-					float* data32src = static_cast<float*>(slices[z]->data[0]);
-					size_t copy_size = slice_size * 4 * sizeof(float);
-					memcpy(data32, data32src, copy_size);
-				}
+				slice_data[z] = slices[z]->data[0];
 			}
-		}
 
-		for (auto &i : slices)
+			image = wrap_image(bitness, slices[0]->dim_x, slices[0]->dim_y, dim_z, slice_data.data(),
+			                   release_slice_images, new std::vector<astcenc_image*>(slices));
+		}
+		else
 		{
-			free_image(i);
+			for (auto &i : slices)
+			{
+				free_image(i);
+			}
 		}
 	}
 
@@ -488,6 +591,18 @@ static int init_astcenc_config(
 
 			flags |= ASTCENC_FLG_MAP_MASK;
 		}
+		else if (!strcmp(argv[argidx], "-blockcache"))
+		{
+			flags |= ASTCENC_FLG_USE_BLOCK_CACHE;
+		}
+		else if (!strcmp(argv[argidx], "-adaptive"))
+		{
+			flags |= ASTCENC_FLG_ADAPTIVE_EFFORT;
+		}
+		else if (!strcmp(argv[argidx], "-stats"))
+		{
+			flags |= ASTCENC_FLG_COLLECT_TIMINGS;
+		}
 		else if (!strcmp(argv[argidx], "-pp-normalize"))
 		{
 			if (preprocess != ASTCENC_PP_NONE)
@@ -837,6 +952,28 @@ static int edit_astcenc_config(
 
 			config.tune_two_plane_early_out_limit = static_cast<float>(atof(argv[argidx - 1]));
 		}
+		else if (!strcmp(argv[argidx], "-budget"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -budget switch with no argument\n");
+				return 1;
+			}
+
+			config.tune_time_budget = static_cast<float>(atof(argv[argidx - 1]));
+		}
+		else if (!strcmp(argv[argidx], "-rdo"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -rdo switch with no argument\n");
+				return 1;
+			}
+
+			config.tune_rdo_lambda = static_cast<float>(atof(argv[argidx - 1]));
+		}
 		else if (!strcmp(argv[argidx], "-refinementlimit"))
 		{
 			argidx += 2;
@@ -870,11 +1007,129 @@ static int edit_astcenc_config(
 
 			cli_config.thread_count = atoi(argv[argidx - 1]);
 		}
+		else if (!strcmp(argv[argidx], "-affinity"))
+		{
+			argidx++;
+			cli_config.thread_affinity = true;
+		}
 		else if (!strcmp(argv[argidx], "-yflip"))
 		{
 			argidx++;
 			cli_config.y_flip = 1;
 		}
+		else if (!strcmp(argv[argidx], "-stats"))
+		{
+			argidx++;
+			cli_config.print_stats = true;
+		}
+		else if (!strcmp(argv[argidx], "-blockcache"))
+		{
+			argidx++;
+		}
+		else if (!strcmp(argv[argidx], "-adaptive"))
+		{
+			argidx++;
+		}
+		else if (!strcmp(argv[argidx], "-bench"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -bench switch with no argument\n");
+				return 1;
+			}
+
+			int iterations = atoi(argv[argidx - 1]);
+			if (iterations < 1)
+			{
+				printf("ERROR: -bench iteration count must be at least 1\n");
+				return 1;
+			}
+
+			cli_config.bench_iterations = static_cast<unsigned int>(iterations);
+		}
+		else if (!strcmp(argv[argidx], "-bench-json"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -bench-json switch with no argument\n");
+				return 1;
+			}
+
+			cli_config.bench_json = argv[argidx - 1];
+		}
+		else if (!strcmp(argv[argidx], "-incremental"))
+		{
+			argidx += 3;
+			if (argidx > argc)
+			{
+				printf("ERROR: -incremental switch with less than 2 arguments\n");
+				return 1;
+			}
+
+			cli_config.incremental_image = argv[argidx - 2];
+			cli_config.incremental_comp = argv[argidx - 1];
+		}
+		else if (!strcmp(argv[argidx], "-warmstart"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -warmstart switch with no argument\n");
+				return 1;
+			}
+
+			cli_config.warmstart_comp = argv[argidx - 1];
+		}
+		else if (!strcmp(argv[argidx], "-mipmap"))
+		{
+			argidx++;
+			cli_config.mipmap = true;
+		}
+		else if (!strcmp(argv[argidx], "-mipmap-coverage"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -mipmap-coverage switch with no argument\n");
+				return 1;
+			}
+
+			cli_config.mipmap = true;
+			cli_config.mipmap_alpha_cutoff = static_cast<float>(atof(argv[argidx - 1]));
+			if (!(cli_config.mipmap_alpha_cutoff > 0.0f) || cli_config.mipmap_alpha_cutoff >= 1.0f)
+			{
+				printf("ERROR: -mipmap-coverage cutoff must be between 0 and 1\n");
+				return 1;
+			}
+		}
+		else if (!strcmp(argv[argidx], "-zstd"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -zstd switch with no argument\n");
+				return 1;
+			}
+
+#if defined(ASTCENC_ZSTD)
+			cli_config.zstd_level = atoi(argv[argidx - 1]);
+			if (cli_config.zstd_level < 1 || cli_config.zstd_level > 22)
+			{
+				printf("ERROR: -zstd level must be between 1 and 22\n");
+				return 1;
+			}
+#else
+			printf("ERROR: -zstd requires a build with zstd support\n");
+			return 1;
+#endif
+		}
+		else if (!strcmp(argv[argidx], "-direct-io"))
+		{
+			argidx++;
+			cli_config.direct_io = true;
+		}
 		else if (!strcmp(argv[argidx], "-mpsnr"))
 		{
 			argidx += 3;
@@ -949,15 +1204,6 @@ static int edit_astcenc_config(
 		cli_config.thread_count = get_cpu_count();
 	}
 
-#if defined(ASTCENC_DECOMPRESS_ONLY) || defined(ASTCENC_DIAGNOSTICS)
-	cli_config.thread_count = 1;
-#else
-	if (operation == ASTCENC_OP_DECOMPRESS)
-	{
-		cli_config.thread_count = 1;
-	}
-#endif
-
 #if defined(ASTCENC_DIAGNOSTICS)
 	if (!config.trace_file_path)
 	{
@@ -1026,9 +1272,34 @@ static int edit_astcenc_config(
 			printf("    PSNR cutoff:                %g dB\n", (double)config.tune_db_limit);
 			printf("    1->2 partition cutoff:      %g\n", (double)config.tune_partition_early_out_limit);
 			printf("    2 plane correlation cutoff: %g\n", (double)config.tune_two_plane_early_out_limit);
+			printf("    Weight convergence cutoff:  %g\n", (double)config.tune_weight_converged_fraction);
 			printf("    Block mode centile cutoff:  %g%%\n", (double)(config.tune_block_mode_limit));
 			printf("    Max refinement cutoff:      %u iterations\n", config.tune_refinement_limit);
+			if (config.tune_time_budget > 0.0f)
+			{
+				printf("    Time budget:                %g ms\n", (double)config.tune_time_budget);
+			}
+			if (config.flags & ASTCENC_FLG_ADAPTIVE_EFFORT)
+			{
+				printf("    Adaptive effort:            enabled\n");
+			}
+			if (config.tune_rdo_lambda > 0.0f)
+			{
+				printf("    RDO lambda:                 %g\n", (double)config.tune_rdo_lambda);
+			}
+			if (cli_config.mipmap_alpha_cutoff > 0.0f)
+			{
+				printf("    Mipmap alpha cutoff:        %g\n", (double)cli_config.mipmap_alpha_cutoff);
+			}
+			if (cli_config.zstd_level > 0)
+			{
+				printf("    zstd level:                 %d\n", cli_config.zstd_level);
+			}
 			printf("    Compressor thread count:    %d\n", cli_config.thread_count);
+			if (cli_config.thread_affinity)
+			{
+				printf("    Thread affinity:            enabled\n");
+			}
 			printf("\n");
 		}
 	}
@@ -1040,8 +1311,9 @@ static int edit_astcenc_config(
  * @brief Get the value of a single pixel in an image.
  *
  * Note, this implementation is not particularly optimal as it puts format
- * checks in the inner-most loop. For the CLI preprocess passes this is deemed
- * acceptable as these are not performance critical paths.
+ * checks in the inner-most loop. For the CLI mipmap passes this is deemed
+ * acceptable as these are not performance critical paths; the whole image
+ * preprocess passes use the row-based image_get_row() instead.
  *
  * @param[in] img   The output image.
  * @param     x     The pixel x coordinate.
@@ -1076,12 +1348,8 @@ static vfloat4 image_get_pixel(
 	{
 		uint16_t* data = static_cast<uint16_t*>(img.data[z]);
 
-		float r = sf16_to_float(data[(4 * img.dim_x * y) + (4 * x    )]);
-		float g = sf16_to_float(data[(4 * img.dim_x * y) + (4 * x + 1)]);
-		float b = sf16_to_float(data[(4 * img.dim_x * y) + (4 * x + 2)]);
-		float a = sf16_to_float(data[(4 * img.dim_x * y) + (4 * x + 3)]);
-
-		return vfloat4(r, g, b, a);
+		const uint16_t* texel = data + (4 * img.dim_x * y) + (4 * x);
+		return float16_to_float(vint4(texel[0], texel[1], texel[2], texel[3]));
 	}
 	else // if (img.data_type == ASTCENC_TYPE_F32)
 	{
@@ -1128,130 +1396,1841 @@ static void image_set_pixel(
 }
 
 /**
- * @brief Create a copy of @c input with forced unit-length normal vectors.
+ * @brief Get the values of a row of pixels in an image.
  *
- * It is assumed that all normal vectors are stored in the RGB components, and
- * stored in a packed unsigned range of [0,1] which must be unpacked prior
- * normalization. Data must then be repacked into this form for handing over to
- * the core codec.
+ * The format check is made once per row, so the per-texel loops are
+ * specialized for each data type.
  *
- * @param[in]  input    The input image.
- * @param[out] output   The output image, must use F32 channels.
+ * @param[in]  img   The input image.
+ * @param      y     The row y coordinate.
+ * @param      z     The row z coordinate.
+ * @param[out] row   The pixel color values, one per texel in the row.
  */
-static void image_preprocess_normalize(
-	const astcenc_image& input,
-	astcenc_image& output
+static void image_get_row(
+	const astcenc_image& img,
+	unsigned int y,
+	unsigned int z,
+	vfloat4* row
 ) {
-	for (unsigned int z = 0; z < input.dim_z; z++)
-	{
-		for (unsigned int y = 0; y < input.dim_y; y++)
-		{
-			for (unsigned int x = 0; x < input.dim_x; x++)
-			{
-				vfloat4 pixel = image_get_pixel(input, x, y, z);
-
-				// Stash alpha channel and zero
-				float a = pixel.lane<3>();
-				pixel.set_lane<3>(0.0f);
-
-				// Decode [0,1] normals to [-1,1]
-				pixel.set_lane<0>((pixel.lane<0>() * 2.0f) - 1.0f);
-				pixel.set_lane<1>((pixel.lane<1>() * 2.0f) - 1.0f);
-				pixel.set_lane<2>((pixel.lane<2>() * 2.0f) - 1.0f);
-
-				// Normalize pixel and restore alpha
-				pixel = normalize(pixel);
-				pixel.set_lane<3>(a);
+	assert(y < img.dim_y);
+	assert(z < img.dim_z);
 
-				// Encode [-1,1] normals to [0,1]
-				pixel.set_lane<0>((pixel.lane<0>() + 1.0f) / 2.0f);
-				pixel.set_lane<1>((pixel.lane<1>() + 1.0f) / 2.0f);
-				pixel.set_lane<2>((pixel.lane<2>() + 1.0f) / 2.0f);
+	size_t offset = 4 * static_cast<size_t>(img.dim_x) * y;
 
-				image_set_pixel(output, x, y, z, pixel);
-			}
+	if (img.data_type == ASTCENC_TYPE_U8)
+	{
+		const uint8_t* data = static_cast<const uint8_t*>(img.data[z]) + offset;
+		for (unsigned int x = 0; x < img.dim_x; x++)
+		{
+			row[x] = int_to_float(vint4(data + 4 * x)) / 255.0f;
+		}
+	}
+	else if (img.data_type == ASTCENC_TYPE_F16)
+	{
+		const uint16_t* data = static_cast<const uint16_t*>(img.data[z]) + offset;
+		for (unsigned int x = 0; x < img.dim_x; x++)
+		{
+			const uint16_t* texel = data + 4 * x;
+			row[x] = float16_to_float(vint4(texel[0], texel[1], texel[2], texel[3]));
+		}
+	}
+	else // if (img.data_type == ASTCENC_TYPE_F32)
+	{
+		assert(img.data_type == ASTCENC_TYPE_F32);
+		const float* data = static_cast<const float*>(img.data[z]) + offset;
+		for (unsigned int x = 0; x < img.dim_x; x++)
+		{
+			row[x] = vfloat4(data + 4 * x);
 		}
 	}
 }
 
 /**
- * @brief Linearize an sRGB value.
- * @return The linearized value.
+ * @brief Set the values of a row of pixels in an image.
+ *
+ * @param[out] img   The output image; must use F32 texture channels.
+ * @param      y     The row y coordinate.
+ * @param      z     The row z coordinate.
+ * @param      row   The pixel color values, one per texel in the row.
  */
-static float srgb_to_linear(
-	float a
+static void image_set_row(
+	astcenc_image& img,
+	unsigned int y,
+	unsigned int z,
+	const vfloat4* row
 ) {
-	if (a <= 0.04045f)
+	assert(y < img.dim_y);
+	assert(z < img.dim_z);
+	assert(img.data_type == ASTCENC_TYPE_F32);
+
+	float* data = static_cast<float*>(img.data[z]) + 4 * static_cast<size_t>(img.dim_x) * y;
+	for (unsigned int x = 0; x < img.dim_x; x++)
 	{
-		return a * (1.0f / 12.92f);
+		store(row[x], data + 4 * x);
 	}
-
-	return powf((a + 0.055f) * (1.0f / 1.055f), 2.4f);
 }
 
 /**
- * @brief sRGB gamma-encode a linear value.
- * @return The gamma encoded value.
+ * @brief A per-texel image processing pass, run over whole rows by worker threads.
  */
-static float linear_to_srgb(
-	float a
-) {
-	if (a <= 0.0031308f)
-	{
+struct image_row_workload
+{
+	/** @brief The input image. */
+	const astcenc_image* input;
+	/** @brief The output image, which must use F32 channels. */
+	astcenc_image* output;
+	/** @brief The kernel which processes a row of pixels in place. */
+	void (*kernel)(vfloat4* row, unsigned int count, astcenc_profile profile);
+	/** @brief The encoding profile. */
+	astcenc_profile profile;
+	/** @brief The index of the next row to process. */
+	std::atomic<unsigned int> next_row;
+	/** @brief The number of rows in the image. */
+	unsigned int row_count;
+};
+
+static void image_row_workload_runner(
+	int thread_count,
+	int thread_id,
+	void* payload
+) {
+	(void)thread_count;
+	(void)thread_id;
+
+	image_row_workload& work = *static_cast<image_row_workload*>(payload);
+	unsigned int dim_x = work.input->dim_x;
+	unsigned int dim_y = work.input->dim_y;
+
+	std::vector<vfloat4> row(dim_x);
+	while (true)
+	{
+		unsigned int index = work.next_row++;
+		if (index >= work.row_count)
+		{
+			break;
+		}
+
+		unsigned int y = index % dim_y;
+		unsigned int z = index / dim_y;
+		image_get_row(*work.input, y, z, row.data());
+		work.kernel(row.data(), dim_x, work.profile);
+		image_set_row(*work.output, y, z, row.data());
+	}
+}
+
+/**
+ * @brief Apply a per-texel processing pass to an image using worker threads.
+ *
+ * @param[in]  input          The input image.
+ * @param[out] output         The output image, must use F32 channels.
+ * @param      kernel         The kernel which processes a row of pixels in place.
+ * @param      profile        The encoding profile.
+ * @param      thread_count   The number of threads to use.
+ */
+static void image_apply_row_kernel(
+	const astcenc_image& input,
+	astcenc_image& output,
+	void (*kernel)(vfloat4* row, unsigned int count, astcenc_profile profile),
+	astcenc_profile profile,
+	unsigned int thread_count
+) {
+	assert(input.dim_x == output.dim_x);
+	assert(input.dim_y == output.dim_y);
+	assert(input.dim_z == output.dim_z);
+
+	image_row_workload work;
+	work.input = &input;
+	work.output = &output;
+	work.kernel = kernel;
+	work.profile = profile;
+	work.next_row = 0;
+	work.row_count = input.dim_y * input.dim_z;
+
+	thread_count = astc::clamp(thread_count, 1u, astc::max(work.row_count, 1u));
+	launch_threads(static_cast<int>(thread_count), image_row_workload_runner, &work);
+}
+
+/**
+ * @brief Force a row of pixels to use unit-length normal vectors.
+ *
+ * It is assumed that all normal vectors are stored in the RGB components, and
+ * stored in a packed unsigned range of [0,1] which must be unpacked prior
+ * normalization. Data must then be repacked into this form for handing over to
+ * the core codec.
+ *
+ * @param[in,out] row       The pixels to process.
+ * @param         count     The number of pixels.
+ * @param         profile   The encoding profile (unused).
+ */
+static void normalize_row(
+	vfloat4* row,
+	unsigned int count,
+	astcenc_profile profile
+) {
+	(void)profile;
+
+	for (unsigned int x = 0; x < count; x++)
+	{
+		vfloat4 pixel = row[x];
+
+		// Stash alpha channel
+		float a = pixel.lane<3>();
+
+		// Decode [0,1] normals to [-1,1], and zero alpha
+		pixel = (pixel * 2.0f) - vfloat4(1.0f);
+		pixel.set_lane<3>(0.0f);
+
+		// Normalize pixel and restore alpha
+		pixel = normalize(pixel);
+
+		// Encode [-1,1] normals to [0,1]
+		pixel = (pixel + vfloat4(1.0f)) / 2.0f;
+		pixel.set_lane<3>(a);
+
+		row[x] = pixel;
+	}
+}
+
+/**
+ * @brief Create a copy of @c input with forced unit-length normal vectors.
+ *
+ * @param[in]  input          The input image.
+ * @param[out] output         The output image, must use F32 channels.
+ * @param      thread_count   The number of threads to use.
+ */
+static void image_preprocess_normalize(
+	const astcenc_image& input,
+	astcenc_image& output,
+	unsigned int thread_count
+) {
+	image_apply_row_kernel(input, output, normalize_row, ASTCENC_PRF_LDR, thread_count);
+}
+
+/**
+ * @brief Linearize an sRGB value.
+ * @return The linearized value.
+ */
+static float srgb_to_linear(
+	float a
+) {
+	if (a <= 0.04045f)
+	{
+		return a * (1.0f / 12.92f);
+	}
+
+	return powf((a + 0.055f) * (1.0f / 1.055f), 2.4f);
+}
+
+/**
+ * @brief sRGB gamma-encode a linear value.
+ * @return The gamma encoded value.
+ */
+static float linear_to_srgb(
+	float a
+) {
+	if (a <= 0.0031308f)
+	{
 		return a * 12.92f;
 	}
 
-	return 1.055f * powf(a, 1.0f / 2.4f) - 0.055f;
+	return 1.055f * powf(a, 1.0f / 2.4f) - 0.055f;
+}
+
+/**
+ * @brief Premultiply a row of pixels by alpha.
+ *
+ * If we are compressing sRGB data we linearize the data prior to
+ * premultiplication and re-gamma-encode afterwards.
+ *
+ * @param[in,out] row       The pixels to process.
+ * @param         count     The number of pixels.
+ * @param         profile   The encoding profile.
+ */
+static void premultiply_row(
+	vfloat4* row,
+	unsigned int count,
+	astcenc_profile profile
+) {
+	bool srgb = profile == ASTCENC_PRF_LDR_SRGB;
+
+	for (unsigned int x = 0; x < count; x++)
+	{
+		vfloat4 pixel = row[x];
+
+		// Linearize sRGB
+		if (srgb)
+		{
+			pixel.set_lane<0>(srgb_to_linear(pixel.lane<0>()));
+			pixel.set_lane<1>(srgb_to_linear(pixel.lane<1>()));
+			pixel.set_lane<2>(srgb_to_linear(pixel.lane<2>()));
+		}
+
+		// Premultiply pixel in linear-space
+		float a = pixel.lane<3>();
+		pixel = pixel * a;
+		pixel.set_lane<3>(a);
+
+		// Gamma-encode sRGB
+		if (srgb)
+		{
+			pixel.set_lane<0>(linear_to_srgb(pixel.lane<0>()));
+			pixel.set_lane<1>(linear_to_srgb(pixel.lane<1>()));
+			pixel.set_lane<2>(linear_to_srgb(pixel.lane<2>()));
+		}
+
+		row[x] = pixel;
+	}
+}
+
+/**
+ * @brief Create a copy of @c input with premultiplied color data.
+ *
+ * @param[in]  input          The input image.
+ * @param[out] output         The output image, must use F32 channels.
+ * @param      profile        The encoding profile.
+ * @param      thread_count   The number of threads to use.
+ */
+static void image_preprocess_premultiply(
+	const astcenc_image& input,
+	astcenc_image& output,
+	astcenc_profile profile,
+	unsigned int thread_count
+) {
+	image_apply_row_kernel(input, output, premultiply_row, profile, thread_count);
+}
+
+/**
+ * @brief Get the number of levels in the full mipmap chain of an image.
+ *
+ * @param img   The image.
+ *
+ * @return The level count, including the image itself.
+ */
+static unsigned int get_mipmap_level_count(
+	const astcenc_image& img
+) {
+	unsigned int dim = astc::max(astc::max(img.dim_x, img.dim_y), img.dim_z);
+	unsigned int count = 1;
+	while (dim > 1)
+	{
+		dim >>= 1;
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ * @brief The input texels, and their weights, for one axis of a mipmap texel.
+ */
+struct mipmap_taps
+{
+	/** @brief The index of the first input texel. */
+	unsigned int first;
+	/** @brief The number of input texels. */
+	unsigned int count;
+	/** @brief The weight of each input texel. */
+	float weights[4];
+};
+
+/**
+ * @brief Get the box filter taps for one axis of a mipmap texel.
+ *
+ * Each output texel covers an equal share of the input texels, so an input
+ * texel may be split between two output texels when the input size is odd.
+ *
+ * @param input_dim    The input size along this axis.
+ * @param output_dim   The output size along this axis.
+ * @param index        The output texel index along this axis.
+ *
+ * @return The filter taps.
+ */
+static mipmap_taps get_mipmap_taps(
+	unsigned int input_dim,
+	unsigned int output_dim,
+	unsigned int index
+) {
+	float scale = static_cast<float>(input_dim) / static_cast<float>(output_dim);
+	float start = static_cast<float>(index) * scale;
+	float end = astc::min(static_cast<float>(index + 1) * scale, static_cast<float>(input_dim));
+
+	mipmap_taps taps;
+	taps.first = static_cast<unsigned int>(start);
+	taps.count = static_cast<unsigned int>(ceilf(end)) - taps.first;
+	assert(taps.count <= 4);
+
+	for (unsigned int i = 0; i < taps.count; i++)
+	{
+		float low = astc::max(start, static_cast<float>(taps.first + i));
+		float high = astc::min(end, static_cast<float>(taps.first + i + 1));
+		taps.weights[i] = (high - low) / scale;
+	}
+
+	return taps;
+}
+
+/**
+ * @brief Downsample an image to the next mipmap level using a box filter.
+ *
+ * @param[in]  input           The input image.
+ * @param      input_is_srgb   True if the input RGB data is sRGB encoded.
+ * @param[out] output          The linear output image, must use F32 channels.
+ */
+static void image_downsample(
+	const astcenc_image& input,
+	bool input_is_srgb,
+	astcenc_image& output
+) {
+	for (unsigned int z = 0; z < output.dim_z; z++)
+	{
+		mipmap_taps tz = get_mipmap_taps(input.dim_z, output.dim_z, z);
+		for (unsigned int y = 0; y < output.dim_y; y++)
+		{
+			mipmap_taps ty = get_mipmap_taps(input.dim_y, output.dim_y, y);
+			for (unsigned int x = 0; x < output.dim_x; x++)
+			{
+				mipmap_taps tx = get_mipmap_taps(input.dim_x, output.dim_x, x);
+
+				vfloat4 sum = vfloat4::zero();
+				for (unsigned int k = 0; k < tz.count; k++)
+				{
+					for (unsigned int j = 0; j < ty.count; j++)
+					{
+						float weight_zy = tz.weights[k] * ty.weights[j];
+						for (unsigned int i = 0; i < tx.count; i++)
+						{
+							vfloat4 pixel = image_get_pixel(input, tx.first + i,
+							                                ty.first + j, tz.first + k);
+
+							// Filter sRGB in linear-space
+							if (input_is_srgb)
+							{
+								pixel.set_lane<0>(srgb_to_linear(pixel.lane<0>()));
+								pixel.set_lane<1>(srgb_to_linear(pixel.lane<1>()));
+								pixel.set_lane<2>(srgb_to_linear(pixel.lane<2>()));
+							}
+
+							sum = sum + pixel * (weight_zy * tx.weights[i]);
+						}
+					}
+				}
+
+				image_set_pixel(output, x, y, z, sum);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Compute the fraction of texels in an image which pass an alpha test.
+ *
+ * @param img           The image.
+ * @param cutoff        The alpha test cutoff.
+ * @param alpha_scale   The scale applied to alpha before the test.
+ *
+ * @return The fraction of texels with scaled alpha above the cutoff.
+ */
+static float image_alpha_coverage(
+	const astcenc_image& img,
+	float cutoff,
+	float alpha_scale
+) {
+	size_t covered = 0;
+	for (unsigned int z = 0; z < img.dim_z; z++)
+	{
+		for (unsigned int y = 0; y < img.dim_y; y++)
+		{
+			for (unsigned int x = 0; x < img.dim_x; x++)
+			{
+				float alpha = image_get_pixel(img, x, y, z).lane<3>();
+				covered += (alpha * alpha_scale) > cutoff;
+			}
+		}
+	}
+
+	size_t texels = static_cast<size_t>(img.dim_x) * img.dim_y * img.dim_z;
+	return static_cast<float>(covered) / static_cast<float>(texels);
+}
+
+/**
+ * @brief Find the alpha scale which gives a mipmap level a target alpha coverage.
+ *
+ * Box filtering blurs alpha, so alpha tested geometry thins out or thickens
+ * in smaller mipmap levels. Scaling alpha in each level restores the fraction
+ * of texels which pass the alpha test.
+ *
+ * @param img        The linear mipmap level.
+ * @param cutoff     The alpha test cutoff.
+ * @param coverage   The target coverage, measured on the first level.
+ *
+ * @return The alpha scale.
+ */
+static float find_alpha_coverage_scale(
+	const astcenc_image& img,
+	float cutoff,
+	float coverage
+) {
+	// Coverage only increases with the scale, so binary search for the target
+	float low = 0.0f;
+	float high = 4.0f;
+	for (int i = 0; i < 10; i++)
+	{
+		float mid = (low + high) * 0.5f;
+		if (image_alpha_coverage(img, cutoff, mid) < coverage)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	// Coverage is a step function for small levels, so pick the closer bound
+	float low_error = fabsf(image_alpha_coverage(img, cutoff, low) - coverage);
+	float high_error = fabsf(image_alpha_coverage(img, cutoff, high) - coverage);
+	return low_error < high_error ? low : high;
+}
+
+/**
+ * @brief Encode a linear mipmap level for compression.
+ *
+ * @param[in]  input         The linear mipmap level.
+ * @param[out] output        The output image, must use F32 channels.
+ * @param      srgb          True if the output RGB data is sRGB encoded.
+ * @param      alpha_scale   The scale to apply to alpha.
+ */
+static void image_encode_mipmap(
+	const astcenc_image& input,
+	astcenc_image& output,
+	bool srgb,
+	float alpha_scale
+) {
+	for (unsigned int z = 0; z < input.dim_z; z++)
+	{
+		for (unsigned int y = 0; y < input.dim_y; y++)
+		{
+			for (unsigned int x = 0; x < input.dim_x; x++)
+			{
+				vfloat4 pixel = image_get_pixel(input, x, y, z);
+
+				if (srgb)
+				{
+					pixel.set_lane<0>(linear_to_srgb(pixel.lane<0>()));
+					pixel.set_lane<1>(linear_to_srgb(pixel.lane<1>()));
+					pixel.set_lane<2>(linear_to_srgb(pixel.lane<2>()));
+				}
+
+				if (alpha_scale != 1.0f)
+				{
+					pixel.set_lane<3>(astc::min(pixel.lane<3>() * alpha_scale, 1.0f));
+				}
+
+				image_set_pixel(output, x, y, z, pixel);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Generate the mipmap levels of a workload after level 0.
+ *
+ * Each level is filtered from the linear data of the previous level, so sRGB
+ * data is only decoded once and errors from encoding do not accumulate.
+ *
+ * @param work   The workload; all level images must be allocated.
+ */
+static void generate_mipmaps(
+	mipmap_workload& work
+) {
+	bool srgb = work.profile == ASTCENC_PRF_LDR_SRGB;
+	float cutoff = work.alpha_cutoff;
+
+	float coverage = 0.0f;
+	if (cutoff > 0.0f)
+	{
+		coverage = image_alpha_coverage(*work.images[0], cutoff, 1.0f);
+	}
+
+	astcenc_image* linear = nullptr;
+	for (size_t i = 1; i < work.images.size(); i++)
+	{
+		astcenc_image& output = *work.images[i];
+		astcenc_image* next = alloc_image(32, output.dim_x, output.dim_y, output.dim_z);
+		if (linear)
+		{
+			image_downsample(*linear, false, *next);
+		}
+		else
+		{
+			image_downsample(*work.images[0], srgb, *next);
+		}
+
+		free_image(linear);
+		linear = next;
+
+		float alpha_scale = 1.0f;
+		if (cutoff > 0.0f)
+		{
+			alpha_scale = find_alpha_coverage_scale(*linear, cutoff, coverage);
+		}
+
+		image_encode_mipmap(*linear, output, srgb, alpha_scale);
+	}
+
+	free_image(linear);
+}
+
+static void mipmap_base_workload_runner(
+	int thread_count,
+	int thread_id,
+	void* payload
+) {
+	mipmap_workload* work = static_cast<mipmap_workload*>(payload);
+
+	// The last thread generates the smaller levels while the others compress
+	// level 0, so the smaller levels are ready when level 0 completes
+	if (thread_id == thread_count - 1)
+	{
+		generate_mipmaps(*work);
+		return;
+	}
+
+	astcenc_error error = astcenc_compress_image(
+	                       work->context, *work->images[0], work->swizzle,
+	                       work->levels[0].data, work->levels[0].data_len, thread_id);
+
+	// This is a racy update, so which error gets returned is a random, but it
+	// will reliably report an error if an error occurs
+	if (error != ASTCENC_SUCCESS)
+	{
+		work->error = error;
+	}
+}
+
+static void mipmap_tail_workload_runner(
+	int thread_count,
+	int thread_id,
+	void* payload
+) {
+	(void)thread_count;
+
+	mipmap_workload* work = static_cast<mipmap_workload*>(payload);
+	astcenc_error error = astcenc_compress_image_batch(
+	                       work->context, work->batch.data(),
+	                       static_cast<unsigned int>(work->batch.size()),
+	                       work->swizzle, thread_id);
+
+	// This is a racy update, so which error gets returned is a random, but it
+	// will reliably report an error if an error occurs
+	if (error != ASTCENC_SUCCESS)
+	{
+		work->error = error;
+	}
+}
+
+/**
+ * @brief Generate and compress the full mipmap chain of an image.
+ *
+ * Level 0 is compressed while the smaller levels are generated, and the
+ * smaller levels are then compressed as a single batch so that all threads
+ * share the work of the small levels.
+ *
+ * @param      context      The codec context.
+ * @param      config       The codec configuration.
+ * @param      cli_config   The command line configuration.
+ * @param      image        The input image, which is level 0.
+ * @param[out] levels       The compressed levels, largest first.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+static astcenc_error compress_mipmaps(
+	astcenc_context* context,
+	const astcenc_config& config,
+	const cli_config_options& cli_config,
+	astcenc_image* image,
+	std::vector<astc_compressed_image>& levels
+) {
+	unsigned int level_count = get_mipmap_level_count(*image);
+
+	mipmap_workload work;
+	work.context = context;
+	work.swizzle = cli_config.swz_encode;
+	work.profile = config.profile;
+	work.alpha_cutoff = cli_config.mipmap_alpha_cutoff;
+	work.error = ASTCENC_SUCCESS;
+
+	for (unsigned int i = 0; i < level_count; i++)
+	{
+		astcenc_image* level_image = image;
+		if (i > 0)
+		{
+			level_image = alloc_image(32,
+			                          astc::max(image->dim_x >> i, 1u),
+			                          astc::max(image->dim_y >> i, 1u),
+			                          astc::max(image->dim_z >> i, 1u));
+		}
+
+		unsigned int blocks_x = (level_image->dim_x + config.block_x - 1) / config.block_x;
+		unsigned int blocks_y = (level_image->dim_y + config.block_y - 1) / config.block_y;
+		unsigned int blocks_z = (level_image->dim_z + config.block_z - 1) / config.block_z;
+		size_t buffer_size = blocks_x * blocks_y * blocks_z * 16;
+
+		astc_compressed_image level;
+		level.block_x = config.block_x;
+		level.block_y = config.block_y;
+		level.block_z = config.block_z;
+		level.dim_x = level_image->dim_x;
+		level.dim_y = level_image->dim_y;
+		level.dim_z = level_image->dim_z;
+		level.data = new uint8_t[buffer_size];
+		level.data_len = buffer_size;
+
+		work.images.push_back(level_image);
+		work.levels.push_back(level);
+		if (i > 0)
+		{
+			work.batch.push_back({ level_image, level.data, level.data_len });
+		}
+	}
+
+	// Only launch worker threads for multi-threaded use - it makes basic
+	// single-threaded profiling and debugging a little less convoluted
+	if (cli_config.thread_count > 1)
+	{
+		launch_threads(cli_config.thread_count + 1, mipmap_base_workload_runner, &work);
+	}
+	else
+	{
+		work.error = astcenc_compress_image(
+		    work.context, *work.images[0], work.swizzle,
+		    work.levels[0].data, work.levels[0].data_len, 0);
+		generate_mipmaps(work);
+	}
+
+	if ((work.error == ASTCENC_SUCCESS) && !work.batch.empty())
+	{
+		astcenc_compress_reset(context);
+
+		if (cli_config.thread_count > 1)
+		{
+			launch_threads(cli_config.thread_count, mipmap_tail_workload_runner, &work);
+		}
+		else
+		{
+			work.error = astcenc_compress_image_batch(
+			    work.context, work.batch.data(),
+			    static_cast<unsigned int>(work.batch.size()), work.swizzle, 0);
+		}
+	}
+
+	for (size_t i = 1; i < work.images.size(); i++)
+	{
+		free_image(work.images[i]);
+	}
+
+	levels = work.levels;
+	return work.error;
+}
+
+/**
+ * @brief Load an uncompressed input image and apply any preprocessing.
+ *
+ * @param      filename          The file to load, or a pattern for array loads.
+ * @param      config            The codec configuration.
+ * @param      cli_config        The command line configuration.
+ * @param      preprocess        The image preprocess operation.
+ * @param      thread_count      The number of threads to use for preprocessing.
+ * @param[out] is_hdr            Is the loaded image HDR?
+ * @param[out] component_count   The number of components in the loaded image.
+ *
+ * @return The image, or nullptr on error.
+ */
+static astcenc_image* load_uncomp_input(
+	const std::string& filename,
+	const astcenc_config& config,
+	const cli_config_options& cli_config,
+	astcenc_preprocess preprocess,
+	unsigned int thread_count,
+	bool& is_hdr,
+	unsigned int& component_count
+) {
+	astcenc_image* image = load_uncomp_file(filename.c_str(), cli_config.array_size,
+	                                        cli_config.y_flip, is_hdr, component_count);
+	if (!image)
+	{
+		printf("ERROR: Failed to load uncompressed image file %s\n", filename.c_str());
+		return nullptr;
+	}
+
+	if (preprocess != ASTCENC_PP_NONE)
+	{
+		// Allocate a float image so we can avoid additional quantization,
+		// as e.g. premultiplication can result in fractional color values
+		astcenc_image* image_pp = alloc_image(32, image->dim_x, image->dim_y, image->dim_z);
+		if (!image_pp)
+		{
+			printf("ERROR: Failed to allocate preprocessed image\n");
+			free_image(image);
+			return nullptr;
+		}
+
+		if (preprocess == ASTCENC_PP_NORMALIZE)
+		{
+			image_preprocess_normalize(*image, *image_pp, thread_count);
+		}
+
+		if (preprocess == ASTCENC_PP_PREMULTIPLY)
+		{
+			image_preprocess_premultiply(*image, *image_pp, config.profile, thread_count);
+		}
+
+		// Delete the original as we no longer need it
+		free_image(image);
+		image = image_pp;
+	}
+
+	return image;
+}
+
+/**
+ * @brief Compress a region of an image, using all of the worker threads.
+ *
+ * @param      context      The codec context; must be reset if used before.
+ * @param      cli_config   The command line configuration.
+ * @param      image        The input image.
+ * @param      region       The region to compress, in blocks.
+ * @param[out] data_out     The output buffer for the region.
+ * @param      data_len     The length of the output buffer.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+static astcenc_error compress_region(
+	astcenc_context* context,
+	const cli_config_options& cli_config,
+	astcenc_image* image,
+	const astcenc_block_region& region,
+	uint8_t* data_out,
+	size_t data_len
+) {
+	compression_workload work;
+	work.context = context;
+	work.image = image;
+	work.swizzle = cli_config.swz_encode;
+	work.region = region;
+	work.data_out = data_out;
+	work.data_len = data_len;
+	work.prev_image = nullptr;
+	work.prev_data = nullptr;
+	work.prev_data_len = 0;
+	work.error = ASTCENC_SUCCESS;
+
+	// Only launch worker threads for multi-threaded use - it makes basic
+	// single-threaded profiling and debugging a little less convoluted
+	if (cli_config.thread_count > 1)
+	{
+		launch_threads(cli_config.thread_count, compression_workload_runner, &work);
+	}
+	else
+	{
+		work.error = astcenc_compress_image_region(
+		    work.context, *work.image, work.swizzle, work.region,
+		    work.data_out, work.data_len, work.region.dim_x, 0);
+	}
+
+	return work.error;
+}
+
+/**
+ * @brief Compress an image, using a previous compression.
+ *
+ * If a previous input image is provided the unchanged blocks of the previous
+ * compression are reused, otherwise the previous compression is used as the
+ * warm-start hint for every block.
+ *
+ * @param      context      The codec context; must be reset if used before.
+ * @param      cli_config   The command line configuration.
+ * @param      image        The input image.
+ * @param      prev_image   The previous input image, or @c nullptr.
+ * @param      prev_comp    The previous compressed image.
+ * @param[out] data_out     The output buffer for the image.
+ * @param      data_len     The length of the output buffer.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+static astcenc_error compress_from_previous(
+	astcenc_context* context,
+	const cli_config_options& cli_config,
+	astcenc_image* image,
+	const astcenc_image* prev_image,
+	const astc_compressed_image& prev_comp,
+	uint8_t* data_out,
+	size_t data_len
+) {
+	compression_workload work;
+	work.context = context;
+	work.image = image;
+	work.swizzle = cli_config.swz_encode;
+	work.region = astcenc_block_region {};
+	work.data_out = data_out;
+	work.data_len = data_len;
+	work.prev_image = prev_image;
+	work.prev_data = prev_comp.data;
+	work.prev_data_len = prev_comp.data_len;
+	work.error = ASTCENC_SUCCESS;
+
+	// Only launch worker threads for multi-threaded use - it makes basic
+	// single-threaded profiling and debugging a little less convoluted
+	if (cli_config.thread_count > 1)
+	{
+		launch_threads(cli_config.thread_count, compression_workload_runner, &work);
+	}
+	else if (work.prev_image)
+	{
+		work.error = astcenc_compress_image_incremental(
+		    work.context, *work.image, *work.prev_image, work.prev_data,
+		    work.prev_data_len, work.swizzle, work.data_out, work.data_len, 0);
+	}
+	else
+	{
+		work.error = astcenc_compress_image_hinted(
+		    work.context, *work.image, work.prev_data, work.prev_data_len,
+		    work.swizzle, work.data_out, work.data_len, 0);
+	}
+
+	return work.error;
+}
+
+/**
+ * @brief Decompress an image, using all of the worker threads.
+ *
+ * @param      context      The codec context; must be reset if used before.
+ * @param      cli_config   The command line configuration.
+ * @param      image_comp   The compressed image.
+ * @param[out] image_out    The output image.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if decompression failed.
+ */
+static astcenc_error decompress_image(
+	astcenc_context* context,
+	const cli_config_options& cli_config,
+	const astc_compressed_image& image_comp,
+	astcenc_image* image_out
+) {
+	decompression_workload work;
+	work.context = context;
+	work.data = image_comp.data;
+	work.data_len = image_comp.data_len;
+	work.image_out = image_out;
+	work.swizzle = cli_config.swz_decode;
+	work.error = ASTCENC_SUCCESS;
+
+	// Only launch worker threads for multi-threaded use - it makes basic
+	// single-threaded profiling and debugging a little less convoluted
+	if (cli_config.thread_count > 1)
+	{
+		launch_threads(cli_config.thread_count, decompression_workload_runner, &work);
+	}
+	else
+	{
+		work.error = astcenc_decompress_image(
+		    work.context, work.data, work.data_len,
+		    *work.image_out, work.swizzle, 0);
+	}
+
+	return work.error;
+}
+
+/**
+ * @brief Compress an image, and its mipmap chain if requested.
+ *
+ * If a writer is provided the image is compressed as a sequence of strips of
+ * whole block rows, and each strip is queued for writing as soon as it is
+ * complete, so writing overlaps compression of the later strips. Images with
+ * a time budget are written once compression completes. Mipmapped images are
+ * not supported with a writer.
+ *
+ * If a previous compressed image is provided it is used for an incremental
+ * compression, where the blocks with unchanged input texels of the previous
+ * image reuse the previous compressed data, or as the warm-start hint if there
+ * is no previous image; this is not supported for mipmapped images.
+ *
+ * The caller owns the data of the returned levels, even if an error occurs.
+ *
+ * @param      context      The codec context; must be reset if used before.
+ * @param      config       The codec configuration.
+ * @param      cli_config   The command line configuration.
+ * @param      image        The input image.
+ * @param      writer       The writer to stream to, or @c nullptr.
+ * @param      prev_image   The previous input image, or @c nullptr.
+ * @param      prev_comp    The previous compressed image, or @c nullptr.
+ * @param[out] levels       The compressed levels, largest first.
+ *
+ * @return ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+static astcenc_error compress_image_levels(
+	astcenc_context* context,
+	const astcenc_config& config,
+	const cli_config_options& cli_config,
+	astcenc_image* image,
+	async_writer* writer,
+	const astcenc_image* prev_image,
+	const astc_compressed_image* prev_comp,
+	std::vector<astc_compressed_image>& levels
+) {
+	if (cli_config.mipmap)
+	{
+		assert(!writer && !prev_comp);
+		return compress_mipmaps(context, config, cli_config, image, levels);
+	}
+
+	unsigned int blocks_x = (image->dim_x + config.block_x - 1) / config.block_x;
+	unsigned int blocks_y = (image->dim_y + config.block_y - 1) / config.block_y;
+	unsigned int blocks_z = (image->dim_z + config.block_z - 1) / config.block_z;
+	size_t buffer_size = blocks_x * blocks_y * blocks_z * 16;
+
+	astc_compressed_image level;
+	level.block_x = config.block_x;
+	level.block_y = config.block_y;
+	level.block_z = config.block_z;
+	level.dim_x = image->dim_x;
+	level.dim_y = image->dim_y;
+	level.dim_z = image->dim_z;
+	level.data = new uint8_t[buffer_size];
+	level.data_len = buffer_size;
+	levels.assign(1, level);
+
+	// Compressions using a previous compression visit the whole image, as the
+	// codec only supports them for whole images, so they are not split into strips
+	if (prev_comp)
+	{
+		astcenc_error error = compress_from_previous(context, cli_config, image, prev_image,
+		                                             *prev_comp, level.data, level.data_len);
+		if ((error == ASTCENC_SUCCESS) && writer)
+		{
+			async_writer_write(writer, level.data, level.data_len);
+		}
+
+		return error;
+	}
+
+	// Compressed data is stored in Z, Y, X order, so strips of whole rows
+	// are contiguous in the output. The time budget applies to a whole
+	// compression, so budgeted compressions are not split into strips.
+	std::vector<astcenc_block_region> regions;
+	if (writer && (config.tune_time_budget == 0.0f))
+	{
+		unsigned int strip_rows = astc::max(STREAM_STRIP_BLOCKS / blocks_x, 1u);
+		for (unsigned int z = 0; z < blocks_z; z++)
+		{
+			for (unsigned int y = 0; y < blocks_y; y += strip_rows)
+			{
+				regions.push_back({ 0, y, z, blocks_x, astc::min(strip_rows, blocks_y - y), 1 });
+			}
+		}
+	}
+	else
+	{
+		regions.push_back({ 0, 0, 0, blocks_x, blocks_y, blocks_z });
+	}
+
+	for (size_t i = 0; i < regions.size(); i++)
+	{
+		const astcenc_block_region& region = regions[i];
+		size_t offset = (region.origin_z * (size_t)blocks_y + region.origin_y) * blocks_x * 16;
+		uint8_t* data_out = level.data + offset;
+		size_t data_len = region.dim_z * (size_t)region.dim_y * blocks_x * 16;
+
+		if (i != 0)
+		{
+			astcenc_compress_reset(context);
+		}
+
+		astcenc_error error = compress_region(context, cli_config, image, region,
+		                                      data_out, data_len);
+		if (error != ASTCENC_SUCCESS)
+		{
+			return error;
+		}
+
+		if (writer)
+		{
+			async_writer_write(writer, data_out, data_len);
+		}
+	}
+
+	return ASTCENC_SUCCESS;
+}
+
+/**
+ * @brief Store a compressed image, selecting the file format by extension.
+ *
+ * @param levels       The compressed levels, largest first.
+ * @param filename     The output file name.
+ * @param profile      The color profile.
+ * @param zstd_level   The KTX2 zstd supercompression level, or 0 for none.
+ *
+ * @return 0 if everything is okay, 1 if there is some error
+ */
+static int store_comp_file(
+	const std::vector<astc_compressed_image>& levels,
+	const std::string& filename,
+	astcenc_profile profile,
+	int zstd_level
+) {
+	int error = 0;
+	if (ends_with(filename, ".astc"))
+	{
+		error = store_cimage(levels[0], filename.c_str());
+	}
+	else if (ends_with(filename, ".ktx"))
+	{
+		bool srgb = profile == ASTCENC_PRF_LDR_SRGB;
+		error = store_ktx_compressed_image(levels.data(), static_cast<unsigned int>(levels.size()),
+		                                   filename.c_str(), srgb);
+	}
+	else if (ends_with(filename, ".ktx2"))
+	{
+		error = store_ktx2_compressed_image(levels.data(), static_cast<unsigned int>(levels.size()),
+		                                    filename.c_str(), profile, zstd_level);
+	}
+	else
+	{
+#if defined(_WIN32)
+		bool is_null = filename == "NUL" || filename == "nul";
+#else
+		bool is_null = filename == "/dev/null";
+#endif
+		if (!is_null)
+		{
+			printf("ERROR: Unknown compressed output file type %s\n", filename.c_str());
+			return 1;
+		}
+	}
+
+	if (error)
+	{
+		printf("ERROR: Failed to store compressed image %s\n", filename.c_str());
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief The timing samples for one phase of a benchmark.
+ */
+struct bench_phase
+{
+	/** @brief The phase key in the JSON report. */
+	const char* key;
+	/** @brief The phase name in the text report. */
+	const char* name;
+	/** @brief The time of each timed iteration, in seconds. */
+	std::vector<double> samples;
+	/** @brief Should a coding rate be reported for this phase? */
+	bool report_rate;
+};
+
+/**
+ * @brief Get a percentile of a sorted set of samples.
+ *
+ * Values between samples are linearly interpolated.
+ *
+ * @param sorted       The samples, sorted in increasing order; must not be empty.
+ * @param percentile   The percentile, between 0 and 1.
+ *
+ * @return The percentile value.
+ */
+static double get_percentile(
+	const std::vector<double>& sorted,
+	double percentile
+) {
+	double pos = percentile * static_cast<double>(sorted.size() - 1);
+	size_t index = static_cast<size_t>(pos);
+	if (index + 1 >= sorted.size())
+	{
+		return sorted.back();
+	}
+
+	double frac = pos - static_cast<double>(index);
+	return sorted[index] + (sorted[index + 1] - sorted[index]) * frac;
+}
+
+/**
+ * @brief Repeatedly compress and/or decompress an in-memory image.
+ *
+ * The benchmark runs warm-up iterations, followed by the requested number of
+ * timed iterations, reusing the codec context for each one. The minimum,
+ * median, and 95th percentile time of each phase are reported, and optionally
+ * stored to a JSON file.
+ *
+ * The variance prepass time is the thread-summed time reported by the codec
+ * statistics divided by the thread count, and is included in the compression
+ * time.
+ *
+ * @param context            The codec context.
+ * @param cli_config         The command line configuration.
+ * @param operation          The operation; only the codec stages are run.
+ * @param image_uncomp_in    The uncompressed input image, if compressing.
+ * @param image_comp         The compressed image.
+ * @param image_decomp_out   The decompressed output image, if decompressing.
+ *
+ * @return 0 if everything is okay, 1 if there is some error
+ */
+static int run_benchmark(
+	astcenc_context* context,
+	const cli_config_options& cli_config,
+	astcenc_operation operation,
+	astcenc_image* image_uncomp_in,
+	const astc_compressed_image& image_comp,
+	astcenc_image* image_decomp_out
+) {
+	bool compress = (operation & ASTCENC_STAGE_COMPRESS) != 0;
+	bool decompress = (operation & ASTCENC_STAGE_DECOMPRESS) != 0;
+
+	unsigned int blocks_x = (image_comp.dim_x + image_comp.block_x - 1) / image_comp.block_x;
+	unsigned int blocks_y = (image_comp.dim_y + image_comp.block_y - 1) / image_comp.block_y;
+	unsigned int blocks_z = (image_comp.dim_z + image_comp.block_z - 1) / image_comp.block_z;
+	astcenc_block_region region { 0, 0, 0, blocks_x, blocks_y, blocks_z };
+
+	// Compress to a scratch buffer, so the stored output is not modified
+	std::vector<uint8_t> scratch(compress ? image_comp.data_len : 0);
+
+	bench_phase prepass { "variance_prepass", "Variance prepass", {}, false };
+	bench_phase compression { "compression", "Compression", {}, true };
+	bench_phase decompression { "decompression", "Decompression", {}, true };
+
+	unsigned int warmup_count = astc::max(cli_config.bench_iterations / 10, 1u);
+	unsigned int total_count = warmup_count + cli_config.bench_iterations;
+	for (unsigned int i = 0; i < total_count; i++)
+	{
+		bool timed = i >= warmup_count;
+
+		if (compress)
+		{
+			astcenc_stats stats_start {};
+			astcenc_stats stats_end {};
+
+			astcenc_compress_reset(context);
+			astcenc_get_stats(context, stats_start);
+
+			double start = get_time();
+			astcenc_error status = compress_region(context, cli_config, image_uncomp_in, region,
+			                                       scratch.data(), scratch.size());
+			double end = get_time();
+
+			astcenc_get_stats(context, stats_end);
+			if (status != ASTCENC_SUCCESS)
+			{
+				printf("ERROR: Codec compress failed: %s\n", astcenc_get_error_string(status));
+				return 1;
+			}
+
+			if (timed)
+			{
+				uint64_t prepass_ns = stats_end.avg_var_time_ns - stats_start.avg_var_time_ns;
+				prepass.samples.push_back(static_cast<double>(prepass_ns) * 1e-9 /
+				                          static_cast<double>(cli_config.thread_count));
+				compression.samples.push_back(end - start);
+			}
+		}
+
+		if (decompress)
+		{
+			astcenc_decompress_reset(context);
+
+			double start = get_time();
+			astcenc_error status = decompress_image(context, cli_config, image_comp,
+			                                        image_decomp_out);
+			double end = get_time();
+
+			if (status != ASTCENC_SUCCESS)
+			{
+				printf("ERROR: Codec decompress failed: %s\n", astcenc_get_error_string(status));
+				return 1;
+			}
+
+			if (timed)
+			{
+				decompression.samples.push_back(end - start);
+			}
+		}
+	}
+
+	std::vector<bench_phase*> phases;
+	if (compress)
+	{
+		phases.push_back(&prepass);
+		phases.push_back(&compression);
+	}
+
+	if (decompress)
+	{
+		phases.push_back(&decompression);
+	}
+
+	double texels = (double)image_comp.dim_x * (double)image_comp.dim_y * (double)image_comp.dim_z;
+
+	printf("Benchmark\n");
+	printf("=========\n\n");
+	printf("    Iterations:                %8u (%u warm-up)\n", cli_config.bench_iterations, warmup_count);
+	printf("    Thread count:              %8u\n", cli_config.thread_count);
+
+	for (bench_phase* phase : phases)
+	{
+		std::sort(phase->samples.begin(), phase->samples.end());
+		printf("\n    %s\n", phase->name);
+		printf("        Minimum:               %8.4f s\n", phase->samples.front());
+		printf("        Median:                %8.4f s\n", get_percentile(phase->samples, 0.5));
+		printf("        95th percentile:       %8.4f s\n", get_percentile(phase->samples, 0.95));
+		if (phase->report_rate)
+		{
+			double rate = texels / get_percentile(phase->samples, 0.5) / 1000000.0;
+			printf("        Median rate:           %8.4f MT/s\n", rate);
+		}
+	}
+
+	printf("\n");
+
+	if (cli_config.bench_json)
+	{
+		FILE* file = fopen(cli_config.bench_json, "w");
+		if (!file)
+		{
+			printf("ERROR: File open failed '%s'\n", cli_config.bench_json);
+			return 1;
+		}
+
+		fprintf(file, "{\n");
+		fprintf(file, "  \"iterations\": %u,\n", cli_config.bench_iterations);
+		fprintf(file, "  \"warmup_iterations\": %u,\n", warmup_count);
+		fprintf(file, "  \"thread_count\": %u,\n", cli_config.thread_count);
+		fprintf(file, "  \"texels\": %.0f,\n", texels);
+		fprintf(file, "  \"phases\": {");
+		for (size_t i = 0; i < phases.size(); i++)
+		{
+			const bench_phase& phase = *phases[i];
+			fprintf(file, "%s\n    \"%s\": {\n", i ? "," : "", phase.key);
+			fprintf(file, "      \"min_s\": %.9f,\n", phase.samples.front());
+			fprintf(file, "      \"median_s\": %.9f,\n", get_percentile(phase.samples, 0.5));
+			fprintf(file, "      \"p95_s\": %.9f", get_percentile(phase.samples, 0.95));
+			if (phase.report_rate)
+			{
+				double rate = texels / get_percentile(phase.samples, 0.5) / 1000000.0;
+				fprintf(file, ",\n      \"median_mtps\": %.6f", rate);
+			}
+			fprintf(file, "\n    }");
+		}
+		fprintf(file, "\n  }\n}\n");
+
+		if (fclose(file))
+		{
+			printf("ERROR: Failed to store benchmark report %s\n", cli_config.bench_json);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief The configuration shared by all batch entries with the same options.
+ */
+struct batch_config
+{
+	/** @brief The codec configuration. */
+	astcenc_config config;
+	/** @brief The command line configuration. */
+	cli_config_options cli_config;
+	/** @brief The image preprocess operation. */
+	astcenc_preprocess preprocess;
+	/** @brief The codec context, reused for every entry with this config. */
+	astcenc_context* context;
+};
+
+/**
+ * @brief A single batch manifest entry, as it moves through the pipeline.
+ */
+struct batch_entry
+{
+	/** @brief The manifest line number, for error reporting. */
+	unsigned int line;
+	/** @brief The shared configuration for this entry. */
+	batch_config* config;
+	/** @brief The input file name. */
+	std::string input_filename;
+	/** @brief The output file name. */
+	std::string output_filename;
+	/** @brief The loaded input image, owned by the entry until compressed. */
+	astcenc_image* image;
+	/** @brief The compressed levels, owned by the entry until stored. */
+	std::vector<astc_compressed_image> levels;
+	/** @brief True if any stage has failed for this entry. */
+	bool failed;
+};
+
+/**
+ * @brief A bounded blocking queue linking two stages of the batch pipeline.
+ *
+ * The bound limits how far a producer stage can run ahead of its consumer,
+ * which limits the number of images held in memory at any one time.
+ */
+class batch_queue
+{
+private:
+	/** @brief Lock used for critical section and condition synchronization. */
+	std::mutex m_lock;
+
+	/** @brief Condition variable signalled on any change of queue state. */
+	std::condition_variable m_changed;
+
+	/** @brief The queued entries, in manifest order. */
+	std::deque<batch_entry*> m_entries;
+
+	/** @brief The maximum number of queued entries. */
+	size_t m_capacity;
+
+	/** @brief True if the producer will push no more entries. */
+	bool m_closed;
+
+public:
+	/**
+	 * @brief Create a new queue.
+	 *
+	 * @param capacity   The maximum number of queued entries.
+	 */
+	explicit batch_queue(size_t capacity)
+		: m_capacity(capacity), m_closed(false)
+	{
+	}
+
+	/**
+	 * @brief Push an entry, blocking while the queue is full.
+	 *
+	 * @param entry   The entry to push.
+	 */
+	void push(batch_entry* entry)
+	{
+		std::unique_lock<std::mutex> lck(m_lock);
+		m_changed.wait(lck, [this]{ return m_entries.size() < m_capacity; });
+		m_entries.push_back(entry);
+		m_changed.notify_all();
+	}
+
+	/**
+	 * @brief Pop an entry, blocking while the queue is empty.
+	 *
+	 * @return The entry, or nullptr if the queue is empty and closed.
+	 */
+	batch_entry* pop()
+	{
+		std::unique_lock<std::mutex> lck(m_lock);
+		m_changed.wait(lck, [this]{ return !m_entries.empty() || m_closed; });
+		if (m_entries.empty())
+		{
+			return nullptr;
+		}
+
+		batch_entry* entry = m_entries.front();
+		m_entries.pop_front();
+		m_changed.notify_all();
+		return entry;
+	}
+
+	/**
+	 * @brief Close the queue, waking any consumer once the queue drains.
+	 */
+	void close()
+	{
+		std::lock_guard<std::mutex> lck(m_lock);
+		m_closed = true;
+		m_changed.notify_all();
+	}
+};
+
+struct batch_workload {
+	std::vector<batch_entry>* entries;
+	// Entries which have been loaded, waiting to be compressed
+	batch_queue loaded { 1 };
+	// Entries which have been compressed, waiting to be stored
+	batch_queue compressed { 1 };
+	// The number of texels compressed, including mipmaps
+	double texel_count;
+	// The number of entries which failed
+	unsigned int fail_count;
+};
+
+/**
+ * @brief Parse a batch manifest, creating a codec context for each config.
+ *
+ * Each line of the manifest is a compression command line without the
+ * executable name, i.e. "<mode> <in> <out> <blocksize> <preset> [options]".
+ * Arguments are separated by whitespace, and blank lines and lines starting
+ * with '#' are ignored. Lines with the same mode and options share a config
+ * and a codec context.
+ *
+ * @param      filename   The manifest file name.
+ * @param      silent     Should the per-config reports be suppressed?
+ * @param[out] configs    The configs, with allocated contexts.
+ * @param[out] entries    The manifest entries.
+ *
+ * @return 0 if everything is okay, 1 if there is some error
+ */
+static int parse_batch_manifest(
+	const char* filename,
+	bool silent,
+	std::vector<std::unique_ptr<batch_config>>& configs,
+	std::vector<batch_entry>& entries
+) {
+	std::ifstream file(filename);
+	if (!file)
+	{
+		printf("ERROR: Failed to open batch manifest %s\n", filename);
+		return 1;
+	}
+
+	std::map<std::string, batch_config*> config_map;
+	std::string text;
+	unsigned int line = 0;
+	while (std::getline(file, text))
+	{
+		line++;
+
+		std::istringstream stream(text);
+		std::vector<std::string> args { "astcenc" };
+		std::string arg;
+		while (stream >> arg)
+		{
+			args.push_back(arg);
+		}
+
+		if ((args.size() == 1) || (args[1][0] == '#'))
+		{
+			continue;
+		}
+
+		if (args.size() < 6)
+		{
+			printf("ERROR: Batch manifest line %u: expected <mode> <in> <out> <blocksize> <preset>\n", line);
+			return 1;
+		}
+
+		if (silent)
+		{
+			args.push_back("-silent");
+		}
+
+		std::vector<char*> argv;
+		for (auto& a : args)
+		{
+			argv.push_back(&a[0]);
+		}
+
+		int argc = static_cast<int>(argv.size());
+
+		astcenc_operation operation;
+		astcenc_profile profile;
+		int error = parse_commandline_options(argc, argv.data(), operation, profile);
+		if (error)
+		{
+			return 1;
+		}
+
+		if (operation != ASTCENC_OP_COMPRESS)
+		{
+			printf("ERROR: Batch manifest line %u: only compression is supported\n", line);
+			return 1;
+		}
+
+		// Everything except the file names selects the config
+		std::string key = args[1];
+		for (size_t i = 4; i < args.size(); i++)
+		{
+			key += " " + args[i];
+		}
+
+		batch_config* config;
+		auto it = config_map.find(key);
+		if (it != config_map.end())
+		{
+			config = it->second;
+		}
+		else
+		{
+			configs.emplace_back(new batch_config());
+			config = configs.back().get();
+			config->cli_config = cli_config_defaults;
+			config->context = nullptr;
+
+			astc_compressed_image image_comp {};
+			error = init_astcenc_config(argc, argv.data(), profile, operation, image_comp,
+			                            config->preprocess, config->config);
+			if (error)
+			{
+				return 1;
+			}
+
+			error = edit_astcenc_config(argc, argv.data(), operation,
+			                            config->cli_config, config->config);
+			if (error)
+			{
+				return 1;
+			}
+
+			if (config->cli_config.bench_iterations)
+			{
+				printf("ERROR: -bench is not supported in batch manifests\n");
+				return 1;
+			}
+
+			astcenc_error status = astcenc_context_alloc(config->config, config->cli_config.thread_count,
+			                                             &config->context);
+			if (status != ASTCENC_SUCCESS)
+			{
+				printf("ERROR: Codec context alloc failed: %s\n", astcenc_get_error_string(status));
+				return 1;
+			}
+
+			config_map[key] = config;
+		}
+
+		if (config->cli_config.mipmap && !is_ktx_filename(args[3]))
+		{
+			printf("ERROR: Batch manifest line %u: -mipmap requires a KTX or KTX2 output file\n", line);
+			return 1;
+		}
+
+		if (config->cli_config.zstd_level && !ends_with(args[3], ".ktx2"))
+		{
+			printf("ERROR: Batch manifest line %u: -zstd requires a KTX2 output file\n", line);
+			return 1;
+		}
+
+		if (config->cli_config.incremental_image)
+		{
+			printf("ERROR: Batch manifest line %u: -incremental is not supported in batch mode\n", line);
+			return 1;
+		}
+
+		if (config->cli_config.warmstart_comp)
+		{
+			printf("ERROR: Batch manifest line %u: -warmstart is not supported in batch mode\n", line);
+			return 1;
+		}
+
+		if (config->cli_config.thread_affinity)
+		{
+			printf("ERROR: Batch manifest line %u: -affinity is not supported in batch mode\n", line);
+			return 1;
+		}
+
+		entries.push_back({ line, config, args[2], args[3], nullptr, {}, false });
+	}
+
+	return 0;
 }
 
 /**
- * @brief Create a copy of @c input with premultiplied color data.
+ * @brief Batch pipeline stage to load and preprocess each input image.
  *
- * If we are compressing sRGB data we linearize the data prior to
- * premultiplication and re-gamma-encode afterwards.
+ * @param work   The batch workload.
+ */
+static void batch_load_stage(
+	batch_workload& work
+) {
+	for (auto& entry : *work.entries)
+	{
+		const batch_config& config = *entry.config;
+		bool is_hdr;
+		unsigned int component_count;
+		// Loading overlaps compression, which already uses all of the threads
+		entry.image = load_uncomp_input(entry.input_filename, config.config, config.cli_config,
+		                                config.preprocess, 1, is_hdr, component_count);
+		entry.failed = !entry.image;
+		work.loaded.push(&entry);
+	}
+
+	work.loaded.close();
+}
+
+/**
+ * @brief Batch pipeline stage to compress each loaded image.
+ *
+ * This stage uses the worker threads of each entry's codec context.
  *
- * @param[in]  input     The input image.
- * @param[out] output    The output image, must use F32 channels.
- * @param      profile   The encoding profile.
+ * @param work   The batch workload.
  */
-static void image_preprocess_premultiply(
-	const astcenc_image& input,
-	astcenc_image& output,
-	astcenc_profile profile
+static void batch_compress_stage(
+	batch_workload& work
 ) {
-	for (unsigned int z = 0; z < input.dim_z; z++)
+	while (batch_entry* entry = work.loaded.pop())
 	{
-		for (unsigned int y = 0; y < input.dim_y; y++)
-		{
-			for (unsigned int x = 0; x < input.dim_x; x++)
+		if (!entry->failed)
+		{
+			const batch_config& config = *entry->config;
+			astcenc_compress_reset(config.context);
+			astcenc_error status = compress_image_levels(config.context, config.config,
+			                                             config.cli_config, entry->image,
+			                                             nullptr, nullptr, nullptr, entry->levels);
+			if (status != ASTCENC_SUCCESS)
 			{
-				vfloat4 pixel = image_get_pixel(input, x, y, z);
+				printf("ERROR: Codec compress failed for %s: %s\n",
+				       entry->input_filename.c_str(), astcenc_get_error_string(status));
+				entry->failed = true;
+			}
 
-				// Linearize sRGB
-				if (profile == ASTCENC_PRF_LDR_SRGB)
-				{
-					pixel.set_lane<0>(srgb_to_linear(pixel.lane<0>()));
-					pixel.set_lane<1>(srgb_to_linear(pixel.lane<1>()));
-					pixel.set_lane<2>(srgb_to_linear(pixel.lane<2>()));
-				}
+			for (auto& level : entry->levels)
+			{
+				work.texel_count += (double)level.dim_x * (double)level.dim_y * (double)level.dim_z;
+			}
+		}
 
-				// Premultiply pixel in linear-space
-				pixel.set_lane<0>(pixel.lane<0>() * pixel.lane<3>());
-				pixel.set_lane<1>(pixel.lane<1>() * pixel.lane<3>());
-				pixel.set_lane<2>(pixel.lane<2>() * pixel.lane<3>());
+		// Release the input as soon as possible to limit peak memory
+		free_image(entry->image);
+		entry->image = nullptr;
+		work.compressed.push(entry);
+	}
 
-				// Gamma-encode sRGB
-				if (profile == ASTCENC_PRF_LDR_SRGB)
-				{
-					pixel.set_lane<0>(linear_to_srgb(pixel.lane<0>()));
-					pixel.set_lane<1>(linear_to_srgb(pixel.lane<1>()));
-					pixel.set_lane<2>(linear_to_srgb(pixel.lane<2>()));
-				}
+	work.compressed.close();
+}
 
-				image_set_pixel(output, x, y, z, pixel);
-			}
+/**
+ * @brief Batch pipeline stage to store each compressed image.
+ *
+ * @param work   The batch workload.
+ */
+static void batch_store_stage(
+	batch_workload& work
+) {
+	while (batch_entry* entry = work.compressed.pop())
+	{
+		if (!entry->failed)
+		{
+			const batch_config& config = *entry->config;
+			int error = store_comp_file(entry->levels, entry->output_filename,
+			                            config.config.profile, config.cli_config.zstd_level);
+			entry->failed = error != 0;
+		}
+
+		if (entry->failed)
+		{
+			printf("ERROR: Batch manifest line %u failed\n", entry->line);
+			work.fail_count++;
+		}
+
+		for (auto& level : entry->levels)
+		{
+			delete[] level.data;
+		}
+
+		entry->levels.clear();
+	}
+}
+
+static void batch_workload_runner(
+	int thread_count,
+	int thread_id,
+	void* payload
+) {
+	(void)thread_count;
+
+	// Each pipeline stage runs on its own thread, so loading the next image
+	// and storing the previous image overlap compression of the current one
+	batch_workload* work = static_cast<batch_workload*>(payload);
+	switch (thread_id)
+	{
+	case 0:
+		batch_load_stage(*work);
+		break;
+	case 1:
+		batch_compress_stage(*work);
+		break;
+	default:
+		batch_store_stage(*work);
+		break;
+	}
+}
+
+/**
+ * @brief Compress all of the images listed in a batch manifest.
+ *
+ * @param argc       Command line argument count.
+ * @param[in] argv   Command line argument vector.
+ *
+ * @return 0 if everything is okay, 1 if there is some error
+ */
+static int process_batch(
+	int argc,
+	char **argv
+) {
+	double start_time = get_time();
+
+	if (argc < 3)
+	{
+		printf("ERROR: Batch manifest not specified\n");
+		return 1;
+	}
+
+	bool silent = false;
+	for (int i = 3; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-silent"))
+		{
+			silent = true;
+		}
+		else
+		{
+			printf("ERROR: Unknown batch option '%s'\n", argv[i]);
+			return 1;
+		}
+	}
+
+	std::vector<std::unique_ptr<batch_config>> configs;
+	std::vector<batch_entry> entries;
+	int error = parse_batch_manifest(argv[2], silent, configs, entries);
+
+	unsigned int fail_count = 0;
+	double start_coding_time = get_time();
+	if (!error)
+	{
+		batch_workload work;
+		work.entries = &entries;
+		work.texel_count = 0.0;
+		work.fail_count = 0;
+
+		launch_threads(3, batch_workload_runner, &work);
+
+		fail_count = work.fail_count;
+		double end_coding_time = get_time();
+
+		if (!silent)
+		{
+			double tex_rate = work.texel_count / (end_coding_time - start_coding_time);
+			tex_rate = tex_rate / 1000000.0;
+
+			printf("Batch\n");
+			printf("=====\n\n");
+			printf("    Manifest:                   %s\n", argv[2]);
+			printf("    Images:                     %zu\n", entries.size());
+			printf("    Configurations:             %zu\n", configs.size());
+			printf("    Failed:                     %u\n", fail_count);
+			printf("\n");
+
+			printf("Performance metrics\n");
+			printf("===================\n\n");
+			printf("    Total time:                %8.4f s\n", end_coding_time - start_time);
+			printf("    Coding time:               %8.4f s\n", end_coding_time - start_coding_time);
+			printf("    Coding rate:               %8.4f MT/s\n", tex_rate);
 		}
 	}
+
+	for (auto& config : configs)
+	{
+		astcenc_context_free(config->context);
+	}
+
+	return (error || fail_count) ? 1 : 0;
 }
 
 int main(
@@ -1286,6 +3265,8 @@ int main(
 	case ASTCENC_OP_VERSION:
 		astcenc_print_header();
 		return 0;
+	case ASTCENC_OP_BATCH:
+		return process_batch(argc, argv);
 	default:
 		break;
 	}
@@ -1322,11 +3303,19 @@ int main(
 				return 1;
 			}
 		}
-		else if (ends_with(input_filename, ".ktx"))
+		else if (is_ktx_filename(input_filename))
 		{
 			// TODO: Just pass on a std::string
 			bool is_srgb;
-			error = load_ktx_compressed_image(input_filename.c_str(), is_srgb, image_comp);
+			if (ends_with(input_filename, ".ktx"))
+			{
+				error = load_ktx_compressed_image(input_filename.c_str(), is_srgb, image_comp);
+			}
+			else
+			{
+				error = load_ktx2_compressed_image(input_filename.c_str(), is_srgb, image_comp);
+			}
+
 			if (error)
 			{
 				return 1;
@@ -1357,9 +3346,7 @@ int main(
 	}
 
 	// Initialize cli_config_options with default values
-	cli_config_options cli_config { 0, 1, false, false, -10, 10,
-		{ ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A },
-		{ ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A } };
+	cli_config_options cli_config = cli_config_defaults;
 
 	error = edit_astcenc_config(argc, argv, operation, cli_config, config);
 	if (error)
@@ -1367,6 +3354,48 @@ int main(
 		return 1;
 	}
 
+	if (cli_config.mipmap &&
+	    ((operation != ASTCENC_OP_COMPRESS) || !is_ktx_filename(output_filename)))
+	{
+		printf("ERROR: -mipmap requires compression to a KTX or KTX2 output file\n");
+		return 1;
+	}
+
+	if (cli_config.zstd_level &&
+	    ((operation != ASTCENC_OP_COMPRESS) || !ends_with(output_filename, ".ktx2")))
+	{
+		printf("ERROR: -zstd requires compression to a KTX2 output file\n");
+		return 1;
+	}
+
+	if (cli_config.bench_json && !cli_config.bench_iterations)
+	{
+		printf("ERROR: -bench-json requires -bench\n");
+		return 1;
+	}
+
+	if (cli_config.incremental_image &&
+	    (!(operation & ASTCENC_STAGE_COMPRESS) || cli_config.mipmap))
+	{
+		printf("ERROR: -incremental requires compression without -mipmap\n");
+		return 1;
+	}
+
+	if (cli_config.warmstart_comp &&
+	    (!(operation & ASTCENC_STAGE_COMPRESS) || cli_config.mipmap))
+	{
+		printf("ERROR: -warmstart requires compression without -mipmap\n");
+		return 1;
+	}
+
+	if (cli_config.warmstart_comp && cli_config.incremental_image)
+	{
+		printf("ERROR: -warmstart cannot be used with -incremental\n");
+		return 1;
+	}
+
+	set_thread_affinity(cli_config.thread_affinity);
+
 	astcenc_image* image_uncomp_in = nullptr ;
 	unsigned int image_uncomp_in_channel_count = 0;
 	bool image_uncomp_in_is_hdr = false;
@@ -1386,45 +3415,14 @@ int main(
 	// Load the uncompressed input file if needed
 	if (operation & ASTCENC_STAGE_LD_NCOMP)
 	{
-		image_uncomp_in = load_uncomp_file(input_filename.c_str(), cli_config.array_size,
-		                                   cli_config.y_flip, image_uncomp_in_is_hdr, image_uncomp_in_channel_count);
+		image_uncomp_in = load_uncomp_input(input_filename, config, cli_config, preprocess,
+		                                    cli_config.thread_count, image_uncomp_in_is_hdr,
+		                                    image_uncomp_in_channel_count);
 		if (!image_uncomp_in)
 		{
-			printf ("ERROR: Failed to load uncompressed image file\n");
 			return 1;
 		}
 
-
-		if (preprocess != ASTCENC_PP_NONE)
-		{
-			// Allocate a float image so we can avoid additional quantization,
-			// as e.g. premultiplication can result in fractional color values
-			astcenc_image* image_pp = alloc_image(32,
-			                                      image_uncomp_in->dim_x,
-			                                      image_uncomp_in->dim_y,
-			                                      image_uncomp_in->dim_z);
-			if (!image_pp)
-			{
-				printf ("ERROR: Failed to allocate preprocessed image\n");
-				return 1;
-			}
-
-			if (preprocess == ASTCENC_PP_NORMALIZE)
-			{
-				image_preprocess_normalize(*image_uncomp_in, *image_pp);
-			}
-
-			if (preprocess == ASTCENC_PP_PREMULTIPLY)
-			{
-				image_preprocess_premultiply(*image_uncomp_in, *image_pp,
-				                             config.profile);
-			}
-
-			// Delete the original as we no longer need it
-			free_image(image_uncomp_in);
-			image_uncomp_in = image_pp;
-		}
-
 		if (!cli_config.silentmode)
 		{
 			printf("Source image\n");
@@ -1441,7 +3439,78 @@ int main(
 				printf("    Dimensions:                 2D, %ux%u\n",
 				       image_uncomp_in->dim_x, image_uncomp_in->dim_y);
 			}
-			printf("    Channels:                   %d\n\n", image_uncomp_in_channel_count);
+			printf("    Channels:                   %d\n", image_uncomp_in_channel_count);
+			if (cli_config.mipmap)
+			{
+				printf("    Mipmap levels:              %u\n", get_mipmap_level_count(*image_uncomp_in));
+			}
+			printf("\n");
+		}
+	}
+
+	// Load the previous images for an incremental compression
+	astcenc_image* image_prev_in = nullptr;
+	astc_compressed_image image_prev_comp {};
+	if (cli_config.incremental_image)
+	{
+		bool prev_is_hdr;
+		unsigned int prev_channel_count;
+		image_prev_in = load_uncomp_input(cli_config.incremental_image, config, cli_config,
+		                                  preprocess, cli_config.thread_count, prev_is_hdr,
+		                                  prev_channel_count);
+		if (!image_prev_in)
+		{
+			return 1;
+		}
+
+		if ((image_prev_in->dim_x != image_uncomp_in->dim_x) ||
+		    (image_prev_in->dim_y != image_uncomp_in->dim_y) ||
+		    (image_prev_in->dim_z != image_uncomp_in->dim_z) ||
+		    (image_prev_in->data_type != image_uncomp_in->data_type))
+		{
+			printf("ERROR: Previous image %s does not match the source image\n",
+			       cli_config.incremental_image);
+			return 1;
+		}
+
+		error = load_cimage(cli_config.incremental_comp, image_prev_comp);
+		if (error)
+		{
+			return 1;
+		}
+
+		if ((image_prev_comp.block_x != config.block_x) ||
+		    (image_prev_comp.block_y != config.block_y) ||
+		    (image_prev_comp.block_z != config.block_z) ||
+		    (image_prev_comp.dim_x != image_uncomp_in->dim_x) ||
+		    (image_prev_comp.dim_y != image_uncomp_in->dim_y) ||
+		    (image_prev_comp.dim_z != image_uncomp_in->dim_z))
+		{
+			printf("ERROR: Previous compressed image %s does not match the source image\n",
+			       cli_config.incremental_comp);
+			return 1;
+		}
+	}
+
+	// Load the previous compressed image for a warm-start compression
+	if (cli_config.warmstart_comp)
+	{
+		error = load_cimage(cli_config.warmstart_comp, image_prev_comp);
+		if (error)
+		{
+			return 1;
+		}
+
+		if ((image_prev_comp.block_x != config.block_x) ||
+		    (image_prev_comp.block_y != config.block_y) ||
+		    (image_prev_comp.block_z != config.block_z) ||
+		    (image_prev_comp.dim_x != image_uncomp_in->dim_x) ||
+		    (image_prev_comp.dim_y != image_uncomp_in->dim_y) ||
+		    (image_prev_comp.dim_z != image_uncomp_in->dim_z))
+		{
+			printf("ERROR: Warm-start compressed image %s does not match the source image\n",
+			       cli_config.warmstart_comp);
+			return 1;
 		}
 	}
 
@@ -1461,50 +3530,60 @@ int main(
 		             (double)image_comp.dim_z;
 	}
 
-	// Compress an image
+	astcenc_stats stats {};
+	std::vector<astc_compressed_image> image_comp_levels;
+
+	// Stream a single compressed image to a .astc file while it compresses,
+	// so little of the file write remains once compression completes
+	async_writer* writer = nullptr;
+	uint8_t writer_header[ASTC_HEADER_SIZE];
+	if ((operation == ASTCENC_OP_COMPRESS) && !cli_config.mipmap &&
+	    ends_with(output_filename, ".astc"))
+	{
+		writer = async_writer_open(output_filename.c_str(), cli_config.direct_io);
+		if (!writer)
+		{
+			printf("ERROR: File open failed '%s'\n", output_filename.c_str());
+			return 1;
+		}
+
+		astc_compressed_image header_image { config.block_x, config.block_y, config.block_z,
+		                                     image_uncomp_in->dim_x, image_uncomp_in->dim_y,
+		                                     image_uncomp_in->dim_z, nullptr, 0 };
+		get_cimage_header(header_image, writer_header);
+		async_writer_write(writer, writer_header, ASTC_HEADER_SIZE);
+	}
+
+	// Compress an image, and its mipmaps if requested
 	if (operation & ASTCENC_STAGE_COMPRESS)
 	{
-		unsigned int blocks_x = (image_uncomp_in->dim_x + config.block_x - 1) / config.block_x;
-		unsigned int blocks_y = (image_uncomp_in->dim_y + config.block_y - 1) / config.block_y;
-		unsigned int blocks_z = (image_uncomp_in->dim_z + config.block_z - 1) / config.block_z;
-		size_t buffer_size = blocks_x * blocks_y * blocks_z * 16;
-		uint8_t* buffer = new uint8_t[buffer_size];
-
-		compression_workload work;
-		work.context = codec_context;
-		work.image = image_uncomp_in;
-		work.swizzle = cli_config.swz_encode;
-		work.data_out = buffer;
-		work.data_len = buffer_size;
-		work.error = ASTCENC_SUCCESS;
-
-		// Only launch worker threads for multi-threaded use - it makes basic
-		// single-threaded profiling and debugging a little less convoluted
-		if (cli_config.thread_count > 1)
+		codec_status = compress_image_levels(codec_context, config, cli_config,
+		                                     image_uncomp_in, writer, image_prev_in,
+		                                     image_prev_comp.data ? &image_prev_comp : nullptr,
+		                                     image_comp_levels);
+		if (codec_status != ASTCENC_SUCCESS)
 		{
-			launch_threads(cli_config.thread_count, compression_workload_runner, &work);
+			printf("ERROR: Codec compress failed: %s\n", astcenc_get_error_string(codec_status));
+			if (writer)
+			{
+				async_writer_close(writer, true);
+			}
+			return 1;
 		}
-		else
+
+		if (cli_config.print_stats)
 		{
-			work.error = astcenc_compress_image(
-			    work.context, *work.image, work.swizzle,
-			    work.data_out, work.data_len, 0);
+			astcenc_get_stats(codec_context, stats);
 		}
 
-		if (work.error != ASTCENC_SUCCESS)
+		for (size_t i = 1; i < image_comp_levels.size(); i++)
 		{
-			printf("ERROR: Codec compress failed: %s\n", astcenc_get_error_string(work.error));
-			return 1;
+			image_size += (double)image_comp_levels[i].dim_x *
+			              (double)image_comp_levels[i].dim_y *
+			              (double)image_comp_levels[i].dim_z;
 		}
 
-		image_comp.block_x = config.block_x;
-		image_comp.block_y = config.block_y;
-		image_comp.block_z = config.block_z;
-		image_comp.dim_x = image_uncomp_in->dim_x;
-		image_comp.dim_y = image_uncomp_in->dim_y;
-		image_comp.dim_z = image_uncomp_in->dim_z;
-		image_comp.data = buffer;
-		image_comp.data_len = buffer_size;
+		image_comp = image_comp_levels[0];
 	}
 
 	// Decompress an image
@@ -1521,8 +3600,7 @@ int main(
 		image_decomp_out = alloc_image(
 		    out_bitness, image_comp.dim_x, image_comp.dim_y, image_comp.dim_z);
 
-		codec_status = astcenc_decompress_image(codec_context, image_comp.data, image_comp.data_len,
-		                                        *image_decomp_out, cli_config.swz_decode);
+		codec_status = decompress_image(codec_context, cli_config, image_comp, image_decomp_out);
 		if (codec_status != ASTCENC_SUCCESS)
 		{
 			printf("ERROR: Codec decompress failed: %s\n", astcenc_get_error_string(codec_status));
@@ -1536,43 +3614,27 @@ int main(
 	if (operation & ASTCENC_STAGE_COMPARE)
 	{
 		compute_error_metrics(image_uncomp_in_is_hdr, image_uncomp_in_channel_count, image_uncomp_in,
-		                      image_decomp_out, cli_config.low_fstop, cli_config.high_fstop);
+		                      image_decomp_out, cli_config.low_fstop, cli_config.high_fstop,
+		                      cli_config.thread_count);
 	}
 
 	// Store compressed image
-	if (operation & ASTCENC_STAGE_ST_COMP)
+	if (writer)
 	{
-		if (ends_with(output_filename, ".astc"))
+		error = async_writer_close(writer, false);
+		if (error)
 		{
-			error = store_cimage(image_comp, output_filename.c_str());
-			if (error)
-			{
-				printf ("ERROR: Failed to store compressed image\n");
-				return 1;
-			}
-		}
-		else if (ends_with(output_filename, ".ktx"))
-		{
-			bool srgb = profile == ASTCENC_PRF_LDR_SRGB;
-			error = store_ktx_compressed_image(image_comp, output_filename.c_str(), srgb);
-			if (error)
-			{
-				printf ("ERROR: Failed to store compressed image\n");
-				return 1;
-			}
+			printf("ERROR: Failed to store compressed image %s\n", output_filename.c_str());
+			return 1;
 		}
-		else
+	}
+	else if (operation & ASTCENC_STAGE_ST_COMP)
+	{
+		error = store_comp_file(image_comp_levels, output_filename, profile,
+		                        cli_config.zstd_level);
+		if (error)
 		{
-#if defined(_WIN32)
-			bool is_null = output_filename == "NUL" || output_filename == "nul";
-#else
-			bool is_null = output_filename == "/dev/null";
-#endif
-			if (!is_null)
-			{
-				printf("ERROR: Unknown compressed output file type\n");
-				return 1;
-			}
+			return 1;
 		}
 	}
 
@@ -1600,11 +3662,28 @@ int main(
 		}
 	}
 
+	// Benchmark the codec stages using the in-memory images
+	if (cli_config.bench_iterations)
+	{
+		error = run_benchmark(codec_context, cli_config, operation, image_uncomp_in,
+		                      image_comp, image_decomp_out);
+		if (error)
+		{
+			return 1;
+		}
+	}
+
 	free_image(image_uncomp_in);
+	free_image(image_prev_in);
+	delete[] image_prev_comp.data;
 	free_image(image_decomp_out);
 	astcenc_context_free(codec_context);
 
 	delete[] image_comp.data;
+	for (size_t i = 1; i < image_comp_levels.size(); i++)
+	{
+		delete[] image_comp_levels[i].data;
+	}
 
 	if ((operation & ASTCENC_STAGE_COMPARE) || (!cli_config.silentmode))
 	{
@@ -1619,5 +3698,30 @@ int main(
 		printf("    Coding rate:               %8.4f MT/s\n", tex_rate);
 	}
 
+	if (cli_config.print_stats && (operation & ASTCENC_STAGE_COMPRESS))
+	{
+		printf("\nCompression statistics\n");
+		printf("======================\n\n");
+		printf("    Blocks:                    %8llu\n", (unsigned long long)stats.block_count);
+		printf("    Cache hits:                %8llu\n", (unsigned long long)stats.cache_hit_count);
+		printf("    RDO reused blocks:         %8llu\n", (unsigned long long)stats.rdo_reuse_count);
+		printf("    Unchanged blocks:          %8llu\n", (unsigned long long)stats.unchanged_block_count);
+		printf("    Adaptive effort retries:   %8llu\n", (unsigned long long)stats.adaptive_retry_count);
+		printf("    Exit constant color:       %8llu\n", (unsigned long long)stats.exit_constant_count);
+		printf("    Exit warm-start hint:      %8llu\n", (unsigned long long)stats.exit_hint_count);
+		printf("    Exit 1 plane:              %8llu\n", (unsigned long long)stats.exit_1_plane_count);
+		printf("    Exit 2 planes:             %8llu\n", (unsigned long long)stats.exit_2_plane_count);
+		printf("    Exit 2 partitions:         %8llu\n", (unsigned long long)stats.exit_partition_count[0]);
+		printf("    Exit 3 partitions:         %8llu\n", (unsigned long long)stats.exit_partition_count[1]);
+		printf("    Exit 4 partitions:         %8llu\n", (unsigned long long)stats.exit_partition_count[2]);
+		printf("    Exit partition early out:  %8llu\n", (unsigned long long)stats.exit_partition_early_out_count);
+		printf("    Exit full search:          %8llu\n", (unsigned long long)stats.exit_full_search_count);
+		printf("    Block modes evaluated:     %8llu\n", (unsigned long long)stats.block_modes_evaluated);
+		printf("    Refinement iterations:     %8llu\n", (unsigned long long)stats.refinement_iterations);
+		printf("    Average/variance time:     %8.4f s\n", (double)stats.avg_var_time_ns * 1e-9);
+		printf("    Block fetch time:          %8.4f s\n", (double)stats.fetch_time_ns * 1e-9);
+		printf("    Block compress time:       %8.4f s\n", (double)stats.compress_time_ns * 1e-9);
+	}
+
 	return 0;
 }
@@ -75,6 +75,7 @@ SYNOPSIS
        astcenc {-cl|-cs|-ch|-cH} <in> <out> <blocksize> <quality> [options]
        astcenc {-dl|-ds|-dh|-dH} <in> <out> <blocksize> <quality> [options]
        astcenc {-tl|-ts|-th|-tH} <in> <out> <blocksize> <quality> [options]
+       astcenc -batch <manifest> [-silent]
 
 DESCRIPTION
        astcenc compresses image files into the Adaptive Scalable Texture
@@ -197,6 +198,49 @@ COMPRESSION
             codec encoding swizzle, so color data must be in the RGB
             channels in the source image.
 
+       -mipmap
+           Generate and compress the full mipmap chain of the image, storing
+           all levels in the output file, which must be a KTX or KTX2 file.
+           Levels are generated with a box filter, which filters sRGB data
+           in linear space. Smaller levels are generated while the first
+           level is compressed.
+
+       -mipmap-coverage <cutoff>
+           Generate mipmaps as for -mipmap, scaling the alpha of each level
+           so that the fraction of texels with alpha above <cutoff> matches
+           the first level. This preserves the coverage of alpha tested
+           geometry, such as foliage, in smaller levels.
+
+       -zstd <level>
+           Supercompress each level of a KTX2 output file using zstd at the
+           given level, between 1 and 22. Each level is compressed and
+           written in chunks as it is stored. This option is only available
+           in builds configured with zstd support.
+
+       -incremental <prev-image> <prev-astc>
+           Recompress an edited image, reusing the encoding of each block
+           in the previous .astc output whose input texels are unchanged
+           from the previous source image. Texels used by any averaging
+           kernels are included in the comparison. Only changed blocks are
+           compressed, so small edits are much faster to recompress. The
+           previous output must have been compressed from the previous
+           image using the same options. Not supported with -mipmap.
+
+       -warmstart <prev-astc>
+           Compress a frame of a sequence of similar images, such as video
+           frames or animation flipbooks, using the .astc output of the
+           previous frame as a hint. The search for each block first tries
+           the block mode and partitioning of the same block in the hint,
+           and stops if this meets the quality target. The hint must use
+           the same block size and image dimensions. Not supported with
+           -mipmap or -incremental.
+
+       -direct-io
+           Write .astc output files using unbuffered direct I/O, bypassing
+           the operating system file cache, if supported by the file system.
+           Single image .astc output is always written by a background
+           thread while the rest of the image is compressed.
+
 COMPRESSION TIPS & TRICKS
        ASTC is a block-based format that can be prone to block artifacts.
        If block artifacts are a problem when compressing a given texture,
@@ -334,8 +378,9 @@ ADVANCED COMPRESSION
 
        -dblimit <number>
            Stop compression work on a block as soon as the PSNR of the
-           block, measured in dB, exceeds <number>. This option is
-           ineffective for HDR textures. Preset defaults, where N is the
+           block, measured in dB, exceeds <number>. For HDR textures the
+           limit is applied to an equivalent logarithmic error, where 0 dB
+           is an error of four stops. Preset defaults, where N is the
            number of texels in a block, are:
 
                -fastest    : MAX(53-19*log10(N),  70-35*log10(N))
@@ -369,6 +414,22 @@ ADVANCED COMPRESSION
                -thorough   : 0.95
                -exhaustive : 0.99
 
+       -budget <ms>
+           Adapt the compressor effort while compressing so the image is
+           compressed within a target time of <ms> milliseconds. The
+           selected preset and tuning options give the highest effort that
+           is used, and the effort is reduced as needed to meet the target.
+           The output of a budgeted compression is not deterministic.
+
+       -rdo <lambda>
+           Trade image quality for a smaller size after entropy coding the
+           output with an LZ-based coder, such as deflate or zstd. Blocks
+           may reuse the encoding, or the endpoints or weights, of one of
+           the previous blocks in their row. A block reuses a neighbor
+           encoding in full if its error is at most 1 + <lambda> times the
+           lowest error found. Useful values are between 0.1 and 2.0; the
+           default of 0 disables this optimization.
+
        Other options
        -------------
 
@@ -407,11 +468,57 @@ ADVANCED COMPRESSION
            after decompression. Note that using this option in a test mode
            (-t*) will have no effect as the image will be flipped twice.
 
+       -stats
+           Print statistics about the compressor search after compression,
+           including the number of blocks which exit the search at each
+           stage, and the time spent in each phase of compression. Times
+           are the sum over all compression threads.
+
+       -bench <iterations>
+           Benchmark the codec after the normal operation completes, by
+           repeating the compression and/or decompression of the in-memory
+           image for the given number of timed iterations. One warm-up
+           iteration is run for every ten timed iterations, with a minimum
+           of one. The minimum, median, and 95th percentile times of the
+           variance prepass, compression, and decompression are reported.
+           The variance prepass time is averaged over all threads, and is
+           included in the compression time. For mipmapped images only the
+           first level is benchmarked.
+
+       -bench-json <file>
+           Store the benchmark results to a JSON file. Requires -bench.
+
+       -blockcache
+           Reuse the encoding of blocks which have bit-identical input data,
+           rather than compressing every block. This can significantly
+           improve compression performance for images with many repeated
+           blocks, such as texture atlases and sprite sheets. This option
+           has no effect if the -v, -va, -a, or -warmstart options are
+           used.
+
+       -adaptive
+           Experimental. Compress each block using the search limits of the
+           -fastest preset first, while keeping the -dblimit quality target
+           of the chosen preset. Only blocks which miss the target are
+           compressed again using the search limits of the chosen preset.
+           This is only faster if most blocks can meet the target with the
+           fastest search, so should be used with a lowered -dblimit; the
+           targets of the built-in presets are rarely met, and are slower
+           with this option. Blocks accepted by the first search only just
+           meet the target, so image quality is lower than without this
+           option. It is not yet recommended for production use.
+
        -j <threads>
            Explicitly specify the number of compression/decompression
            theads to use in the codec. If not specified, the codec will
            use on thread per CPU detected in the system.
 
+       -affinity
+           Bind each worker thread to a single CPU. On systems with multiple
+           NUMA nodes this keeps each thread, and the working memory that it
+           allocates, on the same node. Only supported on Linux and Windows,
+           and not supported in batch mode.
+
        -silent
            Suppresses all non-essential diagnostic output from the codec.
            Error messages will always be printed, as will mandatory outputs
@@ -452,6 +559,28 @@ TEST
        LDR and HDR images, allowing some assessment of the compression
        image quality.
 
+BATCH
+       To compress many images in a single invocation you must specify a
+       manifest file, which lists one compression per line using the same
+       arguments as COMPRESSION without the executable name:
+
+           <mode> <in> <out> <blocksize> <quality> [options]
+
+       Arguments are separated by whitespace, so file names must not
+       contain spaces. Blank lines and lines starting with # are ignored.
+
+       Lines with the same mode, block size, quality, and options share a
+       single codec context, which is created once and reused. Loading of
+       the next image and storing of the previous image are overlapped
+       with compression of the current image.
+
+       Only compression modes are supported in a manifest. If any image
+       fails the remaining images are still processed, and the exit code
+       is non-zero.
+
+       -silent
+           Suppress the configuration and performance reports.
+
 COMPRESSION FILE FORMATS
        The following formats are supported as compression inputs:
 
@@ -483,6 +612,7 @@ COMPRESSION FILE FORMATS
 
            ASTC (*.astc)
            Khronos Texture KTX (*.ktx)
+           Khronos Texture KTX2 (*.ktx2)
 
 
 DECOMPRESSION FILE FORMATS
@@ -490,6 +620,9 @@ DECOMPRESSION FILE FORMATS
 
            ASTC (*.astc)
            Khronos Texture KTX (*.ktx)
+           Khronos Texture KTX2 (*.ktx2)
+
+       KTX2 files may be zstd supercompressed if the build has zstd support.
 
        The following formats are supported as decompression outputs:
 
@@ -524,7 +657,11 @@ QUICK REFERENCE
 // print version and basic build information
 void astcenc_print_header()
 {
-#if (ASTCENC_AVX == 2)
+#if defined(ASTCENC_ISA_DISPATCH)
+	const char* simdtype = "dispatch";
+#elif (ASTCENC_AVX == 512)
+	const char* simdtype = "avx512";
+#elif (ASTCENC_AVX == 2)
 	const char* simdtype = "avx2";
 #elif (ASTCENC_SSE == 41)
 	const char* simdtype = "sse4.1";
@@ -20,8 +20,9 @@ project(astc${CODEC}-${ISA_SIMD})
 set(GNU_LIKE "GNU,Clang,AppleClang")
 set(CLANG_LIKE "Clang,AppleClang")
 
-add_library(astc${CODEC}-${ISA_SIMD}-static
+set(ASTC_CORE_SOURCES
         astcenc_averages_and_directions.cpp
+        astcenc_block_cache.cpp
         astcenc_block_sizes2.cpp
         astcenc_color_quantize.cpp
         astcenc_color_unquantize.cpp
@@ -41,12 +42,36 @@ add_library(astc${CODEC}-${ISA_SIMD}-static
         astcenc_partition_tables.cpp
         astcenc_percentile_tables.cpp
         astcenc_pick_best_endpoint_format.cpp
-        astcenc_platform_isa_detection.cpp
         astcenc_quantization.cpp
         astcenc_symbolic_physical.cpp
         astcenc_weight_align.cpp
         astcenc_weight_quant_xfer_tables.cpp)
 
+if(${ISA_SIMD} MATCHES "dispatch")
+    # Dispatch builds compile the core once per ISA in a unique namespace; the
+    # dispatch layer and the ISA-independent helpers are compiled only once
+    set(ASTC_DISPATCH_ISAS avx512 avx2 sse4.1 sse2)
+
+    add_library(astc${CODEC}-${ISA_SIMD}-static
+            astcenc_dispatch.cpp
+            astcenc_mathlib.cpp
+            astcenc_mathlib_softfloat.cpp
+            astcenc_platform_isa_detection.cpp)
+
+    foreach(DISPATCH_ISA ${ASTC_DISPATCH_ISAS})
+        add_library(astc${CODEC}-${ISA_SIMD}-${DISPATCH_ISA} OBJECT
+                ${ASTC_CORE_SOURCES})
+
+        target_sources(astc${CODEC}-${ISA_SIMD}-static
+            PRIVATE
+                $<TARGET_OBJECTS:astc${CODEC}-${ISA_SIMD}-${DISPATCH_ISA}>)
+    endforeach()
+else()
+    add_library(astc${CODEC}-${ISA_SIMD}-static
+            ${ASTC_CORE_SOURCES}
+            astcenc_platform_isa_detection.cpp)
+endif()
+
 target_include_directories(astc${CODEC}-${ISA_SIMD}-static PUBLIC ${CMAKE_CURRENT_SOURCE_DIR})
 
 add_executable(astc${CODEC}-${ISA_SIMD}
@@ -69,6 +94,15 @@ target_compile_definitions(astc${CODEC}-${ISA_SIMD}
 
 target_link_libraries(astc${CODEC}-${ISA_SIMD} PRIVATE astc${CODEC}-${ISA_SIMD}-static)
 
+if(${ZSTD})
+    target_compile_definitions(astc${CODEC}-${ISA_SIMD}
+        PRIVATE
+            ASTCENC_ZSTD)
+
+    target_include_directories(astc${CODEC}-${ISA_SIMD} PRIVATE ${ZSTD_INCLUDE_DIR})
+    target_link_libraries(astc${CODEC}-${ISA_SIMD} PRIVATE ${ZSTD_LIBRARY})
+endif()
+
 macro(astc_set_properties NAME)
     target_compile_features(${NAME}
         PRIVATE
@@ -147,7 +181,8 @@ macro(astc_set_properties NAME)
                 ASTCENC_NEON=0
                 ASTCENC_SSE=0
                 ASTCENC_AVX=0
-                ASTCENC_POPCNT=0)
+                ASTCENC_POPCNT=0
+                ASTCENC_F16C=0)
 
     elseif(${ISA_SIMD} MATCHES "neon")
         target_compile_definitions(${NAME}
@@ -155,7 +190,8 @@ macro(astc_set_properties NAME)
                 ASTCENC_NEON=1
                 ASTCENC_SSE=0
                 ASTCENC_AVX=0
-                ASTCENC_POPCNT=0)
+                ASTCENC_POPCNT=0
+                ASTCENC_F16C=0)
 
     elseif(${ISA_SIMD} MATCHES "sse2")
         target_compile_definitions(${NAME}
@@ -163,7 +199,8 @@ macro(astc_set_properties NAME)
                 ASTCENC_NEON=0
                 ASTCENC_SSE=20
                 ASTCENC_AVX=0
-                ASTCENC_POPCNT=0)
+                ASTCENC_POPCNT=0
+                ASTCENC_F16C=0)
 
     elseif(${ISA_SIMD} MATCHES "sse4.1")
         target_compile_definitions(${NAME}
@@ -171,7 +208,8 @@ macro(astc_set_properties NAME)
                 ASTCENC_NEON=0
                 ASTCENC_SSE=41
                 ASTCENC_AVX=0
-                ASTCENC_POPCNT=1)
+                ASTCENC_POPCNT=1
+                ASTCENC_F16C=0)
 
         target_compile_options(${NAME}
             PRIVATE
@@ -183,12 +221,37 @@ macro(astc_set_properties NAME)
                 ASTCENC_NEON=0
                 ASTCENC_SSE=41
                 ASTCENC_AVX=2
-                ASTCENC_POPCNT=1)
+                ASTCENC_POPCNT=1
+                ASTCENC_F16C=1)
 
         target_compile_options(${NAME}
             PRIVATE
-                $<$<NOT:$<CXX_COMPILER_ID:MSVC>>:-mavx2 -mpopcnt>
+                $<$<NOT:$<CXX_COMPILER_ID:MSVC>>:-mavx2 -mpopcnt -mf16c>
                 $<$<CXX_COMPILER_ID:MSVC>:/arch:AVX2>)
+
+    elseif(${ISA_SIMD} MATCHES "dispatch")
+        target_compile_definitions(${NAME}
+            PRIVATE
+                ASTCENC_NEON=0
+                ASTCENC_SSE=20
+                ASTCENC_AVX=0
+                ASTCENC_POPCNT=0
+                ASTCENC_F16C=0
+                ASTCENC_ISA_DISPATCH)
+
+    elseif(${ISA_SIMD} MATCHES "avx512")
+        target_compile_definitions(${NAME}
+            PRIVATE
+                ASTCENC_NEON=0
+                ASTCENC_SSE=41
+                ASTCENC_AVX=512
+                ASTCENC_POPCNT=1
+                ASTCENC_F16C=1)
+
+        target_compile_options(${NAME}
+            PRIVATE
+                $<$<NOT:$<CXX_COMPILER_ID:MSVC>>:-mavx512f -mavx512bw -mavx512dq -mavx512vl -mpopcnt -mf16c>
+                $<$<CXX_COMPILER_ID:MSVC>:/arch:AVX512>)
     endif()
 endmacro()
 
@@ -214,4 +277,18 @@ endif()
 astc_set_properties(astc${CODEC}-${ISA_SIMD})
 astc_set_properties(astc${CODEC}-${ISA_SIMD}-static)
 
+if(${ISA_SIMD} MATCHES "dispatch")
+    foreach(DISPATCH_ISA ${ASTC_DISPATCH_ISAS})
+        set(ISA_SIMD ${DISPATCH_ISA})
+        astc_set_properties(astc${CODEC}-dispatch-${DISPATCH_ISA})
+
+        # Namespace names must be identifiers, so drop the "." in "sse4.1"
+        string(REPLACE "." "" DISPATCH_NAMESPACE "astcenc_${DISPATCH_ISA}")
+        target_compile_definitions(astc${CODEC}-dispatch-${DISPATCH_ISA}
+            PRIVATE
+                ASTCENC_DISPATCH_NAMESPACE=${DISPATCH_NAMESPACE})
+    endforeach()
+    set(ISA_SIMD dispatch)
+endif()
+
 install(TARGETS astc${CODEC}-${ISA_SIMD} DESTINATION ${PACKAGE_ROOT})
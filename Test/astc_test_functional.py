@@ -62,15 +62,18 @@ HDR images are an 8x8 image containing 4 4x4 constant color blocks. Assuming
 
 import argparse
 import filecmp
+import json
 import os
 import re
 import signal
 import string
+import struct
 import subprocess as sp
 import sys
 import tempfile
 import time
 import unittest
+import zlib
 
 import numpy
 from PIL import Image
@@ -108,6 +111,8 @@ ASTCENC_TEST_PATTERN_HDR = {
 
 LDR_RGB_PSNR_PATTERN = re.compile(r"\s*PSNR \(LDR-RGB\): (.*) dB")
 
+CACHE_HITS_PATTERN = re.compile(r"\s*Cache hits:\s*(\d+)")
+
 g_TestEncoder = "avx2"
 
 class CLITestBase(unittest.TestCase):
@@ -228,6 +233,23 @@ class CLITestBase(unittest.TestCase):
         os.remove(tmpPath)
         return tmpPath
 
+    def has_zstd(self):
+        """
+        Test if the encoder binary was built with zstd support.
+
+        Returns:
+            bool: ``True`` if the -zstd option is supported.
+        """
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("EXP", ".ktx2"),
+            "4x4", "-fast", "-zstd", "1"]
+
+        result = sp.run(command, stdout=sp.PIPE, stderr=sp.PIPE,
+                        universal_newlines=True)
+        return "requires a build with zstd support" not in result.stdout
+
 
 class CLIPTest(CLITestBase):
     """
@@ -1398,6 +1420,434 @@ class CLIPTest(CLITestBase):
         p2RMSE = sum(self.get_channel_rmse(inputFile, p2DecFile))
         self.assertEqual(p1RMSE, p2RMSE)
 
+    def test_compress_direct_io(self):
+        """
+        Test that direct I/O output matches buffered output.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [self.binary, "-cl", inputFile, p1CompFile, "6x6", "-fast"]
+        self.exec(command)
+
+        command = [
+            self.binary, "-cl", inputFile, p2CompFile, "6x6", "-fast",
+            "-direct-io"]
+        self.exec(command)
+
+        self.assertTrue(filecmp.cmp(p1CompFile, p2CompFile, False))
+
+    def test_warmstart_blockcache(self):
+        """
+        Test that the block cache does not change warm-start compression.
+        """
+        # This image has many repeated blocks
+        inputFile = "./Test/Images/Small/LDR-RGB/ldr-rgb-10.png"
+        hintFile = self.get_tmp_image_path("LDR", "comp")
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("LDR", "comp")
+
+        # Flip the hint so repeated blocks get different hint blocks
+        command = [
+            self.binary, "-cl", inputFile, hintFile, "6x6", "-medium",
+            "-yflip"]
+        self.exec(command)
+
+        command = [
+            self.binary, "-cl", inputFile, p1CompFile, "6x6", "-medium",
+            "-warmstart", hintFile]
+        self.exec(command)
+
+        command[3] = p2CompFile
+        command += ["-blockcache"]
+        self.exec(command)
+
+        self.assertTrue(filecmp.cmp(p1CompFile, p2CompFile, False))
+
+    def test_compress_blockcache(self):
+        """
+        Test that the block cache does not change compression.
+        """
+        # This image has many repeated blocks
+        inputFile = "./Test/Images/Small/LDR-RGB/ldr-rgb-10.png"
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [self.binary, "-cl", inputFile, p1CompFile, "6x6", "-medium"]
+        self.exec(command)
+
+        command = [
+            self.binary, "-cl", inputFile, p2CompFile, "6x6", "-medium",
+            "-blockcache", "-stats"]
+        hits = self.exec(command, CACHE_HITS_PATTERN)
+
+        self.assertGreater(int(hits), 0)
+        self.assertTrue(filecmp.cmp(p1CompFile, p2CompFile, False))
+
+    def test_compress_budget(self):
+        """
+        Test time budgeted compression.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [self.binary, "-cl", inputFile, p1CompFile, "6x6", "-medium"]
+        self.exec(command)
+
+        # A budget which is never reached should not change the output
+        command = [
+            self.binary, "-cl", inputFile, p2CompFile, "6x6", "-medium",
+            "-budget", "1000000"]
+        self.exec(command)
+
+        self.assertTrue(filecmp.cmp(p1CompFile, p2CompFile, False))
+
+        # A budget which is always exceeded should still compress the image
+        command[-1] = "1"
+        self.exec(command)
+
+        self.assertEqual(os.path.getsize(p1CompFile),
+                         os.path.getsize(p2CompFile))
+
+    def test_compress_stats(self):
+        """
+        Test compression statistics reporting.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [self.binary, "-cl", inputFile, p1CompFile, "6x6", "-fast"]
+        self.exec(command)
+
+        # Statistics are reported even in silent mode
+        command = [
+            self.binary, "-cl", inputFile, p2CompFile, "6x6", "-fast",
+            "-silent", "-stats"]
+        pattern = re.compile(r"\s*Blocks:\s*(\d+)")
+        blocks = self.exec(command, pattern)
+
+        # A 256x256 image has 43x43 6x6 blocks
+        self.assertEqual(int(blocks), 43 * 43)
+        self.assertTrue(filecmp.cmp(p1CompFile, p2CompFile, False))
+
+    def test_compress_rdo(self):
+        """
+        Test rate-distortion optimized compression.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [self.binary, "-cl", inputFile, p1CompFile, "6x6", "-medium"]
+        self.exec(command)
+
+        # A lambda of zero disables the optimization
+        command = [
+            self.binary, "-cl", inputFile, p2CompFile, "6x6", "-medium",
+            "-rdo", "0"]
+        self.exec(command)
+
+        self.assertTrue(filecmp.cmp(p1CompFile, p2CompFile, False))
+
+        # Output should get smaller after entropy coding if it is enabled
+        command[-1] = "2"
+        self.exec(command)
+
+        with open(p1CompFile, "rb") as fileHandle:
+            refSize = len(zlib.compress(fileHandle.read(), 9))
+
+        with open(p2CompFile, "rb") as fileHandle:
+            testSize = len(zlib.compress(fileHandle.read(), 9))
+
+        self.assertLess(testSize, refSize)
+
+    def test_compress_mipmap(self):
+        """
+        Test mipmap generation.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        p1CompFile = self.get_tmp_image_path("EXP", ".ktx")
+        p2CompFile = self.get_tmp_image_path("EXP", ".ktx")
+        p1DecFile = self.get_tmp_image_path("LDR", "decomp")
+        p2DecFile = self.get_tmp_image_path("LDR", "decomp")
+
+        command = [self.binary, "-cl", inputFile, p1CompFile, "6x6", "-fast"]
+        self.exec(command)
+
+        for mipArgs in (["-mipmap"], ["-mipmap-coverage", "0.5"]):
+            with self.subTest(args=mipArgs):
+                command = [
+                    self.binary, "-cl", inputFile, p2CompFile, "6x6",
+                    "-fast"] + mipArgs
+                self.exec(command)
+
+                # A 256x256 image has 9 levels, stored in the KTX header
+                with open(p2CompFile, "rb") as fileHandle:
+                    header = fileHandle.read(64)
+                levels = struct.unpack("<I", header[56:60])[0]
+                self.assertEqual(levels, 9)
+
+                # Level 0 should be the same as a compression without mipmaps
+                command = [self.binary, "-dl", p1CompFile, p1DecFile]
+                self.exec(command)
+                command = [self.binary, "-dl", p2CompFile, p2DecFile]
+                self.exec(command)
+                self.assertTrue(filecmp.cmp(p1DecFile, p2DecFile, False))
+
+    def test_batch(self):
+        """
+        Test that batch compression matches single image compression.
+        """
+        inputFiles = [
+            "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png",
+            "./Test/Images/Small/LDR-RGB/ldr-rgb-00.png",
+            "./Test/Images/Small/LDR-RGBA/ldr-rgba-01.png"]
+
+        manifestFile = self.get_tmp_image_path("EXP", ".txt")
+        with open(manifestFile, "w") as fileHandle:
+            fileHandle.write("# Test manifest\n\n")
+            for i, inputFile in enumerate(inputFiles):
+                blockSize = "4x4" if i == 1 else "6x6"
+                compFile = os.path.join(self.tempDir.name, "batch%u.astc" % i)
+                fileHandle.write("-cl %s %s %s -fast\n" %
+                                 (inputFile, compFile, blockSize))
+
+        command = [self.binary, "-batch", manifestFile, "-silent"]
+        self.exec(command)
+
+        for i, inputFile in enumerate(inputFiles):
+            with self.subTest(image=inputFile):
+                blockSize = "4x4" if i == 1 else "6x6"
+                refFile = self.get_tmp_image_path("LDR", "comp")
+                command = [
+                    self.binary, "-cl", inputFile, refFile, blockSize,
+                    "-fast"]
+                self.exec(command)
+
+                compFile = os.path.join(self.tempDir.name, "batch%u.astc" % i)
+                self.assertTrue(filecmp.cmp(refFile, compFile, False))
+
+    def test_compress_ktx2(self):
+        """
+        Test KTX2 compressed output and input.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("EXP", ".ktx2")
+        p1DecFile = self.get_tmp_image_path("LDR", "decomp")
+        p2DecFile = self.get_tmp_image_path("LDR", "decomp")
+
+        command = [self.binary, "-cl", inputFile, p1CompFile, "6x6", "-fast"]
+        self.exec(command)
+        command = [self.binary, "-dl", p1CompFile, p1DecFile]
+        self.exec(command)
+
+        for mipArgs in ([], ["-mipmap"]):
+            with self.subTest(args=mipArgs):
+                command = [
+                    self.binary, "-cl", inputFile, p2CompFile, "6x6",
+                    "-fast"] + mipArgs
+                self.exec(command)
+
+                # A 256x256 image has 9 levels, stored in the KTX2 header
+                with open(p2CompFile, "rb") as fileHandle:
+                    header = fileHandle.read(48)
+                levels = struct.unpack("<I", header[40:44])[0]
+                self.assertEqual(levels, 9 if mipArgs else 1)
+
+                command = [self.binary, "-dl", p2CompFile, p2DecFile]
+                self.exec(command)
+                self.assertTrue(filecmp.cmp(p1DecFile, p2DecFile, False))
+
+    def test_compress_zstd(self):
+        """
+        Test KTX2 compressed output with zstd supercompression.
+        """
+        if not self.has_zstd():
+            self.skipTest("Encoder built without zstd support")
+
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        p1CompFile = self.get_tmp_image_path("EXP", ".ktx2")
+        p2CompFile = self.get_tmp_image_path("EXP", ".ktx2")
+        p1DecFile = self.get_tmp_image_path("LDR", "decomp")
+        p2DecFile = self.get_tmp_image_path("LDR", "decomp")
+
+        command = [
+            self.binary, "-cl", inputFile, p1CompFile, "6x6", "-fast",
+            "-mipmap"]
+        self.exec(command)
+
+        command += ["-zstd", "3"]
+        command[3] = p2CompFile
+        self.exec(command)
+
+        # The KTX2 header should use zstd supercompression
+        with open(p2CompFile, "rb") as fileHandle:
+            header = fileHandle.read(48)
+        scheme = struct.unpack("<I", header[44:48])[0]
+        self.assertEqual(scheme, 2)
+        self.assertLess(os.path.getsize(p2CompFile),
+                        os.path.getsize(p1CompFile))
+
+        # Decompressed images should be the same
+        command = [self.binary, "-dl", p1CompFile, p1DecFile]
+        self.exec(command)
+        command = [self.binary, "-dl", p2CompFile, p2DecFile]
+        self.exec(command)
+        self.assertTrue(filecmp.cmp(p1DecFile, p2DecFile, False))
+
+    def test_bench(self):
+        """
+        Test benchmark mode.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("LDR", "comp")
+        decompFile = self.get_tmp_image_path("LDR", "decomp")
+        jsonFile = self.get_tmp_image_path("EXP", ".json")
+
+        command = [self.binary, "-cl", inputFile, p1CompFile, "6x6", "-fast"]
+        self.exec(command)
+
+        # Benchmarking should not change the output
+        command = [
+            self.binary, "-cl", inputFile, p2CompFile, "6x6", "-fast",
+            "-bench", "3", "-bench-json", jsonFile]
+        pattern = re.compile(r"\s*Iterations:\s*(\d+)")
+        iterations = self.exec(command, pattern)
+
+        self.assertEqual(int(iterations), 3)
+        self.assertTrue(filecmp.cmp(p1CompFile, p2CompFile, False))
+
+        with open(jsonFile, "r") as fileHandle:
+            results = json.load(fileHandle)
+        self.assertEqual(results["iterations"], 3)
+        self.assertIn("compression", results["phases"])
+        self.assertNotIn("decompression", results["phases"])
+
+        # Test mode benchmarks both compression and decompression
+        command = [
+            self.binary, "-tl", inputFile, decompFile, "6x6", "-fast",
+            "-bench", "2", "-bench-json", jsonFile]
+        self.exec(command)
+
+        with open(jsonFile, "r") as fileHandle:
+            results = json.load(fileHandle)
+        self.assertIn("compression", results["phases"])
+        self.assertIn("decompression", results["phases"])
+
+    def test_compress_incremental(self):
+        """
+        Test incremental recompression.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        prevFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-01.png"
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("LDR", "comp")
+        p3CompFile = self.get_tmp_image_path("LDR", "comp")
+        pattern = re.compile(r"\s*Unchanged blocks:\s*(\d+)")
+
+        command = [self.binary, "-cl", inputFile, p1CompFile, "6x6", "-medium"]
+        self.exec(command)
+
+        # An unchanged image should reuse every block of the previous output
+        command = [
+            self.binary, "-cl", inputFile, p2CompFile, "6x6", "-medium",
+            "-incremental", inputFile, p1CompFile, "-stats"]
+        unchanged = self.exec(command, pattern)
+
+        self.assertEqual(int(unchanged), 43 * 43)
+        self.assertTrue(filecmp.cmp(p1CompFile, p2CompFile, False))
+
+        # A different image should compress every block as normal
+        command = [
+            self.binary, "-cl", prevFile, p2CompFile, "6x6", "-medium"]
+        self.exec(command)
+
+        command = [
+            self.binary, "-cl", inputFile, p3CompFile, "6x6", "-medium",
+            "-incremental", prevFile, p2CompFile, "-stats"]
+        unchanged = self.exec(command, pattern)
+
+        self.assertEqual(int(unchanged), 0)
+        self.assertTrue(filecmp.cmp(p1CompFile, p3CompFile, False))
+
+    def test_compress_adaptive(self):
+        """
+        Test adaptive effort compression.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        decompFile = self.get_tmp_image_path("LDR", "decomp")
+        retryPattern = re.compile(r"\s*Adaptive effort retries:\s*(\d+)")
+
+        # Use a lowered dB limit, which most blocks meet with the fast search
+        command = [
+            self.binary, "-tl", inputFile, decompFile, "6x6", "-medium",
+            "-dblimit", "25"]
+        refPSNR = float(self.exec(command, LDR_RGB_PSNR_PATTERN))
+
+        command += ["-adaptive", "-stats"]
+        stdout = self.exec(command)
+        testPSNR = float(LDR_RGB_PSNR_PATTERN.search(stdout).group(1))
+        retries = int(retryPattern.search(stdout).group(1))
+
+        # Only some blocks should be retried with the full search limits
+        self.assertGreater(retries, 0)
+        self.assertLess(retries, 43 * 43)
+
+        # Quality should be similar, as every block has the same target
+        self.assertGreater(testPSNR, refPSNR - 0.5)
+
+    def test_compress_affinity(self):
+        """
+        Test that thread affinity does not change compression.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        p1CompFile = self.get_tmp_image_path("LDR", "comp")
+        p2CompFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [
+            self.binary, "-cl", inputFile, p1CompFile, "6x6", "-medium",
+            "-j", "2"]
+        self.exec(command)
+
+        command = [
+            self.binary, "-cl", inputFile, p2CompFile, "6x6", "-medium",
+            "-j", "2", "-affinity"]
+        self.exec(command)
+
+        self.assertTrue(filecmp.cmp(p1CompFile, p2CompFile, False))
+
+    def test_compress_warmstart(self):
+        """
+        Test warm-start compression.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        hintFile = self.get_tmp_image_path("LDR", "comp")
+        decompFile = self.get_tmp_image_path("LDR", "decomp")
+        hintPattern = re.compile(r"\s*Exit warm-start hint:\s*(\d+)")
+
+        command = [self.binary, "-cl", inputFile, hintFile, "6x6", "-medium"]
+        self.exec(command)
+
+        command = [
+            self.binary, "-tl", inputFile, decompFile, "6x6", "-medium"]
+        refPSNR = float(self.exec(command, LDR_RGB_PSNR_PATTERN))
+
+        command += ["-warmstart", hintFile, "-stats"]
+        stdout = self.exec(command)
+        testPSNR = float(LDR_RGB_PSNR_PATTERN.search(stdout).group(1))
+        hintExits = int(hintPattern.search(stdout).group(1))
+
+        # Blocks should reuse the hint configuration for the same image
+        self.assertGreater(hintExits, 0)
+
+        # Quality should be similar, as every block has the same target
+        self.assertGreater(testPSNR, refPSNR - 0.5)
+
 
 class CLINTest(CLITestBase):
     """
@@ -1627,6 +2077,27 @@ class CLINTest(CLITestBase):
 
         self.exec(command)
 
+    def test_cl_failed_store(self):
+        """
+        Test -cl with an output file that cannot be stored.
+        """
+        # A directory cannot be replaced by the compressed image
+        outDir = os.path.join(self.tempDir.name, "test.astc")
+        os.mkdir(outDir)
+
+        for extraArgs in ([], ["-direct-io"]):
+            with self.subTest(args=extraArgs):
+                command = [
+                    self.binary, "-cl",
+                    self.get_ref_image_path("LDR", "input", "A"),
+                    outDir, "4x4", "-fast"] + extraArgs
+
+                self.exec(command)
+
+                # Check that no partially written file is left behind
+                self.assertTrue(os.path.isdir(outDir))
+                self.assertEqual(os.listdir(self.tempDir.name), ["test.astc"])
+
     def test_cl_2d_block_with_array(self):
         """
         Test -cl with a 2D block size and 3D input data.
@@ -2065,6 +2536,366 @@ class CLINTest(CLITestBase):
         # Run the command, incrementally omitting arguments
         self.exec_with_omit(command, 7)
 
+    def test_cl_budget_missing_args(self):
+        """
+        Test -cl with -budget and missing arguments.
+        """
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast",
+            "-budget", "1000"]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 7)
+
+    def test_cl_rdo_missing_args(self):
+        """
+        Test -cl with -rdo and missing arguments.
+        """
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast",
+            "-rdo", "0.5"]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 7)
+
+    def test_cl_mipmap_coverage_missing_args(self):
+        """
+        Test -cl with -mipmap-coverage and missing arguments.
+        """
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("EXP", ".ktx"),
+            "4x4", "-fast",
+            "-mipmap-coverage", "0.5"]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 7)
+
+    def test_cl_mipmap_bad_args(self):
+        """
+        Test -cl with invalid -mipmap and -mipmap-coverage usage.
+        """
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("EXP", ".ktx"),
+            "4x4", "-fast",
+            "-mipmap-coverage", "0.5"]
+
+        # Test that the underlying command is valid
+        self.exec(command, True)
+
+        for badCutoff in ("0", "1", "-0.5", "1.5"):
+            with self.subTest(cutoff=badCutoff):
+                command[-1] = badCutoff
+                self.exec(command)
+
+        # Mipmaps cannot be stored in a .astc file
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast", "-mipmap"]
+        self.exec(command)
+
+    def test_batch_missing_args(self):
+        """
+        Test -batch with missing arguments.
+        """
+        manifestFile = self.get_tmp_image_path("EXP", ".txt")
+        with open(manifestFile, "w") as fileHandle:
+            fileHandle.write("-cl %s %s 4x4 -fast\n" % (
+                self.get_ref_image_path("LDR", "input", "A"),
+                self.get_tmp_image_path("LDR", "comp")))
+
+        # Build a valid command
+        command = [self.binary, "-batch", manifestFile]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 2)
+
+    def test_batch_bad_manifest(self):
+        """
+        Test -batch with invalid manifest lines.
+        """
+        inputFile = self.get_ref_image_path("LDR", "input", "A")
+        compFile = self.get_tmp_image_path("LDR", "comp")
+        manifestFile = self.get_tmp_image_path("EXP", ".txt")
+
+        badLines = [
+            "-cl %s %s 4x4" % (inputFile, compFile),            # Too short
+            "-dl %s %s 4x4 -fast" % (compFile, inputFile),      # Not compress
+            "-cl %s %s 4x5 -fast" % (inputFile, compFile),      # Bad block
+            "-cl %s %s 4x4 -fast -foo" % (inputFile, compFile)  # Bad option
+        ]
+
+        for badLine in badLines:
+            with self.subTest(line=badLine):
+                with open(manifestFile, "w") as fileHandle:
+                    fileHandle.write(badLine + "\n")
+
+                command = [self.binary, "-batch", manifestFile]
+                self.exec(command)
+
+        # Unknown batch options are rejected
+        command = [self.binary, "-batch", manifestFile, "-foo"]
+        self.exec(command)
+
+    def test_cl_zstd_missing_args(self):
+        """
+        Test -cl with -zstd and missing arguments.
+        """
+        if not self.has_zstd():
+            self.skipTest("Encoder built without zstd support")
+
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("EXP", ".ktx2"),
+            "4x4", "-fast",
+            "-zstd", "3"]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 7)
+
+    def test_cl_zstd_bad_args(self):
+        """
+        Test -cl with invalid -zstd usage.
+        """
+        if not self.has_zstd():
+            self.skipTest("Encoder built without zstd support")
+
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("EXP", ".ktx2"),
+            "4x4", "-fast",
+            "-zstd", "3"]
+
+        # Test that the underlying command is valid
+        self.exec(command, True)
+
+        for badLevel in ("0", "23"):
+            with self.subTest(level=badLevel):
+                command[-1] = badLevel
+                self.exec(command)
+
+        # Supercompression is only supported for KTX2 files
+        command[-1] = "3"
+        for badExt in (".astc", ".ktx"):
+            with self.subTest(ext=badExt):
+                command[3] = self.get_tmp_image_path("EXP", badExt)
+                self.exec(command)
+
+    def test_cl_bench_missing_args(self):
+        """
+        Test -cl with -bench and missing arguments.
+        """
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast",
+            "-bench", "2"]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 7)
+
+    def test_cl_benchjson_missing_args(self):
+        """
+        Test -cl with -bench-json and missing arguments.
+        """
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast",
+            "-bench", "2",
+            "-bench-json", self.get_tmp_image_path("EXP", ".json")]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 9)
+
+    def test_cl_bench_bad_args(self):
+        """
+        Test -cl with invalid -bench and -bench-json usage.
+        """
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast",
+            "-bench", "2"]
+
+        # Test that the underlying command is valid
+        self.exec(command, True)
+
+        command[-1] = "0"
+        self.exec(command)
+
+        # JSON results require benchmark mode
+        command = command[:-2] + [
+            "-bench-json", self.get_tmp_image_path("EXP", ".json")]
+        self.exec(command)
+
+    def test_cl_incremental_missing_args(self):
+        """
+        Test -cl with -incremental and missing arguments.
+        """
+        inputFile = self.get_ref_image_path("LDR", "input", "A")
+        prevCompFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [self.binary, "-cl", inputFile, prevCompFile, "4x4", "-fast"]
+        self.exec(command, True)
+
+        # Build a valid command
+        command = [
+            self.binary, "-cl", inputFile,
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast",
+            "-incremental", inputFile, prevCompFile]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 7)
+
+    def test_cl_incremental_bad_args(self):
+        """
+        Test -cl with invalid -incremental usage.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        prevCompFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [self.binary, "-cl", inputFile, prevCompFile, "6x6", "-fast"]
+        self.exec(command, True)
+
+        # Build a valid command
+        command = [
+            self.binary, "-cl", inputFile,
+            self.get_tmp_image_path("LDR", "comp"),
+            "6x6", "-fast",
+            "-incremental", inputFile, prevCompFile]
+
+        # Test that the underlying command is valid
+        self.exec(command, True)
+
+        # The previous image must have the same size as the input
+        badCommand = list(command)
+        badCommand[-2] = "./Test/Images/Small/LDR-RGB/ldr-rgb-10.png"
+        self.exec(badCommand)
+
+        # The previous output must have the same block size
+        badCommand = list(command)
+        badCommand[4] = "4x4"
+        self.exec(badCommand)
+
+        # Mipmaps are not supported
+        badCommand = list(command)
+        badCommand[3] = self.get_tmp_image_path("EXP", ".ktx")
+        badCommand += ["-mipmap"]
+        self.exec(badCommand)
+
+    def test_batch_affinity(self):
+        """
+        Test -batch with -affinity, which is not supported.
+        """
+        manifestFile = self.get_tmp_image_path("EXP", ".txt")
+        line = "-cl %s %s 4x4 -fast" % (
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("LDR", "comp"))
+
+        # Test that the underlying command is valid
+        with open(manifestFile, "w") as fileHandle:
+            fileHandle.write(line + "\n")
+
+        command = [self.binary, "-batch", manifestFile]
+        self.exec(command, True)
+
+        with open(manifestFile, "w") as fileHandle:
+            fileHandle.write(line + " -affinity\n")
+
+        self.exec(command)
+
+    def test_cl_warmstart_missing_args(self):
+        """
+        Test -cl with -warmstart and missing arguments.
+        """
+        inputFile = self.get_ref_image_path("LDR", "input", "A")
+        hintFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [self.binary, "-cl", inputFile, hintFile, "4x4", "-fast"]
+        self.exec(command, True)
+
+        # Build a valid command
+        command = [
+            self.binary, "-cl", inputFile,
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast",
+            "-warmstart", hintFile]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 7)
+
+    def test_cl_warmstart_bad_args(self):
+        """
+        Test -cl with invalid -warmstart usage.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        hintFile = self.get_tmp_image_path("LDR", "comp")
+
+        command = [self.binary, "-cl", inputFile, hintFile, "6x6", "-fast"]
+        self.exec(command, True)
+
+        # Build a valid command
+        command = [
+            self.binary, "-cl", inputFile,
+            self.get_tmp_image_path("LDR", "comp"),
+            "6x6", "-fast",
+            "-warmstart", hintFile]
+
+        # Test that the underlying command is valid
+        self.exec(command, True)
+
+        # The hint must have the same size and block size as the output
+        badCommand = list(command)
+        badCommand[2] = "./Test/Images/Small/LDR-RGB/ldr-rgb-10.png"
+        self.exec(badCommand)
+
+        badCommand = list(command)
+        badCommand[4] = "4x4"
+        self.exec(badCommand)
+
+        # Mipmaps and incremental compression are not supported
+        badCommand = list(command)
+        badCommand[3] = self.get_tmp_image_path("EXP", ".ktx")
+        badCommand += ["-mipmap"]
+        self.exec(badCommand)
+
+        badCommand = command + ["-incremental", inputFile, hintFile]
+        self.exec(badCommand)
+
+        # Batch mode is not supported
+        manifestFile = self.get_tmp_image_path("EXP", ".txt")
+        with open(manifestFile, "w") as fileHandle:
+            fileHandle.write(" ".join(command[1:]) + "\n")
+
+        self.exec([self.binary, "-batch", manifestFile])
+
 
 def main():
     """
@@ -2077,7 +2908,7 @@ def main():
 
     parser = argparse.ArgumentParser()
 
-    coders = ["none", "neon", "sse2", "sse4.1", "avx2"]
+    coders = ["none", "neon", "sse2", "sse4.1", "avx2", "avx512"]
     parser.add_argument("--encoder", dest="encoder", default="avx2",
                         choices=coders, help="test encoder variant")
     args = parser.parse_known_args()
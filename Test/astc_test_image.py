@@ -348,9 +348,9 @@ def parse_command_line():
                  "ref-master-neon", "ref-master-sse2", "ref-master-sse4.1", "ref-master-avx2"]
 
     # All test encoders
-    testcoders = ["none", "neon", "sse2", "sse4.1", "avx2"]
+    testcoders = ["none", "neon", "sse2", "sse4.1", "avx2", "avx512"]
     testcodersAArch64 = ["none", "neon"]
-    testcodersX86 = ["none", "sse2", "sse4.1", "avx2"]
+    testcodersX86 = ["none", "sse2", "sse4.1", "avx2", "avx512"]
 
     coders = refcoders + testcoders + ["all-aarch64", "all-x86"]
 
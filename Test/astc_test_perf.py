@@ -0,0 +1,309 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# -----------------------------------------------------------------------------
+# Copyright 2021 Arm Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy
+# of the License at:
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations
+# under the License.
+# -----------------------------------------------------------------------------
+"""
+The performance test runner is used for detecting performance regressions.
+
+It uses the same test sets as the image test runner, but compresses each image
+many times with the compressor threads pinned to CPU cores, and keeps the
+coding rate of every run. The mean coding rate of each test is compared
+against a stored baseline for the same encoder ISA using Welch's t-test, and
+tests which are significantly slower than the baseline are flagged as a
+failure.
+
+Attributes:
+    DEFAULT_SAMPLES: The default number of timed runs for each test.
+    DEFAULT_THRESHOLD: The default minimum relative change that is reported.
+"""
+
+import argparse
+import datetime
+import os
+import sys
+
+import astc_test_image as ati
+import testlib.encoder as te
+import testlib.perfset as tps
+import testlib.testset as tts
+
+
+DEFAULT_SAMPLES = 10
+
+DEFAULT_THRESHOLD = 0.02
+
+
+def format_result(record):
+    """
+    Format a metrics string for a performance record.
+
+    Args:
+        record (PerfRecord): The performance record.
+
+    Returns:
+        str: The metrics string.
+    """
+    name = "%5s %s" % (record.blkSz, record.name)
+    ciLow, ciHigh = record.get_interval()
+    tCMTS = "%.3f MT/s" % record.mean
+    tCI = "[%.3f, %.3f]" % (ciLow, ciHigh)
+
+    if record.change == tps.Change.NOTRUN:
+        return "%-32s | %11s | %20s" % (name, tCMTS, tCI)
+
+    tRel = "%1.3fx" % record.relRate
+    return "%-32s | %11s | %20s | %6s | %s" % \
+        (name, tCMTS, tCI, tRel, record.change.name)
+
+
+def run_perf_set(encoder, baseline, testSet, quality, blockSizes, args):
+    """
+    Execute all performance tests in the test set.
+
+    Args:
+        encoder (EncoderBase): The encoder to use.
+        baseline (PerfSet): The baseline results, or ``None``.
+        testSet (TestSet): The test set.
+        quality (str): The quality level to execute the test against.
+        blockSizes (list(str)): The block sizes to execute each test against.
+        args (Namespace): The parsed command line.
+
+    Returns:
+        PerfSet: The test results.
+    """
+    perfSet = tps.PerfSet(testSet.name)
+
+    curCount = 0
+    maxCount = ati.count_test_set(testSet, blockSizes)
+
+    dat = (testSet.name, encoder.name, quality)
+    title = "Perf Set: %s / Encoder: %s -%s" % dat
+    print(title)
+    print("=" * len(title))
+
+    extraArgs = []
+    if not args.noAffinity:
+        extraArgs.append("-affinity")
+
+    if args.threads:
+        extraArgs += ["-j", str(args.threads)]
+
+    for blkSz in blockSizes:
+        for image in testSet.tests:
+            # 3D block sizes require 3D images
+            if ati.is_3d(blkSz) != image.is3D:
+                continue
+
+            curCount += 1
+
+            dat = (curCount, maxCount, blkSz, image.testFile)
+            print("Running %u/%u %s %s ... " % dat, end='', flush=True)
+
+            # Discard the warm-up runs, which load the image into the cache
+            runs = args.warmups + args.samples
+            res = encoder.run_test_samples(image, blkSz, "-%s" % quality,
+                                           runs, False, extraArgs)
+            samples = [x[3] for x in res[args.warmups:]]
+
+            record = tps.PerfRecord(blkSz, image.testFile, samples)
+            perfSet.add_record(record)
+
+            if baseline:
+                try:
+                    ref = baseline.get_matching_record(record)
+                    record.compare(ref, args.threshold)
+                except KeyError:
+                    pass
+
+            print("\r[%3u] %s" % (curCount, format_result(record)))
+
+    return perfSet
+
+
+def parse_command_line():
+    """
+    Parse the command line.
+
+    Returns:
+        Namespace: The parsed command line container.
+    """
+    parser = argparse.ArgumentParser()
+
+    testcoders = ["none", "neon", "sse2", "sse4.1", "avx2", "avx512"]
+    parser.add_argument("--encoder", dest="encoders", default="avx2",
+                        choices=testcoders + ["all-aarch64", "all-x86"],
+                        help="test encoder variant")
+
+    astcProfile = ["ldr", "ldrs", "hdr", "all"]
+    parser.add_argument("--color-profile", dest="profiles", default="all",
+                        choices=astcProfile, help="test color profile")
+
+    imgFormat = ["l", "xy", "rgb", "rgba", "all"]
+    parser.add_argument("--color-format", dest="formats", default="all",
+                        choices=imgFormat, help="test color format")
+
+    choices = list(ati.TEST_BLOCK_SIZES) + ["all"]
+    parser.add_argument("--block-size", dest="blockSizes",
+                        action="append", choices=choices,
+                        help="test block size")
+
+    testDir = os.path.dirname(__file__)
+    testDir = os.path.join(testDir, "Images")
+    testSets = []
+    for path in os.listdir(testDir):
+        fqPath = os.path.join(testDir, path)
+        if os.path.isdir(fqPath):
+            testSets.append(path)
+    testSets.append("all")
+
+    parser.add_argument("--test-set", dest="testSets", default="Small",
+                        choices=testSets, help="test image test set")
+
+    parser.add_argument("--test-image", dest="testImage", default=None,
+                        help="select a specific test image from the test set")
+
+    choices = list(ati.TEST_QUALITIES) + ["all"]
+    parser.add_argument("--test-quality", dest="testQual", default="medium",
+                        choices=choices, help="select a specific test quality")
+
+    parser.add_argument("--samples", dest="samples", default=DEFAULT_SAMPLES,
+                        type=int, help="timed run count for each test")
+
+    parser.add_argument("--warmups", dest="warmups", default=1,
+                        type=int, help="untimed run count for each test")
+
+    parser.add_argument("--threads", dest="threads", default=None,
+                        type=int, help="compressor thread count")
+
+    parser.add_argument("--no-affinity", dest="noAffinity", default=False,
+                        action="store_true",
+                        help="do not pin compressor threads to CPU cores")
+
+    parser.add_argument("--threshold", dest="threshold",
+                        default=DEFAULT_THRESHOLD, type=float,
+                        help="minimum relative change to report")
+
+    parser.add_argument("--baseline-dir", dest="baselineDir",
+                        default="TestOutput",
+                        help="directory storing the baseline results")
+
+    parser.add_argument("--update-baseline", dest="updateBaseline",
+                        default=False, action="store_true",
+                        help="store the results as the new baseline")
+
+    parser.add_argument("--label", dest="label", default=None,
+                        help="label for the results in the trend history")
+
+    args = parser.parse_args()
+
+    if args.samples < 2:
+        parser.error("--samples must be at least 2")
+
+    if args.warmups < 0:
+        parser.error("--warmups must not be negative")
+
+    # Turn things into canonical format lists
+    if args.encoders == "all-aarch64":
+        args.encoders = ["none", "neon"]
+    elif args.encoders == "all-x86":
+        args.encoders = ["none", "sse2", "sse4.1", "avx2", "avx512"]
+    else:
+        args.encoders = [args.encoders]
+
+    args.testQual = ati.TEST_QUALITIES if args.testQual == "all" \
+        else [args.testQual]
+
+    if not args.blockSizes or ("all" in args.blockSizes):
+        args.blockSizes = ati.TEST_BLOCK_SIZES
+
+    args.testSets = testSets[:-1] if args.testSets == "all" \
+        else [args.testSets]
+
+    args.profiles = astcProfile[:-1] if args.profiles == "all" \
+        else [args.profiles]
+
+    args.formats = imgFormat[:-1] if args.formats == "all" \
+        else [args.formats]
+
+    if not args.label:
+        args.label = datetime.datetime.now().strftime("%Y-%m-%d %H:%M")
+
+    return args
+
+
+def main():
+    """
+    The main function.
+
+    Returns:
+        int: The process return code.
+    """
+    # Parse command lines
+    args = parse_command_line()
+
+    slowerCount = 0
+
+    for quality in args.testQual:
+        for imageSet in args.testSets:
+            for encoderName in args.encoders:
+                encoder = te.Encoder2x(encoderName)
+
+                testDir = "Test/Images/%s" % imageSet
+                outDir = "TestOutput/%s" % imageSet
+                baseDir = os.path.join(args.baselineDir, imageSet)
+
+                dat = (encoderName, quality)
+                baseName = "astc_perf_%s_%s_baseline.csv" % dat
+                baseName = os.path.join(baseDir, baseName)
+                testRes = "%s/astc_perf_%s_%s_results.csv" % ((outDir,) + dat)
+                testHist = "%s/astc_perf_%s_%s_history.csv" % ((outDir,) + dat)
+
+                baseline = None
+                if os.path.exists(baseName):
+                    baseline = tps.PerfSet(imageSet)
+                    baseline.load_from_file(baseName)
+                else:
+                    print("No baseline found: %s" % baseName)
+
+                testSet = tts.TestSet(imageSet, testDir,
+                                      args.profiles, args.formats, args.testImage)
+
+                perfSet = run_perf_set(encoder, baseline, testSet, quality,
+                                       args.blockSizes, args)
+
+                perfSet.save_to_file(testRes)
+                perfSet.append_to_history(testHist, args.label)
+
+                if args.updateBaseline:
+                    perfSet.save_to_file(baseName)
+
+                if baseline:
+                    counts = perfSet.get_change_counts()
+                    slowerCount += counts[tps.Change.SLOWER]
+
+                    dat = (counts[tps.Change.SAME], counts[tps.Change.FASTER],
+                           counts[tps.Change.SLOWER])
+                    print("Same: %u, Faster: %u, Slower: %u\n" % dat)
+
+    if slowerCount:
+        print("OVERALL STATUS: FAIL (%u slower)" % slowerCount)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
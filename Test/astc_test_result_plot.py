@@ -18,8 +18,13 @@
 """
 The ``astc_test_result_plot.py`` script consolidates all current sets of
 reference results into a single graphical plot.
+
+If a performance history file written by ``astc_test_perf.py`` is specified,
+the script instead plots the trend of the coding rate of each test over the
+runs stored in the history.
 """
 
+import argparse
 import re
 import os
 import sys
@@ -27,6 +32,7 @@ import sys
 import numpy as np
 import matplotlib.pyplot as plt
 
+import testlib.perfset as tps
 import testlib.resultset as trs
 from collections import defaultdict as ddict
 
@@ -241,6 +247,77 @@ def plot(results, chartRows, chartCols, blockSizes,
     fig.savefig(fileName)
 
 
+def plot_perf_trend(history, fileName):
+    """
+    Plot the coding rate trend of a performance history.
+
+    One chart is plotted for each block size, with one series for each test
+    image showing the mean coding rate and its 95% confidence interval for
+    each run in the history.
+
+    Args:
+        history (list(tuple)): The history records, from ``load_history()``.
+        fileName (str): The output image file name.
+    """
+    labels = []
+    blockSizes = []
+    for record in history:
+        if record[0] not in labels:
+            labels.append(record[0])
+        if record[1] not in blockSizes:
+            blockSizes.append(record[1])
+
+    fig, axs = plt.subplots(nrows=len(blockSizes), ncols=1, sharex=True,
+                            figsize=(15, 4 * len(blockSizes)), squeeze=False)
+
+    for i, blkSz in enumerate(blockSizes):
+        ax = axs[i][0]
+        ax.set_title("%s blocks" % blkSz, y=0.97, backgroundcolor="white")
+        ax.set_ylabel("Coding performance (MTex/s)")
+
+        series = ddict(list)
+        for label, rBlkSz, name, mean, ciLow, ciHigh in history:
+            if rBlkSz == blkSz:
+                series[name].append((labels.index(label), mean, ciLow, ciHigh))
+
+        for name, points in sorted(series.items()):
+            x = [p[0] for p in points]
+            y = [p[1] for p in points]
+            err = [[p[1] - p[2] for p in points],
+                   [p[3] - p[1] for p in points]]
+            ax.errorbar(x, y, yerr=err, capsize=3, marker=".", label=name)
+
+        ax.set_ylim(bottom=0)
+        ax.grid(ls=':')
+        ax.legend(loc="lower left", fontsize="small")
+
+    ax = axs[-1][0]
+    ax.set_xticks(range(len(labels)))
+    ax.set_xticklabels(labels, rotation=45, ha="right")
+
+    fig.tight_layout()
+    fig.savefig(fileName)
+
+
+def parse_command_line():
+    """
+    Parse the command line.
+
+    Returns:
+        Namespace: The parsed command line container.
+    """
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument("--perf-history", dest="perfHistory", default=None,
+                        help="plot the trend of a performance history CSV")
+
+    parser.add_argument("--perf-output", dest="perfOutput",
+                        default="perf-trend.png",
+                        help="the output file for the performance trend")
+
+    return parser.parse_args()
+
+
 def main():
     """
     The main function.
@@ -248,6 +325,17 @@ def main():
     Returns:
         int: The process return code.
     """
+    args = parse_command_line()
+
+    if args.perfHistory:
+        history = tps.load_history(args.perfHistory)
+        if not history:
+            print("ERROR: No records in %s" % args.perfHistory)
+            return 1
+
+        print("Generating %s" % args.perfOutput)
+        plot_perf_trend(history, args.perfOutput)
+        return 0
 
     absoluteXLimit = 35
 
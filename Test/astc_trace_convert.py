@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# -----------------------------------------------------------------------------
+# Copyright 2021 Arm Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy
+# of the License at:
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations
+# under the License.
+# -----------------------------------------------------------------------------
+"""
+The ``astc_trace_convert`` utility converts the binary trace file written by a
+diagnostic build of the codec into the JSON tree used by the
+``astc_trace_analysis`` utility.
+
+The trace contains a separate event stream for each compressor thread. The
+nodes of each stream are added to the root node in thread order, so blocks
+are not stored in image order if more than one thread was used.
+
+WARNING: Trace files are an engineering tool, and not part of the standard
+product, so traces and their associated tools are volatile and may change
+significantly without notice.
+"""
+
+import argparse
+from collections import OrderedDict
+import json
+import struct
+import sys
+
+TRACE_MAGIC = b"ASTCTRC\0"
+TRACE_VERSION = 1
+
+EVENT_NODE_BEGIN = 1
+EVENT_NODE_END = 2
+EVENT_KEY = 3
+EVENT_INT = 4
+EVENT_UINT = 5
+EVENT_FLOAT = 6
+EVENT_STR = 7
+
+
+def read_streams(data):
+    """
+    Split a binary trace into the event stream of each thread.
+
+    Args:
+        data (bytes): The trace file data.
+
+    Returns:
+        OrderedDict(int, bytes): The event stream of each thread.
+    """
+    if data[0:8] != TRACE_MAGIC:
+        raise ValueError("Not an astcenc binary trace file")
+
+    version, = struct.unpack_from("<I", data, 8)
+    if version != TRACE_VERSION:
+        raise ValueError("Unsupported trace version %u" % version)
+
+    chunks = OrderedDict()
+    offset = 12
+    while offset < len(data):
+        thread_id, size = struct.unpack_from("<II", data, offset)
+        offset += 8
+        chunks.setdefault(thread_id, []).append(data[offset:offset + size])
+        offset += size
+
+    streams = OrderedDict()
+    for thread_id in sorted(chunks):
+        streams[thread_id] = b"".join(chunks[thread_id])
+
+    return streams
+
+
+def parse_stream(stream, root):
+    """
+    Parse a thread event stream, adding its nodes and attributes to the root.
+
+    Args:
+        stream (bytes): The event stream.
+        root (list): The children of the root node.
+    """
+    keys = {}
+    stack = [root]
+    offset = 0
+
+    def get_string():
+        nonlocal offset
+        size = stream[offset]
+        value = stream[offset + 1:offset + 1 + size].decode("utf-8")
+        offset += 1 + size
+        return value
+
+    while offset < len(stream):
+        event = stream[offset]
+        offset += 1
+
+        if event == EVENT_NODE_BEGIN:
+            children = []
+            stack[-1].append(["node", get_string(), children])
+            stack.append(children)
+
+        elif event == EVENT_NODE_END:
+            stack.pop()
+
+        elif event == EVENT_KEY:
+            key_id, = struct.unpack_from("<H", stream, offset)
+            offset += 2
+            keys[key_id] = get_string()
+
+        else:
+            key_id, = struct.unpack_from("<H", stream, offset)
+            offset += 2
+            key = keys[key_id]
+
+            if event == EVENT_INT:
+                value, = struct.unpack_from("<i", stream, offset)
+                offset += 4
+            elif event == EVENT_UINT:
+                value, = struct.unpack_from("<I", stream, offset)
+                offset += 4
+            elif event == EVENT_FLOAT:
+                value, = struct.unpack_from("<f", stream, offset)
+                offset += 4
+            elif event == EVENT_STR:
+                value = get_string()
+            else:
+                raise ValueError("Unknown trace event type %u" % event)
+
+            stack[-1].append([key, value])
+
+    if len(stack) != 1:
+        raise ValueError("Trace stream ends inside a node")
+
+
+def convert_trace(data):
+    """
+    Convert a binary trace into a JSON tree.
+
+    Args:
+        data (bytes): The trace file data.
+
+    Returns:
+        list: The root node of the JSON tree.
+    """
+    root = []
+    for stream in read_streams(data).values():
+        parse_stream(stream, root)
+
+    # Root attributes are stored before the child nodes
+    attribs = [x for x in root if x[0] != "node"]
+    nodes = [x for x in root if x[0] == "node"]
+    return ["node", "root", attribs + nodes]
+
+
+def parse_command_line():
+    """
+    Parse the command line.
+
+    Returns:
+        Namespace: The parsed command line container.
+    """
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument("trace", type=argparse.FileType("rb"),
+                        help="The binary trace file to convert")
+
+    parser.add_argument("json", type=argparse.FileType("w"),
+                        help="The JSON file to write")
+
+    return parser.parse_args()
+
+
+def main():
+    """
+    The main function.
+
+    Returns:
+        int: The process return code.
+    """
+    args = parse_command_line()
+
+    try:
+        data = convert_trace(args.trace.read())
+    except (ValueError, KeyError, struct.error) as ex:
+        print("ERROR: %s" % ex)
+        return 1
+
+    json.dump(data, args.json, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
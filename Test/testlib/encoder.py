@@ -186,9 +186,10 @@ class EncoderBase():
         # pylint: disable=unused-argument,no-self-use,redundant-returns-doc
         assert False, "Missing subclass implementation"
 
-    def run_test(self, image, blockSize, preset, testRuns, keepOutput=True):
+    def run_test_samples(self, image, blockSize, preset, testRuns,
+                         keepOutput=True, extraArgs=None):
         """
-        Run the test N times.
+        Run the test N times, returning the results of every run.
 
         Args:
             image (TestImage): The test image to compress.
@@ -198,30 +199,51 @@ class EncoderBase():
             keepOutput (bool): Should the test preserve output images? This is
                 only a hint and discarding output may be ignored if the encoder
                 version used can't do it natively.
+            extraArgs (list(str)): Additional command line arguments.
 
         Returns:
-            tuple(float, float, float, float): Returns the best results from
-            the N test runs, as PSNR (dB), total time (seconds), coding time
+            list(tuple(float, float, float, float)): Returns the results of
+            each test run, as PSNR (dB), total time (seconds), coding time
             (seconds), and coding rate (M pixels/s).
         """
         # pylint: disable=assignment-from-no-return
         command = self.build_cli(image, blockSize, preset, keepOutput)
+        if extraArgs:
+            command += extraArgs
 
-        # Execute test runs
-        bestPSNR = 0
-        bestTTime = sys.float_info.max
-        bestCTime = sys.float_info.max
-        bestCRate = 0
-
+        results = []
         for _ in range(0, testRuns):
             output = self.execute(command)
-            result = self.parse_output(image, output)
+            results.append(self.parse_output(image, output))
+
+        return results
+
+    def run_test(self, image, blockSize, preset, testRuns, keepOutput=True):
+        """
+        Run the test N times.
+
+        Args:
+            image (TestImage): The test image to compress.
+            blockSize (str): The block size to use.
+            preset (str): The quality-performance preset to use.
+            testRuns (int): The number of test runs.
+            keepOutput (bool): Should the test preserve output images? This is
+                only a hint and discarding output may be ignored if the encoder
+                version used can't do it natively.
 
-            # Keep the best results (highest PSNR, lowest times, highest rate)
-            bestPSNR = max(bestPSNR, result[0])
-            bestTTime = min(bestTTime, result[1])
-            bestCTime = min(bestCTime, result[2])
-            bestCRate = max(bestCRate, result[3])
+        Returns:
+            tuple(float, float, float, float): Returns the best results from
+            the N test runs, as PSNR (dB), total time (seconds), coding time
+            (seconds), and coding rate (M pixels/s).
+        """
+        results = self.run_test_samples(image, blockSize, preset, testRuns,
+                                        keepOutput)
+
+        # Keep the best results (highest PSNR, lowest times, highest rate)
+        bestPSNR = max([x[0] for x in results])
+        bestTTime = min([x[1] for x in results])
+        bestCTime = min([x[2] for x in results])
+        bestCRate = max([x[3] for x in results])
 
         return (bestPSNR, bestTTime, bestCTime, bestCRate)
 
@@ -0,0 +1,354 @@
+# SPDX-License-Identifier: Apache-2.0
+# -----------------------------------------------------------------------------
+# Copyright 2021 Arm Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy
+# of the License at:
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations
+# under the License.
+# -----------------------------------------------------------------------------
+"""
+A PerfSet stores the performance samples of a TestSet. Each set keeps a
+PerfRecord for each image and block size tested, which stores the coding rate
+of every timed run rather than just the best run, allowing the variability of
+the measurement to be taken into account when comparing two sets.
+
+PerfSets are backed by a CSV file on disk, which can be used as the baseline
+for a later run of the same encoder. Each run can also be appended to a
+history CSV file, which is used to plot performance trends.
+"""
+
+import csv
+import enum
+import math
+import os
+import statistics
+
+
+# Two-sided 95% critical values of Student's t distribution, indexed by the
+# degrees of freedom. Larger degrees of freedom use the normal approximation.
+T_CRITICAL_95 = [
+    None, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+    2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+    2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+    2.042
+]
+
+
+def get_t_critical(dof):
+    """
+    Get the two-sided 95% critical value of Student's t distribution.
+
+    Args:
+        dof (float): The degrees of freedom, which must be at least 1.
+
+    Returns:
+        float: The critical value.
+    """
+    # Round down, which is conservative for non-integer Welch estimates
+    dof = max(int(dof), 1)
+    if dof < len(T_CRITICAL_95):
+        return T_CRITICAL_95[dof]
+
+    return 1.960
+
+
+@enum.unique
+class Change(enum.IntEnum):
+    """
+    An enumeration of performance comparison results.
+
+    Attributes:
+        NOTRUN: The test has no baseline to compare against.
+        SAME: The test has no significant performance change.
+        FASTER: The test is significantly faster than the baseline.
+        SLOWER: The test is significantly slower than the baseline.
+    """
+    NOTRUN = 0
+    SAME = 1
+    FASTER = 2
+    SLOWER = 3
+
+
+class PerfRecord():
+    """
+    A single performance record, storing samples for one image and block size.
+
+    Attributes:
+        blkSz: The block size.
+        name: The test image name.
+        samples: The coding rate of each timed run, in MT/s.
+        change: The Change compared to the baseline.
+        relRate: The relative mean coding rate vs baseline.
+    """
+
+    def __init__(self, blkSz, name, samples):
+        """
+        Create a performance record, initially in the NOTRUN status.
+
+        Args:
+            blkSz (str): The block size.
+            name (str): The test image name.
+            samples (list(float)): The coding rate of each run, in MT/s.
+        """
+        self.blkSz = blkSz
+        self.name = name
+        self.samples = list(samples)
+        self.change = Change.NOTRUN
+        self.relRate = None
+
+    @property
+    def mean(self):
+        """
+        float: The mean coding rate, in MT/s.
+        """
+        return statistics.mean(self.samples)
+
+    @property
+    def variance(self):
+        """
+        float: The sample variance of the coding rate.
+        """
+        if len(self.samples) < 2:
+            return 0.0
+
+        return statistics.variance(self.samples)
+
+    def get_interval(self):
+        """
+        Get the 95% confidence interval of the mean coding rate.
+
+        Returns:
+            tuple(float, float): The low and high bounds, in MT/s. Both are
+            the mean if there are too few samples to estimate the interval.
+        """
+        count = len(self.samples)
+        if count < 2:
+            return (self.mean, self.mean)
+
+        error = get_t_critical(count - 1) * math.sqrt(self.variance / count)
+        return (self.mean - error, self.mean + error)
+
+    def compare(self, baseline, threshold):
+        """
+        Compare this record against a baseline using Welch's t-test.
+
+        A change is only reported if it is statistically significant at the
+        95% level, and if the relative change in mean coding rate is larger
+        than the threshold. The second condition stops very stable tests
+        reporting changes that are too small to be interesting.
+
+        Args:
+            baseline (PerfRecord): The baseline record.
+            threshold (float): The minimum relative change to report.
+
+        Returns:
+            Change: The result of the comparison, which is also stored.
+        """
+        self.relRate = self.mean / baseline.mean
+
+        countA = len(self.samples)
+        countB = len(baseline.samples)
+        if countA < 2 or countB < 2:
+            self.change = Change.NOTRUN
+            return self.change
+
+        errA = self.variance / countA
+        errB = baseline.variance / countB
+        delta = self.mean - baseline.mean
+
+        # Identical samples, so the only possible difference is exact
+        if errA + errB == 0.0:
+            significant = delta != 0.0
+        else:
+            tValue = delta / math.sqrt(errA + errB)
+
+            # Welch-Satterthwaite approximation of the degrees of freedom
+            dofDiv = 0.0
+            if errA:
+                dofDiv += errA * errA / (countA - 1)
+            if errB:
+                dofDiv += errB * errB / (countB - 1)
+            dof = (errA + errB) ** 2 / dofDiv
+
+            significant = abs(tValue) > get_t_critical(dof)
+
+        if not significant or abs(self.relRate - 1.0) <= threshold:
+            self.change = Change.SAME
+        elif delta < 0.0:
+            self.change = Change.SLOWER
+        else:
+            self.change = Change.FASTER
+
+        return self.change
+
+    def __str__(self):
+        return "'%s' / '%s'" % (self.blkSz, self.name)
+
+
+class PerfSet():
+    """
+    A set of performance records for a TestSet, across one or more block sizes.
+
+    Attributes:
+        testSet: The test set these results are linked to.
+        records: The list of performance records.
+    """
+
+    def __init__(self, testSet):
+        """
+        Create a new empty PerfSet.
+
+        Args:
+            testSet (str): The name of the test set these results are linked to.
+        """
+        self.testSet = testSet
+        self.records = []
+
+    def add_record(self, record):
+        """
+        Add a new performance record to this set.
+
+        Args:
+            record (PerfRecord): The record to add.
+        """
+        self.records.append(record)
+
+    def get_matching_record(self, other):
+        """
+        Get a record matching the config of another record.
+
+        Args:
+            other (PerfRecord): The pattern record to match.
+
+        Returns:
+            PerfRecord: The record, if present.
+
+        Raises:
+            KeyError: No match could be found.
+        """
+        for record in self.records:
+            if record.blkSz == other.blkSz and record.name == other.name:
+                return record
+
+        raise KeyError()
+
+    def get_change_counts(self):
+        """
+        Get the number of records with each comparison result.
+
+        Returns:
+            dict(Change, int): The number of records with each result.
+        """
+        counts = {change: 0 for change in Change}
+        for record in self.records:
+            counts[record.change] += 1
+
+        return counts
+
+    def save_to_file(self, filePath):
+        """
+        Save this set to a CSV file.
+
+        Args:
+            filePath (str): The output file path.
+        """
+        dirName = os.path.dirname(filePath)
+        if dirName and not os.path.exists(dirName):
+            os.makedirs(dirName)
+
+        with open(filePath, "w", newline="") as csvfile:
+            writer = csv.writer(csvfile)
+            writer.writerow(["Image Set", "Block Size", "Name", "Mean Rate",
+                             "CI Low", "CI High", "Samples"])
+            for record in self.records:
+                writer.writerow(self._get_row(record))
+
+    def append_to_history(self, filePath, label):
+        """
+        Append the mean and confidence interval of each record to a history
+        CSV file, creating it if needed.
+
+        Args:
+            filePath (str): The history file path.
+            label (str): The label of this run in the history.
+        """
+        dirName = os.path.dirname(filePath)
+        if dirName and not os.path.exists(dirName):
+            os.makedirs(dirName)
+
+        exists = os.path.exists(filePath)
+        with open(filePath, "a", newline="") as csvfile:
+            writer = csv.writer(csvfile)
+            if not exists:
+                writer.writerow(["Label", "Image Set", "Block Size", "Name",
+                                 "Mean Rate", "CI Low", "CI High"])
+            for record in self.records:
+                writer.writerow([label] + self._get_row(record)[:-1])
+
+    def _get_row(self, record):
+        """
+        Get the CSV row for a record.
+
+        Args:
+            record (PerfRecord): The record to write.
+
+        Returns:
+            list(str): The row.
+        """
+        ciLow, ciHigh = record.get_interval()
+        samples = " ".join(["%0.4f" % x for x in record.samples])
+        return [self.testSet,
+                record.blkSz,
+                record.name,
+                "%0.4f" % record.mean,
+                "%0.4f" % ciLow,
+                "%0.4f" % ciHigh,
+                samples]
+
+    def load_from_file(self, filePath):
+        """
+        Load a baseline set from a CSV file on disk.
+
+        Args:
+            filePath (str): The input file path.
+        """
+        with open(filePath, "r", newline="") as csvfile:
+            reader = csv.reader(csvfile)
+            # Skip the header
+            next(reader)
+            for row in reader:
+                assert row[0] == self.testSet
+                samples = [float(x) for x in row[6].split()]
+                self.add_record(PerfRecord(row[1], row[2], samples))
+
+
+def load_history(filePath):
+    """
+    Load a performance history CSV file.
+
+    Args:
+        filePath (str): The history file path.
+
+    Returns:
+        list(tuple(str, str, str, float, float, float)): The label, block
+        size, image name, mean rate, and confidence interval bounds of each
+        record, in the order they were run.
+    """
+    history = []
+    with open(filePath, "r", newline="") as csvfile:
+        reader = csv.reader(csvfile)
+        # Skip the header
+        next(reader)
+        for row in reader:
+            history.append((row[0], row[2], row[3],
+                            float(row[4]), float(row[5]), float(row[6])))
+
+    return history